@@ -149,6 +149,56 @@ hse_kvs_prefix_probe(
     size_t                      valbuf_sz,
     size_t *                    val_len);
 
+/** @brief Create cursors that partition a key range for a parallel scan.
+ *
+ * Splits the closed interval [@p filt_min, @p filt_max] into at most @p
+ * cursorc subranges at the boundaries of the KVS's on-media leaf nodes, such
+ * that each subrange covers a similar amount of data, and creates one cursor
+ * per subrange.  Each cursor is positioned at the start of its subrange as if
+ * by hse_kvs_cursor_seek_range(), so the subranges can be scanned
+ * concurrently by different threads.
+ *
+ * All the cursors share the same snapshot view: the transaction's view if
+ * @p txn is not NULL, otherwise a single ephemeral view obtained when this
+ * function is called.  Calling hse_kvs_cursor_update_view() or seeking one
+ * of the cursors outside of its subrange is allowed, but the cursors then
+ * no longer partition the range.  Each cursor must be destroyed with
+ * hse_kvs_cursor_destroy().
+ *
+ * @note This function is thread safe.
+ *
+ * <b>Flags:</b>
+ * @arg 0 - Reserved for future use.
+ *
+ * @param kvs: KVS to iterate over, handle from hse_kvdb_kvs_open().
+ * @param flags: Flags for operation specialization.
+ * @param txn: Transaction context (optional).
+ * @param filt_min: Range minimum (optional, NULL for the first key).
+ * @param filt_min_len: Length of @p filt_min.
+ * @param filt_max: Range maximum (optional, NULL for the last key).
+ * @param filt_max_len: Length of @p filt_max.
+ * @param[in,out] cursorc: Max number of cursors to create on input, number
+ * created on output.
+ * @param[out] cursorv: Cursor handles, in ascending order of subrange.
+ *
+ * @remark @p kvs must not be NULL.
+ * @remark @p cursorc must not be NULL and must point to a nonzero value.
+ * @remark @p cursorv must not be NULL.
+ *
+ * @returns Error status.
+ */
+hse_err_t
+hse_kvs_cursor_create_split(
+    struct hse_kvs *        kvs,
+    unsigned int            flags,
+    struct hse_kvdb_txn *   txn,
+    const void *            filt_min,
+    size_t                  filt_min_len,
+    const void *            filt_max,
+    size_t                  filt_max_len,
+    unsigned int *          cursorc,
+    struct hse_kvs_cursor **cursorv);
+
 /**@} KVS */
 
 #pragma GCC visibility pop
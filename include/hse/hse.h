@@ -596,6 +596,54 @@ hse_kvs_get(
     size_t               valbuf_sz,
     size_t *             val_len);
 
+/** @brief Retrieve the values for a batch of keys from the KVS.
+ *
+ * Semantically equivalent to calling hse_kvs_get() once for each of the @p
+ * count keys, except that all keys are resolved against the same view of the
+ * KVS and the per-call overhead is paid once for the whole batch. Results are
+ * returned in the same order as the keys were given. The keys need not be
+ * sorted nor unique.
+ *
+ * @note This function is thread safe.
+ *
+ * <b>Flags:</b>
+ * @arg 0 - Reserved for future use.
+ *
+ * @param kvs: KVS handle from hse_kvdb_kvs_open().
+ * @param flags: Flags for operation specialization.
+ * @param txn: Transaction context (optional).
+ * @param count: Number of keys in @p keys.
+ * @param keys: Vector of keys to get from @p kvs.
+ * @param key_lens: Vector of key lengths.
+ * @param[out] found: Vector of booleans indicating whether each key was found.
+ * @param[in,out] valbufs: Vector of buffers into which the values will be
+ * copied (optional, individual entries may be NULL).
+ * @param valbuf_szs: Vector of sizes of the buffers in @p valbufs (optional).
+ * @param[out] val_lens: Vector of actual value lengths of keys that were found.
+ *
+ * @remark @p kvs must not be NULL.
+ * @remark @p count must be within the range of [1, HSE_KVS_GET_MULTI_MAX].
+ * @remark @p keys and @p key_lens must not be NULL.
+ * @remark Each key length must be within the range of [1, HSE_KVS_KEY_LEN_MAX].
+ * @remark @p found must not be NULL.
+ * @remark @p val_lens must not be NULL.
+ *
+ * @returns Error status.
+ */
+/* MTF_MOCK */
+hse_err_t
+hse_kvs_get_multi(
+    struct hse_kvs *     kvs,
+    unsigned int         flags,
+    struct hse_kvdb_txn *txn,
+    unsigned int         count,
+    const void *const *  keys,
+    const size_t *       key_lens,
+    bool *               found,
+    void *const *        valbufs,
+    const size_t *       valbuf_szs,
+    size_t *             val_lens);
+
 /** @brief Get the name of a KVS.
  *
  * @note This function is thread safe.
@@ -677,6 +725,50 @@ hse_kvs_prefix_delete(
     const void *         pfx,
     size_t               pfx_len);
 
+/** @brief Delete all key-value pairs whose keys lie within a range.
+ *
+ * Deletes every key @p k in the KVS for which @p start <= @p k < @p end
+ * (keys are compared as with memcmp(), shorter keys first) by writing a single
+ * range tombstone, regardless of the number of keys in the range.  The space
+ * occupied by the deleted keys is reclaimed as compaction encounters them.
+ * It is not an error if no keys exist within the range, and a range in which
+ * @p start is not less than @p end deletes nothing.
+ *
+ * This is intended for bulk removal of contiguous key ranges, such as
+ * expiring time-ordered keys, where deleting the keys one by one would be
+ * prohibitively expensive.
+ *
+ * @note This function is thread safe.
+ *
+ * <b>Flags:</b>
+ * @arg 0 - Reserved for future use.
+ *
+ * @param kvs: KVS handle from hse_kvdb_kvs_open().
+ * @param flags: Flags for operation specialization.
+ * @param txn: Transaction context, must be NULL (transactions are not supported).
+ * @param start: First key of the range (inclusive).
+ * @param start_len: Length of @p start.
+ * @param end: End of the range (exclusive).
+ * @param end_len: Length of @p end.
+ *
+ * @remark @p kvs must not be NULL.
+ * @remark @p start and @p end must not be NULL.
+ * @remark @p txn must be NULL, and range deletes fail with ENOTSUP in KVSs
+ *         with transactions enabled.
+ *
+ * @returns Error status.
+ */
+/* MTF_MOCK */
+hse_err_t
+hse_kvs_range_delete(
+    struct hse_kvs *     kvs,
+    unsigned int         flags,
+    struct hse_kvdb_txn *txn,
+    const void *         start,
+    size_t               start_len,
+    const void *         end,
+    size_t               end_len);
+
 /** @brief Put a key-value pair into KVS.
  *
  * If the key already exists in the KVS then the value is effectively
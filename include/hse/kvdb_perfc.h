@@ -37,6 +37,8 @@ enum kvdb_perfc_sidx_kvdbop {
     PERFC_RA_KVDBOP_KVS_PFX_DEL,
     PERFC_RA_KVDBOP_KVS_PFX_DELB,
 
+    PERFC_RA_KVDBOP_KVS_RANGE_DEL,
+
     PERFC_RA_KVDBOP_KVS_PFXPROBE,
 
     PERFC_RA_KVDBOP_KVDB_SYNC,
@@ -155,6 +157,31 @@ enum kvdb_perfc_cncapped {
     PERFC_EN_CNCAPPED
 };
 
+enum kvdb_perfc_cnbcache {
+    PERFC_BA_CNBCACHE_BYTES,
+    PERFC_RA_CNBCACHE_HIT,
+    PERFC_RA_CNBCACHE_MISS,
+    PERFC_RA_CNBCACHE_REJECT,
+    PERFC_EN_CNBCACHE
+};
+
+enum kvdb_perfc_cnrcache {
+    PERFC_BA_CNRCACHE_BYTES,
+    PERFC_RA_CNRCACHE_HIT,
+    PERFC_RA_CNRCACHE_MISS,
+    PERFC_RA_CNRCACHE_FLUSH,
+    PERFC_EN_CNRCACHE
+};
+
+enum kvdb_perfc_walreplay {
+    PERFC_BA_WALREPLAY_FILES,
+    PERFC_BA_WALREPLAY_GENS,
+    PERFC_RA_WALREPLAY_RBYTES,
+    PERFC_RA_WALREPLAY_RECS,
+    PERFC_BA_WALREPLAY_MSECS,
+    PERFC_EN_WALREPLAY
+};
+
 enum kvdb_perfc_sidx_cursorcache {
     PERFC_RA_CC_HIT,
     PERFC_RA_CC_MISS,
@@ -200,6 +227,8 @@ enum kvdb_perfc_sidx_pkvsl {
     PERFC_LT_PKVSL_KVS_DEL,
     PERFC_LT_PKVSL_KVS_PFX_PROBE,
     PERFC_LT_PKVSL_KVS_PFX_DEL,
+    PERFC_LT_PKVSL_KVS_GET_MULTI,
+    PERFC_LT_PKVSL_KVS_RANGE_DEL,
 
     PERFC_EN_PKVSL
 };
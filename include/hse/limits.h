@@ -46,6 +46,9 @@ extern "C" {
  */
 #define HSE_KVS_VALUE_LEN_MAX (1024 * 1024)
 
+/** @brief Maximum number of keys in one hse_kvs_get_multi() call. */
+#define HSE_KVS_GET_MULTI_MAX 1024
+
 /** @} KVS */
 
 #ifdef __cplusplus
@@ -36,6 +36,7 @@
 
 #include <hse/util/err_ctx.h>
 #include <hse/util/event_counter.h>
+#include <hse/util/keycmp.h>
 #include <hse/util/mutex.h>
 #include <hse/util/platform.h>
 #include <hse/util/vlb.h>
@@ -1266,6 +1267,93 @@ hse_kvs_get(
     return 0;
 }
 
+hse_err_t
+hse_kvs_get_multi(
+    struct hse_kvs *           handle,
+    const unsigned int         flags,
+    struct hse_kvdb_txn *const txn,
+    const unsigned int         count,
+    const void *const *        keys,
+    const size_t *             key_lens,
+    bool *                     found,
+    void *const *              valbufs,
+    const size_t *             valbuf_szs,
+    size_t *                   val_lens)
+{
+    struct kvs_ktuple   *ktv;
+    struct kvs_buf      *vbufv;
+    enum key_lookup_res *resv;
+    size_t               sz, vlen;
+    merr_t               err;
+    uint                 i;
+
+    if (HSE_UNLIKELY(!handle || !keys || !key_lens || !found || !val_lens || flags != 0))
+        return merr(EINVAL);
+
+    if (HSE_UNLIKELY(count == 0 || count > HSE_KVS_GET_MULTI_MAX))
+        return merr(EINVAL);
+
+    for (i = 0; i < count; ++i) {
+        if (HSE_UNLIKELY(!keys[i]))
+            return merr(EINVAL);
+
+        if (HSE_UNLIKELY(key_lens[i] > HSE_KVS_KEY_LEN_MAX))
+            return merr(ENAMETOOLONG);
+
+        if (HSE_UNLIKELY(key_lens[i] == 0))
+            return merr(ENOENT);
+
+        if (HSE_UNLIKELY((!valbufs || !valbufs[i]) && valbuf_szs && valbuf_szs[i] > 0))
+            return merr(EINVAL);
+    }
+
+    sz = count * (sizeof(*ktv) + sizeof(*vbufv) + sizeof(*resv));
+
+    ktv = malloc(sz);
+    if (ev(!ktv))
+        return merr(ENOMEM);
+
+    vbufv = (void *)(ktv + count);
+    resv = (void *)(vbufv + count);
+
+    for (i = 0; i < count; ++i) {
+        void  *valbuf = valbufs ? valbufs[i] : NULL;
+        size_t valbuf_sz = (valbuf && valbuf_szs) ? valbuf_szs[i] : 0;
+
+        /* See hse_kvs_get() regarding probes for value length only.
+         */
+        if (!valbuf)
+            valbuf = (void *)-1;
+
+        kvs_ktuple_init_nohash(ktv + i, keys[i], key_lens[i]);
+        kvs_buf_init(vbufv + i, valbuf, valbuf_sz);
+    }
+
+    err = ikvdb_kvs_get_multi(handle, flags, txn, count, ktv, resv, vbufv);
+    if (ev(err))
+        goto out;
+
+    vlen = 0;
+
+    for (i = 0; i < count; ++i) {
+        found[i] = (resv[i] == FOUND_VAL);
+        val_lens[i] = vbufv[i].b_len;
+
+        if (ev(resv[i] == FOUND_MULTIPLE))
+            err = merr(EPROTO);
+
+        if (found[i])
+            vlen += val_lens[i];
+    }
+
+    perfc_add2(&kvdb_pc, PERFC_RA_KVDBOP_KVS_GET, count, PERFC_RA_KVDBOP_KVS_GETB, vlen);
+
+out:
+    free(ktv);
+
+    return err;
+}
+
 /**
  * hse_kvs_delete() - remove the supplied key and associated value from the KVS
  */
@@ -1407,6 +1495,45 @@ hse_kvs_prefix_delete(
     return err;
 }
 
+hse_err_t
+hse_kvs_range_delete(
+    struct hse_kvs *           handle,
+    const unsigned int         flags,
+    struct hse_kvdb_txn *const txn,
+    const void *               start,
+    size_t                     start_len,
+    const void *               end,
+    size_t                     end_len)
+{
+    struct kvs_ktuple skt, ekt;
+    merr_t            err;
+
+    if (HSE_UNLIKELY(!handle || !start || !end || flags != 0))
+        return merr(EINVAL);
+
+    if (HSE_UNLIKELY(start_len > HSE_KVS_KEY_LEN_MAX || end_len > HSE_KVS_KEY_LEN_MAX))
+        return merr(ENAMETOOLONG);
+
+    if (HSE_UNLIKELY(start_len == 0 || end_len == 0))
+        return merr(ENOENT);
+
+    /* An empty range deletes nothing.
+     */
+    if (keycmp(start, start_len, end, end_len) >= 0)
+        return 0;
+
+    kvs_ktuple_init(&skt, start, start_len);
+    kvs_ktuple_init_nohash(&ekt, end, end_len);
+
+    err = ikvdb_kvs_range_delete(handle, flags, txn, &skt, &ekt);
+    ev(err);
+
+    if (!err)
+        PERFC_INC_RU(&kvdb_pc, PERFC_RA_KVDBOP_KVS_RANGE_DEL);
+
+    return err;
+}
+
 hse_err_t
 hse_kvdb_sync(struct hse_kvdb *handle, const unsigned int flags)
 {
@@ -1591,6 +1718,33 @@ hse_kvs_cursor_create(
     return err;
 }
 
+hse_err_t
+hse_kvs_cursor_create_split(
+    struct hse_kvs *           handle,
+    const unsigned int         flags,
+    struct hse_kvdb_txn *const txn,
+    const void *               filt_min,
+    size_t                     filt_min_len,
+    const void *               filt_max,
+    size_t                     filt_max_len,
+    unsigned int *             cursorc,
+    struct hse_kvs_cursor **   cursorv)
+{
+    merr_t err;
+
+    if (HSE_UNLIKELY(!handle || !cursorc || *cursorc == 0 || !cursorv ||
+                     (filt_min_len && !filt_min) || (filt_max_len && !filt_max) || flags != 0))
+        return merr(EINVAL);
+
+    PERFC_INC_RU(&kvdb_pc, PERFC_RA_KVDBOP_KVS_CURSOR_CREATE);
+
+    err = ikvdb_kvs_cursor_create_split(
+        handle, flags, txn, filt_min, filt_min_len, filt_max, filt_max_len, cursorc, cursorv);
+    ev(err);
+
+    return err;
+}
+
 hse_err_t
 hse_kvs_cursor_update_view(struct hse_kvs_cursor *cursor, const unsigned int flags)
 {
@@ -21,6 +21,7 @@ struct perfc_name kvdb_perfc_op[] _dt_section = {
     NE(PERFC_RA_KVDBOP_KVS_PFX_DELB,    1, "kvs_pfxdel klen",         "r_kvs_pfxdel_bytes(/s)"),
     NE(PERFC_RA_KVDBOP_KVS_PFXPROBE,    1, "kvs_prefix_probe rate",   "r_kvs_prefix_probe(/s)"),
     NE(PERFC_RA_KVDBOP_KVS_PFX_DEL,     1, "kvs_prefix_delete rate",  "r_kvs_prefix_delete(/s)"),
+    NE(PERFC_RA_KVDBOP_KVS_RANGE_DEL,   1, "kvs_range_delete rate",   "r_kvs_range_delete(/s)"),
     NE(PERFC_RA_KVDBOP_KVDB_SYNC,       1, "kvdb_sync rate",          "r_kvdb_sync(/s)"),
     NE(PERFC_RA_KVDBOP_KVDB_TXN_ALLOC,  1, "kvdb_txn_alloc rate",     "r_kvdb_txn_alloc(/s)"),
     NE(PERFC_RA_KVDBOP_KVDB_TXN_FREE,   1, "kvdb_txn_free rate",      "r_kvdb_txn_free(/s)"),
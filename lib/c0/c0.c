@@ -118,6 +118,28 @@ c0_prefix_del(struct c0 *handle, struct kvs_ktuple *kt, uintptr_t seqnoref)
     return c0sk_prefix_del(self->c0_c0sk, self->c0_index, kt, seqnoref);
 }
 
+merr_t
+c0_range_del(
+    struct c0               *handle,
+    struct kvs_ktuple       *start,
+    const struct kvs_ktuple *end,
+    uintptr_t                seqnoref)
+{
+    struct c0_impl *self = c0_h2r(handle);
+
+    assert(self->c0_index < HSE_KVS_COUNT_MAX);
+    return c0sk_range_del(self->c0_c0sk, self->c0_index, start, end, seqnoref);
+}
+
+merr_t
+c0_rtombs_get(struct c0 *handle, u64 view_seq, struct rtomb_vec *rv)
+{
+    struct c0_impl *self = c0_h2r(handle);
+
+    assert(self->c0_index < HSE_KVS_COUNT_MAX);
+    return c0sk_rtombs_get(self->c0_c0sk, self->c0_index, view_seq, rv);
+}
+
 /*
  * Tombstone indicated by:
  *     return value == 0 && res == FOUND_TOMB
@@ -140,6 +162,26 @@ c0_get(
         self->c0_c0sk, self->c0_index, self->c0_pfx_len, kt, view_seqno, seqnoref, res, vbuf);
 }
 
+merr_t
+c0_get_multi(
+    struct c0 *              handle,
+    uint                     count,
+    const struct kvs_ktuple *ktv,
+    u64                      view_seqno,
+    uintptr_t                seqnoref,
+    enum key_lookup_res *    resv,
+    struct kvs_buf *         vbufv)
+{
+    struct c0_impl *self;
+
+    self = c0_h2r(handle);
+
+    assert(self->c0_index < HSE_KVS_COUNT_MAX);
+    return c0sk_get_multi(
+        self->c0_c0sk, self->c0_index, self->c0_pfx_len, count, ktv, view_seqno, seqnoref, resv,
+        vbufv);
+}
+
 merr_t
 c0_pfx_probe(
     struct c0 *              handle,
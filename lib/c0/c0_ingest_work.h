@@ -28,6 +28,8 @@
  * @c0iw_coalscedbldrs:
  * @c0iw_bldrs:
  * @c0iw_mblocks:
+ * @c0iw_vcbuf:         output buffer for deferred value compression
+ * @c0iw_vcbufsz:       size of c0iw_vcbuf
  * @c0iw_c0kvms:        struct c0_kvmultiset being ingested
  * @c0iw_c0:
  * @c0iw_kvms_iterc:
@@ -52,6 +54,8 @@ struct c0_ingest_work {
     u32                      c0iw_kvms_iterc;
     u32                      c0iw_lc_iterc;
     struct kvset_mblocks    *c0iw_mbv[HSE_KVS_COUNT_MAX];
+    void                    *c0iw_vcbuf;
+    uint                     c0iw_vcbufsz;
 
     BIN_HEAP_DEFINE(c0iw_kvms_minheap, HSE_C0_INGEST_WIDTH_MAX);
     BIN_HEAP_DEFINE(c0iw_lc_minheap, LC_SOURCE_CNT_MAX);
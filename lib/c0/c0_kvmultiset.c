@@ -25,6 +25,7 @@
 #include <hse/ikvdb/c0_kvset.h>
 #include <hse/ikvdb/c0snr_set.h>
 #include <hse/ikvdb/kvdb_perfc.h>
+#include <hse/ikvdb/rtomb.h>
 
 #include "c0_cursor.h"
 #include "c0_ingest_work.h"
@@ -59,6 +60,7 @@
  * @c0ms_c0snr_base:    base of c0snr memory pool dedicated
  * @c0ms_num_sets:      size of c0ms_sets[]
  * @c0ms_ptreset_sz:    ptomb c0kvs reset size (bytes)
+ * @c0ms_rtombs:        list of range tombstones (newest first)
  * @c0ms_sets:          vector of c0 kvset pointers
  */
 struct c0_kvmultiset_impl {
@@ -87,6 +89,7 @@ struct c0_kvmultiset_impl {
 
     u32              c0ms_num_sets;
     u32              c0ms_ptreset_sz;
+    struct rtomb * _Atomic c0ms_rtombs;
     struct c0_kvset *c0ms_sets[HSE_C0_INGEST_WIDTH_MAX * 2 + 1];
 };
 
@@ -103,6 +106,40 @@ c0kvms_ptomb_c0kvset_get(struct c0_kvmultiset *handle)
     return self->c0ms_sets[0];
 }
 
+uint64_t
+c0kvms_rtomb_add(struct c0_kvmultiset *handle, struct rtomb *rt)
+{
+    struct c0_kvmultiset_impl *self = c0_kvmultiset_h2r(handle);
+    atomic_ulong *sref = self->c0ms_kvdb_seq;
+    struct rtomb *head;
+
+    /* Like a ptomb, an rtomb gets a seqno of its own so that it is
+     * ordered after every value it hides (unless it is being replayed).
+     */
+    if (!rt->rt_seqno) {
+        if (HSE_UNLIKELY(atomic_read(&self->c0ms_seqno) != HSE_SQNREF_INVALID))
+            sref = &self->c0ms_seqno;
+
+        rt->rt_seqno = atomic_inc_return(sref);
+    }
+
+    head = atomic_read(&self->c0ms_rtombs);
+    do {
+        rt->rt_next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&self->c0ms_rtombs, &head, rt,
+                                                    memory_order_release, memory_order_relaxed));
+
+    return rt->rt_seqno;
+}
+
+struct rtomb *
+c0kvms_rtomb_first(struct c0_kvmultiset *handle)
+{
+    struct c0_kvmultiset_impl *self = c0_kvmultiset_h2r(handle);
+
+    return atomic_read_acq(&self->c0ms_rtombs);
+}
+
 struct c0_kvset *
 c0kvms_get_hashed_c0kvset(struct c0_kvmultiset *handle, u64 hash)
 {
@@ -854,6 +891,7 @@ c0kvms_bufrel_walcb(struct c0_kvmultiset_impl *mset)
 static void
 c0kvms_destroy(struct c0_kvmultiset_impl *mset)
 {
+    struct rtomb *rt;
     uint64_t c0snr_cnt;
     int      i;
 
@@ -875,6 +913,15 @@ c0kvms_destroy(struct c0_kvmultiset_impl *mset)
     /* Notify wal to free up buffer space */
     c0kvms_bufrel_walcb(mset);
 
+    rt = atomic_read(&mset->c0ms_rtombs);
+    while (rt) {
+        struct rtomb *next = rt->rt_next;
+
+        free(rt);
+        rt = next;
+    }
+    atomic_set(&mset->c0ms_rtombs, NULL);
+
     /* Try to save this kvms in the caller's stash for fast re-use...
      */
     if (mset->c0ms_finalized && mset->c0ms_stashp) {
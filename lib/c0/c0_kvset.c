@@ -8,7 +8,7 @@
 #include <hse/util/fmt.h>
 #include <hse/util/keycmp.h>
 #include <hse/util/bonsai_tree.h>
-#include <hse/util/compression_lz4.h>
+#include <hse/ikvdb/vcomp_params.h>
 #include <hse/util/event_counter.h>
 
 #include <hse/ikvdb/limits.h>
@@ -125,13 +125,16 @@ c0kvs_ior_stats(
 {
     size_t memsz = sizeof(struct bonsai_val) + new_value_len;
 
+    /* Values may be added to existing keys concurrently (see bn_update()),
+     * so the stats must be updated atomically.
+     */
     if (IS_IOR_INS(code)) {
         /* first insert for this key ... */
 
-        ++c0kvs->c0s_num_entries;
+        atomic_inc(&c0kvs->c0s_num_entries);
         if (HSE_CORE_IS_TOMB(new_value))
-            ++c0kvs->c0s_num_tombstones;
-        c0kvs->c0s_keyb += new_key_len;
+            atomic_inc(&c0kvs->c0s_num_tombstones);
+        atomic_add(&c0kvs->c0s_keyb, new_key_len);
 
         memsz += sizeof(struct bonsai_kv) + new_key_len;
         memsz += sizeof(struct bonsai_node);
@@ -140,29 +143,32 @@ c0kvs_ior_stats(
 
         if (!HSE_CORE_IS_TOMB(old_value)) {
             if (HSE_CORE_IS_TOMB(new_value)) {
-                ++c0kvs->c0s_num_tombstones;
+                atomic_inc(&c0kvs->c0s_num_tombstones);
             }
-            c0kvs->c0s_valb -= old_value_len;
+            atomic_sub(&c0kvs->c0s_valb, old_value_len);
         } else {
             if (!HSE_CORE_IS_TOMB(new_value)) {
-                --c0kvs->c0s_num_tombstones;
+                atomic_dec(&c0kvs->c0s_num_tombstones);
             }
         }
     } else {
         assert(IS_IOR_ADD(code));
 
         if (HSE_CORE_IS_TOMB(new_value))
-            ++c0kvs->c0s_num_tombstones;
+            atomic_inc(&c0kvs->c0s_num_tombstones);
     }
 
-    c0kvs->c0s_valb += new_value_len;
-    c0kvs->c0s_memsz += memsz;
+    atomic_add(&c0kvs->c0s_valb, new_value_len);
+    atomic_add(&c0kvs->c0s_memsz, memsz);
 
-    if (height > c0kvs->c0s_height)
-        c0kvs->c0s_height = height;
+    /* The max height and max keyvals are merely hints, so an occasional
+     * lost update due to a racing writer is harmless.
+     */
+    if (height > atomic_read(&c0kvs->c0s_height))
+        atomic_set(&c0kvs->c0s_height, height);
 
-    if (keyvals > c0kvs->c0s_keyvals)
-        c0kvs->c0s_keyvals = keyvals;
+    if (keyvals > atomic_read(&c0kvs->c0s_keyvals))
+        atomic_set(&c0kvs->c0s_keyvals, keyvals);
 }
 
 /*
@@ -536,13 +542,13 @@ c0kvs_reset(struct c0_kvset *handle, size_t sz)
     bn_reset(set->c0s_broot);
 
     atomic_set(&set->c0s_finalized, 0);
-    set->c0s_num_entries = 0;
-    set->c0s_num_tombstones = 0;
-    set->c0s_keyb = 0;
-    set->c0s_valb = 0;
-    set->c0s_memsz = 0;
-    set->c0s_height = 0;
-    set->c0s_keyvals = 0;
+    atomic_set(&set->c0s_num_entries, 0);
+    atomic_set(&set->c0s_num_tombstones, 0);
+    atomic_set(&set->c0s_keyb, 0);
+    atomic_set(&set->c0s_valb, 0);
+    atomic_set(&set->c0s_memsz, 0);
+    atomic_set(&set->c0s_height, 0);
+    atomic_set(&set->c0s_keyvals, 0);
 }
 
 static HSE_ALWAYS_INLINE void
@@ -561,13 +567,10 @@ void *
 c0kvs_alloc(struct c0_kvset *handle, size_t align, size_t sz)
 {
     struct c0_kvset_impl *impl = c0_kvset_h2r(handle);
-    void *                mem;
 
-    c0kvs_lock(impl);
-    mem = cheap_memalign(impl->c0s_cheap, align, sz);
-    c0kvs_unlock(impl);
-
-    return mem;
+    /* The bonsai tree allocates from the same cheap under its own lock.
+     */
+    return bn_cheap_alloc(impl->c0s_broot, align, sz);
 }
 
 static merr_t
@@ -579,9 +582,18 @@ c0kvs_putdel(
 {
     merr_t err;
 
-    c0kvs_lock(self);
-    err = bn_insert_or_replace(self->c0s_broot, skey, sval);
-    c0kvs_unlock(self);
+    /* Adding a value to a key that is already in the tree doesn't change
+     * the shape of the tree, so we first try to do so without acquiring
+     * the c0kvs mutex (updates to the same key are serialized by the tree).
+     * Only the insertion of new keys is serialized by the mutex, which
+     * greatly reduces contention for hot c0kvsets under skewed workloads.
+     */
+    err = bn_update(self->c0s_broot, skey, sval);
+    if (err && merr_errno(err) == ENOENT) {
+        c0kvs_lock(self);
+        err = bn_insert_or_replace(self->c0s_broot, skey, sval);
+        c0kvs_unlock(self);
+    }
 
     /* Callers putting keys into the active kvms must hold the
      * RCU read lock.  As such, a c0kvset undergoing ingest will
@@ -611,6 +623,7 @@ c0kvs_put(
 
     bn_skey_init(kt->kt_data, kt->kt_len, kt->kt_flags, skidx, &skey);
     bn_sval_init(vt->vt_data, vt->vt_xlen, seqnoref, &sval);
+    sval.bsv_flags = kt->kt_flags & HSE_BTF_VCOMP_OFF;
 
     return c0kvs_putdel(self, &skey, &sval, &kt->kt_seqno);
 }
@@ -650,7 +663,7 @@ c0kvs_get_element_count(struct c0_kvset *handle)
 {
     struct c0_kvset_impl *self = c0_kvset_h2r(handle);
 
-    return self->c0s_num_entries;
+    return atomic_read(&self->c0s_num_entries);
 }
 
 u64
@@ -658,11 +671,11 @@ c0kvs_get_element_count2(struct c0_kvset *handle, uint *heightp, uint *keyvalsp,
 {
     struct c0_kvset_impl *self = c0_kvset_h2r(handle);
 
-    *kvbytesp = self->c0s_keyb + self->c0s_valb;
-    *heightp = self->c0s_height;
-    *keyvalsp = self->c0s_keyvals;
+    *kvbytesp = atomic_read(&self->c0s_keyb) + atomic_read(&self->c0s_valb);
+    *heightp = atomic_read(&self->c0s_height);
+    *keyvalsp = atomic_read(&self->c0s_keyvals);
 
-    return self->c0s_num_entries;
+    return atomic_read(&self->c0s_num_entries);
 }
 
 void
@@ -671,11 +684,11 @@ c0kvs_usage(struct c0_kvset *handle, struct c0_usage *usage)
     struct c0_kvset_impl *self = c0_kvset_h2r(handle);
 
     usage->u_alloc = self->c0s_alloc_sz;
-    usage->u_keys = self->c0s_num_entries - self->c0s_num_tombstones;
-    usage->u_tombs = self->c0s_num_tombstones;
-    usage->u_keyb = self->c0s_keyb;
-    usage->u_valb = self->c0s_valb;
-    usage->u_memsz = self->c0s_memsz;
+    usage->u_keys = atomic_read(&self->c0s_num_entries) - atomic_read(&self->c0s_num_tombstones);
+    usage->u_tombs = atomic_read(&self->c0s_num_tombstones);
+    usage->u_keyb = atomic_read(&self->c0s_keyb);
+    usage->u_valb = atomic_read(&self->c0s_valb);
+    usage->u_memsz = atomic_read(&self->c0s_memsz);
     usage->u_count = 1;
 }
 
@@ -741,7 +754,7 @@ c0kvs_get_excl(
         ulen = bonsai_val_ulen(val);
 
         if (clen > 0) {
-            err = compress_lz4_ops.cop_decompress(
+            err = vcomp_decompress(
                 val->bv_value, clen, vbuf->b_buf, vbuf->b_buf_sz, &outlen);
             if (ev(err))
                 return err;
@@ -816,6 +829,7 @@ c0kvs_pfx_probe_cmn(
     /* found a key with the requested pfx */
     for (; kv != &root->br_kv; kv = kv->bkv_next) {
         u32 klen = key_imm_klen(&kv->bkv_key_imm);
+        bool rdel = false;
 
         if (keycmp_prefix(key->kt_data, key->kt_len, kv->bkv_key, klen))
             break; /* eof */
@@ -842,10 +856,14 @@ c0kvs_pfx_probe_cmn(
                 continue;
             if (val_seq < max_seq)
                 continue;
+
+            rdel = qctx_rtomb_covers(qctx, kv->bkv_key, klen, val_seq, view_seqno);
         }
 
-        /* add to tomblist if a tombstone was encountered */
-        if (HSE_CORE_IS_TOMB(val->bv_value)) {
+        /* add to tomblist if a tombstone was encountered, or if the key
+         * has been range deleted.
+         */
+        if (HSE_CORE_IS_TOMB(val->bv_value) || rdel) {
             err = qctx_tomb_insert(qctx, kv->bkv_key, klen);
             if (ev(err))
                 break;
@@ -872,7 +890,7 @@ c0kvs_pfx_probe_cmn(
                 ulen = bonsai_val_ulen(val);
 
                 if (clen > 0) {
-                    err = compress_lz4_ops.cop_decompress(
+                    err = vcomp_decompress(
                         val->bv_value, clen, vbuf->b_buf, vbuf->b_buf_sz, &outlen);
                     if (ev(err))
                         return err;
@@ -1009,7 +1027,8 @@ c0kvs_debug(struct c0_kvset *handle, void *key, int klen)
     char   disp[256];
     size_t max = sizeof(disp);
 
-    printf("%p nentries %d ntomb %d\n", self, self->c0s_num_entries, self->c0s_num_tombstones);
+    printf("%p nentries %u ntomb %u\n", self, atomic_read(&self->c0s_num_entries),
+           atomic_read(&self->c0s_num_tombstones));
 
     rcu_read_lock();
     end = &rcu_dereference(self->c0s_broot)->br_kv;
@@ -22,7 +22,7 @@
  * @c0s_next:              cheap cache linkage
  * @c0s_kvdb_seqno:        pointer to kvdb seqno
  * @c0s_kvms_seqno:        pointer to kvms seqno
- * @c0s_mutex:             mutex for bonsai tree updates
+ * @c0s_mutex:             serializes insertion of new keys into the tree
  * @c0s_num_entries:       how many entries (includes tombstones)
  * @c0s_num_tombstones:    how many tombstones
  * @c0s_keyb:              total key bytes
@@ -51,13 +51,13 @@ struct c0_kvset_impl {
 
     struct mutex c0s_mutex HSE_ACP_ALIGNED;
 
-    u32 c0s_num_entries HSE_L1D_ALIGNED;
-    u32 c0s_num_tombstones;
-    u32 c0s_keyb;
-    u32 c0s_valb;
-    u32 c0s_memsz;
-    u32 c0s_height;
-    u32 c0s_keyvals;
+    atomic_uint c0s_num_entries HSE_L1D_ALIGNED;
+    atomic_uint c0s_num_tombstones;
+    atomic_uint c0s_keyb;
+    atomic_uint c0s_valb;
+    atomic_uint c0s_memsz;
+    atomic_uint c0s_height;
+    atomic_uint c0s_keyvals;
 };
 
 merr_t
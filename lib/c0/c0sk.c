@@ -32,6 +32,7 @@
 #include <hse/ikvdb/cursor.h>
 #include <hse/ikvdb/kvdb_rparams.h>
 #include <hse/ikvdb/rparam_debug_flags.h>
+#include <hse/ikvdb/rtomb.h>
 
 #include "c0sk_internal.h"
 #include "c0_cursor.h"
@@ -281,13 +282,112 @@ c0sk_prefix_del(struct c0sk *handle, u16 skidx, struct kvs_ktuple *kt, uintptr_t
     return c0sk_putdel(self, skidx, C0SK_OP_PREFIX_DEL, kt, NULL, seqnoref);
 }
 
+merr_t
+c0sk_range_del(
+    struct c0sk             *handle,
+    u16                      skidx,
+    struct kvs_ktuple       *start,
+    const struct kvs_ktuple *end,
+    uintptr_t                seqnoref)
+{
+    struct c0sk_impl *self = c0sk_h2r(handle);
+    struct kvs_vtuple vt;
+    struct rtomb *rt;
+    merr_t err;
+
+    /* Range deletes are not supported in transactions.
+     */
+    if (ev(!HSE_SQNREF_SINGLE_P(seqnoref) && !HSE_SQNREF_ORDNL_P(seqnoref)))
+        return merr(EINVAL);
+
+    rt = rtomb_alloc(start->kt_data, start->kt_len, end->kt_data, end->kt_len,
+                     HSE_SQNREF_ORDNL_P(seqnoref) ? HSE_SQNREF_TO_ORDNL(seqnoref) : 0);
+    if (ev(!rt))
+        return merr(ENOMEM);
+
+    rt->rt_skidx = skidx;
+
+    /* c0sk_putdel() takes ownership of the rtomb, which is passed via vt_data.
+     */
+    kvs_vtuple_init(&vt, rt, rtomb_size(rt->rt_slen, rt->rt_elen));
+
+    err = c0sk_putdel(self, skidx, C0SK_OP_RANGE_DEL, start, &vt, seqnoref);
+    if (err)
+        free(rt);
+
+    return err;
+}
+
+merr_t
+c0sk_rtombs_get(struct c0sk *handle, u16 skidx, u64 view_seq, struct rtomb_vec *rv)
+{
+    struct c0sk_impl *    self = c0sk_h2r(handle);
+    struct c0_kvmultiset *c0kvms;
+    merr_t                err = 0;
+
+    rcu_read_lock();
+    cds_list_for_each_entry_rcu(c0kvms, &self->c0sk_kvmultisets, c0ms_link)
+    {
+        struct rtomb *rt, *copy;
+
+        for (rt = c0kvms_rtomb_first(c0kvms); rt; rt = rt->rt_next) {
+            if (rt->rt_skidx != skidx || rt->rt_seqno > view_seq)
+                continue;
+
+            copy = rtomb_alloc(rtomb_start(rt), rt->rt_slen, rtomb_end(rt), rt->rt_elen,
+                               rt->rt_seqno);
+            if (ev(!copy)) {
+                err = merr(ENOMEM);
+                goto out;
+            }
+
+            err = rtomb_vec_add(rv, copy);
+            if (ev(err)) {
+                free(copy);
+                goto out;
+            }
+        }
+    }
+
+out:
+    rcu_read_unlock();
+
+    return err;
+}
+
+/* Return the seqno of the newest rtomb in the given kvms that covers
+ * the key and is visible in the view, or zero if there is none.
+ */
+static u64
+c0sk_rtomb_get_rcu(
+    struct c0_kvmultiset    *c0kvms,
+    u16                      skidx,
+    const struct kvs_ktuple *kt,
+    u64                      view_seq)
+{
+    struct rtomb *rt;
+    u64 seq = 0;
+
+    for (rt = c0kvms_rtomb_first(c0kvms); rt; rt = rt->rt_next) {
+        if (rt->rt_skidx != skidx || rt->rt_seqno > view_seq || rt->rt_seqno <= seq)
+            continue;
+
+        if (rtomb_covers(rt, kt->kt_data, kt->kt_len))
+            seq = rt->rt_seqno;
+    }
+
+    return seq;
+}
+
 /*
  * Tombstone indicated by:
  *     return value == 0 && res == FOUND_TOMB
  */
-merr_t
-c0sk_get(
-    struct c0sk *            handle,
+/* Caller must hold the RCU read lock.
+ */
+static merr_t
+c0sk_get_rcu(
+    struct c0sk_impl *       self,
     u16                      skidx,
     u32                      pfx_len,
     const struct kvs_ktuple *kt,
@@ -297,18 +397,13 @@ c0sk_get(
     struct kvs_buf *         vbuf)
 {
     struct c0_kvmultiset *c0kvms;
-    struct c0sk_impl *    self;
     uintptr_t             key_seqref = 0, ptomb_seqref = 0;
-    u64                   start;
-    u64                   pfx_seq = 0, val_seq = 0;
+    u64                   pfx_seq = 0, val_seq = 0, rt_seq = 0;
     u64                   seq;
     merr_t                err = 0;
 
-    self = c0sk_h2r(handle);
     *res = NOT_FOUND;
 
-    start = perfc_lat_startl(&self->c0sk_pc_op, PERFC_LT_C0SKOP_GET);
-
     /* Disable ptomb searching if the key has no prefix.
      */
     if (kt->kt_len < pfx_len)
@@ -316,7 +411,6 @@ c0sk_get(
 
     /* Search the list of c0_kvmultisets from newest to oldest...
      */
-    rcu_read_lock();
     cds_list_for_each_entry_rcu(c0kvms, &self->c0sk_kvmultisets, c0ms_link)
     {
         struct c0_kvset *c0kvs;
@@ -333,6 +427,10 @@ c0sk_get(
                 pfx_seq = seq;
         }
 
+        seq = c0sk_rtomb_get_rcu(c0kvms, skidx, kt, view_seq);
+        if (seq > rt_seq)
+            rt_seq = seq;
+
         /* Search for latest value of key w/ seqno <= iseqno. */
         c0kvs = c0kvms_get_hashed_c0kvset(c0kvms, kt->kt_hash);
         err = c0kvs_get_rcu(c0kvs, skidx, kt, view_seq, seqref, res, vbuf, &key_seqref);
@@ -344,13 +442,41 @@ c0sk_get(
         if (*res != NOT_FOUND)
             break;
     }
-    rcu_read_unlock();
 
-    if (pfx_seq > val_seq) {
+    if (pfx_seq > val_seq && pfx_seq >= rt_seq) {
         *res = FOUND_PTMB;
         vbuf->b_len = 0;
+    } else if (rt_seq > val_seq) {
+        *res = FOUND_TMB;
+        vbuf->b_len = 0;
     }
 
+    return err;
+}
+
+merr_t
+c0sk_get(
+    struct c0sk *            handle,
+    u16                      skidx,
+    u32                      pfx_len,
+    const struct kvs_ktuple *kt,
+    u64                      view_seq,
+    uintptr_t                seqref,
+    enum key_lookup_res *    res,
+    struct kvs_buf *         vbuf)
+{
+    struct c0sk_impl *self;
+    u64               start;
+    merr_t            err;
+
+    self = c0sk_h2r(handle);
+
+    start = perfc_lat_startl(&self->c0sk_pc_op, PERFC_LT_C0SKOP_GET);
+
+    rcu_read_lock();
+    err = c0sk_get_rcu(self, skidx, pfx_len, kt, view_seq, seqref, res, vbuf);
+    rcu_read_unlock();
+
     if (start > 0) {
         perfc_lat_record(&self->c0sk_pc_op, PERFC_LT_C0SKOP_GET, start);
         perfc_inc(&self->c0sk_pc_op, PERFC_RA_C0SKOP_GET);
@@ -359,6 +485,46 @@ c0sk_get(
     return err;
 }
 
+merr_t
+c0sk_get_multi(
+    struct c0sk *            handle,
+    u16                      skidx,
+    u32                      pfx_len,
+    uint                     count,
+    const struct kvs_ktuple *ktv,
+    u64                      view_seq,
+    uintptr_t                seqref,
+    enum key_lookup_res *    resv,
+    struct kvs_buf *         vbufv)
+{
+    struct c0sk_impl *self;
+    u64               start;
+    merr_t            err = 0;
+    uint              i;
+
+    self = c0sk_h2r(handle);
+
+    start = perfc_lat_startl(&self->c0sk_pc_op, PERFC_LT_C0SKOP_GET);
+
+    /* Probe each key in turn, but within a single RCU read-side critical
+     * section so that the entire batch sees the same set of kvmultisets.
+     */
+    rcu_read_lock();
+    for (i = 0; i < count; ++i) {
+        err = c0sk_get_rcu(self, skidx, pfx_len, ktv + i, view_seq, seqref, resv + i, vbufv + i);
+        if (ev(err))
+            break;
+    }
+    rcu_read_unlock();
+
+    if (start > 0) {
+        perfc_lat_record(&self->c0sk_pc_op, PERFC_LT_C0SKOP_GET, start);
+        perfc_add(&self->c0sk_pc_op, PERFC_RA_C0SKOP_GET, count);
+    }
+
+    return err;
+}
+
 merr_t
 c0sk_pfx_probe(
     struct c0sk *            handle,
@@ -31,6 +31,10 @@
 #include <hse/ikvdb/kvdb_rparams.h>
 #include <hse/ikvdb/rparam_debug_flags.h>
 #include <hse/ikvdb/kvdb_ctxn.h>
+#include <hse/ikvdb/rtomb.h>
+#include <hse/ikvdb/kvs_rparams.h>
+#include <hse/ikvdb/kvs_vcomp.h>
+#include <hse/ikvdb/vcomp_params.h>
 
 #include "c0sk_internal.h"
 #include "c0_ingest_work.h"
@@ -288,6 +292,119 @@ c0sk_bkv_sort_vals(struct bonsai_kv *bkv, struct bonsai_val **val_head)
     } while (unsorted > 0);
 }
 
+/**
+ * c0sk_ingest_bldr_create() - Create the kvset builder for the given kvs
+ *
+ * @ingest: ingest worker object
+ * @skidx:  kvs index
+ */
+static merr_t
+c0sk_ingest_bldr_create(struct c0_ingest_work *ingest, u16 skidx)
+{
+    struct c0sk_impl *    c0sk = c0sk_h2r(ingest->c0iw_c0sk);
+    struct cn *           cn = c0sk->c0sk_cnv[skidx];
+    struct kvset_builder *bldr;
+    merr_t                err;
+
+    assert(cn);
+    assert(!ingest->c0iw_bldrs[skidx]);
+
+    ingest->c0iw_kvsetidv[skidx] = cndb_kvsetid_mint(cn_get_cndb(cn));
+
+    err = kvset_builder_create(&bldr, cn, cn_get_ingest_perfc(cn), ingest->c0iw_kvsetidv[skidx]);
+    if (ev(err))
+        return err;
+
+    err = kvset_builder_set_agegroup(bldr, HSE_MPOLICY_AGE_ROOT);
+    if (err) {
+        kvset_builder_destroy(bldr);
+        return err;
+    }
+
+    ingest->c0iw_bldrs[skidx] = bldr;
+
+    return 0;
+}
+
+/**
+ * c0sk_ingest_rtombs() - Add the range tombstones of the kvms to the kvset builders
+ *
+ * @ingest: ingest worker object
+ * @kvms:   kvms being ingested
+ *
+ * A kvs that received only range deletes still needs a kvset (with an
+ * hblock but no kblocks) so that the rtombs reach cn.
+ */
+static merr_t
+c0sk_ingest_rtombs(struct c0_ingest_work *ingest, struct c0_kvmultiset *kvms)
+{
+    struct rtomb *rt;
+    merr_t        err;
+
+    for (rt = c0kvms_rtomb_first(kvms); rt; rt = rt->rt_next) {
+        if (!ingest->c0iw_bldrs[rt->rt_skidx]) {
+            err = c0sk_ingest_bldr_create(ingest, rt->rt_skidx);
+            if (ev(err))
+                return err;
+        }
+
+        err = kvset_builder_add_rtomb(ingest->c0iw_bldrs[rt->rt_skidx], rt);
+        if (ev(err))
+            return err;
+    }
+
+    return 0;
+}
+
+/**
+ * c0sk_ingest_vcomp() - Compress a value whose compression was deferred
+ *
+ * @ingest: ingest worker object
+ * @vc:     kvs value compression context
+ * @val:    value to compress
+ * @clen:   compressed length (output, zero if left uncompressed)
+ *
+ * Returns a pointer to the value to store, which is either the compressed
+ * value in the ingest worker's buffer or the original value.
+ */
+static const void *
+c0sk_ingest_vcomp(
+    struct c0_ingest_work   *ingest,
+    struct kvs_vcomp        *vc,
+    const struct bonsai_val *val,
+    uint                    *clen)
+{
+    uint ulen = bonsai_val_ulen(val);
+    uint bufsz;
+    merr_t err;
+
+    *clen = 0;
+
+    bufsz = kvs_vcomp_compress_bound(vc, ulen);
+    if (bufsz > ingest->c0iw_vcbufsz) {
+        bufsz = max_t(uint, roundup(bufsz, PAGE_SIZE), 64 * 1024);
+
+        free(ingest->c0iw_vcbuf);
+        ingest->c0iw_vcbuf = malloc(bufsz);
+        ingest->c0iw_vcbufsz = ingest->c0iw_vcbuf ? bufsz : 0;
+
+        if (ev(!ingest->c0iw_vcbuf))
+            return val->bv_value;
+    }
+
+    err = kvs_vcomp_compress(vc, val->bv_value, ulen, ingest->c0iw_vcbuf,
+                             ingest->c0iw_vcbufsz, clen);
+
+    /* Store the original value if compression fails or doesn't help.
+     */
+    if (err || *clen >= ulen) {
+        *clen = 0;
+        return val->bv_value;
+    }
+
+    return ingest->c0iw_vcbuf;
+}
+
 /**
  * c0sk_cningest_cb() - Callback function for bkv_collection. Called once for every pair of
  *                      key and its value list.
@@ -307,34 +424,28 @@ c0sk_cningest_cb(void *rock, struct bonsai_kv *bkv, struct bonsai_val *vlist)
 
     u16                    skidx = key_immediate_index(&bkv->bkv_key_imm);
     struct c0sk_impl *     c0sk = c0sk_h2r(ingest->c0iw_c0sk);
-    struct cn *            cn = c0sk->c0sk_cnv[skidx];
     struct kvset_builder **kvbldrs = ingest->c0iw_bldrs;
     struct kvset_builder * bldr = kvbldrs[skidx];
+    struct kvs_vcomp *     vc = NULL;
+    struct kvs_rparams *   rp;
 
     assert(bkv);
     assert(vlist);
 
     if (!bldr) {
-        assert(cn);
-
-        ingest->c0iw_kvsetidv[skidx] = cndb_kvsetid_mint(cn_get_cndb(cn));
-
-        err = kvset_builder_create(&bldr, cn, cn_get_ingest_perfc(cn),
-                                   ingest->c0iw_kvsetidv[skidx]);
+        err = c0sk_ingest_bldr_create(ingest, skidx);
         if (ev(err))
             return err;
 
-        err = kvset_builder_set_agegroup(bldr, HSE_MPOLICY_AGE_ROOT);
-        if (err) {
-            kvset_builder_destroy(bldr);
-            return err;
-        }
-
-        kvbldrs[skidx] = bldr;
+        bldr = kvbldrs[skidx];
     }
 
     c0sk_bkv_sort_vals(bkv, &vlist);
 
+    rp = cn_get_rp(c0sk->c0sk_cnv[skidx]);
+    if (rp && rp->value.compression.deferred && rp->value.compression.dflt == VCOMP_DEFAULT_ON)
+        vc = cn_get_vcomp(c0sk->c0sk_cnv[skidx]);
+
     seqno_prev = U64_MAX;
     pt_seqno_prev = U64_MAX;
     key2kobj(&ko, bkv->bkv_key, key_imm_klen(&bkv->bkv_key_imm));
@@ -343,6 +454,8 @@ c0sk_cningest_cb(void *rock, struct bonsai_kv *bkv, struct bonsai_val *vlist)
         enum hse_seqno_state state HSE_MAYBE_UNUSED;
         int                        rc;
         u64                        seqno = 0;
+        const void *               vdata = val->bv_value;
+        uint                       clen = bonsai_val_clen(val);
 
         state = seqnoref_to_seqno(val->bv_seqnoref, &seqno);
         assert(state == HSE_SQNREF_STATE_DEFINED);
@@ -359,8 +472,11 @@ c0sk_cningest_cb(void *rock, struct bonsai_kv *bkv, struct bonsai_val *vlist)
         else
             seqno_prev = seqno;
 
-        err = kvset_builder_add_val(
-            bldr, &ko, val->bv_value, bonsai_val_ulen(val), seqno, bonsai_val_clen(val));
+        if (vc && clen == 0 && bonsai_val_ulen(val) > VCOMP_VALUE_THRESHOLD &&
+            !HSE_CORE_IS_TOMB(vdata) && !(val->bv_flags & HSE_BTF_VCOMP_OFF))
+            vdata = c0sk_ingest_vcomp(ingest, vc, val, &clen);
+
+        err = kvset_builder_add_val(bldr, &ko, vdata, bonsai_val_ulen(val), seqno, clen);
 
         if (ev(err))
             return err;
@@ -696,6 +812,10 @@ c0sk_ingest_worker(struct work_struct *work)
 
     ingest->t7 = get_time_ns();
 
+    err = c0sk_ingest_rtombs(ingest, kvms);
+    if (ev(err))
+        goto health_err;
+
     for (i = 0; i < HSE_KVS_COUNT_MAX; ++i) {
         if (ingest->c0iw_bldrs[i] == 0)
             continue;
@@ -719,6 +839,10 @@ exit_err:
             bkv_collection_destroy(cn_list[i]);
     }
 
+    free(ingest->c0iw_vcbuf);
+    ingest->c0iw_vcbuf = NULL;
+    ingest->c0iw_vcbufsz = 0;
+
     if (debug)
         ingest->t8 = get_time_ns();
 
@@ -1256,7 +1380,12 @@ c0sk_putdel(
 
         kvs = c0kvms_get_hashed_c0kvset(dst, kt->kt_hash);
 
-        if (op == C0SK_OP_PUT) {
+        if (op == C0SK_OP_RANGE_DEL) {
+            /* The rtomb is passed in vt_data (see c0sk_range_del()).
+             */
+            kt->kt_seqno = c0kvms_rtomb_add(dst, vt->vt_data);
+            err = 0;
+        } else if (op == C0SK_OP_PUT) {
             err = c0kvs_put(kvs, skidx, kt, vt, seqnoref);
         } else if (op == C0SK_OP_DEL) {
             err = c0kvs_del(kvs, skidx, kt, seqnoref);
@@ -195,6 +195,7 @@ enum c0sk_op {
     C0SK_OP_PUT,
     C0SK_OP_DEL,
     C0SK_OP_PREFIX_DEL,
+    C0SK_OP_RANGE_DEL,
 };
 
 /**
@@ -0,0 +1,385 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#include <hse/util/alloc.h>
+#include <hse/util/assert.h>
+#include <hse/util/atomic.h>
+#include <hse/util/event_counter.h>
+#include <hse/util/log2.h>
+#include <hse/util/minmax.h>
+#include <hse/util/page.h>
+#include <hse/util/perfc.h>
+#include <hse/util/spinlock.h>
+#include <hse/logging/logging.h>
+
+#include <hse/kvdb_perfc.h>
+#include <hse/mpool/mpool.h>
+
+#include "bcache.h"
+
+#define BCACHE_SHARDS_MAX       (16)
+#define BCACHE_SHARD_PAGES_MIN  (256)
+
+enum bcache_state {
+    BCE_FREE,
+    BCE_LOADING,
+    BCE_VALID,
+};
+
+/**
+ * struct bcache_ent - a cached mblock page
+ * @be_next:  hash chain linkage (or free list linkage)
+ * @be_hash:  hash of (tag, mbid, pg)
+ * @be_tag:   kvset ID
+ * @be_mbid:  mblock ID
+ * @be_pg:    page number within the mblock
+ * @be_state: entry state
+ * @be_clock: referenced since the last pass of the clock hand
+ * @be_ref:   pin count
+ * @be_pc:    perfc set of the kvs to which this page is charged
+ * @be_page:  page data
+ */
+struct bcache_ent {
+    struct bcache_ent *be_next;
+    uint64_t           be_hash;
+    uint64_t           be_tag;
+    uint64_t           be_mbid;
+    uint32_t           be_pg;
+    uint8_t            be_state;
+    bool               be_clock;
+    atomic_int         be_ref;
+    struct perfc_set  *be_pc;
+    void              *be_page;
+};
+
+/**
+ * struct bcache_shard - an independently locked partition of the cache
+ * @bs_lock:  protects all fields and entries of the shard
+ * @bs_hand:  clock hand (index into bs_entv[])
+ * @bs_entc:  number of entries (pages) in the shard
+ * @bs_free:  list of free entries
+ * @bs_hmask: hash table and admission filter mask
+ * @bs_htab:  hash table
+ * @bs_ghost: admission filter of recently rejected value page hashes
+ * @bs_entv:  vector of entries
+ */
+struct bcache_shard {
+    spinlock_t          bs_lock;
+    uint                bs_hand;
+    uint                bs_entc;
+    struct bcache_ent  *bs_free;
+    uint64_t            bs_hmask;
+    struct bcache_ent **bs_htab;
+    uint32_t           *bs_ghost;
+    struct bcache_ent  *bs_entv;
+} HSE_L1D_ALIGNED;
+
+struct bcache {
+    void               *bc_pages;
+    size_t              bc_pagesz;
+    uint                bc_shardc;
+    struct bcache_shard bc_shardv[];
+};
+
+static HSE_ALWAYS_INLINE uint64_t
+bcache_hash(uint64_t tag, uint64_t mbid, uint32_t pg)
+{
+    uint64_t h;
+
+    h = (mbid ^ (tag << 32) ^ (tag >> 32)) * 0x9e3779b97f4a7c15ul;
+    h ^= (h >> 29) + pg * 0xbf58476d1ce4e5b9ul;
+    h *= 0x94d049bb133111ebul;
+
+    return h ^ (h >> 31);
+}
+
+static void
+bcache_unlink(struct bcache_shard *bs, struct bcache_ent *ent)
+{
+    struct bcache_ent **pp = bs->bs_htab + (ent->be_hash & bs->bs_hmask);
+
+    while (*pp != ent)
+        pp = &(*pp)->be_next;
+
+    *pp = ent->be_next;
+}
+
+static void
+bcache_free(struct bcache_shard *bs, struct bcache_ent *ent)
+{
+    if (ent->be_state == BCE_VALID)
+        perfc_sub(ent->be_pc, PERFC_BA_CNBCACHE_BYTES, PAGE_SIZE);
+
+    bcache_unlink(bs, ent);
+
+    ent->be_state = BCE_FREE;
+    ent->be_pc = NULL;
+    ent->be_next = bs->bs_free;
+    bs->bs_free = ent;
+}
+
+/* Find a free entry, evicting the first unpinned page the clock hand
+ * finds that has not been referenced since the hand last passed it.
+ */
+static struct bcache_ent *
+bcache_alloc(struct bcache_shard *bs)
+{
+    struct bcache_ent *ent;
+    uint n;
+
+    if (bs->bs_free) {
+        ent = bs->bs_free;
+        bs->bs_free = ent->be_next;
+        return ent;
+    }
+
+    for (n = bs->bs_entc * 2; n > 0; --n) {
+        ent = bs->bs_entv + bs->bs_hand;
+
+        if (++bs->bs_hand >= bs->bs_entc)
+            bs->bs_hand = 0;
+
+        if (ent->be_state != BCE_VALID || atomic_read(&ent->be_ref) > 0)
+            continue;
+
+        if (ent->be_clock) {
+            ent->be_clock = false;
+            continue;
+        }
+
+        perfc_sub(ent->be_pc, PERFC_BA_CNBCACHE_BYTES, PAGE_SIZE);
+        bcache_unlink(bs, ent);
+
+        return ent;
+    }
+
+    return NULL;
+}
+
+const void *
+bcache_get(const struct bcache_ref *ref, uint32_t pg, enum bcache_type type,
+           struct bcache_ent **entp)
+{
+    struct bcache *bc = ref->br_bc;
+    struct bcache_shard *bs;
+    struct bcache_ent *ent;
+    struct iovec iov;
+    uint64_t hash;
+    merr_t err;
+
+    hash = bcache_hash(ref->br_tag, ref->br_mbid, pg);
+    bs = bc->bc_shardv + (hash >> 40) % bc->bc_shardc;
+
+    spin_lock(&bs->bs_lock);
+    for (ent = bs->bs_htab[hash & bs->bs_hmask]; ent; ent = ent->be_next) {
+        if (ent->be_hash == hash && ent->be_pg == pg && ent->be_mbid == ref->br_mbid &&
+            ent->be_tag == ref->br_tag)
+            break;
+    }
+
+    if (ent) {
+        /* If another thread is loading the page then don't wait for it.
+         */
+        if (ent->be_state != BCE_VALID) {
+            spin_unlock(&bs->bs_lock);
+            return NULL;
+        }
+
+        atomic_inc(&ent->be_ref);
+        ent->be_clock = true;
+        spin_unlock(&bs->bs_lock);
+
+        perfc_inc(ref->br_pc, PERFC_RA_CNBCACHE_HIT);
+        *entp = ent;
+
+        return ent->be_page;
+    }
+
+    perfc_inc(ref->br_pc, PERFC_RA_CNBCACHE_MISS);
+
+    /* Admit value pages only if they were rejected recently.
+     */
+    if (type == BCACHE_VALUE) {
+        uint32_t *ghost = bs->bs_ghost + ((hash >> 20) & bs->bs_hmask);
+        uint32_t fp = (hash >> 32) | 1;
+
+        if (*ghost != fp) {
+            *ghost = fp;
+            spin_unlock(&bs->bs_lock);
+            perfc_inc(ref->br_pc, PERFC_RA_CNBCACHE_REJECT);
+            return NULL;
+        }
+
+        *ghost = 0;
+    }
+
+    ent = bcache_alloc(bs);
+    if (!ent) {
+        spin_unlock(&bs->bs_lock);
+        perfc_inc(ref->br_pc, PERFC_RA_CNBCACHE_REJECT);
+        return NULL;
+    }
+
+    ent->be_hash = hash;
+    ent->be_tag = ref->br_tag;
+    ent->be_mbid = ref->br_mbid;
+    ent->be_pg = pg;
+    ent->be_state = BCE_LOADING;
+    ent->be_clock = false;
+    ent->be_pc = ref->br_pc;
+    atomic_set(&ent->be_ref, 1);
+
+    ent->be_next = bs->bs_htab[hash & bs->bs_hmask];
+    bs->bs_htab[hash & bs->bs_hmask] = ent;
+    spin_unlock(&bs->bs_lock);
+
+    iov.iov_base = ent->be_page;
+    iov.iov_len = PAGE_SIZE;
+
+    err = mpool_mblock_read(ref->br_mp, ref->br_mbid, &iov, 1, (off_t)pg * PAGE_SIZE);
+
+    spin_lock(&bs->bs_lock);
+    if (ev(err)) {
+        atomic_set(&ent->be_ref, 0);
+        bcache_free(bs, ent);
+        spin_unlock(&bs->bs_lock);
+        return NULL;
+    }
+
+    ent->be_state = BCE_VALID;
+    spin_unlock(&bs->bs_lock);
+
+    perfc_add(ref->br_pc, PERFC_BA_CNBCACHE_BYTES, PAGE_SIZE);
+    *entp = ent;
+
+    return ent->be_page;
+}
+
+void
+bcache_put(struct bcache_ent *ent)
+{
+    if (ent) {
+        assert(atomic_read(&ent->be_ref) > 0);
+        atomic_dec(&ent->be_ref);
+    }
+}
+
+void
+bcache_purge(struct bcache *bc, struct perfc_set *pc)
+{
+    if (!bc)
+        return;
+
+    for (uint i = 0; i < bc->bc_shardc; ++i) {
+        struct bcache_shard *bs = bc->bc_shardv + i;
+
+        spin_lock(&bs->bs_lock);
+        for (uint j = 0; j < bs->bs_entc; ++j) {
+            struct bcache_ent *ent = bs->bs_entv + j;
+
+            if (ent->be_state == BCE_FREE || ent->be_pc != pc)
+                continue;
+
+            assert(atomic_read(&ent->be_ref) == 0);
+            bcache_free(bs, ent);
+        }
+        spin_unlock(&bs->bs_lock);
+    }
+}
+
+merr_t
+bcache_create(size_t size, struct bcache **bc_out)
+{
+    struct bcache_ent **htab, *entv;
+    struct bcache *bc;
+    uint32_t *ghost;
+    size_t pagec, hsize;
+    uint shardc, entc;
+    size_t bcsz;
+    void *pages;
+
+    if (ev(!bc_out))
+        return merr(EINVAL);
+
+    pagec = size / PAGE_SIZE;
+    shardc = clamp_t(size_t, pagec / BCACHE_SHARD_PAGES_MIN, 1, BCACHE_SHARDS_MAX);
+    entc = max_t(size_t, pagec / shardc, BCACHE_SHARD_PAGES_MIN);
+    pagec = (size_t)entc * shardc;
+    hsize = roundup_pow_of_two(entc);
+
+    bcsz = sizeof(*bc) + sizeof(bc->bc_shardv[0]) * shardc;
+
+    bc = aligned_alloc(__alignof__(*bc), ALIGN(bcsz, __alignof__(*bc)));
+    if (ev(!bc))
+        return merr(ENOMEM);
+
+    entv = calloc(pagec, sizeof(*entv));
+    htab = calloc(hsize * shardc, sizeof(*htab));
+    ghost = calloc(hsize * shardc, sizeof(*ghost));
+
+    /* Prefault the pages so that first-touch faults do not land on the
+     * lookup path.
+     */
+    pages = mmap(NULL, pagec * PAGE_SIZE, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+
+    if (ev(!entv || !htab || !ghost || pages == MAP_FAILED)) {
+        if (pages != MAP_FAILED)
+            munmap(pages, pagec * PAGE_SIZE);
+        free(ghost);
+        free(htab);
+        free(entv);
+        free(bc);
+        return merr(ENOMEM);
+    }
+
+    bc->bc_pages = pages;
+    bc->bc_pagesz = pagec * PAGE_SIZE;
+    bc->bc_shardc = shardc;
+
+    for (uint i = 0; i < shardc; ++i) {
+        struct bcache_shard *bs = bc->bc_shardv + i;
+
+        memset(bs, 0, sizeof(*bs));
+        spin_lock_init(&bs->bs_lock);
+        bs->bs_entc = entc;
+        bs->bs_hmask = hsize - 1;
+        bs->bs_htab = htab + i * hsize;
+        bs->bs_ghost = ghost + i * hsize;
+        bs->bs_entv = entv + i * entc;
+
+        for (uint j = 0; j < entc; ++j) {
+            struct bcache_ent *ent = bs->bs_entv + j;
+
+            ent->be_page = pages + ((size_t)i * entc + j) * PAGE_SIZE;
+            atomic_set(&ent->be_ref, 0);
+
+            ent->be_next = bs->bs_free;
+            bs->bs_free = ent;
+        }
+    }
+
+    log_info("block cache: %zu MiB, %u shards", bc->bc_pagesz >> 20, shardc);
+
+    *bc_out = bc;
+
+    return 0;
+}
+
+void
+bcache_destroy(struct bcache *bc)
+{
+    if (!bc)
+        return;
+
+    munmap(bc->bc_pages, bc->bc_pagesz);
+    free(bc->bc_shardv[0].bs_ghost);
+    free(bc->bc_shardv[0].bs_htab);
+    free(bc->bc_shardv[0].bs_entv);
+    free(bc);
+}
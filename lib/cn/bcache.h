@@ -0,0 +1,104 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_KVS_CN_BCACHE_H
+#define HSE_KVS_CN_BCACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <hse/error/merr.h>
+
+/* The block cache is an optional per-kvdb cache of kblock and vblock pages
+ * that is filled by direct (O_DIRECT) mblock reads.  It has a fixed byte
+ * budget which is allocated up front, so its memory footprint is
+ * independent of the kernel page cache and of the other kvdbs on the host.
+ *
+ * Pages are identified by (tag, mbid, page) where the tag is the kvset ID,
+ * so that pages from a deleted kvset can never be found after its mblocks
+ * are reused.  Such pages are simply aged out by the clock.
+ *
+ * Index pages (wbt nodes and bloom filter pages) are admitted on first
+ * miss.  Value pages are admitted only on their second miss within a
+ * short window so that single-touch reads don't displace the index.
+ *
+ * Each cached page is charged to the perfc set of the kvs that loaded it
+ * (resident bytes, hits, misses and rejected admissions).
+ */
+
+struct bcache;
+struct bcache_ent;
+struct mpool;
+struct perfc_set;
+
+enum bcache_type {
+    BCACHE_INDEX,
+    BCACHE_VALUE,
+};
+
+/**
+ * struct bcache_ref - identifies an mblock to the block cache
+ * @br_bc:   block cache
+ * @br_pc:   perfc set of the owning kvs
+ * @br_mp:   mpool from which to read missing pages
+ * @br_tag:  kvset ID of the kvset that owns the mblock
+ * @br_mbid: mblock ID
+ */
+struct bcache_ref {
+    struct bcache    *br_bc;
+    struct perfc_set *br_pc;
+    struct mpool     *br_mp;
+    uint64_t          br_tag;
+    uint64_t          br_mbid;
+};
+
+/**
+ * bcache_create() - create a block cache
+ * @size:   cache size in bytes
+ * @bc_out: block cache (output)
+ */
+merr_t
+bcache_create(size_t size, struct bcache **bc_out);
+
+/**
+ * bcache_destroy() - destroy a block cache
+ * @bc: block cache (may be NULL)
+ */
+void
+bcache_destroy(struct bcache *bc);
+
+/**
+ * bcache_get() - get a pinned, cached copy of an mblock page
+ * @ref:  mblock reference
+ * @pg:   page number within the mblock
+ * @type: page type (for admission)
+ * @entp: (output) handle to pass to bcache_put()
+ *
+ * Return: Returns a pointer to the page data, or NULL if the page is not
+ * cached and could not be admitted, in which case the caller must read the
+ * page by other means.  A non-NULL page remains valid until bcache_put().
+ */
+const void *
+bcache_get(const struct bcache_ref *ref, uint32_t pg, enum bcache_type type,
+           struct bcache_ent **entp);
+
+/**
+ * bcache_put() - unpin a page obtained via bcache_get()
+ * @ent: page handle (may be NULL)
+ */
+void
+bcache_put(struct bcache_ent *ent);
+
+/**
+ * bcache_purge() - drop all pages charged to the given perfc set
+ * @bc: block cache
+ * @pc: perfc set of the kvs being closed
+ *
+ * None of the pages to be dropped may be pinned.
+ */
+void
+bcache_purge(struct bcache *bc, struct perfc_set *pc);
+
+#endif
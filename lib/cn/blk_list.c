@@ -42,10 +42,13 @@ commit_mblocks(struct mpool *mp, struct blk_list *blks)
     INVARIANT(mp);
     INVARIANT(blks);
 
-    for (uint32_t i = 0; i < blks->idc; i++) {
-        err = commit_mblock(mp, blks->idv[i]);
-        if (err)
-            return err;
+    if (blks->idc == 0)
+        return 0;
+
+    err = mpool_mblock_commitv(mp, blks->idv, blks->idc);
+    if (err) {
+        log_errx("Failed to commit %u mblocks, blkid 0x%lx", err, blks->idc, blks->idv[0]);
+        return err;
     }
 
     return 0;
@@ -66,13 +69,26 @@ delete_mblock(struct mpool *mp, uint64_t mbid)
 void
 delete_mblocks(struct mpool *mp, struct blk_list *blks)
 {
+    merr_t err;
+
     INVARIANT(mp);
     INVARIANT(blks);
 
-    for (uint32_t i = 0; i < blks->idc; i++) {
-        delete_mblock(mp, blks->idv[i]);
-        blks->idv[i] = 0;
+    if (blks->idc == 0)
+        return;
+
+    /* Delete the whole list with one metadata sync per media class.  If
+     * that fails, retry one at a time so that a single bad mblock doesn't
+     * leak all the others.
+     */
+    err = mpool_mblock_deletev(mp, blks->idv, blks->idc);
+    if (err) {
+        for (uint32_t i = 0; i < blks->idc; i++)
+            delete_mblock(mp, blks->idv[i]);
     }
+
+    for (uint32_t i = 0; i < blks->idc; i++)
+        blks->idv[i] = 0;
 }
 
 void
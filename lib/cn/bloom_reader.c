@@ -5,8 +5,11 @@
 
 #include <hse/util/page.h>
 #include <hse/util/bloom_filter.h>
+#include <hse/util/fuse_filter.h>
 
 #include "bloom_reader.h"
+#include "bcache.h"
+#include "omf.h"
 
 /* [HSE_REVISIT] bloom_filter.[ch] provides an abstracted data type for a bloom
  * filter, but does not provide for creation of a self-managed bloom filter
@@ -17,19 +20,79 @@
  * so that clients (such as what we see here) need not have to manage
  * the details.
  */
+
+/* A fuse filter lookup reads three fingerprints from adjacent segments,
+ * which may reside on up to three different pages.  A fingerprint never
+ * spans a page boundary.
+ */
+static bool
+bloom_reader_fuse_lookup(
+    const struct bloom_desc *desc,
+    const struct bcache_ref *bcr,
+    uint64_t                 hash)
+{
+    const uint32_t fpbytes = desc->bd_fpbits / 8;
+    const uint64_t h = fuse_mix(hash, desc->bd_seed);
+    uint32_t posv[FUSE_ARITY];
+    uint32_t fp;
+
+    fuse_hash2pos(h, desc->bd_seglen, desc->bd_modulus, posv);
+
+    fp = fuse_fingerprint(h, desc->bd_fpbits);
+
+    for (uint i = 0; i < FUSE_ARITY; ++i) {
+        const size_t off = (size_t)posv[i] * fpbytes;
+        const uint8_t *page = NULL;
+        struct bcache_ent *ent;
+
+        if (bcr)
+            page = bcache_get(bcr, desc->bd_first_page + off / PAGE_SIZE, BCACHE_INDEX, &ent);
+
+        if (page) {
+            fp ^= fuse_fp_get(page, desc->bd_fpbits, (off % PAGE_SIZE) / fpbytes);
+            bcache_put(ent);
+        } else {
+            fp ^= fuse_fp_get(desc->bd_bitmap, desc->bd_fpbits, posv[i]);
+        }
+    }
+
+    return fp == 0;
+}
+
 bool
 bloom_reader_lookup(
     const struct bloom_desc *desc,
+    const struct bcache_ref *bcr,
     uint64_t                 hash)
 {
     const uint8_t *bitmap = desc->bd_bitmap;
+    struct bcache_ent *ent;
     size_t bkt;
+    bool hit;
 
     if (!bitmap)
         return true;
 
+    if (desc->bd_type == BLOOM_OMF_FUSE)
+        return bloom_reader_fuse_lookup(desc, bcr, hash);
+
     bkt = bf_hash2bkt(hash, desc->bd_modulus, desc->bd_bktshift);
 
+    /* A bucket never spans a page boundary, so only the page containing
+     * the bucket need be cached.
+     */
+    if (bcr) {
+        const uint8_t *page;
+
+        page = bcache_get(bcr, desc->bd_first_page + bkt / PAGE_SIZE, BCACHE_INDEX, &ent);
+        if (page) {
+            hit = bf_lookup(hash, page + (bkt % PAGE_SIZE), desc->bd_n_hashes, desc->bd_rotl,
+                            desc->bd_bktmask);
+            bcache_put(ent);
+            return hit;
+        }
+    }
+
     bitmap += (bkt / PAGE_SIZE) * PAGE_SIZE + (bkt % PAGE_SIZE);
 
     return bf_lookup(hash, bitmap, desc->bd_n_hashes, desc->bd_rotl, desc->bd_bktmask);
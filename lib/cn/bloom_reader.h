@@ -8,12 +8,19 @@
 
 #include <hse/util/inttypes.h>
 
+struct bcache_ref;
+
 /**
  * struct bloom_desc - a descriptor for reading data from a Bloom filter
  * @bd_bitmap:      base address of bloom filter data in virtual memory
  * @bd_n_pages:     size of data region in pages
  * @bd_n_hashes:
  * @bd_first_page:  offset, in pages, from start of mblock to data region
+ * @bd_type:        filter type (enum bloom_omf_type)
+ * @bd_fpbits:      bits per fingerprint (fuse)
+ * @bd_seglen:      fingerprints per segment (fuse)
+ * @bd_seed:        hash seed (fuse)
+ * @bd_pfxlen:      key prefix length (prefix filter), zero for a key filter
  *
  * When a kblock is opened for reading, the @bloom_hdr_omf struct is read from
  * media and the relevant information is stored in a @bloom_desc struct.
@@ -34,16 +41,23 @@ struct bloom_desc {
     uint32_t  bd_bktmask;
     uint32_t  bd_first_page;
     uint32_t  bd_bktsz;
+    uint32_t  bd_type;
+    uint32_t  bd_fpbits;
+    uint32_t  bd_seglen;
+    uint32_t  bd_seed;
+    uint32_t  bd_pfxlen;
 };
 
 /**
  * bloom_reader_lookup() -
  * @desc:  bloom descriptor
+ * @bcr:   block cache reference for bloom pages (may be NULL)
  * @hash:  hash of key to lookup
  */
 bool
 bloom_reader_lookup(
     const struct bloom_desc *desc,
+    const struct bcache_ref *bcr,
     uint64_t                 hash);
 
 #endif
@@ -22,6 +22,7 @@
 #include <hse/rest/server.h>
 #include <hse/rest/status.h>
 #include <hse/util/alloc.h>
+#include <hse/util/condvar.h>
 #include <hse/util/event_counter.h>
 #include <hse/util/log2.h>
 #include <hse/util/map.h>
@@ -57,6 +58,8 @@
 #include "cn_mblocks.h"
 #include "cn_cursor.h"
 #include "route.h"
+#include "bcache.h"
+#include "rcache.h"
 
 #include "omf.h"
 #include "kvset.h"
@@ -173,6 +176,18 @@ cn_get_mpool(const struct cn *cn)
     return cn->cn_dataset;
 }
 
+void
+cn_set_vcomp(struct cn *cn, struct kvs_vcomp *vcomp)
+{
+    cn->cn_vcomp = vcomp;
+}
+
+struct kvs_vcomp *
+cn_get_vcomp(const struct cn *cn)
+{
+    return cn->cn_vcomp;
+}
+
 void *
 cn_get_tree(const struct cn *handle)
 {
@@ -197,6 +212,12 @@ cn_get_maint_wq(struct cn *cn)
     return cn ? cn->cn_maint_wq : NULL;
 }
 
+struct workqueue_struct *
+cn_get_ra_wq(struct cn *cn)
+{
+    return cn->cn_ra_wq;
+}
+
 struct csched *
 cn_get_sched(struct cn *cn)
 {
@@ -242,6 +263,12 @@ cn_pc_capped_get(struct cn *cn)
     return &cn->cn_pc_capped;
 }
 
+struct perfc_set *
+cn_pc_bcache_get(struct cn *cn)
+{
+    return &cn->cn_pc_bcache;
+}
+
 /**
  * cn_ref_get() - acquire a reference on a cn object
  *
@@ -350,7 +377,60 @@ cn_get(
     enum key_lookup_res *res,
     struct kvs_buf *     vbuf)
 {
-    return cn_tree_lookup(cn->cn_tree, &cn->cn_pc_get, kt, seq, res, NULL, vbuf);
+    struct rcache *rc = cn->cn_rcache;
+    uint64_t cookie = 0;
+    merr_t err;
+
+    if (rc) {
+        if (rcache_lookup(rc, kt, seq, res, vbuf))
+            return 0;
+
+        cookie = rcache_fill_begin(rc, seq);
+    }
+
+    err = cn_tree_lookup(cn->cn_tree, &cn->cn_pc_get, kt, seq, res, NULL, vbuf);
+
+    if (cookie && !err)
+        rcache_fill(rc, cookie, kt, (*res == NOT_FOUND) ? 0 : kt->kt_seqno, *res, vbuf);
+
+    return err;
+}
+
+void
+cn_rcache_invalidate(struct cn *cn, const struct kvs_ktuple *kt)
+{
+    if (!cn->cn_rcache)
+        return;
+
+    if (kt)
+        rcache_invalidate(cn->cn_rcache, kt);
+    else
+        rcache_flush(cn->cn_rcache, 0);
+}
+
+merr_t
+cn_get_multi(
+    struct cn *          cn,
+    uint                 count,
+    struct kvs_ktuple *  ktv,
+    u64                  seq,
+    enum key_lookup_res *resv,
+    struct kvs_buf *     vbufv)
+{
+    return cn_tree_lookup_multi(cn->cn_tree, &cn->cn_pc_get, count, ktv, seq, resv, vbufv);
+}
+
+void
+cn_rtombs_set(struct cn *cn)
+{
+    if (!atomic_read(&cn->cn_rtombs))
+        atomic_set(&cn->cn_rtombs, 1);
+}
+
+bool
+cn_has_rtombs(struct cn *cn)
+{
+    return atomic_read(&cn->cn_rtombs);
 }
 
 merr_t
@@ -366,6 +446,20 @@ cn_pfx_probe(
     return cn_tree_prefix_probe(cn->cn_tree, &cn->cn_pc_get, kt, seq, res, qctx, kbuf, vbuf);
 }
 
+uint
+cn_range_split(
+    struct cn  *cn,
+    const void *min,
+    uint        minlen,
+    const void *max,
+    uint        maxlen,
+    uint        splitc_max,
+    void       *keybufv,
+    uint       *keylenv)
+{
+    return cn_tree_range_split(cn->cn_tree, min, minlen, max, maxlen, splitc_max, keybufv, keylenv);
+}
+
 merr_t
 cn_mblocks_commit(
     struct mpool         *mp,
@@ -373,35 +467,37 @@ cn_mblocks_commit(
     struct kvset_mblocks *list,
     enum cn_mutation      mutation)
 {
+    struct blk_list blks;
     merr_t err = 0;
-    u32    i;
-
-    for (i = 0; i < num_lists; i++) {
-        /* This check is similar to the check in commit_mblocks() where the
-         * bounds on the for loop uses the block count of the block list. Here
-         * we always have at least 1 hblock to validate, and we do that by
-         * checking to make sure the hblock's block ID is valid prior to
-         * committing it.
-         */
-        if (list[i].hblk_id) {
-            err = commit_mblock(mp, list[i].hblk_id);
-            if (ev(err)) {
-                return err;
-            }
-        }
+    u32    i, j;
 
-        err = commit_mblocks(mp, &list[i].kblks);
-        if (ev(err))
-            return err;
+    /* Gather the mblocks of all kvsets into one vector so that the whole
+     * batch is committed with one metadata sync per media class rather
+     * than one per mblock.
+     */
+    blk_list_init(&blks);
 
-        if (mutation != CN_MUT_KCOMPACT) {
-            err = commit_mblocks(mp, &list[i].vblks);
-            if (ev(err))
-                return err;
-        }
+    for (i = 0; i < num_lists && !err; i++) {
+        if (list[i].hblk_id)
+            err = blk_list_append(&blks, list[i].hblk_id);
+
+        for (j = 0; j < list[i].kblks.idc && !err; j++)
+            err = blk_list_append(&blks, list[i].kblks.idv[j]);
+
+        /* K-compaction adopts the vblocks of its input kvsets, which are
+         * already committed, and writes only the values it had to move.
+         */
+        j = (mutation == CN_MUT_KCOMPACT) ? list[i].bl_vadopted : 0;
+        for (; j < list[i].vblks.idc && !err; j++)
+            err = blk_list_append(&blks, list[i].vblks.idv[j]);
     }
 
-    return 0;
+    if (!err)
+        err = commit_mblocks(mp, &blks);
+
+    blk_list_free(&blks);
+
+    return err;
 }
 
 void
@@ -416,8 +512,16 @@ cn_mblocks_destroy(
         list[i].hblk_id = 0;
 
         delete_mblocks(mp, &list[i].kblks);
-        if (!kcompact)
+        if (!kcompact) {
             delete_mblocks(mp, &list[i].vblks);
+        } else if (list[i].vblks.idc > list[i].bl_vadopted) {
+            struct blk_list written = {
+                .idv = list[i].vblks.idv + list[i].bl_vadopted,
+                .idc = list[i].vblks.idc - list[i].bl_vadopted,
+            };
+
+            delete_mblocks(mp, &written);
+        }
     }
 }
 
@@ -701,6 +805,10 @@ cn_ingestv(
             mbv[i]->bl_last_ptlen,
             mbv[i]->bl_last_ptseq);
 
+        /* Cached lookup results may now be shadowed by the new kvset.
+         */
+        rcache_flush(cn[i]->cn_rcache, mbv[i]->bl_seqno_max);
+
         kvsetv[i] = NULL;
 
         check--;
@@ -764,14 +872,43 @@ cn_maint_task(struct work_struct *work)
                        msecs_to_jiffies(cn->rp->cn_maint_delay));
 }
 
+/* Kvsets are opened in parallel on the cn io workqueue at kvdb open.  Each
+ * open job owns a private copy of the kvset meta from cndb, and is inserted
+ * into its node by cn_open() after all the jobs have completed.  The jobs
+ * are counted in their cndb_cn_ctx so that cn_open() waits only for its own
+ * jobs rather than for all the work on the kvdb-wide workqueue.
+ */
+struct cndb_cn_open_work {
+    struct work_struct   ow_work;
+    struct list_head     ow_link;
+    struct cndb_cn_ctx  *ow_ctx;
+    struct cn_tree      *ow_tree;
+    struct cn_tree_node *ow_node;
+    struct kvset        *ow_kvset;
+    uint64_t             ow_kvsetid;
+    merr_t               ow_err;
+    struct kvset_meta    ow_km;
+};
+
 struct cndb_cn_ctx {
-    struct cn_tree *tree;
-    struct map     *nodemap;
-    uint64_t        max_dgen;
+    struct cn_tree          *tree;
+    struct map              *nodemap;
+    uint64_t                 max_dgen;
+    uint64_t                 max_seqno;
+    bool                     rtombs;
+    struct workqueue_struct *wq;
+    struct list_head         openl;
+    struct mutex             open_lock;
+    struct cv                open_cv;
+    uint                     open_pending;
 };
 
 static merr_t
-cndb_cn_ctx_init(struct cndb_cn_ctx *ctx, struct cn_tree *tree, struct cn_tree_node *root)
+cndb_cn_ctx_init(
+    struct cndb_cn_ctx      *ctx,
+    struct cn_tree          *tree,
+    struct cn_tree_node     *root,
+    struct workqueue_struct *wq)
 {
     struct map *nodemap;
     merr_t err;
@@ -794,33 +931,146 @@ cndb_cn_ctx_init(struct cndb_cn_ctx *ctx, struct cn_tree *tree, struct cn_tree_n
     ctx->nodemap = nodemap;
     ctx->tree = tree;
     ctx->max_dgen = 0;
+    ctx->max_seqno = 0;
+    ctx->rtombs = false;
+    ctx->wq = wq;
+    INIT_LIST_HEAD(&ctx->openl);
+    mutex_init(&ctx->open_lock);
+    cv_init(&ctx->open_cv);
+    ctx->open_pending = 0;
 
     return 0;
 }
 
+static void
+cndb_cn_open_work_free(struct cndb_cn_open_work *ow)
+{
+    blk_list_free(&ow->ow_km.km_kblk_list);
+    blk_list_free(&ow->ow_km.km_vblk_list);
+    free(ow);
+}
+
 static void
 cndb_cn_ctx_fini(struct cndb_cn_ctx *ctx)
 {
+    struct cndb_cn_open_work *ow, *next;
+
     INVARIANT(ctx);
     INVARIANT(ctx->nodemap);
+    INVARIANT(ctx->open_pending == 0);
 
+    /* Release the kvsets of any open jobs that were not consumed by
+     * cndb_cn_ctx_insert() (e.g., due to an error).
+     */
+    list_for_each_entry_safe(ow, next, &ctx->openl, ow_link) {
+        if (ow->ow_kvset)
+            kvset_put_ref(ow->ow_kvset);
+        cndb_cn_open_work_free(ow);
+    }
+
+    cv_destroy(&ctx->open_cv);
+    mutex_destroy(&ctx->open_lock);
     map_destroy(ctx->nodemap);
 }
 
+static void
+cndb_cn_open_worker(struct work_struct *work)
+{
+    struct cndb_cn_open_work *ow = container_of(work, struct cndb_cn_open_work, ow_work);
+    struct cndb_cn_ctx *ctx = ow->ow_ctx;
+
+    ow->ow_err = kvset_open(ow->ow_tree, ow->ow_kvsetid, &ow->ow_km, &ow->ow_kvset);
+
+    mutex_lock(&ctx->open_lock);
+    if (--ctx->open_pending == 0)
+        cv_broadcast(&ctx->open_cv);
+    mutex_unlock(&ctx->open_lock);
+}
+
+/* Wait for all the open jobs queued by cndb_cn_callback() to complete.
+ */
+static void
+cndb_cn_ctx_wait(struct cndb_cn_ctx *ctx)
+{
+    mutex_lock(&ctx->open_lock);
+    while (ctx->open_pending > 0)
+        cv_wait(&ctx->open_cv, &ctx->open_lock, "cnopen");
+    mutex_unlock(&ctx->open_lock);
+}
+
+static merr_t
+cndb_cn_km_copy(struct kvset_meta *dst, const struct kvset_meta *src)
+{
+    merr_t err = 0;
+
+    *dst = *src;
+    blk_list_init(&dst->km_kblk_list);
+    blk_list_init(&dst->km_vblk_list);
+
+    for (uint32_t i = 0; i < src->km_kblk_list.idc && !err; i++)
+        err = blk_list_append(&dst->km_kblk_list, src->km_kblk_list.idv[i]);
+
+    for (uint32_t i = 0; i < src->km_vblk_list.idc && !err; i++)
+        err = blk_list_append(&dst->km_vblk_list, src->km_vblk_list.idv[i]);
+
+    return err;
+}
+
+/* Insert the kvsets opened by the (completed) open jobs into their nodes
+ * in the order in which cndb presented them.
+ */
+static merr_t
+cndb_cn_ctx_insert(struct cndb_cn_ctx *ctx)
+{
+    struct cndb_cn_open_work *ow, *next;
+    merr_t err = 0;
+
+    list_for_each_entry(ow, &ctx->openl, ow_link) {
+        if (ow->ow_err) {
+            err = ow->ow_err;
+            break;
+        }
+    }
+
+    if (ev(err))
+        return err;
+
+    list_for_each_entry_safe(ow, next, &ctx->openl, ow_link) {
+        err = cn_node_insert_kvset(ow->ow_node, ow->ow_kvset);
+        if (ev(err))
+            return err;
+
+        if (ctx->max_dgen < ow->ow_km.km_dgen_hi)
+            ctx->max_dgen = ow->ow_km.km_dgen_hi;
+
+        if (ctx->max_seqno < kvset_get_seqno_max(ow->ow_kvset))
+            ctx->max_seqno = kvset_get_seqno_max(ow->ow_kvset);
+
+        if (kvset_get_rtombs(ow->ow_kvset)->rv_cnt > 0)
+            ctx->rtombs = true;
+
+        list_del(&ow->ow_link);
+        cndb_cn_open_work_free(ow);
+    }
+
+    return 0;
+}
+
 /*
  * Callback invoked by cndb_cn_instantiate() to place kvsets into tree nodes.
  *
  * This callback is invoked once for each kvset in a KVS.  Each callback
  * contains a node ID, a kvset ID, and other metadata needed to open the
- * on-media kvset.  It opens the kvsets and adds them to tree nodes, creating
- * the tree nodes as needed.
+ * on-media kvset.  It creates the tree nodes as needed and queues a job to
+ * open the kvset on the cn io workqueue.  The opened kvsets are added to
+ * their tree nodes by cndb_cn_ctx_insert().
  */
 static merr_t
 cndb_cn_callback(void *arg, struct kvset_meta *km, u64 kvsetid)
 {
     struct cndb_cn_ctx *ctx = arg;
+    struct cndb_cn_open_work *ow;
     struct cn_tree_node *node;
-    struct kvset *kvset;
     merr_t err;
 
     node = map_lookup_ptr(ctx->nodemap, km->km_nodeid);
@@ -835,18 +1085,33 @@ cndb_cn_callback(void *arg, struct kvset_meta *km, u64 kvsetid)
         ctx->tree->ct_fanout++;
     }
 
-    err = kvset_open(ctx->tree, kvsetid, km, &kvset);
-    if (ev(err))
-        return err;
+    ow = calloc(1, sizeof(*ow));
+    if (ev(!ow))
+        return merr(ENOMEM);
 
-    err = cn_node_insert_kvset(node, kvset);
+    /* cndb reclaims km's block lists when the callback returns.
+     */
+    err = cndb_cn_km_copy(&ow->ow_km, km);
     if (ev(err)) {
-        kvset_put_ref(kvset);
+        cndb_cn_open_work_free(ow);
         return err;
     }
 
-    if (ctx->max_dgen < km->km_dgen_hi)
-        ctx->max_dgen = km->km_dgen_hi;
+    ow->ow_ctx = ctx;
+    ow->ow_tree = ctx->tree;
+    ow->ow_node = node;
+    ow->ow_kvsetid = kvsetid;
+
+    list_add_tail(&ow->ow_link, &ctx->openl);
+
+    INIT_WORK(&ow->ow_work, cndb_cn_open_worker);
+
+    mutex_lock(&ctx->open_lock);
+    ctx->open_pending++;
+    mutex_unlock(&ctx->open_lock);
+
+    if (!ctx->wq || !queue_work(ctx->wq, &ow->ow_work))
+        cndb_cn_open_worker(&ow->ow_work);
 
     return 0;
 }
@@ -1014,16 +1279,30 @@ cn_open(
 
     /* Add kvsets to nodes based on data stored in CNDB.
      */
-    err = cndb_cn_ctx_init(&ctx, cn->cn_tree, cn->cn_tree->ct_root);
+    err = cndb_cn_ctx_init(&ctx, cn->cn_tree, cn->cn_tree->ct_root, cn_kvdb->cn_io_wq);
     if (ev(err))
         goto err_exit;
 
     err = cndb_cn_instantiate(cndb, cnid, &ctx, cndb_cn_callback);
+    cndb_cn_ctx_wait(&ctx);
+    if (!err)
+        err = cndb_cn_ctx_insert(&ctx);
     atomic_set(&cn->cn_ingest_dgen, ctx.max_dgen);
+    atomic_set(&cn->cn_rtombs, ctx.rtombs);
     cndb_cn_ctx_fini(&ctx);
     if (ev(err))
         goto err_exit;
 
+    /* Capped kvses age out entire kvsets, which would leave stale
+     * results in the cache, so they never use it.
+     */
+    if (rp->cn_rcache_size_mb > 0 && !cn_is_capped(cn) && !cn->cn_replay) {
+        err = rcache_create((size_t)rp->cn_rcache_size_mb << 20, ctx.max_seqno,
+                            &cn->cn_pc_rcache, &cn->cn_rcache);
+        if (ev(err))
+            goto err_exit;
+    }
+
     /* Walk the list of leaf nodes created/populated by cndb_cn_callback()
      * and insert them into the route map (i.e., all nodes except the root
      * node, which always has node ID 0).
@@ -1156,6 +1435,7 @@ cn_open(
     if (!rp->cn_maint_disable) {
         cn->cn_maint_wq = cn_kvdb->cn_maint_wq;
         cn->cn_io_wq = cn_kvdb->cn_io_wq;
+        cn->cn_ra_wq = cn_kvdb->cn_ra_wq;
 
         if (cn_is_capped(cn)) {
             cn->cn_maint_running = true;
@@ -1165,8 +1445,12 @@ cn_open(
              */
             if (rp->cn_bloom_create) {
                 rp->cn_bloom_create = (rp->cn_bloom_capped > 0);
-                if (rp->cn_bloom_create)
+                if (rp->cn_bloom_create) {
                     rp->cn_bloom_prob = rp->cn_bloom_capped;
+                    rp->cn_bloom_prob_root = 0;
+                    rp->cn_bloom_prob_leaf = 0;
+                    rp->cn_bloom_auto = false;
+                }
             }
 
             INIT_DELAYED_WORK(&cn->cn_maint_dwork, cn_maint_task);
@@ -1195,8 +1479,9 @@ cn_open(
 
 err_exit:
     flush_workqueue(cn->cn_maint_wq);
-    flush_workqueue(cn->cn_io_wq);
     cn_tree_destroy(cn->cn_tree);
+    rcache_destroy(cn->cn_rcache);
+    bcache_purge(cn_kvdb->cn_bcache, &cn->cn_pc_bcache);
     if (!cn->cn_replay)
         cn_perfc_free(cn);
     free(cn);
@@ -1234,6 +1519,12 @@ cn_close(struct cn *cn)
     cn_tree_destroy(cn->cn_tree);
     assert(atomic_read(&cn->cn_refcnt) == 0);
 
+    /* Drop this kvs' pages from the block cache before its perfc
+     * set (to which they are charged) is freed.
+     */
+    bcache_purge(cn->cn_kvdb->cn_bcache, &cn->cn_pc_bcache);
+    rcache_destroy(cn->cn_rcache);
+
     cn_perfc_free(cn);
     free(cn);
 
@@ -1418,6 +1709,12 @@ cn_cursor_read(struct cn_cursor *cursor, struct kvs_cursor_element *elem, bool *
     return cn_tree_cursor_read(cursor, elem, eof);
 }
 
+const struct rtomb_vec *
+cn_cursor_rtombs(struct cn_cursor *cursor)
+{
+    return &cursor->cncur_rtombs;
+}
+
 static bool
 cncur_next(struct element_source *es, void **element)
 {
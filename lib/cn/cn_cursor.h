@@ -9,11 +9,15 @@
 #include <hse/error/merr.h>
 #include <hse/util/inttypes.h>
 #include <hse/util/bin_heap.h>
+#include <hse/util/condvar.h>
+#include <hse/util/mutex.h>
 #include <hse/util/table.h>
+#include <hse/util/workqueue.h>
 
 #include <hse/limits.h>
 
 #include <hse/ikvdb/cursor.h>
+#include <hse/ikvdb/rtomb.h>
 
 #include "cn_metrics.h"
 #include "kvset.h"
@@ -70,6 +74,16 @@ struct cn_level_cursor {
  * @cncur_filter:
  * @cncur_pt_kobj:     ptomb key obj (key in kblk OR pt_buf[] right after cur update)
  * @cncur_pt_seq:      ptomb's seqno
+ * @cncur_ra_lcur:     next leaf node's kvset refs, acquired by the read-ahead work
+ * @cncur_ra_work:     read-ahead work struct
+ * @cncur_ra_mutex:    protects @cncur_ra_pending, @cncur_ra_started, @cncur_ra_cancel
+ *                     and @cncur_ra_err
+ * @cncur_ra_cv:       signaled when the read-ahead work completes
+ * @cncur_ra_err:      read-ahead status
+ * @cncur_ra_queued:   read-ahead has been queued and its result not yet consumed
+ * @cncur_ra_pending:  read-ahead work has not yet completed
+ * @cncur_ra_started:  read-ahead work has started acquiring kvset refs
+ * @cncur_ra_cancel:   read-ahead result will be discarded
  */
 struct cn_cursor {
     struct element_source   cncur_es;
@@ -104,6 +118,18 @@ struct cn_cursor {
 
     struct key_obj cncur_pt_kobj;
     uint64_t       cncur_pt_seq;
+
+    struct rtomb_vec cncur_rtombs;
+
+    struct cn_level_cursor cncur_ra_lcur;
+    struct work_struct     cncur_ra_work;
+    struct mutex           cncur_ra_mutex;
+    struct cv              cncur_ra_cv;
+    merr_t                 cncur_ra_err;
+    bool                   cncur_ra_queued;
+    bool                   cncur_ra_pending;
+    bool                   cncur_ra_started;
+    bool                   cncur_ra_cancel;
 };
 
 /* MTF_MOCK */
@@ -141,6 +167,15 @@ cn_cursor_destroy(struct cn_cursor *cursor);
 merr_t
 cn_cursor_active_kvsets(struct cn_cursor *cursor, uint32_t *active, uint32_t *total);
 
+/**
+ * cn_cursor_rtombs() - get the range tombstones of the kvsets in the cursor's view
+ *
+ * The returned vector is valid until the next update or destroy of the cursor.
+ */
+/* MTF_MOCK */
+const struct rtomb_vec *
+cn_cursor_rtombs(struct cn_cursor *cursor);
+
 /* MTF_MOCK */
 struct element_source *
 cn_cursor_es_make(struct cn_cursor *cncur);
@@ -12,6 +12,7 @@ struct cndb;
 struct ikvdb;
 struct kvdb_health;
 struct csched;
+struct rcache;
 
 #include <hse/util/atomic.h>
 #include <hse/util/workqueue.h>
@@ -36,9 +37,15 @@ struct cn {
     atomic_int cn_refcnt;
     bool       cn_replay;
 
+    /* set once the kvs may contain range tombstones (see cn_rtombs_set()) */
+    atomic_int cn_rtombs;
+
     /* for asynchronous mblock I/O */
     struct workqueue_struct *cn_io_wq;
 
+    /* for cursor leaf node read-ahead */
+    struct workqueue_struct *cn_ra_wq;
+
     /* perf counters */
     struct perfc_set cn_pc_ingest;
     struct perfc_set cn_pc_spill;
@@ -51,6 +58,14 @@ struct cn {
     struct perfc_set cn_pc_shape_rnode;
     struct perfc_set cn_pc_shape_lnode;
     struct perfc_set cn_pc_capped;
+    struct perfc_set cn_pc_bcache;
+    struct perfc_set cn_pc_rcache;
+
+    /* point lookup result cache (NULL if disabled) */
+    struct rcache *cn_rcache;
+
+    /* value compression context of the kvs (for recompression) */
+    struct kvs_vcomp *cn_vcomp;
 
     /* for maintenance work */
     struct workqueue_struct *cn_maint_wq;
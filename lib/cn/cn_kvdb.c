@@ -13,10 +13,18 @@
 
 #include <hse/ikvdb/cn_kvdb.h>
 
+#include "bcache.h"
+
 merr_t
-cn_kvdb_create(uint cn_maint_threads, uint cn_io_threads, struct cn_kvdb **out)
+cn_kvdb_create(
+    uint             cn_maint_threads,
+    uint             cn_io_threads,
+    uint             cn_spill_threads,
+    size_t           bcache_sz,
+    struct cn_kvdb **out)
 {
     struct cn_kvdb *self;
+    merr_t err;
 
     self = calloc(1, sizeof(*self));
     if (ev(!self))
@@ -35,6 +43,46 @@ cn_kvdb_create(uint cn_maint_threads, uint cn_io_threads, struct cn_kvdb **out)
         return merr(ENOMEM);
     }
 
+    /* Cursor read-ahead gets its own workqueue so that it is not queued
+     * behind long running compaction work on the io workqueue.
+     */
+    self->cn_ra_wq = alloc_workqueue("hse_cn_ra", 0, 1, cn_io_threads);
+    if (ev(!self->cn_ra_wq)) {
+        destroy_workqueue(self->cn_io_wq);
+        destroy_workqueue(self->cn_maint_wq);
+        free(self);
+        return merr(ENOMEM);
+    }
+
+    /* Range workers for parallel root spills.  These must not share a
+     * workqueue with the cn iterators, which queue vblock readahead and
+     * mblock reads to the maint and io workqueues.
+     */
+    if (cn_spill_threads > 0) {
+        self->cn_spill_wq = alloc_workqueue("hse_cn_spill", 0, 1, cn_spill_threads);
+        if (ev(!self->cn_spill_wq)) {
+            destroy_workqueue(self->cn_ra_wq);
+            destroy_workqueue(self->cn_io_wq);
+            destroy_workqueue(self->cn_maint_wq);
+            free(self);
+            return merr(ENOMEM);
+        }
+
+        self->cn_spill_threads = cn_spill_threads;
+    }
+
+    if (bcache_sz > 0) {
+        err = bcache_create(bcache_sz, &self->cn_bcache);
+        if (ev(err)) {
+            destroy_workqueue(self->cn_spill_wq);
+            destroy_workqueue(self->cn_ra_wq);
+            destroy_workqueue(self->cn_io_wq);
+            destroy_workqueue(self->cn_maint_wq);
+            free(self);
+            return err;
+        }
+    }
+
     *out = self;
 
     return 0;
@@ -46,6 +94,9 @@ cn_kvdb_destroy(struct cn_kvdb *h)
     if (h) {
         destroy_workqueue(h->cn_maint_wq);
         destroy_workqueue(h->cn_io_wq);
+        destroy_workqueue(h->cn_ra_wq);
+        destroy_workqueue(h->cn_spill_wq);
+        bcache_destroy(h->cn_bcache);
         free(h);
     }
 }
@@ -63,10 +63,26 @@ struct perfc_name cn_perfc_capped[] _dt_section = {
     NE(PERFC_BA_CNCAPPED_OLD,    3, "cN capped old (valid) kvsets",  "c_cncap_old"),
 };
 
+struct perfc_name cn_perfc_bcache[] _dt_section = {
+    NE(PERFC_BA_CNBCACHE_BYTES,  2, "cN block cache resident bytes", "c_bc_bytes"),
+    NE(PERFC_RA_CNBCACHE_HIT,    2, "cN block cache hit rate",       "r_bc_hit(/s)"),
+    NE(PERFC_RA_CNBCACHE_MISS,   2, "cN block cache miss rate",      "r_bc_miss(/s)"),
+    NE(PERFC_RA_CNBCACHE_REJECT, 3, "cN block cache reject rate",    "r_bc_reject(/s)"),
+};
+
+struct perfc_name cn_perfc_rcache[] _dt_section = {
+    NE(PERFC_BA_CNRCACHE_BYTES,  2, "cN result cache resident bytes", "c_rc_bytes"),
+    NE(PERFC_RA_CNRCACHE_HIT,    2, "cN result cache hit rate",       "r_rc_hit(/s)"),
+    NE(PERFC_RA_CNRCACHE_MISS,   2, "cN result cache miss rate",      "r_rc_miss(/s)"),
+    NE(PERFC_RA_CNRCACHE_FLUSH,  3, "cN result cache flush rate",     "r_rc_flush(/s)"),
+};
+
 NE_CHECK(cn_perfc_get, PERFC_EN_CNGET, "cn_perfc_get table/enum mismatch");
 NE_CHECK(cn_perfc_compact, PERFC_EN_CNCOMP, "cn_perfc_compact table/enum mismatch");
 NE_CHECK(cn_perfc_shape, PERFC_EN_CNSHAPE, "cn_perfc_shape table/enum mismatch");
 NE_CHECK(cn_perfc_capped, PERFC_EN_CNCAPPED, "cn_perfc_capped table/enum mismatch");
+NE_CHECK(cn_perfc_bcache, PERFC_EN_CNBCACHE, "cn_perfc_bcache table/enum mismatch");
+NE_CHECK(cn_perfc_rcache, PERFC_EN_CNRCACHE, "cn_perfc_rcache table/enum mismatch");
 
 static_assert(PERFC_RA_CNGET_MISS == 1 && NOT_FOUND == 1,
               "PERFC_RA_CNGET_MISS out of sync with enum key_lookup_res");
@@ -124,6 +140,8 @@ cn_perfc_alloc(struct cn *cn, uint prio)
     perfc_alloc(cn_perfc_shape, group, "rnode", prio, &cn->cn_pc_shape_rnode);
     perfc_alloc(cn_perfc_shape, group, "lnode", prio, &cn->cn_pc_shape_lnode);
     perfc_alloc(cn_perfc_capped, group, "capped", prio, &cn->cn_pc_capped);
+    perfc_alloc(cn_perfc_bcache, group, "bcache", prio, &cn->cn_pc_bcache);
+    perfc_alloc(cn_perfc_rcache, group, "rcache", prio, &cn->cn_pc_rcache);
 }
 
 void
@@ -139,6 +157,8 @@ cn_perfc_free(struct cn *cn)
     perfc_free(&cn->cn_pc_shape_rnode);
     perfc_free(&cn->cn_pc_shape_lnode);
     perfc_free(&cn->cn_pc_capped);
+    perfc_free(&cn->cn_pc_bcache);
+    perfc_free(&cn->cn_pc_rcache);
 }
 
 /* NOTE: called once per KVDB, not once per CN */
@@ -30,6 +30,7 @@
 #include <hse/util/hlog.h>
 #include <hse/util/table.h>
 #include <hse/util/keycmp.h>
+#include <hse/util/key_util.h>
 #include <hse/util/bin_heap.h>
 #include <hse/util/log2.h>
 #include <hse/util/fmt.h>
@@ -53,6 +54,9 @@
 #include <hse/ikvdb/sched_sts.h>
 #include <hse/ikvdb/csched.h>
 #include <hse/ikvdb/kvs_rparams.h>
+#include <hse/ikvdb/kvset_builder.h>
+#include <hse/ikvdb/rtomb.h>
+#include <hse/ikvdb/slowop.h>
 
 #include <cn/cn_cursor.h>
 
@@ -936,6 +940,62 @@ cn_tree_route_get(struct cn_tree *tree, const void *key, uint keylen)
     return node;
 }
 
+uint
+cn_tree_range_split(
+    struct cn_tree *tree,
+    const void     *min,
+    uint            minlen,
+    const void     *max,
+    uint            maxlen,
+    uint            splitc_max,
+    void           *keybufv,
+    uint           *keylenv)
+{
+    struct route_node *first, *node;
+    uint edgec = 0, splitc, idx = 0, i;
+    void *lock;
+
+    if (splitc_max == 0)
+        return 0;
+
+    rmlock_rlock(&tree->ct_lock, &lock);
+
+    first = min ? route_map_lookup(tree->ct_route_map, min, minlen) :
+                  route_map_first_node(tree->ct_route_map);
+
+    /* Count the leaf edges that fall within [min, max).  The rightmost
+     * leaf has no successor, and an edge of maximal length is skipped
+     * because it has no immediate successor key.
+     */
+    for (node = first; node && !route_node_islast(node); node = route_node_next(node)) {
+        if (max && route_node_keycmp(max, maxlen, node) <= 0)
+            break;
+
+        if (node->rtn_keylen < HSE_KVS_KEY_LEN_MAX)
+            ++edgec;
+    }
+
+    /* Divide the leaves into (splitc + 1) groups of nearly equal size and
+     * return the edge key of the last leaf in each of the first splitc groups.
+     */
+    splitc = min_t(uint, splitc_max, edgec);
+
+    for (node = first, i = 0; i < splitc; node = route_node_next(node)) {
+        if (node->rtn_keylen >= HSE_KVS_KEY_LEN_MAX)
+            continue;
+
+        if (idx++ == ((i + 1) * (edgec + 1)) / (splitc + 1) - 1) {
+            route_node_keycpy(node, keybufv + i * HSE_KVS_KEY_LEN_MAX,
+                              HSE_KVS_KEY_LEN_MAX, keylenv + i);
+            ++i;
+        }
+    }
+
+    rmlock_runlock(lock);
+
+    return splitc;
+}
+
 merr_t
 cn_tree_prefix_probe(
     struct cn_tree *     tree,
@@ -965,7 +1025,13 @@ cn_tree_prefix_probe(
 
     rmlock_rlock(&tree->ct_lock, &lock);
     node = tree->ct_root;
-    err = 0;
+
+    /* The caller collects the rtombs of c0 only if the kvs may have
+     * rtombs, in which case those of cn are needed too.
+     */
+    err = qctx->rtombs ? cn_tree_rtombs_get(tree, qctx->rtombs) : 0;
+    if (ev(err))
+        goto done;
 
     while (node) {
         struct kvset_list_entry *le;
@@ -1020,6 +1086,56 @@ cn_tree_prefix_probe(
     return err;
 }
 
+/* With cn_bloom_auto enabled, each thread samples one in every
+ * CN_BLOOM_SAMP_PERIOD of its lookups to track per-leaf-node negative
+ * lookup rates.  The counts are halved whenever the number of probes reaches
+ * CN_BLOOM_SAMP_MAX so that they reflect recent lookups.
+ */
+#define CN_BLOOM_SAMP_PERIOD    (64u)
+#define CN_BLOOM_SAMP_MIN       (1u << 10)
+#define CN_BLOOM_SAMP_MAX       (1u << 16)
+#define CN_BLOOM_PROB_AUTO_MAX  (200000u)
+
+static thread_local uint cn_bloom_samp_cnt;
+
+static void
+cn_node_bloom_samp(struct cn_tree_node *tn, bool negative)
+{
+    atomic_inc(&tn->tn_bloom_probes);
+    if (negative)
+        atomic_inc(&tn->tn_bloom_negs);
+
+    if (atomic_read(&tn->tn_bloom_probes) >= CN_BLOOM_SAMP_MAX) {
+        atomic_set(&tn->tn_bloom_probes, CN_BLOOM_SAMP_MAX / 2);
+        atomic_set(&tn->tn_bloom_negs, atomic_read(&tn->tn_bloom_negs) / 2);
+    }
+}
+
+uint64_t
+cn_tree_node_bloom_prob(struct cn_tree_node *tn)
+{
+    const struct kvs_rparams *rp = tn->tn_tree->rp;
+    uint64_t prob, probes, negs;
+
+    if (cn_node_isroot(tn))
+        return rp->cn_bloom_prob_root ? rp->cn_bloom_prob_root : rp->cn_bloom_prob;
+
+    prob = rp->cn_bloom_prob_leaf ? rp->cn_bloom_prob_leaf : rp->cn_bloom_prob;
+
+    probes = atomic_read(&tn->tn_bloom_probes);
+    negs = atomic_read(&tn->tn_bloom_negs);
+
+    if (!rp->cn_bloom_auto || probes < CN_BLOOM_SAMP_MIN || prob >= CN_BLOOM_PROB_AUTO_MAX)
+        return prob;
+
+    /* Keep the expected number of false positives per lookup constant,
+     * relaxing the target by at most 100x.
+     */
+    negs = clamp_t(uint64_t, negs, probes / 100, probes);
+
+    return min_t(uint64_t, prob * probes / negs, CN_BLOOM_PROB_AUTO_MAX);
+}
+
 /**
  * cn_tree_lookup() - search cn tree for a key
  * @tree: cn tree
@@ -1047,6 +1163,7 @@ cn_tree_lookup(
     uint64_t pc_start;
     void *lock;
     merr_t err;
+    bool samp;
 
     *res = NOT_FOUND;
 
@@ -1060,6 +1177,8 @@ cn_tree_lookup(
 
     key_disc_init(kt->kt_data, kt->kt_len, &kdisc);
 
+    samp = tree->rp->cn_bloom_auto && (++cn_bloom_samp_cnt % CN_BLOOM_SAMP_PERIOD == 0);
+
     rmlock_rlock(&tree->ct_lock, &lock);
     node = tree->ct_root;
     err = 0;
@@ -1067,12 +1186,16 @@ cn_tree_lookup(
     while (node) {
         struct kvset_list_entry *le;
 
+        slowop_add(SLOWOP_CN_NODES, 1);
+
         /* Search kvsets from newest to oldest (head to tail).
          * If an error occurs or a key is found, return immediately.
          */
         list_for_each_entry(le, &node->tn_kvset_list, le_link) {
             struct kvset *kvset = le->le_kvset;
 
+            slowop_add(SLOWOP_KVSETS, 1);
+
             err = kvset_lookup(kvset, kt, &kdisc, seq, res, vbuf);
             if (err)
                 goto done;
@@ -1080,14 +1203,21 @@ cn_tree_lookup(
             if (*res != NOT_FOUND) {
                 if (!atomic_read(&node->tn_readers))
                     atomic_inc(&node->tn_readers);
+                if (tree->ct_track_hits)
+                    kvset_hit(kvset);
+                if (samp && cn_node_isleaf(node))
+                    cn_node_bloom_samp(node, false);
                 goto done;
             }
 
             pc_cidx++;
         }
 
-        if (cn_node_isleaf(node))
+        if (cn_node_isleaf(node)) {
+            if (samp)
+                cn_node_bloom_samp(node, true);
             break;
+        }
 
         node = cn_tree_node_lookup(tree, kt->kt_data, kt->kt_len);
     }
@@ -1109,6 +1239,227 @@ cn_tree_lookup(
     return err;
 }
 
+struct cn_lookup_key {
+    struct key_disc    lk_kdisc;
+    struct kvs_ktuple *lk_kt;
+    uint               lk_idx;
+    uint               lk_misses;
+};
+
+static int
+cn_lookup_key_cmp(const void *lhs, const void *rhs)
+{
+    const struct kvs_ktuple *l = ((const struct cn_lookup_key *)lhs)->lk_kt;
+    const struct kvs_ktuple *r = ((const struct cn_lookup_key *)rhs)->lk_kt;
+
+    return keycmp(l->kt_data, l->kt_len, r->kt_data, r->kt_len);
+}
+
+/* Search the kvsets of %node for each unresolved key in keyv[first, last).
+ * The kvset list is walked once, newest to oldest, and each kvset is probed
+ * for all keys routed to this node before moving on to the next kvset.
+ */
+static merr_t
+cn_tree_lookup_node_multi(
+    struct cn_tree_node  *node,
+    struct cn_lookup_key *keyv,
+    uint                  first,
+    uint                  last,
+    uint64_t              seq,
+    enum key_lookup_res  *resv,
+    struct kvset_aio_ctx *aio,
+    struct kvs_buf       *vbufv)
+{
+    const bool track_hits = node->tn_tree->ct_track_hits;
+    struct kvset_list_entry *le;
+    uint pending = last - first;
+    bool found = false;
+    merr_t err = 0;
+
+    slowop_add(SLOWOP_CN_NODES, 1);
+
+    list_for_each_entry(le, &node->tn_kvset_list, le_link) {
+        struct kvset *kvset = le->le_kvset;
+        uint i;
+
+        slowop_add(SLOWOP_KVSETS, 1);
+
+        for (i = first; i < last; ++i) {
+            const uint idx = keyv[i].lk_idx;
+
+            if (resv[idx] != NOT_FOUND)
+                continue;
+
+            err = kvset_lookup_aio(kvset, keyv[i].lk_kt, &keyv[i].lk_kdisc, seq, resv + idx,
+                                   aio, vbufv + idx);
+            if (err)
+                goto done;
+
+            if (resv[idx] == NOT_FOUND) {
+                keyv[i].lk_misses++;
+                continue;
+            }
+
+            if (track_hits)
+                kvset_hit(kvset);
+            found = true;
+            if (--pending == 0)
+                goto done;
+        }
+    }
+
+  done:
+    if (found && !atomic_read(&node->tn_readers))
+        atomic_inc(&node->tn_readers);
+
+    return err;
+}
+
+/**
+ * cn_tree_lookup_multi() - search cn tree for a batch of keys
+ * @tree:  cn tree
+ * @pc:    perf counters
+ * @count: number of keys in %ktv
+ * @ktv:   keys to search for
+ * @seq:   view sequence number
+ * @resv:  (in/out) per-key results, only keys with result %NOT_FOUND are searched
+ * @vbufv: (output) per-key values
+ *
+ * The keys are sorted and the tree is descended once for the entire batch
+ * while holding the tree lock. Keys that route to the same node share a
+ * single walk of that node's kvset list.
+ *
+ * Values read directly from media (see cn_mcache_vmax) are queued to an
+ * io batch (up to cn_get_aio_depth in flight) rather than read one at a
+ * time, and the batch is drained before the tree lock is released.
+ */
+merr_t
+cn_tree_lookup_multi(
+    struct cn_tree *     tree,
+    struct perfc_set *   pc,
+    uint                 count,
+    struct kvs_ktuple *  ktv,
+    uint64_t             seq,
+    enum key_lookup_res *resv,
+    struct kvs_buf *     vbufv)
+{
+    struct kvset_aio_ctx aioctx, *aio = NULL;
+    struct cn_lookup_key *keyv;
+    uint64_t pc_start;
+    uint i, n;
+    void *lock;
+    merr_t err;
+
+    keyv = malloc(count * sizeof(*keyv));
+    if (ev(!keyv))
+        return merr(ENOMEM);
+
+    for (i = n = 0; i < count; ++i) {
+        if (resv[i] != NOT_FOUND)
+            continue;
+
+        key_disc_init(ktv[i].kt_data, ktv[i].kt_len, &keyv[n].lk_kdisc);
+        keyv[n].lk_kt = ktv + i;
+        keyv[n].lk_idx = i;
+        keyv[n].lk_misses = 0;
+        ++n;
+    }
+
+    if (n == 0) {
+        free(keyv);
+        return 0;
+    }
+
+    if (n > 1) {
+        qsort(keyv, n, sizeof(*keyv), cn_lookup_key_cmp);
+
+        /* Proceed without an io batch if one cannot be created,
+         * in which case values are read synchronously.
+         */
+        aioctx.kac_err = 0;
+        if (tree->rp && tree->rp->cn_get_aio_depth > 0 &&
+            !mpool_io_batch_create(min_t(uint, n, tree->rp->cn_get_aio_depth),
+                                   &aioctx.kac_batch))
+            aio = &aioctx;
+    }
+
+    pc_start = perfc_lat_startu(pc, PERFC_LT_CNGET_GET);
+
+    rmlock_rlock(&tree->ct_lock, &lock);
+
+    err = cn_tree_lookup_node_multi(tree->ct_root, keyv, 0, n, seq, resv, aio, vbufv);
+
+    /* Route the remaining keys to their leaf nodes. Since the keys are
+     * sorted, all keys that route to the same leaf are contiguous and
+     * need only be compared against the leaf's edge key.
+     */
+    for (i = 0; i < n && !err && !cn_node_isleaf(tree->ct_root);) {
+        const struct kvs_ktuple *kt = keyv[i].lk_kt;
+        struct route_node *rn;
+        uint last;
+
+        if (resv[keyv[i].lk_idx] != NOT_FOUND) {
+            ++i;
+            continue;
+        }
+
+        rn = route_map_lookup(tree->ct_route_map, kt->kt_data, kt->kt_len);
+        if (!rn)
+            break;
+
+        for (last = i + 1; last < n; ++last) {
+            kt = keyv[last].lk_kt;
+            if (route_node_keycmp(kt->kt_data, kt->kt_len, rn) > 0)
+                break;
+        }
+
+        err = cn_tree_lookup_node_multi(route_node_tnode(rn), keyv, i, last, seq, resv,
+                                        aio, vbufv);
+        i = last;
+    }
+
+    /* Outstanding reads reference the kvsets, so they must complete
+     * before the tree lock is dropped (mpool_io_batch_wait() reaps every
+     * read, even when it fails).
+     */
+    if (aio) {
+        merr_t err2 = mpool_io_batch_wait(aio->kac_batch);
+
+        if (!err)
+            err = err2 ?: aio->kac_err;
+    }
+
+    rmlock_runlock(lock);
+
+    if (aio)
+        mpool_io_batch_destroy(aio->kac_batch);
+
+    /* Each key is charged the latency of the whole batch, and is attributed
+     * to a level by the number of kvsets it missed, as in cn_tree_lookup().
+     */
+    if (pc_start > 0) {
+        const bool levels = perfc_ison(pc, PERFC_LT_CNGET_GET_ROOT);
+
+        for (i = 0; i < n; ++i) {
+            const enum key_lookup_res res = resv[keyv[i].lk_idx];
+            uint pc_cidx = PERFC_LT_CNGET_GET_ROOT + keyv[i].lk_misses;
+
+            perfc_lat_record(pc, (res == NOT_FOUND) ? PERFC_LT_CNGET_MISS : PERFC_LT_CNGET_GET,
+                             pc_start);
+
+            if (levels && pc_cidx < PERFC_LT_CNGET_GET_LEAF + 1)
+                perfc_lat_record(pc, pc_cidx, pc_start);
+        }
+    }
+
+    for (i = 0; i < n; ++i)
+        perfc_inc(pc, resv[keyv[i].lk_idx]);
+
+    free(keyv);
+
+    return err;
+}
+
 bool
 cn_tree_is_capped(const struct cn_tree *tree)
 {
@@ -1306,6 +1657,70 @@ err_out:
     return;
 }
 
+/* Collect the range tombstones of an input kvset so that the merge loops
+ * can both drop the data they cover and carry them into the outputs.
+ * The rtombs are owned by the kvset, which outlives the compaction.
+ */
+static merr_t
+cn_tree_compact_rtombs_add(struct cn_compaction_work *w, struct kvset *ks)
+{
+    const struct rtomb_vec *rv = kvset_get_rtombs(ks);
+    merr_t err;
+
+    for (uint32_t i = 0; rv && i < rv->rv_cnt; ++i) {
+        err = rtomb_vec_add(&w->cw_rtombs, rv->rv_v[i]);
+        if (ev(err))
+            return err;
+    }
+
+    return 0;
+}
+
+u64
+cn_compact_rtomb_seqno(const struct cn_compaction_work *w, const struct key_obj *kobj)
+{
+    u8   kbuf[HSE_KVS_KEY_LEN_MAX];
+    uint klen;
+
+    if (w->cw_rtombs.rv_cnt == 0)
+        return 0;
+
+    key_obj_copy(kbuf, sizeof(kbuf), &klen, kobj);
+
+    return rtomb_vec_lookup(&w->cw_rtombs, kbuf, klen, w->cw_horizon);
+}
+
+merr_t
+cn_compact_rtombs_emit(
+    struct cn_compaction_work *w,
+    struct kvset_builder      *bldr,
+    const void                *min,
+    uint                       minlen,
+    const void                *max,
+    uint                       maxlen,
+    bool                      *added)
+{
+    for (uint32_t i = 0; i < w->cw_rtombs.rv_cnt; ++i) {
+        const struct rtomb *rt = w->cw_rtombs.rv_v[i];
+        merr_t err;
+
+        if (w->cw_drop_tombs && rt->rt_seqno <= w->cw_horizon)
+            continue;
+
+        if (!rtomb_overlaps(rt, min, minlen, max, maxlen))
+            continue;
+
+        err = kvset_builder_add_rtomb(bldr, rt);
+        if (ev(err))
+            return err;
+
+        if (added)
+            *added = true;
+    }
+
+    return 0;
+}
+
 static merr_t
 cn_tree_prepare_compaction(struct cn_compaction_work *w)
 {
@@ -1415,14 +1830,19 @@ cn_tree_prepare_compaction(struct cn_compaction_work *w)
             goto err_exit;
 
         kvset_iter_set_stats(*iter, &w->cw_stats);
+
+        err = cn_tree_compact_rtombs_add(w, le->le_kvset);
+        if (ev(err))
+            goto err_exit;
     }
 
-    /* k-compaction keeps all the vblocks from the source kvsets
+    /* k-compaction keeps all the vblocks from the source kvsets (except for
+     * those rewritten by vblock gc)
      * vbm_blkv[0] is the id of the first vblock of the newest kvset
      * vbm_blkv[n] is the id of the last vblock of the oldest kvset
      */
     if (kcompact) {
-        err = kvset_keep_vblocks(&vbm, w->cw_vgmap, ins, w->cw_kvset_cnt);
+        err = kvset_keep_vblocks(&vbm, w->cw_vgmap, ins, w->cw_kvset_cnt, w->cw_vgc_pct);
         if (ev(err))
             goto err_exit;
     }
@@ -1441,12 +1861,14 @@ cn_tree_prepare_compaction(struct cn_compaction_work *w)
     return 0;
 
 err_exit:
+    rtomb_vec_fini(&w->cw_rtombs, false);
     if (ins) {
         for (i = 0; i < w->cw_kvset_cnt; i++)
             if (ins[i])
                 ins[i]->kvi_ops->kvi_release(ins[i]);
         free(ins);
         free(vbm.vbm_blkv);
+        free(vbm.vbm_vbidx);
         if (w->cw_vgmap) {
             if (kcompact)
                 vgmap_free(w->cw_vgmap[0]); /* one output kvset for k-compact */
@@ -1465,6 +1887,34 @@ err_exit:
  * SECTION: Cn Tree Compaction (k-compaction, kv-compaction, spill)
  */
 
+/* Add the vblocks of a retired kvset whose values were rewritten by vblock gc
+ * to the kvset's purge list.  Returns the kvset's number of vblocks.
+ */
+static uint
+cn_comp_purge_rewritten_vblocks(struct cn_compaction_work *work, struct kvset *ks, uint base)
+{
+    const uint32_t *vbidx = work->cw_vbmap.vbm_vbidx;
+    const uint      nvblks = kvset_get_num_vblocks(ks);
+    struct blk_list purge;
+    merr_t          err = 0;
+
+    blk_list_init(&purge);
+
+    for (uint j = 0; j < nvblks && !err; j++) {
+        if (vbidx[base + j] == VBM_REWRITE)
+            err = blk_list_append(&purge, kvset_get_nth_vblock_id(ks, j));
+    }
+
+    /* Failing to allocate the list merely leaks the rewritten vblocks.
+     */
+    if (!ev(err) && purge.idc > 0)
+        kvset_purge_blklist_add(ks, &purge);
+
+    blk_list_free(&purge);
+
+    return nvblks;
+}
+
 /**
  * cn_comp_update_kvcompact() - Update tree after k-compact and kv-compact
  * See section comment for more info.
@@ -1475,6 +1925,7 @@ cn_comp_update_kvcompact(struct cn_compaction_work *work, struct kvset *new_kvse
     struct cn_tree *         tree = work->cw_tree;
     struct kvset_list_entry *le, *tmp;
     struct list_head         retired_kvsets;
+    uint64_t                 hits = 0;
     uint                     i;
 
     if (ev(work->cw_err))
@@ -1489,14 +1940,21 @@ cn_comp_update_kvcompact(struct cn_compaction_work *work, struct kvset *new_kvse
             assert(&le->le_link != &work->cw_node->tn_kvset_list);
             assert(kvset_get_work(le->le_kvset) == work);
 
+            hits += kvset_reap_hits(le->le_kvset);
+
             tmp = list_prev_entry(le, le_link);
             list_del(&le->le_link);
             list_add(&le->le_link, &retired_kvsets);
             le = tmp;
         }
 
-        if (new_kvset)
+        /* The new kvset inherits the hits on the kvsets it replaces so
+         * that compaction does not cool the node (see sp3_heat_check).
+         */
+        if (new_kvset) {
+            kvset_add_hits(new_kvset, hits);
             kvset_list_add(new_kvset, &le->le_link);
+        }
     }
 
     cn_tree_samp(tree, &work->cw_samp_pre);
@@ -1505,13 +1963,20 @@ cn_comp_update_kvcompact(struct cn_compaction_work *work, struct kvset *new_kvse
 
     rmlock_wunlock(&tree->ct_lock);
 
-    /* Delete retired kvsets. */
+    /* Delete retired kvsets.  Retired kvsets are ordered newest to oldest,
+     * the same as the vblock map used by k-compaction.
+     */
+    i = 0;
     list_for_each_entry_safe(le, tmp, &retired_kvsets, le_link) {
 
         assert(kvset_get_dgen(le->le_kvset) >= work->cw_dgen_hi_min);
         assert(kvset_get_dgen(le->le_kvset) <= work->cw_dgen_hi);
 
         kvset_mark_mblocks_for_delete(le->le_kvset, work->cw_keep_vblks);
+
+        if (work->cw_keep_vblks && work->cw_vbmap.vbm_rewrc > 0)
+            i += cn_comp_purge_rewritten_vblocks(work, le->le_kvset, i);
+
         kvset_put_ref(le->le_kvset);
     }
 }
@@ -1780,7 +2245,7 @@ cn_comp_commit(struct cn_compaction_work *w)
     uint            alloc_len;
     const bool      is_kcompact = (w->cw_action == CN_ACTION_COMPACT_K);
     const bool      is_split = (w->cw_action == CN_ACTION_SPLIT);
-    bool            use_mbsets = is_kcompact;
+    bool            use_mbsets = is_kcompact && !w->cw_vbmap.vbm_rewrc;
     bool            txn_nak = false;
     merr_t          err = 0;
     uint            i;
@@ -2119,6 +2584,7 @@ cn_comp_cleanup(struct cn_compaction_work *w)
         cn_node_comp_token_put(w->cw_node);
 
     free(w->cw_vbmap.vbm_blkv);
+    free(w->cw_vbmap.vbm_vbidx);
 
     if (w->cw_vgmap) {
         if (kcompact) {
@@ -2367,11 +2833,334 @@ cn_comp_zspill(struct cn_compaction_work *w)
     return true;
 }
 
+/* A root spill whose input is large enough is split into ranges of leaves,
+ * each of which is merged and built concurrently by its own spill context.
+ * Range zero is built by the spill thread with the spill's primary context,
+ * the remainder by the cn spill workqueue.  The resulting subspills are then
+ * applied by cn_comp_spill() in leaf order, exactly as if they had been built
+ * serially.
+ *
+ * All leaves are pinned (via tn_ss_spilling) when the plan is created, and
+ * the pins are released one by one as cn_comp_spill() applies the subspills.
+ * As such, a planned spill never waits on a split or join, and to avoid a
+ * deadlock csched must not commit to splitting or joining any node while a
+ * planned spill is in progress (see ct_rspill_pbuild).
+ */
+struct spill_leaf {
+    struct cn_tree_node *sl_node;
+    struct subspill     *sl_ss;
+    uint64_t             sl_dgen;
+    uint                 sl_eklen;
+    uint8_t              sl_ekey[HSE_KVS_KEY_LEN_MAX];
+};
+
+struct spill_range {
+    struct work_struct    sr_work;
+    struct spill_plan    *sr_plan;
+    uint                  sr_first;
+    uint                  sr_last;
+    merr_t                sr_err;
+    struct cn_merge_stats sr_stats;
+};
+
+struct spill_plan {
+    struct cn_compaction_work *sp_work;
+    struct mutex               sp_lock;
+    struct cv                  sp_cv;
+    uint                       sp_pending;
+    uint                       sp_next;
+    uint                       sp_leafc;
+    uint                       sp_rangec;
+    struct spill_range        *sp_rangev;
+    struct spill_leaf          sp_leafv[];
+};
+
+static merr_t
+cn_spill_plan_build(struct spill_plan *plan, struct spillctx *sctx, uint first, uint last)
+{
+    for (uint i = first; i < last; i++) {
+        struct spill_leaf *sl = plan->sp_leafv + i;
+        struct subspill *ss;
+        merr_t err;
+
+        ss = malloc(sizeof(*ss));
+        if (!ss)
+            return merr(ENOMEM);
+
+        err = cn_subspill(ss, sctx, sl->sl_node, sl->sl_dgen, sl->sl_ekey, sl->sl_eklen);
+        if (err) {
+            free(ss);
+            return err;
+        }
+
+        sl->sl_ss = ss;
+    }
+
+    return 0;
+}
+
+static void
+cn_spill_range_cb(struct work_struct *work)
+{
+    struct spill_range *sr = container_of(work, struct spill_range, sr_work);
+    struct spill_plan *plan = sr->sr_plan;
+    struct cn_compaction_work *w = plan->sp_work;
+    const struct spill_leaf *prev = plan->sp_leafv + sr->sr_first - 1;
+    const struct spill_leaf *edge = NULL;
+    struct spillctx *sctx = NULL;
+    uint klen, skip;
+    merr_t err;
+
+    /* A ptomb is carried from one leaf into the next for as long as the
+     * leaves' edge keys share its prefix.  So the merge must start at the
+     * prefix of the previous range's last edge key, and the leaves that may
+     * contain keys with that prefix must be replayed in order to reproduce
+     * the ptomb (and rtomb) state with which the range begins.
+     */
+    klen = prev->sl_eklen;
+    if (w->cw_pfx_len > 0 && klen > w->cw_pfx_len)
+        klen = w->cw_pfx_len;
+
+    for (skip = sr->sr_first - 1; skip > 0; --skip) {
+        edge = plan->sp_leafv + skip - 1;
+
+        if (keycmp(edge->sl_ekey, edge->sl_eklen, prev->sl_ekey, klen) < 0)
+            break;
+
+        edge = NULL;
+    }
+
+    err = cn_spill_range_create(w, cn_get_maint_wq(w->cw_tree->cn), prev->sl_ekey, klen,
+                                edge ? edge->sl_ekey : NULL, edge ? edge->sl_eklen : 0,
+                                &sr->sr_stats, &sctx);
+
+    for (uint i = skip; !err && i < sr->sr_first; i++) {
+        const struct spill_leaf *sl = plan->sp_leafv + i;
+
+        err = cn_subspill_skip(sctx, sl->sl_node, sl->sl_dgen, sl->sl_ekey, sl->sl_eklen);
+    }
+
+    if (!err) {
+        memset(&sr->sr_stats, 0, sizeof(sr->sr_stats));
+
+        err = cn_spill_plan_build(plan, sctx, sr->sr_first, sr->sr_last);
+    }
+
+    cn_spill_destroy(sctx);
+
+    sr->sr_err = err;
+
+    mutex_lock(&plan->sp_lock);
+    if (--plan->sp_pending == 0)
+        cv_signal(&plan->sp_cv);
+    mutex_unlock(&plan->sp_lock);
+}
+
+/**
+ * cn_spill_plan_create() - partition a root spill into ranges of leaves
+ * @w: spill work
+ *
+ * Return: A plan if the spill should be built in parallel, otherwise NULL.
+ */
+static struct spill_plan *
+cn_spill_plan_create(struct cn_compaction_work *w)
+{
+    struct cn_tree *tree = w->cw_tree;
+    struct cn_kvdb *cn_kvdb = tree->cn_kvdb;
+    struct spill_plan *plan;
+    struct route_node *rtn;
+    uint64_t wtot, wsum;
+    uint leafc, rangec, r, i;
+    void *lock;
+    size_t sz;
+
+    if (!cn_kvdb || !cn_kvdb->cn_spill_wq || w->cw_action != CN_ACTION_SPILL)
+        return NULL;
+
+    rangec = min_t(uint64_t, cn_kvdb->cn_spill_threads + 1,
+                   w->cw_est.cwe_read_sz / CN_SPILL_RANGE_MIN);
+
+    rmlock_rlock(&tree->ct_lock, &lock);
+    leafc = 0;
+    for (rtn = route_map_first_node(tree->ct_route_map); rtn; rtn = route_node_next(rtn))
+        leafc++;
+
+    rangec = min_t(uint, rangec, leafc);
+    if (rangec < 2) {
+        rmlock_runlock(lock);
+        return NULL;
+    }
+
+    sz = sizeof(*plan) + leafc * sizeof(plan->sp_leafv[0]) + rangec * sizeof(*plan->sp_rangev);
+
+    plan = malloc(sz);
+    if (ev(!plan)) {
+        rmlock_runlock(lock);
+        return NULL;
+    }
+
+    memset(plan, 0, sizeof(*plan));
+    plan->sp_work = w;
+    plan->sp_leafc = leafc;
+    plan->sp_rangec = rangec;
+    plan->sp_rangev = (void *)(plan->sp_leafv + leafc);
+
+    mutex_lock(&tree->ct_ss_lock);
+    if (jclock_ns < tree->ct_rspill_pdefer) {
+        mutex_unlock(&tree->ct_ss_lock);
+        rmlock_runlock(lock);
+        free(plan);
+        return NULL;
+    }
+
+    wtot = 0;
+    i = 0;
+
+    for (rtn = route_map_first_node(tree->ct_route_map); rtn; rtn = route_node_next(rtn)) {
+        struct spill_leaf *sl = plan->sp_leafv + i++;
+        struct cn_tree_node *tn = route_node_tnode(rtn);
+        struct kvset_list_entry *le;
+
+        if (tn->tn_ss_splitting || tn->tn_ss_joining) {
+            mutex_unlock(&tree->ct_ss_lock);
+            rmlock_runlock(lock);
+            free(plan);
+            return NULL;
+        }
+
+        sl->sl_node = tn;
+        sl->sl_ss = NULL;
+        route_node_keycpy(rtn, sl->sl_ekey, sizeof(sl->sl_ekey), &sl->sl_eklen);
+
+        le = list_first_entry_or_null(&tn->tn_kvset_list, typeof(*le), le_link);
+        sl->sl_dgen = le ? kvset_get_dgen(le->le_kvset) : 0;
+
+        wtot += cn_ns_keys(&tn->tn_ns) + 1;
+    }
+
+    /* Leaves that already hold more keys are likely to receive more keys,
+     * so give each range an equal share of the existing keys (but at least
+     * one leaf).
+     */
+    wsum = 0;
+    r = 0;
+
+    plan->sp_rangev[0].sr_first = 0;
+
+    for (i = 0; i < leafc; i++) {
+        struct cn_tree_node *tn = plan->sp_leafv[i].sl_node;
+
+        atomic_inc_acq(&tn->tn_ss_spilling);
+
+        wsum += cn_ns_keys(&tn->tn_ns) + 1;
+
+        if (r + 1 < rangec &&
+            (wsum * rangec >= wtot * (r + 1) || leafc - i - 1 == rangec - r - 1)) {
+            plan->sp_rangev[r++].sr_last = i + 1;
+            plan->sp_rangev[r].sr_first = i + 1;
+        }
+    }
+
+    plan->sp_rangev[r].sr_last = leafc;
+
+    tree->ct_rspill_pbuild++;
+    mutex_unlock(&tree->ct_ss_lock);
+    rmlock_runlock(lock);
+
+    mutex_init(&plan->sp_lock);
+    cv_init(&plan->sp_cv);
+
+    for (r = 0; r < rangec; r++) {
+        struct spill_range *sr = plan->sp_rangev + r;
+
+        sr->sr_plan = plan;
+        sr->sr_err = 0;
+        memset(&sr->sr_stats, 0, sizeof(sr->sr_stats));
+    }
+
+    return plan;
+}
+
+static merr_t
+cn_spill_plan_run(struct spill_plan *plan, struct spillctx *sctx)
+{
+    struct cn_compaction_work *w = plan->sp_work;
+    struct workqueue_struct *wq = w->cw_tree->cn_kvdb->cn_spill_wq;
+    merr_t err;
+
+    plan->sp_pending = plan->sp_rangec - 1;
+
+    for (uint r = 1; r < plan->sp_rangec; r++) {
+        struct spill_range *sr = plan->sp_rangev + r;
+
+        INIT_WORK(&sr->sr_work, cn_spill_range_cb);
+        queue_work(wq, &sr->sr_work);
+    }
+
+    err = cn_spill_plan_build(plan, sctx, 0, plan->sp_rangev[0].sr_last);
+
+    mutex_lock(&plan->sp_lock);
+    while (plan->sp_pending > 0)
+        cv_wait(&plan->sp_cv, &plan->sp_lock, "spilrng");
+    mutex_unlock(&plan->sp_lock);
+
+    for (uint r = 1; r < plan->sp_rangec; r++) {
+        struct spill_range *sr = plan->sp_rangev + r;
+
+        if (!err)
+            err = sr->sr_err;
+
+        cn_merge_stats_add(&w->cw_stats, &sr->sr_stats);
+    }
+
+    return err;
+}
+
+/**
+ * cn_spill_plan_destroy() - release the subspills not consumed by cn_comp_spill()
+ * @plan: plan from cn_spill_plan_create() (may be NULL)
+ */
+static void
+cn_spill_plan_destroy(struct spill_plan *plan)
+{
+    struct cn_tree *tree;
+
+    if (!plan)
+        return;
+
+    tree = plan->sp_work->cw_tree;
+
+    for (uint i = plan->sp_next; i < plan->sp_leafc; i++) {
+        struct spill_leaf *sl = plan->sp_leafv + i;
+        struct subspill *ss = sl->sl_ss;
+
+        if (ss) {
+            if (ss->ss_mblks.hblk_id)
+                cn_mblocks_destroy(tree->mp, 1, &ss->ss_mblks, false);
+            blk_list_free(&ss->ss_mblks.kblks);
+            blk_list_free(&ss->ss_mblks.vblks);
+            free(ss);
+        }
+
+        atomic_dec_rel(&sl->sl_node->tn_ss_spilling);
+    }
+
+    mutex_lock(&tree->ct_ss_lock);
+    assert(tree->ct_rspill_pbuild > 0);
+    tree->ct_rspill_pbuild--;
+    mutex_unlock(&tree->ct_ss_lock);
+
+    cv_destroy(&plan->sp_cv);
+    mutex_destroy(&plan->sp_lock);
+    free(plan);
+}
+
 static merr_t
 cn_comp_spill(struct cn_compaction_work *w)
 {
     struct subspill *ss_saved = NULL, *ss = NULL;
     struct cn_tree *tree = w->cw_tree;
+    struct spill_plan *plan = NULL;
     struct route_node *rtn = NULL;
     atomic_uint *spillingp = NULL;
     struct spillctx *sctx = NULL;
@@ -2385,6 +3174,13 @@ cn_comp_spill(struct cn_compaction_work *w)
         err = cn_spill_create(w, &sctx);
         if (err)
             return err;
+
+        plan = cn_spill_plan_create(w);
+        if (plan) {
+            err = cn_spill_plan_run(plan, sctx);
+            if (err)
+                goto errout;
+        }
     }
 
     while (1) {
@@ -2396,6 +3192,29 @@ cn_comp_spill(struct cn_compaction_work *w)
         void *lock;
         uint eklen;
 
+        /* The subspills of a planned spill have already been built and their
+         * leaves pinned, so just transfer the next leaf's pin and apply.
+         */
+        if (plan) {
+            struct spill_leaf *sl;
+
+            if (plan->sp_next >= plan->sp_leafc)
+                break;
+
+            sl = plan->sp_leafv + plan->sp_next++;
+
+            if (spillingp)
+                atomic_dec_rel(spillingp);
+
+            tn = sl->sl_node;
+            spillingp = &tn->tn_ss_spilling;
+
+            free(ss_saved);
+            ss_saved = ss = sl->sl_ss;
+            sl->sl_ss = NULL;
+            goto apply;
+        }
+
         rmlock_rlock(&tree->ct_lock, &lock);
         rtnext = rtn ? route_node_next(rtn) : route_map_first_node(tree->ct_route_map);
         if (!rtnext) {
@@ -2498,6 +3317,7 @@ cn_comp_spill(struct cn_compaction_work *w)
             }
         }
 
+      apply:
         /* Enqueue the subspill only if there are older spills that need to update
          * this node ahead of us, in which case we must acquire an additional spill
          * ref (which is safe outside the tree lock because we already hold a ref).
@@ -2540,6 +3360,8 @@ cn_comp_spill(struct cn_compaction_work *w)
     w->cw_t3_build = get_time_ns();
 
   errout:
+    cn_spill_plan_destroy(plan);
+
     if (ss_saved != ss)
         free(ss_saved);
     ss_saved = ss;
@@ -2706,6 +3528,8 @@ cn_comp_compact(struct cn_compaction_work *w)
         free(w->cw_inputv);
     }
 
+    rtomb_vec_fini(&w->cw_rtombs, false);
+
     if (w->cw_canceled) {
         w->cw_err = err ? err : merr(ESHUTDOWN);
     } else {
@@ -2849,6 +3673,12 @@ cn_tree_perfc_shape_report(
     }
 }
 
+enum hse_mclass_policy_age
+cn_tree_node_agegroup(const struct cn_tree_node *tn)
+{
+    return tn->tn_hot ? HSE_MPOLICY_AGE_ROOT : HSE_MPOLICY_AGE_LEAF;
+}
+
 HSE_WEAK enum hse_mclass
 cn_tree_node_mclass(struct cn_tree_node *tn, enum hse_mclass_policy_dtype dtype)
 {
@@ -2858,7 +3688,7 @@ cn_tree_node_mclass(struct cn_tree_node *tn, enum hse_mclass_policy_dtype dtype)
     INVARIANT(tn);
 
     policy = cn_get_mclass_policy(tn->tn_tree->cn);
-    age = cn_node_isroot(tn) ? HSE_MPOLICY_AGE_ROOT : HSE_MPOLICY_AGE_LEAF;
+    age = cn_node_isroot(tn) ? HSE_MPOLICY_AGE_ROOT : cn_tree_node_agegroup(tn);
 
     return mclass_policy_get_type(policy, age, dtype);
 }
@@ -44,6 +44,45 @@ cn_tree_lookup(
     struct kvs_buf *     kbuf,
     struct kvs_buf *     vbuf);
 
+merr_t
+cn_tree_lookup_multi(
+    struct cn_tree *     tree,
+    struct perfc_set *   pc,
+    uint                 count,
+    struct kvs_ktuple *  ktv,
+    u64                  seq,
+    enum key_lookup_res *resv,
+    struct kvs_buf *     vbufv);
+
+/**
+ * cn_tree_range_split() - Split a key range at cn leaf node boundaries
+ * @tree:       cn tree
+ * @min:        minimum key of the range (NULL for the first key)
+ * @minlen:     length of %min
+ * @max:        maximum key of the range (NULL for the last key)
+ * @maxlen:     length of %max
+ * @splitc_max: max number of split keys to return
+ * @keybufv:    (output) array of %splitc_max HSE_KVS_KEY_LEN_MAX byte key buffers
+ * @keylenv:    (output) array of %splitc_max key lengths
+ *
+ * Each split key is the edge key (i.e., the largest key) of a leaf node,
+ * such that the range [%min, %max] splits into subranges that each cover
+ * a nearly equal number of leaf nodes.  Split keys are returned in ascending
+ * order and are strictly less than %max.
+ *
+ * Return: The number of split keys.
+ */
+uint
+cn_tree_range_split(
+    struct cn_tree *tree,
+    const void     *min,
+    uint            minlen,
+    const void     *max,
+    uint            maxlen,
+    uint            splitc_max,
+    void           *keybufv,
+    uint           *keylenv);
+
 /* MTF_MOCK */
 merr_t
 cn_tree_prefix_probe(
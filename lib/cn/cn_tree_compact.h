@@ -14,6 +14,7 @@
 #include <hse/util/perfc.h>
 
 #include <hse/ikvdb/csched.h>
+#include <hse/ikvdb/rtomb.h>
 #include <hse/ikvdb/sched_sts.h>
 
 #include "cn_metrics.h"
@@ -27,6 +28,8 @@ struct kv_iterator;
 struct kvset_list_entry;
 struct kvset_mblocks;
 struct kvset;
+struct kvset_builder;
+struct key_obj;
 
 enum cn_action {
     CN_ACTION_NONE = 0,
@@ -107,6 +110,7 @@ struct cn_work_est {
  * @cw_outc:         number of output kvsets
  * @cw_outv:         outputs (mblock ids used to make output kvsets)
  * @cw_inputv:       number of input kvsets
+ * @cw_rtombs:       range tombstones of the input kvsets (not owned)
  * @cw_vbmap:        tracks vblocks that are transferred from intput to output
  *                       kvsets during k-compaction
  * @cw_drop_tombs:   if true, then tombstones can be dropped in the merge loop
@@ -114,6 +118,8 @@ struct cn_work_est {
  * @cw_keep_vblks:   indicates whether or not vblocks should be deleted or
  *                   if they should transferred from input kvsets to
  *                   output kvets (e.g., in k-compaction).
+ * @cw_vgc_pct:      k-compaction rewrites the values of vblocks with at least
+ *                   this percentage of garbage (0: keep all vblocks)
  * @cw_tagv:         uniquely identify kvsets for cndb journal
  * @cw_stats:        debug stats
  * @cw_t0_enqueue:   debug stats
@@ -181,10 +187,12 @@ struct cn_compaction_work {
     uint64_t                *cw_kvsetidv;
     struct kvset_mblocks    *cw_outv;
     struct kv_iterator     **cw_inputv;
+    struct rtomb_vec         cw_rtombs;
     struct cn_tree_node    **cw_output_nodev;
     struct vgmap           **cw_vgmap; /* used during k-compact and split */
     struct kvset_vblk_map    cw_vbmap; /* used only during k-compact */
     bool                     cw_keep_vblks;
+    uint                     cw_vgc_pct;
 
     /* Used only for node split */
     struct {
@@ -235,6 +243,37 @@ cn_node_comp_token_get(struct cn_tree_node *tn);
 void
 cn_node_comp_token_put(struct cn_tree_node *tn);
 
+/**
+ * cn_compact_rtomb_seqno() - seqno of the newest input rtomb that covers a key
+ * @w:    compaction work
+ * @kobj: key
+ *
+ * Only rtombs at or below the horizon are considered, so every value of
+ * %kobj whose seqno is less than the returned seqno can be dropped.
+ */
+u64
+cn_compact_rtomb_seqno(const struct cn_compaction_work *w, const struct key_obj *kobj);
+
+/**
+ * cn_compact_rtombs_emit() - add the input rtombs that intersect [min, max] to an output
+ * @w:      compaction work
+ * @bldr:   output kvset builder
+ * @min:    minimum key of the output (NULL for unbounded)
+ * @max:    maximum key of the output (NULL for unbounded)
+ * @added:  (output) set to true if at least one rtomb was added
+ *
+ * Rtombs at or below the horizon are dropped if the compaction may drop tombstones.
+ */
+merr_t
+cn_compact_rtombs_emit(
+    struct cn_compaction_work *w,
+    struct kvset_builder      *bldr,
+    const void                *min,
+    uint                       minlen,
+    const void                *max,
+    uint                       maxlen,
+    bool                      *added);
+
 #if HSE_MOCKING
 #include "cn_tree_compact_ut.h"
 #endif /* HSE_MOCKING */
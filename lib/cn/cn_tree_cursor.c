@@ -14,6 +14,11 @@
  * These two binheaps feed into a top level binheap that forms the cn cursor.
  *
  * Each node uses a struct cn_level_cursor to iterate over its kvsets.
+ *
+ * While the cursor consumes a leaf node, a work item on the cn io workqueue acquires refs on the
+ * kvsets of the next non-empty leaf node in the iteration order and initiates read-ahead of the
+ * mblock pages that their iterators will touch first.  Crossing into the next leaf node then
+ * adopts those kvset refs rather than walking the route map under the tree lock itself.
  */
 
 #include <hse/util/event_counter.h>
@@ -24,8 +29,12 @@
 #include <hse/util/key_util.h>
 #include <hse/util/keycmp.h>
 #include <hse/util/bin_heap.h>
+#include <hse/util/condvar.h>
+#include <hse/util/mutex.h>
+#include <hse/util/workqueue.h>
 
 #include <hse/ikvdb/cn.h>
+#include <hse/ikvdb/rtomb.h>
 
 #include <cn/cn_cursor.h>
 
@@ -97,6 +106,7 @@ cn_kv_cmp_rev(const void *a_blob, const void *b_blob)
 MTF_STATIC merr_t
 cn_tree_kvset_refs(struct cn_tree_node *node, struct cn_level_cursor *lcur)
 {
+    struct cn_cursor *cncur = lcur->cnlc_cncur;
     struct table *tab = lcur->cnlc_kvref_tab;
     struct kvset_list_entry *le;
 
@@ -114,14 +124,60 @@ cn_tree_kvset_refs(struct cn_tree_node *node, struct cn_level_cursor *lcur)
         if (!lcur->cnlc_dgen_hi)
             lcur->cnlc_dgen_hi = dgen;
 
+        lcur->cnlc_dgen_lo = dgen;
+
+        /* A prefix cursor needn't iterate over kvsets which cannot contain
+         * keys with its prefix.
+         */
+        if (cncur->cncur_pfxlen && !kvset_pfx_maybe(kvset, cncur->cncur_pfx, cncur->cncur_pfxlen))
+            continue;
+
         k = table_append(tab);
         if (ev(!k))
             return merr(ENOMEM);
 
         kvset_get_ref(kvset);
+        if (node->tn_tree->ct_track_hits)
+            kvset_hit(kvset);
         k->kvset = kvset;
+    }
 
-        lcur->cnlc_dgen_lo = dgen;
+    return 0;
+}
+
+/* Collect copies of the rtombs of all kvsets in the tree.  Caller must
+ * hold the tree lock so that the rtombs are consistent with the kvsets
+ * referenced by the cursor.  Rtombs are not filtered by the view here,
+ * as the view may advance without the cursor re-acquiring its kvsets.
+ */
+merr_t
+cn_tree_rtombs_get(struct cn_tree *tree, struct rtomb_vec *rv)
+{
+    struct cn_tree_node *node;
+
+    cn_tree_foreach_node(node, tree) {
+        struct kvset_list_entry *le;
+
+        list_for_each_entry(le, &node->tn_kvset_list, le_link) {
+            const struct rtomb_vec *ksrv = kvset_get_rtombs(le->le_kvset);
+
+            for (uint32_t i = 0; ksrv && i < ksrv->rv_cnt; ++i) {
+                const struct rtomb *rt = ksrv->rv_v[i];
+                struct rtomb *copy;
+                merr_t err;
+
+                copy = rtomb_alloc(rtomb_start(rt), rt->rt_slen, rtomb_end(rt), rt->rt_elen,
+                                   rt->rt_seqno);
+                if (ev(!copy))
+                    return merr(ENOMEM);
+
+                err = rtomb_vec_add(rv, copy);
+                if (ev(err)) {
+                    free(copy);
+                    return err;
+                }
+            }
+        }
     }
 
     return 0;
@@ -221,6 +277,225 @@ cn_lcur_kvset_release(struct cn_level_cursor *lcur)
     table_reset(lcur->cnlc_kvref_tab);
 }
 
+/* Acquire refs on the kvsets of the first non-empty leaf node that follows the edge key in
+ * lcur->cnlc_next_ekey, and replace the edge key with that of the new leaf node.
+ */
+static merr_t
+cn_lcur_next_refs(struct cn_level_cursor *lcur)
+{
+    struct cn_cursor *cncur = lcur->cnlc_cncur;
+    struct cn_tree *tree = cn_get_tree(cncur->cncur_cn);
+    struct route_node *rtn_curr, *rtn_ekey;
+    bool first_pass = true;
+    merr_t err = 0;
+    void *lock;
+
+    rmlock_rlock(&tree->ct_lock, &lock);
+
+    rtn_curr = cncur->cncur_reverse ?
+               route_map_lookup(tree->ct_route_map, lcur->cnlc_next_ekey, lcur->cnlc_next_eklen) :
+               route_map_lookupGT(tree->ct_route_map, lcur->cnlc_next_ekey, lcur->cnlc_next_eklen);
+
+    do {
+        if (cncur->cncur_reverse) {
+            if (!first_pass)
+                rtn_curr = route_node_prev(rtn_curr);
+
+            lcur->cnlc_islast = route_node_isfirst(rtn_curr);
+            rtn_ekey = route_node_prev(rtn_curr);
+        } else {
+            if (!first_pass)
+                rtn_curr = route_node_next(rtn_curr);
+
+            lcur->cnlc_islast = route_node_islast(rtn_curr);
+            rtn_ekey = rtn_curr;
+        }
+
+        first_pass = false;
+        err = cn_tree_kvset_refs(route_node_tnode(rtn_curr), lcur);
+        if (ev(err))
+            break;
+
+    } while (!lcur->cnlc_islast && !table_len(lcur->cnlc_kvref_tab));
+
+    if (!err && !lcur->cnlc_islast)
+        route_node_keycpy(rtn_ekey, lcur->cnlc_next_ekey,
+                          sizeof(lcur->cnlc_next_ekey), &lcur->cnlc_next_eklen);
+
+    rmlock_runlock(lock);
+
+    return err;
+}
+
+static void
+cn_lcur_ra_worker(struct work_struct *work)
+{
+    struct cn_cursor *cur = container_of(work, struct cn_cursor, cncur_ra_work);
+    struct cn_level_cursor *ra = &cur->cncur_ra_lcur;
+    bool cancel;
+    merr_t err = 0;
+
+    mutex_lock(&cur->cncur_ra_mutex);
+    cancel = cur->cncur_ra_cancel;
+    cur->cncur_ra_started = !cancel;
+    mutex_unlock(&cur->cncur_ra_mutex);
+
+    if (!cancel) {
+        err = cn_lcur_next_refs(ra);
+
+        for (uint i = 0; !err && i < table_len(ra->cnlc_kvref_tab); i++) {
+            struct kvref *k = table_at(ra->cnlc_kvref_tab, i);
+
+            kvset_madvise_cursor(k->kvset, cur->cncur_reverse);
+        }
+    }
+
+    mutex_lock(&cur->cncur_ra_mutex);
+    cur->cncur_ra_err = err;
+    cur->cncur_ra_pending = false;
+    cv_signal(&cur->cncur_ra_cv);
+    mutex_unlock(&cur->cncur_ra_mutex);
+}
+
+/* Start acquiring the kvsets of the leaf node that follows the one the level cursor is
+ * currently positioned in.
+ */
+static void
+cn_lcur_ra_start(struct cn_level_cursor *lcur)
+{
+    struct cn_cursor *cur = lcur->cnlc_cncur;
+    struct cn_level_cursor *ra = &cur->cncur_ra_lcur;
+    struct workqueue_struct *wq;
+
+    if (lcur->cnlc_islast)
+        return;
+
+    /* A read-ahead canceled by cn_lcur_ra_adopt() or cn_lcur_ra_discard()
+     * might still be waiting to run, in which case we forgo read-ahead for
+     * this leaf node.
+     */
+    if (cur->cncur_ra_queued) {
+        bool pending;
+
+        mutex_lock(&cur->cncur_ra_mutex);
+        assert(cur->cncur_ra_cancel);
+        pending = cur->cncur_ra_pending;
+        mutex_unlock(&cur->cncur_ra_mutex);
+
+        if (pending)
+            return;
+
+        cur->cncur_ra_queued = false;
+    }
+
+    wq = cn_get_ra_wq(cur->cncur_cn);
+    if (!wq)
+        return;
+
+    ra->cnlc_next_eklen = lcur->cnlc_next_eklen;
+    memcpy(ra->cnlc_next_ekey, lcur->cnlc_next_ekey, lcur->cnlc_next_eklen);
+
+    cur->cncur_ra_err = 0;
+    cur->cncur_ra_cancel = false;
+    cur->cncur_ra_started = false;
+    cur->cncur_ra_pending = true;
+    cur->cncur_ra_queued = true;
+
+    INIT_WORK(&cur->cncur_ra_work, cn_lcur_ra_worker);
+    if (!queue_work(wq, &cur->cncur_ra_work))
+        cur->cncur_ra_pending = cur->cncur_ra_queued = false;
+}
+
+static merr_t
+cn_lcur_ra_wait(struct cn_cursor *cur)
+{
+    merr_t err;
+
+    mutex_lock(&cur->cncur_ra_mutex);
+    while (cur->cncur_ra_pending)
+        cv_wait(&cur->cncur_ra_cv, &cur->cncur_ra_mutex, "cnlcra");
+    err = cur->cncur_ra_err;
+    mutex_unlock(&cur->cncur_ra_mutex);
+
+    return err;
+}
+
+/* Cancel the read-ahead and release the kvset refs it acquired.  A read-ahead that has
+ * yet to start acquires no refs once canceled, so it is waited upon only if %wait is
+ * true (i.e., the cursor is going away).
+ */
+static void
+cn_lcur_ra_discard(struct cn_cursor *cur, bool wait)
+{
+    bool started;
+
+    if (!cur->cncur_ra_queued)
+        return;
+
+    mutex_lock(&cur->cncur_ra_mutex);
+    cur->cncur_ra_cancel = true;
+    started = cur->cncur_ra_started;
+    mutex_unlock(&cur->cncur_ra_mutex);
+
+    if (!started && !wait)
+        return;
+
+    cn_lcur_ra_wait(cur);
+    cur->cncur_ra_queued = false;
+
+    table_apply(cur->cncur_ra_lcur.cnlc_kvref_tab, kvref_tab_putref);
+    table_reset(cur->cncur_ra_lcur.cnlc_kvref_tab);
+}
+
+/* Take over the kvset refs acquired by the read-ahead, if any.  The level cursor must
+ * have released its own kvsets.  If the read-ahead work has yet to start (e.g., the io
+ * workqueue is busy with compaction) it is canceled rather than waited upon, and the
+ * caller must acquire the refs itself.
+ */
+static bool
+cn_lcur_ra_adopt(struct cn_level_cursor *lcur)
+{
+    struct cn_cursor *cur = lcur->cnlc_cncur;
+    struct cn_level_cursor *ra = &cur->cncur_ra_lcur;
+    struct table *tab;
+    merr_t err;
+
+    if (!cur->cncur_ra_queued)
+        return false;
+
+    mutex_lock(&cur->cncur_ra_mutex);
+    if (cur->cncur_ra_cancel || !cur->cncur_ra_started) {
+        cur->cncur_ra_cancel = true;
+        mutex_unlock(&cur->cncur_ra_mutex);
+        ev_debug(1);
+        return false;
+    }
+
+    while (cur->cncur_ra_pending)
+        cv_wait(&cur->cncur_ra_cv, &cur->cncur_ra_mutex, "cnlcra");
+    err = cur->cncur_ra_err;
+    mutex_unlock(&cur->cncur_ra_mutex);
+
+    if (ev(err)) {
+        cn_lcur_ra_discard(cur, true);
+        return false;
+    }
+
+    cur->cncur_ra_queued = false;
+
+    tab = lcur->cnlc_kvref_tab;
+    lcur->cnlc_kvref_tab = ra->cnlc_kvref_tab;
+    ra->cnlc_kvref_tab = tab;
+
+    lcur->cnlc_dgen_hi = ra->cnlc_dgen_hi;
+    lcur->cnlc_dgen_lo = ra->cnlc_dgen_lo;
+    lcur->cnlc_islast = ra->cnlc_islast;
+    lcur->cnlc_next_eklen = ra->cnlc_next_eklen;
+    memcpy(lcur->cnlc_next_ekey, ra->cnlc_next_ekey, ra->cnlc_next_eklen);
+
+    return true;
+}
+
 merr_t
 cn_tree_cursor_create(struct cn_cursor *cur)
 {
@@ -229,9 +504,18 @@ cn_tree_cursor_create(struct cn_cursor *cur)
     void *lock;
     struct cn_level_cursor *lcur;
     struct cn_tree *tree = cn_get_tree(cur->cncur_cn);
+    size_t kvref_tab_cnt = 1024 / sizeof(struct kvref);
+
+    mutex_init(&cur->cncur_ra_mutex);
+    cv_init(&cur->cncur_ra_cv);
+
+    lcur = &cur->cncur_ra_lcur;
+    lcur->cnlc_cncur = cur;
+    lcur->cnlc_level = 1;
+    if (!lcur->cnlc_kvref_tab)
+        lcur->cnlc_kvref_tab = table_create(kvref_tab_cnt, sizeof(struct kvref), false);
 
     for (i = 0; i < NUM_LEVELS; i++) {
-        size_t kvref_tab_cnt = 1024 / sizeof(struct kvref);
 
         lcur = &cur->cncur_lcur[i];
         lcur->cnlc_cncur = cur;
@@ -243,7 +527,7 @@ cn_tree_cursor_create(struct cn_cursor *cur)
         lcur->cnlc_esrcc = 64;
         lcur->cnlc_esrcv = malloc(lcur->cnlc_esrcc * sizeof(*lcur->cnlc_esrcv));
 
-        if (!lcur->cnlc_kvref_tab || !lcur->cnlc_esrcv) {
+        if (!lcur->cnlc_kvref_tab || !lcur->cnlc_esrcv || !cur->cncur_ra_lcur.cnlc_kvref_tab) {
             err = merr(ENOMEM);
             goto out;
         }
@@ -255,8 +539,12 @@ cn_tree_cursor_create(struct cn_cursor *cur)
 
     lcur = &cur->cncur_lcur[0];
 
+    rtomb_vec_fini(&cur->cncur_rtombs, true);
+
     rmlock_rlock(&tree->ct_lock, &lock);
     err = cn_tree_kvset_refs(tree->ct_root, lcur);
+    if (!err)
+        err = cn_tree_rtombs_get(tree, &cur->cncur_rtombs);
     rmlock_runlock(lock);
 
     if (ev(err))
@@ -280,6 +568,11 @@ out:
             table_destroy(lcur->cnlc_kvref_tab);
             free(lcur->cnlc_esrcv);
         }
+
+        table_destroy(cur->cncur_ra_lcur.cnlc_kvref_tab);
+        cv_destroy(&cur->cncur_ra_cv);
+        mutex_destroy(&cur->cncur_ra_mutex);
+        rtomb_vec_fini(&cur->cncur_rtombs, true);
     }
 
     return err;
@@ -290,6 +583,11 @@ cn_tree_cursor_destroy(struct cn_cursor *cur)
 {
     int i;
 
+    cn_lcur_ra_discard(cur, true);
+    table_destroy(cur->cncur_ra_lcur.cnlc_kvref_tab);
+    cv_destroy(&cur->cncur_ra_cv);
+    mutex_destroy(&cur->cncur_ra_mutex);
+
     for (i = 0; i < NUM_LEVELS; i++) {
         struct cn_level_cursor *lcur = &cur->cncur_lcur[i];
 
@@ -301,6 +599,7 @@ cn_tree_cursor_destroy(struct cn_cursor *cur)
     }
 
     bin_heap_destroy(cur->cncur_bh);
+    rtomb_vec_fini(&cur->cncur_rtombs, true);
 }
 
 MTF_STATIC merr_t
@@ -330,10 +629,8 @@ static void
 cn_lcur_advance(struct cn_level_cursor *lcur)
 {
     struct cn_cursor *cncur = lcur->cnlc_cncur;
-    struct cn_tree *tree = cn_get_tree(cncur->cncur_cn);
-    struct route_node *rtn_curr, *rtn_ekey;
-    void *lock;
-    bool first_pass = true;
+    unsigned char ekey[HSE_KVS_KEY_LEN_MAX];
+    uint eklen;
 
     if (lcur->cnlc_islast)
         return;
@@ -346,55 +643,28 @@ cn_lcur_advance(struct cn_level_cursor *lcur)
 
     cn_lcur_kvset_release(lcur);
 
-    rmlock_rlock(&tree->ct_lock, &lock);
-
-    rtn_curr = cncur->cncur_reverse ?
-               route_map_lookup(tree->ct_route_map, lcur->cnlc_next_ekey, lcur->cnlc_next_eklen) :
-               route_map_lookupGT(tree->ct_route_map, lcur->cnlc_next_ekey, lcur->cnlc_next_eklen);
-
-    do {
-        if (cncur->cncur_reverse) {
-            if (!first_pass)
-                rtn_curr = route_node_prev(rtn_curr);
-
-            lcur->cnlc_islast = route_node_isfirst(rtn_curr);
-            rtn_ekey = route_node_prev(rtn_curr);
-        } else {
-            if (!first_pass)
-                rtn_curr = route_node_next(rtn_curr);
-
-            lcur->cnlc_islast = route_node_islast(rtn_curr);
-            rtn_ekey = rtn_curr;
-        }
+    /* The edge key of the exhausted node is where iteration resumes in the next node.
+     */
+    eklen = lcur->cnlc_next_eklen;
+    memcpy(ekey, lcur->cnlc_next_ekey, eklen);
 
-        first_pass = false;
-        cncur->cncur_merr = cn_tree_kvset_refs(route_node_tnode(rtn_curr), lcur);
+    if (!cn_lcur_ra_adopt(lcur)) {
+        cncur->cncur_merr = cn_lcur_next_refs(lcur);
         if (ev(cncur->cncur_merr))
-            break;
-
-    } while (!lcur->cnlc_islast && !table_len(lcur->cnlc_kvref_tab));
-
-    rmlock_runlock(lock);
-
-    if (ev(cncur->cncur_merr))
-        return;
+            return;
+    }
 
     cncur->cncur_merr = cn_lcur_init(lcur);
     if (ev(cncur->cncur_merr))
         return;
 
     if (lcur->cnlc_iterc) {
-        cncur->cncur_merr = cn_lcur_seek(lcur, lcur->cnlc_next_ekey, lcur->cnlc_next_eklen);
+        cncur->cncur_merr = cn_lcur_seek(lcur, ekey, eklen);
         if (ev(cncur->cncur_merr))
             return;
     }
 
-    if (lcur->cnlc_islast)
-        return;
-
-    route_node_keycpy(rtn_ekey, lcur->cnlc_next_ekey,
-                      sizeof(lcur->cnlc_next_ekey),
-                      &lcur->cnlc_next_eklen);
+    cn_lcur_ra_start(lcur);
 }
 
 static bool
@@ -440,6 +710,7 @@ cn_tree_cursor_seek(
     bool first_pass = true;
     int i;
 
+    cn_lcur_ra_discard(cur, false);
     cn_lcur_kvset_release(lcur);
 
     rmlock_rlock(&tree->ct_lock, &lock);
@@ -482,6 +753,8 @@ cn_tree_cursor_seek(
     if (ev(err))
         return err;
 
+    cn_lcur_ra_start(lcur);
+
     /* Prepare iters and binheaps.
      */
     cur->cncur_iterc = 0;
@@ -540,6 +813,8 @@ cn_tree_cursor_update(struct cn_cursor *cur)
 
     /* Release resources.
      */
+    cn_lcur_ra_discard(cur, false);
+
     for (i = 0; i < NUM_LEVELS; i++)
         cn_lcur_kvset_release(&cur->cncur_lcur[i]);
 
@@ -548,8 +823,12 @@ cn_tree_cursor_update(struct cn_cursor *cur)
     cur->cncur_first_read = 1;
     lcur = &cur->cncur_lcur[0];
 
+    rtomb_vec_fini(&cur->cncur_rtombs, true);
+
     rmlock_rlock(&tree->ct_lock, &lock);
     err = cn_tree_kvset_refs(tree->ct_root, lcur);
+    if (!err)
+        err = cn_tree_rtombs_get(tree, &cur->cncur_rtombs);
     rmlock_runlock(lock);
 
     if (ev(err))
@@ -28,6 +28,12 @@
 
 struct hlog;
 struct route_map;
+struct rtomb_vec;
+
+/* A root spill is built in parallel only if each range would read at
+ * least this many bytes.
+ */
+#define CN_SPILL_RANGE_MIN  (64ul << 20)
 
 /* Each node in a cN tree contains a list of kvsets that must be protected
  * against concurrent update.  Since update of the list is relatively rare,
@@ -68,6 +74,7 @@ struct cn_kle_hdr {
  * @ct_root:        root node of tree
  * @ct_nodes:       list of all tree nodes, including ct_root
  * @ct_fanout:      the number of leaf nodes on ct_nodes list
+ * @ct_track_hits:  count get and cursor hits on kvsets (see sp3_heat_check)
  * @cn:    ptr to parent cn object
  * @rp:    ptr to shared runtime parameters struct
  * @cndb:  handle for cndb (the metadata journal/log)
@@ -77,6 +84,8 @@ struct cn_kle_hdr {
  * @ct_rspill_slp: number of rspill jobs waiting on a split to finish
  * @ct_split_cnt:  number of pending or running split jobs
  * @ct_split_dly:  time at which a new splits may be requested
+ * @ct_rspill_pbuild: number of parallel rspills holding spill refs on all leaves
+ * @ct_rspill_pdefer: time before which new rspills must not run in parallel
  * @ct_sched:
  * @ct_kvdb_health: for monitoring KDVB health
  * @ct_last_ptseq:
@@ -94,6 +103,7 @@ struct cn_tree {
     uint16_t             ct_fanout;
     u16                  ct_pfx_len;
     bool                 ct_rspills_wedged;
+    bool                 ct_track_hits;
     struct cn           *cn;
     struct mpool        *mp;
     struct kvs_rparams  *rp;
@@ -113,6 +123,8 @@ struct cn_tree {
     atomic_uint          ct_rspill_slp;
     atomic_uint          ct_split_cnt;
     uint64_t             ct_split_dly;
+    uint                 ct_rspill_pbuild;
+    uint64_t             ct_rspill_pdefer;
     uint64_t             ct_sgen;
 
     union {
@@ -156,6 +168,9 @@ struct cn_tree_node {
     size_t               tn_split_size;
     uint64_t             tn_split_ns;
     atomic_uint          tn_readers;
+    atomic_uint          tn_bloom_probes; /* sampled lookups that searched this node */
+    atomic_uint          tn_bloom_negs;   /* sampled lookups not resolved by this node */
+    bool                 tn_hot;       /* place new kvsets per the root mclass policy */
 
     struct list_head     tn_kvset_list HSE_L1D_ALIGNED;
     u64                  tn_update_incr_dgen;
@@ -222,6 +237,33 @@ cn_node_isleaf(const struct cn_tree_node *tn)
     return !cn_node_isroot(tn);
 }
 
+/**
+ * cn_tree_node_agegroup() - mclass policy age group for kvsets built into a node
+ * @tn: cn tree node pointer
+ *
+ * Kvsets built by compaction or spill use the leaf policy row, other than
+ * for leaf nodes the scheduler has found to be hot, which use the root row
+ * (e.g., staging rather than capacity media).
+ */
+/* MTF_MOCK */
+enum hse_mclass_policy_age
+cn_tree_node_agegroup(const struct cn_tree_node *tn);
+
+/**
+ * cn_tree_node_bloom_prob() - bloom false-positive target for a leaf node
+ * @tn: cn tree node pointer
+ *
+ * Returns the target (in parts per million) for kvsets built into the leaf
+ * node by compaction or spill.  With cn_bloom_auto enabled the target is
+ * relaxed in inverse proportion to the fraction of sampled lookups that
+ * search the node without finding their key, since a lookup that finds its
+ * key in the node probes only the blooms of kvsets newer than the one that
+ * holds the key.
+ */
+/* MTF_MOCK */
+uint64_t
+cn_tree_node_bloom_prob(struct cn_tree_node *tn);
+
 enum hse_mclass
 cn_tree_node_mclass(struct cn_tree_node *tn, enum hse_mclass_policy_dtype dtype);
 
@@ -263,6 +305,14 @@ cn_kvset_can_zspill(struct kvset *ks, struct route_map *map);
 struct cn_tree_node *
 cn_tree_find_node(struct cn_tree *tree, uint64_t nodeid);
 
+/**
+ * cn_tree_rtombs_get() - collect copies of the rtombs of all kvsets in the tree
+ * @tree: cn tree (caller must hold the tree lock)
+ * @rv:   rtomb vector to which the copies are appended
+ */
+merr_t
+cn_tree_rtombs_get(struct cn_tree *tree, struct rtomb_vec *rv);
+
 #if HSE_MOCKING
 #include "cn_tree_internal_ut.h"
 #endif /* HSE_MOCKING */
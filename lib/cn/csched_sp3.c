@@ -8,6 +8,7 @@
 #include <math.h>
 #include <bsd/string.h>
 #include <sys/resource.h>
+#include <sys/statvfs.h>
 
 #include <hse/experimental.h>
 #include <hse/rest/headers.h>
@@ -30,6 +31,8 @@
 #include <hse/ikvdb/throttle.h>
 #include <hse/ikvdb/kvdb_rparams.h>
 #include <hse/ikvdb/hse_gparams.h>
+#include <hse/ikvdb/mclass_policy.h>
+#include <hse/mpool/mpool.h>
 
 #include "csched_sp3.h"
 #include "csched_sp3_work.h"
@@ -165,6 +168,10 @@ struct mpool;
 #define CSCHED_LEAF_PCT_MIN  1
 #define CSCHED_LEAF_PCT_MAX  99
 
+/* Leaf node access counts are sampled and decayed once per heat period.
+ */
+#define SP3_HEAT_PERIOD_SECS (15)
+
 struct sp3_qinfo {
     uint qjobs;
     uint qjobs_max;
@@ -641,6 +648,8 @@ sp3_refresh_thresholds(struct sp3 *sp)
 
     thresh.split_cnt_max = qthreads(sp, SP3_QNUM_SPLIT);
 
+    thresh.lcomp_vgc_pct = sp->rp->csched_vgc_pct;
+
     /* If thresholds have not changed there's nothing to do.  Otherwise, need to
      * recompute work trees.
      */
@@ -654,13 +663,14 @@ sp3_refresh_thresholds(struct sp3 *sp)
     }
 
     log_info("sp3 thresholds: rspill: min/max/wlenmb %u/%u/%lu, lcomp: max/pct/keys %u/%u%%/%u,"
-             " llen: min/max %u/%u, idlec: %u, idlem: %u, lscat: hwm/max %u/%u split %u",
+             " llen: min/max %u/%u, idlec: %u, idlem: %u, lscat: hwm/max %u/%u split %u"
+             " vgc %u%%",
              thresh.rspill_runlen_min, thresh.rspill_runlen_max, thresh.rspill_wlen_max >> 20,
              thresh.lcomp_runlen_max, thresh.lcomp_join_pct, thresh.lcomp_split_keys >> 20,
              thresh.llen_runlen_min, thresh.llen_runlen_max,
              thresh.llen_idlec, thresh.llen_idlem,
              thresh.lscat_hwm, thresh.lscat_runlen_max,
-             thresh.split_cnt_max);
+             thresh.split_cnt_max, thresh.lcomp_vgc_pct);
 }
 
 static void
@@ -840,6 +850,7 @@ sp3_dirty_node_locked(struct sp3 *sp, struct cn_tree_node *tn)
             sp3_node_remove(sp, spn, wtype_length);
             sp3_node_remove(sp, spn, wtype_scatter);
             sp3_node_remove(sp, spn, wtype_garbage);
+            sp3_node_remove(sp, spn, wtype_mclass);
         } else if (nkvsets > 0 && jobs < 1) {
             const uint64_t keys_uniq = cn_ns_keys_uniq(ns);
             const uint64_t keys = cn_ns_keys(ns);
@@ -936,6 +947,18 @@ sp3_dirty_node_locked(struct sp3 *sp, struct cn_tree_node *tn)
                 sp3_node_remove(sp, spn, wtype_join);
             }
 
+            /* Leaf nodes whose data should move to a different media class,
+             * demotions first (coldest first) so as to free up hot media
+             * budget, followed by promotions (hottest first).
+             */
+            if (spn->spn_migrate < 0) {
+                sp3_node_insert(sp, spn, wtype_mclass, UINT64_MAX - spn->spn_heat);
+            } else if (spn->spn_migrate > 0) {
+                sp3_node_insert(sp, spn, wtype_mclass, min_t(uint64_t, spn->spn_heat, INT64_MAX));
+            } else {
+                sp3_node_remove(sp, spn, wtype_mclass);
+            }
+
         } else if (nkvsets_total == 0) {
             struct cn_tree_node *left, *right;
 
@@ -1257,6 +1280,8 @@ sp3_trees_add(struct sp3 *sp)
 
         cn_samp_add(&sp->samp, &tree->ct_samp);
 
+        tree->ct_track_hits = (sp->rp->csched_hot_rate > 0);
+
         /* Move to the monitor's list. */
         list_del(&spt->spt_tlink);
         list_add(&spt->spt_tlink, &sp->mon_tlist);
@@ -1521,6 +1546,15 @@ sp3_comp_thread_name(
     case CN_RULE_JOIN:
         r = "nj";
         break;
+    case CN_RULE_VGARBAGE:
+        r = "vg";
+        break;
+    case CN_RULE_HOT:
+        r = "ht";
+        break;
+    case CN_RULE_COLD:
+        r = "cd";
+        break;
     case CN_RULE_MAX:
         r = "xx";
         break;
@@ -1863,6 +1897,185 @@ sp3_tree_shape_log(const struct cn_tree_node *tn, bool bad, const char *category
              cn_ns_clen(ns) >> MB_SHIFT, hll_pct, cn_ns_samp(ns));
 }
 
+/* Bytes of hot leaf node data the given media class may hold, as a
+ * percentage of the size of the file system on which it resides.
+ */
+static uint64_t
+sp3_hot_budget(struct sp3 *sp, struct mpool *mp, enum hse_mclass mclass)
+{
+    struct mpool_mclass_props props;
+    struct statvfs sv;
+    uint64_t size;
+    uint pct;
+
+    switch (mclass) {
+    case HSE_MCLASS_STAGING:
+        pct = sp->rp->csched_hot_staging_pct;
+        break;
+
+    case HSE_MCLASS_PMEM:
+        pct = sp->rp->csched_hot_pmem_pct;
+        break;
+
+    default:
+        return 0;
+    }
+
+    if (ev(mpool_mclass_props_get(mp, mclass, &props)))
+        return 0;
+
+    size = props.mc_fmaxsz * props.mc_filecnt;
+
+    if (!statvfs(props.mc_path, &sv))
+        size = min_t(uint64_t, size, (uint64_t)sv.f_blocks * sv.f_frsize);
+
+    return size / 100 * pct;
+}
+
+void
+sp3_heat_update(struct cn_tree *tree, uint64_t hot, uint64_t *used)
+{
+    struct cn_tree_node *tn;
+
+    tree->ct_track_hits = (hot > 0);
+
+    cn_tree_foreach_leaf(tn, tree) {
+        struct sp3_node *spn = tn2spn(tn);
+        struct kvset_list_entry *le;
+        uint64_t hits = 0;
+
+        list_for_each_entry(le, &tn->tn_kvset_list, le_link)
+            hits += kvset_reap_hits(le->le_kvset);
+
+        spn->spn_heat = (spn->spn_heat + hits) / 2;
+
+        if (tn->tn_hot || spn->spn_migrate > 0) {
+            if (hot == 0 || spn->spn_heat < hot / 2) {
+                if (spn->spn_migrate >= 0)
+                    spn->spn_migrate = tn->tn_hot ? -1 : 0;
+                continue;
+            }
+
+            *used += cn_ns_alen(&tn->tn_ns);
+        }
+    }
+}
+
+void
+sp3_heat_promote(struct cn_tree *tree, uint64_t hot, uint64_t budget, uint64_t *used)
+{
+    struct cn_tree_node *tn;
+
+    cn_tree_foreach_leaf(tn, tree) {
+        struct sp3_node *spn = tn2spn(tn);
+        const uint64_t alen = cn_ns_alen(&tn->tn_ns);
+
+        if (tn->tn_hot || spn->spn_migrate != 0 || spn->spn_heat < hot)
+            continue;
+
+        if (*used + alen > budget) {
+            ev_debug(1);
+            continue;
+        }
+
+        *used += alen;
+        spn->spn_migrate = 1;
+    }
+}
+
+/* Dirty the leaf nodes that are, or should be, on the wtype_mclass queue.
+ */
+static void
+sp3_heat_dirty_locked(struct sp3 *sp, struct cn_tree *tree)
+{
+    struct cn_tree_node *tn;
+
+    cn_tree_foreach_leaf(tn, tree) {
+        struct sp3_node *spn = tn2spn(tn);
+
+        if (spn->spn_migrate != 0 || !RB_EMPTY_NODE(&spn->spn_rbe[wtype_mclass].rbe_node))
+            sp3_dirty_node_locked(sp, tn);
+    }
+}
+
+/**
+ * sp3_heat_check() - migrate leaf nodes between media classes by access rate
+ * @sp: scheduler context
+ *
+ * A leaf node's heat is the number of get and cursor hits on its kvsets
+ * over the last heat period, exponentially decayed over prior periods.
+ * Nodes whose heat reaches csched_hot_rate (hits per second) are promoted
+ * to the media class the mclass policy assigns to root node values, so
+ * long as the hot data in that media class remains within its budget.
+ * Hot nodes whose heat falls below half that rate are demoted back to the
+ * leaf media class.  The data is moved by kv-compaction (see wtype_mclass)
+ * as mblocks cannot be cloned from one media class to another.
+ */
+static void
+sp3_heat_check(struct sp3 *sp)
+{
+    const uint64_t hot = (uint64_t)sp->rp->csched_hot_rate * SP3_HEAT_PERIOD_SECS;
+    uint64_t budgetv[HSE_MCLASS_COUNT] = { 0 };
+    uint64_t usedv[HSE_MCLASS_COUNT] = { 0 };
+    struct cn_tree *tree;
+    bool have_budget = false;
+
+    /* Update each leaf node's heat and select the hot nodes to demote.
+     * Nodes that remain hot (or are pending promotion) are charged to
+     * their hot media class's budget.
+     */
+    list_for_each_entry(tree, &sp->mon_tlist, ct_sched.sp3t.spt_tlink) {
+        const struct mclass_policy *policy = cn_get_mclass_policy(tree->cn);
+        enum hse_mclass mclass;
+        uint64_t unused = 0;
+        void *lock;
+
+        mclass = policy->mc_table[HSE_MPOLICY_AGE_ROOT][HSE_MPOLICY_DTYPE_VALUE];
+
+        if (!have_budget) {
+            for (uint i = 0; i < NELEM(budgetv); ++i)
+                budgetv[i] = sp3_hot_budget(sp, tree->mp, i);
+            have_budget = true;
+        }
+
+        rmlock_rlock(&tree->ct_lock, &lock);
+        if (mclass < NELEM(usedv))
+            sp3_heat_update(tree, hot, usedv + mclass);
+        else
+            sp3_heat_update(tree, 0, &unused);
+        sp3_heat_dirty_locked(sp, tree);
+        rmlock_runlock(lock);
+    }
+
+    if (hot == 0)
+        return;
+
+    /* Promote hot leaf nodes while there is room in the budget.
+     */
+    list_for_each_entry(tree, &sp->mon_tlist, ct_sched.sp3t.spt_tlink) {
+        const struct mclass_policy *policy = cn_get_mclass_policy(tree->cn);
+        enum hse_mclass mclass;
+        void *lock;
+
+        mclass = policy->mc_table[HSE_MPOLICY_AGE_ROOT][HSE_MPOLICY_DTYPE_VALUE];
+
+        if (mclass >= NELEM(usedv) ||
+            mclass == policy->mc_table[HSE_MPOLICY_AGE_LEAF][HSE_MPOLICY_DTYPE_VALUE])
+            continue;
+
+        rmlock_rlock(&tree->ct_lock, &lock);
+        sp3_heat_promote(tree, hot, budgetv[mclass], usedv + mclass);
+        sp3_heat_dirty_locked(sp, tree);
+        rmlock_runlock(lock);
+    }
+
+    if (debug_sched(sp)) {
+        log_info("hot bytes: staging %lum/%lum pmem %lum/%lum",
+                 usedv[HSE_MCLASS_STAGING] >> MB_SHIFT, budgetv[HSE_MCLASS_STAGING] >> MB_SHIFT,
+                 usedv[HSE_MCLASS_PMEM] >> MB_SHIFT, budgetv[HSE_MCLASS_PMEM] >> MB_SHIFT);
+    }
+}
+
 /**
  * sp3_tree_shape_check() - report on tree shape
  * @sp: scheduler context
@@ -2324,6 +2537,14 @@ sp3_schedule(struct sp3 *sp)
 
             job = sp3_check_rb_tree(sp, sp->rr_wtype, 0, qnum);
             break;
+
+        case wtype_mclass:
+            qnum = SP3_QNUM_SHARED;
+            if (sp->samp_reduce || qfull(sp, qnum))
+                break;
+
+            job = sp3_check_rb_tree(sp, sp->rr_wtype, 0, qnum);
+            break;
         }
     }
 }
@@ -2483,6 +2704,7 @@ sp3_monitor(struct work_struct *work)
     struct periodic_check chk_sched   = { .interval = NSEC_PER_SEC * 3 };
     struct periodic_check chk_refresh = { .interval = NSEC_PER_SEC * 17 };
     struct periodic_check chk_shape   = { .interval = NSEC_PER_SEC * 23 };
+    struct periodic_check chk_heat    = { .interval = NSEC_PER_SEC * SP3_HEAT_PERIOD_SECS };
     struct periodic_check chk_stats   = { .interval = NSEC_PER_SEC * 300 };
 
     chk_refresh.next = get_time_ns() + chk_refresh.interval;
@@ -2561,6 +2783,11 @@ sp3_monitor(struct work_struct *work)
             sp3_tree_shape_check(sp);
         }
 
+        if (now > chk_heat.next) {
+            chk_heat.next = now + chk_heat.interval;
+            sp3_heat_check(sp);
+        }
+
         if (now > chk_stats.next) {
             chk_stats.next = now + chk_stats.interval;
             sp3_stats(sp);
@@ -36,6 +36,8 @@ struct sp3_node {
     struct sp3_rbe   spn_rbe[wtype_MAX];
     struct list_head spn_rlink;
     struct list_head spn_alink;
+    uint64_t         spn_heat;     /* decayed hits per heat check period */
+    int8_t           spn_migrate;  /* 1: promote, -1: demote (see sp3_heat_check) */
     bool             spn_managed;
 };
 
@@ -98,6 +100,30 @@ sp3_tree_add(struct csched *handle, struct cn_tree *tree);
 void
 sp3_tree_remove(struct csched *handle, struct cn_tree *tree, bool cancel);
 
+/**
+ * sp3_heat_update() - update leaf node heat and select hot nodes to demote
+ * @tree: cn tree
+ * @hot:  heat at which a leaf node is hot, zero to demote all hot nodes
+ * @used: (in/out) bytes of hot data in the tree's hot media class
+ *
+ * Leaf nodes that remain hot, or are pending promotion, are charged to
+ * %used.  Caller must hold the tree lock (see sp3_heat_check).
+ */
+void
+sp3_heat_update(struct cn_tree *tree, uint64_t hot, uint64_t *used);
+
+/**
+ * sp3_heat_promote() - select hot leaf nodes to promote
+ * @tree:   cn tree
+ * @hot:    heat at which a leaf node is hot (non-zero)
+ * @budget: bytes of hot data the tree's hot media class may hold
+ * @used:   (in/out) bytes of hot data in the tree's hot media class
+ *
+ * Caller must hold the tree lock (see sp3_heat_check).
+ */
+void
+sp3_heat_promote(struct cn_tree *tree, uint64_t hot, uint64_t budget, uint64_t *used);
+
 #if HSE_MOCKING
 #include "csched_sp3_ut.h"
 #endif /* HSE_MOCKING */
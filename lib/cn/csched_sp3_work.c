@@ -480,6 +480,14 @@ sp3_work_wtype_split(
             if (atomic_read(&tree->ct_split_cnt) >= thresh->split_cnt_max ||
                 jclock_ns < tree->ct_split_dly) {
 
+                tn->tn_ss_visits = 0;
+            } else if (tree->ct_rspill_pbuild > 0) {
+                /* A parallel spill holds spill refs on all leaves and will not
+                 * wait for a split, so we must not commit to one until it has
+                 * finished.  Meanwhile, hold off new parallel spills so that
+                 * this split isn't starved.
+                 */
+                tree->ct_rspill_pdefer = jclock_ns + NSEC_PER_SEC;
                 tn->tn_ss_visits = 0;
             } else if (spilling && tn->tn_ss_visits < thresh->split_cnt_max) {
                 tn->tn_ss_visits++;
@@ -597,6 +605,9 @@ sp3_work_wtype_join(
             if (atomic_read(&tree->ct_split_cnt) >= thresh->split_cnt_max ||
                 jclock_ns < tree->ct_split_dly) {
 
+                tn->tn_ss_visits = 0;
+            } else if (tree->ct_rspill_pbuild > 0) {
+                tree->ct_rspill_pdefer = jclock_ns + NSEC_PER_SEC;
                 tn->tn_ss_visits = 0;
             } else if (spilling && tn->tn_ss_visits < thresh->split_cnt_max) {
                 tn->tn_ss_visits++;
@@ -653,6 +664,40 @@ sp3_work_wtype_join(
     return kvsets;
 }
 
+/* Move a leaf node's data to the media class of its new temperature by
+ * kv-compacting its oldest kvsets, which hold the bulk of its data.  Any
+ * remaining kvsets are rewritten to the new media class by subsequent
+ * compactions, as are new kvsets spilled into the node.
+ */
+static uint
+sp3_work_wtype_mclass(
+    struct sp3_node          *spn,
+    struct sp3_thresholds    *thresh,
+    struct kvset_list_entry **mark,
+    enum cn_action           *action,
+    enum cn_rule             *rule)
+{
+    struct cn_tree_node *tn = spn2tn(spn);
+    struct kvset_list_entry *le;
+    uint kvsets;
+
+    if (!spn->spn_migrate)
+        return 0;
+
+    *mark = list_last_entry_or_null(&tn->tn_kvset_list, typeof(*le), le_link);
+
+    kvsets = cn_ns_kvsets(&tn->tn_ns);
+    kvsets = min_t(uint, kvsets, thresh->lcomp_runlen_max);
+
+    *action = CN_ACTION_COMPACT_KV;
+    *rule = (spn->spn_migrate > 0) ? CN_RULE_HOT : CN_RULE_COLD;
+
+    tn->tn_hot = (spn->spn_migrate > 0);
+    spn->spn_migrate = 0;
+
+    return kvsets;
+}
+
 static uint
 sp3_work_wtype_garbage(
     struct sp3_node          *spn,
@@ -675,18 +720,44 @@ sp3_work_wtype_garbage(
         return kvsets;
     }
 
+    head = &tn->tn_kvset_list;
+    *mark = list_last_entry_or_null(head, typeof(*le), le_link);
+
+    kvsets = cn_ns_kvsets(&tn->tn_ns);
+    kvsets = min_t(uint, kvsets, thresh->lcomp_runlen_max);
+
+    /* If most of the node's vblock garbage lives in dirty vblocks then a
+     * k-compaction that rewrites only the values in those vblocks reclaims
+     * it at a fraction of the cost of a kv-compaction.
+     */
+    if (thresh->lcomp_vgc_pct > 0 && kvsets > 1) {
+        uint64_t vgc = 0;
+        uint n = 0;
+
+        list_for_each_entry_reverse(le, head, le_link) {
+            if (n++ == kvsets)
+                break;
+
+            vgc += kvset_vgc_bytes(le->le_kvset, thresh->lcomp_vgc_pct);
+        }
+
+        if (vgc > 0 && vgc * 2 >= cn_ns_vgarb(&tn->tn_ns)) {
+            *action = CN_ACTION_COMPACT_K;
+            *rule = CN_RULE_VGARBAGE;
+            ev_debug(1);
+
+            return kvsets;
+        }
+    }
+
     /* There is no low-hanging fruit, so until we have zcompact
      * we must issue a heavy-weight kv-compaction.
      */
-    head = &tn->tn_kvset_list;
-    *mark = list_last_entry_or_null(head, typeof(*le), le_link);
     *action = CN_ACTION_COMPACT_KV;
     *rule = CN_RULE_GARBAGE;
     ev_debug(1);
 
-    kvsets = cn_ns_kvsets(&tn->tn_ns);
-
-    return min_t(uint, kvsets, thresh->lcomp_runlen_max);
+    return kvsets;
 }
 
 static uint
@@ -1013,6 +1084,10 @@ sp3_work(
             n_kvsets = sp3_work_wtype_garbage(spn, thresh, &mark, &action, &rule);
             break;
 
+        case wtype_mclass:
+            n_kvsets = sp3_work_wtype_mclass(spn, thresh, &mark, &action, &rule);
+            break;
+
         case wtype_scatter:
             n_kvsets = sp3_work_wtype_scatter(spn, thresh, &mark, &action, &rule);
             break;
@@ -1082,6 +1157,9 @@ sp3_work(
     w->cw_rule = rule;
     w->cw_t0_enqueue = get_time_ns();
 
+    if (rule == CN_RULE_VGARBAGE)
+        w->cw_vgc_pct = thresh->lcomp_vgc_pct;
+
     /* mark the kvsets with dgen_lo */
     w->cw_dgen_hi_min = kvset_get_dgen(mark->le_kvset);
     w->cw_dgen_lo = UINT64_MAX;
@@ -62,6 +62,7 @@ enum sp3_work_type {
     wtype_scatter,      /* leaf nodes: kv-compact to reduce vgroup scatter */
     wtype_split,        /* leaf nodes: split to eliminate large nodes */
     wtype_join,         /* leaf nodes: join to eliminate small nodes */
+    wtype_mclass,       /* leaf nodes: kv-compact to move between media classes */
     wtype_idle,         /* root+leaf nodes: kv-compact idle nodes */
     wtype_root,         /* root node: spill to leaves */
     wtype_MAX
@@ -81,6 +82,7 @@ struct sp3_thresholds {
     uint8_t  llen_idlec;
     uint8_t  llen_idlem;
     uint8_t  split_cnt_max;       /* max node splits per batch */
+    uint8_t  lcomp_vgc_pct;       /* leaf vblock gc garbage percentage threshold */
 };
 
 /* MTF_MOCK */
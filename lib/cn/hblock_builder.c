@@ -14,6 +14,7 @@
 #include <hse/ikvdb/cn.h>
 #include <hse/ikvdb/kvset_builder.h>
 #include <hse/ikvdb/mclass_policy.h>
+#include <hse/ikvdb/rtomb.h>
 #include <hse/util/alloc.h>
 #include <hse/util/event_counter.h>
 #include <hse/error/merr.h>
@@ -39,6 +40,10 @@ struct hblock_builder {
     uint32_t                   max_size;
     uint32_t                   nptombs;
     enum hse_mclass_policy_age agegroup;
+    size_t                     rtomb_bytes;
+    struct rtomb_vec           rtombs;
+    const uint32_t            *vbusedv;
+    uint32_t                   vbusedc;
 };
 
 static unsigned int
@@ -57,6 +62,9 @@ make_header(
     const uint32_t num_vblocks,
     const uint32_t ptree_pgc,
     const uint32_t vgmap_pgc,
+    const uint32_t num_rtombs,
+    const uint32_t rtomb_pgc,
+    const uint32_t vbused_pgc,
     const struct key_obj *const min_pfx,
     const struct key_obj *const max_pfx)
 {
@@ -81,6 +89,17 @@ make_header(
     omf_set_hbh_ptree_data_off_pg(hdr, HBLOCK_HDR_PAGES + vgmap_pgc + HLOG_PGC);
     omf_set_hbh_ptree_data_len_pg(hdr, ptree_pgc);
 
+    omf_set_hbh_num_rtombs(hdr, num_rtombs);
+    omf_set_hbh_rtomb_off_pg(hdr, HBLOCK_HDR_PAGES + vgmap_pgc + HLOG_PGC + ptree_pgc);
+    omf_set_hbh_rtomb_len_pg(hdr, rtomb_pgc);
+
+    /* Vblock usage follows the range tombstones, a zero length means the
+     * usage of the kvset's vblocks is unknown.
+     */
+    omf_set_hbh_vbused_off_pg(hdr, vbused_pgc ?
+                              HBLOCK_HDR_PAGES + vgmap_pgc + HLOG_PGC + ptree_pgc + rtomb_pgc : 0);
+    omf_set_hbh_vbused_len_pg(hdr, vbused_pgc);
+
     if (max_pfx) {
         unsigned int max_pfx_len = 0;
 
@@ -151,6 +170,78 @@ hbb_add_ptomb(
     return !added ? merr(EXFULL) : err;
 }
 
+static size_t
+rtomb_omf_size(const struct rtomb *rt)
+{
+    return sizeof(struct rtomb_omf) + rt->rt_slen + rt->rt_elen;
+}
+
+merr_t
+hbb_add_rtomb(struct hblock_builder *bld, const struct rtomb *rt)
+{
+    struct rtomb *copy;
+    size_t avail;
+    merr_t err;
+
+    avail = (available_pgc(bld) - bld->ptree_pgc) * PAGE_SIZE;
+    if (bld->rtomb_bytes + rtomb_omf_size(rt) > avail)
+        return merr(EXFULL);
+
+    copy = rtomb_alloc(rtomb_start(rt), rt->rt_slen, rtomb_end(rt), rt->rt_elen, rt->rt_seqno);
+    if (ev(!copy))
+        return merr(ENOMEM);
+
+    err = rtomb_vec_add(&bld->rtombs, copy);
+    if (ev(err)) {
+        free(copy);
+        return err;
+    }
+
+    bld->rtomb_bytes += rtomb_omf_size(rt);
+
+    return 0;
+}
+
+uint32_t
+hbb_get_nrtombs(const struct hblock_builder *bld)
+{
+    return bld->rtombs.rv_cnt;
+}
+
+void
+hbb_set_vblock_usage(struct hblock_builder *bld, const uint32_t *vbusedv, uint32_t nvblks)
+{
+    bld->vbusedv = vbusedv;
+    bld->vbusedc = nvblks;
+}
+
+static void
+make_vblock_usage(const uint32_t *vbusedv, uint32_t nvblks, void *outbuf)
+{
+    struct vbused_omf *omf = outbuf;
+
+    for (uint32_t i = 0; i < nvblks; ++i, ++omf)
+        omf_set_vbu_used(omf, vbusedv[i]);
+}
+
+static void
+make_rtombs(const struct rtomb_vec *rv, void *outbuf)
+{
+    char *p = outbuf;
+
+    for (uint32_t i = 0; i < rv->rv_cnt; ++i) {
+        const struct rtomb *rt = rv->rv_v[i];
+        struct rtomb_omf *omf = (void *)p;
+
+        omf_set_rto_seqno(omf, rt->rt_seqno);
+        omf_set_rto_slen(omf, rt->rt_slen);
+        omf_set_rto_elen(omf, rt->rt_elen);
+
+        memcpy(omf + 1, rt->rt_data, rt->rt_slen + rt->rt_elen);
+        p += rtomb_omf_size(rt);
+    }
+}
+
 merr_t
 hbb_create(struct hblock_builder **bld_out, const struct cn *const cn, struct perfc_set *pc)
 {
@@ -164,6 +255,10 @@ hbb_create(struct hblock_builder **bld_out, const struct cn *const cn, struct pe
         return merr(ENOMEM);
 
     bld->nptombs = 0;
+    bld->rtomb_bytes = 0;
+    memset(&bld->rtombs, 0, sizeof(bld->rtombs));
+    bld->vbusedv = NULL;
+    bld->vbusedc = 0;
     bld->mpool = cn_get_mpool(cn);
     bld->cn = cn;
     bld->pc = pc;
@@ -199,6 +294,7 @@ hbb_destroy(struct hblock_builder *bld)
         return;
 
     wbb_destroy(bld->ptree);
+    rtomb_vec_fini(&bld->rtombs, true);
     free(bld);
 }
 
@@ -222,7 +318,8 @@ hbb_finish(
     merr_t err;
     enum hse_mclass mclass;
     uint64_t blkid = 0;
-    uint32_t vgmap_pgc = 0;
+    uint32_t vgmap_pgc = 0, rtomb_pgc = 0, vbused_pgc = 0;
+    void *rtbuf = NULL, *vubuf = NULL;
     struct iovec *iov = NULL;
     unsigned int iov_max, iov_idx = 0;
     size_t wlen = 0, sz;
@@ -236,10 +333,10 @@ hbb_finish(
         return merr(EINVAL);
 
     /* In the event that no kblocks were emitted and there are no entries in the
-     * ptree, there is no data within containing kvset. Skip the allocation of
-     * the hblock. This kvset will not be written to disk.
+     * ptree nor any rtombs, there is no data within containing kvset. Skip the
+     * allocation of the hblock. This kvset will not be written to disk.
      */
-    if (num_kblocks == 0 && (!wbb_entries(bld->ptree) && !ptree))
+    if (num_kblocks == 0 && (!wbb_entries(bld->ptree) && !ptree) && bld->rtombs.rv_cnt == 0)
         return 0;
 
     assert(!ptree || (ptree_desc && ptree_pgc > 0));
@@ -269,10 +366,39 @@ hbb_finish(
         iov_max += 1 + wbb_max_inodec_get(bld->ptree) + wbb_kmd_pgc_get(bld->ptree);
     }
 
+    if (bld->rtombs.rv_cnt > 0) {
+        iov_max++;
+        rtomb_pgc = roundup(bld->rtomb_bytes, PAGE_SIZE) / PAGE_SIZE;
+
+        rtbuf = aligned_alloc(PAGE_SIZE, rtomb_pgc * PAGE_SIZE);
+        if (!rtbuf)
+            return merr(ENOMEM);
+
+        memset(rtbuf, 0, rtomb_pgc * PAGE_SIZE);
+        make_rtombs(&bld->rtombs, rtbuf);
+    }
+
+    if (bld->vbusedc > 0 && bld->vbusedc == num_vblocks) {
+        iov_max++;
+        vbused_pgc = roundup(num_vblocks * sizeof(struct vbused_omf), PAGE_SIZE) / PAGE_SIZE;
+
+        vubuf = aligned_alloc(PAGE_SIZE, vbused_pgc * PAGE_SIZE);
+        if (!vubuf) {
+            free(rtbuf);
+            return merr(ENOMEM);
+        }
+
+        memset(vubuf, 0, vbused_pgc * PAGE_SIZE);
+        make_vblock_usage(bld->vbusedv, num_vblocks, vubuf);
+    }
+
     sz = HBLOCK_HDR_LEN + (vgmap ? (vgmap_pgc * PAGE_SIZE) : 0);
     hdr = aligned_alloc(PAGE_SIZE, sz);
-    if (!hdr)
+    if (!hdr) {
+        free(vubuf);
+        free(rtbuf);
         return merr(ENOMEM);
+    }
     memset(hdr, 0, sz);
 
     iov = malloc(sizeof(*iov) * iov_max);
@@ -316,8 +442,32 @@ hbb_finish(
         wbb_min_max_keys(bld->ptree, min_pfxp, max_pfxp);
     }
 
+    if (rtbuf) {
+        if (ev(ptree_pgc + rtomb_pgc > available_pgc(bld))) {
+            err = merr(EXFULL);
+            goto out;
+        }
+
+        /* Range tombstones follow the ptree */
+        iov[iov_idx].iov_base = rtbuf;
+        iov[iov_idx++].iov_len = rtomb_pgc * PAGE_SIZE;
+    }
+
+    if (vubuf) {
+        /* Vblock usage is only advisory, so omit it rather than fail
+         * the build if the hblock is full.
+         */
+        if (ev(ptree_pgc + rtomb_pgc + vbused_pgc > available_pgc(bld))) {
+            vbused_pgc = 0;
+        } else {
+            iov[iov_idx].iov_base = vubuf;
+            iov[iov_idx++].iov_len = vbused_pgc * PAGE_SIZE;
+        }
+    }
+
     make_header(hdr, min_seqno, max_seqno, num_ptombs, num_kblocks, num_vblocks,
-                ptree_pgc, vgmap_pgc, min_pfxp, max_pfxp);
+                ptree_pgc, vgmap_pgc, bld->rtombs.rv_cnt, rtomb_pgc, vbused_pgc,
+                min_pfxp, max_pfxp);
 
     if (vgmap)
         make_vgroup_map(vgmap, ((char *)hdr) + HBLOCK_HDR_LEN);
@@ -355,6 +505,8 @@ out:
 
     free(iov);
     free(hdr);
+    free(rtbuf);
+    free(vubuf);
 
     return err;
 }
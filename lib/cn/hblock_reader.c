@@ -9,10 +9,12 @@
 #include <errno.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
 
 #include <hse/util/compiler.h>
 #include <hse/util/event_counter.h>
 #include <hse/error/merr.h>
+#include <hse/ikvdb/rtomb.h>
 
 #include "kvset.h"
 #include "hblock_reader.h"
@@ -27,7 +29,8 @@ hblock_hdr_valid(const struct hblock_hdr_omf *omf)
     const uint32_t version = omf_hbh_version(omf);
     const uint32_t magic   = omf_hbh_magic(omf);
 
-    return HSE_LIKELY(magic == HBLOCK_HDR_MAGIC && version == HBLOCK_HDR_VERSION);
+    return HSE_LIKELY(magic == HBLOCK_HDR_MAGIC &&
+                      version >= HBLOCK_HDR_VERSION1 && version <= HBLOCK_HDR_VERSION);
 }
 
 void
@@ -174,6 +177,93 @@ hbr_read_vgroup_map(const struct kvs_mblk_desc *hbd, struct vgmap *vgmap, bool *
     return 0;
 }
 
+merr_t
+hbr_read_rtombs(const struct kvs_mblk_desc *hbd, struct rtomb_vec *rv)
+{
+    const struct hblock_hdr_omf *hdr = hbd->map_base;
+    const char *p, *end;
+    uint32_t nrtombs;
+
+    if (omf_hbh_version(hdr) < HBLOCK_HDR_VERSION2)
+        return 0; /* rtombs were introduced in version 2 */
+
+    nrtombs = omf_hbh_num_rtombs(hdr);
+    if (nrtombs == 0)
+        return 0;
+
+    p = hbd->map_base + omf_hbh_rtomb_off_pg(hdr) * PAGE_SIZE;
+    end = p + omf_hbh_rtomb_len_pg(hdr) * PAGE_SIZE;
+
+    if (ev(end > (char *)hbd->map_base + hbd->wlen_pages * PAGE_SIZE))
+        return merr(EPROTO);
+
+    for (uint32_t i = 0; i < nrtombs; ++i) {
+        const struct rtomb_omf *omf = (const void *)p;
+        uint slen, elen;
+        struct rtomb *rt;
+        merr_t err;
+
+        if (ev(p + sizeof(*omf) > end))
+            return merr(EPROTO);
+
+        slen = omf_rto_slen(omf);
+        elen = omf_rto_elen(omf);
+        p += sizeof(*omf);
+
+        if (ev(p + slen + elen > end))
+            return merr(EPROTO);
+
+        rt = rtomb_alloc(p, slen, p + slen, elen, omf_rto_seqno(omf));
+        if (ev(!rt))
+            return merr(ENOMEM);
+
+        err = rtomb_vec_add(rv, rt);
+        if (ev(err)) {
+            free(rt);
+            return err;
+        }
+
+        p += slen + elen;
+    }
+
+    return 0;
+}
+
+merr_t
+hbr_read_vblock_usage(
+    const struct kvs_mblk_desc *hbd,
+    uint32_t                    nvblks,
+    uint32_t                   *vbusedv,
+    bool                       *found)
+{
+    const struct hblock_hdr_omf *hdr = hbd->map_base;
+    const struct vbused_omf *omf;
+    uint32_t len_pg;
+
+    *found = false;
+
+    if (omf_hbh_version(hdr) < HBLOCK_HDR_VERSION3)
+        return 0; /* vblock usage was introduced in version 3 */
+
+    len_pg = omf_hbh_vbused_len_pg(hdr);
+    if (len_pg == 0 || nvblks == 0)
+        return 0;
+
+    if (ev(omf_hbh_num_vblocks(hdr) != nvblks ||
+           nvblks * sizeof(*omf) > len_pg * PAGE_SIZE ||
+           omf_hbh_vbused_off_pg(hdr) + len_pg > hbd->wlen_pages))
+        return merr(EPROTO);
+
+    omf = hbd->map_base + omf_hbh_vbused_off_pg(hdr) * PAGE_SIZE;
+
+    for (uint32_t i = 0; i < nvblks; ++i)
+        vbusedv[i] = omf_vbu_used(omf + i);
+
+    *found = true;
+
+    return 0;
+}
+
 void
 hbr_read_ptree(
     const struct kvs_mblk_desc *hbd,
@@ -15,6 +15,7 @@
 #include <hse/error/merr.h>
 
 struct kvs_mblk_desc;
+struct rtomb_vec;
 struct wbt_desc;
 struct vgmap;
 
@@ -128,6 +129,31 @@ hbr_read_ptree(
     uint8_t                   **ptree,
     uint32_t                   *ptree_pgc);
 
+/**
+ * Read the range tombstones from the hblock.
+ *
+ * @param hbd hblock descriptor
+ * @param[in,out] rv rtomb vector to which the rtombs are appended (caller
+ *                must free them via rtomb_vec_fini(rv, true))
+ */
+merr_t
+hbr_read_rtombs(const struct kvs_mblk_desc *hbd, struct rtomb_vec *rv);
+
+/**
+ * Read the live bytes of each of the kvset's vblocks from the hblock.
+ *
+ * @param hbd hblock descriptor
+ * @param nvblks number of vblocks in the kvset
+ * @param[out] vbusedv live bytes per vblock (@nvblks entries)
+ * @param[out] found set if the hblock records vblock usage
+ */
+merr_t
+hbr_read_vblock_usage(
+    const struct kvs_mblk_desc *hbd,
+    uint32_t                    nvblks,
+    uint32_t                   *vbusedv,
+    bool                       *found);
+
 #if HSE_MOCKING
 #include "hblock_reader_ut.h"
 #endif /* HSE_MOCKING */
@@ -14,6 +14,7 @@
 #include "omf.h"
 #include "intern_builder.h"
 #include "wbt_builder.h"
+#include "wbt_internal.h"
 
 /**
  * struct intern_node - node data
@@ -265,6 +266,7 @@ ib_node_publish(struct intern_level *ib, uint last_child)
     size_t              lcp_len = ib->node_lcp_len;
     struct wbt_ine_omf *entry; /* (out) current key entry ptr */
     void *              sfxp;  /* (out) current suffix ptr */
+    uint32_t *          fpv;   /* (out) key fingerprint array */
     int                 i;
     uint                nkey = ib->curr_rkeys_cnt;
 
@@ -287,6 +289,7 @@ ib_node_publish(struct intern_level *ib, uint last_child)
     }
 
     entry = cnode + sizeof(*node_hdr) + lcp_len;
+    fpv = cnode + wbt_ine_fpv_off(lcp_len, nkey);
     sfxp = cnode + PAGE_SIZE;
 
     for (i = 0; i < nkey; i++) {
@@ -294,6 +297,7 @@ ib_node_publish(struct intern_level *ib, uint last_child)
 
         sfxp -= sfx_len;
         memcpy(sfxp, k->kdata + lcp_len, sfx_len);
+        fpv[i] = cpu_to_be32(wbt_ine_fp(sfxp, sfx_len));
         omf_set_ine_koff(entry, sfxp - cnode);
         omf_set_ine_left_child(entry, k->child_idx);
 
@@ -305,8 +309,9 @@ ib_node_publish(struct intern_level *ib, uint last_child)
         k = (void *)k + roundup(sizeof(*k) + k->klen, __alignof__(*k));
     }
 
-    /* should have space for this last entry */
-    assert((void *)(entry) <= sfxp);
+    /* should have space for this last entry and the fingerprints */
+    assert((void *)(entry + 1) <= (void *)fpv);
+    assert((void *)(fpv + nkey) <= sfxp);
 
     /* Create rightmost edge entry -- yes, it uses 'ine_left_child' member.
      */
@@ -483,20 +488,19 @@ key_add(
      */
     while (l) {
         uint used;
-        uint ine_sz = sizeof(struct wbt_ine_omf);
-        uint hdr_sz = sizeof(struct wbt_node_hdr_omf);
+        uint fp_sz = WBT_INE_FP_LEN;
         uint lcp_len = ib_lcp_len(l, right_edge); /* new lcp len if key is added */
 
         /* All internal nodes must have a right edge. Adding one to
          * the level's l->curr_rkeys_cnt accounts for this.
          *
-         * used = hdr_sz + lcp_len + tot_klen - lcp_savings + ines
+         * used = hdr_sz + lcp_len + ines + align + fps + tot_klen - lcp_savings
          */
-        used = hdr_sz + lcp_len + l->curr_rkeys_sum - (l->curr_rkeys_cnt * lcp_len) +
-               ((1 + l->curr_rkeys_cnt) * ine_sz);
+        used = wbt_ine_fpv_off(lcp_len, l->curr_rkeys_cnt + 1) + (l->curr_rkeys_cnt * fp_sz) +
+               l->curr_rkeys_sum - (l->curr_rkeys_cnt * lcp_len);
 
         /* Check if this key will prompt a new node at this level */
-        if (used + ine_sz + right_edge_klen - lcp_len > PAGE_SIZE) {
+        if (used + fp_sz + right_edge_klen - lcp_len > PAGE_SIZE) {
 
             /* Count this key as the right edge of the current node
              * and finish the node.
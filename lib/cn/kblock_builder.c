@@ -21,6 +21,7 @@
 #include <hse/util/page.h>
 #include <hse/util/assert.h>
 #include <hse/util/bloom_filter.h>
+#include <hse/util/fuse_filter.h>
 #include <hse/util/event_counter.h>
 #include <hse/util/perfc.h>
 #include <hse/util/hlog.h>
@@ -87,15 +88,40 @@ struct hash_set {
     struct hash_set_part *curr_part;
 };
 
+/**
+ * struct kblock_bloom - a kblock filter under construction
+ * @hash_set:  Hash set to store key hashes. Used to build
+ *             Bloom filter at end of kblock construction.
+ * @pgc:       Number of pages reserved for the filter.
+ * @elt_cap:   Number of hashes the filter can hold at current size
+ * @nhashes:   Number of hashes in @hash_set
+ * @buf:       Filter image
+ * @len:       Length of the filter image
+ * @alloc_len: Allocated size of @buf
+ * @used_max:  Max length of @buf ever used (for vlb_free())
+ */
+struct kblock_bloom {
+    struct hash_set hash_set;
+    uint32_t        pgc;
+    uint            elt_cap;
+    uint            nhashes;
+    void           *buf;
+    uint            len;
+    uint            alloc_len;
+    uint            used_max;
+};
+
 /**
  * struct curr_kblock - context for building a single kblock
  * @wbtree: Wbtree builder handle.
  * @max_pgc:  Max size of kblock in pages.
  * @wbt_pgc:  Number of pages reserved for wbtree.
- * @blm_pgc:  Number of pages reserved for Bloom filter.
- * @bloom_elt_cap: Number of keys Bloom filter can hold at current size
- * @hash_set:  Hash set to store key hashes. Used to build
- *             Bloom filter at end of kblock construction.
+ * @blm:       Bloom filter on full keys
+ * @pblm:      Bloom filter on key prefixes of length @pfx_len
+ * @desc:      Blocked bloom bits and hashes per key
+ * @fpbits:    Fuse filter fingerprint size (zero for a blocked bloom)
+ * @pfx_len:   Prefix filter key length (zero if disabled)
+ * @pfx_last:  Prefix most recently added to @pblm
  * @num_keys:  Number of keys in kblock.
  * @num_tombstones:  Number of keys in kblock that have tombstone values.
  * @total_key_bytes: Sum of all key lengths.
@@ -123,7 +149,13 @@ struct hash_set {
  *
  *   Wbtree occupies next wbt_pgc pages.
  *
- *   Bloom tree occupies next blm_pbc pages.
+ *   Bloom tree occupies next blm_pbc pages.  It holds either a blocked
+ *   bloom filter or, with cn_bloom_type=fuse, a binary fuse filter.  Both
+ *   are built at kblock finish time from the key hashes in @blm.
+ *
+ *   Prefix bloom occupies next pblm.pgc pages.  It is built the same way
+ *   from the hashes of the distinct @pfx_len byte prefixes of the kblock's
+ *   keys, and is empty unless cn_bloom_pfx is set.
  */
 struct curr_kblock {
 
@@ -141,25 +173,24 @@ struct curr_kblock {
 
     uint32_t max_size;
     uint32_t max_pgc;
-    uint32_t blm_pgc;
     uint32_t wbt_pgc;
 
-    uint                   blm_elt_cap;
-    struct hash_set        hash_set;
+    struct kblock_bloom    blm;
+    struct kblock_bloom    pblm;
     struct bf_bithash_desc desc;
+    uint32_t               fpbits;
+    uint32_t               pfx_len;
+    uint8_t                pfx_last[HSE_KVS_PFX_LEN_MAX];
 
     void *kblk_hdr;
     struct hlog *hlog;
-    void *bloom;
-    uint  bloom_len;
-    uint  bloom_alloc_len;
-    uint  bloom_used_max;
 };
 
 static HSE_ALWAYS_INLINE uint32_t
 available_pgc(struct curr_kblock *kblk)
 {
-    const uint32_t used = KBLOCK_HDR_PAGES + HLOG_PGC + kblk->blm_pgc + kblk->wbt_pgc;
+    const uint32_t used = KBLOCK_HDR_PAGES + HLOG_PGC + kblk->blm.pgc + kblk->pblm.pgc +
+        kblk->wbt_pgc;
 
     assert(kblk->max_pgc >= used);
     if (kblk->max_pgc >= used)
@@ -380,7 +411,7 @@ hash_set_init(struct hash_set *hs)
 }
 
 static merr_t
-hash_set_add(struct hash_set *hs, const struct key_obj *kobj)
+hash_set_add(struct hash_set *hs, uint64_t hash)
 {
     if (!hs->curr_part) {
         hs->curr_part = vlb_alloc(VLB_ALLOCSZ_MAX);
@@ -394,7 +425,7 @@ hash_set_add(struct hash_set *hs, const struct key_obj *kobj)
 
     assert(hs->curr_part->n_hashes < HSP_HASH_MAX_KEYS);
 
-    hs->curr_part->hashvec[hs->curr_part->n_hashes++] = key_obj_hash64(kobj);
+    hs->curr_part->hashvec[hs->curr_part->n_hashes++] = hash;
 
     /* If full, then use next part.  If next is null, allocate new
      * part next time one is added.
@@ -449,6 +480,93 @@ hash_set_free(struct hash_set *hs)
  *
  * kblock_free() -- free resources
  */
+/* Bloom false-positive target (parts per million) for kvsets built into the
+ * root node or a leaf node, either of which may override cn_bloom_prob.
+ */
+static uint32_t
+kblock_bloom_prob(const struct kvs_rparams *rp, enum hse_mclass_policy_age age)
+{
+    uint64_t prob = rp->cn_bloom_prob;
+
+    if (age == HSE_MPOLICY_AGE_ROOT && rp->cn_bloom_prob_root)
+        prob = rp->cn_bloom_prob_root;
+    else if (age == HSE_MPOLICY_AGE_LEAF && rp->cn_bloom_prob_leaf)
+        prob = rp->cn_bloom_prob_leaf;
+
+    return min_t(uint64_t, prob, UINT32_MAX);
+}
+
+static void
+kblock_set_bloom_prob(struct curr_kblock *kblk, uint32_t prob)
+{
+    kblk->desc = bf_compute_bithash_est(prob);
+    kblk->fpbits = 0;
+
+    if (kblk->rp->cn_bloom_type == CN_BLOOM_TYPE_FUSE)
+        kblk->fpbits = fuse_fpbits_est(prob);
+}
+
+/* Number of keys for which the reserved Bloom pages suffice.
+ */
+static uint
+kblock_bloom_elt_cap(struct curr_kblock *kblk, struct kblock_bloom *blm)
+{
+    const size_t sz = blm->pgc * PAGE_SIZE;
+
+    if (kblk->fpbits)
+        return fuse_element_estimate(kblk->fpbits, sz);
+
+    return bf_element_estimate(kblk->desc, sz);
+}
+
+/* Ensure we have enough pages reserved for the filter to hold one more hash.
+ * A fuse filter grows in whole segments, which may span several pages.
+ */
+static bool
+kblock_bloom_reserve(struct curr_kblock *kblk, struct kblock_bloom *blm)
+{
+    while (blm->nhashes + 1 > blm->elt_cap) {
+        if (!available_pgc(kblk))
+            return false;
+        blm->pgc++;
+        blm->elt_cap = kblock_bloom_elt_cap(kblk, blm);
+    }
+
+    return true;
+}
+
+static merr_t
+kblock_bloom_add(struct kblock_bloom *blm, uint64_t hash)
+{
+    merr_t err;
+
+    err = hash_set_add(&blm->hash_set, hash);
+    if (ev(err))
+        return err;
+
+    blm->nhashes++;
+
+    return 0;
+}
+
+static void
+kblock_bloom_reset(struct kblock_bloom *blm)
+{
+    blm->pgc = 0;
+    blm->elt_cap = 0;
+    blm->nhashes = 0;
+    blm->len = 0;
+
+    hash_set_reset(&blm->hash_set);
+}
+
+static void
+kblock_bloom_free(struct kblock_bloom *blm)
+{
+    vlb_free(blm->buf, blm->used_max);
+    hash_set_free(&blm->hash_set);
+}
+
 /**
  * kblock_init - initialize caller-supplied struct curr_kblock
  *
@@ -467,14 +585,18 @@ kblock_init(
 
     memset(kblk, 0, sizeof(*kblk));
 
-    hash_set_init(&kblk->hash_set);
+    hash_set_init(&kblk->blm.hash_set);
+    hash_set_init(&kblk->pblm.hash_set);
 
     kblk->max_size = max_size;
     kblk->max_pgc = max_size / PAGE_SIZE;
     kblk->rp = rp;
     kblk->cp = cp;
     kblk->pc = pc;
-    kblk->desc = bf_compute_bithash_est(rp->cn_bloom_prob);
+    kblock_set_bloom_prob(kblk, kblock_bloom_prob(rp, HSE_MPOLICY_AGE_LEAF));
+
+    if (rp->cn_bloom_pfx)
+        kblk->pfx_len = rp->cn_bloom_pfx_len ?: cp->pfx_len;
 
     err = hlog_create(&kblk->hlog, HLOG_PRECISION);
     if (ev(err))
@@ -501,11 +623,8 @@ kblock_reset(struct curr_kblock *kblk)
     kblk->num_keys = 0;
     kblk->num_tombstones = 0;
 
-    kblk->blm_pgc = 0;
-    kblk->blm_elt_cap = 0;
-    kblk->bloom_len = 0;
-
-    hash_set_reset(&kblk->hash_set);
+    kblock_bloom_reset(&kblk->blm);
+    kblock_bloom_reset(&kblk->pblm);
 
     hlog_reset(kblk->hlog);
     wbb_reset(kblk->wbtree, &kblk->wbt_pgc);
@@ -517,12 +636,12 @@ kblock_reset(struct curr_kblock *kblk)
 static void
 kblock_free(struct curr_kblock *kblk)
 {
-    vlb_free(kblk->bloom, kblk->bloom_used_max);
+    kblock_bloom_free(&kblk->blm);
+    kblock_bloom_free(&kblk->pblm);
     free(kblk->kblk_hdr);
 
     wbb_destroy(kblk->wbtree);
     hlog_destroy(kblk->hlog);
-    hash_set_free(&kblk->hash_set);
     memset(kblk, 0, sizeof(*kblk));
 }
 
@@ -554,21 +673,37 @@ kblock_add_entry(
     *added = false;
 
     if (kblk->rp->cn_bloom_create) {
+        uint8_t pfx[HSE_KVS_PFX_LEN_MAX];
+        bool    addpfx = false;
 
-        /* Ensure we have enough pages reserved for bloom filters. */
-        if (kblk->num_keys + 1 > kblk->blm_elt_cap) {
-            if (!available_pgc(kblk))
+        if (!kblock_bloom_reserve(kblk, &kblk->blm))
+            return 0;
+
+        /* Keys are added in order, so a prefix need only be added to
+         * the prefix filter when it differs from the previous one.
+         */
+        if (kblk->pfx_len && key_obj_len(kobj) >= kblk->pfx_len) {
+            key_obj_copy(pfx, kblk->pfx_len, NULL, kobj);
+
+            addpfx = !kblk->pblm.nhashes || memcmp(pfx, kblk->pfx_last, kblk->pfx_len);
+
+            if (addpfx && !kblock_bloom_reserve(kblk, &kblk->pblm))
                 return 0;
-            kblk->blm_pgc++;
-            kblk->blm_elt_cap = bf_element_estimate(kblk->desc, kblk->blm_pgc * PAGE_SIZE);
         }
 
         /* Add key's hash to hash_set.
          */
-        err = hash_set_add(&kblk->hash_set, kobj);
-
+        err = kblock_bloom_add(&kblk->blm, key_obj_hash64(kobj));
         if (ev(err))
             return err;
+
+        if (addpfx) {
+            err = kblock_bloom_add(&kblk->pblm, key_hash64(pfx, kblk->pfx_len));
+            if (ev(err))
+                return err;
+
+            memcpy(kblk->pfx_last, pfx, kblk->pfx_len);
+        }
     }
 
     /* update wbtree */
@@ -596,38 +731,102 @@ kblock_add_entry(
     return 0;
 }
 
-/* Finalize wbtree bloom filter.
+/* Build a fuse filter into the bloom buffer.  The hash set may hold one more
+ * hash than there are keys in the kblock (see kblock_add_entry()), which
+ * merely yields a false positive.
  */
 static merr_t
-kblock_finish_bloom(struct curr_kblock *kblk, struct bloom_hdr_omf *blm_hdr)
+kblock_finish_fuse(
+    struct curr_kblock   *kblk,
+    struct kblock_bloom  *blm,
+    struct bloom_hdr_omf *blm_hdr)
+{
+    struct fuse_filter    fuse;
+    struct hash_set_part *part;
+    uint64_t *hashv;
+    uint      hashc = blm->nhashes;
+    merr_t    err;
+
+    if (fuse_size_estimate(kblk->fpbits, hashc) > blm->len)
+        return merr(ENOSPC);
+
+    hashv = malloc(sizeof(*hashv) * hashc);
+    if (ev(!hashv))
+        return merr(ENOMEM);
+
+    hashc = 0;
+    list_for_each_entry (part, &blm->hash_set.part_list, part_link) {
+        memcpy(hashv + hashc, part->hashvec, sizeof(*hashv) * part->n_hashes);
+        hashc += part->n_hashes;
+    }
+
+    fuse_filter_init(&fuse, kblk->fpbits, hashc, blm->buf, blm->len);
+
+    err = fuse_filter_populate(&fuse, hashv, hashc);
+    free(hashv);
+    if (err)
+        return err;
+
+    memset(blm_hdr, 0, sizeof(*blm_hdr));
+    omf_set_bh_magic(blm_hdr, BLOOM_OMF_MAGIC);
+    omf_set_bh_version(blm_hdr, BLOOM_OMF_VERSION);
+    omf_set_bh_type(blm_hdr, BLOOM_OMF_FUSE);
+    omf_set_bh_fpbits(blm_hdr, fuse.ff_fpbits);
+    omf_set_bh_bitmapsz(blm_hdr, fuse.ff_arraylen * (fuse.ff_fpbits / 8));
+    omf_set_bh_modulus(blm_hdr, fuse.ff_segcntlen);
+    omf_set_bh_seglen(blm_hdr, fuse.ff_seglen);
+    omf_set_bh_seed(blm_hdr, fuse.ff_seed);
+
+    return 0;
+}
+
+/* Finalize a wbtree bloom filter (full key or prefix).
+ */
+static merr_t
+kblock_finish_bloom(
+    struct curr_kblock   *kblk,
+    struct kblock_bloom  *blm,
+    struct bloom_hdr_omf *blm_hdr)
 {
     struct bloom_filter   bloom;
     struct hash_set_part *part;
 
-    if (kblk->num_keys == 0 || kblk->rp->cn_bloom_create == 0) {
-        assert(kblk->blm_pgc == 0);
+    if (blm->nhashes == 0 || kblk->rp->cn_bloom_create == 0) {
+        assert(blm->pgc == 0);
         memset(&bloom, 0, sizeof(bloom));
     } else {
-        kblk->bloom_len = kblk->blm_pgc * PAGE_SIZE;
+        blm->len = blm->pgc * PAGE_SIZE;
 
-        if (kblk->bloom_len > kblk->bloom_alloc_len) {
-            kblk->bloom_alloc_len = roundup(kblk->bloom_len, 1u << 20);
+        if (blm->len > blm->alloc_len) {
+            blm->alloc_len = roundup(blm->len, 1u << 20);
 
-            vlb_free(kblk->bloom, kblk->bloom_used_max);
+            vlb_free(blm->buf, blm->used_max);
 
-            kblk->bloom = vlb_alloc(kblk->bloom_alloc_len);
-            if (ev(!kblk->bloom)) {
-                kblk->bloom_len = 0;
-                kblk->bloom_alloc_len = 0;
+            blm->buf = vlb_alloc(blm->alloc_len);
+            if (ev(!blm->buf)) {
+                blm->len = 0;
+                blm->alloc_len = 0;
                 return merr(ENOMEM);
             }
         }
 
-        kblk->bloom_used_max = max_t(uint, kblk->bloom_used_max, kblk->bloom_len);
+        blm->used_max = max_t(uint, blm->used_max, blm->len);
 
-        memset(kblk->bloom, 0, kblk->bloom_len);
-        bf_filter_init(&bloom, kblk->desc, kblk->num_keys, kblk->bloom, kblk->bloom_len);
-        list_for_each_entry (part, &kblk->hash_set.part_list, part_link) {
+        /* Should the fuse filter fail to build we fall back to a blocked
+         * bloom in the same space, at a higher false positive rate.
+         */
+        if (kblk->fpbits) {
+            merr_t err = kblock_finish_fuse(kblk, blm, blm_hdr);
+
+            if (!err)
+                return 0;
+
+            log_warnx("fuse filter build failed, %u keys", err, blm->nhashes);
+        }
+
+        memset(blm->buf, 0, blm->len);
+        bf_filter_init(&bloom, kblk->desc, blm->nhashes, blm->buf, blm->len);
+        list_for_each_entry (part, &blm->hash_set.part_list, part_link) {
             bf_filter_insert_by_hashv(&bloom, part->hashvec, part->n_hashes);
         }
     }
@@ -636,6 +835,7 @@ kblock_finish_bloom(struct curr_kblock *kblk, struct bloom_hdr_omf *blm_hdr)
     memset(blm_hdr, 0, sizeof(*blm_hdr));
     omf_set_bh_magic(blm_hdr, BLOOM_OMF_MAGIC);
     omf_set_bh_version(blm_hdr, BLOOM_OMF_VERSION);
+    omf_set_bh_type(blm_hdr, BLOOM_OMF_BLOCKED);
     omf_set_bh_bitmapsz(blm_hdr, bloom.bf_bitmapsz);
     omf_set_bh_modulus(blm_hdr, bloom.bf_modulus);
     omf_set_bh_bktshift(blm_hdr, bloom.bf_bktshift);
@@ -651,6 +851,7 @@ kblock_finish_bloom(struct curr_kblock *kblk, struct bloom_hdr_omf *blm_hdr)
  * - kblk: kblock handle
  * - wbt_hdr: wbtree header
  * - blm_hdr: Bloom filter header
+ * - pblm_hdr: prefix Bloom filter header
  * - hdr: (output) kblock header
  *
  * Notes:
@@ -661,6 +862,7 @@ kblock_make_header(
     struct curr_kblock    *kblk,
     struct wbt_hdr_omf    *wbt_hdr,
     struct bloom_hdr_omf  *blm_hdr,
+    struct bloom_hdr_omf  *pblm_hdr,
     struct kblock_hdr_omf *hdr)
 {
     void *          base;
@@ -675,7 +877,7 @@ kblock_make_header(
     off = 0;
 
     assert(
-        sizeof(*hdr) + sizeof(*wbt_hdr) + sizeof(*blm_hdr) + 4 * align +
+        sizeof(*hdr) + sizeof(*wbt_hdr) + 2 * sizeof(*blm_hdr) + 5 * align +
             2 * HSE_KBLOCK_OMF_KLEN_MAX <=
         PAGE_SIZE);
 
@@ -705,6 +907,13 @@ kblock_make_header(
     off += omf_kbh_blm_hlen(hdr);
     off = (off + align) & ~align;
 
+    /* prefix bloom header is next, also at an 8-byte boundary */
+    omf_set_kbh_pblm_hoff(hdr, off);
+    omf_set_kbh_pblm_hlen(hdr, sizeof(*pblm_hdr));
+
+    off += omf_kbh_pblm_hlen(hdr);
+    off = (off + align) & ~align;
+
     /* get min/max keys */
     wbb_min_max_keys(kblk->wbtree, &min_kobj, &max_kobj);
 
@@ -737,22 +946,28 @@ kblock_make_header(
     /* make sure max key doesn't overlap with min key */
     assert(omf_kbh_min_koff(hdr) >= omf_kbh_max_koff(hdr) + key_obj_len(&max_kobj));
 
-    /* Set offset and length for wbtree, bloom and hlog regions. */
+    /* Set offset and length for wbtree, bloom, prefix bloom and hlog regions. */
     omf_set_kbh_wbt_doff_pg(hdr, KBLOCK_HDR_PAGES);
     omf_set_kbh_wbt_dlen_pg(hdr, kblk->wbt_pgc);
 
     omf_set_kbh_blm_doff_pg(hdr, KBLOCK_HDR_PAGES + kblk->wbt_pgc);
-    omf_set_kbh_blm_dlen_pg(hdr, kblk->blm_pgc);
+    omf_set_kbh_blm_dlen_pg(hdr, kblk->blm.pgc);
 
-    omf_set_kbh_hlog_doff_pg(hdr, KBLOCK_HDR_PAGES + kblk->wbt_pgc + kblk->blm_pgc);
+    omf_set_kbh_pblm_doff_pg(hdr, KBLOCK_HDR_PAGES + kblk->wbt_pgc + kblk->blm.pgc);
+    omf_set_kbh_pblm_dlen_pg(hdr, kblk->pblm.pgc);
+    omf_set_kbh_pblm_pfxlen(hdr, kblk->pblm.pgc ? kblk->pfx_len : 0);
+
+    omf_set_kbh_hlog_doff_pg(
+        hdr, KBLOCK_HDR_PAGES + kblk->wbt_pgc + kblk->blm.pgc + kblk->pblm.pgc);
     omf_set_kbh_hlog_dlen_pg(hdr, HLOG_PGC);
 
-    /* Copy wbtree, bloom and min/max keys into header page.
+    /* Copy wbtree, blooms and min/max keys into header page.
      * Use void* 'base' for ptr arithmetic.
      */
     base = hdr;
     memcpy(base + omf_kbh_wbt_hoff(hdr), wbt_hdr, sizeof(*wbt_hdr));
     memcpy(base + omf_kbh_blm_hoff(hdr), blm_hdr, sizeof(*blm_hdr));
+    memcpy(base + omf_kbh_pblm_hoff(hdr), pblm_hdr, sizeof(*pblm_hdr));
 
     key_obj_copy(base + omf_kbh_max_koff(hdr), HSE_KVS_KEY_LEN_MAX, 0, &max_kobj);
     key_obj_copy(base + omf_kbh_min_koff(hdr), HSE_KVS_KEY_LEN_MAX, 0, &min_kobj);
@@ -779,7 +994,7 @@ kbb_estimate_alen(struct cn *cn, size_t wlen, enum hse_mclass mclass)
 static merr_t
 kblock_finish(struct kblock_builder *bld)
 {
-    struct bloom_hdr_omf      blm_hdr;
+    struct bloom_hdr_omf      blm_hdr, pblm_hdr;
     struct wbt_hdr_omf        wbt_hdr = { 0 };
     struct mblock_props       mbprop;
     struct mpool_mclass_props mc_props;
@@ -811,14 +1026,14 @@ kblock_finish(struct kblock_builder *bld)
         }
     }
 
-    /* Include wbtree pages from main and ptree and add 3 more iov members for
-     * the kblock header, bloom and hlog
+    /* Include wbtree pages from main and ptree and add 4 more iov members for
+     * the kblock header, blooms and hlog
      *
      * [HSE_TODO]: This 1 here represents the wbtree's nodev iovec. Create a
      * helper function to just ask the wbtree how many iovecs it will need in
      * the worst case.
      */
-    iov_max = 3 + 1 + wbb_max_inodec_get(kblk->wbtree) + wbb_kmd_pgc_get(kblk->wbtree);
+    iov_max = 4 + 1 + wbb_max_inodec_get(kblk->wbtree) + wbb_kmd_pgc_get(kblk->wbtree);
 
     iov = malloc(sizeof(*iov) * iov_max);
     if (ev(!iov))
@@ -848,13 +1063,22 @@ kblock_finish(struct kblock_builder *bld)
         kblk->wbt_pgc = 0;
     }
 
-    /* Finalize Bloom filter. */
-    err = kblock_finish_bloom(kblk, &blm_hdr);
+    /* Finalize Bloom filters. */
+    err = kblock_finish_bloom(kblk, &kblk->blm, &blm_hdr);
     if (ev(err))
         goto errout;
-    if (kblk->bloom_len) {
-        iov[iov_cnt].iov_base = kblk->bloom;
-        iov[iov_cnt].iov_len = kblk->bloom_len;
+    if (kblk->blm.len) {
+        iov[iov_cnt].iov_base = kblk->blm.buf;
+        iov[iov_cnt].iov_len = kblk->blm.len;
+        iov_cnt++;
+    }
+
+    err = kblock_finish_bloom(kblk, &kblk->pblm, &pblm_hdr);
+    if (ev(err))
+        goto errout;
+    if (kblk->pblm.len) {
+        iov[iov_cnt].iov_base = kblk->pblm.buf;
+        iov[iov_cnt].iov_len = kblk->pblm.len;
         iov_cnt++;
     }
 
@@ -864,7 +1088,7 @@ kblock_finish(struct kblock_builder *bld)
     iov_cnt++;
 
     /* Format kblock header. */
-    kblock_make_header(kblk, &wbt_hdr, &blm_hdr, kblk->kblk_hdr);
+    kblock_make_header(kblk, &wbt_hdr, &blm_hdr, &pblm_hdr, kblk->kblk_hdr);
 
     assert(iov_cnt <= iov_max);
 
@@ -1126,10 +1350,19 @@ kbb_set_agegroup(struct kblock_builder *bld, enum hse_mclass_policy_age age)
         return err;
 
     bld->max_size = props.mc_mblocksz;
+    kblock_set_bloom_prob(&bld->curr, kblock_bloom_prob(bld->rp, age));
 
     return err;
 }
 
+void
+kbb_set_bloom_prob(struct kblock_builder *bld, uint64_t prob)
+{
+    assert(kblock_is_empty(&bld->curr));
+
+    kblock_set_bloom_prob(&bld->curr, min_t(uint64_t, prob, UINT32_MAX));
+}
+
 void
 kbb_set_merge_stats(struct kblock_builder *bld, struct cn_merge_stats *stats)
 {
@@ -122,6 +122,17 @@ kbb_get_composite_hlog(const struct kblock_builder *bld);
 merr_t
 kbb_set_agegroup(struct kblock_builder *bld, enum hse_mclass_policy_age age);
 
+/**
+ * kbb_set_bloom_prob() - override the bloom false-positive target
+ * @bld:  kblock builder
+ * @prob: false-positive probability in parts per million (see cn_bloom_prob)
+ *
+ * Must be called before any keys are added, and after kbb_set_agegroup()
+ * which resets the target to that of the age group.
+ */
+void
+kbb_set_bloom_prob(struct kblock_builder *bld, uint64_t prob);
+
 void
 kbb_set_merge_stats(struct kblock_builder *bld, struct cn_merge_stats *stats);
 
@@ -56,8 +56,13 @@ kbr_read_wbt_region_desc(struct kvs_mblk_desc *kblkdesc, struct wbt_desc *desc)
     return err;
 }
 
-merr_t
-kbr_read_blm_region_desc(struct kvs_mblk_desc *kbd, struct bloom_desc *desc)
+static merr_t
+kbr_read_bloom_desc(
+    struct kvs_mblk_desc *kbd,
+    uint32_t              hoff,
+    uint32_t              doff_pg,
+    uint32_t              dlen_pg,
+    struct bloom_desc    *desc)
 {
     const struct kblock_hdr_omf *hdr = kbd->map_base;
     const struct bloom_hdr_omf *blm_omf = NULL;
@@ -65,13 +70,9 @@ kbr_read_blm_region_desc(struct kvs_mblk_desc *kbd, struct bloom_desc *desc)
     u32                    magic;
     u32                    version;
 
-    memset(desc, 0, sizeof(*desc));
     mbid = kbd->mbid;
 
-    if (!kblock_hdr_valid(hdr))
-        return merr(EINVAL);
-
-    blm_omf = (void *)hdr + omf_kbh_blm_hoff(hdr);
+    blm_omf = (void *)hdr + hoff;
 
     magic = omf_bh_magic(blm_omf);
     if (ev(magic != BLOOM_OMF_MAGIC)) {
@@ -85,14 +86,14 @@ kbr_read_blm_region_desc(struct kvs_mblk_desc *kbd, struct bloom_desc *desc)
      * it's safe to run without blooms, albeit at a big hit to read perf.
      */
     version = omf_bh_version(blm_omf);
-    if (ev(version != BLOOM_OMF_VERSION)) {
+    if (ev(version != BLOOM_OMF_VERSION && version != BLOOM_OMF_VERSION5)) {
         log_err("bloom %lx invalid version %u (expected %u)",
                 mbid, version, BLOOM_OMF_VERSION);
         return 0;
     }
 
-    desc->bd_first_page = omf_kbh_blm_doff_pg(hdr);
-    desc->bd_n_pages = omf_kbh_blm_dlen_pg(hdr);
+    desc->bd_first_page = doff_pg;
+    desc->bd_n_pages = dlen_pg;
 
     desc->bd_modulus = omf_bh_modulus(blm_omf);
     desc->bd_bktshift = omf_bh_bktshift(blm_omf);
@@ -100,6 +101,25 @@ kbr_read_blm_region_desc(struct kvs_mblk_desc *kbd, struct bloom_desc *desc)
     desc->bd_rotl = omf_bh_rotl(blm_omf);
     desc->bd_bktmask = (1u << desc->bd_bktshift) - 1;
 
+    /* Version 5 headers have zeroed fields in place of the filter type.
+     */
+    desc->bd_type = omf_bh_type(blm_omf);
+    if (desc->bd_type == BLOOM_OMF_FUSE) {
+        desc->bd_fpbits = omf_bh_fpbits(blm_omf);
+        desc->bd_seglen = omf_bh_seglen(blm_omf);
+        desc->bd_seed = omf_bh_seed(blm_omf);
+
+        if (ev(desc->bd_fpbits != 8 && desc->bd_fpbits != 16)) {
+            log_err("bloom %lx invalid fingerprint size %u", mbid, desc->bd_fpbits);
+            memset(desc, 0, sizeof(*desc));
+            return 0;
+        }
+    } else if (ev(desc->bd_type != BLOOM_OMF_BLOCKED)) {
+        log_err("bloom %lx invalid type %u", mbid, desc->bd_type);
+        memset(desc, 0, sizeof(*desc));
+        return 0;
+    }
+
     if (desc->bd_n_pages)
         desc->bd_bitmap = (void *)kbd->map_base + desc->bd_first_page * PAGE_SIZE;
     else
@@ -108,6 +128,45 @@ kbr_read_blm_region_desc(struct kvs_mblk_desc *kbd, struct bloom_desc *desc)
     return 0;
 }
 
+merr_t
+kbr_read_blm_region_desc(struct kvs_mblk_desc *kbd, struct bloom_desc *desc)
+{
+    const struct kblock_hdr_omf *hdr = kbd->map_base;
+
+    memset(desc, 0, sizeof(*desc));
+
+    if (!kblock_hdr_valid(hdr))
+        return merr(EINVAL);
+
+    return kbr_read_bloom_desc(kbd, omf_kbh_blm_hoff(hdr), omf_kbh_blm_doff_pg(hdr),
+                               omf_kbh_blm_dlen_pg(hdr), desc);
+}
+
+merr_t
+kbr_read_pblm_region_desc(struct kvs_mblk_desc *kbd, struct bloom_desc *desc)
+{
+    const struct kblock_hdr_omf *hdr = kbd->map_base;
+    merr_t err;
+
+    memset(desc, 0, sizeof(*desc));
+
+    if (!kblock_hdr_valid(hdr))
+        return merr(EINVAL);
+
+    /* Kblocks prior to version 7 and kblocks built without a prefix
+     * filter have no prefix filter pages.
+     */
+    if (omf_kbh_version(hdr) < KBLOCK_HDR_VERSION7 || !omf_kbh_pblm_pfxlen(hdr))
+        return 0;
+
+    err = kbr_read_bloom_desc(kbd, omf_kbh_pblm_hoff(hdr), omf_kbh_pblm_doff_pg(hdr),
+                              omf_kbh_pblm_dlen_pg(hdr), desc);
+    if (!err && desc->bd_n_pages)
+        desc->bd_pfxlen = omf_kbh_pblm_pfxlen(hdr);
+
+    return err;
+}
+
 merr_t
 kbr_read_metrics(struct kvs_mblk_desc *kblkdesc, struct kblk_metrics *metrics)
 {
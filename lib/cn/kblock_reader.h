@@ -50,6 +50,17 @@ kbr_read_wbt_region_desc(struct kvs_mblk_desc *kblock_desc, struct wbt_desc *wbt
 merr_t
 kbr_read_blm_region_desc(struct kvs_mblk_desc *kblock_desc, struct bloom_desc *blm_desc);
 
+/**
+ * kbr_read_pblm_region_desc() - Read the prefix Bloom filter region
+ *                          descriptor for the given KBLOCK ID.
+ * @kblock_desc:    KVBLOCK_DESC for KBLOCK to read
+ * @blm_rgn_desc:   (output) bloom region descriptor
+ *
+ * The descriptor's bd_pfxlen is zero if the kblock has no prefix filter.
+ */
+merr_t
+kbr_read_pblm_region_desc(struct kvs_mblk_desc *kblock_desc, struct bloom_desc *blm_desc);
+
 /**
  * kbr_read_metrics() - Read kblock header to obtain metrics.
  *
@@ -38,6 +38,30 @@ kv_item_compare(const void *a, const void *b)
     return key_obj_cmp(&item_a->kobj, &item_b->kobj);
 }
 
+/* Rewrite a value that lives in a vblock that is not carried over to the
+ * output kvset (vblock gc).
+ */
+static merr_t
+kcompact_rewrite_val(
+    struct kvset_builder *bldr,
+    struct kv_iterator   *iter,
+    struct cn_kv_item    *curr,
+    u64                   seq,
+    enum kmd_vtype        vtype,
+    uint                  vbidx,
+    uint                  vboff)
+{
+    const void *vdata = NULL;
+    uint vlen, complen;
+    merr_t err;
+
+    err = kvset_iter_val_get(iter, &curr->vctx, vtype, vbidx, vboff, &vdata, &vlen, &complen);
+    if (ev(err))
+        return err;
+
+    return kvset_builder_add_val(bldr, &curr->kobj, vdata, vlen, seq, complen);
+}
+
 /**
  * kcompact() - merge key-value streams in a single output stream
  * Requirements:
@@ -53,7 +77,7 @@ kcompact(struct cn_compaction_work *w, struct kvset_builder *bldr)
     struct element_source **sources = NULL;
 
     enum kmd_vtype vtype;
-    uint           vbidx, vboff, vlen, complen;
+    uint           vbidx, vboff, vlen, complen, out_vbidx;
     const void *   vdata;
 
     u64  seq, emitted_seq = 0, emitted_seq_pt = 0;
@@ -63,6 +87,7 @@ kcompact(struct cn_compaction_work *w, struct kvset_builder *bldr)
 
     bool pt_set = false;
     u64  pt_seq = 0;
+    u64  rt_seq = 0;
     u64  tprog = 0;
 
     u64 dbg_prev_seq HSE_MAYBE_UNUSED;
@@ -137,6 +162,8 @@ kcompact(struct cn_compaction_work *w, struct kvset_builder *bldr)
         dbg_nvals_this_key = 0;
         dbg_dup = false;
 
+        rt_seq = cn_compact_rtomb_seqno(w, &curr->kobj);
+
     values:
         vdata = NULL;
         w->cw_stats.ms_keys_in++;
@@ -158,6 +185,11 @@ kcompact(struct cn_compaction_work *w, struct kvset_builder *bldr)
             dbg_nvals_this_key++;
             dbg_prev_seq = seq;
 
+            if (rt_seq > seq) {
+                horizon = false;
+                continue; /* skip value and all older values covered by rtomb */
+            }
+
             if (seq <= w->cw_horizon) {
                 horizon = false;
                 if (pt_set && seq < pt_seq)
@@ -189,8 +221,18 @@ kcompact(struct cn_compaction_work *w, struct kvset_builder *bldr)
                 switch (vtype) {
                 case VTYPE_UCVAL:
                 case VTYPE_CVAL:
-                    err = kvset_builder_add_vref(
-                        bldr, seq, vbidx + w->cw_vbmap.vbm_map[idx], vboff, vlen, complen);
+                    out_vbidx = vbidx + w->cw_vbmap.vbm_map[idx];
+
+                    if (w->cw_vbmap.vbm_vbidx) {
+                        out_vbidx = w->cw_vbmap.vbm_vbidx[out_vbidx];
+                        if (out_vbidx == VBM_REWRITE) {
+                            err = kcompact_rewrite_val(bldr, iter, curr, seq, vtype, vbidx, vboff);
+                            break;
+                        }
+                    }
+
+                    err = kvset_builder_add_vref(bldr, seq, out_vbidx, vboff, vlen, complen);
+                    w->cw_vbmap.vbm_used += complen ? complen : vlen;
                     break;
                 case VTYPE_ZVAL:
                 case VTYPE_IVAL:
@@ -209,13 +251,7 @@ kcompact(struct cn_compaction_work *w, struct kvset_builder *bldr)
                 else
                     emitted_seq = seq;
 
-                if (complen) {
-                    w->cw_stats.ms_val_bytes_out += complen;
-                    w->cw_vbmap.vbm_used += complen;
-                } else {
-                    w->cw_stats.ms_val_bytes_out += vlen;
-                    w->cw_vbmap.vbm_used += vlen;
-                }
+                w->cw_stats.ms_val_bytes_out += complen ? complen : vlen;
             } else {
                 /* The only time we ever land here is when the same
                  * key appears in two input kvsets with overlapping
@@ -309,23 +345,24 @@ cn_kcompact(struct cn_compaction_work *w)
     if (ev(err))
         return err;
 
-    err = kvset_builder_set_agegroup(bldr, HSE_MPOLICY_AGE_LEAF);
+    err = kvset_builder_set_agegroup(bldr, cn_tree_node_agegroup(w->cw_node));
     if (err)
         goto done;
 
-    kvset_builder_set_merge_stats(bldr, &w->cw_stats);
+    kvset_builder_set_bloom_prob(bldr, cn_tree_node_bloom_prob(w->cw_node));
 
-    err = kcompact(w, bldr);
-    if (ev(err))
-        goto done;
+    kvset_builder_set_merge_stats(bldr, &w->cw_stats);
 
-    /* During k-compaction, vblocks will not be generated. Instead, they will be
-     * inherited from the input kvsets.
+    /* During k-compaction, vblocks are inherited from the input kvsets rather
+     * than generated, other than for values rewritten by vblock gc, which are
+     * written to new vblocks that follow the adopted ones.  The builder takes
+     * ownership of vbm_blkv (and hence of vbm_map), which it leaves intact
+     * until it's finished.
      */
     if (w->cw_vbmap.vbm_blkc > 0) {
         struct vgmap *vgmap = w->cw_vgmap[0];
 
-        assert(vgmap && w->cw_input_vgroups == vgmap->nvgroups);
+        assert(vgmap && vgmap->nvgroups <= w->cw_input_vgroups);
         kvset_builder_adopt_vblocks(bldr, w->cw_vbmap.vbm_blkc, w->cw_vbmap.vbm_blkv,
                                     w->cw_vbmap.vbm_tot, vgmap);
         w->cw_vgmap[0] = NULL; /* reset after adopting the vgmap to the kvset builder */
@@ -334,6 +371,14 @@ cn_kcompact(struct cn_compaction_work *w)
         w->cw_vbmap.vbm_blkc = 0;
     }
 
+    err = kcompact(w, bldr);
+    if (ev(err))
+        goto done;
+
+    err = cn_compact_rtombs_emit(w, bldr, NULL, 0, NULL, 0, NULL);
+    if (ev(err))
+        goto done;
+
     /* get resulting mblocks */
     err = kvset_builder_get_mblocks(bldr, w->cw_outv);
     if (ev(err))
@@ -38,12 +38,21 @@ struct cn_compaction_work;
  * used 100M, waste 200M, ratio: 200 / 300 = .67
  * used 100M, waste 300M, ratio: 300 / 400 = .75
  * used 20M,  waste 300M, ratio: 300 / 320 = .94
+ *
+ * A vblock gc compaction keeps only the input vblocks whose garbage is below
+ * a threshold and rewrites the values of the others.  In that case map[] is
+ * an offset into the vector of all input vblocks and vbidx[] maps each input
+ * vblock to its index in blkv, or to VBM_REWRITE if its values are rewritten.
  */
+#define VBM_REWRITE     UINT32_MAX
+
 struct kvset_vblk_map {
     uint64_t         *vbm_blkv;  // vector of vblock ids
     uint32_t         *vbm_map;   // map of offsets from src vr_index to new vr_index in target
+    uint32_t         *vbm_vbidx; // input vblock to blkv index (vblock gc only, else NULL)
     uint32_t          vbm_blkc;  // number of entries in blkv
     uint32_t          vbm_mapc;  // number of entries in map[]
+    uint32_t          vbm_rewrc; // number of input vblocks rewritten
     uint64_t          vbm_used;  // total bytes of used vblock space
     uint64_t          vbm_waste; // total bytes of un-used vblock space
     uint64_t          vbm_tot;   // total bytes of all values in vblock space
@@ -8,18 +8,22 @@
 #include <hse/util/alloc.h>
 #include <hse/util/slab.h>
 #include <hse/util/assert.h>
+#include <hse/util/minmax.h>
 
 #include "kvset.h"
 #include "kcompact.h"
+#include "vgmap.h"
 
 merr_t
 kvset_keep_vblocks(
     struct kvset_vblk_map  *vbm,
     struct vgmap          **vgm_out,
     struct kv_iterator    **iv,
-    int                     niv)
+    int                     niv,
+    uint                    gc_pct)
 {
     struct vgmap *vgm = NULL;
+    uint32_t *vbidx = NULL;
     void *mem;
     uint32_t nv, nvg, vgidx;
     size_t sz;
@@ -54,7 +58,14 @@ kvset_keep_vblocks(
             err = merr(EBUG);
     }
 
+    if (!err && gc_pct > 0 && nv > 0) {
+        vbidx = malloc(nv * sizeof(*vbidx));
+        if (ev(!vbidx))
+            err = merr(ENOMEM);
+    }
+
     if (err) {
+        vgmap_free(vgm);
         free(mem);
         return err;
     }
@@ -62,7 +73,9 @@ kvset_keep_vblocks(
     vbm->vbm_blkv = mem;
     vbm->vbm_blkc = 0;
     vbm->vbm_map = (uint32_t *)(vbm->vbm_blkv + nv);
+    vbm->vbm_vbidx = vbidx;
     vbm->vbm_mapc = niv;
+    vbm->vbm_rewrc = 0;
     vbm->vbm_used = 0;
     vbm->vbm_waste = 0;
     vbm->vbm_tot = 0;
@@ -80,6 +93,10 @@ kvset_keep_vblocks(
      * and waste start as zero: there is no waste in ingest, kv-compact
      * or spill.  If this node has been previously k-compacted, then
      * waste may be >= 0, and this cycle adds to the waste count.
+     *
+     * If gc_pct is non-zero then vblocks with at least gc_pct percent
+     * garbage are left out of blkv[] and their values are rewritten by
+     * the compaction.  A vgroup left with no vblocks is dropped.
      */
 
     nv = 0;
@@ -87,42 +104,73 @@ kvset_keep_vblocks(
     for (int i = 0; i < niv; ++i) {
         struct kvset *kvset = kvset_from_iter(iv[i]);
         uint32_t cnt = kvset_get_num_vblocks(kvset);
-        uint32_t kvg = 0;
+        uint32_t kvg = 0, kept = 0;
 
         vbm->vbm_map[i] = nv;
 
         for (uint32_t j = 0; j < cnt; ++j) {
-            vbm->vbm_blkv[nv] = kvset_get_nth_vblock_id(kvset, j);
-            vbm->vbm_tot += kvset_get_nth_vblock_len(kvset, j);
+            const uint64_t len = kvset_get_nth_vblock_len(kvset, j);
+            uint32_t blkc = vbm->vbm_blkc;
+
+            if (vbidx) {
+                const uint64_t used = kvset_get_nth_vblock_used(kvset, j);
+
+                if (len > 0 && (len - min_t(uint64_t, used, len)) * 100 >= len * gc_pct) {
+                    vbidx[nv] = VBM_REWRITE;
+                    vbm->vbm_rewrc++;
+                } else {
+                    vbidx[nv] = blkc;
+                }
+            }
+
+            if (!vbidx || vbidx[nv] != VBM_REWRITE) {
+                vbm->vbm_blkv[blkc] = kvset_get_nth_vblock_id(kvset, j);
+                vbm->vbm_tot += len;
+                vbm->vbm_blkc++;
+                kept++;
+            }
 
             if (j == vgmap_vbidx_out_end(kvset, kvg)) {
                 merr_t err;
 
                 assert(vgm);
 
-                /* vgmap_src is passed as NULL as the kblocks are rewritten during k-compact */
-                err = vgmap_vbidx_set(NULL, nv, vgm, nv, vgidx);
-                if (err) {
-                    free(vbm->vbm_blkv);
-                    vbm->vbm_blkv = NULL;
-                    free(vgm);
+                if (kept > 0) {
+                    blkc = vbm->vbm_blkc - 1;
+
+                    /* vgmap_src is passed as NULL as the kblocks are rewritten during k-compact */
+                    err = vgmap_vbidx_set(NULL, blkc, vgm, blkc, vgidx);
+                    if (err) {
+                        free(vbm->vbm_blkv);
+                        vbm->vbm_blkv = NULL;
+                        free(vbm->vbm_vbidx);
+                        vbm->vbm_vbidx = NULL;
+                        free(vgm);
+
+                        return err;
+                    }
 
-                    return err;
+                    vgidx++;
+                    kept = 0;
                 }
 
-                vgidx++;
                 kvg++;
             }
 
             nv++;
         }
         assert(kvg == kvset_get_vgroups(kvset));
-
-        vbm->vbm_blkc += cnt;
     }
 
-    assert(vgidx == nvg);
-    assert(vbm->vbm_blkc == nv);
+    assert(vgidx <= nvg);
+    assert(vbm->vbm_blkc + vbm->vbm_rewrc == nv);
+
+    if (vgidx == 0) {
+        vgmap_free(vgm);
+        vgm = NULL;
+    } else {
+        vgm->nvgroups = vgidx;
+    }
 
     *vgm_out = vgm;
 
@@ -8,6 +8,7 @@
 #include <hse/util/slab.h>
 #include <hse/util/page.h>
 #include <hse/util/event_counter.h>
+#include <hse/util/compression_zstd.h>
 #include <hse/logging/logging.h>
 
 #include <hse/ikvdb/kvs_cparams.h>
@@ -18,6 +19,9 @@
 #include <hse/ikvdb/kvdb_perfc.h>
 #include <hse/ikvdb/cndb.h>
 #include <hse/ikvdb/cn.h>
+#include <hse/ikvdb/kvs_vcomp.h>
+#include <hse/ikvdb/mclass_policy.h>
+#include <hse/ikvdb/vcomp_params.h>
 
 #include "kvcompact.h"
 
@@ -84,6 +88,98 @@ get_direct_read_buf(uint len, bool aligned_voff, u32 *bufsz, void **buf)
     return 0;
 }
 
+/**
+ * struct recomp_ctx - value recompression state for a kv-compaction
+ * @rc_vc:     kvs value compression context
+ * @rc_ubuf:   buffer for decompressed values
+ * @rc_ubufsz: size of rc_ubuf
+ * @rc_cbuf:   buffer for recompressed values
+ * @rc_cbufsz: size of rc_cbuf
+ */
+struct recomp_ctx {
+    struct kvs_vcomp *rc_vc;
+    void             *rc_ubuf;
+    uint              rc_ubufsz;
+    void             *rc_cbuf;
+    uint              rc_cbufsz;
+};
+
+static merr_t
+recomp_buf_get(void **buf, uint *bufsz, uint len)
+{
+    if (*bufsz >= len)
+        return 0;
+
+    len = max_t(uint, roundup(len, PAGE_SIZE), 64 * 1024);
+
+    free(*buf);
+
+    *buf = malloc(len);
+    *bufsz = *buf ? len : 0;
+
+    return *buf ? 0 : merr(ENOMEM);
+}
+
+/* Recompress a value with the stronger of the kvs's algorithms as it moves
+ * into a leaf on the capacity media class.  On success, *vdata, *complen
+ * refer to the recompressed value if it's smaller than the original, else
+ * they are left as they were.
+ */
+static merr_t
+recompress_val(
+    struct recomp_ctx *rc,
+    enum kmd_vtype     vtype,
+    const void       **vdata,
+    uint               vlen,
+    uint              *complen)
+{
+    const void *src = *vdata;
+    uint omlen, outlen;
+    merr_t err;
+
+    if (vtype != VTYPE_UCVAL && vtype != VTYPE_CVAL)
+        return 0;
+
+    if (vlen <= CN_SMALL_VALUE_THRESHOLD)
+        return 0;
+
+    omlen = (vtype == VTYPE_CVAL) ? *complen : vlen;
+
+    /* Values already compressed with zstd are left as they are, lest they
+     * be recompressed by every compaction until they're dropped.
+     */
+    if (vtype == VTYPE_CVAL) {
+        if (*(const uint8_t *)src == COMPRESS_ZSTD_TAG)
+            return 0;
+
+        err = recomp_buf_get(&rc->rc_ubuf, &rc->rc_ubufsz, vlen);
+        if (err)
+            return err;
+
+        err = vcomp_decompress(src, omlen, rc->rc_ubuf, vlen, &outlen);
+        if (ev(err))
+            return err;
+
+        if (ev(outlen != vlen))
+            return merr(EBUG);
+
+        src = rc->rc_ubuf;
+    }
+
+    err = recomp_buf_get(&rc->rc_cbuf, &rc->rc_cbufsz, kvs_vcomp_recompress_bound(rc->rc_vc, vlen));
+    if (err)
+        return err;
+
+    err = kvs_vcomp_recompress(rc->rc_vc, src, vlen, rc->rc_cbuf, rc->rc_cbufsz, &outlen);
+    if (err || outlen >= omlen || outlen >= vlen)
+        return 0; /* keep the value as it is */
+
+    *vdata = rc->rc_cbuf;
+    *complen = outlen;
+
+    return 0;
+}
+
 merr_t
 cn_kvcompact(struct cn_compaction_work *w)
 {
@@ -103,6 +199,7 @@ cn_kvcompact(struct cn_compaction_work *w)
     struct key_obj pt_kobj = {0};
     u64 pt_seq = 0;
     bool pt_set = false;
+    u64 rt_seq = 0;
 
     u64  tstart, tprog = 0;
     u64  dbg_prev_seq = 0;
@@ -114,6 +211,9 @@ cn_kvcompact(struct cn_compaction_work *w)
     bool more;
     struct cn_kv_item *curr = NULL;
     struct element_source **bh_sources;
+    struct recomp_ctx recomp = { 0 };
+    struct cn *cn = cn_tree_get_cn(w->cw_tree);
+    enum hse_mclass_policy_age age;
 
     assert(w->cw_kvset_cnt);
     assert(w->cw_inputv);
@@ -139,16 +239,33 @@ cn_kvcompact(struct cn_compaction_work *w)
 
     w->cw_kvsetidv[0] = cndb_kvsetid_mint(cn_tree_get_cndb(w->cw_tree));
 
-    err = kvset_builder_create(&bldr, cn_tree_get_cn(w->cw_tree), w->cw_pc, w->cw_kvsetidv[0]);
+    err = kvset_builder_create(&bldr, cn, w->cw_pc, w->cw_kvsetidv[0]);
     if (err)
         goto out;
 
     kvset_builder_set_merge_stats(bldr, &w->cw_stats);
 
-    err = kvset_builder_set_agegroup(bldr, HSE_MPOLICY_AGE_LEAF);
+    age = cn_tree_node_agegroup(w->cw_node);
+
+    err = kvset_builder_set_agegroup(bldr, age);
     if (err)
         goto out;
 
+    kvset_builder_set_bloom_prob(bldr, cn_tree_node_bloom_prob(w->cw_node));
+
+    /* Recompress values only when they land on the capacity media class,
+     * where space rather than CPU is at a premium.
+     */
+    recomp.rc_vc = cn_get_vcomp(cn);
+    if (kvs_vcomp_recompress_enabled(recomp.rc_vc)) {
+        const struct mclass_policy *policy = cn_get_mclass_policy(cn);
+
+        if (policy->mc_table[age][HSE_MPOLICY_DTYPE_VALUE] != HSE_MCLASS_CAPACITY)
+            recomp.rc_vc = NULL;
+    } else {
+        recomp.rc_vc = NULL;
+    }
+
     new_key = true;
 
     tstart = perfc_ison(w->cw_pc, PERFC_DI_CNCOMP_VGET) ? 1 : 0;
@@ -185,6 +302,8 @@ cn_kvcompact(struct cn_compaction_work *w)
             dbg_prev_idx = 0;
             dbg_nvals_this_key = 0;
             dbg_dup = false;
+
+            rt_seq = cn_compact_rtomb_seqno(w, &curr->kobj);
         }
 
         while (!bg_val) {
@@ -240,6 +359,9 @@ cn_kvcompact(struct cn_compaction_work *w)
             if (bg_val && pt_set && w->cw_horizon >= pt_seq && pt_seq > seq)
                 break; /* drop val if it and pt are beyond horizon */
 
+            if (rt_seq > seq)
+                break; /* drop val if it and its rtomb are beyond horizon */
+
             /* Set ptomb context irrespective of bg_val for tombstone propagation */
             if (HSE_CORE_IS_PTOMB(vdata)) {
                 pt_set = true;
@@ -261,6 +383,12 @@ cn_kvcompact(struct cn_compaction_work *w)
                 if (w->cw_drop_tombs && HSE_CORE_IS_TOMB(vdata) && bg_val)
                     continue; /* skip value */
 
+                if (recomp.rc_vc) {
+                    err = recompress_val(&recomp, vtype, &vdata, vlen, &complen);
+                    if (err)
+                        break;
+                }
+
                 err = kvset_builder_add_val(bldr, &curr->kobj, vdata, vlen, seq, complen);
                 if (err)
                     break;
@@ -349,6 +477,10 @@ cn_kvcompact(struct cn_compaction_work *w)
         }
     }
 
+    err = cn_compact_rtombs_emit(w, bldr, NULL, 0, NULL, 0, NULL);
+    if (err)
+        goto out;
+
     err = kvset_builder_get_mblocks(bldr, &w->cw_outv[0]);
     if (!err)
         w->cw_output_nodev[0] = w->cw_node;
@@ -358,6 +490,8 @@ out:
     bin_heap_destroy(bh);
     free(bh_sources);
     free(buf);
+    free(recomp.rc_ubuf);
+    free(recomp.rc_cbuf);
 
     if (seqno_errcnt)
         log_warn("seqno errcnt %u", seqno_errcnt);
@@ -18,7 +18,7 @@
 #include <hse/util/perfc.h>
 #include <hse/util/log2.h>
 #include <hse/util/keycmp.h>
-#include <hse/util/compression_lz4.h>
+#include <hse/ikvdb/vcomp_params.h>
 #include <hse/util/vlb.h>
 
 #include <hse/limits.h>
@@ -29,6 +29,7 @@
 #include <hse/ikvdb/cn.h>
 #include <hse/ikvdb/ikvdb.h>
 #include <hse/ikvdb/kvs_rparams.h>
+#include <hse/ikvdb/slowop.h>
 
 #include "kvs_mblk_desc.h"
 #include "vblock_reader.h"
@@ -61,6 +62,7 @@
 #include "cn_tree.h"
 #include "cn_tree_internal.h"
 #include "vgmap.h"
+#include "bcache.h"
 
 /*
  * kvset deferred deletes
@@ -300,11 +302,34 @@ kvset_hblk_init(
     return 0;
 }
 
+static void
+kvset_kblk_preload(const struct kvs_rparams *rp, struct kvset_kblk *p)
+{
+    struct kvs_mblk_desc *kbd = &p->kb_kblk_desc;
+
+    /* Preload the wbtree nodes.
+     */
+    if (rp->cn_mcache_wbt > 0) {
+        kbr_madvise_wbt_int_nodes(kbd, &p->kb_wbt_desc, MADV_WILLNEED);
+
+        if (rp->cn_mcache_wbt > 1)
+            kbr_madvise_wbt_leaf_nodes(kbd, &p->kb_wbt_desc, MADV_WILLNEED);
+    }
+
+    /* Preload the bloom filter.
+     */
+    if (rp->cn_bloom_preload) {
+        kbr_madvise_bloom(kbd, &p->kb_blm_desc, MADV_WILLNEED);
+        kbr_madvise_bloom(kbd, &p->kb_pblm_desc, MADV_WILLNEED);
+    }
+}
+
 static merr_t
 kvset_kblk_init(
     struct kvs_rparams *     rp,
     struct mpool *           ds,
     uint64_t                 mbid,
+    bool                     preload,
     struct kvset_kblk *      p)
 {
     struct kvs_mblk_desc * kbd = &p->kb_kblk_desc;
@@ -323,6 +348,10 @@ kvset_kblk_init(
     if (ev(err))
         return err;
 
+    err = kbr_read_pblm_region_desc(kbd, &p->kb_pblm_desc);
+    if (ev(err))
+        return err;
+
     err = kbr_read_metrics(kbd, &p->kb_metrics);
     if (ev(err))
         return err;
@@ -352,21 +381,27 @@ kvset_kblk_init(
 
     p->kb_hlog = (uint8_t *)hdr + (omf_kbh_hlog_doff_pg(hdr) * PAGE_SIZE);
 
-    /* Preload the wbtree nodes.
-     */
-    if (rp->cn_mcache_wbt > 0) {
-        kbr_madvise_wbt_int_nodes(kbd, &p->kb_wbt_desc, MADV_WILLNEED);
+    if (preload)
+        kvset_kblk_preload(rp, p);
 
-        if (rp->cn_mcache_wbt > 1)
-            kbr_madvise_wbt_leaf_nodes(kbd, &p->kb_wbt_desc, MADV_WILLNEED);
-    }
+    return 0;
+}
 
-    /* Preload the bloom filter.
-     */
-    if (rp->cn_bloom_preload)
-        kbr_madvise_bloom(kbd, &p->kb_blm_desc, MADV_WILLNEED);
+/* Preload the wbtree nodes and bloom filter of all kblocks of a kvset whose
+ * preload was deferred at open (see rparam cn_mcache_lazy).  Only the first
+ * caller to observe the pending flag performs the preload.
+ */
+static void
+kvset_preload_deferred(struct kvset *ks)
+{
+    if (HSE_LIKELY(!atomic_read(&ks->ks_preload_pending)))
+        return;
 
-    return 0;
+    if (!atomic_cas(&ks->ks_preload_pending, 1, 0))
+        return;
+
+    for (uint32_t i = 0; i < ks->ks_st.kst_kblks; i++)
+        kvset_kblk_preload(ks->ks_rp, ks->ks_kblks + i);
 }
 
 static merr_t
@@ -375,6 +410,43 @@ vblock_udata_init(const struct kvs_mblk_desc *mblk, void *rock)
     return vbr_desc_read(mblk, rock);
 }
 
+/* Widen the kvset's key range to include its range tombstones so that
+ * routing and compaction see the kvset as overlapping every key that
+ * one of its rtombs might delete.
+ */
+static void
+kvset_rtomb_minmax(struct kvset *ks)
+{
+    bool widened = false;
+
+    for (uint32_t i = 0; i < ks->ks_rtombs.rv_cnt; ++i) {
+        const struct rtomb *rt = ks->ks_rtombs.rv_v[i];
+
+        if (!ks->ks_minkey ||
+            keycmp(rtomb_start(rt), rt->rt_slen, ks->ks_minkey, ks->ks_minklen) < 0) {
+            ks->ks_minkey = rtomb_start(rt);
+            ks->ks_minklen = rt->rt_slen;
+            key_disc_init(ks->ks_minkey, ks->ks_minklen, &ks->ks_kdisc_min);
+            widened = true;
+        }
+
+        if (!ks->ks_maxkey ||
+            keycmp(rtomb_end(rt), rt->rt_elen, ks->ks_maxkey, ks->ks_maxklen) > 0) {
+            ks->ks_maxkey = rtomb_end(rt);
+            ks->ks_maxklen = rt->rt_elen;
+            key_disc_init(ks->ks_maxkey, ks->ks_maxklen, &ks->ks_kdisc_max);
+            widened = true;
+        }
+    }
+
+    /* ks_lcp is only consulted for kvsets that have kblocks.
+     */
+    if (widened && ks->ks_st.kst_kblks > 0) {
+        ks->ks_lcp = min_t(size_t, ks->ks_minklen, ks->ks_maxklen);
+        ks->ks_lcp = memlcpq(ks->ks_minkey, ks->ks_maxkey, ks->ks_lcp);
+    }
+}
+
 merr_t
 kvset_open2(
     struct cn_tree *   tree,
@@ -397,6 +469,7 @@ kvset_open2(
     const uint32_t n_vblks = km->km_vblk_list.idc;
     uint          vbsetc;
     uint32_t      last_kb;
+    bool          preload, vbused;
 
     struct kvs_cparams *cp;
 
@@ -414,11 +487,13 @@ kvset_open2(
      * - array of struct kvset_kblk for kblocks
      * - array of ptrs to vbsets
      * - array of struct mbset_locator
+     * - array of live bytes per vblock
      */
     alloc_len = sizeof(*ks);
     alloc_len += sizeof(ks->ks_kblks[0]) * n_kblks;
     alloc_len += sizeof(ks->ks_vbsetv[0]) * vbsetc;
     alloc_len += sizeof(ks->ks_vblk2mbs[0]) * n_vblks;
+    alloc_len += sizeof(ks->ks_vbused[0]) * n_vblks;
     alloc_len = ALIGN(alloc_len, __alignof__(*ks));
 
     if (ev(alloc_len > kvset_cache[0].sz))
@@ -444,8 +519,9 @@ kvset_open2(
     memset(ks, 0, alloc_len);
     ks->ks_vbsetv = (void *)(ks->ks_kblks + n_kblks);
     ks->ks_vblk2mbs = (void *)(ks->ks_vbsetv + vbsetc);
+    ks->ks_vbused = (void *)(ks->ks_vblk2mbs + n_vblks);
 
-    assert((void *)ks + alloc_len >= (void *)(ks->ks_vblk2mbs + n_vblks));
+    assert((void *)ks + alloc_len >= (void *)(ks->ks_vbused + n_vblks));
 
     ks->ks_st.kst_kvsets = 1;
     ks->ks_st.kst_vulen = km->km_vused;
@@ -474,10 +550,23 @@ kvset_open2(
     ks->ks_vmax = rp->cn_mcache_vmax;
     ks->ks_cn_kvdb = cn_kvdb;
 
+    if (cn_kvdb && cn_kvdb->cn_bcache && cn_tree_get_cn(tree)) {
+        ks->ks_bcache = cn_kvdb->cn_bcache;
+        ks->ks_bcache_pc = cn_pc_bcache_get(cn_tree_get_cn(tree));
+    }
+
     /* initialize atomics */
     atomic_set(&ks->ks_ref, 0);
     atomic_set(&ks->ks_delete_error, 0);
     atomic_set(&ks->ks_mbset_callbacks, 0);
+    atomic_set(&ks->ks_hits, 0);
+
+    /* Kvsets restored at open may defer their wbtree and bloom preload
+     * until first access so as not to fault in the metadata of the
+     * entire tree before the kvdb is usable.
+     */
+    preload = !(rp->cn_mcache_lazy && km->km_restored);
+    atomic_set(&ks->ks_preload_pending, !preload);
 
     if (cn_tree_is_capped(ks->ks_tree))
         ks->ks_vra_len = rp->cn_capped_vra;
@@ -491,6 +580,10 @@ kvset_open2(
     if (ev(err))
         goto err_exit;
 
+    err = hbr_read_vblock_usage(&ks->ks_hblk.kh_hblk_desc, n_vblks, ks->ks_vbused, &vbused);
+    if (ev(err))
+        goto err_exit;
+
     /* kvset_stats from hblocks */
     ks->ks_st.kst_halen += ks->ks_hblk.kh_hblk_desc.alen_pages * PAGE_SIZE;
     ks->ks_st.kst_hwlen += ks->ks_hblk.kh_hblk_desc.wlen_pages * PAGE_SIZE;
@@ -500,6 +593,10 @@ kvset_open2(
     ks->ks_seqno_max = ks->ks_hblk.kh_seqno_max;
     assert(ks->ks_seqno_min <= ks->ks_seqno_max);
 
+    err = hbr_read_rtombs(&ks->ks_hblk.kh_hblk_desc, &ks->ks_rtombs);
+    if (ev(err))
+        goto err_exit;
+
     kcachesz = 0;
 
     for (uint32_t i = 0; i < n_kblks; i++) {
@@ -507,7 +604,7 @@ kvset_open2(
 
         u64 mbid = km->km_kblk_list.idv[i];
 
-        err = kvset_kblk_init(rp, mp, mbid, kblk);
+        err = kvset_kblk_init(rp, mp, mbid, preload, kblk);
         if (ev(err))
             goto err_exit;
 
@@ -632,6 +729,9 @@ kvset_open2(
         ks->ks_kdisc_max = ks->ks_hblk.kh_pfx_max_disc;
     }
 
+    if (ks->ks_rtombs.rv_cnt > 0)
+        kvset_rtomb_minmax(ks);
+
     {
         uint v = 0; /* vblock number (0..n_vblks) */
         uint m = 0; /* index into mbset vector */
@@ -657,6 +757,19 @@ kvset_open2(
             }
         }
 
+        /* Kvsets written before per-vblock usage was recorded (and those
+         * produced by split) spread the kvset's garbage evenly over its vblocks.
+         */
+        if (!vbused) {
+            const uint64_t vtot = ks->ks_st.kst_vulen + ks->ks_st.kst_vgarb;
+
+            for (uint i = 0; i < v; i++) {
+                const uint64_t len = lvx2vbd(ks, i)->vbd_len;
+
+                ks->ks_vbused[i] = vtot ? len - (len * ks->ks_st.kst_vgarb) / vtot : len;
+            }
+        }
+
         /* Compute vgroup indices and tally the number of vgroups.
          */
         vgroupc = 0;
@@ -821,7 +934,11 @@ kvset_mark_mblocks_for_delete(struct kvset *ks, bool keepv)
 void
 kvset_purge_blklist_add(struct kvset *ks, struct blk_list *blks)
 {
-    ks->ks_deleted = DEL_LIST;
+    /* A kvset already marked for delete (e.g., a k-compacted kvset whose
+     * dirty vblocks were rewritten) retains its delete type.
+     */
+    if (ks->ks_deleted == DEL_NONE)
+        ks->ks_deleted = DEL_LIST;
 
     for (uint32_t i = 0; i < blks->idc; i++) {
         merr_t err = blk_list_append(&ks->ks_purge, blks->idv[i]);
@@ -880,10 +997,10 @@ cleanup_hblock(struct kvset *ks)
 static void
 cleanup_purge_blklist(struct kvset *ks)
 {
-    assert(ks->ks_deleted == DEL_LIST);
+    assert(ks->ks_deleted != DEL_NONE);
 
-    for (uint32_t i = 0; i < ks->ks_purge.idc; i++) {
-        merr_t err = mpool_mblock_delete(ks->ks_mp, ks->ks_purge.idv[i]);
+    if (ks->ks_purge.idc > 0) {
+        merr_t err = mpool_mblock_deletev(ks->ks_mp, ks->ks_purge.idv, ks->ks_purge.idc);
         if (err) {
             atomic_inc(&ks->ks_delete_error);
             return;
@@ -902,7 +1019,7 @@ kvset_close(struct kvset *ks)
     cleanup_hblock(ks);
     cleanup_kblocks(ks);
 
-    if (ks->ks_deleted == DEL_LIST)
+    if (ks->ks_purge.idc > 0)
         cleanup_purge_blklist(ks);
 
     if ((ks->ks_deleted != DEL_NONE) && !atomic_read(&ks->ks_delete_error))
@@ -911,6 +1028,7 @@ kvset_close(struct kvset *ks)
     free((void *)ks->ks_klarge);
 
     vgmap_free(ks->ks_vgmap);
+    rtomb_vec_fini(&ks->ks_rtombs, true);
 
     if (ks->ks_kvset_sz > kvset_cache[0].sz)
         free(ks);
@@ -1067,6 +1185,25 @@ kvset_kblk_start(struct kvset *ks, const void *key, int len, bool reverse)
     }
 }
 
+/* Initialize a block cache reference for the given mblock.  Returns NULL
+ * if the kvset doesn't use the block cache or if the mblock resides on
+ * pmem, which is always accessed via its mapping.
+ */
+static HSE_ALWAYS_INLINE const struct bcache_ref *
+kvset_bcache_ref(const struct kvset *ks, uint64_t mbid, uint8_t mclass, struct bcache_ref *bcr)
+{
+    if (!ks->ks_bcache || mclass == HSE_MCLASS_PMEM)
+        return NULL;
+
+    bcr->br_bc = ks->ks_bcache;
+    bcr->br_pc = ks->ks_bcache_pc;
+    bcr->br_mp = ks->ks_mp;
+    bcr->br_tag = ks->ks_kvsetid;
+    bcr->br_mbid = mbid;
+
+    return bcr;
+}
+
 static merr_t
 kblk_get_value_ref(
     struct kvset *         ks,
@@ -1077,16 +1214,67 @@ kblk_get_value_ref(
     struct kvs_vtuple_ref *vref)
 {
     struct kvset_kblk *kblk = ks->ks_kblks + kblk_idx;
+    const struct bcache_ref *bcrp;
+    struct bcache_ref bcr;
     uint64_t hash = kt->kt_hash;
+    merr_t err;
 
     if (ks->ks_rp->kvs_sfxlen)
         hash = key_hash64(kt->kt_data, kt->kt_len);
 
-    if (!bloom_reader_lookup(&kblk->kb_blm_desc, hash))
+    bcrp = kvset_bcache_ref(ks, kblk->kb_kblk_desc.mbid, kblk->kb_kblk_desc.mclass, &bcr);
+
+    if (!bloom_reader_lookup(&kblk->kb_blm_desc, bcrp, hash))
         return 0;
 
-    return wbtr_read_vref(kblk->kb_kblk_desc.map_base, &kblk->kb_wbt_desc, kt, seq, result,
-                          ks->ks_use_vgmap ? ks->ks_vgmap : NULL, vref);
+    err = wbtr_read_vref(kblk->kb_kblk_desc.map_base, bcrp, &kblk->kb_wbt_desc, kt, seq, result,
+                         ks->ks_use_vgmap ? ks->ks_vgmap : NULL, vref);
+
+    /* The filter passed a key that is not in the kblock.
+     */
+    if (!err && *result == NOT_FOUND)
+        slowop_add(SLOWOP_BLOOM_FP, 1);
+
+    return err;
+}
+
+/* Check the prefix filter of the kblock at which a search for the given
+ * prefix starts.  Keys with a common prefix are contiguous, so if that
+ * kblock has no keys with the filter's prefix then neither do the kblocks
+ * that follow it.  Returns false only if no key in the kvset can have the
+ * given prefix.
+ */
+static bool
+kblk_pfx_maybe(struct kvset *ks, uint kblk_idx, const void *pfx, uint pfxlen)
+{
+    struct kvset_kblk *kblk = ks->ks_kblks + kblk_idx;
+    const uint filter_pfxlen = kblk->kb_pblm_desc.bd_pfxlen;
+    const struct bcache_ref *bcrp;
+    struct bcache_ref bcr;
+
+    if (!filter_pfxlen || pfxlen < filter_pfxlen)
+        return true;
+
+    bcrp = kvset_bcache_ref(ks, kblk->kb_kblk_desc.mbid, kblk->kb_kblk_desc.mclass, &bcr);
+
+    return bloom_reader_lookup(&kblk->kb_pblm_desc, bcrp, key_hash64(pfx, filter_pfxlen));
+}
+
+bool
+kvset_pfx_maybe(struct kvset *ks, const void *pfx, uint pfxlen)
+{
+    int kbidx;
+
+    /* Prefix tombstones must be seen regardless of the keys in the kvset.
+     */
+    if (kvset_has_ptree(ks))
+        return true;
+
+    kbidx = kvset_kblk_start(ks, pfx, -pfxlen, 0);
+    if (kbidx < 0)
+        return false;
+
+    return kblk_pfx_maybe(ks, kbidx, pfx, pfxlen);
 }
 
 static merr_t
@@ -1106,6 +1294,7 @@ kvset_ptomb_lookup(
 
         err = wbtr_read_vref(
             ks->ks_hblk.kh_hblk_desc.map_base,
+            NULL,
             &ks->ks_hblk.kh_ptree_desc,
             &pfx,
             view_seq,
@@ -1132,6 +1321,7 @@ kvset_lookup_vref(
     int    first, last;
     int    rc, i;
     int    lcp;
+    u64    rt_seq;
     merr_t err;
 
     enum key_lookup_res   pt_result;
@@ -1142,6 +1332,8 @@ kvset_lookup_vref(
     first = 0;
     last = ks->ks_st.kst_kblks - 1;
 
+    kvset_preload_deferred(ks);
+
     pt_result = NOT_FOUND;
     err = kvset_ptomb_lookup(ks, kt, seq, &pt_result, &pt_vref);
     if (ev(err))
@@ -1201,6 +1393,19 @@ done:
         }
     }
 
+    /* A covering range tombstone hides all older values of the key,
+     * including those in older kvsets.
+     */
+    rt_seq = rtomb_vec_lookup(&ks->ks_rtombs, kt->kt_data, kt->kt_len, seq);
+    if (rt_seq > 0) {
+        if (*result == NOT_FOUND || rt_seq > vref->vr_seq) {
+            memset(vref, 0, sizeof(*vref));
+            vref->vr_type = VTYPE_TOMB;
+            vref->vr_seq = rt_seq;
+            *result = FOUND_TMB;
+        }
+    }
+
     return 0;
 }
 
@@ -1335,7 +1540,7 @@ kvset_lookup_val_direct_decompress(
     } else {
         src = iov.iov_base + (vboff & ~PAGE_MASK);
 
-        err = compress_lz4_ops.cop_decompress(src, omlen, vbuf, copylen, outlenp);
+        err = vcomp_decompress(src, omlen, vbuf, copylen, outlenp);
     }
 
     if (freeme)
@@ -1344,9 +1549,211 @@ kvset_lookup_val_direct_decompress(
     return ev(err);
 }
 
+/* Values that span at most this many pages are eligible for caching.
+ */
+#define KVSET_BCACHE_VPAGES_MAX     (2)
+
+/* Copy a value out of the block cache.  Returns false if any of the value's
+ * pages are not cached and cannot be admitted, in which case the value must
+ * be read by other means.
+ */
+static bool
+kvset_lookup_val_bcache(
+    struct kvset          *ks,
+    struct vblock_desc    *vbd,
+    struct kvs_vtuple_ref *vref,
+    void                  *dst,
+    uint                   copylen,
+    uint                   omlen)
+{
+    const uint vboff = vref->vb.vr_off;
+    const struct bcache_ref *bcrp;
+    struct bcache_ref bcr;
+    uint readlen, pgoff, done;
+    size_t pg, pgc;
+    char *buf;
+
+    readlen = vref->vb.vr_complen ? omlen : copylen;
+
+    pg = (vbd->vbd_off + vboff) / PAGE_SIZE;
+    pgc = (ALIGN(vboff + readlen, PAGE_SIZE) - (vboff & PAGE_MASK)) / PAGE_SIZE;
+    if (pgc > KVSET_BCACHE_VPAGES_MAX)
+        return false;
+
+    bcrp = kvset_bcache_ref(ks, lvx2mbid(ks, vref->vb.vr_index), vbd->vbd_mblkdesc->mclass, &bcr);
+    if (!bcrp)
+        return false;
+
+    /* Compressed values are gathered into tls_vbuf and then decompressed.
+     */
+    buf = vref->vb.vr_complen ? tls_vbuf : dst;
+    pgoff = vboff & ~PAGE_MASK;
+
+    for (done = 0; done < readlen; ++pg, pgoff = 0) {
+        struct bcache_ent *ent;
+        const char *page;
+        uint len;
+
+        page = bcache_get(bcrp, pg, BCACHE_VALUE, &ent);
+        if (!page)
+            return false;
+
+        len = min_t(uint, PAGE_SIZE - pgoff, readlen - done);
+        memcpy(buf + done, page + pgoff, len);
+        bcache_put(ent);
+
+        done += len;
+    }
+
+    if (vref->vb.vr_complen) {
+        uint outlen;
+        merr_t err;
+
+        err = vcomp_decompress(buf, omlen, dst, copylen, &outlen);
+        if (ev(err))
+            return false;
+
+        if (ev(copylen == vref->vb.vr_len && outlen != copylen))
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * struct kvset_aio_req - a direct value read queued to an io batch
+ * @kar_ctx:     batch context (for error reporting)
+ * @kar_vbuf:    caller's value buffer
+ * @kar_iov:     read buffer (may be the caller's buffer)
+ * @kar_src:     ptr to the value in the mmap'd vblock (fallback)
+ * @kar_pgoff:   offset of the value within the first page read
+ * @kar_omlen:   on-media length of the value
+ * @kar_copylen: number of bytes to copy out
+ * @kar_vlen:    uncompressed length of the value
+ * @kar_vlb:     kar_iov.iov_base was allocated via vlb_alloc()
+ */
+struct kvset_aio_req {
+    struct kvset_aio_ctx *kar_ctx;
+    struct kvs_buf       *kar_vbuf;
+    struct iovec          kar_iov;
+    const void           *kar_src;
+    uint                  kar_pgoff;
+    uint                  kar_omlen;
+    uint                  kar_copylen;
+    uint                  kar_vlen;
+    bool                  kar_vlb;
+};
+
+static void
+kvset_aio_done(void *arg, merr_t err)
+{
+    struct kvset_aio_req *req = arg;
+    struct kvs_buf *vbuf = req->kar_vbuf;
+    const void *src = req->kar_src;
+    uint outlen;
+
+    /* On a read error fall back to the mmap'd vblock, just as the
+     * synchronous direct read path does.
+     */
+    if (!err)
+        src = req->kar_iov.iov_base + req->kar_pgoff;
+
+    if (req->kar_omlen != req->kar_vlen) {
+        err = vcomp_decompress(src, req->kar_omlen, vbuf->b_buf, req->kar_copylen, &outlen);
+        if (!ev(err) && req->kar_copylen == req->kar_vlen && outlen != req->kar_copylen)
+            err = merr(EBUG);
+    } else {
+        if (src != vbuf->b_buf)
+            memmove(vbuf->b_buf, src, req->kar_copylen);
+        err = 0;
+    }
+
+    if (err && !req->kar_ctx->kac_err)
+        req->kar_ctx->kac_err = err;
+
+    if (req->kar_vlb)
+        vlb_free(req->kar_iov.iov_base, req->kar_iov.iov_len);
+
+    free(req);
+}
+
+/* Queue a direct read of the value referenced by %vref to the caller's io
+ * batch. The value is copied out to %vbuf by kvset_aio_done() when the read
+ * completes. Returns an error if the read could not be queued, in which
+ * case the caller should read the value synchronously.
+ */
+static merr_t
+kvset_lookup_val_submit(
+    struct kvset          *ks,
+    struct vblock_desc    *vbd,
+    struct kvs_vtuple_ref *vref,
+    const void            *src,
+    uint                   omlen,
+    uint                   copylen,
+    struct kvset_aio_ctx  *ctx,
+    struct kvs_buf        *vbuf)
+{
+    struct kvset_aio_req *req;
+    const uint vboff = vref->vb.vr_off;
+    uint readlen;
+    size_t off;
+    merr_t err;
+
+    req = malloc(sizeof(*req));
+    if (ev(!req))
+        return merr(ENOMEM);
+
+    off = vbd->vbd_off + (vboff & PAGE_MASK);
+
+    req->kar_ctx = ctx;
+    req->kar_vbuf = vbuf;
+    req->kar_src = src;
+    req->kar_pgoff = vboff & ~PAGE_MASK;
+    req->kar_omlen = omlen;
+    req->kar_copylen = copylen;
+    req->kar_vlen = vref->vb.vr_len;
+    req->kar_vlb = false;
+
+    /* Read directly into the caller's buffer if it is page aligned, large
+     * enough to contain the entire read, and the value isn't compressed.
+     * Otherwise read into a private buffer since the thread-local vbuf
+     * used by the synchronous path cannot be shared by concurrent reads.
+     */
+    readlen = vref->vb.vr_complen ? omlen : copylen;
+
+    req->kar_iov.iov_len = ALIGN(vboff + readlen, PAGE_SIZE) - (vboff & PAGE_MASK);
+    req->kar_iov.iov_base = vbuf->b_buf;
+
+    if (vref->vb.vr_complen || !IS_ALIGNED((ulong)vbuf->b_buf, PAGE_SIZE) ||
+        vbuf->b_buf_sz < req->kar_iov.iov_len) {
+
+        req->kar_iov.iov_base = vlb_alloc(req->kar_iov.iov_len);
+        if (ev(!req->kar_iov.iov_base)) {
+            free(req);
+            return merr(ENOMEM);
+        }
+
+        req->kar_vlb = true;
+    }
+
+    err = mpool_mblock_read_async(ks->ks_mp, ctx->kac_batch, lvx2mbid(ks, vref->vb.vr_index),
+                                  &req->kar_iov, 1, off, kvset_aio_done, req);
+    if (ev(err)) {
+        if (req->kar_vlb)
+            vlb_free(req->kar_iov.iov_base, req->kar_iov.iov_len);
+        free(req);
+    }
+
+    return err;
+}
+
 static
 merr_t
-kvset_lookup_val(struct kvset *ks, struct kvs_vtuple_ref *vref, struct kvs_buf *vbuf)
+kvset_lookup_val(
+    struct kvset          *ks,
+    struct kvs_vtuple_ref *vref,
+    struct kvset_aio_ctx  *aio,
+    struct kvs_buf        *vbuf)
 {
     struct vblock_desc *vbd;
     merr_t              err;
@@ -1383,6 +1790,15 @@ kvset_lookup_val(struct kvset *ks, struct kvs_vtuple_ref *vref, struct kvs_buf *
     if (!copylen)
         goto done;
 
+    if (!direct && ks->ks_bcache && kvset_lookup_val_bcache(ks, vbd, vref, dst, copylen, omlen))
+        goto done;
+
+    if (direct && aio) {
+        err = kvset_lookup_val_submit(ks, vbd, vref, src, omlen, copylen, aio, vbuf);
+        if (!err)
+            goto done;
+    }
+
     if (vref->vb.vr_complen) {
         uint outlen;
 
@@ -1393,7 +1809,7 @@ kvset_lookup_val(struct kvset *ks, struct kvs_vtuple_ref *vref, struct kvs_buf *
                 ks, vbd, vref->vb.vr_index, vref->vb.vr_off, dst, copylen, omlen, &outlen);
 
         if (!direct || err) {
-            err = compress_lz4_ops.cop_decompress(src, omlen, dst, copylen, &outlen);
+            err = vcomp_decompress(src, omlen, dst, copylen, &outlen);
             if (ev(err))
                 return err;
         }
@@ -1450,6 +1866,7 @@ kvset_pfx_lookup(
     struct kvset_kblk *   kblk;
     merr_t                err;
     u64                   pt_seq = 0;
+    u64                   vseq = 0;
     int                   kbidx, last;
     const void *          kmd;
     unsigned char foundkey[HSE_KVS_KEY_LEN_MAX];
@@ -1460,6 +1877,8 @@ kvset_pfx_lookup(
 
     key2kobj(&kt_obj, kt->kt_data, kt->kt_len);
 
+    kvset_preload_deferred(ks);
+
     err = kvset_ptomb_lookup(ks, kt, seq, res, &vref);
     if (ev(err))
         return err;
@@ -1472,6 +1891,9 @@ kvset_pfx_lookup(
     if (kbidx < 0)
         goto done; /* eof */
 
+    if (!kblk_pfx_maybe(ks, kbidx, kt->kt_data, kt->kt_len))
+        goto done;
+
     last = ks->ks_st.kst_kblks - 1;
 
 next_kblk:
@@ -1503,7 +1925,6 @@ get_more:
      */
     {
         size_t off = 0;
-        u64    vseq;
         uint   nvals;
 
         *res = NOT_FOUND;
@@ -1531,6 +1952,11 @@ get_more:
 
     key_obj_copy(foundkey, sizeof(foundkey), &foundklen, &kobj);
 
+    /* A key hidden by a range tombstone is treated as tombstoned.
+     */
+    if (*res == FOUND_VAL && qctx_rtomb_covers(qctx, foundkey, foundklen, vseq, seq))
+        *res = FOUND_TMB;
+
     if (*res == FOUND_TMB) {
         err = qctx_tomb_insert(qctx, foundkey, foundklen);
         if (ev(err))
@@ -1555,7 +1981,7 @@ get_more:
      * is the first seen kv-pair.
      */
     if (++qctx->seen == 1) {
-        err = kvset_lookup_val(ks, &vref, vbuf);
+        err = kvset_lookup_val(ks, &vref, NULL, vbuf);
         if (ev(err))
             return err;
 
@@ -1584,6 +2010,19 @@ kvset_lookup(
     u64                    seq,
     enum key_lookup_res *  res,
     struct kvs_buf *       vbuf)
+{
+    return kvset_lookup_aio(ks, kt, kdisc, seq, res, NULL, vbuf);
+}
+
+merr_t
+kvset_lookup_aio(
+    struct kvset *         ks,
+    struct kvs_ktuple *    kt,
+    const struct key_disc *kdisc,
+    u64                    seq,
+    enum key_lookup_res *  res,
+    struct kvset_aio_ctx * aio,
+    struct kvs_buf *       vbuf)
 {
     struct kvs_vtuple_ref vref;
     merr_t                err;
@@ -1592,10 +2031,15 @@ kvset_lookup(
     if (ev(err))
         return err;
 
+    if (*res == NOT_FOUND)
+        return 0;
+
+    kt->kt_seqno = vref.vr_seq;
+
     if (*res != FOUND_VAL)
         return 0;
 
-    return kvset_lookup_val(ks, &vref, vbuf);
+    return kvset_lookup_val(ks, &vref, aio, vbuf);
 }
 
 uint64_t
@@ -1622,6 +2066,12 @@ kvset_get_dgen_lo(const struct kvset *ks)
     return ks->ks_dgen_lo;
 }
 
+const struct rtomb_vec *
+kvset_get_rtombs(const struct kvset *ks)
+{
+    return &ks->ks_rtombs;
+}
+
 bool
 kvset_younger(const struct kvset *ks1, const struct kvset *ks2)
 {
@@ -1643,6 +2093,30 @@ kvset_get_compc(const struct kvset *ks)
     return ks->ks_compc;
 }
 
+void
+kvset_hit(struct kvset *ks)
+{
+    atomic_inc(&ks->ks_hits);
+}
+
+void
+kvset_add_hits(struct kvset *ks, uint64_t hits)
+{
+    if (hits > 0)
+        atomic_add(&ks->ks_hits, hits);
+}
+
+uint64_t
+kvset_reap_hits(struct kvset *ks)
+{
+    uint64_t hits = atomic_read(&ks->ks_hits);
+
+    if (hits > 0)
+        atomic_sub(&ks->ks_hits, hits);
+
+    return hits;
+}
+
 void
 kvset_set_compc(struct kvset *ks, uint32_t compc)
 {
@@ -1780,6 +2254,28 @@ kvset_get_nth_vblock_len(struct kvset *ks, u32 index)
     return vbd ? vbd->vbd_len : 0;
 }
 
+u64
+kvset_get_nth_vblock_used(struct kvset *ks, u32 index)
+{
+    return (index < ks->ks_st.kst_vblks ? ks->ks_vbused[index] : 0);
+}
+
+uint64_t
+kvset_vgc_bytes(struct kvset *ks, uint pct)
+{
+    uint64_t garbage = 0;
+
+    for (uint32_t i = 0; i < ks->ks_st.kst_vblks; i++) {
+        const uint64_t len = lvx2vbd(ks, i)->vbd_len;
+        const uint64_t used = min_t(uint64_t, ks->ks_vbused[i], len);
+
+        if (len > 0 && (len - used) * 100 >= len * pct)
+            garbage += len - used;
+    }
+
+    return garbage;
+}
+
 struct vblock_desc *
 kvset_get_nth_vblock_desc(struct kvset *ks, uint32_t index)
 {
@@ -2559,6 +3055,12 @@ kvset_iter_create(
     if (ev(reverse && (io_workq || mblock_read)))
         return merr(EINVAL);
 
+    /* Compaction iterators read the kblocks sequentially and have no
+     * use for the wbtree internal nodes or blooms.
+     */
+    if (!fullscan)
+        kvset_preload_deferred(ks);
+
     iter = kmem_cache_zalloc(kvset_iter_cache);
     if (ev(!iter))
         return merr(ENOMEM);
@@ -2686,8 +3188,10 @@ kvset_madvise_kblks(struct kvset *ks, int advice, bool blooms, bool leaves)
         kbr_madvise_wbt_int_nodes(&p->kb_kblk_desc, &p->kb_wbt_desc, advice);
         kbr_madvise_kmd(&p->kb_kblk_desc, &p->kb_wbt_desc, advice);
 
-        if (blooms)
+        if (blooms) {
             kbr_madvise_bloom(&p->kb_kblk_desc, &p->kb_blm_desc, advice);
+            kbr_madvise_bloom(&p->kb_kblk_desc, &p->kb_pblm_desc, advice);
+        }
     }
 }
 
@@ -2735,6 +3239,27 @@ kvset_madvise_capped(struct kvset *ks, int advice)
     }
 }
 
+void
+kvset_madvise_cursor(struct kvset *ks, bool reverse)
+{
+    struct kvset_kblk *p;
+
+    if (!ks->ks_st.kst_kblks)
+        return;
+
+    p = ks->ks_kblks + (reverse ? ks->ks_st.kst_kblks - 1 : 0);
+
+    kbr_madvise_wbt_int_nodes(&p->kb_kblk_desc, &p->kb_wbt_desc, MADV_WILLNEED);
+
+    if (ks->ks_rp->cn_cursor_kra) {
+        kbr_madvise_wbt_leaf_nodes(&p->kb_kblk_desc, &p->kb_wbt_desc, MADV_WILLNEED);
+        kbr_madvise_kmd(&p->kb_kblk_desc, &p->kb_wbt_desc, MADV_WILLNEED);
+    }
+
+    if (ks->ks_vra_len)
+        kvset_madvise_capped(ks, MADV_WILLNEED);
+}
+
 void
 kvset_madvise_vmaps(struct kvset *ks, int advice)
 {
@@ -37,6 +37,7 @@ struct cn_tree;
 struct cn_merge_stats;
 struct kvset_stats;
 struct vgmap;
+struct rtomb_vec;
 
 struct kvset_list_entry {
     struct list_head le_link;
@@ -187,6 +188,19 @@ kvset_madvise_vblks(struct kvset *kvset, int advice);
 void
 kvset_madvise_capped(struct kvset *kvset, int advice);
 
+/**
+ * kvset_madvise_cursor() - initiate read-ahead for a cursor about to iterate a kvset
+ * @kvset:   kvset pointer
+ * @reverse: cursor iterates in reverse
+ *
+ * Preloads the wbt internal nodes of the kblock at which the cursor will start
+ * and, if cn_cursor_kra is set, its leaf nodes and kmd.  Also preloads the
+ * first cn_cursor_vra bytes of each vblock.
+ */
+/* MTF_MOCK */
+void
+kvset_madvise_cursor(struct kvset *kvset, bool reverse);
+
 /**
  * kvset_madvise_vmaps() - Change kvset vblock memory mapped pages use mode
  * @kvset:    kvset pointer
@@ -276,10 +290,24 @@ kvset_has_ptree(const struct kvset *ks) HSE_NONNULL(1);
 int
 kvset_kblk_start(struct kvset *kvset, const void *key, int len, bool reverse);
 
+/**
+ * kvset_pfx_maybe() - check if a kvset may contain keys with a prefix
+ * @kvset:   kvset to search
+ * @pfx:     prefix
+ * @pfxlen:  length of prefix
+ *
+ * Consults the prefix filter of kblocks built with cn_bloom_pfx, and
+ * otherwise only checks the prefix against the kvset's key range.  Always
+ * true for kvsets with prefix tombstones.
+ */
+bool
+kvset_pfx_maybe(struct kvset *kvset, const void *pfx, uint pfxlen);
+
 /**
  * kvset_lookup() - Search a kvset for a key and return its value
  * @kvset:  kvset to search
- * @kt:     key to search for
+ * @kt:     key to search for (kt_seqno is set to the seqno of the value
+ *          or tombstone found, if any)
  * @kdisc:  key discriminator
  * @seq:    sequence number
  * @result: (output) one of NOT_FOUND, FOUND_VAL, or FOUND_TMB (tombstone)
@@ -296,6 +324,37 @@ kvset_lookup(
     enum key_lookup_res *  res,
     struct kvs_buf *       vbuf);
 
+struct io_batch;
+
+/**
+ * struct kvset_aio_ctx - context for batched direct value reads
+ * @kac_batch: io batch to which direct value reads are queued
+ * @kac_err:   first error encountered by a completed value read
+ */
+struct kvset_aio_ctx {
+    struct io_batch *kac_batch;
+    merr_t           kac_err;
+};
+
+/**
+ * kvset_lookup_aio() - Search a kvset for a key, deferring value reads
+ *
+ * Identical to kvset_lookup() except that values which would be read
+ * directly from media are instead queued to @aio->kac_batch.  The value
+ * is not available in @vbuf (though @vbuf->b_len is valid) until the batch
+ * has been waited for, after which @aio->kac_err must be checked.
+ * The caller must prevent @kvset from being destroyed until then.
+ */
+merr_t
+kvset_lookup_aio(
+    struct kvset *         kvset,
+    struct kvs_ktuple *    kt,
+    const struct key_disc *kdisc,
+    u64                    seq,
+    enum key_lookup_res *  res,
+    struct kvset_aio_ctx * aio,
+    struct kvs_buf *       vbuf);
+
 struct query_ctx;
 
 merr_t
@@ -356,6 +415,27 @@ kvset_set_rule(struct kvset *ks, enum cn_rule rule);
 u64
 kvset_get_nth_vblock_len(struct kvset *km, u32 index);
 
+/**
+ * kvset_get_nth_vblock_used() - Get number of live value bytes in nth vblock
+ *
+ * Values in the vblock not referenced by the kvset's kblocks are garbage.
+ */
+/* MTF_MOCK */
+u64
+kvset_get_nth_vblock_used(struct kvset *ks, u32 index);
+
+/**
+ * kvset_vgc_bytes() - Get the garbage in the kvset's dirty vblocks
+ * @ks:  kvset handle
+ * @pct: minimum garbage percentage of a dirty vblock
+ *
+ * Returns the number of garbage bytes that would be reclaimed by rewriting
+ * only the vblocks with at least %pct percent garbage.
+ */
+/* MTF_MOCK */
+uint64_t
+kvset_vgc_bytes(struct kvset *ks, uint pct);
+
 /* MTF_MOCK */
 void
 kvset_stats(const struct kvset *ks, struct kvset_stats *stats);
@@ -380,6 +460,31 @@ kvset_get_compc(const struct kvset *ks);
 void
 kvset_set_compc(struct kvset *ks, uint32_t compc);
 
+/**
+ * kvset_hit() - record a get or cursor hit on a kvset
+ * @ks: kvset handle
+ */
+/* MTF_MOCK */
+void
+kvset_hit(struct kvset *ks);
+
+/**
+ * kvset_add_hits() - add hits carried over from other kvsets
+ * @ks:   kvset handle
+ * @hits: hits to add
+ */
+/* MTF_MOCK */
+void
+kvset_add_hits(struct kvset *ks, uint64_t hits);
+
+/**
+ * kvset_reap_hits() - retrieve and clear a kvset's hit count
+ * @ks: kvset handle
+ */
+/* MTF_MOCK */
+uint64_t
+kvset_reap_hits(struct kvset *ks);
+
 /* MTF_MOCK */
 uint
 kvset_get_vgroups(const struct kvset *km);
@@ -405,6 +510,15 @@ kvset_set_nodeid(struct kvset *kvset, uint64_t nodeid);
 uint64_t
 kvset_get_dgen_lo(const struct kvset *kvset);
 
+/**
+ * kvset_get_rtombs() - Get the range tombstones of a kvset
+ *
+ * Return: The kvset's rtomb vector (may be NULL or empty).
+ */
+/* MTF_MOCK */
+const struct rtomb_vec *
+kvset_get_rtombs(const struct kvset *kvset);
+
 /**
  * kvset_iter_create() - Create iterator to traverse all entries in a kvset
  * @kvset:     kvset handle
@@ -524,6 +638,7 @@ kvset_iter_next_vref(
  * @gmap: vgroup map to populate
  * @iv:   the vector of input iterators
  * @niv:  the number of iterator
+ * @gc_pct: garbage percentage at which a vblock is rewritten (0: keep all)
  *
  * This function creates a map of vblock offsets necessary
  * for correctly locating the values when used in a k-compaction.
@@ -538,7 +653,8 @@ kvset_keep_vblocks(
     struct kvset_vblk_map  *out,
     struct vgmap          **vgmap,
     struct kv_iterator    **iv,
-    int                     niv);
+    int                     niv,
+    uint                    gc_pct);
 
 /* MTF_MOCK */
 void
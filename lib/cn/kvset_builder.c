@@ -15,6 +15,7 @@
 #include <hse/ikvdb/key_hash.h>
 #include <hse/ikvdb/limits.h>
 #include <hse/ikvdb/cn.h>
+#include <hse/ikvdb/rtomb.h>
 
 #include <hse/limits.h>
 
@@ -28,6 +29,7 @@
 #include "blk_list.h"
 #include "kvset_builder_internal.h"
 #include "kvset.h"
+#include "vgmap.h"
 
 merr_t
 kvset_builder_create(
@@ -107,6 +109,31 @@ reserve_kmd(struct kmd_info *ki)
     return 0;
 }
 
+/* Account @len live bytes to the output vblock at index @vbidx.
+ */
+static merr_t
+vbused_add(struct kvset_builder *self, uint vbidx, uint len)
+{
+    if (vbidx >= self->vbusedc) {
+        uint32_t n = max_t(uint32_t, vbidx + 1, self->vbusedc * 2);
+        uint32_t *v;
+
+        n = max_t(uint32_t, n, 64);
+
+        v = realloc(self->vbusedv, n * sizeof(*v));
+        if (ev(!v))
+            return merr(ENOMEM);
+
+        memset(v + self->vbusedc, 0, (n - self->vbusedc) * sizeof(*v));
+        self->vbusedv = v;
+        self->vbusedc = n;
+    }
+
+    self->vbusedv[vbidx] += len;
+
+    return 0;
+}
+
 merr_t
 kvset_builder_add_key(struct kvset_builder *self, const struct key_obj *kobj)
 {
@@ -224,6 +251,14 @@ kvset_builder_add_val(
         if (ev(err))
             return err;
 
+        /* New vblocks follow any adopted vblocks in the output kvset.
+         */
+        vbidx += self->vadopted;
+
+        err = vbused_add(self, vbidx, omlen);
+        if (ev(err))
+            return err;
+
         if (complen)
             kmd_add_cval(self->kblk_kmd.kmd, &self->kblk_kmd.kmd_used, seq, vbidx, vboff, vlen, complen);
         else
@@ -271,10 +306,15 @@ kvset_builder_add_vref(
     uint                    complen)
 {
     uint om_len = complen ? complen : vlen; /* on-media length */
+    merr_t err;
 
     if (reserve_kmd(&self->kblk_kmd))
         return merr(ev(ENOMEM));
 
+    err = vbused_add(self, vbidx, om_len);
+    if (ev(err))
+        return err;
+
     if (complen > 0)
         kmd_add_cval(self->kblk_kmd.kmd, &self->kblk_kmd.kmd_used, seq, vbidx, vboff, vlen, complen);
     else
@@ -317,6 +357,21 @@ kvset_builder_add_nonval(struct kvset_builder *self, u64 seq, enum kmd_vtype vty
     return 0;
 }
 
+merr_t
+kvset_builder_add_rtomb(struct kvset_builder *self, const struct rtomb *rt)
+{
+    merr_t err;
+
+    err = hbb_add_rtomb(self->hbb, rt);
+    if (ev(err))
+        return err;
+
+    self->seqno_max = max_t(u64, self->seqno_max, rt->rt_seqno);
+    self->seqno_min = min_t(u64, self->seqno_min, rt->rt_seqno);
+
+    return 0;
+}
+
 void
 kvset_builder_adopt_vblocks(
     struct kvset_builder *self,
@@ -326,10 +381,12 @@ kvset_builder_adopt_vblocks(
     struct vgmap         *vgmap)
 {
     assert(self->vblk_list.idc == 0);
+    assert(vbb_vlen_get(self->vbb) == 0);
 
     self->vblk_list.idv = vblock_ids;
     self->vblk_list.idc = num_vblocks;
     self->vblk_list.n_alloc = num_vblocks;
+    self->vadopted = num_vblocks;
     self->vtotal = vtotal;
 
     /* vgroup map is adopted from the compaction worker for k-compacts.
@@ -355,7 +412,16 @@ kvset_builder_destroy(struct kvset_builder *bld)
     delete_mblocks(mp, &bld->kblk_list);
     blk_list_free(&bld->kblk_list);
 
-    delete_mblocks(mp, &bld->vblk_list);
+    /* Adopted vblocks belong to the kvsets from which they were adopted.
+     */
+    if (bld->vblk_list.idc > bld->vadopted) {
+        struct blk_list written = {
+            .idv = bld->vblk_list.idv + bld->vadopted,
+            .idc = bld->vblk_list.idc - bld->vadopted,
+        };
+
+        delete_mblocks(mp, &written);
+    }
     blk_list_free(&bld->vblk_list);
 
     hbb_destroy(bld->hbb);
@@ -366,6 +432,7 @@ kvset_builder_destroy(struct kvset_builder *bld)
 
     free(bld->kblk_kmd.kmd);
     free(bld->hblk_kmd.kmd);
+    free(bld->vbusedv);
     free(bld);
 }
 
@@ -379,23 +446,91 @@ kvset_mblocks_destroy(struct kvset_mblocks *blks)
     }
 }
 
+/* Append the vblocks written by a k-compaction (values moved out of garbage
+ * laden vblocks) to the adopted vblocks, as a vgroup of their own.
+ */
+static merr_t
+kvset_builder_finish_written(struct kvset_builder *imp, const struct key_obj *max_kobj)
+{
+    struct blk_list written;
+    struct vgmap *vgmap;
+    uint32_t nvg, vbidx_out;
+    merr_t err;
+
+    blk_list_init(&written);
+
+    err = vbb_finish(imp->vbb, &written, max_kobj);
+    if (err)
+        return err;
+
+    if (written.idc == 0)
+        return 0;
+
+    assert(imp->vgmap);
+    nvg = imp->vgmap->nvgroups;
+
+    vgmap = vgmap_alloc(nvg + 1);
+    if (!vgmap) {
+        err = merr(ENOMEM);
+        goto errout;
+    }
+
+    memcpy(vgmap->vbidx_out, imp->vgmap->vbidx_out, nvg * sizeof(*vgmap->vbidx_out));
+    memcpy(vgmap->vbidx_adj, imp->vgmap->vbidx_adj, nvg * sizeof(*vgmap->vbidx_adj));
+    memcpy(vgmap->vbidx_src, imp->vgmap->vbidx_src, nvg * sizeof(*vgmap->vbidx_src));
+
+    for (uint32_t i = 0; i < written.idc; i++) {
+        err = blk_list_append(&imp->vblk_list, written.idv[i]);
+        if (err) {
+            imp->vblk_list.idc = imp->vadopted;
+            vgmap_free(vgmap);
+            goto errout;
+        }
+    }
+
+    vbidx_out = imp->vblk_list.idc - 1;
+    err = vgmap_vbidx_set(NULL, vbidx_out, vgmap, vbidx_out, nvg);
+    if (err) {
+        imp->vblk_list.idc = imp->vadopted;
+        vgmap_free(vgmap);
+        goto errout;
+    }
+
+    vgmap_free(imp->vgmap);
+    imp->vgmap = vgmap;
+    imp->vtotal += vbb_vlen_get(imp->vbb);
+
+    blk_list_free(&written);
+
+    return 0;
+
+errout:
+    delete_mblocks(cn_get_mpool(imp->cn), &written);
+    blk_list_free(&written);
+
+    return err;
+}
+
 static merr_t
 kvset_builder_finish(struct kvset_builder *imp)
 {
     merr_t err;
-    bool adopted_vbs = (imp->vblk_list.idc > 0);
+    bool adopted_vbs = (imp->vadopted > 0);
 
     INVARIANT(imp->hbb);
     INVARIANT(imp->kbb);
     INVARIANT(imp->vbb);
 
     if (!kbb_is_empty(imp->kbb)) {
-        /* If we haven't adopted any vblocks previously */
-        if (!adopted_vbs) {
-            struct key_obj min_kobj = { 0 }, max_kobj = { 0 };
+        struct key_obj min_kobj = { 0 }, max_kobj = { 0 };
 
-            kbb_curr_kblk_min_max_keys(imp->kbb, &min_kobj, &max_kobj);
+        kbb_curr_kblk_min_max_keys(imp->kbb, &min_kobj, &max_kobj);
 
+        if (adopted_vbs) {
+            err = kvset_builder_finish_written(imp, &max_kobj);
+            if (err)
+                return err;
+        } else {
             err = vbb_finish(imp->vbb, &imp->vblk_list, &max_kobj);
             if (err)
                 return err;
@@ -437,6 +572,7 @@ kvset_builder_finish(struct kvset_builder *imp)
             blk_list_free(&imp->vblk_list);
             vgmap_free(imp->vgmap);
             imp->vgmap = NULL;
+            imp->vadopted = 0;
         }
     }
 
@@ -448,6 +584,13 @@ kvset_builder_finish(struct kvset_builder *imp)
         return err;
     }
 
+    /* Record how much of each vblock is live so that vblock garbage can be
+     * collected without rewriting the whole kvset.  The usage is advisory,
+     * it's omitted if we can't size the vector.
+     */
+    if (imp->vblk_list.idc > 0 && !vbused_add(imp, imp->vblk_list.idc - 1, 0))
+        hbb_set_vblock_usage(imp->hbb, imp->vbusedv, imp->vblk_list.idc);
+
     err = hbb_finish(imp->hbb, &imp->hblk_id, imp->vgmap, NULL, NULL, imp->seqno_min,
                      imp->seqno_max, imp->kblk_list.idc, imp->vblk_list.idc,
                      hbb_get_nptombs(imp->hbb), kbb_get_composite_hlog(imp->kbb), NULL, NULL, 0);
@@ -489,8 +632,10 @@ kvset_builder_get_mblocks(struct kvset_builder *self, struct kvset_mblocks *mblk
     list = &self->vblk_list;
     mblks->vblks.idv = list->idv;
     mblks->vblks.idc = list->idc;
+    mblks->bl_vadopted = self->vadopted;
     list->idv = 0;
     list->idc = 0;
+    self->vadopted = 0;
 
     mblks->bl_vtotal = self->vtotal;
     mblks->bl_vused = self->vused;
@@ -524,6 +669,12 @@ kvset_builder_set_agegroup(struct kvset_builder *self, enum hse_mclass_policy_ag
     return err;
 }
 
+void
+kvset_builder_set_bloom_prob(struct kvset_builder *self, uint64_t prob)
+{
+    kbb_set_bloom_prob(self->kbb, prob);
+}
+
 void
 kvset_builder_set_merge_stats(struct kvset_builder *self, struct cn_merge_stats *stats)
 {
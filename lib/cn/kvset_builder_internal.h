@@ -46,6 +46,10 @@ struct kvset_builder {
 
     struct vblock_builder *vbb;  // vblock builder
     struct blk_list vblk_list;   // list of vblock ids
+    uint32_t vadopted;           // number of leading vblocks adopted from other kvsets
+
+    uint32_t *vbusedv;           // live bytes per vblock, indexed like vblk_list
+    uint32_t  vbusedc;           // number of entries allocated in vbusedv
 
     struct vgmap *vgmap;
 
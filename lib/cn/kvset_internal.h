@@ -17,6 +17,7 @@
 #include <hse/ikvdb/tuple.h>
 #include <hse/ikvdb/omf_kmd.h>
 #include <hse/ikvdb/kvset_view.h>
+#include <hse/ikvdb/rtomb.h>
 
 #include <hse/mpool/mpool.h>
 
@@ -63,6 +64,7 @@ struct kvset_kblk {
     u16             kb_klen_min;   /* length of smallest key */
 
     struct bloom_desc kb_blm_desc;  /* Bloom descriptor */
+    struct bloom_desc kb_pblm_desc; /* prefix Bloom descriptor */
 
     struct kblk_metrics kb_metrics; /* kblock metrics */
 };
@@ -85,6 +87,8 @@ struct kvset {
     u64                 ks_seqno_max;
     u64                 ks_cnid;
     struct cn_kvdb *    ks_cn_kvdb;
+    struct bcache *     ks_bcache;    /* block cache (may be NULL) */
+    struct perfc_set *  ks_bcache_pc; /* block cache accounting */
     struct cn_tree *    ks_tree;
     struct kvset_stats  ks_st;
 
@@ -101,6 +105,7 @@ struct kvset {
     bool          ks_use_vgmap; /* consult vgmap during query/compaction? */
 
     struct mbset_locator *ks_vblk2mbs;
+    uint32_t             *ks_vbused; /* live bytes per vblock */
 
     /* csched uses ks_work to mark busy all the kvsets within a compaction
      * operation (by stashing the address of the cn_compaction_work object
@@ -113,6 +118,7 @@ struct kvset {
     size_t          ks_lcp;       /* longest common prefix */
 
     struct kvset_hblk ks_hblk;
+    struct rtomb_vec  ks_rtombs; /* range tombstones from the hblock */
 
     const u8 *                ks_klarge; /* large key cache */
     struct mbset **           ks_vbsetv;
@@ -129,12 +135,14 @@ struct kvset {
     u32        ks_deleted;             /* DEL_NONE, DEL_KEEPV, DEL_ALL */
     atomic_int ks_delete_error;
     atomic_int ks_mbset_callbacks;
+    atomic_int ks_preload_pending;     /* wbt/bloom preload deferred at open */
+    atomic_ulong ks_hits;              /* get and cursor hits since last reaped */
     bool       ks_mbset_cb_pending;
     u64        ks_seqno_min;
     size_t     ks_kvset_sz;
     u64        ks_ctime;
 
-    struct blk_list ks_purge; /* used by kvset split */
+    struct blk_list ks_purge; /* used by kvset split and vblock gc */
 
     struct kvset_kblk ks_kblks[] HSE_L1D_ALIGNED;
 };
@@ -600,6 +600,7 @@ vblocks_split(
  * The hblock is rewritten in the left and the right kvsets by duplicating the following
  * fields from the hblock in the source kvset:
  *   - min/max seqno, min/max prefix, ptomb tree and its related fields
+ *   - range tombstones that intersect the key range of the output kvset
  *
  * The following fields are regenerated for the left and the right kvsets:
  *   - hlog and vgroup map
@@ -607,6 +608,7 @@ vblocks_split(
 static merr_t
 hblock_split(
     struct kvset           *ks,
+    const struct key_obj   *split_kobj,
     struct kvset_split_work work[static 2],
     struct kvset_split_res *result)
 {
@@ -629,10 +631,32 @@ hblock_split(
     if (ptree_pgc == 0)
         ptree = NULL;
 
+    /* Each rtomb goes to whichever side(s) of the split key its range intersects.
+     */
+    if (ks->ks_rtombs.rv_cnt > 0) {
+        char split_key[HSE_KVS_KEY_LEN_MAX];
+        uint32_t split_klen;
+
+        key_obj_copy(split_key, sizeof(split_key), &split_klen, split_kobj);
+
+        for (uint32_t i = 0; i < ks->ks_rtombs.rv_cnt && !err; i++) {
+            const struct rtomb *rt = ks->ks_rtombs.rv_v[i];
+
+            if (rtomb_overlaps(rt, NULL, 0, split_key, split_klen))
+                err = hbb_add_rtomb(work[LEFT].hbb, rt);
+
+            if (!err && rtomb_overlaps(rt, split_key, split_klen, NULL, 0))
+                err = hbb_add_rtomb(work[RIGHT].hbb, rt);
+        }
+
+        if (err)
+            return err;
+    }
+
     /* Add both the left and the right hblock to the commit list and add the source hblock
      * to the purge list.
      */
-    if (blks_left->kblks.idc > 0 || ptree) {
+    if (blks_left->kblks.idc > 0 || ptree || hbb_get_nrtombs(work[LEFT].hbb) > 0) {
         err = hbb_finish(work[LEFT].hbb, &blks_left->hblk_id, work[LEFT].vgmap, &min_pfx, &max_pfx,
                          min_seqno, max_seqno, blks_left->kblks.idc, blks_left->vblks.idc,
                          num_ptombs, hlog_data(work[LEFT].hlog),
@@ -641,7 +665,7 @@ hblock_split(
             err = blk_list_append(result->ks[LEFT].blks_commit, blks_left->hblk_id);
     }
 
-    if (!err && (blks_right->kblks.idc > 0 || ptree)) {
+    if (!err && (blks_right->kblks.idc > 0 || ptree || hbb_get_nrtombs(work[RIGHT].hbb) > 0)) {
         err = hbb_finish(work[RIGHT].hbb, &blks_right->hblk_id, work[RIGHT].vgmap, &min_pfx, &max_pfx,
                          min_seqno, max_seqno, blks_right->kblks.idc, blks_right->vblks.idc,
                          num_ptombs, hlog_data(work[RIGHT].hlog),
@@ -677,7 +701,7 @@ kvset_split(
     if (err)
         goto errout;
 
-    err = hblock_split(ks, work, result);
+    err = hblock_split(ks, split_kobj, work, result);
     if (err)
         goto errout;
 
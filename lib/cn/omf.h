@@ -56,7 +56,9 @@ OMF_SETGET(struct wbt_hdr_omf, wbt_kmd_pgc, 16);
 #define WBT_LFE_NODE_MAGIC ((uint16_t)0xabc0)
 #define WBT_INE_NODE_MAGIC ((uint16_t)0xabc1)
 
-/* WBT node header (v6) */
+/* WBT node header (v6, v7).  See wbt_internal.h for the v7 internal node
+ * key fingerprint array.
+ */
 struct wbt_node_hdr_omf {
     uint16_t wbn_magic;    /* magic number, distinguishes INEs from LFEs */
     uint16_t wbn_num_keys; /* number of keys in node */
@@ -136,6 +138,15 @@ struct hblock_hdr_omf {
     uint32_t hbh_min_pfx_off;
     uint8_t hbh_min_pfx_len;
     uint8_t hbh_rsvd2[3];
+
+    /* range tombstones (version 2 and later) */
+    uint32_t hbh_num_rtombs;
+    uint32_t hbh_rtomb_off_pg;
+    uint32_t hbh_rtomb_len_pg;
+
+    /* live bytes per vblock, one le32 per vblock (version 3 and later) */
+    uint32_t hbh_vbused_off_pg;
+    uint32_t hbh_vbused_len_pg;
 } HSE_PACKED;
 
 OMF_SETGET(struct hblock_hdr_omf, hbh_magic, 32)
@@ -155,6 +166,11 @@ OMF_SETGET(struct hblock_hdr_omf, hbh_max_pfx_off, 32)
 OMF_SETGET(struct hblock_hdr_omf, hbh_max_pfx_len, 8)
 OMF_SETGET(struct hblock_hdr_omf, hbh_min_pfx_off, 32)
 OMF_SETGET(struct hblock_hdr_omf, hbh_min_pfx_len, 8)
+OMF_SETGET(struct hblock_hdr_omf, hbh_num_rtombs, 32)
+OMF_SETGET(struct hblock_hdr_omf, hbh_rtomb_off_pg, 32)
+OMF_SETGET(struct hblock_hdr_omf, hbh_rtomb_len_pg, 32)
+OMF_SETGET(struct hblock_hdr_omf, hbh_vbused_off_pg, 32)
+OMF_SETGET(struct hblock_hdr_omf, hbh_vbused_len_pg, 32)
 
 static_assert(HSE_KVS_PFX_LEN_MAX <= UINT8_MAX,
     "uint8_t is not enough to hold HSE_KVS_PFX_LEN_MAX");
@@ -165,6 +181,28 @@ static_assert(HSE_KVS_PFX_LEN_MAX <= UINT8_MAX,
 
 static_assert(HBLOCK_HDR_PAGES == 1, "Hblock header spanning more than 1 page has not been tested");
 
+/* Range tombstone region: hbh_num_rtombs packed, variable length entries,
+ * each a struct rtomb_omf followed by the start key and then the end key.
+ */
+struct rtomb_omf {
+    uint64_t rto_seqno;
+    uint16_t rto_slen;
+    uint16_t rto_elen;
+} HSE_PACKED;
+
+OMF_SETGET(struct rtomb_omf, rto_seqno, 64)
+OMF_SETGET(struct rtomb_omf, rto_slen, 16)
+OMF_SETGET(struct rtomb_omf, rto_elen, 16)
+
+/* Vblock usage region: one entry per vblock giving the number of bytes of
+ * the vblock still referenced by the kvset's keys.
+ */
+struct vbused_omf {
+    uint32_t vbu_used;
+} HSE_PACKED;
+
+OMF_SETGET(struct vbused_omf, vbu_used, 32)
+
 
 /*****************************************************************
  *
@@ -248,6 +286,14 @@ struct kblock_hdr_omf {
     uint32_t kbh_blm_hlen;
     uint32_t kbh_blm_doff_pg;
     uint32_t kbh_blm_dlen_pg;
+
+    /* Prefix bloom header and data (version 7) */
+    uint32_t kbh_pblm_hoff;
+    uint32_t kbh_pblm_hlen;
+    uint32_t kbh_pblm_doff_pg;
+    uint32_t kbh_pblm_dlen_pg;
+    uint32_t kbh_pblm_pfxlen;
+    uint32_t kbh_rsvd3;
 } HSE_PACKED;
 
 /* Define set/get methods for kblock_hdr_omf */
@@ -278,6 +324,12 @@ OMF_SETGET(struct kblock_hdr_omf, kbh_blm_hlen, 32)
 OMF_SETGET(struct kblock_hdr_omf, kbh_blm_doff_pg, 32)
 OMF_SETGET(struct kblock_hdr_omf, kbh_blm_dlen_pg, 32)
 
+OMF_SETGET(struct kblock_hdr_omf, kbh_pblm_hoff, 32)
+OMF_SETGET(struct kblock_hdr_omf, kbh_pblm_hlen, 32)
+OMF_SETGET(struct kblock_hdr_omf, kbh_pblm_doff_pg, 32)
+OMF_SETGET(struct kblock_hdr_omf, kbh_pblm_dlen_pg, 32)
+OMF_SETGET(struct kblock_hdr_omf, kbh_pblm_pfxlen, 32)
+
 /* Storing 2 keys in the header: min and max. */
 #define KBLOCK_HDR_PAGES \
     (roundup(sizeof(struct kblock_hdr_omf) + 2 * HSE_KVS_KEY_LEN_MAX, PAGE_SIZE) / PAGE_SIZE)
@@ -293,15 +345,27 @@ static_assert(KBLOCK_HDR_PAGES == 1, "Kblock header spanning more than 1 page ha
 
 #define BLOOM_OMF_MAGIC ((uint32_t)('b' << 24 | 'l' << 16 | 'm' << 8 | 'h'))
 
+/* Filter types (bh_type).  Version 5 headers are always BLOOM_OMF_BLOCKED.
+ */
+enum bloom_omf_type {
+    BLOOM_OMF_BLOCKED = 0,
+    BLOOM_OMF_FUSE = 1,
+};
+
 /**
  * struct bloom_hdr_omf -
  * @bh_magic:           BLOOM_OMF_MAGIC
  * @bh_version:         BLOOM_OMF_VERSION
  * @bh_bktsz:           number of bytes per bucket
+ * @bh_type:            filter type (enum bloom_omf_type)
+ * @bh_fpbits:          bits per fingerprint (fuse)
  * @bh_rotl:            hash rotate left amount
  * @bh_n_hashes:        number of hashes per bucket
- * @bh_bitmapsz:        size of bitmap in bytes
- * @bh_modulus:         modulus used to convert first hash to bucket
+ * @bh_bitmapsz:        size of bitmap (or fingerprint array) in bytes
+ * @bh_modulus:         modulus used to convert first hash to bucket (blocked)
+ *                      or to first segment slot (fuse)
+ * @bh_seglen:          fingerprints per segment (fuse)
+ * @bh_seed:            hash seed (fuse)
  */
 struct bloom_hdr_omf {
     uint32_t bh_magic;
@@ -309,11 +373,12 @@ struct bloom_hdr_omf {
     uint32_t bh_bitmapsz;
     uint32_t bh_modulus;
     uint32_t bh_bktshift;
-    uint16_t bh_rsvd1;
+    uint8_t  bh_type;
+    uint8_t  bh_fpbits;
     uint8_t  bh_rotl;
     uint8_t  bh_n_hashes;
-    uint32_t bh_rsvd2;
-    uint32_t bh_rsvd3;
+    uint32_t bh_seglen;
+    uint32_t bh_seed;
 } HSE_PACKED;
 
 /* Define set/get methods for bloom_hdr_omf */
@@ -324,6 +389,10 @@ OMF_SETGET(struct bloom_hdr_omf, bh_modulus, 32)
 OMF_SETGET(struct bloom_hdr_omf, bh_bktshift, 32)
 OMF_SETGET(struct bloom_hdr_omf, bh_rotl, 8)
 OMF_SETGET(struct bloom_hdr_omf, bh_n_hashes, 8)
+OMF_SETGET(struct bloom_hdr_omf, bh_type, 8)
+OMF_SETGET(struct bloom_hdr_omf, bh_fpbits, 8)
+OMF_SETGET(struct bloom_hdr_omf, bh_seglen, 32)
+OMF_SETGET(struct bloom_hdr_omf, bh_seed, 32)
 
 /*****************************************************************
  *
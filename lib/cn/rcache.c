@@ -0,0 +1,363 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <stdlib.h>
+
+#include <hse/util/alloc.h>
+#include <hse/util/assert.h>
+#include <hse/util/atomic.h>
+#include <hse/util/event_counter.h>
+#include <hse/util/log2.h>
+#include <hse/util/minmax.h>
+#include <hse/util/perfc.h>
+#include <hse/util/spinlock.h>
+#include <hse/logging/logging.h>
+
+#include <hse/kvdb_perfc.h>
+
+#include "rcache.h"
+
+#define RCACHE_WAYS         (6)
+#define RCACHE_SETS_MIN     (64)
+#define RCACHE_ITEMSZ_EST   (128)
+#define RCACHE_VLEN_MAX     (4096)
+
+/**
+ * struct rcache_item - a cached lookup result
+ * @ri_hash:  key hash (kt_hash)
+ * @ri_epoch: cache epoch at which the result was looked up
+ * @ri_seqno: seqno of the value (zero if not found)
+ * @ri_vlen:  value length
+ * @ri_klen:  key length
+ * @ri_res:   lookup result
+ * @ri_clock: referenced since the last pass of the clock hand
+ * @ri_data:  key immediately followed by the value
+ */
+struct rcache_item {
+    uint64_t ri_hash;
+    uint64_t ri_epoch;
+    uint64_t ri_seqno;
+    uint32_t ri_vlen;
+    uint16_t ri_klen;
+    uint8_t  ri_res;
+    bool     ri_clock;
+    uint8_t  ri_data[];
+};
+
+/**
+ * struct rcache_set - an independently locked set of items
+ * @rs_lock:  protects all fields of the set
+ * @rs_hand:  clock hand (index into rs_itemv[])
+ * @rs_itemv: items (NULL if unused)
+ */
+struct rcache_set {
+    spinlock_t          rs_lock;
+    uint                rs_hand;
+    struct rcache_item *rs_itemv[RCACHE_WAYS];
+} HSE_L1D_ALIGNED;
+
+struct rcache {
+    atomic_ulong      rc_epoch HSE_L1D_ALIGNED;
+    atomic_ulong      rc_seqno;
+    atomic_long       rc_bytes HSE_L1D_ALIGNED;
+    size_t            rc_size;
+    uint64_t          rc_smask;
+    struct perfc_set *rc_pc;
+    struct rcache_set rc_setv[];
+};
+
+static HSE_ALWAYS_INLINE size_t
+rcache_item_size(const struct rcache_item *item)
+{
+    return sizeof(*item) + item->ri_klen + item->ri_vlen;
+}
+
+static HSE_ALWAYS_INLINE struct rcache_set *
+rcache_set(struct rcache *rc, uint64_t hash)
+{
+    return rc->rc_setv + ((hash ^ (hash >> 32)) & rc->rc_smask);
+}
+
+static HSE_ALWAYS_INLINE bool
+rcache_item_match(const struct rcache_item *item, const struct kvs_ktuple *kt)
+{
+    return item->ri_hash == kt->kt_hash && item->ri_klen == kt->kt_len &&
+        !memcmp(item->ri_data, kt->kt_data, kt->kt_len);
+}
+
+static void
+rcache_item_free(struct rcache *rc, struct rcache_item *item)
+{
+    const size_t sz = rcache_item_size(item);
+
+    atomic_sub(&rc->rc_bytes, sz);
+    perfc_sub(rc->rc_pc, PERFC_BA_CNRCACHE_BYTES, sz);
+    free(item);
+}
+
+bool
+rcache_lookup(
+    struct rcache           *rc,
+    const struct kvs_ktuple *kt,
+    uint64_t                 seq,
+    enum key_lookup_res     *res,
+    struct kvs_buf          *vbuf)
+{
+    struct rcache_set *rs = rcache_set(rc, kt->kt_hash);
+    uint64_t epoch = atomic_read_acq(&rc->rc_epoch);
+
+    spin_lock(&rs->rs_lock);
+    for (uint i = 0; i < RCACHE_WAYS; ++i) {
+        struct rcache_item *item = rs->rs_itemv[i];
+
+        if (!item || !rcache_item_match(item, kt))
+            continue;
+
+        /* The entry is stale or holds a value the view cannot see.
+         */
+        if (item->ri_epoch != epoch || item->ri_seqno > seq)
+            break;
+
+        *res = item->ri_res;
+
+        if (*res == FOUND_VAL) {
+            uint32_t copylen = min_t(uint32_t, item->ri_vlen, vbuf->b_buf_sz);
+
+            if (copylen > 0)
+                memcpy(vbuf->b_buf, item->ri_data + item->ri_klen, copylen);
+            vbuf->b_len = item->ri_vlen;
+        }
+
+        item->ri_clock = true;
+        spin_unlock(&rs->rs_lock);
+
+        perfc_inc(rc->rc_pc, PERFC_RA_CNRCACHE_HIT);
+
+        return true;
+    }
+    spin_unlock(&rs->rs_lock);
+
+    perfc_inc(rc->rc_pc, PERFC_RA_CNRCACHE_MISS);
+
+    return false;
+}
+
+uint64_t
+rcache_fill_begin(struct rcache *rc, uint64_t seq)
+{
+    uint64_t epoch = atomic_read_acq(&rc->rc_epoch);
+
+    /* The result of a lookup at a view that cannot see all of cn
+     * isn't necessarily the newest value of the key in cn.
+     */
+    if (seq < atomic_read(&rc->rc_seqno))
+        return 0;
+
+    return epoch;
+}
+
+void
+rcache_fill(
+    struct rcache           *rc,
+    uint64_t                 cookie,
+    const struct kvs_ktuple *kt,
+    uint64_t                 vseq,
+    enum key_lookup_res      res,
+    const struct kvs_buf    *vbuf)
+{
+    struct rcache_item *item, *victim = NULL, *old = NULL;
+    struct rcache_set *rs;
+    uint32_t vlen = 0;
+    size_t sz;
+    uint i, n;
+
+    if (!cookie || res == FOUND_MULTIPLE)
+        return;
+
+    if (res == FOUND_VAL) {
+        vlen = vbuf->b_len;
+        if (vlen > RCACHE_VLEN_MAX || vlen > vbuf->b_buf_sz)
+            return;
+    }
+
+    sz = sizeof(*item) + kt->kt_len + vlen;
+
+    item = malloc(sz);
+    if (ev(!item))
+        return;
+
+    item->ri_hash = kt->kt_hash;
+    item->ri_epoch = cookie;
+    item->ri_seqno = vseq;
+    item->ri_vlen = vlen;
+    item->ri_klen = kt->kt_len;
+    item->ri_res = res;
+    item->ri_clock = false;
+    memcpy(item->ri_data, kt->kt_data, kt->kt_len);
+    if (vlen > 0)
+        memcpy(item->ri_data + kt->kt_len, vbuf->b_buf, vlen);
+
+    rs = rcache_set(rc, kt->kt_hash);
+
+    spin_lock(&rs->rs_lock);
+    if (atomic_read(&rc->rc_epoch) != cookie) {
+        spin_unlock(&rs->rs_lock);
+        free(item);
+        return;
+    }
+
+    /* Replace the key's existing entry, if any, otherwise use an empty
+     * or stale slot, otherwise evict the first item the clock hand finds
+     * that has not been referenced since the hand last passed it.
+     */
+    for (i = 0; i < RCACHE_WAYS; ++i) {
+        if (rs->rs_itemv[i] && rcache_item_match(rs->rs_itemv[i], kt))
+            break;
+    }
+
+    if (i == RCACHE_WAYS) {
+        for (i = 0; i < RCACHE_WAYS; ++i) {
+            if (!rs->rs_itemv[i] || rs->rs_itemv[i]->ri_epoch != cookie)
+                break;
+        }
+    }
+
+    if (i < RCACHE_WAYS) {
+        old = rs->rs_itemv[i];
+    } else {
+        for (n = RCACHE_WAYS * 2; n > 0; --n) {
+            i = rs->rs_hand;
+
+            if (++rs->rs_hand >= RCACHE_WAYS)
+                rs->rs_hand = 0;
+
+            if (!rs->rs_itemv[i]->ri_clock)
+                break;
+
+            rs->rs_itemv[i]->ri_clock = false;
+        }
+
+        victim = rs->rs_itemv[i];
+    }
+
+    rs->rs_itemv[i] = NULL;
+
+    /* Stay within budget, at the expense of the new item if evicting
+     * the slot's previous occupant wasn't enough.
+     */
+    if (atomic_add_return(&rc->rc_bytes, sz) - (old ? rcache_item_size(old) : 0) -
+        (victim ? rcache_item_size(victim) : 0) > rc->rc_size) {
+        atomic_sub(&rc->rc_bytes, sz);
+        free(item);
+        item = NULL;
+    } else {
+        rs->rs_itemv[i] = item;
+    }
+    spin_unlock(&rs->rs_lock);
+
+    if (item)
+        perfc_add(rc->rc_pc, PERFC_BA_CNRCACHE_BYTES, sz);
+    if (old)
+        rcache_item_free(rc, old);
+    if (victim)
+        rcache_item_free(rc, victim);
+}
+
+void
+rcache_invalidate(struct rcache *rc, const struct kvs_ktuple *kt)
+{
+    struct rcache_item *old = NULL;
+    struct rcache_set *rs;
+
+    if (!rc)
+        return;
+
+    rs = rcache_set(rc, kt->kt_hash);
+
+    spin_lock(&rs->rs_lock);
+    for (uint i = 0; i < RCACHE_WAYS; ++i) {
+        if (rs->rs_itemv[i] && rcache_item_match(rs->rs_itemv[i], kt)) {
+            old = rs->rs_itemv[i];
+            rs->rs_itemv[i] = NULL;
+            break;
+        }
+    }
+    spin_unlock(&rs->rs_lock);
+
+    if (old)
+        rcache_item_free(rc, old);
+}
+
+void
+rcache_flush(struct rcache *rc, uint64_t seqno)
+{
+    uint64_t cur;
+
+    if (!rc)
+        return;
+
+    cur = atomic_read(&rc->rc_seqno);
+    while (seqno > cur && !atomic_cas(&rc->rc_seqno, cur, seqno))
+        cur = atomic_read(&rc->rc_seqno);
+
+    /* Stale items are reclaimed lazily by rcache_fill().
+     */
+    atomic_inc_rel(&rc->rc_epoch);
+
+    perfc_inc(rc->rc_pc, PERFC_RA_CNRCACHE_FLUSH);
+}
+
+merr_t
+rcache_create(size_t size, uint64_t seqno, struct perfc_set *pc, struct rcache **rc_out)
+{
+    struct rcache *rc;
+    size_t setc;
+
+    if (ev(!rc_out || !size))
+        return merr(EINVAL);
+
+    setc = roundup_pow_of_two(max_t(size_t, size / (RCACHE_WAYS * RCACHE_ITEMSZ_EST),
+                                    RCACHE_SETS_MIN));
+
+    rc = aligned_alloc(__alignof__(*rc), sizeof(*rc) + sizeof(rc->rc_setv[0]) * setc);
+    if (ev(!rc))
+        return merr(ENOMEM);
+
+    memset(rc, 0, sizeof(*rc) + sizeof(rc->rc_setv[0]) * setc);
+
+    for (size_t i = 0; i < setc; ++i)
+        spin_lock_init(&rc->rc_setv[i].rs_lock);
+
+    /* Epoch zero is reserved for "do not fill".
+     */
+    atomic_set(&rc->rc_epoch, 1);
+    atomic_set(&rc->rc_seqno, seqno);
+    atomic_set(&rc->rc_bytes, 0);
+    rc->rc_size = size;
+    rc->rc_smask = setc - 1;
+    rc->rc_pc = pc;
+
+    *rc_out = rc;
+
+    return 0;
+}
+
+void
+rcache_destroy(struct rcache *rc)
+{
+    if (!rc)
+        return;
+
+    for (size_t i = 0; i <= rc->rc_smask; ++i) {
+        struct rcache_set *rs = rc->rc_setv + i;
+
+        for (uint j = 0; j < RCACHE_WAYS; ++j) {
+            if (rs->rs_itemv[j])
+                rcache_item_free(rc, rs->rs_itemv[j]);
+        }
+    }
+
+    free(rc);
+}
@@ -0,0 +1,122 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_KVS_CN_RCACHE_H
+#define HSE_KVS_CN_RCACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <hse/error/merr.h>
+
+#include <hse/ikvdb/tuple.h>
+
+/* The result cache is an optional per-kvs cache of cn point lookup results
+ * (values, tombstones and misses) that is consulted before descending the
+ * cn tree.  It has a fixed byte budget and is organized as a set-associative
+ * hash table with a clock per set.
+ *
+ * The contents of cn only change in ways visible to a point lookup when
+ * data is ingested from c0/lc (compaction does not change the newest value
+ * of any key), so an ingest bumps the cache epoch which invalidates all
+ * entries in O(1).  A result is admitted only if the view at which it was
+ * looked up can see all data in cn, in which case it is the newest value
+ * of the key in cn and may be returned to any view that can see it until
+ * the next ingest.  Newer values in c0 and lc shadow the cache because they
+ * are searched first, but puts and deletes drop the key's entry anyway so
+ * that the budget isn't spent on keys that are being overwritten.
+ */
+
+struct rcache;
+struct perfc_set;
+
+/**
+ * rcache_create() - create a result cache
+ * @size:   cache size in bytes
+ * @seqno:  max seqno of all data in cn
+ * @pc:     perfc set (may be NULL)
+ * @rc_out: result cache (output)
+ */
+merr_t
+rcache_create(size_t size, uint64_t seqno, struct perfc_set *pc, struct rcache **rc_out);
+
+/**
+ * rcache_destroy() - destroy a result cache
+ * @rc: result cache (may be NULL)
+ */
+void
+rcache_destroy(struct rcache *rc);
+
+/**
+ * rcache_lookup() - look up a key in the result cache
+ * @rc:   result cache
+ * @kt:   key
+ * @seq:  view seqno
+ * @res:  (output) lookup result
+ * @vbuf: (output) value if %res is FOUND_VAL
+ *
+ * Return: Returns true on a hit, in which case %res and %vbuf are set as
+ * if by cn_get().
+ */
+bool
+rcache_lookup(
+    struct rcache           *rc,
+    const struct kvs_ktuple *kt,
+    uint64_t                 seq,
+    enum key_lookup_res     *res,
+    struct kvs_buf          *vbuf);
+
+/**
+ * rcache_fill_begin() - start a cache fill
+ * @rc:  result cache
+ * @seq: view seqno of the lookup about to be performed
+ *
+ * Return: Returns a cookie to pass to rcache_fill() once the result of the
+ * lookup is known, or zero if the result at this view cannot be cached.
+ */
+uint64_t
+rcache_fill_begin(struct rcache *rc, uint64_t seq);
+
+/**
+ * rcache_fill() - admit a lookup result
+ * @rc:     result cache
+ * @cookie: cookie from rcache_fill_begin()
+ * @kt:     key
+ * @vseq:   seqno of the value found (zero if %res is NOT_FOUND)
+ * @res:    lookup result
+ * @vbuf:   value if %res is FOUND_VAL
+ *
+ * The result is dropped if an ingest happened since rcache_fill_begin(),
+ * or if the value is too large or was truncated by the caller's buffer.
+ */
+void
+rcache_fill(
+    struct rcache           *rc,
+    uint64_t                 cookie,
+    const struct kvs_ktuple *kt,
+    uint64_t                 vseq,
+    enum key_lookup_res      res,
+    const struct kvs_buf    *vbuf);
+
+/**
+ * rcache_invalidate() - drop the entry for a key
+ * @rc: result cache (may be NULL)
+ * @kt: key
+ */
+void
+rcache_invalidate(struct rcache *rc, const struct kvs_ktuple *kt);
+
+/**
+ * rcache_flush() - invalidate all entries
+ * @rc:    result cache (may be NULL)
+ * @seqno: max seqno of the data (if any) just added to cn
+ *
+ * Must be called after new data has been made visible in the cn tree.
+ */
+void
+rcache_flush(struct rcache *rc, uint64_t seqno);
+
+#endif
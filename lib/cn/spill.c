@@ -87,8 +87,15 @@ get_direct_read_buf(uint len, bool aligned_voff, u32 *bufsz, void **buf)
 
 struct spillctx {
     struct cn_compaction_work *work;
+    struct cn_merge_stats     *stats;
 
     uint64_t         sgen;
+    bool             primary;
+    bool             dryrun;
+
+    /* Iterators owned by a range spill context */
+    uint                 itc;
+    struct kv_iterator **itv;
 
     /* Merge Loop */
     struct bin_heap        *bh;
@@ -100,8 +107,23 @@ struct spillctx {
     struct key_obj pt_kobj;
     u64            pt_seq; /* [HSE_REVISIT]: Need a list of seqnos to carry all ptombs across leaves. */
     bool           pt_set;
+
+    /* Rtombs: the previous child's edge key bounds the current child's range */
+    uint    prev_eklen;
+    bool    prev_eset;
+    uint8_t prev_ekey[HSE_KVS_KEY_LEN_MAX];
+    uint    rt_minlen;
+    uint8_t rt_min[HSE_KVS_KEY_LEN_MAX];
 };
 
+static void
+spill_edge_save(struct spillctx *sctx, const void *ekey, uint eklen)
+{
+    memcpy(sctx->prev_ekey, ekey, eklen);
+    sctx->prev_eklen = eklen;
+    sctx->prev_eset = true;
+}
+
 merr_t
 cn_spill_create(struct cn_compaction_work *w, struct spillctx **sctx_out)
 {
@@ -133,7 +155,9 @@ cn_spill_create(struct cn_compaction_work *w, struct spillctx **sctx_out)
         goto out;
 
     s->work = w;
+    s->stats = &w->cw_stats;
     s->sgen = w->cw_sgen;
+    s->primary = true;
 
     s->more = bin_heap_peek(s->bh, (void **)&s->curr);
     if (s->curr) {
@@ -152,12 +176,103 @@ out:
     return err;
 }
 
+merr_t
+cn_spill_range_create(
+    struct cn_compaction_work *w,
+    struct workqueue_struct   *vra_wq,
+    const void                *key,
+    uint                       klen,
+    const void                *prev_ekey,
+    uint                       prev_eklen,
+    struct cn_merge_stats     *stats,
+    struct spillctx          **sctx_out)
+{
+    struct key_obj kobj;
+    struct spillctx *s;
+    size_t sz;
+    merr_t err;
+
+    sz = sizeof(*s) + w->cw_kvset_cnt * (sizeof(*s->bh_sources) + sizeof(*s->itv));
+
+    s = malloc(sz);
+    if (!s)
+        return merr(ENOMEM);
+
+    memset(s, 0, sz);
+    s->bh_sources = (void *)(s + 1);
+    s->itv = (void *)(s->bh_sources + w->cw_kvset_cnt);
+
+    err = bin_heap_create(w->cw_kvset_cnt, kv_item_compare, &s->bh);
+    if (err)
+        goto out;
+
+    /* The spill's own input iterators read the kblocks sequentially from
+     * the first key, so a range creates mmap iterators over the same kvsets
+     * (in the same order) that it can position at the start of its range.
+     */
+    for (uint i = 0; i < w->cw_kvset_cnt; i++) {
+        struct kvset *ks = kvset_iter_kvset_get(w->cw_inputv[i]);
+        bool eof;
+
+        err = kvset_iter_create(ks, NULL, vra_wq, w->cw_pc,
+                                kvset_iter_flag_fullscan | kvset_iter_flag_mmap, &s->itv[i]);
+        if (err)
+            goto out;
+
+        s->itc++;
+        kvset_iter_set_stats(s->itv[i], stats);
+
+        err = kvset_iter_seek(s->itv[i], key, klen, &eof);
+        if (err)
+            goto out;
+
+        s->bh_sources[i] = kvset_iter_es_get(s->itv[i]);
+    }
+
+    err = bin_heap_prepare(s->bh, w->cw_kvset_cnt, s->bh_sources);
+    if (err)
+        goto out;
+
+    s->work = w;
+    s->stats = stats;
+    s->sgen = w->cw_sgen;
+
+    /* Seeks are kblock granular, discard the keys that precede the range.
+     */
+    key2kobj(&kobj, key, klen);
+
+    s->more = bin_heap_peek(s->bh, (void **)&s->curr);
+    while (s->more && key_obj_cmp(&s->curr->kobj, &kobj) < 0) {
+        bin_heap_pop(s->bh, NULL);
+        s->more = bin_heap_peek(s->bh, (void **)&s->curr);
+    }
+
+    if (s->curr) {
+        stats->ms_keys_in++;
+        stats->ms_key_bytes_in += key_obj_len(&s->curr->kobj);
+    }
+
+    if (prev_ekey)
+        spill_edge_save(s, prev_ekey, prev_eklen);
+
+    *sctx_out = s;
+
+out:
+    if (err)
+        cn_spill_destroy(s);
+
+    return err;
+}
+
 void
 cn_spill_destroy(struct spillctx *sctx)
 {
     if (!sctx)
         return;
 
+    for (uint i = 0; i < sctx->itc; i++)
+        sctx->itv[i]->kvi_ops->kvi_release(sctx->itv[i]);
+
     bin_heap_destroy(sctx->bh);
     free(sctx);
 }
@@ -217,6 +332,9 @@ cn_subspill(
     uint seqno_errcnt = 0;
     bool new_key;
     struct key_obj ekobj;
+    const void *rt_min, *rt_max;
+    bool rt_overlap = false;
+    u64 rt_seq = 0;
 
     key2kobj(&ekobj, ekey, eklen);
 
@@ -227,7 +345,7 @@ cn_subspill(
 
     ss->ss_sgen = w->cw_sgen;
 
-    if (w->cw_prog_interval && w->cw_progress)
+    if (w->cw_prog_interval && w->cw_progress && sctx->primary)
         tprog = jiffies;
 
     /* We must issue a direct read for all values that will not fit into the vblock readahead
@@ -241,46 +359,75 @@ cn_subspill(
     ss->ss_added = false;
     ss->ss_work = w;
 
-    if (!sctx->more && !sctx->pt_set)
+    /* An rtomb is propagated to every child whose key range it intersects.
+     */
+    rt_min = NULL;
+    if (sctx->prev_eset) {
+        memcpy(sctx->rt_min, sctx->prev_ekey, sctx->prev_eklen);
+        sctx->rt_minlen = sctx->prev_eklen;
+        rt_min = sctx->rt_min;
+    }
+
+    rt_max = route_node_islast(node->tn_route_node) ? NULL : ekey;
+
+    for (uint32_t i = 0; i < w->cw_rtombs.rv_cnt && !rt_overlap; ++i)
+        rt_overlap = rtomb_overlaps(w->cw_rtombs.rv_v[i], rt_min, sctx->rt_minlen, rt_max, eklen);
+
+    if (!sctx->more && !sctx->pt_set && !rt_overlap) {
+        spill_edge_save(sctx, ekey, eklen);
         return 0;
+    }
 
-    /* Proceed only if either the curr key belongs in this leaf node OR there's a ptomb that needs
-     * to be propagated to this child.
+    /* Proceed only if either the curr key belongs in this leaf node OR there's a ptomb or an
+     * rtomb that needs to be propagated to this child.
      */
-    if (!sctx->pt_set && key_obj_cmp(&sctx->curr->kobj, &ekobj) > 0)
+    if (!sctx->pt_set && !rt_overlap && key_obj_cmp(&sctx->curr->kobj, &ekobj) > 0) {
+        spill_edge_save(sctx, ekey, eklen);
         return 0;
+    }
 
-    w->cw_kvsetidv[0] = ss->ss_kvsetid = cndb_kvsetid_mint(cn_tree_get_cndb(w->cw_tree));
+    spill_edge_save(sctx, ekey, eklen);
 
-    err = kvset_builder_create(&child, cn_tree_get_cn(w->cw_tree), w->cw_pc, ss->ss_kvsetid);
-    if (err)
-        return err;
+    if (!sctx->dryrun) {
+        ss->ss_kvsetid = cndb_kvsetid_mint(cn_tree_get_cndb(w->cw_tree));
+        if (sctx->primary)
+            w->cw_kvsetidv[0] = ss->ss_kvsetid;
+
+        err = kvset_builder_create(&child, cn_tree_get_cn(w->cw_tree), w->cw_pc, ss->ss_kvsetid);
+        if (err)
+            return err;
 
-    assert(child);
+        assert(child);
 
-    kvset_builder_set_merge_stats(child, &w->cw_stats);
+        kvset_builder_set_merge_stats(child, sctx->stats);
 
-    err = kvset_builder_set_agegroup(child, HSE_MPOLICY_AGE_LEAF);
-    if (err) {
-        kvset_builder_destroy(child);
-        return err;
+        err = kvset_builder_set_agegroup(child, cn_tree_node_agegroup(node));
+        if (err) {
+            kvset_builder_destroy(child);
+            return err;
+        }
+
+        kvset_builder_set_bloom_prob(child, cn_tree_node_bloom_prob(node));
     }
 
     /* Add ptomb to 'child' if a ptomb context is carried forward from the
      * previous node spill, i.e., this ptomb spans across multiple children.
      */
     if (sctx->pt_set && (!w->cw_drop_tombs || sctx->pt_seq > w->cw_horizon)) {
-        err = kvset_builder_add_val(child, &sctx->pt_kobj, HSE_CORE_TOMB_PFX, 0, sctx->pt_seq, 0);
-        if (!err)
-            err = kvset_builder_add_key(child, &sctx->pt_kobj);
-
-        if (err) {
-            kvset_builder_destroy(child);
-            return err;
+        if (!sctx->dryrun) {
+            err = kvset_builder_add_val(child, &sctx->pt_kobj, HSE_CORE_TOMB_PFX, 0,
+                                        sctx->pt_seq, 0);
+            if (!err)
+                err = kvset_builder_add_key(child, &sctx->pt_kobj);
+
+            if (err) {
+                kvset_builder_destroy(child);
+                return err;
+            }
         }
 
-        w->cw_stats.ms_keys_out++;
-        w->cw_stats.ms_key_bytes_out += key_obj_len(&sctx->pt_kobj);
+        sctx->stats->ms_keys_out++;
+        sctx->stats->ms_key_bytes_out += key_obj_len(&sctx->pt_kobj);
 
         ss->ss_added = true;
         if (key_obj_cmp_prefix(&sctx->pt_kobj, &ekobj) < 0)
@@ -310,6 +457,8 @@ cn_subspill(
 
             if (sctx->pt_set && key_obj_cmp_prefix(&sctx->pt_kobj, &sctx->curr->kobj) != 0)
                 sctx->pt_set = false; /* cached ptomb key is no longer valid */
+
+            rt_seq = cn_compact_rtomb_seqno(w, &sctx->curr->kobj);
         }
 
         while (!bg_val) {
@@ -331,7 +480,16 @@ cn_subspill(
             omlen = (vtype == VTYPE_UCVAL) ? vlen : ((vtype == VTYPE_CVAL) ? complen : 0);
 
             direct = omlen > direct_read_len;
-            if (direct) {
+            if (sctx->dryrun) {
+                /* Only the tombstones affect the state carried across leaves.
+                 */
+                if (vtype == VTYPE_TOMB)
+                    vdata = HSE_CORE_TOMB_REG;
+                else if (vtype == VTYPE_PTOMB)
+                    vdata = HSE_CORE_TOMB_PFX;
+                else if (vtype != VTYPE_IVAL)
+                    vdata = NULL;
+            } else if (direct) {
                 err = get_direct_read_buf(omlen, !(vboff % PAGE_SIZE), &bufsz, &buf);
                 if (err)
                     break;
@@ -370,6 +528,9 @@ cn_subspill(
             if (bg_val && sctx->pt_set && w->cw_horizon >= sctx->pt_seq && sctx->pt_seq > seq)
                 break; /* drop val if it and pt are beyond horizon */
 
+            if (rt_seq > seq)
+                break; /* drop val if it and its rtomb are beyond horizon */
+
             /* Set ptomb context irrespective of bg_val for tombstone propagation */
             if (HSE_CORE_IS_PTOMB(vdata)) {
                 sctx->pt_set = true;
@@ -391,11 +552,14 @@ cn_subspill(
                 if (w->cw_drop_tombs && HSE_CORE_IS_TOMB(vdata) && bg_val)
                     continue; /* skip value */
 
-                err = kvset_builder_add_val(child, &sctx->curr->kobj, vdata, vlen, seq, complen);
-                if (err)
-                    break;
+                if (!sctx->dryrun) {
+                    err = kvset_builder_add_val(child, &sctx->curr->kobj, vdata, vlen, seq,
+                                                complen);
+                    if (err)
+                        break;
+                }
 
-                w->cw_stats.ms_val_bytes_out += complen ? complen : vlen;
+                sctx->stats->ms_val_bytes_out += complen ? complen : vlen;
                 emitted_val = true;
                 if (HSE_CORE_IS_PTOMB(vdata))
                     emitted_seq_pt = seq;
@@ -438,8 +602,8 @@ cn_subspill(
         sctx->more = bin_heap_peek(bh, (void **)&sctx->curr);
 
         if (sctx->curr) {
-            w->cw_stats.ms_keys_in++;
-            w->cw_stats.ms_key_bytes_in += key_obj_len(&sctx->curr->kobj);
+            sctx->stats->ms_keys_in++;
+            sctx->stats->ms_key_bytes_in += key_obj_len(&sctx->curr->kobj);
         }
 
         if (sctx->more) {
@@ -452,13 +616,15 @@ cn_subspill(
         }
 
         if (emitted_val) {
-            err = kvset_builder_add_key(child, &prev_kobj);
-            if (err)
-                goto out;
+            if (!sctx->dryrun) {
+                err = kvset_builder_add_key(child, &prev_kobj);
+                if (err)
+                    goto out;
+            }
 
             ss->ss_added = true;
-            w->cw_stats.ms_keys_out++;
-            w->cw_stats.ms_key_bytes_out += key_obj_len(&prev_kobj);
+            sctx->stats->ms_keys_out++;
+            sctx->stats->ms_key_bytes_out += key_obj_len(&prev_kobj);
         }
 
         new_key = true;
@@ -478,6 +644,16 @@ cn_subspill(
         }
     }
 
+    if (sctx->dryrun)
+        goto out;
+
+    if (rt_overlap) {
+        err = cn_compact_rtombs_emit(w, child, rt_min, sctx->rt_minlen, rt_max, eklen,
+                                     &ss->ss_added);
+        if (err)
+            goto out;
+    }
+
     err = kvset_builder_get_mblocks(child, &ss->ss_mblks);
 
 out:
@@ -487,7 +663,8 @@ out:
     if (sctx->pt_set && key_obj_cmp_prefix(&sctx->pt_kobj, &ekobj) != 0)
         sctx->pt_set = false;
 
-    kvset_builder_destroy(child);
+    if (child)
+        kvset_builder_destroy(child);
     free(buf);
 
     if (seqno_errcnt)
@@ -501,6 +678,24 @@ out:
     return err;
 }
 
+merr_t
+cn_subspill_skip(
+    struct spillctx     *sctx,
+    struct cn_tree_node *node,
+    uint64_t             node_dgen,
+    const void          *ekey,
+    uint                 eklen)
+{
+    struct subspill ss;
+    merr_t err;
+
+    sctx->dryrun = true;
+    err = cn_subspill(&ss, sctx, node, node_dgen, ekey, eklen);
+    sctx->dryrun = false;
+
+    return err;
+}
+
 #if HSE_MOCKING
 #include "spill_ut_impl.i"
 #endif /* HSE_MOCKING */
@@ -14,9 +14,11 @@
 #include "route.h"
 
 struct cn_compaction_work;
+struct cn_merge_stats;
 struct cn_tree_node;
 struct kvset_meta;
 struct spillctx;
+struct workqueue_struct;
 
 struct zspill {
     struct kvset_list_entry *zsp_src_list;
@@ -79,10 +81,56 @@ cn_subspill(
 merr_t
 cn_spill_create(struct cn_compaction_work *w, struct spillctx **sctx_out);
 
+/**
+ * cn_spill_range_create() - Create a spill context for a range of leaves
+ * @w:          spill work
+ * @vra_wq:     workqueue for vblock readahead
+ * @key:        first key of interest
+ * @klen:       length of @key
+ * @prev_ekey:  edge key of the leaf that precedes the range (may be NULL)
+ * @prev_eklen: length of @prev_ekey
+ * @stats:      merge stats for the range
+ * @sctx_out:   (output) spill context
+ *
+ * The context merges the spill's input kvsets starting at @key through
+ * its own iterators, such that it may run concurrently with the spill's
+ * primary context (as created by cn_spill_create()) and with other range
+ * contexts.  The caller must replay the leaves that may contain keys from
+ * @key up to @prev_ekey via cn_subspill_skip() before calling cn_subspill()
+ * on the first leaf of the range.
+ */
+/* MTF_MOCK */
+merr_t
+cn_spill_range_create(
+    struct cn_compaction_work *w,
+    struct workqueue_struct   *vra_wq,
+    const void                *key,
+    uint                       klen,
+    const void                *prev_ekey,
+    uint                       prev_eklen,
+    struct cn_merge_stats     *stats,
+    struct spillctx          **sctx_out);
+
 /* MTF_MOCK */
 void
 cn_spill_destroy(struct spillctx *ctx);
 
+/**
+ * cn_subspill_skip() - Consume a leaf's keys without building a kvset
+ *
+ * Advances the merge loop exactly as cn_subspill() would, so that the
+ * ptomb and rtomb state carried into the next leaf is identical, but
+ * neither allocates mblocks nor reads values.
+ */
+/* MTF_MOCK */
+merr_t
+cn_subspill_skip(
+    struct spillctx     *sctx,
+    struct cn_tree_node *node,
+    uint64_t             node_dgen,
+    const void          *ekey,
+    uint                 eklen);
+
 /* MTF_MOCK */
 void
 cn_subspill_get_kvset_meta(struct subspill *ss, struct kvset_meta *km);
@@ -5,7 +5,25 @@
 
 #include <hse/ikvdb/vcomp_params.h>
 #include <hse/util/compression_lz4.h>
+#include <hse/util/compression_zstd.h>
+#include <hse/util/event_counter.h>
+
+static_assert(COMPRESS_ZSTD_TAG == VCOMP_ALGO_ZSTD, "zstd tag must match its algorithm");
 
 const struct compress_ops *vcomp_compress_ops[VCOMP_ALGO_COUNT] = {
     &compress_lz4_ops,
+    &compress_zstd_ops,
 };
+
+merr_t
+vcomp_decompress(const void *src, uint src_len, void *dst, uint dst_cap, uint *dst_len)
+{
+    uint tag = *(const uint8_t *)src;
+
+    if (tag >= 0x10)
+        tag = VCOMP_ALGO_LZ4;
+    else if (ev(tag == VCOMP_ALGO_LZ4 || tag > VCOMP_ALGO_MAX))
+        return merr(EPROTO);
+
+    return vcomp_compress_ops[tag]->cop_decompress(src, src_len, dst, dst_cap, dst_len);
+}
@@ -12,6 +12,8 @@
 #include <hse/util/compiler.h>
 #include <hse/util/byteorder.h>
 
+#include <string.h>
+
 #include "omf.h"
 
 static HSE_ALWAYS_INLINE const struct wbt_lfe_omf *
@@ -93,4 +95,72 @@ wbt_ine_key(
     *klen = end - start;
 }
 
+/* Starting with wbt v7, internal nodes carry a key fingerprint array,
+ * 4-byte aligned, immediately after the ine array (including the right
+ * edge entry).  Each fingerprint is the first WBT_INE_FP_LEN bytes of
+ * the key suffix (zero padded), stored as is such that it compares as a
+ * big-endian integer.  Since fingerprints are monotonic in key order a
+ * search can narrow down the candidate range using only the dense array
+ * and then compare full keys only on fingerprint ties.
+ */
+#define WBT_INE_FP_LEN      (sizeof(uint32_t))
+
+static HSE_ALWAYS_INLINE size_t
+wbt_ine_fpv_off(uint pfx_len, uint nkeys)
+{
+    size_t off = sizeof(struct wbt_node_hdr_omf) + pfx_len + (nkeys + 1) * sizeof(struct wbt_ine_omf);
+
+    return (off + WBT_INE_FP_LEN - 1) & ~(WBT_INE_FP_LEN - 1);
+}
+
+static HSE_ALWAYS_INLINE const uint32_t *
+wbt_ine_fpv(const struct wbt_node_hdr_omf *node)
+{
+    return (void *)node + wbt_ine_fpv_off(omf_wbn_pfx_len(node), omf_wbn_num_keys(node));
+}
+
+/* Return the fingerprint of a key suffix in cpu byte order.
+ */
+static HSE_ALWAYS_INLINE uint32_t
+wbt_ine_fp(const void *sfx, uint sfx_len)
+{
+    uint32_t fp = 0;
+
+    if (HSE_LIKELY(sfx_len >= WBT_INE_FP_LEN)) {
+        memcpy(&fp, sfx, sizeof(fp));
+        return be32_to_cpu(fp);
+    }
+
+    memcpy(&fp, sfx, sfx_len);
+
+    return be32_to_cpu(fp);
+}
+
+/* Branch-free search of the fingerprint array.  Returns the index of the
+ * first fingerprint that is not less than (or, if %upper, greater than) %fp.
+ */
+static HSE_ALWAYS_INLINE uint
+wbt_ine_fp_search(const uint32_t *fpv, uint n, uint32_t fp, bool upper)
+{
+    const uint32_t *base = fpv;
+    uint32_t limit = fp + upper;
+
+    /* For upper bound search "v <= fp" is "v < fp + 1" unless fp + 1 wraps.
+     */
+    if (HSE_UNLIKELY(upper && fp == UINT32_MAX))
+        return n;
+
+    if (n == 0)
+        return 0;
+
+    while (n > 1) {
+        uint half = n / 2;
+
+        base = (be32_to_cpu(base[half]) < limit) ? base + half : base;
+        n -= half;
+    }
+
+    return (base - fpv) + (be32_to_cpu(*base) < limit);
+}
+
 #endif /* HSE_KVS_CN_WBT_INTERNAL_H */
@@ -25,6 +25,7 @@
 #include "kvs_mblk_desc.h"
 #include "kblock_reader.h"
 #include "kvset.h"
+#include "bcache.h"
 
 #define MTF_MOCK_IMPL_wbt_reader
 #include "wbt_reader.h"
@@ -116,31 +117,54 @@ wbti_get_page(struct wbti *self, u32 node_idx)
     self->node_idx = node_idx;
 }
 
+/* Get a wbt node from the block cache if possible, otherwise from the
+ * mapped mblock.  The node must be released via bcache_put(*entp).
+ */
+static HSE_ALWAYS_INLINE const void *
+wbtr_node_get(const void *base, const struct bcache_ref *bcr, size_t pg, struct bcache_ent **entp)
+{
+    const void *node;
+
+    *entp = NULL;
+
+    if (bcr) {
+        node = bcache_get(bcr, pg, BCACHE_INDEX, entp);
+        if (node)
+            return node;
+    }
+
+    return base + pg * PAGE_SIZE;
+}
+
 static int
 wbtr_seek_page(
     const void *base,
+    const struct bcache_ref *bcr,
     const struct wbt_desc *wbd,
     const void *kt_data,
     uint kt_len,
     uint lcp)
 {
     const struct wbt_node_hdr_omf *node;
+    struct bcache_ent        *ent;
     int                      j, cmp, node_num;
     uint                     cmplen;
     size_t                   pg;
 
     /* pull struct derefs out of the loop */
     uint first_page = wbd->wbd_first_page;
+    bool fp_search = wbd->wbd_version >= WBT_TREE_VERSION7;
 
     /* search from root */
     node_num = wbd->wbd_root;
 
     /* prefetch root node header */
-    __builtin_prefetch(base + (first_page + wbd->wbd_root) * PAGE_SIZE);
+    if (!bcr)
+        __builtin_prefetch(base + (first_page + wbd->wbd_root) * PAGE_SIZE);
 
     assert(0 <= node_num && node_num < wbd->wbd_n_pages);
     pg = first_page + node_num;
-    node = base + pg * PAGE_SIZE;
+    node = wbtr_node_get(base, bcr, pg, &ent);
 
     while (omf_wbn_magic(node) == WBT_INE_NODE_MAGIC) {
         const struct wbt_ine_omf *ine;
@@ -170,6 +194,22 @@ wbtr_seek_page(
             goto navigate;
         }
 
+        /* Narrow the search to the keys whose fingerprint matches
+         * that of the search key, all keys to the left are smaller
+         * and all keys to the right are larger than the search key.
+         */
+        if (fp_search) {
+            const uint32_t *fpv = wbt_ine_fpv(node);
+            uint32_t fp = wbt_ine_fp(kt_data + cmplen, kt_len - cmplen);
+            uint nkeys = last + 1;
+
+            first = wbt_ine_fp_search(fpv, nkeys, fp, false);
+            if (first == nkeys || be32_to_cpu(fpv[first]) != fp)
+                goto navigate;
+
+            last = wbt_ine_fp_search(fpv + first, nkeys - first, fp, true) + first - 1;
+        }
+
         /* prefetch first node in binary search */
         __builtin_prefetch(wbt_ine(node, (first + last) / 2));
 
@@ -202,10 +242,14 @@ wbtr_seek_page(
 
         assert(0 <= node_num && node_num < wbd->wbd_n_pages);
         pg = first_page + node_num;
-        node = base + pg * PAGE_SIZE;
+
+        bcache_put(ent);
+        node = wbtr_node_get(base, bcr, pg, &ent);
         __builtin_prefetch(node);
     }
 
+    bcache_put(ent);
+
     return node_num;
 }
 
@@ -288,7 +332,7 @@ wbti_seek_fwd(struct wbti *self, struct kvs_ktuple *kt)
     kt_data = kt->kt_data;
     kt_len = abs(kt->kt_len);
 
-    node_num = wbtr_seek_page(self->base, wbd, kt_data, kt_len, 0);
+    node_num = wbtr_seek_page(self->base, NULL, wbd, kt_data, kt_len, 0);
     wbti_get_page(self, node_num);
 
     assert(0 <= node_num && node_num < wbd->wbd_n_pages);
@@ -484,7 +528,7 @@ wbti_seek_rev(struct wbti *self, struct kvs_ktuple *kt)
     if (create)
         kt_len = HSE_KVS_KEY_LEN_MAX;
 
-    node_num = wbtr_seek_page(self->base, wbd, kt_data, kt_len, 0);
+    node_num = wbtr_seek_page(self->base, NULL, wbd, kt_data, kt_len, 0);
     dbg_nrepeat = 0;
 
 repeat:
@@ -747,6 +791,7 @@ wbti_reset(
 merr_t
 wbtr_read_vref(
     const void              *base,
+    const struct bcache_ref *bcr,
     const struct wbt_desc   *wbd,
     const struct kvs_ktuple *kt,
     uint64_t                 seq,
@@ -755,6 +800,7 @@ wbtr_read_vref(
     struct kvs_vtuple_ref   *vref)
 {
     const struct wbt_node_hdr_omf *node;
+    struct bcache_ent       *ent = NULL;
     int                      j, cmp, node_num;
     int                      first, last;
     size_t                   pg;
@@ -773,11 +819,11 @@ wbtr_read_vref(
     if (HSE_UNLIKELY(!wbd->wbd_n_pages))
         goto done;
 
-    node_num = wbtr_seek_page(base, wbd, kt_data, kt_len, 0);
+    node_num = wbtr_seek_page(base, bcr, wbd, kt_data, kt_len, 0);
 
     assert(0 <= node_num && node_num < wbd->wbd_n_pages);
     pg = wbd->wbd_first_page + node_num;
-    node = base + pg * PAGE_SIZE;
+    node = wbtr_node_get(base, bcr, pg, &ent);
 
     /* at leaf */
     assert(omf_wbn_magic(node) == WBT_LFE_NODE_MAGIC);
@@ -822,6 +868,12 @@ wbtr_read_vref(
 
             off = wbt_lfe_kmd(node, lfe);
             assert(off < wbd->wbd_kmd_pgc * PAGE_SIZE);
+
+            /* Key metadata is always read from the mapped mblock.
+             */
+            bcache_put(ent);
+            ent = NULL;
+
             nvals = kmd_count(kmd, &off);
             assert(nvals > 0);
             while (nvals--) {
@@ -843,6 +895,8 @@ wbtr_read_vref(
         }
     }
 done:
+    bcache_put(ent);
+
     /* Not finding the key is *not* an error. */
     *lookup_res = NOT_FOUND;
     return 0;
@@ -923,7 +977,8 @@ wbtr_hdr_valid(const struct wbt_hdr_omf *omf)
     const uint32_t version = omf_wbt_version(omf);
     const uint32_t magic = omf_wbt_magic(omf);
 
-    return HSE_LIKELY(version == WBT_TREE_VERSION && magic == WBT_TREE_MAGIC);
+    return HSE_LIKELY(
+        (version == WBT_TREE_VERSION || version == WBT_TREE_VERSION6) && magic == WBT_TREE_MAGIC);
 }
 
 merr_t
@@ -935,7 +990,8 @@ wbtr_read_desc(const struct wbt_hdr_omf *wbt_hdr, struct wbt_desc *desc)
     desc->wbd_version = omf_wbt_version(wbt_hdr);
 
     switch (desc->wbd_version) {
-    case WBT_TREE_VERSION:
+    case WBT_TREE_VERSION6:
+    case WBT_TREE_VERSION7:
         desc->wbd_root = omf_wbt_root(wbt_hdr);
         desc->wbd_leaf = omf_wbt_leaf(wbt_hdr);
         desc->wbd_leaf_cnt = omf_wbt_leaf_cnt(wbt_hdr);
@@ -11,6 +11,7 @@
 
 #include <hse/ikvdb/tuple.h>
 
+struct bcache_ref;
 struct kvs_mblk_desc;
 struct mpool;
 struct wbt_hdr_omf;
@@ -62,6 +63,7 @@ struct wbti {
 /**
  * wbtr_read_vref() - Read the metadata data for the value associated with key
  * @base: base address of the block
+ * @bcr:  block cache reference for wbt nodes (may be NULL)
  * @wbd: wbtree descriptor
  * @kt: key to search for
  * @lookup_res: (output) one of NOT_FOUND, FOUND_VAL,
@@ -72,6 +74,7 @@ struct wbti {
 merr_t
 wbtr_read_vref(
     const void *base,
+    const struct bcache_ref *bcr,
     const struct wbt_desc *wbd,
     const struct kvs_ktuple *kt,
     u64 seq,
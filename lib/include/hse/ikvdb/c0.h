@@ -27,6 +27,7 @@ struct cn;
 struct query_ctx;
 struct kvdb_ctxn;
 struct kc_filter;
+struct rtomb_vec;
 
 struct mpool;
 
@@ -123,6 +124,26 @@ c0_get(
     enum key_lookup_res *    res,
     struct kvs_buf *         vbuf);
 
+/**
+ * c0_get_multi() - retrieve the values associated with a batch of keys,
+ *                  no newer than seqno
+ * @self:      Instance of struct c0 from which to retrieve
+ * @count:     Number of keys in @ktv
+ * @ktv:       Vector of keys to retrieve
+ * @seqno:     Seqno to use for get
+ * @resv:      Vector of lookup results
+ * @vbufv:     Vector of callers buffers
+ */
+merr_t
+c0_get_multi(
+    struct c0 *              self,
+    uint                     count,
+    const struct kvs_ktuple *ktv,
+    u64                      view_seqno,
+    uintptr_t                seqnoref,
+    enum key_lookup_res *    resv,
+    struct kvs_buf *         vbufv);
+
 /**
  * c0_del() - delete any value associated with the given key
  * @self:      Instance of struct c0 from which to delete
@@ -158,6 +179,31 @@ c0_pfx_probe(
 merr_t
 c0_prefix_del(struct c0 *self, struct kvs_ktuple *key, uintptr_t seqnoref);
 
+/**
+ * c0_range_del() - delete all keys in the range [start, end)
+ * @self:      Instance of struct c0 from which to delete
+ * @start:     First key of the range (inclusive)
+ * @end:       End of the range (exclusive)
+ * @seqnoref:  seqnoref for range delete
+ */
+/* MTF_MOCK */
+merr_t
+c0_range_del(
+    struct c0               *self,
+    struct kvs_ktuple       *start,
+    const struct kvs_ktuple *end,
+    uintptr_t                seqnoref);
+
+/**
+ * c0_rtombs_get() - collect the range tombstones visible in a view
+ * @self:      Instance of struct c0
+ * @view_seq:  View sequence number
+ * @rv:        (output) vector to which copies of the rtombs are appended
+ */
+/* MTF_MOCK */
+merr_t
+c0_rtombs_get(struct c0 *self, u64 view_seq, struct rtomb_vec *rv);
+
 /**
  * c0_sync() - force ingest of existing c0 data and waits until ingest complete
  * @self:      Instance of struct c0 to flush
@@ -24,6 +24,7 @@ struct c0_kvmultiset_cursor;
 struct c0sk;
 struct c0_kvmultiset_impl;
 struct kvdb_callback;
+struct rtomb;
 
 /**
  * c0_kvmultiset - container for struct c0_kvset's
@@ -133,6 +134,27 @@ c0kvms_gen_set(struct c0_kvmultiset *mset, uint64_t gen);
 struct c0_kvset *
 c0kvms_ptomb_c0kvset_get(struct c0_kvmultiset *handle);
 
+/**
+ * c0kvms_rtomb_add() - add a range tombstone to the kvms
+ * @handle: kvms
+ * @rt:     rtomb allocated by rtomb_alloc(), freed when the kvms is destroyed
+ *
+ * If rt_seqno is zero the rtomb is assigned the next kvdb seqno.
+ *
+ * Return: The seqno of the rtomb
+ */
+uint64_t
+c0kvms_rtomb_add(struct c0_kvmultiset *handle, struct rtomb *rt);
+
+/**
+ * c0kvms_rtomb_first() - return the newest range tombstone in the kvms
+ *
+ * Rtombs are immutable once added, the list may be walked via rt_next
+ * for as long as the caller holds a reference on the kvms.
+ */
+struct rtomb *
+c0kvms_rtomb_first(struct c0_kvmultiset *handle);
+
 size_t
 c0kvms_size(struct c0_kvmultiset *handle);
 
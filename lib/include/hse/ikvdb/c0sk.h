@@ -32,6 +32,7 @@ struct throttle_sensor;
 struct query_ctx;
 struct kvdb_ctxn_set;
 struct kvdb_callback;
+struct rtomb_vec;
 
 merr_t
 c0sk_init(void);
@@ -186,6 +187,32 @@ c0sk_get(
     enum key_lookup_res *    res,
     struct kvs_buf *         vbuf);
 
+/**
+ * c0sk_get_multi() - retrieve the values associated with a batch of keys
+ * @self:      Instance of struct c0sk from which to retrieve
+ * @skidx:     Structured key index
+ * @pfx_len:   Prefix length to use for this get
+ * @count:     Number of keys in @ktv
+ * @ktv:       Vector of keys to retrieve
+ * @view_seq:  View sequence number
+ * @seqref:    Caller's sequence number reference (may be 0)
+ * @resv:      Vector of lookup results
+ * @vbufv:     Vector of callers buffers
+ *
+ * All keys are probed within a single RCU read-side critical section.
+ */
+merr_t
+c0sk_get_multi(
+    struct c0sk *            self,
+    u16                      skidx,
+    u32                      pfx_len,
+    uint                     count,
+    const struct kvs_ktuple *ktv,
+    u64                      view_seq,
+    uintptr_t                seqref,
+    enum key_lookup_res *    resv,
+    struct kvs_buf *         vbufv);
+
 /**
  * c0sk_del() - delete any value associated with the given key
  * @self:       Instance of struct c0sk from which to delete
@@ -226,6 +253,38 @@ c0sk_pfx_probe(
 merr_t
 c0sk_prefix_del(struct c0sk *self, u16 skidx, struct kvs_ktuple *key, uintptr_t seqnoref);
 
+/**
+ * c0sk_range_del() - delete all keys in the range [start, end)
+ * @self:      Instance of struct c0sk from which to delete
+ * @skidx:     Structured key index
+ * @start:     First key of the range (inclusive)
+ * @end:       End of the range (exclusive)
+ * @seqnoref:  seqnoref for range delete (must not be a txn)
+ *
+ * On success the seqno of the range tombstone is returned in start->kt_seqno.
+ */
+/* MTF_MOCK */
+merr_t
+c0sk_range_del(
+    struct c0sk             *self,
+    u16                      skidx,
+    struct kvs_ktuple       *start,
+    const struct kvs_ktuple *end,
+    uintptr_t                seqnoref);
+
+/**
+ * c0sk_rtombs_get() - collect the range tombstones of a kvs visible in a view
+ * @self:      Instance of struct c0sk
+ * @skidx:     Structured key index
+ * @view_seq:  View sequence number
+ * @rv:        (output) vector to which copies of the rtombs are appended
+ *
+ * The caller must free the copies (see rtomb_vec_fini()).
+ */
+/* MTF_MOCK */
+merr_t
+c0sk_rtombs_get(struct c0sk *self, u16 skidx, u64 view_seq, struct rtomb_vec *rv);
+
 /**
  * c0sk_rparams() - Get a ptr to c0sk kvdb rparams
  * @self:       Instance of struct c0sk
@@ -91,6 +91,14 @@ cn_get_rp(const struct cn *cn);
 struct mpool *
 cn_get_mpool(const struct cn *cn);
 
+/* MTF_MOCK */
+void
+cn_set_vcomp(struct cn *cn, struct kvs_vcomp *vcomp);
+
+/* MTF_MOCK */
+struct kvs_vcomp *
+cn_get_vcomp(const struct cn *cn);
+
 /* MTF_MOCK */
 struct mclass_policy *
 cn_get_mclass_policy(const struct cn *cn);
@@ -112,6 +120,40 @@ cn_get(
     enum key_lookup_res *res,
     struct kvs_buf *     vbuf);
 
+/*
+ * Search cn for the keys in %ktv whose result in %resv is NOT_FOUND,
+ * leaving all other entries untouched.
+ */
+merr_t
+cn_get_multi(
+    struct cn *          cn,
+    uint                 count,
+    struct kvs_ktuple *  ktv,
+    u64                  seq,
+    enum key_lookup_res *resv,
+    struct kvs_buf *     vbufv);
+
+/*
+ * Drop the cached lookup result (if any) of key %kt, or (if %kt is NULL)
+ * of all keys, from the cn result cache (see cn_rcache_size_mb).
+ */
+/* MTF_MOCK */
+void
+cn_rcache_invalidate(struct cn *cn, const struct kvs_ktuple *kt);
+
+/*
+ * Note that range tombstones have been written to the kvs.  The flag is
+ * also set by cn_open() if any kvset of the kvs carries rtombs, and is
+ * never cleared while the kvs is open.
+ */
+/* MTF_MOCK */
+void
+cn_rtombs_set(struct cn *cn);
+
+/* MTF_MOCK */
+bool
+cn_has_rtombs(struct cn *cn);
+
 struct query_ctx;
 
 merr_t
@@ -124,6 +166,22 @@ cn_pfx_probe(
     struct kvs_buf *     kbuf,
     struct kvs_buf *     vbuf);
 
+/**
+ * cn_range_split() - Split a key range at cn leaf node boundaries
+ *
+ * See cn_tree_range_split().
+ */
+uint
+cn_range_split(
+    struct cn  *cn,
+    const void *min,
+    uint        minlen,
+    const void *max,
+    uint        maxlen,
+    uint        splitc_max,
+    void       *keybufv,
+    uint       *keylenv);
+
 /**
  * cn_ingestv() - A vectored version of cn_ingest
  * @cn:
@@ -177,6 +235,10 @@ cn_get_io_wq(struct cn *cn);
 struct workqueue_struct *
 cn_get_maint_wq(struct cn *cn);
 
+/* MTF_MOCK */
+struct workqueue_struct *
+cn_get_ra_wq(struct cn *cn);
+
 /* MTF_MOCK */
 struct csched *
 cn_get_sched(struct cn *cn);
@@ -193,6 +255,10 @@ cn_get_perfc(struct cn *cn, enum cn_action action);
 struct perfc_set *
 cn_pc_capped_get(struct cn *cn);
 
+/* MTF_MOCK */
+struct perfc_set *
+cn_pc_bcache_get(struct cn *cn);
+
 /* MTF_MOCK */
 struct kvs_cparams *
 cn_get_cparams(const struct cn *handle);
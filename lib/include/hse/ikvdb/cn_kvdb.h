@@ -12,17 +12,28 @@
 
 /* MTF_MOCK_DECL(cn_kvdb) */
 
+struct bcache;
+
 /**
  * Public portion of per kvdb cN object
  */
 struct cn_kvdb {
     struct workqueue_struct *cn_maint_wq;
     struct workqueue_struct *cn_io_wq;
+    struct workqueue_struct *cn_ra_wq;
+    struct workqueue_struct *cn_spill_wq;
+    uint                     cn_spill_threads;
+    struct bcache           *cn_bcache;
 };
 
 /* MTF_MOCK */
 merr_t
-cn_kvdb_create(uint cn_maint_threads, uint cn_io_threads, struct cn_kvdb **h);
+cn_kvdb_create(
+    uint             cn_maint_threads,
+    uint             cn_io_threads,
+    uint             cn_spill_threads,
+    size_t           bcache_sz,
+    struct cn_kvdb **h);
 
 /* MTF_MOCK */
 void
@@ -63,6 +63,9 @@ enum cn_rule {
     CN_RULE_LSPLIT,         /* left node kvset after a split */
     CN_RULE_RSPLIT,         /* right ndoe kvset after a split */
     CN_RULE_JOIN,           /* prev node is very small */
+    CN_RULE_VGARBAGE,       /* leaf vblock garbage (k-compact rewriting dirty vblocks) */
+    CN_RULE_HOT,            /* leaf node accessed often (move to faster media) */
+    CN_RULE_COLD,           /* leaf node no longer hot (move back to leaf media) */
     CN_RULE_MAX,
 };
 
@@ -114,6 +117,12 @@ cn_rule2str(enum cn_rule rule)
         return "right";
     case CN_RULE_JOIN:
         return "join";
+    case CN_RULE_VGARBAGE:
+        return "vgarb";
+    case CN_RULE_HOT:
+        return "hot";
+    case CN_RULE_COLD:
+        return "cold";
     case CN_RULE_MAX:
         return "max";
     }
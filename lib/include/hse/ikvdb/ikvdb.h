@@ -41,6 +41,7 @@ struct cndb;
 struct kvdb_diag_kvs_list;
 struct kvs;
 struct ikvdb_kvs_hdl;
+struct slowop_log;
 enum hse_mclass;
 
 struct hse_kvdb_txn {
@@ -269,6 +270,15 @@ ikvdb_config(struct ikvdb *kvdb);
 const struct kvdb_rparams * HSE_RETURNS_NONNULL
 ikvdb_rparams(struct ikvdb *kvdb);
 
+/** @brief Get the KVDB slow operation log.
+ *
+ * @param kvdb: KVDB handle.
+ *
+ * @returns Slow operation log, NULL if the KVDB was opened for diagnostics.
+ */
+struct slowop_log *
+ikvdb_slowop_log(struct ikvdb *kvdb);
+
 /** @brief Get KVDB cparams.
  *
  * There is no current way to access a pre-existing kvdb_cparams struct. In
@@ -436,6 +446,20 @@ ikvdb_kvs_get(
     enum key_lookup_res *res,
     struct kvs_buf *     vbuf);
 
+/**
+ * ikvdb_kvs_get_multi() - search for a batch of keys within the KVS. All keys
+ * are resolved against the same view.
+ */
+merr_t
+ikvdb_kvs_get_multi(
+    struct hse_kvs *     kvs,
+    unsigned int         flags,
+    struct hse_kvdb_txn *txn,
+    uint                 count,
+    struct kvs_ktuple *  ktv,
+    enum key_lookup_res *resv,
+    struct kvs_buf *     vbufv);
+
 /**
  * ikvdb_kvs_del() - remove the supplied key and associated value from the KVS
  * indexed by opspec->kop_index.
@@ -472,6 +496,19 @@ ikvdb_kvs_prefix_delete(
     struct hse_kvdb_txn *txn,
     struct kvs_ktuple *  kt);
 
+/**
+ * ikvdb_kvs_range_delete() - remove all key/value pairs in the range [start, end)
+ * from the given KVS.  Transactions are not supported.
+ */
+/* MTF_MOCK */
+merr_t
+ikvdb_kvs_range_delete(
+    struct hse_kvs          *kvs,
+    unsigned int             flags,
+    struct hse_kvdb_txn     *txn,
+    struct kvs_ktuple       *start,
+    const struct kvs_ktuple *end);
+
 merr_t
 ikvdb_kvs_param_get(
     struct hse_kvs *kvs,
@@ -553,6 +590,24 @@ ikvdb_kvs_cursor_create(
     size_t                  pfx_len,
     struct hse_kvs_cursor **cursor);
 
+/**
+ * ikvdb_kvs_cursor_create_split() - return cursors that partition a key range
+ * at cn leaf node boundaries.  All the cursors share the same view, and each
+ * is positioned at the start of its subrange.  On entry *cursorc is the max
+ * number of cursors to create, on return it is the number created.
+ */
+merr_t
+ikvdb_kvs_cursor_create_split(
+    struct hse_kvs *        kvs,
+    unsigned int            flags,
+    struct hse_kvdb_txn *   txn,
+    const void *            min,
+    size_t                  min_len,
+    const void *            max,
+    size_t                  max_len,
+    unsigned int *          cursorc,
+    struct hse_kvs_cursor **cursorv);
+
 /**
  * ikvdb_kvs_cursor_update() - incorporate updates since cursor created
  */
@@ -687,6 +742,15 @@ ikvdb_wal_replay_prefix_del(
     u64                   seqno,
     struct kvs_ktuple    *kt);
 
+merr_t
+ikvdb_wal_replay_range_del(
+    struct ikvdb         *ikvdb,
+    struct ikvdb_kvs_hdl *ikvsh,
+    u64                   cnid,
+    u64                   seqno,
+    struct kvs_ktuple    *kt,
+    struct kvs_vtuple    *vt);
+
 merr_t
 ikvdb_wal_replay_sync(struct ikvdb *handle, const unsigned int flags);
 
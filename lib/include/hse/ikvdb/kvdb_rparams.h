@@ -55,6 +55,7 @@ struct kvdb_rparams {
     uint32_t c0_ingest_width;
 
     uint64_t txn_timeout;
+    uint64_t slowop_thresh_us;
 
     uint64_t csched_debug_mask;
     uint64_t csched_qthreads;
@@ -64,6 +65,10 @@ struct kvdb_rparams {
     uint8_t  csched_hi_th_pct;
     uint8_t  csched_leaf_pct;
     uint8_t  csched_gc_pct;
+    uint8_t  csched_vgc_pct;
+    uint32_t csched_hot_rate;
+    uint8_t  csched_hot_staging_pct;
+    uint8_t  csched_hot_pmem_pct;
     uint16_t csched_lscat_hwm;
     uint8_t  csched_lscat_runlen_max;
     uint64_t csched_rspill_params;
@@ -74,6 +79,7 @@ struct kvdb_rparams {
     uint32_t dur_bufsz_mb;
     uint32_t dur_intvl_ms;
     uint32_t dur_size_bytes;
+    uint32_t dur_replay_threads;
     bool     dur_enable;
     bool     dur_buf_managed;
     bool     dur_replay_force;
@@ -96,6 +102,8 @@ struct kvdb_rparams {
     uint32_t c0_ingest_threads;
     uint16_t cn_maint_threads;
     uint16_t cn_io_threads;
+    uint16_t cn_spill_threads;
+    uint32_t cn_bcache_size_mb;
     uint32_t cndb_compact_hwm_pct;
 
     uint32_t keylock_tables;
@@ -37,6 +37,7 @@ struct cn;
 struct cn_kvdb;
 struct wal;
 struct viewset;
+struct kvs_vcomp;
 
 struct kc_filter {
     const void *kcf_maxkey;
@@ -65,6 +66,7 @@ struct ikvs {
     struct cn *      ikv_cn;
     struct lc *      ikv_lc;
     struct wal *     ikv_wal;
+    struct kvs_vcomp *ikv_vcomp;
     struct perfc_set ikv_pkvsl_pc; /* Public kvs interfaces Lat. */
     struct perfc_set ikv_cc_pc;
     struct perfc_set ikv_cd_pc;
@@ -183,6 +185,26 @@ kvs_get(
     enum key_lookup_res *res,
     struct kvs_buf *     vbuf);
 
+/**
+ * kvs_get_multi() - get a batch of keys from the same view
+ * @ikvs:  kvs handle
+ * @txn:   transaction handle (may be NULL)
+ * @count: number of keys in %ktv
+ * @ktv:   vector of keys
+ * @seqno: view seqno (ignored if %txn is not NULL)
+ * @resv:  (output) vector of lookup results
+ * @vbufv: (output) vector of value buffers
+ */
+merr_t
+kvs_get_multi(
+    struct ikvs *        ikvs,
+    struct hse_kvdb_txn *txn,
+    uint                 count,
+    struct kvs_ktuple *  ktv,
+    u64                  seqno,
+    enum key_lookup_res *resv,
+    struct kvs_buf *     vbufv);
+
 merr_t
 kvs_del(struct ikvs *ikvs, struct hse_kvdb_txn *txn, struct kvs_ktuple *key, u64 seqno);
 
@@ -199,6 +221,13 @@ kvs_pfx_probe(
 merr_t
 kvs_prefix_del(struct ikvs *ikvs, struct hse_kvdb_txn *txn, struct kvs_ktuple *key, u64 seqno);
 
+merr_t
+kvs_range_del(
+    struct ikvs             *ikvs,
+    struct kvs_ktuple       *start,
+    const struct kvs_ktuple *end,
+    uintptr_t                seqnoref);
+
 void
 kvs_maint_task(struct ikvs *ikvs, u64 now);
 
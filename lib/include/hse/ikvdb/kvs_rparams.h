@@ -15,6 +15,19 @@
 #include <hse/ikvdb/mclass_policy.h>
 #include <hse/ikvdb/vcomp_params.h>
 
+#define CN_BLOOM_TYPE_PARAM_BLOCKED "blocked"
+#define CN_BLOOM_TYPE_PARAM_FUSE    "fuse"
+
+/* Type of the per-kblock filter built by new kvsets.
+ */
+enum cn_bloom_type {
+    CN_BLOOM_TYPE_BLOCKED,
+    CN_BLOOM_TYPE_FUSE,
+};
+
+#define CN_BLOOM_TYPE_MIN CN_BLOOM_TYPE_BLOCKED
+#define CN_BLOOM_TYPE_MAX CN_BLOOM_TYPE_FUSE
+
 /*
  * Steps to add a new KVS parameter:
  * 1. Add a new struct element to struct kvs_params.
@@ -59,12 +72,21 @@ struct kvs_rparams {
     uint8_t  cn_mcache_kra_params;
     uint8_t  cn_mcache_vra_params;
     uint8_t  cn_mcache_wbt;
+    bool     cn_mcache_lazy;
     uint32_t cn_mcache_vmax;
+    uint32_t cn_get_aio_depth;
+    uint32_t cn_rcache_size_mb;
 
     bool     cn_bloom_create;
     bool     cn_bloom_preload;
     uint64_t cn_bloom_prob;
     uint64_t cn_bloom_capped;
+    uint64_t cn_bloom_prob_root;
+    uint64_t cn_bloom_prob_leaf;
+    bool     cn_bloom_auto;
+    enum cn_bloom_type cn_bloom_type;
+    bool     cn_bloom_pfx;
+    uint32_t cn_bloom_pfx_len;
 
     uint64_t cn_kcachesz;
 
@@ -72,7 +94,13 @@ struct kvs_rparams {
 
     struct {
         struct {
-            enum vcomp_default dflt;
+            enum vcomp_default   dflt;
+            enum vcomp_algorithm algo;
+            int32_t              level;
+            uint32_t             dict_size;
+            enum vcomp_default   compact;
+            int32_t              compact_level;
+            bool                 deferred;
         } compression;
     } value;
 
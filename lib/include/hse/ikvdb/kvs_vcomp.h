@@ -0,0 +1,131 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_KVS_VCOMP_H
+#define HSE_KVS_VCOMP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <hse/error/merr.h>
+#include <hse/util/inttypes.h>
+
+/* Per-kvs value compression context.  It binds the kvs's choice of algorithm
+ * and level and, for zstd with a nonzero value.compression.dict_size, the
+ * kvs's trained dictionary.
+ *
+ * A dictionary is trained once from values sampled from the put path, after
+ * which it is persisted to an mpool file in the capacity media class and
+ * registered with the zstd decompressor.  Values compressed before the
+ * dictionary became available remain readable since the dictionary ID is
+ * recorded in each zstd frame.
+ */
+
+struct kvs_rparams;
+struct kvs_vcomp;
+struct mpool;
+struct workqueue_struct;
+
+/**
+ * kvs_vcomp_open() - create a kvs's value compression context
+ * @mp:        mpool
+ * @cnid:      cnid of the kvs
+ * @rp:        kvs rparams
+ * @wq:        workqueue on which to train the dictionary
+ * @vcomp_out: compression context (output)
+ *
+ * Loads and registers the kvs's dictionary if one was previously trained.
+ */
+merr_t
+kvs_vcomp_open(
+    struct mpool             *mp,
+    uint64_t                  cnid,
+    const struct kvs_rparams *rp,
+    struct workqueue_struct  *wq,
+    struct kvs_vcomp        **vcomp_out);
+
+/**
+ * kvs_vcomp_close() - destroy a kvs's value compression context
+ * @vc: compression context (may be NULL)
+ *
+ * Waits for an in-progress dictionary training to complete.
+ */
+void
+kvs_vcomp_close(struct kvs_vcomp *vc);
+
+/**
+ * kvs_vcomp_compress() - compress a value
+ * @vc:           compression context
+ * @src:          value
+ * @src_len:      value length
+ * @dst:          output buffer
+ * @dst_capacity: output buffer size
+ * @dst_len:      compressed length (output)
+ *
+ * While the kvs is gathering samples for dictionary training, this also
+ * samples the value.
+ */
+merr_t
+kvs_vcomp_compress(
+    struct kvs_vcomp *vc,
+    const void       *src,
+    uint              src_len,
+    void             *dst,
+    uint              dst_capacity,
+    uint             *dst_len);
+
+/**
+ * kvs_vcomp_compress_bound() - output buffer size required to compress
+ * @vc:  compression context
+ * @len: uncompressed value length
+ */
+uint
+kvs_vcomp_compress_bound(const struct kvs_vcomp *vc, uint len);
+
+/**
+ * kvs_vcomp_recompress_enabled() - check if compaction should recompress values
+ * @vc: compression context (may be NULL)
+ */
+bool
+kvs_vcomp_recompress_enabled(const struct kvs_vcomp *vc);
+
+/**
+ * kvs_vcomp_recompress() - compress a value for colder storage
+ * @vc:           compression context
+ * @src:          uncompressed value
+ * @src_len:      value length
+ * @dst:          output buffer
+ * @dst_capacity: output buffer size (see kvs_vcomp_recompress_bound())
+ * @dst_len:      compressed length (output)
+ *
+ * Compresses with zstd at value.compression.compact_level, using the kvs's
+ * dictionary if it has one.
+ */
+merr_t
+kvs_vcomp_recompress(
+    struct kvs_vcomp *vc,
+    const void       *src,
+    uint              src_len,
+    void             *dst,
+    uint              dst_capacity,
+    uint             *dst_len);
+
+/**
+ * kvs_vcomp_recompress_bound() - output buffer size required to recompress
+ * @vc:  compression context
+ * @len: uncompressed value length
+ */
+uint
+kvs_vcomp_recompress_bound(const struct kvs_vcomp *vc, uint len);
+
+/**
+ * kvs_vcomp_drop() - remove a dropped kvs's persisted dictionary
+ * @mp:   mpool
+ * @cnid: cnid of the dropped kvs
+ */
+void
+kvs_vcomp_drop(struct mpool *mp, uint64_t cnid);
+
+#endif
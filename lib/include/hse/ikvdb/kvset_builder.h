@@ -20,6 +20,7 @@ struct cn;
 struct kvset_builder;
 struct kvs_rparams;
 struct perfc_set;
+struct rtomb;
 struct cn_merge_stats;
 struct vgmap;
 
@@ -100,6 +101,30 @@ kvset_builder_add_vref(
 merr_t
 kvset_builder_add_nonval(struct kvset_builder *self, u64 seq, enum kmd_vtype vtype);
 
+/**
+ * kvset_builder_add_rtomb() - add a range tombstone to the kvset
+ * @builder: kvset builder object
+ * @rt:      range tombstone (copied)
+ *
+ * Range tombstones may be added at any time before the mblocks are
+ * retrieved.  A kvset may consist of only range tombstones.
+ */
+/* MTF_MOCK */
+merr_t
+kvset_builder_add_rtomb(struct kvset_builder *builder, const struct rtomb *rt);
+
+/**
+ * kvset_builder_adopt_vblocks() - use vblocks of existing kvsets (k-compaction)
+ * @self:        kvset builder object
+ * @num_vblocks: number of vblocks in @vblock_ids
+ * @vblock_ids:  vblock IDs (ownership of the vector passes to the builder)
+ * @vtotal:      sum of the lengths of the adopted vblocks
+ * @vgmap:       vgroup map of the adopted vblocks (ownership passes to the builder)
+ *
+ * Must be called before any values are added.  Values subsequently added via
+ * kvset_builder_add_val() are written to new vblocks that follow the adopted
+ * vblocks in the output kvset.
+ */
 /* MTF_MOCK */
 void
 kvset_builder_adopt_vblocks(
@@ -121,6 +146,18 @@ kvset_mblocks_destroy(struct kvset_mblocks *kvset);
 merr_t
 kvset_builder_set_agegroup(struct kvset_builder *self, enum hse_mclass_policy_age age);
 
+/**
+ * kvset_builder_set_bloom_prob() - set the bloom false-positive target
+ * @self: kvset builder
+ * @prob: false-positive probability in parts per million (see cn_bloom_prob)
+ *
+ * Overrides the target chosen by kvset_builder_set_agegroup(), hence must
+ * be called after it and before any keys are added.
+ */
+/* MTF_MOCK */
+void
+kvset_builder_set_bloom_prob(struct kvset_builder *self, uint64_t prob);
+
 /* MTF_MOCK */
 void
 kvset_builder_set_merge_stats(struct kvset_builder *self, struct cn_merge_stats *stats);
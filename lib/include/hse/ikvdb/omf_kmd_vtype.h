@@ -16,7 +16,7 @@ enum kmd_vtype {
     VTYPE_TOMB = 2,    // tombstone
     VTYPE_PTOMB = 3,   // prefix tombstone
     VTYPE_IVAL = 4,    // immediate value, uncompressed, stored in a kblock
-    VTYPE_CVAL = 5,    // an LZ4 compressed value stored in a vblock
+    VTYPE_CVAL = 5,    // a compressed value stored in a vblock (see vcomp_decompress)
 };
 
 #define NUM_KMD_VTYPES 6
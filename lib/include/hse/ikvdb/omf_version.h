@@ -11,6 +11,11 @@ enum {
     GLOBAL_OMF_VERSION2 = 2,
     GLOBAL_OMF_VERSION3 = 3,
     GLOBAL_OMF_VERSION4 = 4,
+    GLOBAL_OMF_VERSION5 = 5,
+    GLOBAL_OMF_VERSION6 = 6,
+    GLOBAL_OMF_VERSION7 = 7,
+    GLOBAL_OMF_VERSION8 = 8,
+    GLOBAL_OMF_VERSION9 = 9,
 };
 
 enum {
@@ -18,7 +23,9 @@ enum {
 };
 
 enum {
-    HBLOCK_HDR_VERSION1 = 1
+    HBLOCK_HDR_VERSION1 = 1,
+    HBLOCK_HDR_VERSION2 = 2,
+    HBLOCK_HDR_VERSION3 = 3,
 };
 
 enum {
@@ -27,6 +34,7 @@ enum {
 
 enum {
     KBLOCK_HDR_VERSION6 = 6,
+    KBLOCK_HDR_VERSION7 = 7,
 };
 
 enum {
@@ -35,10 +43,12 @@ enum {
 
 enum {
     BLOOM_OMF_VERSION5 = 5,
+    BLOOM_OMF_VERSION6 = 6,
 };
 
 enum {
     WBT_TREE_VERSION6 = 6,
+    WBT_TREE_VERSION7 = 7,
 };
 
 enum {
@@ -66,19 +76,19 @@ enum {
     KVDB_META_VERSION2 = 2,
 };
 
-#define GLOBAL_OMF_VERSION     GLOBAL_OMF_VERSION4
+#define GLOBAL_OMF_VERSION     GLOBAL_OMF_VERSION9
 
 /* In the event one of the following versions in incremented, increment the
  * global OMF version.
  */
 
 #define CNDB_VERSION           CNDB_VERSION1
-#define HBLOCK_HDR_VERSION     HBLOCK_HDR_VERSION1
+#define HBLOCK_HDR_VERSION     HBLOCK_HDR_VERSION3
 #define VGROUP_MAP_VERSION     VGROUP_MAP_VERSION1
-#define KBLOCK_HDR_VERSION     KBLOCK_HDR_VERSION6
+#define KBLOCK_HDR_VERSION     KBLOCK_HDR_VERSION7
 #define VBLOCK_FOOTER_VERSION  VBLOCK_FOOTER_VERSION1
-#define BLOOM_OMF_VERSION      BLOOM_OMF_VERSION5
-#define WBT_TREE_VERSION       WBT_TREE_VERSION6
+#define BLOOM_OMF_VERSION      BLOOM_OMF_VERSION6
+#define WBT_TREE_VERSION       WBT_TREE_VERSION7
 #define CN_TSTATE_VERSION      CN_TSTATE_VERSION2
 #define MBLOCK_METAHDR_VERSION MBLOCK_METAHDR_VERSION2
 #define MDC_LOGHDR_VERSION     MDC_LOGHDR_VERSION2
@@ -6,17 +6,26 @@
 #ifndef HSE_KVS_QCTX_H
 #define HSE_KVS_QCTX_H
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 #include <hse/error/merr.h>
+
+struct rtomb_vec;
+
 /**
  * struct query_ctx - context for special queries (pfx probe)
  * @tomb_map: map for tombstones
+ * @rtombs:   range tombstones of the kvs (NULL if it has none)
  * @pos:      current position in the memory region backing tomb elems
  * @seen:     number of unique keys seen
  */
 struct query_ctx {
-    int            pos;
-    int            seen;
-    struct map    *tomb_map;
+    int               pos;
+    int               seen;
+    struct map       *tomb_map;
+    struct rtomb_vec *rtombs;
 };
 
 merr_t
@@ -25,4 +34,20 @@ qctx_tomb_insert(struct query_ctx *qctx, const void *key, size_t klen);
 bool
 qctx_tomb_seen(struct query_ctx *qctx, const void *key, size_t klen);
 
+/**
+ * qctx_rtomb_covers() - check whether a range tombstone hides a key
+ * @qctx: query context
+ * @key:  key
+ * @klen: key length
+ * @seq:  seqno of the key's value
+ * @view: view seqno of the query
+ */
+bool
+qctx_rtomb_covers(
+    const struct query_ctx *qctx,
+    const void             *key,
+    size_t                  klen,
+    uint64_t                seq,
+    uint64_t                view);
+
 #endif /* HSE_KVS_QCTX_H */
@@ -0,0 +1,156 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_KVS_RTOMB_H
+#define HSE_KVS_RTOMB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <hse/error/merr.h>
+#include <hse/util/compiler.h>
+
+/* A range tombstone (rtomb) deletes all keys in [start, end) that were
+ * written before it, i.e., every value whose seqno is less than the
+ * rtomb's seqno is hidden from views that can see the rtomb.
+ *
+ * Rtombs live in a per-kvms list in c0, in the hblock of each kvset
+ * in cn, and are carried forward by compaction until a leaf compaction
+ * that includes the oldest kvset of the node finds them to be older
+ * than the txn horizon, at which point they (and the data they cover)
+ * are dropped.
+ */
+
+/**
+ * struct rtomb - range tombstone
+ * @rt_next:  list linkage (used by c0)
+ * @rt_seqno: seqno of the range delete
+ * @rt_skidx: kvs index (used by c0)
+ * @rt_slen:  length of the start key
+ * @rt_elen:  length of the end key
+ * @rt_data:  start key immediately followed by the end key
+ */
+struct rtomb {
+    struct rtomb *rt_next;
+    uint64_t      rt_seqno;
+    uint16_t      rt_skidx;
+    uint16_t      rt_slen;
+    uint16_t      rt_elen;
+    uint8_t       rt_data[];
+};
+
+/**
+ * struct rtomb_vec - vector of range tombstones
+ * @rv_cnt: number of rtombs in rv_v[]
+ * @rv_max: capacity of rv_v[]
+ * @rv_v:   vector of rtomb pointers (not owned by the vector)
+ *
+ * Range deletes are expected to be rare relative to the number of keys
+ * they cover, so lookups are a linear scan.
+ */
+struct rtomb_vec {
+    uint32_t       rv_cnt;
+    uint32_t       rv_max;
+    struct rtomb **rv_v;
+};
+
+static HSE_ALWAYS_INLINE const void *
+rtomb_start(const struct rtomb *rt)
+{
+    return rt->rt_data;
+}
+
+static HSE_ALWAYS_INLINE const void *
+rtomb_end(const struct rtomb *rt)
+{
+    return rt->rt_data + rt->rt_slen;
+}
+
+static HSE_ALWAYS_INLINE size_t
+rtomb_size(size_t slen, size_t elen)
+{
+    return sizeof(struct rtomb) + slen + elen;
+}
+
+/**
+ * rtomb_init() - initialize an rtomb in caller supplied memory
+ * @rt:    memory of at least rtomb_size(slen, elen) bytes
+ * @start: start key (inclusive)
+ * @slen:  start key length
+ * @end:   end key (exclusive)
+ * @elen:  end key length
+ * @seqno: seqno of the range delete
+ */
+void
+rtomb_init(
+    struct rtomb *rt,
+    const void   *start,
+    size_t        slen,
+    const void   *end,
+    size_t        elen,
+    uint64_t      seqno);
+
+/**
+ * rtomb_alloc() - allocate and initialize an rtomb (free with free())
+ */
+struct rtomb *
+rtomb_alloc(const void *start, size_t slen, const void *end, size_t elen, uint64_t seqno);
+
+/**
+ * rtomb_covers() - check whether key lies within [start, end) of the rtomb
+ */
+bool
+rtomb_covers(const struct rtomb *rt, const void *key, size_t klen);
+
+/**
+ * rtomb_overlaps() - check whether the rtomb intersects the key range [min, max]
+ * @min: minimum key (NULL for unbounded)
+ * @max: maximum key (NULL for unbounded)
+ */
+bool
+rtomb_overlaps(
+    const struct rtomb *rt,
+    const void         *min,
+    size_t              minlen,
+    const void         *max,
+    size_t              maxlen);
+
+/**
+ * rtomb_vec_add() - append an rtomb to an rtomb vector
+ */
+merr_t
+rtomb_vec_add(struct rtomb_vec *rv, struct rtomb *rt);
+
+/**
+ * rtomb_vec_reset() - empty an rtomb vector (retains its capacity)
+ */
+static HSE_ALWAYS_INLINE void
+rtomb_vec_reset(struct rtomb_vec *rv)
+{
+    rv->rv_cnt = 0;
+}
+
+/**
+ * rtomb_vec_fini() - free the resources of an rtomb vector
+ * @free_rtombs: free the rtombs too (if they were allocated by rtomb_alloc())
+ */
+void
+rtomb_vec_fini(struct rtomb_vec *rv, bool free_rtombs);
+
+/**
+ * rtomb_vec_lookup() - find the newest rtomb that covers key
+ * @rv:    rtomb vector (may be NULL)
+ * @key:   key
+ * @klen:  key length
+ * @view:  view seqno, rtombs newer than the view are ignored
+ *
+ * Return: The seqno of the newest rtomb in %rv that covers %key and is
+ * visible in %view, or zero if there is no such rtomb.
+ */
+uint64_t
+rtomb_vec_lookup(const struct rtomb_vec *rv, const void *key, size_t klen, uint64_t view);
+
+#endif /* HSE_KVS_RTOMB_H */
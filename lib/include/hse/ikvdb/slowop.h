@@ -0,0 +1,176 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_IKVDB_SLOWOP_H
+#define HSE_IKVDB_SLOWOP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cjson/cJSON.h>
+
+#include <hse/error/merr.h>
+#include <hse/util/arch.h>
+#include <hse/util/compiler.h>
+
+/* Slow operation tracing.
+ *
+ * With kvdb rparam slowop_thresh_us set, each get, put, delete, cursor and
+ * transaction commit that takes longer than the threshold is recorded in a
+ * small per-cpu ring buffer (see /kvdbs/<alias>/slowops).  While an operation
+ * is being timed, the layers it passes through accumulate a per-stage
+ * breakdown in thread-local storage via slowop_add() and slowop_stage_*(),
+ * each of which costs only a thread-local load and branch when no operation
+ * is being traced.  Tracing does not nest, an operation started while
+ * another is being traced is accounted to the outer operation.
+ */
+
+enum slowop_type {
+    SLOWOP_GET,
+    SLOWOP_PUT,
+    SLOWOP_DEL,
+    SLOWOP_CURSOR_CREATE,
+    SLOWOP_CURSOR_SEEK,
+    SLOWOP_CURSOR_READ,
+    SLOWOP_TXN_COMMIT,
+    SLOWOP_TYPE_CNT,
+};
+
+/* Per-stage statistics.  Page fault and block input counts are per-thread
+ * rusage deltas over the whole operation, sampled only while tracing is
+ * enabled.
+ */
+enum slowop_stat {
+    SLOWOP_C0_NS,
+    SLOWOP_LC_NS,
+    SLOWOP_CN_NS,
+    SLOWOP_CN_NODES,
+    SLOWOP_KVSETS,
+    SLOWOP_BLOOM_FP,
+    SLOWOP_THROTTLE_NS,
+    SLOWOP_MINFLT,
+    SLOWOP_MAJFLT,
+    SLOWOP_INBLOCK,
+    SLOWOP_STAT_CNT,
+};
+
+/**
+ * struct slowop_tls - stage statistics of the calling thread's traced operation
+ * @st_active: an operation is being traced
+ * @st_statv:  per-stage statistics
+ */
+struct slowop_tls {
+    bool     st_active;
+    uint64_t st_statv[SLOWOP_STAT_CNT];
+};
+
+extern thread_local struct slowop_tls slowop_tls;
+
+/**
+ * struct slowop - an operation being timed
+ * @so_start:     start time (ns), zero if the operation is not being traced
+ * @so_thresh_ns: record the operation if it takes longer than this
+ * @so_minflt:    minor page faults of the calling thread at start
+ * @so_majflt:    major page faults of the calling thread at start
+ * @so_inblock:   block input operations of the calling thread at start
+ */
+struct slowop {
+    uint64_t so_start;
+    uint64_t so_thresh_ns;
+    uint64_t so_minflt;
+    uint64_t so_majflt;
+    uint64_t so_inblock;
+};
+
+struct slowop_log;
+
+void
+slowop_trace_start(struct slowop *so, uint64_t thresh_us);
+
+void
+slowop_trace_finish(
+    struct slowop_log *log,
+    struct slowop     *so,
+    enum slowop_type   op,
+    const char        *kvs_name,
+    const void        *key,
+    size_t             klen);
+
+/**
+ * slowop_start() - start timing an operation
+ * @so:        operation context
+ * @thresh_us: tracing threshold (us), zero to disable
+ */
+static HSE_ALWAYS_INLINE void
+slowop_start(struct slowop *so, uint64_t thresh_us)
+{
+    so->so_start = 0;
+
+    if (HSE_UNLIKELY(thresh_us > 0))
+        slowop_trace_start(so, thresh_us);
+}
+
+/**
+ * slowop_finish() - record the operation if it exceeded the threshold
+ * @log:      slow operation log
+ * @so:       operation context from slowop_start()
+ * @op:       operation type
+ * @kvs_name: kvs name (may be NULL)
+ * @key:      key or prefix of the operation (may be NULL)
+ * @klen:     length of %key
+ */
+static HSE_ALWAYS_INLINE void
+slowop_finish(
+    struct slowop_log *log,
+    struct slowop     *so,
+    enum slowop_type   op,
+    const char        *kvs_name,
+    const void        *key,
+    size_t             klen)
+{
+    if (HSE_UNLIKELY(so->so_start > 0))
+        slowop_trace_finish(log, so, op, kvs_name, key, klen);
+}
+
+static HSE_ALWAYS_INLINE void
+slowop_add(enum slowop_stat stat, uint64_t val)
+{
+    if (HSE_UNLIKELY(slowop_tls.st_active))
+        slowop_tls.st_statv[stat] += val;
+}
+
+static HSE_ALWAYS_INLINE uint64_t
+slowop_stage_start(void)
+{
+    return HSE_UNLIKELY(slowop_tls.st_active) ? get_time_ns() : 0;
+}
+
+static HSE_ALWAYS_INLINE void
+slowop_stage_end(enum slowop_stat stat, uint64_t start)
+{
+    if (HSE_UNLIKELY(start > 0))
+        slowop_tls.st_statv[stat] += get_time_ns() - start;
+}
+
+/**
+ * slowop_log_create() - create a slow operation log
+ * @log: (output) log handle
+ */
+merr_t
+slowop_log_create(struct slowop_log **log);
+
+void
+slowop_log_destroy(struct slowop_log *log);
+
+/**
+ * slowop_log_emit() - describe the recorded operations, oldest first
+ * @log:  slow operation log
+ * @root: (output) JSON array of records
+ */
+merr_t
+slowop_log_emit(struct slowop_log *log, cJSON **root);
+
+#endif /* HSE_IKVDB_SLOWOP_H */
@@ -8,9 +8,16 @@
 
 #include <stdint.h>
 
+#include <hse/error/merr.h>
+#include <hse/util/inttypes.h>
+#include <hse/ikvdb/limits.h>
+
 #define VCOMP_PARAM_OFF "off"
 #define VCOMP_PARAM_ON  "on"
 
+#define VCOMP_PARAM_LZ4  "lz4"
+#define VCOMP_PARAM_ZSTD "zstd"
+
 enum vcomp_default {
     VCOMP_DEFAULT_OFF,
     VCOMP_DEFAULT_ON,
@@ -22,12 +29,36 @@ enum vcomp_default {
 
 enum vcomp_algorithm {
     VCOMP_ALGO_LZ4,
+    VCOMP_ALGO_ZSTD,
 };
 
 #define VCOMP_ALGO_MIN   VCOMP_ALGO_LZ4
-#define VCOMP_ALGO_MAX   VCOMP_ALGO_LZ4
+#define VCOMP_ALGO_MAX   VCOMP_ALGO_ZSTD
 #define VCOMP_ALGO_COUNT (VCOMP_ALGO_MAX + 1)
 
+/* Values no longer than this are never compressed.
+ */
+#if CN_SMALL_VALUE_THRESHOLD > 15
+#define VCOMP_VALUE_THRESHOLD   (CN_SMALL_VALUE_THRESHOLD)
+#else
+#define VCOMP_VALUE_THRESHOLD   (15)
+#endif
+
 extern const struct compress_ops *vcomp_compress_ops[VCOMP_ALGO_COUNT];
 
+/**
+ * vcomp_decompress() - decompress a value compressed by any algorithm
+ * @src:     compressed value
+ * @src_len: compressed value length
+ * @dst:     output buffer
+ * @dst_cap: output buffer size (may be less than the uncompressed length)
+ * @dst_len: number of bytes written to dst (output)
+ *
+ * LZ4 values are stored as raw LZ4 blocks, whose first byte is never less
+ * than 0x10.  Values compressed by any other algorithm begin with a tag byte
+ * equal to the algorithm's enum vcomp_algorithm value.
+ */
+merr_t
+vcomp_decompress(const void *src, uint src_len, void *dst, uint dst_cap, uint *dst_len);
+
 #endif
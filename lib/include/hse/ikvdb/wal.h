@@ -9,6 +9,7 @@
 
 #include <hse/ikvdb/ikvdb.h>
 #include <hse/ikvdb/kvs.h>
+#include <hse/ikvdb/limits.h>
 #include <hse/ikvdb/tuple.h>
 
 #define HSE_WAL_DUR_MS_MIN         (1)
@@ -25,6 +26,11 @@
 #define HSE_WAL_DUR_BUFSZ_MB_DFLT  (4096ul)
 #define HSE_WAL_DUR_BUFSZ_MB_MAX   (8192ul)
 
+/* Number of threads applying replayed records to c0 */
+#define HSE_WAL_REPLAY_THREADS_MIN   (1)
+#define HSE_WAL_REPLAY_THREADS_DFLT  (8)
+#define HSE_WAL_REPLAY_THREADS_MAX   (HSE_C0_INGEST_WIDTH_MAX)
+
 struct wal;
 struct throttle_sensor;
 
@@ -44,6 +50,7 @@ struct wal_replay_info {
     uint64_t  gen;
     uint64_t  seqno;
     uint64_t  txhorizon;
+    uint32_t  replay_threads;
     bool      replay_force;
 };
 
@@ -97,6 +104,15 @@ wal_del_pfx(
     uint64_t txid,
     struct wal_record *recout);
 
+/* MTF_MOCK */
+merr_t
+wal_del_range(
+    struct wal *wal,
+    struct ikvs *kvs,
+    struct kvs_ktuple *start,
+    struct kvs_vtuple *end,
+    struct wal_record *recout);
+
 /* MTF_MOCK */
 merr_t
 wal_txn_begin(struct wal *wal, uint64_t txid, int64_t *cookie);
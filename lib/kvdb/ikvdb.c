@@ -20,7 +20,6 @@
 #include <hse/util/log2.h>
 #include <hse/util/atomic.h>
 #include <hse/util/vlb.h>
-#include <hse/util/compression_lz4.h>
 #include <hse/util/token_bucket.h>
 #include <hse/util/xrand.h>
 #include <hse/util/bkv_collection.h>
@@ -31,6 +30,7 @@
 #include <hse/ikvdb/ikvdb.h>
 #include <hse/ikvdb/kvdb_health.h>
 #include <hse/ikvdb/kvs.h>
+#include <hse/ikvdb/kvs_vcomp.h>
 #include <hse/ikvdb/c0.h>
 #include <hse/ikvdb/c0sk.h>
 #include <hse/ikvdb/c0sk_perfc.h>
@@ -60,6 +60,7 @@
 #include <hse/ikvdb/kvdb_meta.h>
 #include <hse/ikvdb/omf_version.h>
 #include <hse/ikvdb/kvdb_home.h>
+#include <hse/ikvdb/slowop.h>
 
 #include "kvdb_kvs.h"
 #include "viewset.h"
@@ -142,6 +143,7 @@ static atomic_uint ikvdb_txn_idx;
  * @ikdb_mp:            mpool handle
  * @ikdb_log:           KVDB log handle
  * @ikdb_cndb:          CNDB handle
+ * @ikdb_slowop:        slow operation log
  * @ikdb_ctxn_cache:    ctxn cache
  * @ikdb_curcnt:        number of active cursors (lazily updated)
  * @ikdb_curcnt_max:    maximum number of active cursors
@@ -181,6 +183,7 @@ struct ikvdb_impl {
     struct cndb            *ikdb_cndb;
     struct viewset         *ikdb_txn_viewset;
     struct viewset         *ikdb_cur_viewset;
+    struct slowop_log      *ikdb_slowop;
 
     struct kvdb_callback    ikdb_wal_cb;
     struct kvdb_health      ikdb_health;
@@ -1355,6 +1358,7 @@ ikvdb_wal_replay_info_init(
     rinfo->seqno = seqno;
     rinfo->gen = gen;
     rinfo->txhorizon = txhorizon;
+    rinfo->replay_threads = self->ikdb_rp.dur_replay_threads;
     rinfo->replay_force = self->ikdb_rp.dur_replay_force;
 }
 
@@ -1527,6 +1531,10 @@ ikvdb_open(
     if (ev(err))
         goto out;
 
+    err = slowop_log_create(&self->ikdb_slowop);
+    if (ev(err))
+        goto out;
+
     self->ikdb_cndb_oid1 = meta.km_cndb.oid1;
     self->ikdb_cndb_oid2 = meta.km_cndb.oid2;
 
@@ -1547,7 +1555,8 @@ ikvdb_open(
     }
 
     err = cn_kvdb_create(self->ikdb_rp.cn_maint_threads, self->ikdb_rp.cn_io_threads,
-                         &self->ikdb_cn_kvdb);
+                         self->ikdb_rp.cn_spill_threads,
+                         (size_t)self->ikdb_rp.cn_bcache_size_mb << 20, &self->ikdb_cn_kvdb);
     if (err) {
         log_errx("cannot open %s", err, kvdb_home);
         goto out;
@@ -1649,6 +1658,7 @@ out:
         wal_close(self->ikdb_wal);
         cndb_close(self->ikdb_cndb);
         kvdb_pfxlock_destroy(self->ikdb_pfxlock);
+        slowop_log_destroy(self->ikdb_slowop);
         kvdb_keylock_destroy(self->ikdb_keylock);
         viewset_destroy(self->ikdb_cur_viewset);
         viewset_destroy(self->ikdb_txn_viewset);
@@ -1720,6 +1730,14 @@ ikvdb_rparams(struct ikvdb *const kvdb)
     return &self->ikdb_rp;
 }
 
+struct slowop_log *
+ikvdb_slowop_log(struct ikvdb *const kvdb)
+{
+    struct ikvdb_impl *self = ikvdb_h2r(kvdb);
+
+    return self->ikdb_slowop;
+}
+
 merr_t
 ikvdb_cparams(struct ikvdb *const kvdb, struct kvdb_cparams *const cparams)
 {
@@ -1983,6 +2001,8 @@ ikvdb_kvs_drop(struct ikvdb *handle, const char *kvs_name)
     if (ev(err))
         goto out_unlock;
 
+    kvs_vcomp_drop(self->ikdb_mp, kvs->kk_cnid);
+
     drop_kvs_index(handle, idx);
 
 out_unlock:
@@ -2180,10 +2200,10 @@ ikvdb_kvs_open(
     kvs->kk_viewset = self->ikdb_cur_viewset;
 
     kvs->kk_vcomp_default = params->value.compression.dflt;
-    cops = vcomp_compress_ops[VCOMP_ALGO_LZ4];
+    kvs->kk_vcomp_deferred = params->value.compression.deferred;
+    cops = vcomp_compress_ops[params->value.compression.algo];
     assert(cops && cops->cop_compress && cops->cop_estimate);
 
-    kvs->kk_vcompress = cops->cop_compress;
     kvs->kk_vcompbnd = cops->cop_estimate(NULL, tls_vbufsz);
     kvs->kk_vcompbnd = tls_vbufsz - (kvs->kk_vcompbnd - tls_vbufsz);
     assert(kvs->kk_vcompbnd < tls_vbufsz);
@@ -2355,6 +2375,7 @@ ikvdb_close(struct ikvdb *handle)
     c0snr_set_destroy(self->ikdb_c0snr_set);
 
     kvdb_pfxlock_destroy(self->ikdb_pfxlock);
+    slowop_log_destroy(self->ikdb_slowop);
     kvdb_keylock_destroy(self->ikdb_keylock);
 
     viewset_destroy(self->ikdb_cur_viewset);
@@ -2389,11 +2410,15 @@ ikvdb_throttle(struct ikvdb_impl *self, u64 bytes, u64 tstart)
         u64 dly = now - tstart;
 
         if (sleep_ns > dly) {
+            u64 sostart = slowop_stage_start();
+
             if (sleep_ns - dly > timer_slack / 2) {
                 tbkt_delay(sleep_ns - dly);
             } else {
                 sched_yield();
             }
+
+            slowop_stage_end(SLOWOP_THROTTLE_NS, sostart);
         }
 
         if (HSE_UNLIKELY(self->ikdb_tb_dbg)) {
@@ -2419,19 +2444,20 @@ is_read_allowed(struct ikvs *kvs, struct hse_kvdb_txn *const txn)
     return txn && !kvs_txn_is_enabled(kvs) ? false : true;
 }
 
+/* With value.compression.deferred, values that would be compressed by
+ * default are instead inserted into c0 as is and compressed by the c0
+ * ingest threads (see c0sk_cningest_cb()), unless put with
+ * HSE_KVS_PUT_VCOMP_OFF.  Only an explicit request for compression is
+ * still honored on the put path.
+ */
 static inline bool
 is_compression_allowed(const struct kvdb_kvs *const kk, const unsigned int flags)
 {
     return (flags & HSE_KVS_PUT_VCOMP_ON) ||
-        (kk->kk_vcomp_default == VCOMP_DEFAULT_ON && !(flags & HSE_KVS_PUT_VCOMP_OFF));
+        (kk->kk_vcomp_default == VCOMP_DEFAULT_ON && !kk->kk_vcomp_deferred &&
+         !(flags & HSE_KVS_PUT_VCOMP_OFF));
 }
 
-#if CN_SMALL_VALUE_THRESHOLD > 15
-#define VCOMP_VALUE_THRESHOLD   (CN_SMALL_VALUE_THRESHOLD)
-#else
-#define VCOMP_VALUE_THRESHOLD   (15)
-#endif
-
 merr_t
 ikvdb_kvs_put(
     struct hse_kvs *           handle,
@@ -2450,6 +2476,7 @@ ikvdb_kvs_put(
     struct kvs_ktuple ktbuf;
     struct kvs_vtuple vtbuf;
     struct ikvdb_impl *parent;
+    struct slowop so;
 
     INVARIANT(handle && kt && vt);
 
@@ -2467,6 +2494,7 @@ ikvdb_kvs_put(
         return err;
 
     tstart = (flags & HSE_KVS_PUT_PRIO || parent->ikdb_rp.throttle_disable) ? 0 : get_time_ns();
+    slowop_start(&so, parent->ikdb_rp.slowop_thresh_us);
 
     ktbuf = *kt;
     vtbuf = *vt;
@@ -2474,6 +2502,12 @@ ikvdb_kvs_put(
     kt = &ktbuf;
     vt = &vtbuf;
 
+    /* Values put with compression disabled must also be left as they are
+     * by deferred compression.
+     */
+    if (flags & HSE_KVS_PUT_VCOMP_OFF)
+        kt->kt_flags |= HSE_BTF_VCOMP_OFF;
+
     vlen = kvs_vtuple_vlen(vt);
     clen = kvs_vtuple_clen(vt);
 
@@ -2489,7 +2523,8 @@ ikvdb_kvs_put(
         }
 
         if (vbuf) {
-            err = kk->kk_vcompress(vt->vt_data, vlen, vbuf, vbufsz, &clen);
+            err = kvs_vcomp_compress(kk->kk_ikvs->ikv_vcomp, vt->vt_data, vlen,
+                                     vbuf, vbufsz, &clen);
 
             /* Save space by storing the original value if the compressed length
              * is larger than the original length.
@@ -2511,6 +2546,8 @@ ikvdb_kvs_put(
     if (tstart > 0)
         ikvdb_throttle(parent, kt->kt_len + (clen ? clen : vlen), tstart);
 
+    slowop_finish(parent->ikdb_slowop, &so, SLOWOP_PUT, kk->kk_name, kt->kt_data, kt->kt_len);
+
     return err;
 }
 
@@ -2562,7 +2599,9 @@ ikvdb_kvs_get(
 {
     struct kvdb_kvs *  kk = (struct kvdb_kvs *)handle;
     struct ikvdb_impl *p;
+    struct slowop      so;
     u64                view_seqno;
+    merr_t             err;
 
     if (ev(!handle))
         return merr(EINVAL);
@@ -2572,6 +2611,8 @@ ikvdb_kvs_get(
 
     p = kk->kk_parent;
 
+    slowop_start(&so, p->ikdb_rp.slowop_thresh_us);
+
     if (txn) {
         /*
          * No need to wait for ongoing commits. A transaction waited when its view was
@@ -2584,7 +2625,46 @@ ikvdb_kvs_get(
         kvdb_ctxn_set_wait_commits(p->ikdb_ctxn_set, 0);
     }
 
-    return kvs_get(kk->kk_ikvs, txn, kt, view_seqno, res, vbuf);
+    err = kvs_get(kk->kk_ikvs, txn, kt, view_seqno, res, vbuf);
+
+    slowop_finish(p->ikdb_slowop, &so, SLOWOP_GET, kk->kk_name, kt->kt_data, kt->kt_len);
+
+    return err;
+}
+
+merr_t
+ikvdb_kvs_get_multi(
+    struct hse_kvs *           handle,
+    const unsigned int         flags,
+    struct hse_kvdb_txn *const txn,
+    uint                       count,
+    struct kvs_ktuple *        ktv,
+    enum key_lookup_res *      resv,
+    struct kvs_buf *           vbufv)
+{
+    struct kvdb_kvs *  kk = (struct kvdb_kvs *)handle;
+    struct ikvdb_impl *p;
+    u64                view_seqno;
+
+    if (ev(!handle))
+        return merr(EINVAL);
+
+    if (ev(!is_read_allowed(kk->kk_ikvs, txn)))
+        return merr(EINVAL);
+
+    p = kk->kk_parent;
+
+    /* Same as ikvdb_kvs_get(), but the view and the wait for ongoing
+     * commits are established once for the entire batch.
+     */
+    if (txn) {
+        view_seqno = 0;
+    } else {
+        view_seqno = atomic_read(&p->ikdb_seqno);
+        kvdb_ctxn_set_wait_commits(p->ikdb_ctxn_set, 0);
+    }
+
+    return kvs_get_multi(kk->kk_ikvs, txn, count, ktv, view_seqno, resv, vbufv);
 }
 
 merr_t
@@ -2596,6 +2676,7 @@ ikvdb_kvs_del(
 {
     struct kvdb_kvs *  kk = (struct kvdb_kvs *)handle;
     struct ikvdb_impl *parent;
+    struct slowop      so;
     u64                seqnoref;
     merr_t             err;
 
@@ -2613,9 +2694,15 @@ ikvdb_kvs_del(
     if (ev(err))
         return err;
 
+    slowop_start(&so, parent->ikdb_rp.slowop_thresh_us);
+
     seqnoref = txn ? 0 : HSE_SQNREF_SINGLE;
 
-    return kvs_del(kk->kk_ikvs, txn, kt, seqnoref);
+    err = kvs_del(kk->kk_ikvs, txn, kt, seqnoref);
+
+    slowop_finish(parent->ikdb_slowop, &so, SLOWOP_DEL, kk->kk_name, kt->kt_data, kt->kt_len);
+
+    return err;
 }
 
 merr_t
@@ -2659,6 +2746,45 @@ ikvdb_kvs_prefix_delete(
     return kvs_prefix_del(kk->kk_ikvs, txn, kt, seqnoref);
 }
 
+merr_t
+ikvdb_kvs_range_delete(
+    struct hse_kvs           *handle,
+    const unsigned int        flags,
+    struct hse_kvdb_txn      *txn,
+    struct kvs_ktuple        *start,
+    const struct kvs_ktuple  *end)
+{
+    struct kvdb_kvs *  kk = (struct kvdb_kvs *)handle;
+    struct ikvdb_impl *parent;
+    merr_t             err;
+
+    INVARIANT(handle);
+    INVARIANT(start->kt_data && end->kt_data);
+
+    /* Range tombstones are not (yet) supported within transactions.  As
+     * a consequence LC, which holds only transactional mutations, never
+     * contains a key that an rtomb must hide.
+     */
+    if (ev(txn || kvs_txn_is_enabled(kk->kk_ikvs)))
+        return merr(ENOTSUP);
+
+    if (ev(!is_write_allowed(kk->kk_ikvs, txn)))
+        return merr(EINVAL);
+
+    parent = kk->kk_parent;
+    if (!parent->ikdb_allow_writes)
+        return merr(EROFS);
+
+    err = kvdb_health_check(&parent->ikdb_health, KVDB_HEALTH_FLAG_ALL);
+    if (ev(err))
+        return err;
+
+    /* Like a ptomb, the range tombstone is assigned a seqno greater
+     * than that of every mutation it deletes.
+     */
+    return kvs_range_del(kk->kk_ikvs, start, end, HSE_SQNREF_SINGLE);
+}
+
 /*-  IKVDB Cursors --------------------------------------------------*/
 
 /*
@@ -2747,42 +2873,26 @@ cursor_unbind_txn(struct hse_kvs_cursor *cur)
     return 0;
 }
 
-merr_t
-ikvdb_kvs_cursor_create(
-    struct hse_kvs *           handle,
-    const unsigned int         flags,
-    struct hse_kvdb_txn *const txn,
-    const void *               prefix,
-    size_t                     pfx_len,
-    struct hse_kvs_cursor **   cursorp)
-{
-    struct kvdb_kvs *      kk = (struct kvdb_kvs *)handle;
-    struct ikvdb_impl *    ikvdb = kk->kk_parent;
-    struct kvdb_ctxn *     ctxn = 0;
-    struct hse_kvs_cursor *cur = 0;
-    merr_t                 err;
-    u64                    ts, vseq, tstart, tseqno;
+/* Allocate and initialize a cursor.  If vseq is HSE_SQNREF_UNDEFINED then
+ * the cursor acquires its own view and returns the commit ticket needed by
+ * kvdb_ctxn_set_wait_commits() via tseqnop.  Otherwise the cursor adopts
+ * the given view, which the caller must hold until this function returns.
+ */
+static merr_t
+cursor_create_view(
+    struct kvdb_kvs *       kk,
+    const unsigned int      flags,
+    struct kvdb_ctxn *      ctxn,
+    const void *            prefix,
+    size_t                  pfx_len,
+    u64                     vseq,
+    u64 *                   tseqnop,
+    struct hse_kvs_cursor **cursorp)
+{
+    struct hse_kvs_cursor *cur;
     struct perfc_set *     pkvsl_pc;
-
-    *cursorp = NULL;
-
-    if (ev(!is_read_allowed(kk->kk_ikvs, txn)))
-        return merr(EINVAL);
-
-    if (ev(atomic_read(&ikvdb->ikdb_curcnt) > ikvdb->ikdb_curcnt_max))
-        return merr(ECANCELED);
-
-    pkvsl_pc = kvs_perfc_pkvsl(kk->kk_ikvs);
-    tstart = perfc_lat_start(pkvsl_pc);
-
-    vseq = HSE_SQNREF_UNDEFINED;
-
-    if (txn) {
-        ctxn = kvdb_ctxn_h2h(txn);
-        err = kvdb_ctxn_get_view_seqno(ctxn, &vseq);
-        if (ev(err))
-            return err;
-    }
+    merr_t                 err;
+    u64                    ts;
 
     /* The initialization sequence is driven by the way the sequence
      * number horizon is tracked, which requires atomically getting a
@@ -2799,6 +2909,7 @@ ikvdb_kvs_cursor_create(
     if (ev(!cur))
         return merr(ENOMEM);
 
+    pkvsl_pc = kvs_perfc_pkvsl(kk->kk_ikvs);
     cur->kc_pkvsl_pc = pkvsl_pc;
 
     /* if we have a transaction at all, use its view seqno... */
@@ -2810,7 +2921,7 @@ ikvdb_kvs_cursor_create(
     cur->kc_bind = ctxn ? kvdb_ctxn_cursor_bind(ctxn) : NULL;
 
     /* Temporarily lock a view until this cursor gets refs on cn kvsets. */
-    err = cursor_view_acquire(cur, &tseqno);
+    err = cursor_view_acquire(cur, tseqnop);
     if (ev(err))
         goto out;
 
@@ -2822,6 +2933,61 @@ ikvdb_kvs_cursor_create(
 
     cursor_view_release(cur); /* release the view that was locked */
 
+    *cursorp = cur;
+
+out:
+    if (err)
+        ikvdb_kvs_cursor_destroy(cur);
+
+    return err;
+}
+
+merr_t
+ikvdb_kvs_cursor_create(
+    struct hse_kvs *           handle,
+    const unsigned int         flags,
+    struct hse_kvdb_txn *const txn,
+    const void *               prefix,
+    size_t                     pfx_len,
+    struct hse_kvs_cursor **   cursorp)
+{
+    struct kvdb_kvs *      kk = (struct kvdb_kvs *)handle;
+    struct ikvdb_impl *    ikvdb = kk->kk_parent;
+    struct kvdb_ctxn *     ctxn = 0;
+    struct hse_kvs_cursor *cur = 0;
+    merr_t                 err;
+    u64                    vseq, tstart, tseqno;
+    struct perfc_set *     pkvsl_pc;
+    struct slowop          so;
+
+    *cursorp = NULL;
+
+    if (ev(!is_read_allowed(kk->kk_ikvs, txn)))
+        return merr(EINVAL);
+
+    if (ev(atomic_read(&ikvdb->ikdb_curcnt) > ikvdb->ikdb_curcnt_max))
+        return merr(ECANCELED);
+
+    pkvsl_pc = kvs_perfc_pkvsl(kk->kk_ikvs);
+    tstart = perfc_lat_start(pkvsl_pc);
+
+    vseq = HSE_SQNREF_UNDEFINED;
+
+    if (txn) {
+        ctxn = kvdb_ctxn_h2h(txn);
+        err = kvdb_ctxn_get_view_seqno(ctxn, &vseq);
+        if (ev(err))
+            return err;
+    }
+
+    slowop_start(&so, ikvdb->ikdb_rp.slowop_thresh_us);
+
+    err = cursor_create_view(kk, flags, ctxn, prefix, pfx_len, vseq, &tseqno, &cur);
+    if (ev(err)) {
+        slowop_finish(ikvdb->ikdb_slowop, &so, SLOWOP_CURSOR_CREATE, kk->kk_name, prefix, pfx_len);
+        return err;
+    }
+
     /* After acquiring a view, non-txn cursors must wait for ongoing commits
      * to finish to ensure they never see partial txns.  This is not necessary
      * for txn cursors because their view is inherited from the txn.
@@ -2833,12 +2999,130 @@ ikvdb_kvs_cursor_create(
     cur->kc_create_time = tstart;
 
     perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_CURSOR_CREATE, tstart);
+    slowop_finish(ikvdb->ikdb_slowop, &so, SLOWOP_CURSOR_CREATE, kk->kk_name, prefix, pfx_len);
 
     *cursorp = cur;
 
-out:
-    if (err)
-        ikvdb_kvs_cursor_destroy(cur);
+    return 0;
+}
+
+merr_t
+ikvdb_kvs_cursor_create_split(
+    struct hse_kvs *           handle,
+    const unsigned int         flags,
+    struct hse_kvdb_txn *const txn,
+    const void *               min,
+    size_t                     min_len,
+    const void *               max,
+    size_t                     max_len,
+    unsigned int *             cursorc,
+    struct hse_kvs_cursor **   cursorv)
+{
+    struct kvdb_kvs *  kk = (struct kvdb_kvs *)handle;
+    struct ikvdb_impl *ikvdb = kk->kk_parent;
+    struct kvdb_ctxn * ctxn = NULL;
+    void *             viewcookie = NULL;
+    uint8_t *          keybufv = NULL;
+    uint *             keylenv = NULL;
+    uint               splitc, n, i;
+    u64                vseq, tstart, tseqno = 0;
+    merr_t             err = 0;
+
+    if (ev(!is_read_allowed(kk->kk_ikvs, txn)))
+        return merr(EINVAL);
+
+    /* Range limits are only supported by forward cursors.
+     */
+    if (ev(flags & HSE_CURSOR_CREATE_REV))
+        return merr(EINVAL);
+
+    if (ev(min_len > HSE_KVS_KEY_LEN_MAX || max_len > HSE_KVS_KEY_LEN_MAX))
+        return merr(EINVAL);
+
+    if (ev(atomic_read(&ikvdb->ikdb_curcnt) > ikvdb->ikdb_curcnt_max))
+        return merr(ECANCELED);
+
+    tstart = perfc_lat_start(kvs_perfc_pkvsl(kk->kk_ikvs));
+
+    if (*cursorc > 1) {
+        keybufv = malloc((*cursorc - 1) * (HSE_KVS_KEY_LEN_MAX + sizeof(*keylenv)));
+        if (ev(!keybufv))
+            return merr(ENOMEM);
+
+        keylenv = (uint *)(keybufv + (*cursorc - 1) * HSE_KVS_KEY_LEN_MAX);
+    }
+
+    /* All the sub-cursors share one view, so that together they scan
+     * a consistent snapshot of the range.  For a non-txn scan we hold
+     * that view until every sub-cursor has its refs on cn kvsets.
+     */
+    if (txn) {
+        ctxn = kvdb_ctxn_h2h(txn);
+        err = kvdb_ctxn_get_view_seqno(ctxn, &vseq);
+    } else {
+        err = viewset_insert(kk->kk_viewset, &vseq, &tseqno, &viewcookie);
+    }
+
+    if (ev(err)) {
+        free(keybufv);
+        return err;
+    }
+
+    splitc = cn_range_split(kvs_cn(kk->kk_ikvs), min, min_len, max, max_len,
+                            *cursorc - 1, keybufv, keylenv);
+
+    for (n = 0; n <= splitc; ++n) {
+        err = cursor_create_view(kk, flags, ctxn, NULL, 0, vseq, NULL, cursorv + n);
+        if (ev(err))
+            break;
+
+        perfc_inc(&kvdb_metrics_pc, PERFC_BA_KVDBMETRICS_CURCNT);
+        cursorv[n]->kc_create_time = tstart;
+    }
+
+    if (viewcookie) {
+        u64 minview;
+        u32 minchg;
+
+        viewset_remove(kk->kk_viewset, viewcookie, &minchg, &minview);
+
+        if (!err)
+            kvdb_ctxn_set_wait_commits(ikvdb->ikdb_ctxn_set, tseqno);
+    }
+
+    /* Sub-cursor i covers the keys in (split[i - 1], split[i]], where
+     * the first and last sub-cursors are bounded by min and max.  The
+     * smallest key greater than a split key is that key with a trailing
+     * zero byte.
+     */
+    for (i = 0; i < n && !err; ++i) {
+        uint8_t     lobuf[HSE_KVS_KEY_LEN_MAX];
+        const void *lo = min, *hi = max;
+        size_t      lolen = min_len, hilen = max_len;
+
+        if (i > 0) {
+            lolen = keylenv[i - 1];
+            memcpy(lobuf, keybufv + (i - 1) * HSE_KVS_KEY_LEN_MAX, lolen);
+            lobuf[lolen++] = 0;
+            lo = lobuf;
+        }
+
+        if (i < splitc) {
+            hi = keybufv + i * HSE_KVS_KEY_LEN_MAX;
+            hilen = keylenv[i];
+        }
+
+        err = ikvdb_kvs_cursor_seek(cursorv[i], 0, lo, lolen, hi, hilen, NULL);
+    }
+
+    if (err) {
+        for (i = 0; i < n; ++i)
+            ikvdb_kvs_cursor_destroy(cursorv[i]);
+        n = 0;
+    }
+
+    free(keybufv);
+    *cursorc = n;
 
     return err;
 }
@@ -2923,6 +3207,8 @@ ikvdb_kvs_cursor_seek(
     size_t                 limit_len,
     struct kvs_ktuple *    kt)
 {
+    struct kvdb_kvs *kk = cur->kc_kvs;
+    struct slowop so;
     merr_t err;
     u64    tstart;
 
@@ -2934,16 +3220,22 @@ ikvdb_kvs_cursor_seek(
     if (ev(cur->kc_err))
         return cur->kc_err;
 
+    slowop_start(&so, kk->kk_parent->ikdb_rp.slowop_thresh_us);
+
     if (cur->kc_bind) {
         cur->kc_err = cursor_refresh(cur);
-        if (ev(cur->kc_err))
+        if (ev(cur->kc_err)) {
+            slowop_finish(kk->kk_parent->ikdb_slowop, &so, SLOWOP_CURSOR_SEEK, kk->kk_name,
+                          key, len);
             return cur->kc_err;
+        }
     }
 
     /* errors on seek are not fatal */
     err = kvs_cursor_seek(cur, key, (u32)len, limit, (u32)limit_len, kt);
 
     perfc_lat_record(cur->kc_pkvsl_pc, PERFC_LT_PKVSL_KVS_CURSOR_SEEK, tstart);
+    slowop_finish(kk->kk_parent->ikdb_slowop, &so, SLOWOP_CURSOR_SEEK, kk->kk_name, key, len);
 
     return ev(err);
 }
@@ -2958,6 +3250,8 @@ ikvdb_kvs_cursor_read(
     size_t *               val_len,
     bool *                 eof)
 {
+    struct kvdb_kvs   *kk = cur->kc_kvs;
+    struct slowop      so;
     merr_t             err;
     u64                tstart;
 
@@ -2966,22 +3260,24 @@ ikvdb_kvs_cursor_read(
     if (ev(cur->kc_err))
         return cur->kc_err;
 
+    slowop_start(&so, kk->kk_parent->ikdb_rp.slowop_thresh_us);
+
     if (cur->kc_bind) {
         cur->kc_err = cursor_refresh(cur);
-        if (ev(cur->kc_err))
-            return cur->kc_err;
+        if (ev(cur->kc_err)) {
+            err = cur->kc_err;
+            goto out;
+        }
     }
 
     err = kvs_cursor_read(cur, flags, eof);
-    if (ev(err))
-        return err;
-    if (*eof)
-        return 0;
+    if (ev(err) || *eof)
+        goto out;
 
     kvs_cursor_key_copy(cur, NULL, 0, key, key_len);
     err = kvs_cursor_val_copy(cur, NULL, 0, val, val_len);
     if (ev(err))
-        return err;
+        goto out;
 
     perfc_lat_record(
         cur->kc_pkvsl_pc,
@@ -2989,7 +3285,13 @@ ikvdb_kvs_cursor_read(
                                                 : PERFC_LT_PKVSL_KVS_CURSOR_READFWD,
         tstart);
 
-    return 0;
+out:
+    /* Record the key read, if any.
+     */
+    slowop_finish(kk->kk_parent->ikdb_slowop, &so, SLOWOP_CURSOR_READ, kk->kk_name,
+                  (err || *eof) ? NULL : *key, (err || *eof) ? 0 : *key_len);
+
+    return err;
 }
 
 merr_t
@@ -3229,16 +3531,19 @@ ikvdb_txn_commit(struct ikvdb *handle, struct hse_kvdb_txn *txn)
 {
     struct ikvdb_impl *self = ikvdb_h2r(handle);
     struct kvdb_ctxn * ctxn = kvdb_ctxn_h2h(txn);
+    struct slowop      so;
     merr_t             err;
     u64                lstart;
 
     lstart = perfc_lat_startu(&self->ikdb_ctxn_op, PERFC_LT_CTXNOP_COMMIT);
     perfc_inc(&self->ikdb_ctxn_op, PERFC_RA_CTXNOP_COMMIT);
+    slowop_start(&so, self->ikdb_rp.slowop_thresh_us);
 
     err = kvdb_ctxn_commit(ctxn);
 
     perfc_dec(&self->ikdb_ctxn_op, PERFC_BA_CTXNOP_ACTIVE);
     perfc_lat_record(&self->ikdb_ctxn_op, PERFC_LT_CTXNOP_COMMIT, lstart);
+    slowop_finish(self->ikdb_slowop, &so, SLOWOP_TXN_COMMIT, NULL, NULL, 0);
 
     return err;
 }
@@ -3267,8 +3572,6 @@ ikvdb_txn_state(struct ikvdb *handle, struct hse_kvdb_txn *txn)
 /* ------------------  WAL replay ikvdb interfaces ---------------- */
 
 struct ikvdb_kvs_hdl {
-    struct kvdb_kvs *kk_prev;
-    uint64_t cnid_prev;
     size_t   cache_sz;
     size_t   cheap_sz;
     bool     needs_reset;
@@ -3338,21 +3641,19 @@ ikvdb_wal_replay_close(struct ikvdb *ikvdb, struct ikvdb_kvs_hdl *ikvsh)
     free(ikvsh);
 }
 
+/* Records are applied by several replay threads concurrently, so the kvs
+ * handle vector is only ever read here.
+ */
 static struct kvdb_kvs *
-ikvdb_wal_replay_kvs_get(struct ikvdb_kvs_hdl *ikvsh, u64 cnid)
+ikvdb_wal_replay_kvs_get(const struct ikvdb_kvs_hdl *ikvsh, u64 cnid)
 {
     int i;
 
-    if (ikvsh->cnid_prev == cnid)
-        return ikvsh->kk_prev;
-
     for (i = 0; i < ikvsh->kvshc; i++) {
         struct kvdb_kvs *kk = (struct kvdb_kvs *)ikvsh->kvshv[i];
-        if (kk->kk_cnid == cnid) {
-            ikvsh->cnid_prev = cnid;
-            ikvsh->kk_prev = kk;
+
+        if (kk->kk_cnid == cnid)
             return kk;
-        }
     }
 
     return NULL;
@@ -3431,6 +3732,34 @@ ikvdb_wal_replay_prefix_del(
     return err;
 }
 
+merr_t
+ikvdb_wal_replay_range_del(
+    struct ikvdb         *ikvdb,
+    struct ikvdb_kvs_hdl *ikvsh,
+    u64                   cnid,
+    u64                   seqno,
+    struct kvs_ktuple    *kt,
+    struct kvs_vtuple    *vt)
+{
+    struct kvs_ktuple end;
+    struct kvdb_kvs *kk;
+    merr_t err;
+
+    assert(ikvdb && ikvsh);
+
+    kk = ikvdb_wal_replay_kvs_get(ikvsh, cnid);
+    if (ev(!kk))
+        return 0; /* Possible that the kvs is dropped just prior to crash */
+
+    kvs_ktuple_init_nohash(&end, vt->vt_data, vt->vt_xlen);
+
+    err = kvs_range_del(kk->kk_ikvs, kt, &end, HSE_ORDNL_TO_SQNREF(seqno));
+    if (!err)
+        ikvdb_wal_replay_seqno_set(ikvdb, seqno);
+
+    return err;
+}
+
 merr_t
 ikvdb_wal_replay_sync(struct ikvdb *handle, const unsigned int flags)
 {
@@ -3443,14 +3772,19 @@ void
 ikvdb_wal_replay_seqno_set(struct ikvdb *ikvdb, uint64_t seqno)
 {
     struct ikvdb_impl *self;
+    uint64_t cur;
 
     assert(ikvdb);
 
     self = ikvdb_h2r(ikvdb);
 
-    /* This is called only in a single-threaded replay context */
-    if (seqno > atomic_read(&self->ikdb_seqno))
-        atomic_set(&self->ikdb_seqno, seqno);
+    /* Records are applied by several replay threads concurrently */
+    cur = atomic_read(&self->ikdb_seqno);
+    while (seqno > cur) {
+        if (atomic_cas(&self->ikdb_seqno, cur, seqno))
+            break;
+        cur = atomic_read(&self->ikdb_seqno);
+    }
 }
 
 void
@@ -15,6 +15,7 @@
 #include <hse/util/seqno.h>
 #include <hse/util/keylock.h>
 #include <hse/util/page.h>
+#include <hse/util/spinlock.h>
 #include <hse/util/xrand.h>
 #include <hse/util/event_counter.h>
 
@@ -49,6 +50,9 @@ struct kvdb_ctxn_set {
  * @ktn_dwork:        delayed work struct
  * @ktn_tseqno_head:  used to obtain a stable view seqno
  * @ktn_tseqno_tail:  used to obtain a stable view seqno
+ * @ktn_commit_lock:  protects ktn_commit_list and ktn_commit_leader
+ * @ktn_commit_list:  committing txns waiting to join the next batch
+ * @ktn_commit_leader: true while a batch leader is active
  * @ktn_list_mutex:   protects updates to list of allocated transactions
  * @ktn_alloc_list:   RCU list of allocated transactions
  * @ktn_pending:      transactions to be freed when reader thread finishes
@@ -65,6 +69,10 @@ struct kvdb_ctxn_set_impl {
     atomic_ulong             ktn_tseqno_head HSE_ACP_ALIGNED;
     atomic_ulong             ktn_tseqno_tail HSE_ACP_ALIGNED;
 
+    spinlock_t               ktn_commit_lock HSE_ACP_ALIGNED;
+    struct list_head         ktn_commit_list;
+    bool                     ktn_commit_leader;
+
     struct mutex             ktn_list_mutex HSE_ACP_ALIGNED;
     struct list_head         ktn_pending;
     atomic_int               ktn_reading;
@@ -480,13 +488,113 @@ kvdb_ctxn_abort(struct kvdb_ctxn *handle)
     }
 }
 
+/* Group commit states of a writing transaction (see kvdb_ctxn_commit()).
+ */
+enum {
+    CTXN_COMMIT_WAIT,
+    CTXN_COMMIT_LEAD,
+    CTXN_COMMIT_DONE,
+};
+
+/* Commit all the transactions waiting on the commit list as one batch.
+ *
+ * Only one batch leader is active at a time, so the leader mints the
+ * commit seqnos for the entire batch with a single atomic op and advances
+ * the commit ticket lock (tseqno head/tail) by the size of the batch
+ * without having to wait on it.  The batch's commit seqnos are assigned
+ * in list order (i.e., the order in which the txns joined the batch),
+ * which is also the order in which their write locks are enqueued.
+ */
+static void
+kvdb_ctxn_commit_batch(struct kvdb_ctxn_set_impl *kcs, struct kvdb_ctxn_impl *leader)
+{
+    struct kvdb_ctxn_impl *ctxn, *next;
+    struct list_head batch;
+    uint64_t head, commit_sn;
+    void *cookie;
+    uint n = 0;
+
+    INIT_LIST_HEAD(&batch);
+
+    spin_lock(&kcs->ktn_commit_lock);
+    list_splice_tail(&kcs->ktn_commit_list, &batch);
+    INIT_LIST_HEAD(&kcs->ktn_commit_list);
+    spin_unlock(&kcs->ktn_commit_lock);
+
+    list_for_each_entry(ctxn, &batch, ctxn_commit_link)
+        ++n;
+
+    assert(n > 0);
+
+    cookie = NULL; /* Set to nil for mapi */
+
+    /* The critical section demarcated by the keylock_list_{lock/unlock}
+     * calls provides mutual exclusion only for the list referenced by
+     * cookie, and ensures that keylocks are queued to their respective
+     * lists in commit sequence number order (aborting txns also mint
+     * their end seqnos within this critical section).
+     */
+    kvdb_keylock_list_lock(leader->ctxn_kvdb_keylock, &cookie);
+
+    /* The commit ticket lock (tseqno head/tail) ensures that commit sequence
+     * numbers are minted and made visible in ticket order.  Acquire semantics
+     * on the increment of tseqno head ensure that it is always incremented
+     * before the batch's commit seqnos are computed.  This ticket lock is also
+     * used by kvdb_ctxn_set_wait_commits() to ensure visibility of a view seqno
+     * obtained asynchronously with respect to this critical section.
+     */
+    head = atomic_fetch_add(&kcs->ktn_tseqno_head, n);
+    assert(atomic_read(&kcs->ktn_tseqno_tail) == head);
+
+    commit_sn = 1 + atomic_fetch_add(leader->ctxn_kvdb_seq_addr, 2 * n);
+
+    /* The assignment through each txn's priv gives all the values
+     * associated with that transaction an ordinal sequence number.
+     * Each of those values has their own pointer to the ordinal value.
+     */
+    list_for_each_entry(ctxn, &batch, ctxn_commit_link) {
+        ctxn->ctxn_commit_sn = commit_sn;
+        ctxn->ctxn_commit_tsn = head++;
+
+        *(uintptr_t *)ctxn->ctxn_seqref = HSE_ORDNL_TO_SQNREF(commit_sn);
+        commit_sn += 2;
+    }
+
+    atomic_add_rel(&kcs->ktn_tseqno_tail, n); /* release tickets */
+
+    list_for_each_entry(ctxn, &batch, ctxn_commit_link) {
+        struct kvdb_ctxn_locks *locks = ctxn->ctxn_locks_handle;
+
+        if (kvdb_ctxn_locks_count(locks) > 0) {
+            kvdb_keylock_enqueue_locks(locks, ctxn->ctxn_commit_sn, cookie);
+            ctxn->ctxn_locks_handle = NULL;
+        }
+    }
+    kvdb_keylock_list_unlock(cookie);
+
+    /* Hand off leadership to the first txn that joined the next batch
+     * while we were busy committing this one.
+     */
+    spin_lock(&kcs->ktn_commit_lock);
+    next = list_first_entry_or_null(&kcs->ktn_commit_list, typeof(*next), ctxn_commit_link);
+    if (next)
+        atomic_set_rel(&next->ctxn_commit_state, CTXN_COMMIT_LEAD);
+    else
+        kcs->ktn_commit_leader = false;
+    spin_unlock(&kcs->ktn_commit_lock);
+
+    /* A txn may be reused as soon as we release it, so we must not
+     * touch it after setting its state to done.
+     */
+    list_for_each_entry_safe(ctxn, next, &batch, ctxn_commit_link)
+        atomic_set_rel(&ctxn->ctxn_commit_state, CTXN_COMMIT_DONE);
+}
+
 merr_t
 kvdb_ctxn_commit(struct kvdb_ctxn *handle)
 {
     merr_t err;
-    void *cookie;
-    uint64_t head;
-    uintptr_t ref;
+    bool lead;
     uintptr_t *priv;
     uint64_t commit_sn;
     struct kvdb_ctxn_locks *locks;
@@ -551,49 +659,47 @@ kvdb_ctxn_commit(struct kvdb_ctxn *handle)
      *     txn in the system, we ensure that we put A's write lock
      *     collection on the list before we call kvdb_ctxn_deactivate
      *     so that a commit execution will reap its own collection.
+     *
+     *   - Concurrent committers are grouped into batches, where the batch
+     *     leader mints the commit sequence numbers, publishes them, and
+     *     enqueues the write lock collections for the entire batch (see
+     *     kvdb_ctxn_commit_batch()).  This replaces a global ticket lock
+     *     acquired by each committer in turn.
      */
 
     kcs = kvdb_ctxn_set_h2r(ctxn->ctxn_kvdb_ctxn_set);
 
-    /* Prefetch priv to try and avoid a cache miss whithin the critsec.
+    /* Prefetch priv to try and avoid a cache miss in the batch leader.
      */
     priv = (uintptr_t *)ctxn->ctxn_seqref;
     __builtin_prefetch(priv);
 
-    cookie = NULL; /* Set to nil for mapi */
-
-    /* The critical section demarcated by the keylock_list_{lock/unlock}
-     * calls provide mutual exclusion only for the list referenced by
-     * cookie, and ensures that keylocks are queued to their respective
-     * lists in commit sequence number order.  Additionally, the list
-     * lock limits concurrency through this section to only a handful
-     * of CPUs (currently 4 as defined by KVDB_DLOCK_MAX) which helps
-     * to relive contention on the ticket lock.
+    /* Join the next commit batch.  If there is no active batch leader
+     * then we become the leader, otherwise we wait (spinning only on
+     * our own ctxn) until the leader either commits our batch or hands
+     * leadership of the next batch to us.
      */
-    kvdb_keylock_list_lock(ctxn->ctxn_kvdb_keylock, &cookie);
+    atomic_set(&ctxn->ctxn_commit_state, CTXN_COMMIT_WAIT);
 
-    /* The commit ticket lock (tseqno head/tail) ensures that commit sequence
-     * numbers are minted and made visible in ticket order.  Acquire semantics
-     * on the increment of tseqno head ensure that it is always incremented
-     * before commit_sn is computed.  This ticket lock is also used by
-     * kvdb_ctxn_set_wait_commit() to ensure visibility of a view seqno
-     * obtained asynchronously with respect to this critical section.
-     */
-    head = atomic_fetch_add(&kcs->ktn_tseqno_head, 1); /* acquire next ticket */
+    spin_lock(&kcs->ktn_commit_lock);
+    list_add_tail(&ctxn->ctxn_commit_link, &kcs->ktn_commit_list);
+    lead = !kcs->ktn_commit_leader;
+    kcs->ktn_commit_leader = true;
+    spin_unlock(&kcs->ktn_commit_lock);
 
-    while (atomic_read(&kcs->ktn_tseqno_tail) < head)
-        cpu_relax(); /* wait for our ticket to be served */
+    if (!lead) {
+        int state;
 
-    commit_sn = 1 + atomic_fetch_add(ctxn->ctxn_kvdb_seq_addr, 2);
+        while ((state = atomic_read_acq(&ctxn->ctxn_commit_state)) == CTXN_COMMIT_WAIT)
+            cpu_relax();
 
-    /* The assignment through *priv gives all the values associated
-     * with this transaction an ordinal sequence number. Each of
-     * those values has their own pointer to the ordinal value.
-     */
-    ref = HSE_ORDNL_TO_SQNREF(commit_sn);
-    *priv = ref;
+        lead = (state == CTXN_COMMIT_LEAD);
+    }
+
+    if (lead)
+        kvdb_ctxn_commit_batch(kcs, ctxn);
 
-    atomic_inc_rel(&kcs->ktn_tseqno_tail); /* release ticket lock */
+    assert(atomic_read(&ctxn->ctxn_commit_state) == CTXN_COMMIT_DONE);
 
     /* Once the indirect assignment has been performed the
      * transaction itself no longer needs to see the shared value
@@ -601,25 +707,23 @@ kvdb_ctxn_commit(struct kvdb_ctxn *handle)
      * preserved until the transaction is reused and allows us to
      * remember that the state of the transaction is "committed".
      */
-    ctxn->ctxn_seqref = ref;
+    commit_sn = ctxn->ctxn_commit_sn;
+    ctxn->ctxn_seqref = HSE_ORDNL_TO_SQNREF(commit_sn);
     c0snr_clear_txn(priv);
 
+    /* The batch leader took ownership of our write locks if we
+     * acquired any, otherwise we must dispose of the empty set.
+     */
     locks = ctxn->ctxn_locks_handle;
     ctxn->ctxn_locks_handle = NULL;
 
-    if (kvdb_ctxn_locks_count(locks) > 0) {
-        kvdb_keylock_enqueue_locks(locks, commit_sn, cookie);
-        locks = NULL;
-    }
-    kvdb_keylock_list_unlock(cookie);
-
     if (locks)
         kvdb_ctxn_locks_destroy(locks);
 
     kvdb_ctxn_bind_cancel(bind);
 
-    err = wal_txn_commit(ctxn->ctxn_wal, ctxn->ctxn_view_seqno, commit_sn, head,
-                         ctxn->ctxn_wal_cookie);
+    err = wal_txn_commit(ctxn->ctxn_wal, ctxn->ctxn_view_seqno, commit_sn,
+                         ctxn->ctxn_commit_tsn, ctxn->ctxn_wal_cookie);
 
     kvdb_ctxn_pfxlock_seqno_pub(ctxn->ctxn_pfxlock_handle, commit_sn);
 
@@ -724,6 +828,10 @@ kvdb_ctxn_set_create(struct kvdb_ctxn_set **handle_out, u64 txn_timeout_ms, u64
     ktn->txn_wkth_delay = msecs_to_jiffies(delay_msecs);
     INIT_DELAYED_WORK(&ktn->ktn_dwork, kvdb_ctxn_reaper);
 
+    spin_lock_init(&ktn->ktn_commit_lock);
+    INIT_LIST_HEAD(&ktn->ktn_commit_list);
+    ktn->ktn_commit_leader = false;
+
     mutex_init(&ktn->ktn_list_mutex);
     CDS_INIT_LIST_HEAD(&ktn->ktn_alloc_list);
     INIT_LIST_HEAD(&ktn->ktn_pending);
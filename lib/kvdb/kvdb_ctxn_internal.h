@@ -36,6 +36,10 @@
  * @ctxn_alloc_link:          used to queue onto KVDB allocated txn list
  * @ctxn_free_link:           used to queue onto the list of txns to be freed
  * @ctxn_abort_link:
+ * @ctxn_commit_link:         used to join a group commit batch
+ * @ctxn_commit_state:        group commit state (wait, lead, or done)
+ * @ctxn_commit_sn:           commit seqno assigned by the batch leader
+ * @ctxn_commit_tsn:          commit ticket assigned by the batch leader
  */
 struct kvdb_ctxn_impl {
     struct kvdb_ctxn        ctxn_inner_handle;
@@ -65,6 +69,11 @@ struct kvdb_ctxn_impl {
     struct list_head        ctxn_abort_link;
     u64                     ctxn_begin_ts;
     bool                    ctxn_expired;
+
+    struct list_head        ctxn_commit_link HSE_ACP_ALIGNED;
+    atomic_int              ctxn_commit_state;
+    u64                     ctxn_commit_sn;
+    u64                     ctxn_commit_tsn;
 };
 
 /* clang-format on */
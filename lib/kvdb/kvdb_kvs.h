@@ -23,8 +23,8 @@ struct kvdb_kvs;
  * struct kvdb_kvs - Describes a kvs in the kvdb - open or closed
  * @kk_ikvs:         kvs handle. NULL if closed.
  * @kk_parent:       pointer to parent kvdb_impl instance.
+ * @kk_vcomp_deferred: defer default value compression to c0 ingest
  * @kk_vcompbnd:     compression output buffer size estimate for tls_vbuf[]
- * @kk_vcompress:    ptr to value compression function
  * @kk_cnid:         id of the cn associated with kvdb.
  * @kk_cparams:      cn's create-time parameters.
  * @kk_flags:        flags for cn.
@@ -37,8 +37,8 @@ struct kvdb_kvs {
     struct viewset         *kk_viewset;
     struct ikvdb_impl      *kk_parent;
     enum vcomp_default      kk_vcomp_default;
+    bool                    kk_vcomp_deferred;
     u32                     kk_vcompbnd;
-    compress_op_compress_t *kk_vcompress;
     u64                     kk_cnid;
     struct kvs_cparams     *kk_cparams;
     u32                     kk_flags;
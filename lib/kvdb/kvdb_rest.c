@@ -36,6 +36,7 @@
 #include <hse/ikvdb/kvdb_rparams.h>
 #include <hse/ikvdb/csched.h>
 #include <hse/ikvdb/hse_gparams.h>
+#include <hse/ikvdb/slowop.h>
 
 #include "kvdb_rest.h"
 #include "kvdb_kvs.h"
@@ -47,6 +48,7 @@
 #define ENDPOINT_FMT_KVDB_MCLASS   "/kvdbs/%s/mclass/%s"
 #define ENDPOINT_FMT_KVDB_PARAMS   "/kvdbs/%s/params"
 #define ENDPOINT_FMT_KVDB_PERFC    "/kvdbs/%s/perfc"
+#define ENDPOINT_FMT_KVDB_SLOWOPS  "/kvdbs/%s/slowops"
 #define ENDPOINT_FMT_KVS_PARAMS    "/kvdbs/%s/kvs/%s/params"
 #define ENDPOINT_FMT_KVS_PERFC     "/kvdbs/%s/kvs/%s/perfc"
 
@@ -451,6 +453,59 @@ out:
     return status;
 }
 
+static enum rest_status
+rest_kvdb_get_slowops(
+    const struct rest_request *const req,
+    struct rest_response *const resp,
+    void *const ctx)
+{
+    char *data;
+    merr_t err;
+    cJSON *root;
+    bool pretty;
+    struct ikvdb *kvdb;
+    struct slowop_log *log;
+    enum rest_status status;
+
+    INVARIANT(req);
+    INVARIANT(resp);
+    INVARIANT(ctx);
+
+    kvdb = ctx;
+
+    err = rest_params_get(req->rr_params, "pretty", &pretty, false);
+    if (ev(err))
+        return rest_response_perror(resp, REST_STATUS_BAD_REQUEST,
+            "The 'pretty' query parameter must be a boolean", merr(EINVAL));
+
+    log = ikvdb_slowop_log(kvdb);
+    if (ev(!log))
+        return rest_response_perror(resp, REST_STATUS_NOT_FOUND,
+            "Slow operation log does not exist", merr(ENOENT));
+
+    err = slowop_log_emit(log, &root);
+    if (ev(err))
+        return rest_response_perror(resp, REST_STATUS_SERVICE_UNAVAILABLE, "Out of memory", err);
+
+    data = (pretty ? cJSON_Print : cJSON_PrintUnformatted)(root);
+    if (ev(!data)) {
+        status = rest_response_perror(resp, REST_STATUS_SERVICE_UNAVAILABLE, "Out of memory",
+            merr(ENOMEM));
+        goto out;
+    }
+
+    fputs(data, resp->rr_stream);
+    cJSON_free(data);
+
+    rest_headers_set(resp->rr_headers, REST_HEADER_CONTENT_TYPE, REST_APPLICATION_JSON);
+    status = REST_STATUS_OK;
+
+out:
+    cJSON_Delete(root);
+
+    return status;
+}
+
 static enum rest_status
 rest_kvs_params_get(
     const struct rest_request *const req,
@@ -893,6 +948,9 @@ kvdb_rest_add_endpoints(struct ikvdb *const kvdb)
         {
             [REST_METHOD_GET] = rest_kvdb_get_perfc,
         },
+        {
+            [REST_METHOD_GET] = rest_kvdb_get_slowops,
+        },
     };
 
     merr_t err = 0;
@@ -954,6 +1012,13 @@ kvdb_rest_add_endpoints(struct ikvdb *const kvdb)
         return err;
     }
 
+    err = rest_server_add_endpoint(REST_ENDPOINT_EXACT, handlers[7], kvdb,
+        ENDPOINT_FMT_KVDB_SLOWOPS, alias);
+    if (err) {
+        log_errx("Failed to add REST endpoint (" ENDPOINT_FMT_KVDB_SLOWOPS ")", err, alias);
+        return err;
+    }
+
     return 0;
 }
 
@@ -974,6 +1039,7 @@ kvdb_rest_remove_endpoints(struct ikvdb *const kvdb)
         rest_server_remove_endpoint(ENDPOINT_FMT_KVDB_MCLASS, alias, hse_mclass_name_get(i));
     rest_server_remove_endpoint(ENDPOINT_FMT_KVDB_PARAMS, alias);
     rest_server_remove_endpoint(ENDPOINT_FMT_KVDB_PERFC, alias);
+    rest_server_remove_endpoint(ENDPOINT_FMT_KVDB_SLOWOPS, alias);
 }
 
 merr_t
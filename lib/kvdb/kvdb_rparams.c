@@ -738,6 +738,27 @@ static const struct param_spec pspecs[] = {
             },
         },
     },
+    {
+        .ps_name = "slowop_thresh_us",
+        .ps_description = "trace operations slower than this (us, 0: disable)",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL | PARAM_FLAG_WRITABLE,
+        .ps_type = PARAM_TYPE_U64,
+        .ps_offset = offsetof(struct kvdb_rparams, slowop_thresh_us),
+        .ps_size = PARAM_SZ(struct kvdb_rparams, slowop_thresh_us),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_uscalar = 0,
+        },
+        .ps_bounds = {
+            .as_uscalar = {
+                .ps_min = 0,
+                .ps_max = UINT64_MAX,
+            },
+        },
+    },
     {
         .ps_name = "cndb_compact_hwm_pct",
         .ps_description = "CNDB compaction high water mark percentage",
@@ -906,6 +927,90 @@ static const struct param_spec pspecs[] = {
             },
         },
     },
+    {
+        .ps_name = "csched_vgc_pct",
+        .ps_description = "vblock garbage percentage at which garbage collection rewrites a vblock",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL | PARAM_FLAG_WRITABLE,
+        .ps_type = PARAM_TYPE_U8,
+        .ps_offset = offsetof(struct kvdb_rparams, csched_vgc_pct),
+        .ps_size = PARAM_SZ(struct kvdb_rparams, csched_vgc_pct),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_uscalar = 50,
+        },
+        .ps_bounds = {
+            .as_uscalar = {
+                .ps_min = 0,   /* disable vblock garbage collection */
+                .ps_max = 100,
+            },
+        },
+    },
+    {
+        .ps_name = "csched_hot_rate",
+        .ps_description = "leaf node hits per second at which its data moves to the root media class",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL | PARAM_FLAG_WRITABLE,
+        .ps_type = PARAM_TYPE_U32,
+        .ps_offset = offsetof(struct kvdb_rparams, csched_hot_rate),
+        .ps_size = PARAM_SZ(struct kvdb_rparams, csched_hot_rate),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_uscalar = 0,
+        },
+        .ps_bounds = {
+            .as_uscalar = {
+                .ps_min = 0,   /* disable hot leaf node migration */
+                .ps_max = UINT32_MAX,
+            },
+        },
+    },
+    {
+        .ps_name = "csched_hot_staging_pct",
+        .ps_description = "percentage of the staging media class that hot leaf nodes may occupy",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL | PARAM_FLAG_WRITABLE,
+        .ps_type = PARAM_TYPE_U8,
+        .ps_offset = offsetof(struct kvdb_rparams, csched_hot_staging_pct),
+        .ps_size = PARAM_SZ(struct kvdb_rparams, csched_hot_staging_pct),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_uscalar = 50,
+        },
+        .ps_bounds = {
+            .as_uscalar = {
+                .ps_min = 0,
+                .ps_max = 100,
+            },
+        },
+    },
+    {
+        .ps_name = "csched_hot_pmem_pct",
+        .ps_description = "percentage of the pmem media class that hot leaf nodes may occupy",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL | PARAM_FLAG_WRITABLE,
+        .ps_type = PARAM_TYPE_U8,
+        .ps_offset = offsetof(struct kvdb_rparams, csched_hot_pmem_pct),
+        .ps_size = PARAM_SZ(struct kvdb_rparams, csched_hot_pmem_pct),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_uscalar = 50,
+        },
+        .ps_bounds = {
+            .as_uscalar = {
+                .ps_min = 0,
+                .ps_max = 100,
+            },
+        },
+    },
     {
         .ps_name = "csched_max_vgroups",
         .ps_description = "leaf-scatter-remediation trigger threshold",
@@ -1104,6 +1209,27 @@ static const struct param_spec pspecs[] = {
             .as_bool = false,
         },
     },
+    {
+        .ps_name = "durability.replay.threads",
+        .ps_description = "Number of threads applying WAL records to c0 during replay",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL,
+        .ps_type = PARAM_TYPE_U32,
+        .ps_offset = offsetof(struct kvdb_rparams, dur_replay_threads),
+        .ps_size = PARAM_SZ(struct kvdb_rparams, dur_replay_threads),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_uscalar = HSE_WAL_REPLAY_THREADS_DFLT,
+        },
+        .ps_bounds = {
+            .as_uscalar = {
+                .ps_min = HSE_WAL_REPLAY_THREADS_MIN,
+                .ps_max = HSE_WAL_REPLAY_THREADS_MAX,
+            },
+        },
+    },
     {
         .ps_name = "durability.size_bytes",
         .ps_description = "Maximum amount of application data lost in the event of a crash",
@@ -1470,6 +1596,48 @@ static const struct param_spec pspecs[] = {
             },
         },
     },
+    {
+        .ps_name = "cn_spill_threads",
+        .ps_description = "max number of threads per root spill (0 disables parallel spills)",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL,
+        .ps_type = PARAM_TYPE_U16,
+        .ps_offset = offsetof(struct kvdb_rparams, cn_spill_threads),
+        .ps_size = PARAM_SZ(struct kvdb_rparams, cn_spill_threads),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_uscalar = 4,
+        },
+        .ps_bounds = {
+            .as_uscalar = {
+                .ps_min = 0,
+                .ps_max = 64,
+            },
+        },
+    },
+    {
+        .ps_name = "cn_bcache_size_mb",
+        .ps_description = "size of the cn block cache in MiB (0: disable)",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL,
+        .ps_type = PARAM_TYPE_U32,
+        .ps_offset = offsetof(struct kvdb_rparams, cn_bcache_size_mb),
+        .ps_size = PARAM_SZ(struct kvdb_rparams, cn_bcache_size_mb),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_uscalar = 0,
+        },
+        .ps_bounds = {
+            .as_uscalar = {
+                .ps_min = 0,
+                .ps_max = 1024 * 1024,
+            },
+        },
+    },
     {
         .ps_name = "keylock_tables",
         .ps_description = "number of keylock tables",
@@ -0,0 +1,288 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <bsd/string.h>
+#include <cjson/cJSON.h>
+
+#include <hse/limits.h>
+
+#include <hse/error/merr.h>
+#include <hse/util/event_counter.h>
+#include <hse/util/fmt.h>
+#include <hse/util/minmax.h>
+#include <hse/util/platform.h>
+#include <hse/util/spinlock.h>
+#include <hse/util/time.h>
+
+#include <hse/ikvdb/slowop.h>
+
+/* Records are appended to the ring of the calling thread's cpu, so a burst
+ * of slow operations on one cpu overwrites only that cpu's history.
+ */
+#define SLOWOP_RINGS_MAX    (16)
+#define SLOWOP_RING_RECS    (32)
+#define SLOWOP_KEY_MAX      (32)
+
+thread_local struct slowop_tls slowop_tls;
+
+static const char * const slowop_type_names[] = {
+    [SLOWOP_GET] = "get",
+    [SLOWOP_PUT] = "put",
+    [SLOWOP_DEL] = "delete",
+    [SLOWOP_CURSOR_CREATE] = "cursor_create",
+    [SLOWOP_CURSOR_SEEK] = "cursor_seek",
+    [SLOWOP_CURSOR_READ] = "cursor_read",
+    [SLOWOP_TXN_COMMIT] = "txn_commit",
+};
+
+static const char * const slowop_stat_names[] = {
+    [SLOWOP_C0_NS] = "c0_ns",
+    [SLOWOP_LC_NS] = "lc_ns",
+    [SLOWOP_CN_NS] = "cn_ns",
+    [SLOWOP_CN_NODES] = "cn_nodes",
+    [SLOWOP_KVSETS] = "kvsets",
+    [SLOWOP_BLOOM_FP] = "bloom_fp",
+    [SLOWOP_THROTTLE_NS] = "throttle_ns",
+    [SLOWOP_MINFLT] = "minflt",
+    [SLOWOP_MAJFLT] = "majflt",
+    [SLOWOP_INBLOCK] = "inblock",
+};
+
+static_assert(NELEM(slowop_type_names) == SLOWOP_TYPE_CNT, "slowop_type_names out of sync");
+static_assert(NELEM(slowop_stat_names) == SLOWOP_STAT_CNT, "slowop_stat_names out of sync");
+
+/**
+ * struct slowop_rec - a recorded slow operation
+ * @sr_time_us: wall clock time at which the operation finished
+ * @sr_lat_ns:  operation latency
+ * @sr_op:      operation type
+ * @sr_cpu:     cpu on which the operation finished
+ * @sr_tid:     thread ID
+ * @sr_klen:    full length of the key
+ * @sr_kvs:     kvs name
+ * @sr_key:     first SLOWOP_KEY_MAX bytes of the key
+ * @sr_statv:   per-stage statistics
+ */
+struct slowop_rec {
+    uint64_t sr_time_us;
+    uint64_t sr_lat_ns;
+    uint32_t sr_op;
+    uint32_t sr_cpu;
+    uint32_t sr_tid;
+    uint32_t sr_klen;
+    char     sr_kvs[HSE_KVS_NAME_LEN_MAX];
+    uint8_t  sr_key[SLOWOP_KEY_MAX];
+    uint64_t sr_statv[SLOWOP_STAT_CNT];
+};
+
+struct slowop_ring {
+    spinlock_t        sr_lock HSE_ACP_ALIGNED;
+    uint64_t          sr_cnt;
+    struct slowop_rec sr_recv[SLOWOP_RING_RECS];
+};
+
+struct slowop_log {
+    struct slowop_ring sl_ringv[SLOWOP_RINGS_MAX];
+};
+
+void
+slowop_trace_start(struct slowop *so, uint64_t thresh_us)
+{
+    struct rusage ru;
+
+    if (slowop_tls.st_active)
+        return;
+
+    memset(slowop_tls.st_statv, 0, sizeof(slowop_tls.st_statv));
+
+    getrusage(RUSAGE_THREAD, &ru);
+    so->so_minflt = ru.ru_minflt;
+    so->so_majflt = ru.ru_majflt;
+    so->so_inblock = ru.ru_inblock;
+
+    so->so_thresh_ns = thresh_us * 1000;
+    so->so_start = get_time_ns();
+    slowop_tls.st_active = true;
+}
+
+void
+slowop_trace_finish(
+    struct slowop_log *log,
+    struct slowop     *so,
+    enum slowop_type   op,
+    const char        *kvs_name,
+    const void        *key,
+    size_t             klen)
+{
+    struct slowop_ring *ring;
+    struct slowop_rec *rec;
+    struct timespec ts;
+    struct rusage ru;
+    uint64_t lat;
+    uint cpu;
+
+    lat = get_time_ns() - so->so_start;
+    slowop_tls.st_active = false;
+
+    if (lat < so->so_thresh_ns || !log)
+        return;
+
+    getrusage(RUSAGE_THREAD, &ru);
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    slowop_tls.st_statv[SLOWOP_MINFLT] = ru.ru_minflt - so->so_minflt;
+    slowop_tls.st_statv[SLOWOP_MAJFLT] = ru.ru_majflt - so->so_majflt;
+    slowop_tls.st_statv[SLOWOP_INBLOCK] = ru.ru_inblock - so->so_inblock;
+
+    cpu = hse_getcpu(NULL);
+    ring = log->sl_ringv + (cpu % SLOWOP_RINGS_MAX);
+
+    spin_lock(&ring->sr_lock);
+    rec = ring->sr_recv + (ring->sr_cnt++ % SLOWOP_RING_RECS);
+
+    rec->sr_time_us = ts.tv_sec * USEC_PER_SEC + ts.tv_nsec / 1000;
+    rec->sr_lat_ns = lat;
+    rec->sr_op = op;
+    rec->sr_cpu = cpu;
+    rec->sr_tid = syscall(SYS_gettid);
+    rec->sr_klen = key ? klen : 0;
+    strlcpy(rec->sr_kvs, kvs_name ? kvs_name : "", sizeof(rec->sr_kvs));
+    if (key)
+        memcpy(rec->sr_key, key, min_t(size_t, klen, sizeof(rec->sr_key)));
+    memcpy(rec->sr_statv, slowop_tls.st_statv, sizeof(rec->sr_statv));
+    spin_unlock(&ring->sr_lock);
+}
+
+merr_t
+slowop_log_create(struct slowop_log **log_out)
+{
+    struct slowop_log *log;
+
+    if (ev(!log_out))
+        return merr(EINVAL);
+
+    log = aligned_alloc(__alignof__(*log), sizeof(*log));
+    if (ev(!log))
+        return merr(ENOMEM);
+
+    memset(log, 0, sizeof(*log));
+
+    for (int i = 0; i < SLOWOP_RINGS_MAX; ++i)
+        spin_lock_init(&log->sl_ringv[i].sr_lock);
+
+    *log_out = log;
+
+    return 0;
+}
+
+void
+slowop_log_destroy(struct slowop_log *log)
+{
+    free(log);
+}
+
+static int
+slowop_rec_cmp(const void *lhs, const void *rhs)
+{
+    const struct slowop_rec *l = lhs;
+    const struct slowop_rec *r = rhs;
+
+    return (l->sr_time_us > r->sr_time_us) - (l->sr_time_us < r->sr_time_us);
+}
+
+static bool
+slowop_rec_emit(const struct slowop_rec *rec, cJSON *root)
+{
+    char key[SLOWOP_KEY_MAX * 3 + 1];
+    cJSON *obj, *stages;
+    bool bad = false;
+
+    obj = cJSON_CreateObject();
+    if (ev(!obj))
+        return false;
+
+    fmt_pe(key, sizeof(key), rec->sr_key, min_t(size_t, rec->sr_klen, sizeof(rec->sr_key)));
+
+    bad |= !cJSON_AddNumberToObject(obj, "timestamp_us", rec->sr_time_us);
+    bad |= !cJSON_AddStringToObject(obj, "op", slowop_type_names[rec->sr_op]);
+    bad |= !cJSON_AddNumberToObject(obj, "latency_ns", rec->sr_lat_ns);
+    bad |= !cJSON_AddNumberToObject(obj, "cpu", rec->sr_cpu);
+    bad |= !cJSON_AddNumberToObject(obj, "tid", rec->sr_tid);
+    bad |= !cJSON_AddStringToObject(obj, "kvs", rec->sr_kvs);
+    bad |= !cJSON_AddStringToObject(obj, "key", key);
+    bad |= !cJSON_AddNumberToObject(obj, "key_length", rec->sr_klen);
+
+    stages = cJSON_AddObjectToObject(obj, "stages");
+    if (stages) {
+        for (int i = 0; i < SLOWOP_STAT_CNT; ++i)
+            bad |= !cJSON_AddNumberToObject(stages, slowop_stat_names[i], rec->sr_statv[i]);
+    } else {
+        bad = true;
+    }
+
+    if (bad || !cJSON_AddItemToArray(root, obj)) {
+        cJSON_Delete(obj);
+        return false;
+    }
+
+    return true;
+}
+
+merr_t
+slowop_log_emit(struct slowop_log *log, cJSON **root_out)
+{
+    struct slowop_rec *recv;
+    cJSON *root;
+    size_t recc;
+
+    if (ev(!log || !root_out))
+        return merr(EINVAL);
+
+    recv = malloc(sizeof(*recv) * SLOWOP_RINGS_MAX * SLOWOP_RING_RECS);
+    if (ev(!recv))
+        return merr(ENOMEM);
+
+    recc = 0;
+
+    for (int i = 0; i < SLOWOP_RINGS_MAX; ++i) {
+        struct slowop_ring *ring = log->sl_ringv + i;
+        size_t n;
+
+        spin_lock(&ring->sr_lock);
+        n = min_t(uint64_t, ring->sr_cnt, SLOWOP_RING_RECS);
+        memcpy(recv + recc, ring->sr_recv, sizeof(*recv) * n);
+        spin_unlock(&ring->sr_lock);
+
+        recc += n;
+    }
+
+    qsort(recv, recc, sizeof(*recv), slowop_rec_cmp);
+
+    root = cJSON_CreateArray();
+    if (ev(!root)) {
+        free(recv);
+        return merr(ENOMEM);
+    }
+
+    for (size_t i = 0; i < recc; ++i) {
+        if (!slowop_rec_emit(recv + i, root)) {
+            cJSON_Delete(root);
+            free(recv);
+            return merr(ENOMEM);
+        }
+    }
+
+    free(recv);
+    *root_out = root;
+
+    return 0;
+}
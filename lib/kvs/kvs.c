@@ -24,14 +24,18 @@
 #include <hse/ikvdb/c0.h>
 #include <hse/ikvdb/lc.h>
 #include <hse/ikvdb/cn.h>
+#include <hse/ikvdb/cn_kvdb.h>
 #include <hse/ikvdb/kvs.h>
+#include <hse/ikvdb/kvs_vcomp.h>
 #include <hse/ikvdb/limits.h>
 #include <hse/ikvdb/key_hash.h>
 #include <hse/ikvdb/kvdb_ctxn.h>
 #include <hse/ikvdb/tuple.h>
 #include <hse/ikvdb/kvdb_health.h>
 #include <hse/ikvdb/cursor.h>
+#include <hse/ikvdb/rtomb.h>
 #include <hse/ikvdb/wal.h>
+#include <hse/ikvdb/slowop.h>
 
 /* clang-format off */
 
@@ -56,6 +60,8 @@ struct perfc_name kvs_pkvsl_perfc_op[] _dt_section = {
     NE(PERFC_LT_PKVSL_KVS_DEL,            5, "kvs_delete latency",         "kvs_del_lat", 7),
     NE(PERFC_LT_PKVSL_KVS_PFX_PROBE,      5, "kvs_prefix_probe latency",   "kvs_pfx_probe_lat", 7),
     NE(PERFC_LT_PKVSL_KVS_PFX_DEL,        5, "kvs_prefix_delete latency",  "kvs_pfx_del_lat", 7),
+    NE(PERFC_LT_PKVSL_KVS_GET_MULTI,      5, "kvs_get_multi latency",      "kvs_get_multi_lat", 7),
+    NE(PERFC_LT_PKVSL_KVS_RANGE_DEL,      5, "kvs_range_delete latency",   "kvs_range_del_lat", 7),
 };
 
 /* clang-format on */
@@ -117,6 +123,7 @@ kvs_perfc_free(struct ikvs *kvs)
  *    Allocator              ->  Freer
  *    ---------                  ------
  *    kvs_create                 kvs_destroy
+ *    kvs_vcomp_open             kvs_vcomp_close
  *    cn_open                    cn_close
  *    c0_open                    c0_close
  *
@@ -168,6 +175,14 @@ kvs_open(
     /* avoid using caller's rp struct.  use our copy in ikvs struct. */
     rp = 0;
 
+    /* Dictionary training is only useful if the kvdb accepts puts.
+     */
+    err = kvs_vcomp_open(ds, cnid, &ikvs->ikv_rp,
+                         (cn_kvdb && ikvdb_allows_user_writes(kvdb)) ? cn_kvdb->cn_maint_wq : NULL,
+                         &ikvs->ikv_vcomp);
+    if (ev(err))
+        goto err_exit;
+
     err = cn_open(
         cn_kvdb,
         ds,
@@ -183,6 +198,8 @@ kvs_open(
     if (ev(err))
         goto err_exit;
 
+    cn_set_vcomp(ikvs->ikv_cn, ikvs->ikv_vcomp);
+
     err = c0_open(kvdb, ikvs->ikv_cn, &ikvs->ikv_c0);
     if (ev(err))
         goto err_exit;
@@ -201,6 +218,7 @@ err_exit:
             c0_close(ikvs->ikv_c0);
         if (ikvs->ikv_cn)
             cn_close(ikvs->ikv_cn);
+        kvs_vcomp_close(ikvs->ikv_vcomp);
         kvs_destroy(ikvs);
     }
 
@@ -223,6 +241,7 @@ kvs_cnid(const struct ikvs *ikvs)
  * Resources freed by kvs_close:
  *    c0_close
  *    cn_close
+ *    kvs_vcomp_close
  *    kvs_destroy
  */
 merr_t
@@ -245,6 +264,8 @@ kvs_close(struct ikvs *ikvs)
     if (err)
         log_errx("cn_close(cn) failed", err);
 
+    kvs_vcomp_close(ikvs->ikv_vcomp);
+
     kvs_perfc_free(ikvs);
 
     kvs_destroy(ikvs);
@@ -279,6 +300,7 @@ kvs_put(
     struct perfc_set *pkvsl_pc = kvs_perfc_pkvsl(kvs);
     struct wal_record rec;
     u64               tstart;
+    u64               sostart;
     u64               seqno;
     merr_t            err;
 
@@ -308,14 +330,20 @@ kvs_put(
             return err;
     }
 
+    sostart = slowop_stage_start();
+
     err = wal_put(kvs->ikv_wal, kvs, kt, vt, seqno, &rec);
 
     if (HSE_LIKELY(!err)) {
         err = c0_put(kvs->ikv_c0, kt, vt, seqnoref);
+        if (!err)
+            cn_rcache_invalidate(kvs->ikv_cn, kt);
 
         wal_op_finish(kvs->ikv_wal, &rec, kt->kt_seqno, kt->kt_dgen, merr_errno(err));
     }
 
+    slowop_stage_end(SLOWOP_C0_NS, sostart);
+
     if (ctxn)
         kvdb_ctxn_unlock(ctxn);
 
@@ -340,6 +368,7 @@ kvs_get(
     struct cn *       cn = kvs->ikv_cn;
     uintptr_t         seqnoref = 0;
     u64               tstart;
+    u64               sostart;
     merr_t            err;
 
     tstart = perfc_lat_start(pkvsl_pc);
@@ -356,22 +385,83 @@ kvs_get(
             return err;
     }
 
+    sostart = slowop_stage_start();
     err = c0_get(c0, kt, seqno, seqnoref, res, vbuf);
+    slowop_stage_end(SLOWOP_C0_NS, sostart);
 
-    if (!err && *res == NOT_FOUND)
+    if (!err && *res == NOT_FOUND) {
+        sostart = slowop_stage_start();
         err = lc_get(lc, c0_index(c0), kvs->ikv_pfx_len, kt, seqno, seqnoref, res, vbuf);
+        slowop_stage_end(SLOWOP_LC_NS, sostart);
+    }
 
     if (ctxn)
         kvdb_ctxn_unlock(ctxn);
 
-    if (!err && *res == NOT_FOUND)
+    if (!err && *res == NOT_FOUND) {
+        sostart = slowop_stage_start();
         err = cn_get(cn, kt, seqno, res, vbuf);
+        slowop_stage_end(SLOWOP_CN_NS, sostart);
+    }
 
     perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_GET, tstart);
 
     return err;
 }
 
+merr_t
+kvs_get_multi(
+    struct ikvs *              kvs,
+    struct hse_kvdb_txn *const txn,
+    uint                       count,
+    struct kvs_ktuple *        ktv,
+    u64                        seqno,
+    enum key_lookup_res *      resv,
+    struct kvs_buf *           vbufv)
+{
+    struct kvdb_ctxn *ctxn = txn ? kvdb_ctxn_h2h(txn) : 0;
+    struct perfc_set *pkvsl_pc = kvs_perfc_pkvsl(kvs);
+    struct lc *       lc = kvs->ikv_lc;
+    uintptr_t         seqnoref = 0;
+    u64               tstart;
+    merr_t            err;
+    uint              i;
+
+    tstart = perfc_lat_start(pkvsl_pc);
+
+    for (i = 0; i < count; ++i) {
+        assert(ktv[i].kt_len >= kvs->ikv_rp.kvs_sfxlen);
+        ktv[i].kt_hash = key_hash64(ktv[i].kt_data, ktv[i].kt_len - kvs->ikv_rp.kvs_sfxlen);
+    }
+
+    /* Exclusively lock txn for query once for the entire batch.
+     * seqnoref is invalid ater lock is released.
+     */
+    if (ctxn) {
+        err = kvdb_ctxn_trylock_read(ctxn, &seqnoref, &seqno);
+        if (err)
+            return err;
+    }
+
+    err = c0_get_multi(kvs->ikv_c0, count, ktv, seqno, seqnoref, resv, vbufv);
+
+    for (i = 0; i < count && !err; ++i) {
+        if (resv[i] == NOT_FOUND)
+            err = lc_get(lc, c0_index(kvs->ikv_c0), kvs->ikv_pfx_len, ktv + i, seqno, seqnoref,
+                         resv + i, vbufv + i);
+    }
+
+    if (ctxn)
+        kvdb_ctxn_unlock(ctxn);
+
+    if (!err)
+        err = cn_get_multi(kvs->ikv_cn, count, ktv, seqno, resv, vbufv);
+
+    perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_GET_MULTI, tstart);
+
+    return err;
+}
+
 merr_t
 kvs_del(struct ikvs *kvs, struct hse_kvdb_txn *const txn, struct kvs_ktuple *kt, uintptr_t seqnoref)
 {
@@ -379,6 +469,7 @@ kvs_del(struct ikvs *kvs, struct hse_kvdb_txn *const txn, struct kvs_ktuple *kt,
     struct kvdb_ctxn *ctxn = txn ? kvdb_ctxn_h2h(txn) : 0;
     struct wal_record rec;
     u64               tstart;
+    u64               sostart;
     u64               seqno;
     merr_t            err;
 
@@ -403,13 +494,19 @@ kvs_del(struct ikvs *kvs, struct hse_kvdb_txn *const txn, struct kvs_ktuple *kt,
             return err;
     }
 
+    sostart = slowop_stage_start();
+
     err = wal_del(kvs->ikv_wal, kvs, kt, seqno, &rec);
     if (!err) {
         err = c0_del(kvs->ikv_c0, kt, seqnoref);
+        if (!err)
+            cn_rcache_invalidate(kvs->ikv_cn, kt);
 
         wal_op_finish(kvs->ikv_wal, &rec, kt->kt_seqno, kt->kt_dgen, merr_errno(err));
     }
 
+    slowop_stage_end(SLOWOP_C0_NS, sostart);
+
     if (ctxn)
         kvdb_ctxn_unlock(ctxn);
 
@@ -456,6 +553,8 @@ kvs_prefix_del(
     err = wal_del_pfx(kvs->ikv_wal, kvs, kt, seqno, &rec);
     if (!err) {
         err = c0_prefix_del(kvs->ikv_c0, kt, seqnoref);
+        if (!err)
+            cn_rcache_invalidate(kvs->ikv_cn, NULL);
 
         wal_op_finish(kvs->ikv_wal, &rec, kt->kt_seqno, kt->kt_dgen, merr_errno(err));
     }
@@ -468,6 +567,48 @@ kvs_prefix_del(
     return ev(err);
 }
 
+merr_t
+kvs_range_del(
+    struct ikvs             *kvs,
+    struct kvs_ktuple       *start,
+    const struct kvs_ktuple *end,
+    uintptr_t                seqnoref)
+{
+    struct perfc_set *pkvsl_pc = kvs_perfc_pkvsl(kvs);
+    struct kvs_vtuple vt;
+    struct wal_record rec;
+    u64               tstart;
+    merr_t            err;
+
+    tstart = perfc_lat_start(pkvsl_pc);
+
+    if (!start->kt_hash)
+        start->kt_hash = key_hash64(start->kt_data, start->kt_len);
+
+    rec.cookie = -1;
+
+    /* The end key is logged as the value of the record.
+     */
+    kvs_vtuple_init(&vt, (void *)end->kt_data, end->kt_len);
+
+    /* Prefix probes consult rtombs only once the kvs may have some.
+     */
+    cn_rtombs_set(kvs->ikv_cn);
+
+    err = wal_del_range(kvs->ikv_wal, kvs, start, &vt, &rec);
+    if (!err) {
+        err = c0_range_del(kvs->ikv_c0, start, end, seqnoref);
+        if (!err)
+            cn_rcache_invalidate(kvs->ikv_cn, NULL);
+
+        wal_op_finish(kvs->ikv_wal, &rec, start->kt_seqno, start->kt_dgen, merr_errno(err));
+    }
+
+    perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_RANGE_DEL, tstart);
+
+    return ev(err);
+}
+
 merr_t
 kvs_pfx_probe(
     struct ikvs *              kvs,
@@ -485,6 +626,7 @@ kvs_pfx_probe(
     struct cn *       cn = kvs->ikv_cn;
     uintptr_t         seqnoref = 0;
     struct query_ctx  qctx = { 0 };
+    struct rtomb_vec  rtombs = { 0 };
     u64               tstart;
     merr_t            err;
 
@@ -501,6 +643,18 @@ kvs_pfx_probe(
             return err;
     }
 
+    /* As with cursors, the rtombs of c0 are collected before those of cn
+     * (see cn_tree_prefix_probe()) so that an rtomb ingested in the interim
+     * is not missed.
+     */
+    if (cn_has_rtombs(cn)) {
+        err = c0_rtombs_get(c0, seqno, &rtombs);
+        if (ev(err))
+            goto exit;
+
+        qctx.rtombs = &rtombs;
+    }
+
     err = c0_pfx_probe(c0, kt, seqno, seqnoref, res, &qctx, kbuf, vbuf);
     if (err || *res == FOUND_PTMB || qctx.seen > 1)
         goto exit;
@@ -518,6 +672,8 @@ exit:
     if (ctxn)
         kvdb_ctxn_unlock(ctxn);
 
+    rtomb_vec_fini(&rtombs, true);
+
     /* If any tombstone was encountered, a tomb_map is created. Free the tomb_map.
      */
     map_destroy(qctx.tomb_map);
@@ -4,7 +4,7 @@
  */
 
 #include <hse/logging/logging.h>
-#include <hse/util/compression_lz4.h>
+#include <hse/ikvdb/vcomp_params.h>
 #include <hse/util/event_counter.h>
 #include <hse/util/fmt.h>
 #include <hse/util/keycmp.h>
@@ -24,6 +24,7 @@
 #include <hse/ikvdb/kvdb_perfc.h>
 #include <hse/ikvdb/tuple.h>
 #include <hse/ikvdb/cursor.h>
+#include <hse/ikvdb/rtomb.h>
 
 #include <c0/c0_cursor.h>
 #include <cn/cn_cursor.h>
@@ -162,6 +163,7 @@ struct kvs_cursor_impl {
 
     struct kvs_cursor_element  kci_elem_last;
     struct kvs_cursor_element  kci_ptomb;
+    struct rtomb_vec           kci_rtombs;
     struct key_obj             kci_last_kobj;
     struct key_obj *           kci_last;
     u8 *                       kci_last_kbuf;
@@ -784,6 +786,14 @@ kvs_cursor_init(struct hse_kvs_cursor *cursor, struct kvdb_ctxn *ctxn)
 
     assert(cur->kci_c0cur);
 
+    /* Collect c0's rtombs before creating/updating the cn cursor so that
+     * an rtomb ingested in the interim is found in cn.
+     */
+    rtomb_vec_fini(&cur->kci_rtombs, true);
+    err = c0_rtombs_get(c0, seqno, &cur->kci_rtombs);
+    if (ev(err))
+        goto error;
+
     if (!cur->kci_lccur) {
         u16       skidx = c0_index(c0);
         s32       tree_pfxlen = c0_get_pfx_len(c0);
@@ -883,6 +893,8 @@ kvs_cursor_destroy(struct hse_kvs_cursor *handle)
     if (cursor->kci_bh)
         bin_heap_destroy(cursor->kci_bh);
 
+    rtomb_vec_fini(&cursor->kci_rtombs, true);
+
     vlb_free(cursor, kvs_cursor_impl_alloc_sz);
 }
 
@@ -934,6 +946,11 @@ kvs_cursor_update(struct hse_kvs_cursor *handle, struct kvdb_ctxn *ctxn, u64 seq
     if (flags & CURSOR_FLAG_SEQNO_CHANGE)
         perfc_inc(cursor->kci_cc_pc, PERFC_BA_CC_UPDATED_C0);
 
+    rtomb_vec_fini(&cursor->kci_rtombs, true);
+    cursor->kci_err = c0_rtombs_get(cursor->kci_kvs->ikv_c0, seqno, &cursor->kci_rtombs);
+    if (ev(cursor->kci_err))
+        return cursor->kci_err;
+
     /* Update lc cursor */
     cursor->kci_err =
         lc_cursor_update(cursor->kci_lccur, cursor->kci_last_kbuf, cursor->kci_last_klen, seqno);
@@ -1006,6 +1023,33 @@ ikvs_cursor_should_drop(struct kvs_cursor_element *item, struct kvs_cursor_eleme
     return true;
 }
 
+/* Check whether the item is deleted by a range tombstone from either c0
+ * or cn that is visible in the cursor's view.
+ */
+static bool
+ikvs_cursor_rtomb_drop(struct kvs_cursor_impl *cursor, struct kvs_cursor_element *item)
+{
+    const struct rtomb_vec *cnrv = cn_cursor_rtombs(cursor->kci_cncur);
+    u8                      kbuf[HSE_KVS_KEY_LEN_MAX];
+    uint                    klen;
+    u64                     view = cursor->kci_handle.kc_seq;
+    u64                     elem_seqno, rt_seqno;
+
+    if (cursor->kci_rtombs.rv_cnt == 0 && (!cnrv || cnrv->rv_cnt == 0))
+        return false;
+
+    /* Elements from active txns are newer than any rtomb in the view. */
+    if (seqnoref_to_seqno(item->kce_seqnoref, &elem_seqno) != HSE_SQNREF_STATE_DEFINED)
+        return false;
+
+    key_obj_copy(kbuf, sizeof(kbuf), &klen, &item->kce_kobj);
+
+    rt_seqno = max_t(u64, rtomb_vec_lookup(&cursor->kci_rtombs, kbuf, klen, view),
+                     rtomb_vec_lookup(cnrv, kbuf, klen, view));
+
+    return rt_seqno > elem_seqno;
+}
+
 merr_t
 ikvs_cursor_replenish(struct kvs_cursor_impl *cursor)
 {
@@ -1047,6 +1091,9 @@ ikvs_cursor_replenish(struct kvs_cursor_impl *cursor)
             }
         }
 
+        if (!is_tomb && ikvs_cursor_rtomb_drop(cursor, &cursor->kci_elem_last))
+            is_tomb = true;
+
         if (is_ptomb) {
             cursor->kci_ptomb = cursor->kci_elem_last;
             cursor->kci_ptomb_set = 1;
@@ -1166,7 +1213,7 @@ kvs_cursor_val_copy(
     if (clen) {
         uint outlen;
 
-        err = compress_lz4_ops.cop_decompress(vt->vt_data, clen, buf, bufsz, &outlen);
+        err = vcomp_decompress(vt->vt_data, clen, buf, bufsz, &outlen);
         if (ev(err))
             return err;
 
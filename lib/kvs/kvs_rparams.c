@@ -10,6 +10,8 @@
 
 #include <bsd/string.h>
 
+#include <hse/limits.h>
+
 #include <hse/util/assert.h>
 #include <hse/util/compiler.h>
 #include <hse/logging/logging.h>
@@ -117,6 +119,180 @@ compression_default_jsonify(const struct param_spec *const ps, const void *const
     abort();
 }
 
+static bool HSE_NONNULL(1, 2, 3)
+compression_algorithm_converter(
+    const struct param_spec *const ps,
+    const cJSON *const             node,
+    void *const                    data)
+{
+    const char *value;
+
+    INVARIANT(ps);
+    INVARIANT(node);
+    INVARIANT(data);
+
+    if (!cJSON_IsString(node))
+        return false;
+
+    value = cJSON_GetStringValue(node);
+    if (strcmp(value, VCOMP_PARAM_LZ4) == 0) {
+        *(enum vcomp_algorithm *)data = VCOMP_ALGO_LZ4;
+    } else if (strcmp(value, VCOMP_PARAM_ZSTD) == 0) {
+        *(enum vcomp_algorithm *)data = VCOMP_ALGO_ZSTD;
+    } else {
+        log_err("Unknown compression algorithm value: %s", value);
+        return false;
+    }
+
+    return true;
+}
+
+static merr_t
+compression_algorithm_stringify(
+    const struct param_spec *const ps,
+    const void *const              value,
+    char *const                    buf,
+    const size_t                   buf_sz,
+    size_t *const                  needed_sz)
+{
+    int n;
+    enum vcomp_algorithm algo;
+    const char *param = NULL;
+
+    INVARIANT(ps);
+    INVARIANT(value);
+    INVARIANT(buf);
+
+    algo = *(enum vcomp_algorithm *)value;
+
+    switch (algo) {
+    case VCOMP_ALGO_LZ4:
+        param = VCOMP_PARAM_LZ4;
+        break;
+    case VCOMP_ALGO_ZSTD:
+        param = VCOMP_PARAM_ZSTD;
+        break;
+    }
+
+    assert(param);
+
+    n = snprintf(buf, buf_sz, "\"%s\"", param);
+    if (n < 0)
+        return merr(EBADMSG);
+
+    if (needed_sz)
+        *needed_sz = n;
+
+    return 0;
+}
+
+static cJSON *
+compression_algorithm_jsonify(const struct param_spec *const ps, const void *const value)
+{
+    enum vcomp_algorithm algo;
+
+    INVARIANT(ps);
+    INVARIANT(value);
+
+    algo = *(enum vcomp_algorithm *)value;
+
+    switch (algo) {
+        case VCOMP_ALGO_LZ4:
+            return cJSON_CreateString(VCOMP_PARAM_LZ4);
+        case VCOMP_ALGO_ZSTD:
+            return cJSON_CreateString(VCOMP_PARAM_ZSTD);
+    }
+
+    abort();
+}
+
+static bool HSE_NONNULL(1, 2, 3)
+cn_bloom_type_converter(
+    const struct param_spec *const ps,
+    const cJSON *const             node,
+    void *const                    data)
+{
+    const char *value;
+
+    INVARIANT(ps);
+    INVARIANT(node);
+    INVARIANT(data);
+
+    if (!cJSON_IsString(node))
+        return false;
+
+    value = cJSON_GetStringValue(node);
+    if (strcmp(value, CN_BLOOM_TYPE_PARAM_BLOCKED) == 0) {
+        *(enum cn_bloom_type *)data = CN_BLOOM_TYPE_BLOCKED;
+    } else if (strcmp(value, CN_BLOOM_TYPE_PARAM_FUSE) == 0) {
+        *(enum cn_bloom_type *)data = CN_BLOOM_TYPE_FUSE;
+    } else {
+        log_err("Unknown bloom type value: %s", value);
+        return false;
+    }
+
+    return true;
+}
+
+static merr_t
+cn_bloom_type_stringify(
+    const struct param_spec *const ps,
+    const void *const              value,
+    char *const                    buf,
+    const size_t                   buf_sz,
+    size_t *const                  needed_sz)
+{
+    int n;
+    enum cn_bloom_type type;
+    const char *param = NULL;
+
+    INVARIANT(ps);
+    INVARIANT(value);
+    INVARIANT(buf);
+
+    type = *(enum cn_bloom_type *)value;
+
+    switch (type) {
+    case CN_BLOOM_TYPE_BLOCKED:
+        param = CN_BLOOM_TYPE_PARAM_BLOCKED;
+        break;
+    case CN_BLOOM_TYPE_FUSE:
+        param = CN_BLOOM_TYPE_PARAM_FUSE;
+        break;
+    }
+
+    assert(param);
+
+    n = snprintf(buf, buf_sz, "\"%s\"", param);
+    if (n < 0)
+        return merr(EBADMSG);
+
+    if (needed_sz)
+        *needed_sz = n;
+
+    return 0;
+}
+
+static cJSON *
+cn_bloom_type_jsonify(const struct param_spec *const ps, const void *const value)
+{
+    enum cn_bloom_type type;
+
+    INVARIANT(ps);
+    INVARIANT(value);
+
+    type = *(enum cn_bloom_type *)value;
+
+    switch (type) {
+        case CN_BLOOM_TYPE_BLOCKED:
+            return cJSON_CreateString(CN_BLOOM_TYPE_PARAM_BLOCKED);
+        case CN_BLOOM_TYPE_FUSE:
+            return cJSON_CreateString(CN_BLOOM_TYPE_PARAM_FUSE);
+    }
+
+    abort();
+}
+
 static const struct param_spec pspecs[] = {
     {
         .ps_name = "kvs_cursor_ttl",
@@ -443,6 +619,48 @@ static const struct param_spec pspecs[] = {
             },
         },
     },
+    {
+        .ps_name = "cn_get_aio_depth",
+        .ps_description = "max direct value reads in flight per batched get (0: disable)",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL | PARAM_FLAG_WRITABLE,
+        .ps_type = PARAM_TYPE_U32,
+        .ps_offset = offsetof(struct kvs_rparams, cn_get_aio_depth),
+        .ps_size = PARAM_SZ(struct kvs_rparams, cn_get_aio_depth),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_uscalar = 32,
+        },
+        .ps_bounds = {
+            .as_uscalar = {
+                .ps_min = 0,
+                .ps_max = 1024,
+            },
+        },
+    },
+    {
+        .ps_name = "cn_rcache_size_mb",
+        .ps_description = "point lookup result cache size (MiB, 0: disable)",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL,
+        .ps_type = PARAM_TYPE_U32,
+        .ps_offset = offsetof(struct kvs_rparams, cn_rcache_size_mb),
+        .ps_size = PARAM_SZ(struct kvs_rparams, cn_rcache_size_mb),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_uscalar = 0,
+        },
+        .ps_bounds = {
+            .as_uscalar = {
+                .ps_min = 0,
+                .ps_max = 64 * 1024,
+            },
+        },
+    },
     {
         .ps_name = "cn_mcache_kra_params",
         .ps_description = "kblock readahead [willneed]",
@@ -530,6 +748,21 @@ static const struct param_spec pspecs[] = {
             .as_uscalar = false,
         },
     },
+    {
+        .ps_name = "cn_mcache_lazy",
+        .ps_description = "defer wbtree and bloom preload of kvsets restored at open until first access",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL,
+        .ps_type = PARAM_TYPE_BOOL,
+        .ps_offset = offsetof(struct kvs_rparams, cn_mcache_lazy),
+        .ps_size = PARAM_SZ(struct kvs_rparams, cn_mcache_lazy),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_uscalar = false,
+        },
+    },
     {
         .ps_name = "cn_bloom_prob",
         .ps_description = "bloom create probability",
@@ -572,6 +805,120 @@ static const struct param_spec pspecs[] = {
             },
         },
     },
+    {
+        .ps_name = "cn_bloom_prob_root",
+        .ps_description = "bloom create probability for root node kvsets (0: use cn_bloom_prob)",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL,
+        .ps_type = PARAM_TYPE_U64,
+        .ps_offset = offsetof(struct kvs_rparams, cn_bloom_prob_root),
+        .ps_size = PARAM_SZ(struct kvs_rparams, cn_bloom_prob_root),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_uscalar = 0,
+        },
+        .ps_bounds = {
+            .as_uscalar = {
+                .ps_min = 0,
+                .ps_max = UINT64_MAX,
+            },
+        },
+    },
+    {
+        .ps_name = "cn_bloom_prob_leaf",
+        .ps_description = "bloom create probability for leaf node kvsets (0: use cn_bloom_prob)",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL,
+        .ps_type = PARAM_TYPE_U64,
+        .ps_offset = offsetof(struct kvs_rparams, cn_bloom_prob_leaf),
+        .ps_size = PARAM_SZ(struct kvs_rparams, cn_bloom_prob_leaf),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_uscalar = 0,
+        },
+        .ps_bounds = {
+            .as_uscalar = {
+                .ps_min = 0,
+                .ps_max = UINT64_MAX,
+            },
+        },
+    },
+    {
+        .ps_name = "cn_bloom_auto",
+        .ps_description = "relax leaf bloom probability per node by observed negative lookup rate",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL,
+        .ps_type = PARAM_TYPE_BOOL,
+        .ps_offset = offsetof(struct kvs_rparams, cn_bloom_auto),
+        .ps_size = PARAM_SZ(struct kvs_rparams, cn_bloom_auto),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_uscalar = false,
+        },
+    },
+    {
+        .ps_name = "cn_bloom_type",
+        .ps_description = "kblock filter type (blocked bloom or binary fuse)",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL,
+        .ps_type = PARAM_TYPE_ENUM,
+        .ps_offset = offsetof(struct kvs_rparams, cn_bloom_type),
+        .ps_size = PARAM_SZ(struct kvs_rparams, cn_bloom_type),
+        .ps_convert = cn_bloom_type_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = cn_bloom_type_stringify,
+        .ps_jsonify = cn_bloom_type_jsonify,
+        .ps_default_value = {
+            .as_enum = CN_BLOOM_TYPE_BLOCKED,
+        },
+        .ps_bounds = {
+            .as_uscalar = {
+                .ps_min = CN_BLOOM_TYPE_MIN,
+                .ps_max = CN_BLOOM_TYPE_MAX,
+            },
+        },
+    },
+    {
+        .ps_name = "cn_bloom_pfx",
+        .ps_description = "build a second kblock filter on key prefixes",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL,
+        .ps_type = PARAM_TYPE_BOOL,
+        .ps_offset = offsetof(struct kvs_rparams, cn_bloom_pfx),
+        .ps_size = PARAM_SZ(struct kvs_rparams, cn_bloom_pfx),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_uscalar = false,
+        },
+    },
+    {
+        .ps_name = "cn_bloom_pfx_len",
+        .ps_description = "prefix filter key length (0: use the kvs prefix length)",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL,
+        .ps_type = PARAM_TYPE_U32,
+        .ps_offset = offsetof(struct kvs_rparams, cn_bloom_pfx_len),
+        .ps_size = PARAM_SZ(struct kvs_rparams, cn_bloom_pfx_len),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_uscalar = 0,
+        },
+        .ps_bounds = {
+            .as_uscalar = {
+                .ps_min = 0,
+                .ps_max = HSE_KVS_PFX_LEN_MAX,
+            },
+        },
+    },
     {
         .ps_name = "cn_compaction_debug",
         .ps_description = "cn compaction debug flags",
@@ -712,6 +1059,126 @@ static const struct param_spec pspecs[] = {
             },
         },
     },
+    {
+        .ps_name = "value.compression.algorithm",
+        .ps_description = "Value compression algorithm (lz4 or zstd)",
+        .ps_flags = 0,
+        .ps_type = PARAM_TYPE_ENUM,
+        .ps_offset = offsetof(struct kvs_rparams, value.compression.algo),
+        .ps_size = PARAM_SZ(struct kvs_rparams, value.compression.algo),
+        .ps_convert = compression_algorithm_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = compression_algorithm_stringify,
+        .ps_jsonify = compression_algorithm_jsonify,
+        .ps_default_value = {
+            .as_enum = VCOMP_ALGO_LZ4,
+        },
+        .ps_bounds = {
+            .as_uscalar = {
+                .ps_min = VCOMP_ALGO_MIN,
+                .ps_max = VCOMP_ALGO_MAX,
+            },
+        },
+    },
+    {
+        .ps_name = "value.compression.level",
+        .ps_description = "Value compression level (zstd only)",
+        .ps_flags = 0,
+        .ps_type = PARAM_TYPE_I32,
+        .ps_offset = offsetof(struct kvs_rparams, value.compression.level),
+        .ps_size = PARAM_SZ(struct kvs_rparams, value.compression.level),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_scalar = 3,
+        },
+        .ps_bounds = {
+            .as_scalar = {
+                .ps_min = -7,
+                .ps_max = 19,
+            },
+        },
+    },
+    {
+        .ps_name = "value.compression.dict_size",
+        .ps_description = "Size of the trained value compression dictionary (zstd only, 0: none)",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL,
+        .ps_type = PARAM_TYPE_U32,
+        .ps_offset = offsetof(struct kvs_rparams, value.compression.dict_size),
+        .ps_size = PARAM_SZ(struct kvs_rparams, value.compression.dict_size),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_uscalar = 0,
+        },
+        .ps_bounds = {
+            .as_uscalar = {
+                .ps_min = 0,
+                .ps_max = 1024 * 1024,
+            },
+        },
+    },
+    {
+        .ps_name = "value.compression.compact",
+        .ps_description = "Recompress values with zstd when compacting into leaf or capacity media",
+        .ps_flags = 0,
+        .ps_type = PARAM_TYPE_ENUM,
+        .ps_offset = offsetof(struct kvs_rparams, value.compression.compact),
+        .ps_size = PARAM_SZ(struct kvs_rparams, value.compression.compact),
+        .ps_convert = compression_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = compression_default_stringify,
+        .ps_jsonify = compression_default_jsonify,
+        .ps_default_value = {
+            .as_enum = VCOMP_DEFAULT_OFF,
+        },
+        .ps_bounds = {
+            .as_uscalar = {
+                .ps_min = VCOMP_DEFAULT_OFF,
+                .ps_max = VCOMP_DEFAULT_ON,
+            },
+        },
+    },
+    {
+        .ps_name = "value.compression.compact_level",
+        .ps_description = "Zstd level used to recompress values during compaction",
+        .ps_flags = 0,
+        .ps_type = PARAM_TYPE_I32,
+        .ps_offset = offsetof(struct kvs_rparams, value.compression.compact_level),
+        .ps_size = PARAM_SZ(struct kvs_rparams, value.compression.compact_level),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_scalar = 9,
+        },
+        .ps_bounds = {
+            .as_scalar = {
+                .ps_min = -7,
+                .ps_max = 19,
+            },
+        },
+    },
+    {
+        .ps_name = "value.compression.deferred",
+        .ps_description = "Compress values during c0 ingest rather than on the put path",
+        .ps_flags = 0,
+        .ps_type = PARAM_TYPE_BOOL,
+        .ps_offset = offsetof(struct kvs_rparams, value.compression.deferred),
+        .ps_size = PARAM_SZ(struct kvs_rparams, value.compression.deferred),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_bool = false,
+        },
+    },
 };
 
 const struct param_spec *
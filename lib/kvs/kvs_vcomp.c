@@ -0,0 +1,578 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <crc32c.h>
+
+#include <hse/util/alloc.h>
+#include <hse/util/assert.h>
+#include <hse/util/atomic.h>
+#include <hse/util/byteorder.h>
+#include <hse/util/compression_lz4.h>
+#include <hse/util/compression_zstd.h>
+#include <hse/util/event_counter.h>
+#include <hse/util/minmax.h>
+#include <hse/util/mutex.h>
+#include <hse/util/platform.h>
+#include <hse/util/workqueue.h>
+#include <hse/logging/logging.h>
+
+#include <hse/ikvdb/kvs_rparams.h>
+#include <hse/ikvdb/kvs_vcomp.h>
+#include <hse/ikvdb/vcomp_params.h>
+#include <hse/mpool/mpool.h>
+
+/* Values larger than this gain little from a dictionary and would crowd
+ * out smaller samples.  Only every VC_SAMPLE_INTERVAL'th eligible value is
+ * sampled so that training reflects more than a short burst of puts.
+ */
+#define VC_SAMPLE_VLEN_MAX      (16 * 1024)
+#define VC_SAMPLE_INTERVAL      (8)
+#define VC_SAMPLE_BUFSZ_MAX     (16ul << 20)
+#define VC_SAMPLE_RATIO         (100)
+#define VC_SAMPLES_MAX          (64 * 1024)
+
+#define VC_DICT_MAGIC           (0x7a646963u) /* ascii "zdic" */
+#define VC_DICT_VERSION         (1)
+#define VC_DICT_LEN_MAX         (1024 * 1024) /* max value.compression.dict_size */
+
+enum vc_state {
+    VC_STATE_NONE,
+    VC_STATE_SAMPLING,
+    VC_STATE_TRAINING,
+    VC_STATE_READY,
+};
+
+/**
+ * struct vcomp_dict_omf - header of a persisted dictionary
+ * @vdo_magic:   VC_DICT_MAGIC
+ * @vdo_version: VC_DICT_VERSION
+ * @vdo_len:     length of the dictionary that follows the header
+ * @vdo_crc:     crc32c of the dictionary
+ */
+struct vcomp_dict_omf {
+    uint32_t vdo_magic;
+    uint32_t vdo_version;
+    uint32_t vdo_len;
+    uint32_t vdo_crc;
+} HSE_PACKED;
+
+/**
+ * struct kvs_vcomp - per-kvs value compression context
+ * @vc_algo:     compression algorithm
+ * @vc_level:    zstd compression level
+ * @vc_cdict:    digested zstd dictionary (NULL until trained or loaded)
+ * @vc_ccdict:   digested zstd dictionary at the compaction level
+ * @vc_state:    dictionary state (enum vc_state)
+ * @vc_nputs:    number of values eligible for sampling
+ * @vc_lock:     protects the sample buffer
+ * @vc_sbuf:     sample buffer
+ * @vc_slen:     bytes used in vc_sbuf
+ * @vc_scap:     size of vc_sbuf
+ * @vc_sizev:    sample lengths
+ * @vc_samplec:  number of samples in vc_sbuf
+ * @vc_dict_sz:  maximum dictionary size
+ * @vc_dict_id:  registered dictionary ID (zero if none)
+ * @vc_dict:     dictionary content (NULL if none)
+ * @vc_dict_len: length of vc_dict
+ * @vc_compact:  recompress values during compaction
+ * @vc_clevel:   zstd level used for recompression
+ * @vc_mp:       mpool in which the dictionary is persisted
+ * @vc_cnid:     cnid of the kvs
+ * @vc_wq:       training workqueue
+ * @vc_work:     training work
+ */
+struct kvs_vcomp {
+    enum vcomp_algorithm     vc_algo;
+    int                      vc_level;
+    ZSTD_CDict * _Atomic     vc_cdict;
+    ZSTD_CDict * _Atomic     vc_ccdict;
+    atomic_int               vc_state;
+    atomic_ulong             vc_nputs HSE_L1D_ALIGNED;
+
+    struct mutex             vc_lock HSE_L1D_ALIGNED;
+    char                    *vc_sbuf;
+    size_t                   vc_slen;
+    size_t                   vc_scap;
+    size_t                  *vc_sizev;
+    uint                     vc_samplec;
+
+    size_t                   vc_dict_sz;
+    uint32_t                 vc_dict_id;
+    void                    *vc_dict;
+    size_t                   vc_dict_len;
+    bool                     vc_compact;
+    int                      vc_clevel;
+    struct mpool            *vc_mp;
+    uint64_t                 vc_cnid;
+    struct workqueue_struct *vc_wq;
+    struct work_struct       vc_work;
+};
+
+static void
+kvs_vcomp_fname(uint64_t cnid, char *buf, size_t bufsz)
+{
+    snprintf(buf, bufsz, "%s-%lu", VCOMP_DICT_FILE_PFX, cnid);
+}
+
+/* Register the dictionary for decompression and then publish it for use by
+ * the put path.  A dictionary that the kvs is no longer configured to use is
+ * only registered, so that the values compressed with it remain readable.
+ */
+static merr_t
+kvs_vcomp_dict_install(struct kvs_vcomp *vc, const void *dict, size_t len)
+{
+    ZSTD_CDict *cdict;
+    merr_t err;
+
+    err = compress_zstd_dict_register(dict, len, &vc->vc_dict_id);
+    if (ev(err))
+        return err;
+
+    if (vc->vc_algo != VCOMP_ALGO_ZSTD || !vc->vc_dict_sz)
+        return 0;
+
+    /* Keep a copy from which to digest the dictionary at the compaction
+     * level, should it be needed.
+     */
+    vc->vc_dict = malloc(len);
+    if (ev(!vc->vc_dict)) {
+        err = merr(ENOMEM);
+        goto errout;
+    }
+
+    memcpy(vc->vc_dict, dict, len);
+    vc->vc_dict_len = len;
+
+    cdict = ZSTD_createCDict(dict, len, vc->vc_level);
+    if (ev(!cdict)) {
+        free(vc->vc_dict);
+        vc->vc_dict = NULL;
+        vc->vc_dict_len = 0;
+        err = merr(ENOMEM);
+        goto errout;
+    }
+
+    atomic_set_rel(&vc->vc_cdict, cdict);
+
+    return 0;
+
+  errout:
+    compress_zstd_dict_unregister(vc->vc_dict_id);
+    vc->vc_dict_id = 0;
+
+    return err;
+}
+
+static const ZSTD_CDict *
+kvs_vcomp_compact_cdict(struct kvs_vcomp *vc)
+{
+    ZSTD_CDict *cdict;
+
+    if (!atomic_read_acq(&vc->vc_cdict))
+        return NULL;
+
+    cdict = atomic_read_acq(&vc->vc_ccdict);
+    if (cdict)
+        return cdict;
+
+    cdict = ZSTD_createCDict(vc->vc_dict, vc->vc_dict_len, vc->vc_clevel);
+    if (ev(!cdict))
+        return NULL;
+
+    if (!atomic_cas(&vc->vc_ccdict, (ZSTD_CDict *)NULL, cdict)) {
+        ZSTD_freeCDict(cdict);
+        cdict = atomic_read_acq(&vc->vc_ccdict);
+    }
+
+    return cdict;
+}
+
+bool
+kvs_vcomp_recompress_enabled(const struct kvs_vcomp *vc)
+{
+    return vc && vc->vc_compact;
+}
+
+merr_t
+kvs_vcomp_recompress(
+    struct kvs_vcomp *vc,
+    const void       *src,
+    uint              src_len,
+    void             *dst,
+    uint              dst_capacity,
+    uint             *dst_len)
+{
+    assert(vc->vc_compact);
+
+    return compress_zstd_compress(src, src_len, dst, dst_capacity, dst_len, vc->vc_clevel,
+                                  kvs_vcomp_compact_cdict(vc));
+}
+
+uint
+kvs_vcomp_recompress_bound(const struct kvs_vcomp *vc, uint len)
+{
+    return compress_zstd_ops.cop_estimate(NULL, len);
+}
+
+struct vcomp_ftw_arg {
+    const char *name;
+    bool        found;
+};
+
+static void
+kvs_vcomp_ftw_cb(void *cbarg, const char *path)
+{
+    struct vcomp_ftw_arg *arg = cbarg;
+    const char *base = strrchr(path, '/');
+
+    if (!strcmp(base ? base + 1 : path, arg->name))
+        arg->found = true;
+}
+
+/* mpool_file_open() creates missing files, which we must avoid (e.g., if
+ * the kvdb is read-only, or if the file must not be overwritten).
+ */
+static merr_t
+kvs_vcomp_dict_exists(struct kvs_vcomp *vc, const char *name, bool *found)
+{
+    struct vcomp_ftw_arg arg;
+    struct mpool_file_cb cb;
+    merr_t err;
+
+    arg.name = name;
+    arg.found = false;
+    cb.cbarg = &arg;
+    cb.cbfunc = kvs_vcomp_ftw_cb;
+
+    err = mpool_mclass_ftw(vc->vc_mp, HSE_MCLASS_CAPACITY, name, &cb);
+    if (!err)
+        *found = arg.found;
+
+    return err;
+}
+
+static merr_t
+kvs_vcomp_dict_load(struct kvs_vcomp *vc)
+{
+    struct vcomp_dict_omf omf;
+    struct mpool_file *mpf;
+    char name[64];
+    size_t rdlen, len;
+    bool found;
+    void *dict;
+    merr_t err;
+
+    kvs_vcomp_fname(vc->vc_cnid, name, sizeof(name));
+
+    err = kvs_vcomp_dict_exists(vc, name, &found);
+    if (err)
+        return err;
+
+    if (!found)
+        return merr(ENOENT);
+
+    err = mpool_file_open(vc->vc_mp, HSE_MCLASS_CAPACITY, name, O_RDWR, 0, true, &mpf);
+    if (err)
+        return err;
+
+    err = mpool_file_read(mpf, 0, (char *)&omf, sizeof(omf), &rdlen);
+    if (err) {
+        mpool_file_close(mpf);
+        return err;
+    }
+
+    /* The header is written last, so a file without one was left by a
+     * crash before the dictionary was installed, and no value can have
+     * been compressed with it.
+     */
+    if (rdlen < sizeof(omf) || omf.vdo_magic == 0) {
+        mpool_file_close(mpf);
+
+        err = mpool_file_destroy(vc->vc_mp, HSE_MCLASS_CAPACITY, name);
+
+        return err ?: merr(ENOENT);
+    }
+
+    len = le32_to_cpu(omf.vdo_len);
+
+    if (le32_to_cpu(omf.vdo_magic) != VC_DICT_MAGIC ||
+        le32_to_cpu(omf.vdo_version) != VC_DICT_VERSION || len == 0 || len > VC_DICT_LEN_MAX) {
+        mpool_file_close(mpf);
+        return merr(EPROTO);
+    }
+
+    dict = malloc(len);
+    if (ev(!dict)) {
+        mpool_file_close(mpf);
+        return merr(ENOMEM);
+    }
+
+    err = mpool_file_read(mpf, sizeof(omf), dict, len, &rdlen);
+    mpool_file_close(mpf);
+
+    if (!err && (rdlen != len || crc32c(0, dict, len) != le32_to_cpu(omf.vdo_crc)))
+        err = merr(EPROTO);
+
+    if (!err)
+        err = kvs_vcomp_dict_install(vc, dict, len);
+    if (!err)
+        atomic_set(&vc->vc_state, VC_STATE_READY);
+
+    free(dict);
+
+    return err;
+}
+
+static merr_t
+kvs_vcomp_dict_save(struct kvs_vcomp *vc, const void *dict, size_t len)
+{
+    struct vcomp_dict_omf omf;
+    struct mpool_file *mpf;
+    char name[64];
+    size_t wrlen;
+    bool found;
+    merr_t err;
+
+    kvs_vcomp_fname(vc->vc_cnid, name, sizeof(name));
+
+    /* Values may already have been compressed with an existing dictionary.
+     */
+    err = kvs_vcomp_dict_exists(vc, name, &found);
+    if (ev(err))
+        return err;
+
+    if (ev(found))
+        return merr(EEXIST);
+
+    omf.vdo_magic = cpu_to_le32(VC_DICT_MAGIC);
+    omf.vdo_version = cpu_to_le32(VC_DICT_VERSION);
+    omf.vdo_len = cpu_to_le32(len);
+    omf.vdo_crc = cpu_to_le32(crc32c(0, dict, len));
+
+    err = mpool_file_open(vc->vc_mp, HSE_MCLASS_CAPACITY, name, O_RDWR, 0, true, &mpf);
+    if (ev(err))
+        return err;
+
+    /* Write the dictionary before the header so that a crash leaves either
+     * a complete dictionary or one whose header doesn't validate.
+     */
+    err = mpool_file_write(mpf, sizeof(omf), dict, len, &wrlen);
+    if (!err)
+        err = mpool_file_sync(mpf);
+    if (!err)
+        err = mpool_file_write(mpf, 0, (const char *)&omf, sizeof(omf), &wrlen);
+    if (!err)
+        err = mpool_file_sync(mpf);
+
+    mpool_file_close(mpf);
+
+    return err;
+}
+
+static void
+kvs_vcomp_train(struct work_struct *work)
+{
+    struct kvs_vcomp *vc = container_of(work, struct kvs_vcomp, vc_work);
+    size_t len;
+    void *dict;
+    merr_t err;
+
+    dict = malloc(vc->vc_dict_sz);
+    if (ev(!dict)) {
+        err = merr(ENOMEM);
+        goto out;
+    }
+
+    err = compress_zstd_train(vc->vc_sbuf, vc->vc_sizev, vc->vc_samplec, dict, vc->vc_dict_sz,
+                              &len);
+    if (!err)
+        err = kvs_vcomp_dict_save(vc, dict, len);
+    if (!err)
+        err = kvs_vcomp_dict_install(vc, dict, len);
+
+    if (!err)
+        log_info("cnid %lu: trained %zu byte dictionary %u from %u samples",
+                 vc->vc_cnid, len, vc->vc_dict_id, vc->vc_samplec);
+
+    free(dict);
+
+  out:
+    if (err)
+        log_warnx("cnid %lu: unable to train a dictionary from %u samples",
+                  err, vc->vc_cnid, vc->vc_samplec);
+
+    mutex_lock(&vc->vc_lock);
+    free(vc->vc_sbuf);
+    free(vc->vc_sizev);
+    vc->vc_sbuf = NULL;
+    vc->vc_sizev = NULL;
+    mutex_unlock(&vc->vc_lock);
+
+    /* kvs_vcomp_close() may free vc as soon as the state changes.
+     */
+    atomic_set_rel(&vc->vc_state, err ? VC_STATE_NONE : VC_STATE_READY);
+}
+
+static void
+kvs_vcomp_sample(struct kvs_vcomp *vc, const void *src, uint src_len)
+{
+    if (src_len > VC_SAMPLE_VLEN_MAX || atomic_inc_return(&vc->vc_nputs) % VC_SAMPLE_INTERVAL)
+        return;
+
+    if (!mutex_trylock(&vc->vc_lock))
+        return;
+
+    if (atomic_read(&vc->vc_state) == VC_STATE_SAMPLING && vc->vc_slen + src_len <= vc->vc_scap) {
+        memcpy(vc->vc_sbuf + vc->vc_slen, src, src_len);
+        vc->vc_sizev[vc->vc_samplec++] = src_len;
+        vc->vc_slen += src_len;
+
+        if (vc->vc_slen + VC_SAMPLE_VLEN_MAX > vc->vc_scap || vc->vc_samplec >= VC_SAMPLES_MAX) {
+            atomic_set(&vc->vc_state, VC_STATE_TRAINING);
+
+            INIT_WORK(&vc->vc_work, kvs_vcomp_train);
+            if (!queue_work(vc->vc_wq, &vc->vc_work))
+                atomic_set(&vc->vc_state, VC_STATE_NONE);
+        }
+    }
+
+    mutex_unlock(&vc->vc_lock);
+}
+
+merr_t
+kvs_vcomp_compress(
+    struct kvs_vcomp *vc,
+    const void       *src,
+    uint              src_len,
+    void             *dst,
+    uint              dst_capacity,
+    uint             *dst_len)
+{
+    const ZSTD_CDict *cdict;
+
+    if (vc->vc_algo == VCOMP_ALGO_LZ4)
+        return compress_lz4_ops.cop_compress(src, src_len, dst, dst_capacity, dst_len);
+
+    cdict = atomic_read_acq(&vc->vc_cdict);
+    if (!cdict && atomic_read(&vc->vc_state) == VC_STATE_SAMPLING)
+        kvs_vcomp_sample(vc, src, src_len);
+
+    return compress_zstd_compress(src, src_len, dst, dst_capacity, dst_len, vc->vc_level, cdict);
+}
+
+uint
+kvs_vcomp_compress_bound(const struct kvs_vcomp *vc, uint len)
+{
+    return vcomp_compress_ops[vc->vc_algo]->cop_estimate(NULL, len);
+}
+
+merr_t
+kvs_vcomp_open(
+    struct mpool             *mp,
+    uint64_t                  cnid,
+    const struct kvs_rparams *rp,
+    struct workqueue_struct  *wq,
+    struct kvs_vcomp        **vcomp_out)
+{
+    struct kvs_vcomp *vc;
+    merr_t err;
+
+    INVARIANT(rp);
+    INVARIANT(vcomp_out);
+
+    vc = aligned_alloc(__alignof__(*vc), sizeof(*vc));
+    if (ev(!vc))
+        return merr(ENOMEM);
+
+    memset(vc, 0, sizeof(*vc));
+    mutex_init(&vc->vc_lock);
+    vc->vc_algo = rp->value.compression.algo;
+    vc->vc_level = rp->value.compression.level;
+    vc->vc_dict_sz = rp->value.compression.dict_size;
+    vc->vc_compact = rp->value.compression.compact == VCOMP_DEFAULT_ON;
+    vc->vc_clevel = rp->value.compression.compact_level;
+    vc->vc_mp = mp;
+    vc->vc_cnid = cnid;
+    vc->vc_wq = wq;
+
+    atomic_set(&vc->vc_cdict, NULL);
+    atomic_set(&vc->vc_ccdict, NULL);
+    atomic_set(&vc->vc_state, VC_STATE_NONE);
+
+    *vcomp_out = vc;
+
+    if (!mp)
+        return 0;
+
+    /* Values compressed with a dictionary must remain readable even if the
+     * kvs is reopened with different compression parameters, so always
+     * load an existing dictionary.  One that cannot be loaded must not be
+     * replaced, lest its values become unreadable.
+     */
+    err = kvs_vcomp_dict_load(vc);
+    if (err && merr_errno(err) != ENOENT) {
+        log_errx("cnid %lu: unable to load dictionary", err, cnid);
+        kvs_vcomp_close(vc);
+        *vcomp_out = NULL;
+        return err;
+    }
+
+    /* Training requires zstd, a workqueue and a kvdb that accepts puts.
+     */
+    if (!err || vc->vc_algo != VCOMP_ALGO_ZSTD || !vc->vc_dict_sz || !wq)
+        return 0;
+
+    vc->vc_scap = min_t(size_t, vc->vc_dict_sz * VC_SAMPLE_RATIO, VC_SAMPLE_BUFSZ_MAX);
+    vc->vc_sbuf = malloc(vc->vc_scap);
+    vc->vc_sizev = malloc(VC_SAMPLES_MAX * sizeof(*vc->vc_sizev));
+
+    if (vc->vc_sbuf && vc->vc_sizev) {
+        atomic_set(&vc->vc_state, VC_STATE_SAMPLING);
+    } else {
+        free(vc->vc_sbuf);
+        free(vc->vc_sizev);
+        vc->vc_sbuf = NULL;
+        vc->vc_sizev = NULL;
+    }
+
+    return 0;
+}
+
+void
+kvs_vcomp_close(struct kvs_vcomp *vc)
+{
+    if (!vc)
+        return;
+
+    while (atomic_read_acq(&vc->vc_state) == VC_STATE_TRAINING)
+        usleep(10 * 1000);
+
+    if (vc->vc_dict_id)
+        compress_zstd_dict_unregister(vc->vc_dict_id);
+
+    ZSTD_freeCDict(atomic_read(&vc->vc_cdict));
+    ZSTD_freeCDict(atomic_read(&vc->vc_ccdict));
+    free(vc->vc_dict);
+    free(vc->vc_sbuf);
+    free(vc->vc_sizev);
+    mutex_destroy(&vc->vc_lock);
+    free(vc);
+}
+
+void
+kvs_vcomp_drop(struct mpool *mp, uint64_t cnid)
+{
+    char name[64];
+    merr_t err;
+
+    kvs_vcomp_fname(cnid, name, sizeof(name));
+
+    err = mpool_file_destroy(mp, HSE_MCLASS_CAPACITY, name);
+    if (err && merr_errno(err) != ENOENT)
+        log_warnx("cnid %lu: unable to remove dictionary", err, cnid);
+}
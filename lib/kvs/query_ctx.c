@@ -8,6 +8,7 @@
 #include <hse/util/map.h>
 
 #include <hse/ikvdb/query_ctx.h>
+#include <hse/ikvdb/rtomb.h>
 
 merr_t
 qctx_tomb_insert(struct query_ctx *qctx, const void *key, size_t klen)
@@ -33,3 +34,17 @@ qctx_tomb_seen(struct query_ctx *qctx, const void *key, size_t klen)
 
     return map_lookup(qctx->tomb_map, hash, NULL);
 }
+
+bool
+qctx_rtomb_covers(
+    const struct query_ctx *qctx,
+    const void             *key,
+    size_t                  klen,
+    uint64_t                seq,
+    uint64_t                view)
+{
+    if (!qctx->rtombs)
+        return false;
+
+    return rtomb_vec_lookup(qctx->rtombs, key, klen, view) > seq;
+}
@@ -0,0 +1,124 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <hse/util/assert.h>
+#include <hse/util/event_counter.h>
+#include <hse/util/keycmp.h>
+
+#include <hse/ikvdb/rtomb.h>
+
+void
+rtomb_init(
+    struct rtomb *rt,
+    const void   *start,
+    size_t        slen,
+    const void   *end,
+    size_t        elen,
+    uint64_t      seqno)
+{
+    INVARIANT(rt && start && end);
+    assert(slen <= UINT16_MAX && elen <= UINT16_MAX);
+
+    rt->rt_next = NULL;
+    rt->rt_seqno = seqno;
+    rt->rt_skidx = 0;
+    rt->rt_slen = slen;
+    rt->rt_elen = elen;
+
+    memcpy(rt->rt_data, start, slen);
+    memcpy(rt->rt_data + slen, end, elen);
+}
+
+struct rtomb *
+rtomb_alloc(const void *start, size_t slen, const void *end, size_t elen, uint64_t seqno)
+{
+    struct rtomb *rt;
+
+    rt = malloc(rtomb_size(slen, elen));
+    if (rt)
+        rtomb_init(rt, start, slen, end, elen, seqno);
+
+    return rt;
+}
+
+bool
+rtomb_covers(const struct rtomb *rt, const void *key, size_t klen)
+{
+    return keycmp(rtomb_start(rt), rt->rt_slen, key, klen) <= 0 &&
+        keycmp(key, klen, rtomb_end(rt), rt->rt_elen) < 0;
+}
+
+bool
+rtomb_overlaps(
+    const struct rtomb *rt,
+    const void         *min,
+    size_t              minlen,
+    const void         *max,
+    size_t              maxlen)
+{
+    if (max && keycmp(max, maxlen, rtomb_start(rt), rt->rt_slen) < 0)
+        return false;
+
+    if (min && keycmp(min, minlen, rtomb_end(rt), rt->rt_elen) >= 0)
+        return false;
+
+    return true;
+}
+
+merr_t
+rtomb_vec_add(struct rtomb_vec *rv, struct rtomb *rt)
+{
+    if (rv->rv_cnt >= rv->rv_max) {
+        uint32_t max = rv->rv_max ? rv->rv_max * 2 : 8;
+        void *v;
+
+        v = realloc(rv->rv_v, sizeof(*rv->rv_v) * max);
+        if (ev(!v))
+            return merr(ENOMEM);
+
+        rv->rv_v = v;
+        rv->rv_max = max;
+    }
+
+    rv->rv_v[rv->rv_cnt++] = rt;
+
+    return 0;
+}
+
+void
+rtomb_vec_fini(struct rtomb_vec *rv, bool free_rtombs)
+{
+    if (free_rtombs) {
+        for (uint32_t i = 0; i < rv->rv_cnt; ++i)
+            free(rv->rv_v[i]);
+    }
+
+    free(rv->rv_v);
+    memset(rv, 0, sizeof(*rv));
+}
+
+uint64_t
+rtomb_vec_lookup(const struct rtomb_vec *rv, const void *key, size_t klen, uint64_t view)
+{
+    uint64_t seqno = 0;
+
+    if (!rv)
+        return 0;
+
+    for (uint32_t i = 0; i < rv->rv_cnt; ++i) {
+        const struct rtomb *rt = rv->rv_v[i];
+
+        if (rt->rt_seqno > view || rt->rt_seqno <= seqno)
+            continue;
+
+        if (rtomb_covers(rt, key, klen))
+            seqno = rt->rt_seqno;
+    }
+
+    return seqno;
+}
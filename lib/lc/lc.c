@@ -82,7 +82,7 @@
 #include <hse/util/slab.h>
 #include <hse/util/vlb.h>
 #include <hse/util/bonsai_tree.h>
-#include <hse/util/compression_lz4.h>
+#include <hse/ikvdb/vcomp_params.h>
 #include <hse/util/rmlock.h>
 #include <hse/util/bin_heap.h>
 #include <hse/util/bkv_collection.h>
@@ -490,6 +490,7 @@ lc_builder_cb(void *rock, struct bonsai_kv *bkv, struct bonsai_val *vlist)
         struct bonsai_sval  sval;
 
         bn_sval_init(val->bv_value, val->bv_xlen, val->bv_seqnoref, &sval);
+        sval.bsv_flags = val->bv_flags;
         root = sval.bsv_val == HSE_CORE_TOMB_PFX ? rcu_dereference(lc->lc_broot[0])
                                                  : rcu_dereference(lc->lc_broot[1]);
 
@@ -632,7 +633,7 @@ copy_val(struct kvs_buf *vbuf, struct bonsai_val *val)
         ulen = bonsai_val_ulen(val);
 
         if (clen > 0) {
-            err = compress_lz4_ops.cop_decompress(
+            err = vcomp_decompress(
                 val->bv_value, clen, vbuf->b_buf, vbuf->b_buf_sz, &outlen);
             if (ev(err))
                 return err;
@@ -16,6 +16,7 @@
 struct mpool;            /* opaque mpool handle */
 struct mpool_mdc;        /* opaque MDC (metadata container) handle */
 struct mpool_file;       /* opaque mpool file handle */
+struct io_batch;         /* opaque asynchronous read batch */
 struct iovec;
 
 /* MTF_MOCK_DECL(mpool) */
@@ -384,6 +385,40 @@ mpool_mblock_commit(struct mpool *mp, uint64_t mbid);
 merr_t
 mpool_mblock_delete(struct mpool *mp, uint64_t mbid);
 
+/**
+ * mpool_mblock_commitv() - commit a vector of mblocks
+ *
+ * @mp:    mpool
+ * @mbidv: vector of mblock object IDs
+ * @mbidc: number of mblock object IDs in %mbidv
+ *
+ * Equivalent to calling mpool_mblock_commit() on each mblock, except that
+ * the metadata of all mblocks in the vector that reside in the same media
+ * class is made durable with a single sync.  Mblocks in the same media class
+ * and file are committed all or nothing, but on failure mblocks in other
+ * files may have been committed.
+ *
+ * Return: %0 on success, <%0 on error
+ */
+/* MTF_MOCK */
+merr_t
+mpool_mblock_commitv(struct mpool *mp, uint64_t *mbidv, int mbidc);
+
+/**
+ * mpool_mblock_deletev() - delete a vector of mblocks
+ *
+ * @mp:    mpool
+ * @mbidv: vector of mblock object IDs (zero IDs are ignored)
+ * @mbidc: number of mblock object IDs in %mbidv
+ *
+ * Vector form of mpool_mblock_delete(), see mpool_mblock_commitv().
+ *
+ * Return: %0 on success, <%0 on error
+ */
+/* MTF_MOCK */
+merr_t
+mpool_mblock_deletev(struct mpool *mp, uint64_t *mbidv, int mbidc);
+
 /**
  * mpool_mblock_props_get() - get properties of an mblock
  *
@@ -428,6 +463,66 @@ mpool_mblock_write(struct mpool *mp, uint64_t mbid, const struct iovec *iov, int
 merr_t
 mpool_mblock_read(struct mpool *mp, uint64_t mbid, const struct iovec *iov, int iovc, off_t offset);
 
+/**
+ * mpool_io_batch_create() - create a batch for asynchronous mblock reads
+ *
+ * @depth:     maximum number of reads in flight
+ * @batch_out: batch handle (output)
+ *
+ * Reads are executed via io_uring if HSE was built with liburing,
+ * otherwise they are executed synchronously at submit time.
+ */
+merr_t
+mpool_io_batch_create(unsigned int depth, struct io_batch **batch_out);
+
+/**
+ * mpool_io_batch_destroy() - destroy an io batch
+ *
+ * @batch: batch handle
+ *
+ * All reads must have been waited for via mpool_io_batch_wait().
+ */
+void
+mpool_io_batch_destroy(struct io_batch *batch);
+
+/**
+ * mpool_io_batch_wait() - wait for all reads in an io batch to complete
+ *
+ * @batch: batch handle
+ *
+ * Invokes the completion callback of every outstanding read before returning,
+ * also when an error is returned.
+ */
+merr_t
+mpool_io_batch_wait(struct io_batch *batch);
+
+/**
+ * mpool_mblock_read_async() - queue a read of mblock data to an io batch
+ *
+ * @mp:      mpool
+ * @batch:   batch handle
+ * @mbid:    mblock object ID
+ * @iov:     iovec for output data
+ * @iov_cnt: length of iov[]
+ * @offset:  PAGE aligned offset into the mblock
+ * @cb:      completion callback, invoked with the read's status
+ * @cbarg:   argument passed to @cb
+ *
+ * The iovec and the buffers it references must remain valid until @cb
+ * has been called, which happens at the latest in mpool_io_batch_wait().
+ * If an error is returned then @cb will not be called.
+ */
+merr_t
+mpool_mblock_read_async(
+    struct mpool       *mp,
+    struct io_batch    *batch,
+    uint64_t            mbid,
+    const struct iovec *iov,
+    int                 iovc,
+    off_t               offset,
+    void              (*cb)(void *cbarg, merr_t err),
+    void               *cbarg);
+
 /**
  * mpool_mblock_clone() - clone the specified mblock
  *
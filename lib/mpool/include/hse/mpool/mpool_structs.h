@@ -18,6 +18,7 @@
 
 #define WAL_FILE_PFX           "wal"
 #define WAL_FILE_PFX_LEN       (sizeof(WAL_FILE_PFX) - 1)
+#define VCOMP_DICT_FILE_PFX    "zdict"
 
 /* [HSE_REVISIT]: The fact that this is necessary at all seems like a code
  * smell. Ideally, I think we remove this and properly propogate errors up the
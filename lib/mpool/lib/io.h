@@ -6,6 +6,9 @@
 #ifndef MPOOL_IO_H
 #define MPOOL_IO_H
 
+#include <sys/types.h>
+#include <sys/uio.h>
+
 #include <hse/error/merr.h>
 
 /**
@@ -33,4 +36,42 @@ extern const struct io_ops io_sync_ops;
 extern const struct io_ops io_pmem_ops;
 #endif /* HAVE_PMEM */
 
+/**
+ * struct io_batch - a queue of outstanding asynchronous reads
+ *
+ * Reads are submitted via io_batch_read() and may complete in any order.
+ * Each read's completion callback is invoked at the latest from within
+ * io_batch_wait(), which returns only after all submitted reads have
+ * completed, even if it fails. The buffers referenced by a read's iovec
+ * must remain valid until its callback has been invoked. If io_batch_read()
+ * fails then the read was not queued and its callback will never be
+ * invoked, errors that occur after a read was queued are reported by its
+ * callback or by io_batch_wait().
+ *
+ * With io_uring the reads are queued to a per-batch submission ring,
+ * otherwise they are executed synchronously at submit time.
+ */
+struct io_batch;
+
+typedef void io_batch_cb(void *arg, merr_t err);
+
+merr_t
+io_batch_create(unsigned int depth, struct io_batch **batch_out);
+
+void
+io_batch_destroy(struct io_batch *batch);
+
+merr_t
+io_batch_read(
+    struct io_batch    *batch,
+    int                 src_fd,
+    off_t               off,
+    const struct iovec *iov,
+    int                 iovcnt,
+    io_batch_cb        *cb,
+    void               *cbarg);
+
+merr_t
+io_batch_wait(struct io_batch *batch);
+
 #endif /* MPOOL_IO_H */
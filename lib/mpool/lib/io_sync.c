@@ -21,6 +21,7 @@
 #error "Neither __IOV_MAX nor IOV_MAX is defined"
 #endif
 
+#include <stdlib.h>
 #include <sys/mman.h>
 
 #include <hse/util/minmax.h>
@@ -171,8 +172,10 @@ io_sync_msync(void *addr, size_t len, int flags)
 
     INVARIANT(addr);
 
+    /* Cover the whole of [addr, addr + len) after rounding addr down.
+     */
+    len = PAGE_ALIGN(len + ((uintptr_t)addr & ~PAGE_MASK));
     addr = (void *)((uintptr_t)addr & PAGE_MASK);
-    len = PAGE_ALIGN(len);
 
     rc = msync(addr, len, flags);
 
@@ -205,6 +208,68 @@ io_sync_clone(int src_fd, off_t src_off, int tgt_fd, off_t tgt_off, size_t len,
     return left > 0 ? merr(EIO) : 0;
 }
 
+#ifndef HAVE_LIBURING
+
+/* Without io_uring an io_batch degenerates to synchronous reads issued at
+ * submit time, which preserves the io_batch semantics for its callers.
+ */
+struct io_batch {
+    unsigned int iob_depth;
+};
+
+merr_t
+io_batch_create(unsigned int depth, struct io_batch **batch_out)
+{
+    struct io_batch *batch;
+
+    INVARIANT(batch_out);
+
+    batch = calloc(1, sizeof(*batch));
+    if (!batch)
+        return merr(ENOMEM);
+
+    batch->iob_depth = depth;
+    *batch_out = batch;
+
+    return 0;
+}
+
+void
+io_batch_destroy(struct io_batch *batch)
+{
+    free(batch);
+}
+
+merr_t
+io_batch_read(
+    struct io_batch    *batch,
+    int                 src_fd,
+    off_t               off,
+    const struct iovec *iov,
+    int                 iovcnt,
+    io_batch_cb        *cb,
+    void               *cbarg)
+{
+    size_t rdlen = 0;
+    merr_t err;
+
+    err = io_sync_read(src_fd, off, iov, iovcnt, 0, &rdlen);
+    if (!err && rdlen != iolen(iov, iovcnt))
+        err = merr(EIO);
+
+    cb(cbarg, err);
+
+    return 0;
+}
+
+merr_t
+io_batch_wait(struct io_batch *batch)
+{
+    return 0;
+}
+
+#endif /* !HAVE_LIBURING */
+
 const struct io_ops io_sync_ops = {
     .read = io_sync_read,
     .write = io_sync_write,
@@ -0,0 +1,366 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#include <liburing.h>
+
+#include <hse/util/base.h>
+#include <hse/util/assert.h>
+#include <hse/util/event_counter.h>
+#include <hse/util/minmax.h>
+
+#include "io.h"
+
+#define IO_BATCH_DEPTH_MAX (1024u)
+
+/**
+ * struct io_req - one outstanding read in an io_batch
+ * @ior_cb:    completion callback
+ * @ior_cbarg: completion callback argument
+ * @ior_len:   expected length of the read
+ * @ior_busy:  read has been queued and not yet reaped
+ * @ior_next:  free list linkage
+ */
+struct io_req {
+    io_batch_cb   *ior_cb;
+    void          *ior_cbarg;
+    size_t         ior_len;
+    bool           ior_busy;
+    struct io_req *ior_next;
+};
+
+/**
+ * struct io_batch - io_uring backed batch of asynchronous reads
+ * @iob_ring:     submission/completion ring
+ * @iob_depth:    number of entries in the ring (and in iob_reqv[])
+ * @iob_inflight: number of submitted but not yet reaped reads
+ * @iob_queued:   number of prepared but not yet submitted reads
+ * @iob_err:      first error encountered while submitting or reaping
+ * @iob_cancel:   cancel requests were issued, their completions may linger
+ * @iob_free:     list of free request descriptors
+ * @iob_reqv:     request descriptors
+ */
+struct io_batch {
+    struct io_uring iob_ring;
+    unsigned int    iob_depth;
+    unsigned int    iob_inflight;
+    unsigned int    iob_queued;
+    merr_t          iob_err;
+    bool            iob_cancel;
+    struct io_req  *iob_free;
+    struct io_req   iob_reqv[];
+};
+
+/* Creating a ring costs several system calls, so each thread caches one
+ * idle batch for reuse by its next io_batch_create().
+ */
+static thread_local struct io_batch *io_batch_tls;
+static pthread_key_t io_batch_key;
+static pthread_once_t io_batch_once = PTHREAD_ONCE_INIT;
+
+static void
+io_batch_free(struct io_batch *batch)
+{
+    io_uring_queue_exit(&batch->iob_ring);
+    free(batch);
+}
+
+static void
+io_batch_key_dtor(void *arg)
+{
+    io_batch_free(arg);
+}
+
+static void
+io_batch_key_init(void)
+{
+    if (pthread_key_create(&io_batch_key, io_batch_key_dtor))
+        ev(1);
+}
+
+static void
+io_batch_reset(struct io_batch *batch)
+{
+    unsigned int i;
+
+    batch->iob_inflight = 0;
+    batch->iob_queued = 0;
+    batch->iob_err = 0;
+    batch->iob_cancel = false;
+    batch->iob_free = NULL;
+
+    for (i = 0; i < batch->iob_depth; ++i) {
+        batch->iob_reqv[i].ior_busy = false;
+        batch->iob_reqv[i].ior_next = batch->iob_free;
+        batch->iob_free = batch->iob_reqv + i;
+    }
+}
+
+merr_t
+io_batch_create(unsigned int depth, struct io_batch **batch_out)
+{
+    struct io_batch *batch;
+    int rc;
+
+    INVARIANT(batch_out);
+
+    depth = clamp_t(unsigned int, depth, 1, IO_BATCH_DEPTH_MAX);
+
+    batch = io_batch_tls;
+    if (batch && batch->iob_depth >= depth) {
+        io_batch_tls = NULL;
+        pthread_setspecific(io_batch_key, NULL);
+        goto out;
+    }
+
+    batch = malloc(sizeof(*batch) + depth * sizeof(batch->iob_reqv[0]));
+    if (!batch)
+        return merr(ENOMEM);
+
+    rc = io_uring_queue_init(depth, &batch->iob_ring, 0);
+    if (rc < 0) {
+        free(batch);
+        return merr(-rc);
+    }
+
+    batch->iob_depth = depth;
+
+  out:
+    io_batch_reset(batch);
+    *batch_out = batch;
+
+    return 0;
+}
+
+void
+io_batch_destroy(struct io_batch *batch)
+{
+    if (!batch)
+        return;
+
+    assert(batch->iob_inflight == 0 && batch->iob_queued == 0);
+
+    pthread_once(&io_batch_once, io_batch_key_init);
+
+    /* A ring on which reads were cancelled may yet produce completions
+     * for the cancel requests themselves, so it is not reused.
+     */
+    if (!io_batch_tls && !batch->iob_cancel && batch->iob_inflight == 0 &&
+        batch->iob_queued == 0) {
+        io_batch_tls = batch;
+        pthread_setspecific(io_batch_key, batch);
+        return;
+    }
+
+    io_batch_free(batch);
+}
+
+/* Retire one completion, returns false if it was that of a cancel request
+ * rather than of a read.
+ */
+static bool
+io_batch_complete(struct io_batch *batch, struct io_uring_cqe *cqe)
+{
+    struct io_req *req = io_uring_cqe_get_data(cqe);
+    merr_t err = 0;
+
+    if (!req) {
+        io_uring_cqe_seen(&batch->iob_ring, cqe);
+        return false;
+    }
+
+    if (cqe->res < 0)
+        err = merr(-cqe->res);
+    else if (ev((size_t)cqe->res != req->ior_len))
+        err = merr(EIO);
+
+    io_uring_cqe_seen(&batch->iob_ring, cqe);
+
+    req->ior_cb(req->ior_cbarg, err);
+
+    req->ior_busy = false;
+    req->ior_next = batch->iob_free;
+    batch->iob_free = req;
+    batch->iob_inflight--;
+
+    return true;
+}
+
+static merr_t
+io_batch_submit(struct io_batch *batch)
+{
+    int rc;
+
+    if (batch->iob_queued == 0)
+        return 0;
+
+    rc = io_uring_submit(&batch->iob_ring);
+    if (rc < 0)
+        return merr(-rc);
+
+    batch->iob_inflight += batch->iob_queued;
+    batch->iob_queued = 0;
+
+    return 0;
+}
+
+/* Reap at least %min completions, and any others that are ready.
+ */
+static merr_t
+io_batch_reap(struct io_batch *batch, unsigned int min)
+{
+    struct io_uring_cqe *cqe;
+    int rc;
+
+    while (batch->iob_inflight > 0) {
+        if (min > 0) {
+            rc = io_uring_wait_cqe(&batch->iob_ring, &cqe);
+            if (rc == -EINTR)
+                continue;
+        } else {
+            rc = io_uring_peek_cqe(&batch->iob_ring, &cqe);
+            if (rc == -EAGAIN)
+                break;
+        }
+
+        if (rc < 0)
+            return merr(-rc);
+
+        if (io_batch_complete(batch, cqe) && min > 0)
+            --min;
+    }
+
+    return 0;
+}
+
+merr_t
+io_batch_read(
+    struct io_batch    *batch,
+    int                 src_fd,
+    off_t               off,
+    const struct iovec *iov,
+    int                 iovcnt,
+    io_batch_cb        *cb,
+    void               *cbarg)
+{
+    struct io_uring_sqe *sqe;
+    struct io_req *req;
+    size_t len = 0;
+    merr_t err;
+    int i;
+
+    INVARIANT(batch && iov && cb);
+
+    /* Make room if every request descriptor is in use.
+     */
+    if (!batch->iob_free) {
+        err = io_batch_submit(batch);
+        if (!err)
+            err = io_batch_reap(batch, 1);
+        if (ev(err))
+            return err;
+    }
+
+    sqe = io_uring_get_sqe(&batch->iob_ring);
+    if (!sqe) {
+        err = io_batch_submit(batch);
+        if (ev(err))
+            return err;
+
+        sqe = io_uring_get_sqe(&batch->iob_ring);
+        if (ev(!sqe))
+            return merr(EAGAIN);
+    }
+
+    for (i = 0; i < iovcnt; ++i)
+        len += iov[i].iov_len;
+
+    req = batch->iob_free;
+    batch->iob_free = req->ior_next;
+
+    req->ior_cb = cb;
+    req->ior_cbarg = cbarg;
+    req->ior_len = len;
+    req->ior_busy = true;
+
+    io_uring_prep_readv(sqe, src_fd, iov, iovcnt, off);
+    io_uring_sqe_set_data(sqe, req);
+    batch->iob_queued++;
+
+    /* Opportunistically retire completed reads to keep the ring flowing.
+     * The request is queued and its callback will run, so a reap error
+     * must not be returned here (the caller would reclaim %cbarg).  It is
+     * instead reported by io_batch_wait().
+     */
+    err = io_batch_reap(batch, 0);
+    if (ev(err) && !batch->iob_err)
+        batch->iob_err = err;
+
+    return 0;
+}
+
+/* Ask the kernel to abandon every queued read. This is best effort, reads
+ * that cannot be cancelled simply run to completion.
+ */
+static void
+io_batch_cancel(struct io_batch *batch)
+{
+    struct io_uring_sqe *sqe;
+    unsigned int i;
+
+    for (i = 0; i < batch->iob_depth; ++i) {
+        struct io_req *req = batch->iob_reqv + i;
+
+        if (!req->ior_busy)
+            continue;
+
+        sqe = io_uring_get_sqe(&batch->iob_ring);
+        if (!sqe) {
+            io_uring_submit(&batch->iob_ring);
+
+            sqe = io_uring_get_sqe(&batch->iob_ring);
+            if (ev(!sqe))
+                break;
+        }
+
+        io_uring_prep_cancel(sqe, req, 0);
+        io_uring_sqe_set_data(sqe, NULL);
+        batch->iob_cancel = true;
+    }
+
+    io_uring_submit(&batch->iob_ring);
+}
+
+merr_t
+io_batch_wait(struct io_batch *batch)
+{
+    merr_t err = 0;
+
+    INVARIANT(batch);
+
+    /* The caller reclaims the read buffers once this returns, so every
+     * read must be reaped even after an error.  Reads outstanding at the
+     * first error are cancelled so that draining them is quick.  The
+     * errors io_uring reports here (e.g., EAGAIN, EBUSY) are transient
+     * and clear as completions are reaped.
+     */
+    while (batch->iob_queued > 0 || batch->iob_inflight > 0) {
+        merr_t err2;
+
+        err2 = io_batch_submit(batch);
+        if (!err2)
+            err2 = io_batch_reap(batch, batch->iob_inflight);
+
+        if (ev(err2) && !err) {
+            err = err2;
+            io_batch_cancel(batch);
+        }
+    }
+
+    return err ?: batch->iob_err;
+}
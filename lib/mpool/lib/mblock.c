@@ -3,6 +3,10 @@
  * Copyright (C) 2021 Micron Technology, Inc.  All rights reserved.
  */
 
+#include <stdlib.h>
+#include <string.h>
+
+#include <hse/util/base.h>
 #include <hse/util/event_counter.h>
 #include <hse/logging/logging.h>
 
@@ -81,6 +85,91 @@ mpool_mblock_delete(struct mpool *mp, uint64_t mbid)
     return mblock_fset_delete(mclass_fset(mc), &mbid, 1);
 }
 
+static int
+mbid_mclass_cmp(const void *lhs, const void *rhs)
+{
+    enum mclass_id l = mclassid(*(const uint64_t *)lhs);
+    enum mclass_id r = mclassid(*(const uint64_t *)rhs);
+
+    return (l > r) - (l < r);
+}
+
+/*
+ * Group a vector of mblock ids by media class and hand each group to its
+ * file set, so that each file set logs and syncs its share of the batch
+ * once however the ids are interleaved.  Zero ids are skipped to match the
+ * semantics of mpool_mblock_delete().
+ */
+static merr_t
+mpool_mblock_batch(
+    struct mpool *mp,
+    uint64_t     *mbidv,
+    int           mbidc,
+    merr_t      (*fn)(struct mblock_fset *, uint64_t *, int))
+{
+    uint64_t            mbidbuf[32], *sortv = mbidv;
+    struct media_class *mc;
+    enum mclass_id      mcid;
+    int                 i, j;
+    merr_t              err = 0;
+
+    if (!mp || (!mbidv && mbidc > 0) || mbidc < 0)
+        return merr(EINVAL);
+
+    if (mbidc > 1) {
+        sortv = mbidbuf;
+        if ((size_t)mbidc > NELEM(mbidbuf)) {
+            sortv = malloc(mbidc * sizeof(*sortv));
+            if (ev(!sortv))
+                return merr(ENOMEM);
+        }
+
+        memcpy(sortv, mbidv, mbidc * sizeof(*sortv));
+        qsort(sortv, mbidc, sizeof(*sortv), mbid_mclass_cmp);
+    }
+
+    for (i = 0; i < mbidc; i = j) {
+        if (!sortv[i]) {
+            j = i + 1;
+            continue;
+        }
+
+        mcid = mclassid(sortv[i]);
+
+        for (j = i + 1; j < mbidc; j++) {
+            if (!sortv[j] || mclassid(sortv[j]) != mcid)
+                break;
+        }
+
+        mc = mpool_mclass_handle(mp, mcid_to_mclass(mcid));
+        if (!mc) {
+            err = merr(ENOENT);
+            break;
+        }
+
+        err = fn(mclass_fset(mc), sortv + i, j - i);
+        if (err)
+            break;
+    }
+
+    if (sortv != mbidv && sortv != mbidbuf)
+        free(sortv);
+
+    return err;
+}
+
+merr_t
+mpool_mblock_commitv(struct mpool *mp, uint64_t *mbidv, int mbidc)
+{
+    return mpool_mblock_batch(mp, mbidv, mbidc, mblock_fset_commit);
+}
+
+merr_t
+mpool_mblock_deletev(struct mpool *mp, uint64_t *mbidv, int mbidc)
+{
+    return mpool_mblock_batch(mp, mbidv, mbidc, mblock_fset_delete);
+}
+
 merr_t
 mpool_mblock_props_get(struct mpool *mp, uint64_t mbid, struct mblock_props *props)
 {
@@ -138,6 +227,53 @@ mpool_mblock_read(struct mpool *mp, uint64_t mbid, const struct iovec *iov, int
     return mblock_fset_read(mclass_fset(mc), mbid, iov, iovc, off);
 }
 
+merr_t
+mpool_io_batch_create(unsigned int depth, struct io_batch **batch_out)
+{
+    if (!batch_out)
+        return merr(EINVAL);
+
+    return io_batch_create(depth, batch_out);
+}
+
+void
+mpool_io_batch_destroy(struct io_batch *batch)
+{
+    io_batch_destroy(batch);
+}
+
+merr_t
+mpool_io_batch_wait(struct io_batch *batch)
+{
+    if (!batch)
+        return merr(EINVAL);
+
+    return io_batch_wait(batch);
+}
+
+merr_t
+mpool_mblock_read_async(
+    struct mpool       *mp,
+    struct io_batch    *batch,
+    uint64_t            mbid,
+    const struct iovec *iov,
+    int                 iovc,
+    off_t               off,
+    io_batch_cb        *cb,
+    void               *cbarg)
+{
+    struct media_class *mc;
+
+    if (!mp || !batch || !iov || !cb)
+        return merr(EINVAL);
+
+    mc = mpool_mclass_handle(mp, mcid_to_mclass(mclassid(mbid)));
+    if (!mc)
+        return merr(ENOENT);
+
+    return mblock_fset_read_async(mclass_fset(mc), batch, mbid, iov, iovc, off, cb, cbarg);
+}
+
 merr_t
 mpool_mblock_clone(struct mpool *mp, uint64_t mbid, off_t off, size_t len, uint64_t *mbid_out)
 {
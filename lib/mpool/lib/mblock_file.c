@@ -532,47 +532,62 @@ mblock_oid_isvalid(uint64_t mbid, uint64_t omfid, uint32_t wlen, uint32_t omfwle
     return (exists && mbid == omfid && wlen == omfwlen) || (0 == omfid && 0 == omfwlen);
 }
 
+/*
+ * Log the commit or delete of a batch of mblocks in this file.  The entire
+ * batch is validated before any metadata is modified so that a bad mbid
+ * doesn't leave the batch partially logged, and the updated OID slots are
+ * then made durable with a single msync over the span they occupy.
+ */
 static merr_t
 mblock_file_meta_log(struct mblock_file *mbfp, uint64_t *mbidv, int mbidc, bool delete)
 {
     struct mblock_oid_info mbinfo;
     uint32_t block, wlen, oid_len;
-    char    *addr;
+    char    *base, *addr, *lo, *hi;
     merr_t   err = 0;
+    int      i;
 
-    if (!mbfp || !mbidv)
+    if (!mbfp || !mbidv || mbidc < 1)
         return merr(EINVAL);
 
-    if (mbidc > 1)
-        return merr(ENOTSUP);
-
-    addr = mbfp->meta_addr;
-    block = block_id(*mbidv);
-
-    wlen = atomic_read(mbfp->wlenv + block);
+    base = mbfp->meta_addr + MBLOCK_FILE_META_HDRLEN;
     oid_len = omf_mblock_oid_len(MBLOCK_METAHDR_VERSION);
-
-    addr += MBLOCK_FILE_META_HDRLEN;
-    addr += (block * oid_len);
+    lo = hi = NULL;
 
     mutex_lock(&mbfp->meta_lock);
 
-    err = omf_mblock_oid_unpack(addr, MBLOCK_METAHDR_VERSION, true, &mbinfo);
+    for (i = 0; i < mbidc; i++) {
+        block = block_id(mbidv[i]);
+        addr = base + (block * oid_len);
+        wlen = atomic_read(mbfp->wlenv + block);
 
-    if (err || !mblock_oid_isvalid(*mbidv, mbinfo.mb_oid, wlen, mbinfo.mb_wlen, delete)) {
-        mutex_unlock(&mbfp->meta_lock);
-        return err ?: merr(EINVAL);
+        err = omf_mblock_oid_unpack(addr, MBLOCK_METAHDR_VERSION, true, &mbinfo);
+
+        if (err || !mblock_oid_isvalid(mbidv[i], mbinfo.mb_oid, wlen, mbinfo.mb_wlen, delete)) {
+            mutex_unlock(&mbfp->meta_lock);
+            return err ?: merr(EINVAL);
+        }
     }
 
-    if (delete) {
-        omf_mblock_oid_pack_zero(addr);
-    } else {
-        mbinfo.mb_oid = *mbidv;
-        mbinfo.mb_wlen = wlen;
-        omf_mblock_oid_pack(&mbinfo, addr);
+    for (i = 0; i < mbidc; i++) {
+        block = block_id(mbidv[i]);
+        addr = base + (block * oid_len);
+
+        if (delete) {
+            omf_mblock_oid_pack_zero(addr);
+        } else {
+            mbinfo.mb_oid = mbidv[i];
+            mbinfo.mb_wlen = atomic_read(mbfp->wlenv + block);
+            omf_mblock_oid_pack(&mbinfo, addr);
+        }
+
+        if (!lo || addr < lo)
+            lo = addr;
+        if (!hi || addr + oid_len > hi)
+            hi = addr + oid_len;
     }
 
-    err = mbfp->metaio.msync(addr, oid_len, MS_SYNC);
+    err = mbfp->metaio.msync(lo, hi - lo, MS_SYNC);
     mutex_unlock(&mbfp->meta_lock);
 
     return err;
@@ -937,19 +952,16 @@ mblock_file_commit(struct mblock_file *mbfp, uint64_t *mbidv, int mbidc)
 {
     merr_t err;
     bool delete = false;
-    uint32_t block;
+    int i;
 
-    if (!mbfp || !mbidv)
+    if (!mbfp || !mbidv || mbidc < 1)
         return merr(EINVAL);
 
-    if (mbidc > 1)
-        return merr(ENOTSUP);
-
-    block = block_id(*mbidv);
-
-    err = mblock_rgn_find(&mbfp->rgnmap, block + 1);
-    if (err)
-        return err;
+    for (i = 0; i < mbidc; i++) {
+        err = mblock_rgn_find(&mbfp->rgnmap, block_id(mbidv[i]) + 1);
+        if (err)
+            return err;
+    }
 
     hse_wmesg_tls = "mbcommit";
     err = mblock_file_meta_log(mbfp, mbidv, mbidc, delete);
@@ -964,35 +976,38 @@ mblock_file_delete(struct mblock_file *mbfp, uint64_t *mbidv, int mbidc)
     uint32_t block;
     off_t    mblocksz;
     merr_t   err;
-    int      rc;
+    int      rc, i;
 
-    if (!mbfp || !mbidv)
+    if (!mbfp || !mbidv || mbidc < 1)
         return merr(EINVAL);
 
-    if (mbidc > 1)
-        return merr(ENOTSUP);
-
-    block = block_id(*mbidv);
-    err = mblock_rgn_find(&mbfp->rgnmap, block + 1);
-    if (err)
-        return err;
+    for (i = 0; i < mbidc; i++) {
+        err = mblock_rgn_find(&mbfp->rgnmap, block_id(mbidv[i]) + 1);
+        if (err)
+            return err;
+    }
 
     err = mblock_file_meta_log(mbfp, mbidv, mbidc, true);
     if (err)
         return err;
 
     mblocksz = mbfp->mblocksz;
-    rc = fallocate(mbfp->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
-                   block_off(*mbidv, mblocksz), mblocksz);
-    ev(rc);
 
-    atomic_sub(&mbfp->wlen, mblock_wlen_get(mbfp, *mbidv));
-    mblock_wlen_set(mbfp, *mbidv, 0, false);
-    atomic_dec(&mbfp->mbcnt);
+    for (i = 0; i < mbidc; i++) {
+        block = block_id(mbidv[i]);
 
-    err = mblock_rgn_free(&mbfp->rgnmap, block + 1);
-    if (err)
-        return err;
+        rc = fallocate(mbfp->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                       block_off(mbidv[i], mblocksz), mblocksz);
+        ev(rc);
+
+        atomic_sub(&mbfp->wlen, mblock_wlen_get(mbfp, mbidv[i]));
+        mblock_wlen_set(mbfp, mbidv[i], 0, false);
+        atomic_dec(&mbfp->mbcnt);
+
+        err = mblock_rgn_free(&mbfp->rgnmap, block + 1);
+        if (err)
+            return err;
+    }
 
     return 0;
 }
@@ -1017,8 +1032,16 @@ iov_len_get(const struct iovec *iov, int iovc, size_t *tlen)
     return 0;
 }
 
-merr_t
-mblock_read(struct mblock_file *mbfp, uint64_t mbid, const struct iovec *iov, int iovc, off_t off)
+/* Validate a read request and compute its absolute offset in the data file.
+ */
+static merr_t
+mblock_read_check(
+    struct mblock_file *mbfp,
+    uint64_t            mbid,
+    const struct iovec *iov,
+    int                 iovc,
+    off_t               off,
+    off_t              *roff_out)
 {
     uint32_t  block;
     off_t     roff, eoff;
@@ -1028,9 +1051,6 @@ mblock_read(struct mblock_file *mbfp, uint64_t mbid, const struct iovec *iov, in
     if (!mbfp || !iov)
         return merr(EINVAL);
 
-    if (iovc == 0)
-        return 0;
-
     if (!PAGE_ALIGNED(off))
         return merr(EINVAL);
 
@@ -1056,6 +1076,24 @@ mblock_read(struct mblock_file *mbfp, uint64_t mbid, const struct iovec *iov, in
         return merr(EINVAL);
     }
 
+    *roff_out = roff;
+
+    return 0;
+}
+
+merr_t
+mblock_read(struct mblock_file *mbfp, uint64_t mbid, const struct iovec *iov, int iovc, off_t off)
+{
+    off_t  roff;
+    merr_t err;
+
+    if (iovc == 0)
+        return 0;
+
+    err = mblock_read_check(mbfp, mbid, iov, iovc, off, &roff);
+    if (err)
+        return err;
+
     hse_wmesg_tls = "mbread";
     err = mbfp->dataio.read(mbfp->fd, roff, iov, iovc, 0, NULL);
     hse_wmesg_tls = "-";
@@ -1063,6 +1101,30 @@ mblock_read(struct mblock_file *mbfp, uint64_t mbid, const struct iovec *iov, in
     return err;
 }
 
+merr_t
+mblock_read_async(
+    struct mblock_file *mbfp,
+    struct io_batch    *batch,
+    uint64_t            mbid,
+    const struct iovec *iov,
+    int                 iovc,
+    off_t               off,
+    io_batch_cb        *cb,
+    void               *cbarg)
+{
+    off_t  roff;
+    merr_t err;
+
+    if (!batch || !cb || iovc == 0)
+        return merr(EINVAL);
+
+    err = mblock_read_check(mbfp, mbid, iov, iovc, off, &roff);
+    if (err)
+        return err;
+
+    return io_batch_read(batch, mbfp->fd, roff, iov, iovc, cb, cbarg);
+}
+
 merr_t
 mblock_write(struct mblock_file *mbfp, uint64_t mbid, const struct iovec *iov, int iovc)
 {
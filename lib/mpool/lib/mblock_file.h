@@ -12,6 +12,7 @@
 #include <hse/util/compiler.h>
 
 #include "mclass.h"
+#include "io.h"
 
 /* clang-format off */
 
@@ -236,6 +237,29 @@ mblock_file_delete(struct mblock_file *mbfp, uint64_t *mbidv, int mbidc);
 merr_t
 mblock_read(struct mblock_file *mbfp, uint64_t mbid, const struct iovec *iov, int iovc, off_t off);
 
+/**
+ * mblock_read_async() - queue an mblock object read to an io batch
+ *
+ * @mbfp:   mblock file handle
+ * @batch:  io batch
+ * @mbid:   mblock id
+ * @iov:    iovec ptr
+ * @iovc:   iov count
+ * @off:    offset
+ * @cb:     completion callback
+ * @cbarg:  completion callback argument
+ */
+merr_t
+mblock_read_async(
+    struct mblock_file *mbfp,
+    struct io_batch    *batch,
+    uint64_t            mbid,
+    const struct iovec *iov,
+    int                 iovc,
+    off_t               off,
+    io_batch_cb        *cb,
+    void               *cbarg);
+
 /**
  * mblock_write() - write an mblock object
  *
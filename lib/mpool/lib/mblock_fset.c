@@ -642,56 +642,96 @@ mblock_fset_alloc(struct mblock_fset *mbfsp, uint32_t flags, int mbidc, uint64_t
     return err;
 }
 
-merr_t
-mblock_fset_commit(struct mblock_fset *mbfsp, uint64_t *mbidv, int mbidc)
+static int
+mbid_file_cmp(const void *lhs, const void *rhs)
 {
-    struct mblock_file *mbfp;
-    merr_t              err;
-    int                 rc;
-
-    if (!mbfsp || !mbidv || file_id(*mbidv) > mbfsp->mhdr.fcnt)
-        return merr(EINVAL);
+    uint64_t l = *(const uint64_t *)lhs;
+    uint64_t r = *(const uint64_t *)rhs;
 
-    if (mbidc > 1)
-        return merr(ENOTSUP);
+    if (file_id(l) != file_id(r))
+        return file_id(l) < file_id(r) ? -1 : 1;
 
-    mbfp = mbfsp->filev[file_index(*mbidv)];
+    l &= MBID_BLOCK_MASK;
+    r &= MBID_BLOCK_MASK;
 
-    err = mblock_file_commit(mbfp, mbidv, mbidc);
-    if (err)
-        return err;
-
-    rc = fdatasync(mbfsp->metafd);
-    if (rc == -1)
-        return merr(errno);
-
-    return 0;
+    return (l > r) - (l < r);
 }
 
-merr_t
-mblock_fset_delete(struct mblock_fset *mbfsp, uint64_t *mbidv, int mbidc)
+/*
+ * Apply a commit or delete to a vector of mblocks that may span any number
+ * of files in the file set.  The vector is grouped by file so that each
+ * file logs its share of the batch under a single acquisition of its meta
+ * lock, after which the metadata file is synced once for the entire batch.
+ */
+static merr_t
+mblock_fset_meta_batch(
+    struct mblock_fset *mbfsp,
+    uint64_t           *mbidv,
+    int                 mbidc,
+    merr_t            (*fn)(struct mblock_file *, uint64_t *, int))
 {
-    struct mblock_file *mbfp;
-    merr_t              err;
-    int                 rc;
+    uint64_t  mbidbuf[32], *sortv = mbidv;
+    merr_t    err = 0;
+    int       i, j, rc;
+    bool      logged = false;
 
-    if (!mbfsp || !mbidv || file_id(*mbidv) > mbfsp->mhdr.fcnt)
+    if (!mbfsp || !mbidv || mbidc < 1)
         return merr(EINVAL);
 
-    if (mbidc > 1)
-        return merr(ENOTSUP);
+    for (i = 0; i < mbidc; i++) {
+        if (file_id(mbidv[i]) == 0 || file_id(mbidv[i]) > mbfsp->mhdr.fcnt)
+            return merr(EINVAL);
+    }
 
-    mbfp = mbfsp->filev[file_index(*mbidv)];
+    if (mbidc > 1) {
+        sortv = mbidbuf;
+        if ((size_t)mbidc > NELEM(mbidbuf)) {
+            sortv = malloc(mbidc * sizeof(*sortv));
+            if (ev(!sortv))
+                return merr(ENOMEM);
+        }
 
-    err = mblock_file_delete(mbfp, mbidv, mbidc);
-    if (err)
-        return err;
+        memcpy(sortv, mbidv, mbidc * sizeof(*sortv));
+        qsort(sortv, mbidc, sizeof(*sortv), mbid_file_cmp);
+    }
 
-    rc = fdatasync(mbfsp->metafd);
-    if (rc == -1)
-        return merr(errno);
+    for (i = 0; i < mbidc; i = j) {
+        for (j = i + 1; j < mbidc; j++) {
+            if (file_id(sortv[j]) != file_id(sortv[i]))
+                break;
+        }
 
-    return 0;
+        err = fn(mbfsp->filev[file_index(sortv[i])], sortv + i, j - i);
+        if (err)
+            break;
+
+        logged = true;
+    }
+
+    if (sortv != mbidv && sortv != mbidbuf)
+        free(sortv);
+
+    /* Make whatever was logged durable even if a later file failed.
+     */
+    if (logged) {
+        rc = fdatasync(mbfsp->metafd);
+        if (rc == -1 && !err)
+            err = merr(errno);
+    }
+
+    return err;
+}
+
+merr_t
+mblock_fset_commit(struct mblock_fset *mbfsp, uint64_t *mbidv, int mbidc)
+{
+    return mblock_fset_meta_batch(mbfsp, mbidv, mbidc, mblock_file_commit);
+}
+
+merr_t
+mblock_fset_delete(struct mblock_fset *mbfsp, uint64_t *mbidv, int mbidc)
+{
+    return mblock_fset_meta_batch(mbfsp, mbidv, mbidc, mblock_file_delete);
 }
 
 merr_t
@@ -741,6 +781,27 @@ mblock_fset_read(
     return mblock_read(mbfp, mbid, iov, iovc, off);
 }
 
+merr_t
+mblock_fset_read_async(
+    struct mblock_fset *mbfsp,
+    struct io_batch    *batch,
+    uint64_t            mbid,
+    const struct iovec *iov,
+    int                 iovc,
+    off_t               off,
+    io_batch_cb        *cb,
+    void               *cbarg)
+{
+    struct mblock_file *mbfp;
+
+    if (!mbfsp || file_id(mbid) > mbfsp->mhdr.fcnt)
+        return merr(EINVAL);
+
+    mbfp = mbfsp->filev[file_index(mbid)];
+
+    return mblock_read_async(mbfp, batch, mbid, iov, iovc, off, cb, cbarg);
+}
+
 merr_t
 mblock_fset_map_getbase(struct mblock_fset *mbfsp, uint64_t mbid, char **addr_out, uint32_t *wlen)
 {
@@ -85,8 +85,11 @@ mblock_fset_alloc(struct mblock_fset *mbfsp, uint32_t flags, int mbidc, uint64_t
  * mblock_fset_commit() - commit mblocks
  *
  * @mbfsp: mblock fileset handle
- * @mbidv: mblock id
- * @mbidc: mblock count (support only mbidc == 1)
+ * @mbidv: vector of mblock ids (may span files in the fileset)
+ * @mbidc: mblock count
+ *
+ * The metadata updates for the entire vector are made durable with a single
+ * sync of the fileset's metadata file.
  */
 merr_t
 mblock_fset_commit(struct mblock_fset *mbfsp, uint64_t *mbidv, int mbidc);
@@ -95,8 +98,11 @@ mblock_fset_commit(struct mblock_fset *mbfsp, uint64_t *mbidv, int mbidc);
  * mblock_fset_delete() - delete mblocks
  *
  * @mbfsp: mblock fileset handle
- * @mbidv: mblock id
- * @mbidc: mblock count (support only mbidc == 1)
+ * @mbidv: vector of mblock ids (may span files in the fileset)
+ * @mbidc: mblock count
+ *
+ * The metadata updates for the entire vector are made durable with a single
+ * sync of the fileset's metadata file.
  */
 merr_t
 mblock_fset_delete(struct mblock_fset *mbfsp, uint64_t *mbidv, int mbidc);
@@ -129,6 +135,29 @@ mblock_fset_read(
     int                 iovc,
     off_t               off);
 
+/**
+ * mblock_fset_read_async() - queue an mblock read to an io batch
+ *
+ * @mbfsp: mblock fileset handle
+ * @batch: io batch
+ * @mbid:  mblock id
+ * @iov:   iovec ptr
+ * @iovc:  iovec cnt
+ * @off:   offset to read from
+ * @cb:    completion callback
+ * @cbarg: completion callback argument
+ */
+merr_t
+mblock_fset_read_async(
+    struct mblock_fset *mbfsp,
+    struct io_batch    *batch,
+    uint64_t            mbid,
+    const struct iovec *iov,
+    int                 iovc,
+    off_t               off,
+    io_batch_cb        *cb,
+    void               *cbarg);
+
 /**
  * mblock_fset_find() - find an mblock and return props
  *
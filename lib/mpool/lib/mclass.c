@@ -186,7 +186,7 @@ mclass_files_prefix(const char *path)
     const char *base = basename(path);
 
     return strstr(base, MBLOCK_FILE_PFX) || strstr(base, MDC_FILE_PFX) ||
-        strstr(base, WAL_FILE_PFX);
+        strstr(base, WAL_FILE_PFX) || strstr(base, VCOMP_DICT_FILE_PFX);
 }
 
 static struct workqueue_struct *mpdwq;
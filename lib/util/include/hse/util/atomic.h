@@ -56,6 +56,9 @@
 #define atomic_set_rel(_ptr, _val) \
     atomic_store_explicit((_ptr), (_val), memory_order_release)
 
+#define atomic_add_rel(_ptr, _val) \
+    (void)atomic_fetch_add_explicit((_ptr), (_val), memory_order_release)
+
 #define atomic_sub_rel(_ptr, _val) \
     (void)atomic_fetch_sub_explicit((_ptr), (_val), memory_order_release)
 
@@ -28,6 +28,9 @@
  */
 #define HSE_BT_BALANCE_THRESHOLD    (2)
 #define HSE_BT_SLABSZ               (PAGE_SIZE * 8)
+#define HSE_BT_KVLOCKS              (16)
+#define HSE_BT_CHUNKS               (16)
+#define HSE_BT_CHUNKSZ              (32 * 1024)
 #define HSE_BT_NODESPERSLAB \
     ((HSE_BT_SLABSZ - sizeof(struct bonsai_slab)) / sizeof(struct bonsai_node))
 
@@ -52,6 +55,11 @@
  */
 #define HSE_BTF_MANAGED             (0x0001)
 
+/* The value must be stored as put, c0 ingest must not compress it
+ * (see HSE_KVS_PUT_VCOMP_OFF).  Recorded on the value (bv_flags).
+ */
+#define HSE_BTF_VCOMP_OFF           (0x0002)
+
 enum bonsai_ior_code {
     B_IOR_INVALID       = 0,
     B_IOR_INSERTED      = 1,
@@ -90,6 +98,7 @@ struct bonsai_skey {
  * @bv_xlen:      opaque encoded value length
  * @bv_priv:      user-managed ptr
  * @bv_free:      ptr to next value in free list bkv_freevals
+ * @bv_flags:     HSE_BTF_VCOMP_OFF
  * @bv_valbuf:    value data (zero length if caller managed)
  *
  * A bonsai_val includes the value data and may be on both the bnkv_values
@@ -106,6 +115,7 @@ struct bonsai_val {
     u64                bv_xlen;
     struct bonsai_val *bv_priv;
     struct bonsai_val *bv_free;
+    u32                bv_flags;
     char               bv_valbuf[];
 };
 
@@ -156,6 +166,7 @@ bonsai_val_vlen(const struct bonsai_val *bv)
  * @bsv_val:      pointer to value data
  * @bsv_xlen:     opaque encoded value length
  * @bsv_seqnoref: sequence number reference
+ * @bsv_flags:    HSE_BTF_VCOMP_OFF
  *
  * Note that the value length (@bsv_xlen) is an opaque encoding of compressed
  * and uncompressed value lengths so one must use the bonsai_sval_vlen()
@@ -165,6 +176,7 @@ struct bonsai_sval {
     void     *bsv_val;
     u64       bsv_xlen;
     uintptr_t bsv_seqnoref;
+    u32       bsv_flags;
 };
 
 /**
@@ -280,6 +292,15 @@ struct bonsai_slab {
     struct bonsai_node      bs_entryv[];
 };
 
+/* struct bonsai_chunk - a chunk of the cheap for lock-free small allocations
+ * @bc_next:  next free byte in the chunk
+ * @bc_end:   end of the chunk
+ */
+struct bonsai_chunk {
+    atomic_ulong bc_next;
+    uintptr_t    bc_end;
+};
+
 /* struct bonsai_slabinfo -
  * @bsi_slab:       current slab from which to allocate entries
  * @bsi_rnodec:     count of recycled node allocations
@@ -334,6 +355,9 @@ typedef void bonsai_ior_cb(
  * @br_slabbase:        ptr to base of slabs embedded in bonsai_root
  * @br_key_alloc:       total number of keys ever allocated
  * @br_val_alloc:       total number of values ever allocated
+ * @br_alloc_lock:      serializes allocations from br_cheap
+ * @br_chunkv:          per-cpu chunks of br_cheap for small allocations
+ * @br_kvlockv:         protects the value lists of keys (hashed by kv)
  * @br_kv:              a circular k/v list, next=head, prev=tail
  * @br_gc_lock:         protects gc queues between user and rcu callback
  * @br_gc_waitq:        list of slabs waiting to get on the ready queue
@@ -362,10 +386,20 @@ struct bonsai_root {
      */
     int                     br_height HSE_L1D_ALIGNED;
     ulong                   br_key_alloc;
-    ulong                   br_val_alloc;
+    atomic_ulong            br_val_alloc;
     struct bonsai_kv       *br_vfkeys;
     struct bonsai_kv       *br_rfkeys;
 
+    spinlock_t              br_alloc_lock HSE_L1D_ALIGNED;
+
+    struct {
+        struct bonsai_chunk * _Atomic chunk HSE_L1D_ALIGNED;
+    } br_chunkv[HSE_BT_CHUNKS];
+
+    struct {
+        spinlock_t          lock HSE_L1D_ALIGNED;
+    } br_kvlockv[HSE_BT_KVLOCKS];
+
     spinlock_t              br_gc_lock HSE_L1D_ALIGNED;
     struct bonsai_slab     *br_gc_waitq;
     struct bonsai_slab     *br_gc_readyq;
@@ -413,6 +447,19 @@ bn_create(
     void                *cbarg,
     struct bonsai_root **tree);
 
+/**
+ * bn_cheap_alloc() - allocate memory from the tree's cheap
+ * @tree:  bonsai tree instance (must be cheap backed)
+ * @align: alignment
+ * @sz:    size
+ *
+ * Allocations are serialized with the tree's own allocations, so this is
+ * safe to call concurrently with updates to the tree.  The memory is
+ * released when the cheap is reset or destroyed.
+ */
+void *
+bn_cheap_alloc(struct bonsai_root *tree, size_t align, size_t sz);
+
 /**
  * bn_reset() - Resets bonsai tree.
  * @tree: bonsai tree instance
@@ -454,6 +501,31 @@ bn_insert_or_replace(
     const struct bonsai_skey *skey,
     struct bonsai_sval       *sval);
 
+/**
+ * bn_update() - Add or replace a value of a key that is already in the tree
+ * @tree: bonsai tree instance
+ * @skey: bonsai_skey instance containing the key and its related info
+ * @sval: bonsai_sval instance containing the value and its related info
+ *
+ * bn_update() behaves like bn_insert_or_replace() for a key that is
+ * already in the tree, but it does not modify the shape of the tree.
+ * Hence it may be called without the bonsai tree mutex, concurrently
+ * with other calls to bn_update() and with bn_insert_or_replace().
+ * Updates to the same key are serialized by a per-key lock, which is
+ * held across the client's insert-or-replace callback.
+ *
+ * - Caller must hold rcu_read_lock() across this call.
+ * - Must not be used concurrently with bn_delete().
+ *
+ * Return: 0 upon success, ENOENT if the key is not in the tree,
+ * error code otherwise
+ */
+merr_t
+bn_update(
+    struct bonsai_root *      tree,
+    const struct bonsai_skey *skey,
+    struct bonsai_sval       *sval);
+
 /**
  * bn_delete() - remove and delete the given key from the tree
  * @tree: bonsai tree instance
@@ -595,6 +667,7 @@ bn_sval_init(void *val, u64 xlen, uintptr_t seqnoref, struct bonsai_sval *sval)
     sval->bsv_val = val;
     sval->bsv_xlen = xlen;
     sval->bsv_seqnoref = seqnoref;
+    sval->bsv_flags = 0;
 }
 
 static inline s32
@@ -664,8 +737,11 @@ bn_kv_cmp_rev(const void *lhs, const void *rhs)
  * since cursors and ingest might use it long after dropping
  * the rcu read lock.
  *
- * Caller must hold the bonsai tree mutex or be operating in
- * a single threaded environment.
+ * Caller must hold the kv's value list lock (see bn_kvlock() in
+ * bonsai_tree.c) or be operating in a single threaded environment.
+ * bn_update() and bn_insert_or_replace() both modify a kv's value
+ * lists only under that lock, so the tree mutex alone does not
+ * suffice.
  */
 static HSE_ALWAYS_INLINE void
 bn_val_rcufree(struct bonsai_kv *kv, struct bonsai_val *dval)
@@ -0,0 +1,83 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+#ifndef HSE_UTIL_COMPRESS_ZSTD_H
+#define HSE_UTIL_COMPRESS_ZSTD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <hse/util/compression.h>
+
+#include <zstd.h>
+
+/* A zstd compressed buffer is a one byte tag followed by a standard zstd
+ * frame less its four byte magic number.  The tag lets readers tell zstd
+ * output apart from an LZ4 block, whose first byte is never less than 0x10.
+ */
+#define COMPRESS_ZSTD_TAG   (0x01)
+
+extern struct compress_ops compress_zstd_ops;
+
+/**
+ * compress_zstd_compress() - compress with a given level and/or dictionary
+ * @src:          source buffer
+ * @src_len:      source length
+ * @dst:          output buffer
+ * @dst_capacity: output buffer size (see cop_estimate)
+ * @dst_len:      compressed length (output)
+ * @level:        zstd compression level (ignored if %cdict is not NULL)
+ * @cdict:        digested dictionary (may be NULL)
+ *
+ * The dictionary must have been registered via compress_zstd_dict_register()
+ * for the output to be decompressible by cop_decompress.
+ */
+merr_t
+compress_zstd_compress(
+    const void       *src,
+    uint              src_len,
+    void             *dst,
+    uint              dst_capacity,
+    uint             *dst_len,
+    int               level,
+    const ZSTD_CDict *cdict);
+
+/**
+ * compress_zstd_dict_register() - make a dictionary available for decompression
+ * @dict:   dictionary content
+ * @len:    dictionary length
+ * @id_out: dictionary ID (output)
+ *
+ * Registrations are reference counted by dictionary ID.  Returns EEXIST if
+ * a different dictionary with the same ID is already registered.
+ */
+merr_t
+compress_zstd_dict_register(const void *dict, size_t len, uint32_t *id_out);
+
+/**
+ * compress_zstd_dict_unregister() - drop a reference on a dictionary
+ * @id: dictionary ID from compress_zstd_dict_register()
+ */
+void
+compress_zstd_dict_unregister(uint32_t id);
+
+/**
+ * compress_zstd_train() - train a dictionary from a set of samples
+ * @samples:  concatenated samples
+ * @sizes:    sample sizes
+ * @nsamples: number of samples
+ * @dict:     dictionary buffer
+ * @capacity: dictionary buffer size (maximum dictionary size)
+ * @len_out:  dictionary length (output)
+ */
+merr_t
+compress_zstd_train(
+    const void   *samples,
+    const size_t *sizes,
+    uint          nsamples,
+    void         *dict,
+    size_t        capacity,
+    size_t       *len_out);
+
+#endif
@@ -0,0 +1,158 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_PLATFORM_FUSE_FILTER_H
+#define HSE_PLATFORM_FUSE_FILTER_H
+
+#include <hse/error/merr.h>
+#include <hse/util/compiler.h>
+#include <hse/util/inttypes.h>
+
+/* A binary fuse filter (Graf & Lemire, "Binary Fuse Filters: Fast and
+ * Smaller Than Xor Filters", 2022) is a static filter built from the full
+ * set of key hashes.  Each key maps to three fingerprint slots in adjacent
+ * segments, and a lookup reports a hit if the xor of the three slots equals
+ * the key's fingerprint.  With 8-bit fingerprints the false positive rate
+ * is 1/256 at roughly 9 bits per key (versus 11 bits per key for a 1% rate
+ * from a blocked bloom), and with 16-bit fingerprints it is 1/65536.
+ */
+#define FUSE_ARITY          (3)
+#define FUSE_SEGLEN_MAX     (1u << 18)
+
+/**
+ * struct fuse_filter -
+ * @ff_fpv:      fingerprint array (8 or 16 bit elements)
+ * @ff_fpbits:   bits per fingerprint (8 or 16)
+ * @ff_seed:     hash seed for which construction succeeded
+ * @ff_seglen:   number of fingerprints per segment (power of two)
+ * @ff_segcntlen: number of fingerprints in all possible first segments
+ * @ff_arraylen: number of fingerprints in @ff_fpv
+ */
+struct fuse_filter {
+    void    *ff_fpv;
+    uint32_t ff_fpbits;
+    uint32_t ff_seed;
+    uint32_t ff_seglen;
+    uint32_t ff_segcntlen;
+    uint32_t ff_arraylen;
+};
+
+static HSE_ALWAYS_INLINE u64
+fuse_mix(u64 hash, u32 seed)
+{
+    u64 h = hash + seed;
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+
+    return h;
+}
+
+static HSE_ALWAYS_INLINE u32
+fuse_fingerprint(u64 h, u32 fpbits)
+{
+    return (h ^ (h >> 32)) & ((1u << fpbits) - 1);
+}
+
+/**
+ * fuse_hash2pos() - compute the three fingerprint slots of a mixed hash
+ * @h:         hash from fuse_mix()
+ * @seglen:    segment length
+ * @segcntlen: segment count length
+ * @posv:      (output) slot indices
+ */
+static HSE_ALWAYS_INLINE void
+fuse_hash2pos(u64 h, u32 seglen, u32 segcntlen, u32 *posv)
+{
+    u64 hi = ((unsigned __int128)h * segcntlen) >> 64;
+
+    posv[0] = hi;
+    posv[1] = (hi + seglen) ^ ((h >> 18) & (seglen - 1));
+    posv[2] = (hi + 2 * seglen) ^ (h & (seglen - 1));
+}
+
+static HSE_ALWAYS_INLINE u32
+fuse_fp_get(const void *fpv, u32 fpbits, u32 pos)
+{
+    return (fpbits == 8) ? ((const u8 *)fpv)[pos] : ((const u16 *)fpv)[pos];
+}
+
+/**
+ * fuse_lookup() - check to see if hash may be in the filter
+ * @ff:   filter
+ * @hash: key hash
+ */
+static HSE_ALWAYS_INLINE bool
+fuse_lookup(const struct fuse_filter *ff, u64 hash)
+{
+    u64 h = fuse_mix(hash, ff->ff_seed);
+    u32 posv[FUSE_ARITY];
+    u32 fp;
+
+    fuse_hash2pos(h, ff->ff_seglen, ff->ff_segcntlen, posv);
+
+    fp = fuse_fingerprint(h, ff->ff_fpbits);
+    fp ^= fuse_fp_get(ff->ff_fpv, ff->ff_fpbits, posv[0]);
+    fp ^= fuse_fp_get(ff->ff_fpv, ff->ff_fpbits, posv[1]);
+    fp ^= fuse_fp_get(ff->ff_fpv, ff->ff_fpbits, posv[2]);
+
+    return fp == 0;
+}
+
+/**
+ * fuse_fpbits_est() - fingerprint width for a false positive probability
+ * @probability: false positive probability in parts per million
+ */
+u32
+fuse_fpbits_est(u32 probability);
+
+/**
+ * fuse_size_estimate() - size in bytes of a filter for %num_elmnts keys
+ * @fpbits:     bits per fingerprint
+ * @num_elmnts: number of keys
+ */
+size_t
+fuse_size_estimate(u32 fpbits, u32 num_elmnts);
+
+/**
+ * fuse_element_estimate() - number of keys a filter of the given size can hold
+ * @fpbits:        bits per fingerprint
+ * @size_in_bytes: filter size
+ */
+u32
+fuse_element_estimate(u32 fpbits, size_t size_in_bytes);
+
+/**
+ * fuse_filter_init() - initialize filter geometry for %exp_elmts keys
+ * @filter:     filter
+ * @fpbits:     bits per fingerprint (8 or 16)
+ * @exp_elmts:  number of keys
+ * @storage:    fingerprint storage
+ * @storage_sz: size of %storage (at least fuse_size_estimate() bytes)
+ */
+void
+fuse_filter_init(
+    struct fuse_filter *filter,
+    u32                 fpbits,
+    u32                 exp_elmts,
+    void               *storage,
+    size_t              storage_sz);
+
+/**
+ * fuse_filter_populate() - construct the filter from its full key set
+ * @filter: filter initialized by fuse_filter_init()
+ * @hashv:  key hashes (may be reordered)
+ * @len:    number of key hashes, not more than exp_elmts
+ *
+ * Construction may have to retry with different seeds, and fails with
+ * EAGAIN in the (very unlikely) event that none of them work.
+ */
+merr_t
+fuse_filter_populate(struct fuse_filter *filter, u64 *hashv, u32 len);
+
+#endif
@@ -10,6 +10,7 @@
 #include <hse/util/minmax.h>
 #include <hse/util/assert.h>
 #include <hse/util/compiler.h>
+#include <hse/util/keycmp.h>
 
 /* Max number of a key's bytes that we can store in a key_immediate
  * minus 4 (i.e., the skidx byte + dlen byte + two bytes used to
@@ -104,7 +105,7 @@ key_immediate_cmp(const struct key_immediate *imm0, const struct key_immediate *
  * key1:        key data ptr
  * key1_len     key0 data length
  *
- * If memcmp returns 0, then either (1) keys are equal or (2)
+ * If keycmp_mem returns 0, then either (1) keys are equal or (2)
  * one key is a prefix of the other.  In either case returning
  * (len1 - len2) results in desired behavior:
  *
@@ -115,7 +116,7 @@ key_immediate_cmp(const struct key_immediate *imm0, const struct key_immediate *
 static HSE_ALWAYS_INLINE int
 key_inner_cmp(const void *key0, int key0_len, const void *key1, int key1_len)
 {
-    int rc = memcmp(key0, key1, min(key0_len, key1_len));
+    int rc = keycmp_mem(key0, key1, min(key0_len, key1_len));
 
     return rc ? rc : (key0_len - key1_len);
 }
@@ -285,7 +286,7 @@ key_obj_ncmp(const struct key_obj *ko1, const struct key_obj *ko2, uint cmplen)
      */
     len = min_t(uint, limitv[0], limitv[2]);
     if (HSE_LIKELY(k1 && k2)) {
-        rc = memcmp(k1, k2, len);
+        rc = keycmp_mem(k1, k2, len);
         if (HSE_LIKELY(rc))
             return rc;
     }
@@ -298,7 +299,7 @@ key_obj_ncmp(const struct key_obj *ko1, const struct key_obj *ko2, uint cmplen)
      */
     len = min_t(uint, limitv[1], limitv[2]) - len;
     if (HSE_LIKELY(k1 && k2)) {
-        rc = memcmp(k1, k2, len);
+        rc = keycmp_mem(k1, k2, len);
         if (HSE_LIKELY(rc))
             return rc;
     }
@@ -311,7 +312,7 @@ key_obj_ncmp(const struct key_obj *ko1, const struct key_obj *ko2, uint cmplen)
      */
     len = limitv[2] - pos;
     if (HSE_LIKELY(k1 && k2)) {
-        rc = memcmp(k1, k2, len);
+        rc = keycmp_mem(k1, k2, len);
         if (HSE_LIKELY(rc))
             return rc;
     }
@@ -378,7 +379,7 @@ key_obj_cmp_spl(const struct key_obj *ko1, const struct key_obj *ko2)
         uint len = min_t(uint, len1, len2);
         int  rc;
 
-        rc = memcmp(ko1->ko_sfx, ko2->ko_sfx, len);
+        rc = keycmp_mem(ko1->ko_sfx, ko2->ko_sfx, len);
         return rc == 0 ? len1 - len2 : rc;
     }
 
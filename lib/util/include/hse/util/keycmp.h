@@ -10,6 +10,93 @@
 #include <hse/util/compiler.h>
 #include <hse/util/inttypes.h>
 
+#if __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* Keys at least this long are handed off to the runtime selected
+ * (e.g., AVX2) longest-common-prefix routine, shorter keys are
+ * compared inline.
+ */
+#define KEYCMP_LCP_LONG_MIN     (64)
+
+/* Runtime selected LCP routine for long keys, see keycmp_init().
+ */
+extern size_t (*keycmp_lcp_long)(const void *s1, const void *s2, size_t len);
+
+/**
+ * keycmp_init() - select the keycmp kernels for the running cpu
+ */
+void
+keycmp_init(void);
+
+/**
+ * keycmp_lcp() - return longest common prefix of two byte arrays
+ * @s1:     byte array one
+ * @s2:     byte array two
+ * @len:    max length to compare
+ *
+ * Return: The length of the longest common prefix of %s1 and %s2,
+ * which is also the index of the first mismatched byte if less
+ * than %len.
+ */
+static HSE_ALWAYS_INLINE size_t
+keycmp_lcp(const void *s1, const void *s2, size_t len)
+{
+    const uint8_t *p1 = s1;
+    const uint8_t *p2 = s2;
+    size_t i = 0;
+
+    if (len >= KEYCMP_LCP_LONG_MIN)
+        return keycmp_lcp_long(s1, s2, len);
+
+#if __SSE2__
+    while (i + 16 <= len) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(p1 + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(p2 + i));
+        uint mask = _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) ^ 0xffffu;
+
+        if (mask)
+            return i + __builtin_ctz(mask);
+        i += 16;
+    }
+#endif
+
+    while (i + 8 <= len) {
+        uint64_t a, b;
+
+        memcpy(&a, p1 + i, sizeof(a));
+        memcpy(&b, p2 + i, sizeof(b));
+
+        if (a != b) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            return i + (__builtin_ctzll(a ^ b) >> 3);
+#else
+            return i + (__builtin_clzll(a ^ b) >> 3);
+#endif
+        }
+        i += 8;
+    }
+
+    while (i < len && p1[i] == p2[i])
+        i++;
+
+    return i;
+}
+
+/**
+ * keycmp_mem() - lexicographic compare of two byte arrays of equal length
+ *
+ * Like memcmp(), but inlined for the short keys typical of kvs keys.
+ */
+static HSE_ALWAYS_INLINE int
+keycmp_mem(const void *s1, const void *s2, size_t len)
+{
+    size_t i = keycmp_lcp(s1, s2, len);
+
+    return (i < len) ? (int)((const uint8_t *)s1)[i] - (int)((const uint8_t *)s2)[i] : 0;
+}
+
 /*
  * Return value:
  *   0            : keys are equal
@@ -20,7 +107,7 @@ static inline int
 keycmp(const void *key1, u32 len1, const void *key2, u32 len2)
 {
     /*
-     * If memcmp returns 0, then either (1) keys are equal or (2)
+     * If keycmp_mem returns 0, then either (1) keys are equal or (2)
      * one key is a prefix of the other.  In either case returning
      * len1-len2 results in desired behavior:
      *
@@ -29,7 +116,7 @@ keycmp(const void *key1, u32 len1, const void *key2, u32 len2)
      *   len1 >  len2 --> return pos (key1 > key2).
      */
     size_t len = len1 < len2 ? len1 : len2;
-    int    rc = memcmp(key1, key2, len);
+    int    rc = keycmp_mem(key1, key2, len);
     return rc == 0 ? (int)(len1 - len2) : rc;
 }
 
@@ -43,12 +130,12 @@ static HSE_ALWAYS_INLINE int
 keycmp_prefix(const void *pfx, u32 pfxlen, const void *key, u32 keylen)
 {
     if (keylen < pfxlen) {
-        int rc = memcmp(pfx, key, keylen);
+        int rc = keycmp_mem(pfx, key, keylen);
 
         return rc ? rc : 1;
     }
 
-    return memcmp(pfx, key, pfxlen);
+    return keycmp_mem(pfx, key, pfxlen);
 }
 
 #endif
@@ -48,7 +48,7 @@ bn_summary(struct bonsai_root *tree, char *buf, size_t bufsz)
     return snprintf(
         buf, bufsz, "%2d %2d  keys %lu  vals %lu  nodes %lu,%lu,%u  %.2lf  (%u %lu %3lu) %s",
         tree->br_height, atomic_read(&tree->br_bounds),
-        tree->br_key_alloc, tree->br_key_alloc + tree->br_val_alloc,
+        tree->br_key_alloc, tree->br_key_alloc + atomic_read(&tree->br_val_alloc),
         nodec, rnodec, slabc,
         (double)(nodec + rnodec) / tree->br_key_alloc,
         atomic_read(&tree->br_gc_rcugen_done),
@@ -57,33 +57,49 @@ bn_summary(struct bonsai_root *tree, char *buf, size_t bufsz)
         sibuf);
 }
 
-static struct bonsai_node *
+static HSE_ALWAYS_INLINE spinlock_t *
+bn_kvlock(struct bonsai_root *tree, const struct bonsai_kv *kv)
+{
+    uintptr_t idx = (uintptr_t)kv / HSE_L1D_LINESIZE;
+
+    return &tree->br_kvlockv[idx % NELEM(tree->br_kvlockv)].lock;
+}
+
+static merr_t
 bn_ior_replace(
     struct bonsai_root *      tree,
     const struct bonsai_skey *skey,
     struct bonsai_sval       *sval,
-    struct bonsai_node       *node)
+    struct bonsai_kv         *kv)
 {
     struct bonsai_val *oldv = NULL, *v;
     enum bonsai_ior_code code;
+    spinlock_t *lock;
 
+    /* Allocate and copy in the value before acquiring the kv lock
+     * so as to keep the critical section as short as possible.
+     */
     v = bn_val_alloc(tree, sval, skey->bsk_flags & HSE_BTF_MANAGED);
     if (!v)
-        return NULL;
+        return merr(ENOMEM);
 
     SET_IOR_REPORADD(code);
 
-    tree->br_ior_cb(tree->br_ior_cbarg, &code, node->bn_kv, v, &oldv, tree->br_height);
+    lock = bn_kvlock(tree, kv);
+    spin_lock(lock);
+
+    tree->br_ior_cb(tree->br_ior_cbarg, &code, kv, v, &oldv, tree->br_height);
 
     /* oldv must remain visible for the life of the kv since cursors
      * might use it long after dropping the rcu read lock.
      */
     if (oldv)
-        bn_val_rcufree(node->bn_kv, oldv);
+        bn_val_rcufree(kv, oldv);
 
     sval->bsv_seqnoref = v->bv_seqnoref;
+    spin_unlock(lock);
 
-    return tree->br_root;
+    return 0;
 }
 
 static struct bonsai_node *
@@ -172,7 +188,7 @@ bn_ior_impl(
     assert(n < NELEM(stack)); /* should never ever fail */
 
     if (node)
-        return bn_ior_replace(tree, skey, sval, node);
+        return bn_ior_replace(tree, skey, sval, node->bn_kv) ? NULL : tree->br_root;
 
     if (n > 0) {
         struct bonsai_node *parent;
@@ -547,6 +563,24 @@ bn_insert_or_replace(
     return 0;
 }
 
+merr_t
+bn_update(
+    struct bonsai_root *      tree,
+    const struct bonsai_skey *skey,
+    struct bonsai_sval       *sval)
+{
+    struct bonsai_kv *kv;
+
+    if (atomic_read(&tree->br_bounds))
+        return merr(ENOMEM);
+
+    kv = bn_find_impl(tree, skey, B_MATCH_EQ);
+    if (!kv)
+        return merr(ENOENT);
+
+    return bn_ior_replace(tree, skey, sval, kv);
+}
+
 merr_t
 bn_delete(
     struct bonsai_root       *tree,
@@ -781,6 +815,10 @@ bn_reset(struct bonsai_root *tree)
     tree->br_kv.bkv_prev = &tree->br_kv;
     tree->br_kv.bkv_next = &tree->br_kv;
 
+    spin_lock_init(&tree->br_alloc_lock);
+    for (size_t i = 0; i < NELEM(tree->br_kvlockv); ++i)
+        spin_lock_init(&tree->br_kvlockv[i].lock);
+
     spin_lock_init(&tree->br_gc_lock);
     atomic_set(&tree->br_gc_rcugen_start, 1);
     atomic_set(&tree->br_gc_rcugen_done, 1);
@@ -848,6 +886,77 @@ bn_create(
     return 0;
 }
 
+static void *
+bn_chunk_alloc(struct bonsai_chunk *chunk, size_t align, size_t sz)
+{
+    ulong next, addr;
+
+    next = atomic_read(&chunk->bc_next);
+    do {
+        addr = ALIGN(next, align);
+        if (addr + sz > chunk->bc_end)
+            return NULL;
+    } while (!atomic_compare_exchange_weak(&chunk->bc_next, &next, addr + sz));
+
+    return (void *)addr;
+}
+
+/* Small allocations are bump allocated lock-free from a per-cpu chunk of
+ * the cheap.  br_alloc_lock is taken only to replace an exhausted chunk
+ * and for allocations too large to be carved from one, such that puts to
+ * the same tree from many threads do not serialize on it.
+ */
+void *
+bn_cheap_alloc(struct bonsai_root *tree, size_t align, size_t sz)
+{
+    struct bonsai_chunk * _Atomic *chunkp;
+    struct bonsai_chunk *chunk;
+    void *mem;
+
+    INVARIANT(tree && tree->br_cheap);
+
+    if (align & (align - 1))
+        return NULL;
+
+    if (sz > HSE_BT_CHUNKSZ / 8) {
+        spin_lock(&tree->br_alloc_lock);
+        mem = cheap_memalign(tree->br_cheap, align, sz);
+        spin_unlock(&tree->br_alloc_lock);
+
+        return mem;
+    }
+
+    chunkp = &tree->br_chunkv[hse_getcpu(NULL) % NELEM(tree->br_chunkv)].chunk;
+
+    while (1) {
+        struct bonsai_chunk *old = atomic_read_acq(chunkp);
+
+        if (old) {
+            mem = bn_chunk_alloc(old, align, sz);
+            if (mem)
+                return mem;
+        }
+
+        spin_lock(&tree->br_alloc_lock);
+        if (atomic_read(chunkp) == old) {
+            chunk = cheap_memalign(tree->br_cheap, __alignof__(*chunk), HSE_BT_CHUNKSZ);
+            if (!chunk) {
+                /* The cheap might still have room for this allocation.
+                 */
+                mem = cheap_memalign(tree->br_cheap, align, sz);
+                spin_unlock(&tree->br_alloc_lock);
+
+                return mem;
+            }
+
+            atomic_set(&chunk->bc_next, (ulong)(chunk + 1));
+            chunk->bc_end = (uintptr_t)chunk + HSE_BT_CHUNKSZ;
+            atomic_set_rel(chunkp, chunk);
+        }
+        spin_unlock(&tree->br_alloc_lock);
+    }
+}
+
 void
 bn_destroy(struct bonsai_root *tree)
 {
@@ -239,7 +239,7 @@ bn_slab_alloc(struct bonsai_root *tree, struct bonsai_slabinfo *slabinfo)
     bool canfree;
 
     if (tree->br_cheap) {
-        slab = cheap_memalign(tree->br_cheap, __alignof__(*slab), HSE_BT_SLABSZ);
+        slab = bn_cheap_alloc(tree, __alignof__(*slab), HSE_BT_SLABSZ);
         canfree = false;
     } else {
         slab = aligned_alloc(__alignof__(*slab), HSE_BT_SLABSZ);
@@ -349,13 +349,16 @@ bn_node_alloc(struct bonsai_root *tree, int height, uint skidx)
     return bn_node_alloc_impl(tree, skidx % (NELEM(tree->br_slabinfov) - 2));
 }
 
+/* bn_update() allocates values without the tree mutex, so allocations from
+ * the cheap must go through bn_cheap_alloc().
+ */
 static void *
 bn_alloc(struct bonsai_root *tree, size_t sz)
 {
-    if (tree->br_cheap)
-        return cheap_malloc(tree->br_cheap, sz);
+    if (!tree->br_cheap)
+        return malloc(sz);
 
-    return malloc(sz);
+    return bn_cheap_alloc(tree, tree->br_cheap->alignment, sz);
 }
 
 static struct bonsai_val *
@@ -365,6 +368,7 @@ bn_val_init(struct bonsai_val *v, const struct bonsai_sval *sval, size_t sz)
     v->bv_seqnoref = sval->bsv_seqnoref;
     v->bv_value = sval->bsv_val;
     v->bv_xlen = sval->bsv_xlen;
+    v->bv_flags = sval->bsv_flags;
 
     if (sz > sizeof(*v)) {
         memcpy(v->bv_valbuf, sval->bsv_val, sz - sizeof(*v));
@@ -388,7 +392,7 @@ bn_val_alloc(struct bonsai_root *tree, const struct bonsai_sval *sval, bool mana
     v = bn_alloc(tree, sz);
     if (v) {
         v = bn_val_init(v, sval, sz);
-        tree->br_val_alloc++;
+        atomic_inc(&tree->br_val_alloc);
     }
 
     return v;
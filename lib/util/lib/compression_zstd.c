@@ -0,0 +1,426 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <pthread.h>
+
+#include <urcu-bp.h>
+#include <zdict.h>
+
+#include <hse/util/alloc.h>
+#include <hse/util/assert.h>
+#include <hse/util/atomic.h>
+#include <hse/util/event_counter.h>
+#include <hse/util/minmax.h>
+#include <hse/util/mutex.h>
+#include <hse/util/compression_zstd.h>
+#include <hse/logging/logging.h>
+
+#if ZSTD_VERSION_NUMBER < (10000 + 400 + 0)
+#error "Need zstd 1.4.0 or higher"
+#endif
+
+#define ZSTD_MAGIC_LEN      (4)
+#define ZSTD_HDRLEN_MAX     (18)
+#define ZSTD_DICT_MAX       (64)
+
+/**
+ * struct zstd_dict - a registered decompression dictionary
+ * @zd_id:     dictionary ID
+ * @zd_refcnt: number of registrations (protected by zstd_dict_lock)
+ * @zd_ddict:  digested dictionary
+ * @zd_rcu:    for freeing once lookups can no longer see it
+ * @zd_len:    length of zd_data[]
+ * @zd_data:   dictionary content
+ */
+struct zstd_dict {
+    uint32_t        zd_id;
+    uint            zd_refcnt;
+    ZSTD_DDict     *zd_ddict;
+    struct rcu_head zd_rcu;
+    size_t          zd_len;
+    char            zd_data[];
+};
+
+struct zstd_tls {
+    ZSTD_CCtx *zt_cctx;
+    ZSTD_DCtx *zt_dctx;
+};
+
+static const uint8_t zstd_magic[ZSTD_MAGIC_LEN] = { 0x28, 0xb5, 0x2f, 0xfd };
+
+/* Lookups are lock-free, a lookup and the decompression that uses its result
+ * run within an rcu read-side critical section so that an unregistered
+ * dictionary is freed only after all such readers have finished with it.
+ */
+static struct zstd_dict * _Atomic zstd_dictv[ZSTD_DICT_MAX];
+static DEFINE_MUTEX(zstd_dict_lock);
+
+/* Compression contexts are expensive to create and hold large work areas,
+ * so each thread caches one of each for reuse.
+ */
+static thread_local struct zstd_tls *zstd_tls;
+static pthread_key_t zstd_tls_key;
+static pthread_once_t zstd_tls_once = PTHREAD_ONCE_INIT;
+
+static void
+zstd_tls_key_dtor(void *arg)
+{
+    struct zstd_tls *tls = arg;
+
+    ZSTD_freeCCtx(tls->zt_cctx);
+    ZSTD_freeDCtx(tls->zt_dctx);
+    free(tls);
+}
+
+static void
+zstd_tls_key_init(void)
+{
+    if (pthread_key_create(&zstd_tls_key, zstd_tls_key_dtor))
+        ev(1);
+}
+
+static struct zstd_tls *
+zstd_tls_get(void)
+{
+    struct zstd_tls *tls = zstd_tls;
+
+    if (HSE_LIKELY(tls))
+        return tls;
+
+    pthread_once(&zstd_tls_once, zstd_tls_key_init);
+
+    tls = calloc(1, sizeof(*tls));
+    if (ev(!tls))
+        return NULL;
+
+    pthread_setspecific(zstd_tls_key, tls);
+    zstd_tls = tls;
+
+    return tls;
+}
+
+static void
+zstd_dict_free_cb(struct rcu_head *rh)
+{
+    struct zstd_dict *zd = container_of(rh, struct zstd_dict, zd_rcu);
+
+    ZSTD_freeDDict(zd->zd_ddict);
+    free(zd);
+}
+
+/* Caller must hold rcu_read_lock() for as long as it uses the result.
+ */
+static const ZSTD_DDict *
+zstd_dict_lookup(uint32_t id)
+{
+    for (uint i = 0; i < ZSTD_DICT_MAX; ++i) {
+        struct zstd_dict *zd = atomic_read_acq(&zstd_dictv[(id + i) % ZSTD_DICT_MAX]);
+
+        if (zd && zd->zd_id == id)
+            return zd->zd_ddict;
+    }
+
+    return NULL;
+}
+
+merr_t
+compress_zstd_dict_register(const void *dict, size_t len, uint32_t *id_out)
+{
+    struct zstd_dict *zd, *old;
+    uint32_t id;
+    uint i, slot;
+    merr_t err = 0;
+
+    if (ev(!dict || !len || !id_out))
+        return merr(EINVAL);
+
+    /* Raw content dictionaries have no ID and cannot be told apart.
+     */
+    id = ZDICT_getDictID(dict, len);
+    if (ev(!id))
+        return merr(EINVAL);
+
+    zd = malloc(sizeof(*zd) + len);
+    if (ev(!zd))
+        return merr(ENOMEM);
+
+    zd->zd_id = id;
+    zd->zd_refcnt = 1;
+    zd->zd_len = len;
+    memcpy(zd->zd_data, dict, len);
+
+    zd->zd_ddict = ZSTD_createDDict(zd->zd_data, len);
+    if (ev(!zd->zd_ddict)) {
+        free(zd);
+        return merr(ENOMEM);
+    }
+
+    slot = ZSTD_DICT_MAX;
+
+    mutex_lock(&zstd_dict_lock);
+    for (i = 0; i < ZSTD_DICT_MAX; ++i) {
+        uint idx = (id + i) % ZSTD_DICT_MAX;
+
+        old = atomic_read(&zstd_dictv[idx]);
+        if (!old) {
+            if (slot == ZSTD_DICT_MAX)
+                slot = idx;
+            continue;
+        }
+
+        if (old->zd_id == id) {
+            if (old->zd_len == len && !memcmp(old->zd_data, dict, len))
+                old->zd_refcnt++;
+            else
+                err = merr(EEXIST);
+            break;
+        }
+    }
+
+    if (i == ZSTD_DICT_MAX) {
+        if (slot < ZSTD_DICT_MAX)
+            atomic_set_rel(&zstd_dictv[slot], zd);
+        else
+            err = merr(ENOSPC);
+    }
+    mutex_unlock(&zstd_dict_lock);
+
+    if (err || i < ZSTD_DICT_MAX) {
+        ZSTD_freeDDict(zd->zd_ddict);
+        free(zd);
+    }
+
+    if (!err)
+        *id_out = id;
+
+    return err;
+}
+
+void
+compress_zstd_dict_unregister(uint32_t id)
+{
+    struct zstd_dict *zd = NULL;
+
+    mutex_lock(&zstd_dict_lock);
+    for (uint i = 0; i < ZSTD_DICT_MAX; ++i) {
+        uint idx = (id + i) % ZSTD_DICT_MAX;
+
+        zd = atomic_read(&zstd_dictv[idx]);
+        if (zd && zd->zd_id == id) {
+            if (--zd->zd_refcnt == 0)
+                atomic_set(&zstd_dictv[idx], NULL);
+            else
+                zd = NULL;
+            break;
+        }
+
+        zd = NULL;
+    }
+    mutex_unlock(&zstd_dict_lock);
+
+    if (zd)
+        call_rcu(&zd->zd_rcu, zstd_dict_free_cb);
+}
+
+merr_t
+compress_zstd_train(
+    const void   *samples,
+    const size_t *sizes,
+    uint          nsamples,
+    void         *dict,
+    size_t        capacity,
+    size_t       *len_out)
+{
+    size_t len;
+
+    if (ev(!samples || !sizes || !dict || !len_out))
+        return merr(EINVAL);
+
+    len = ZDICT_trainFromBuffer(dict, capacity, samples, sizes, nsamples);
+    if (ZDICT_isError(len)) {
+        log_debug("training failed: %u samples, cap %zu: %s",
+                  nsamples, capacity, ZDICT_getErrorName(len));
+        return merr(ENODATA);
+    }
+
+    *len_out = len;
+
+    return 0;
+}
+
+static
+uint
+compress_zstd_estimate(
+    const void *data,
+    uint        len)
+{
+    if (!len)
+        return 0;
+
+    return (uint)ZSTD_compressBound(len);
+}
+
+merr_t
+compress_zstd_compress(
+    const void       *src,
+    uint              src_len,
+    void             *dst,
+    uint              dst_capacity,
+    uint             *dst_len,
+    int               level,
+    const ZSTD_CDict *cdict)
+{
+    struct zstd_tls *tls;
+    uint8_t *out = dst;
+    size_t len;
+
+    assert(src && dst && dst_len);
+    assert(src_len && dst_capacity);
+
+    tls = zstd_tls_get();
+    if (ev(!tls))
+        return merr(ENOMEM);
+
+    if (!tls->zt_cctx) {
+        tls->zt_cctx = ZSTD_createCCtx();
+        if (ev(!tls->zt_cctx))
+            return merr(ENOMEM);
+    }
+
+    if (cdict)
+        len = ZSTD_compress_usingCDict(tls->zt_cctx, dst, dst_capacity, src, src_len, cdict);
+    else
+        len = ZSTD_compressCCtx(tls->zt_cctx, dst, dst_capacity, src, src_len, level);
+
+    if (ZSTD_isError(len) || len <= ZSTD_MAGIC_LEN) {
+        *dst_len = 0;
+        return merr(EFBIG);
+    }
+
+    /* Replace the magic number with our tag byte.
+     */
+    assert(!memcmp(out, zstd_magic, ZSTD_MAGIC_LEN));
+
+    memmove(out + 1, out + ZSTD_MAGIC_LEN, len - ZSTD_MAGIC_LEN);
+    out[0] = COMPRESS_ZSTD_TAG;
+
+    *dst_len = len - ZSTD_MAGIC_LEN + 1;
+
+    return 0;
+}
+
+static
+merr_t
+compress_zstd_compress_default(
+    const void *src,
+    uint        src_len,
+    void       *dst,
+    uint        dst_capacity,
+    uint       *dst_len)
+{
+    return compress_zstd_compress(src, src_len, dst, dst_capacity, dst_len,
+                                  ZSTD_CLEVEL_DEFAULT, NULL);
+}
+
+static
+merr_t
+compress_zstd_decompress(
+    const void *src,
+    uint        src_len,
+    void       *dst,
+    uint        dst_capacity,
+    uint       *dst_len)
+{
+    const ZSTD_DDict *ddict = NULL;
+    uint8_t hdr[ZSTD_HDRLEN_MAX];
+    ZSTD_inBuffer in;
+    ZSTD_outBuffer out;
+    struct zstd_tls *tls;
+    uint32_t id;
+    size_t rc;
+
+    assert(src && dst && dst_len);
+    assert(src_len && dst_capacity);
+
+    if (ev(src_len < 2 || *(const uint8_t *)src != COMPRESS_ZSTD_TAG))
+        return merr(EPROTO);
+
+    tls = zstd_tls_get();
+    if (ev(!tls))
+        return merr(ENOMEM);
+
+    if (!tls->zt_dctx) {
+        tls->zt_dctx = ZSTD_createDCtx();
+        if (ev(!tls->zt_dctx))
+            return merr(ENOMEM);
+    }
+
+    /* Reconstruct enough of the frame header to learn the dictionary ID.
+     */
+    memcpy(hdr, zstd_magic, ZSTD_MAGIC_LEN);
+    rc = min_t(size_t, src_len - 1, sizeof(hdr) - ZSTD_MAGIC_LEN);
+    memcpy(hdr + ZSTD_MAGIC_LEN, (const uint8_t *)src + 1, rc);
+
+    id = ZSTD_getDictID_fromFrame(hdr, ZSTD_MAGIC_LEN + rc);
+    if (id) {
+        rcu_read_lock();
+
+        ddict = zstd_dict_lookup(id);
+        if (HSE_UNLIKELY(!ddict)) {
+            rcu_read_unlock();
+            log_err("dictionary %u not registered", id);
+            return merr(ENOENT);
+        }
+    }
+
+    ZSTD_DCtx_reset(tls->zt_dctx, ZSTD_reset_session_only);
+    ZSTD_DCtx_refDDict(tls->zt_dctx, ddict);
+
+    /* Decompress via the streaming interface so that we can feed it the
+     * magic number and the stored frame separately, and so that we can
+     * stop once the caller's buffer is full (like LZ4's partial decode).
+     */
+    out.dst = dst;
+    out.size = dst_capacity;
+    out.pos = 0;
+
+    in.src = zstd_magic;
+    in.size = ZSTD_MAGIC_LEN;
+    in.pos = 0;
+
+    rc = ZSTD_decompressStream(tls->zt_dctx, &out, &in);
+    if (!ZSTD_isError(rc)) {
+        in.src = (const uint8_t *)src + 1;
+        in.size = src_len - 1;
+        in.pos = 0;
+
+        do {
+            rc = ZSTD_decompressStream(tls->zt_dctx, &out, &in);
+        } while (!ZSTD_isError(rc) && rc > 0 && in.pos < in.size && out.pos < out.size);
+    }
+
+    if (ddict) {
+        ZSTD_DCtx_refDDict(tls->zt_dctx, NULL);
+        rcu_read_unlock();
+    }
+
+    if (HSE_UNLIKELY(ZSTD_isError(rc) || out.pos == 0)) {
+        log_err("slen %u, cap %u, len %zu, src %p, dst %p: %s",
+                src_len, dst_capacity, out.pos, src, dst,
+                ZSTD_isError(rc) ? ZSTD_getErrorName(rc) : "no output");
+
+        return merr(EFBIG);
+    }
+
+    *dst_len = out.pos;
+
+    return 0;
+}
+
+struct compress_ops compress_zstd_ops HSE_READ_MOSTLY = {
+    .cop_estimate   = compress_zstd_estimate,
+    .cop_compress   = compress_zstd_compress_default,
+    .cop_decompress = compress_zstd_decompress,
+};
@@ -0,0 +1,291 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <hse/util/assert.h>
+#include <hse/util/event_counter.h>
+#include <hse/util/fuse_filter.h>
+#include <hse/util/minmax.h>
+
+/* Construction with a given seed fails with a probability that is small
+ * but not negligible for small key sets, so we try several seeds.
+ */
+#define FUSE_POPULATE_TRIES     (64)
+
+/* False positive probability of an 8-bit fingerprint (1/256) in ppm.
+ */
+#define FUSE_FP8_PROB           (1000000 / 256)
+
+struct fuse_geometry {
+    u32 fg_seglen;
+    u32 fg_segcntlen;
+    u32 fg_arraylen;
+};
+
+/* Compute the filter geometry for n keys as per the reference implementation
+ * of 3-wise binary fuse filters.  The result is recorded in the filter, so
+ * readers never recompute it.
+ */
+static void
+fuse_geometry(u32 n, struct fuse_geometry *geo)
+{
+    u32 seglen, segcnt, capacity, arraylen;
+    double factor;
+
+    seglen = 4;
+    if (n > 0)
+        seglen = 1u << (u32)floor(log(n) / log(3.33) + 2.25);
+    seglen = min_t(u32, seglen, FUSE_SEGLEN_MAX);
+
+    capacity = 0;
+    if (n > 1) {
+        factor = max_t(double, 1.125, 0.875 + 0.25 * log(1000000.0) / log(n));
+        capacity = (u32)round(n * factor);
+    }
+
+    /* Unsigned wraparound in the first two steps cancels out.
+     */
+    segcnt = (capacity + seglen - 1) / seglen - (FUSE_ARITY - 1);
+    arraylen = (segcnt + FUSE_ARITY - 1) * seglen;
+    segcnt = (arraylen + seglen - 1) / seglen;
+    segcnt = (segcnt <= FUSE_ARITY - 1) ? 1 : segcnt - (FUSE_ARITY - 1);
+
+    geo->fg_seglen = seglen;
+    geo->fg_segcntlen = segcnt * seglen;
+    geo->fg_arraylen = (segcnt + FUSE_ARITY - 1) * seglen;
+}
+
+u32
+fuse_fpbits_est(u32 probability)
+{
+    return (probability < FUSE_FP8_PROB) ? 16 : 8;
+}
+
+size_t
+fuse_size_estimate(u32 fpbits, u32 num_elmnts)
+{
+    struct fuse_geometry geo;
+
+    fuse_geometry(num_elmnts, &geo);
+
+    return (size_t)geo.fg_arraylen * (fpbits / 8);
+}
+
+u32
+fuse_element_estimate(u32 fpbits, size_t size_in_bytes)
+{
+    u64 lo = 0, hi;
+
+    /* Filters take more than fpbits per key, so this bounds the search.
+     */
+    hi = min_t(u64, (size_in_bytes * 8) / fpbits, UINT32_MAX);
+
+    while (lo < hi) {
+        u64 mid = (lo + hi + 1) / 2;
+
+        if (fuse_size_estimate(fpbits, mid) <= size_in_bytes)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+
+    return lo;
+}
+
+void
+fuse_filter_init(
+    struct fuse_filter *filter,
+    u32                 fpbits,
+    u32                 exp_elmts,
+    void               *storage,
+    size_t              storage_sz)
+{
+    struct fuse_geometry geo;
+
+    assert(fpbits == 8 || fpbits == 16);
+
+    fuse_geometry(exp_elmts, &geo);
+
+    filter->ff_fpv = storage;
+    filter->ff_fpbits = fpbits;
+    filter->ff_seed = 0;
+    filter->ff_seglen = geo.fg_seglen;
+    filter->ff_segcntlen = geo.fg_segcntlen;
+    filter->ff_arraylen = geo.fg_arraylen;
+
+    assert(storage_sz >= (size_t)geo.fg_arraylen * (fpbits / 8));
+}
+
+static int
+fuse_hash_cmp(const void *lhs, const void *rhs)
+{
+    const u64 l = *(const u64 *)lhs;
+    const u64 r = *(const u64 *)rhs;
+
+    return (l > r) - (l < r);
+}
+
+/* Remove duplicate hashes, which can never be peeled.
+ */
+static u32
+fuse_hash_unique(u64 *hashv, u32 len)
+{
+    u32 i, n;
+
+    qsort(hashv, len, sizeof(*hashv), fuse_hash_cmp);
+
+    for (i = n = 1; i < len; ++i) {
+        if (hashv[i] != hashv[n - 1])
+            hashv[n++] = hashv[i];
+    }
+
+    return min_t(u32, n, len);
+}
+
+static HSE_ALWAYS_INLINE void
+fuse_fp_set(void *fpv, u32 fpbits, u32 pos, u32 fp)
+{
+    if (fpbits == 8)
+        ((u8 *)fpv)[pos] = fp;
+    else
+        ((u16 *)fpv)[pos] = fp;
+}
+
+merr_t
+fuse_filter_populate(struct fuse_filter *ff, u64 *hashv, u32 len)
+{
+    const u32 arraylen = ff->ff_arraylen;
+    u64 *t2hash, *stackh;
+    u8 *t2count, *stackf;
+    u32 *alone;
+    u32 stacksz = 0;
+    void *mem;
+    int attempt;
+
+    if (len == 0)
+        return 0;
+
+    /* The peeling state for each slot is the xor of the hashes of the keys
+     * mapped to it, and the count of those keys (upper six bits) along with
+     * the xor of their slot numbers within their triples (lower two bits).
+     */
+    mem = malloc((sizeof(*t2hash) + sizeof(*alone) + sizeof(*t2count)) * arraylen +
+                 (sizeof(*stackh) + sizeof(*stackf)) * len);
+    if (ev(!mem))
+        return merr(ENOMEM);
+
+    t2hash = mem;
+    stackh = t2hash + arraylen;
+    alone = (u32 *)(stackh + len);
+    t2count = (u8 *)(alone + arraylen);
+    stackf = t2count + arraylen;
+
+    for (attempt = 0; attempt < FUSE_POPULATE_TRIES; ++attempt) {
+        u32 posv[FUSE_ARITY];
+        bool overflow = false;
+        u32 qlen = 0;
+
+        ff->ff_seed = fuse_mix(attempt, 0x9e3779b9);
+
+        memset(t2hash, 0, sizeof(*t2hash) * arraylen);
+        memset(t2count, 0, sizeof(*t2count) * arraylen);
+
+        for (u32 i = 0; i < len; ++i) {
+            const u64 h = fuse_mix(hashv[i], ff->ff_seed);
+
+            fuse_hash2pos(h, ff->ff_seglen, ff->ff_segcntlen, posv);
+
+            for (u32 j = 0; j < FUSE_ARITY; ++j) {
+                t2count[posv[j]] += 4;
+                t2count[posv[j]] ^= j;
+                t2hash[posv[j]] ^= h;
+                overflow |= (t2count[posv[j]] < 4);
+            }
+        }
+
+        if (overflow) {
+            len = fuse_hash_unique(hashv, len);
+            continue;
+        }
+
+        for (u32 i = 0; i < arraylen; ++i) {
+            if ((t2count[i] >> 2) == 1)
+                alone[qlen++] = i;
+        }
+
+        /* Peel keys off slots to which no other key maps, and record
+         * the order in which they were peeled.
+         */
+        stacksz = 0;
+
+        while (qlen > 0) {
+            const u32 pos = alone[--qlen];
+            u32 found;
+            u64 h;
+
+            if ((t2count[pos] >> 2) != 1)
+                continue;
+
+            h = t2hash[pos];
+            found = t2count[pos] & 3;
+
+            stackh[stacksz] = h;
+            stackf[stacksz] = found;
+            stacksz++;
+
+            fuse_hash2pos(h, ff->ff_seglen, ff->ff_segcntlen, posv);
+
+            for (u32 j = 0; j < FUSE_ARITY; ++j) {
+                const u32 p = posv[j];
+
+                t2count[p] -= 4;
+                t2count[p] ^= j;
+                t2hash[p] ^= h;
+
+                if (j != found && (t2count[p] >> 2) == 1)
+                    alone[qlen++] = p;
+            }
+        }
+
+        if (stacksz == len)
+            break;
+
+        /* Duplicate hashes make peeling impossible regardless of seed.
+         */
+        if (attempt == 0)
+            len = fuse_hash_unique(hashv, len);
+    }
+
+    if (ev(attempt == FUSE_POPULATE_TRIES)) {
+        free(mem);
+        return merr(EAGAIN);
+    }
+
+    /* Assign fingerprints in reverse peeling order, such that each key's
+     * peeled slot is assigned after its other two slots have been fixed.
+     */
+    memset(ff->ff_fpv, 0, (size_t)arraylen * (ff->ff_fpbits / 8));
+
+    while (stacksz-- > 0) {
+        const u64 h = stackh[stacksz];
+        const u32 found = stackf[stacksz];
+        u32 posv[FUSE_ARITY];
+        u32 fp;
+
+        fuse_hash2pos(h, ff->ff_seglen, ff->ff_segcntlen, posv);
+
+        fp = fuse_fingerprint(h, ff->ff_fpbits);
+        fp ^= fuse_fp_get(ff->ff_fpv, ff->ff_fpbits, posv[(found + 1) % FUSE_ARITY]);
+        fp ^= fuse_fp_get(ff->ff_fpv, ff->ff_fpbits, posv[(found + 2) % FUSE_ARITY]);
+
+        fuse_fp_set(ff->ff_fpv, ff->ff_fpbits, posv[found], fp);
+    }
+
+    free(mem);
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse/util/keycmp.h>
+
+#if __amd64__
+#include <immintrin.h>
+#endif
+
+static size_t
+keycmp_lcp_generic(const void *s1, const void *s2, size_t len)
+{
+    const uint8_t *p1 = s1;
+    const uint8_t *p2 = s2;
+    size_t i = 0;
+
+#if __SSE2__
+    while (i + 16 <= len) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(p1 + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(p2 + i));
+        uint mask = _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) ^ 0xffffu;
+
+        if (mask)
+            return i + __builtin_ctz(mask);
+        i += 16;
+    }
+#else
+    while (i + 8 <= len) {
+        if (memcmp(p1 + i, p2 + i, 8))
+            break;
+        i += 8;
+    }
+#endif
+
+    while (i < len && p1[i] == p2[i])
+        i++;
+
+    return i;
+}
+
+#if __amd64__
+/* GCOV_EXCL_START */
+
+static __attribute__((__target__("avx2"))) size_t
+keycmp_lcp_avx2(const void *s1, const void *s2, size_t len)
+{
+    const uint8_t *p1 = s1;
+    const uint8_t *p2 = s2;
+    size_t i = 0;
+
+    while (i + 32 <= len) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(p1 + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(p2 + i));
+        uint mask = ~(uint)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b));
+
+        if (mask)
+            return i + __builtin_ctz(mask);
+        i += 32;
+    }
+
+    if (i + 16 <= len) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(p1 + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(p2 + i));
+        uint mask = _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) ^ 0xffffu;
+
+        if (mask)
+            return i + __builtin_ctz(mask);
+        i += 16;
+    }
+
+    while (i < len && p1[i] == p2[i])
+        i++;
+
+    return i;
+}
+
+/* GCOV_EXCL_STOP */
+#endif
+
+size_t (*keycmp_lcp_long)(const void *, const void *, size_t) HSE_READ_MOSTLY = keycmp_lcp_generic;
+
+void
+keycmp_init(void)
+{
+    keycmp_lcp_long = keycmp_lcp_generic;
+
+#if __amd64__
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+        keycmp_lcp_long = keycmp_lcp_avx2;
+#endif
+}
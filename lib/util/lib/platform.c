@@ -12,6 +12,7 @@
 
 #include <hse/util/data_tree.h>
 #include <hse/util/event_counter.h>
+#include <hse/util/keycmp.h>
 #include <hse/util/minmax.h>
 #include <hse/util/page.h>
 #include <hse/util/perfc.h>
@@ -213,6 +214,8 @@ hse_platform_init(void)
     if (err)
         goto errout;
 
+    keycmp_init();
+
     err = hse_timer_init();
     if (err)
         goto errout;
@@ -9,6 +9,7 @@
 #include <hse/util/bonsai_tree.h>
 #include <hse/util/event_counter.h>
 #include <hse/util/log2.h>
+#include <hse/util/perfc.h>
 
 #include <hse/ikvdb/ikvdb.h>
 #include <hse/ikvdb/kvs.h>
@@ -73,6 +74,7 @@ struct wal {
     struct kvdb_health *health;
     struct ikvdb *ikvdb;
     struct wal_iocb wiocb;
+    struct perfc_set replay_pc;
 };
 
 struct wal_sync_waiter {
@@ -422,7 +424,7 @@ wal_put(
     kvdata = (char *)rec + rlen;
     memcpy(kvdata, kt->kt_data, klen);
     kt->kt_data = kvdata;
-    kt->kt_flags = wal->buf_flags;
+    kt->kt_flags = wal->buf_flags | (kt->kt_flags & HSE_BTF_VCOMP_OFF);
 
     if (vlen > 0) {
         kvdata = PTR_ALIGN(kvdata + klen, kvalign);
@@ -504,6 +506,58 @@ wal_del_pfx(
     return wal_del_impl(wal, kvs, kt, txid, recout, true);
 }
 
+merr_t
+wal_del_range(
+    struct wal *wal,
+    struct ikvs *kvs,
+    struct kvs_ktuple *start,
+    struct kvs_vtuple *end,
+    struct wal_record *recout)
+{
+    const size_t kalign = sizeof(uint64_t);
+    struct wal_rec_omf *rec;
+    uint64_t rid;
+    size_t slen, elen, rlen, len;
+    char *kdata;
+    merr_t err;
+
+    if (!wal)
+        return 0;
+
+    /* The start key is logged as the key and the end key as the value.
+     */
+    rlen = wal_reclen(wal->version);
+    slen = start->kt_len;
+    elen = end->vt_xlen;
+    len = rlen + ALIGN(slen, kalign) + ALIGN(elen, kalign);
+
+    rec = wal_bufset_alloc(wal->wbs, len, &recout->offset, &recout->wbidx, &recout->cookie);
+    if (!rec) {
+        err = merr(ENOMEM); /* unrecoverable error */
+        kvdb_health_error(wal->health, err);
+        return err;
+    }
+
+    recout->recbuf = rec;
+    recout->len = len;
+
+    rid = atomic_inc_return(&wal->wal_rid);
+    wal_rechdr_pack(WAL_RT_NONTX, rid, len, 0, rec);
+
+    wal_rec_pack(WAL_OP_RDEL, kvs->ikv_cnid, 0, slen, elen, rec);
+
+    kdata = (char *)rec + rlen;
+    memcpy(kdata, start->kt_data, slen);
+    start->kt_data = kdata;
+    start->kt_flags = wal->buf_flags;
+
+    kdata = PTR_ALIGN(kdata + slen, kalign);
+    memcpy(kdata, end->vt_data, elen);
+    end->vt_data = kdata;
+
+    return 0;
+}
+
 static merr_t
 wal_txn(
     struct wal *wal,
@@ -675,6 +729,13 @@ wal_open(
     INIT_LIST_HEAD(&wal->sync_waiters);
     wal->sync_pending = false;
 
+    if (ikdb) {
+        char group[DT_PATH_MAX];
+
+        snprintf(group, sizeof(group), "kvdbs/%s", ikvdb_alias(ikdb));
+        wal_replay_perfc_alloc(rp->perfc_level, group, &wal->replay_pc);
+    }
+
     err = wal_mdc_open(mp, rinfo->mdcid1, rinfo->mdcid2, wal->allow_writes, &wal->mdc);
     if (err)
         goto errout;
@@ -837,6 +898,8 @@ wal_close(struct wal *wal)
     mutex_destroy(&wal->timer_mutex);
     cv_destroy(&wal->timer_cv);
 
+    perfc_free(&wal->replay_pc);
+
     free(wal);
 }
 
@@ -939,6 +1002,12 @@ wal_fset(const struct wal *wal)
     return wal->wfset;
 }
 
+struct perfc_set *
+wal_replay_pc(struct wal *wal)
+{
+    return &wal->replay_pc;
+}
+
 struct wal_mdc *
 wal_mdc(const struct wal *wal)
 {
@@ -54,6 +54,7 @@ struct wal_flush_stats {
 
 struct wal;
 struct mpool;
+struct perfc_set;
 
 enum hse_mclass
 wal_dur_mclass_get(struct wal *wal);
@@ -94,6 +95,9 @@ wal_ikvdb(const struct wal *wal);
 struct wal_fileset *
 wal_fset(const struct wal *wal);
 
+struct perfc_set *
+wal_replay_pc(struct wal *wal);
+
 struct wal_mdc *
 wal_mdc(const struct wal *wal);
 
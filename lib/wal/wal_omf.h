@@ -41,6 +41,7 @@ enum wal_op {
     WAL_OP_PUT = 500,
     WAL_OP_DEL = 501,
     WAL_OP_PDEL = 502,
+    WAL_OP_RDEL = 503,
 };
 
 enum wal_flags {
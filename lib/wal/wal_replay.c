@@ -3,17 +3,23 @@
  * Copyright (C) 2021-2022 Micron Technology, Inc.  All rights reserved.
  */
 
+#include <sys/mman.h>
+
 #include <hse/error/merr.h>
 #include <hse/util/event_counter.h>
 #include <hse/util/workqueue.h>
 #include <hse/util/slab.h>
 #include <hse/util/bonsai_tree.h>
 #include <hse/util/rmlock.h>
+#include <hse/util/page.h>
+#include <hse/util/perfc.h>
 #include <hse/logging/logging.h>
+#include <hse/kvdb_perfc.h>
 
 #include <rbtree.h>
 
 #include <hse/ikvdb/ikvdb.h>
+#include <hse/ikvdb/key_hash.h>
 #include <hse/ikvdb/kvdb_rparams.h>
 #include <hse/ikvdb/cndb.h>
 #include <hse/ikvdb/kvdb_modes.h>
@@ -24,6 +30,24 @@
 #include "wal_mdc.h"
 #include "wal_omf.h"
 
+/* clang-format off */
+
+static struct perfc_name wal_replay_perfc[] _dt_section = {
+    NE(PERFC_BA_WALREPLAY_FILES,  2, "WAL files pending replay",    "c_wrp_files"),
+    NE(PERFC_BA_WALREPLAY_GENS,   2, "WAL gens pending apply",      "c_wrp_gens"),
+    NE(PERFC_RA_WALREPLAY_RBYTES, 2, "WAL replay bytes validated",  "r_wrp_rbytes(/s)"),
+    NE(PERFC_RA_WALREPLAY_RECS,   2, "WAL replay records applied",  "r_wrp_recs(/s)"),
+    NE(PERFC_BA_WALREPLAY_MSECS,  2, "WAL replay duration",         "c_wrp_msecs"),
+};
+
+NE_CHECK(wal_replay_perfc, PERFC_EN_WALREPLAY, "wal_replay_perfc table/enum mismatch");
+
+/* Size of the read-ahead window that the record validator keeps in flight
+ * ahead of its current offset in a wal file.
+ */
+#define WAL_REPLAY_RA_BYTES     (4ul << 20)
+
+/* clang-format on */
 
 struct wal_replay_gen {
     struct mutex           rg_lock HSE_ACP_ALIGNED;
@@ -45,6 +69,22 @@ struct wal_replay_work {
     merr_t                      rw_err;
 };
 
+/* The records of a gen are partitioned by key hash across the apply
+ * workers so that all mutations of a given key are applied to c0 in
+ * record order by the same worker.
+ */
+struct wal_replay_apply {
+    struct work_struct     ra_work;
+    struct wal_replay     *ra_rep;
+    struct wal_replay_gen *ra_rgen;
+    struct wal_rec        *ra_head;
+    struct wal_rec       **ra_tailp;
+    uint64_t               ra_krcnt;
+    uint64_t               ra_maxseqno;
+    uint32_t               ra_flags;
+    merr_t                 ra_err;
+} HSE_L1D_ALIGNED;
+
 struct wal_replay {
     struct list_head            r_head HSE_ACP_ALIGNED;
     struct kmem_cache          *r_cache;
@@ -66,6 +106,11 @@ struct wal_replay {
     struct wal_replay_gen_info *r_ginfo;
     uint32_t                    r_cnt;
 
+    struct workqueue_struct    *r_awq;
+    struct wal_replay_apply    *r_apply;
+    uint32_t                    r_acnt;
+    struct perfc_set           *r_pc;
+
     struct rmlock               r_txm_lock HSE_L1D_ALIGNED;
 };
 
@@ -129,6 +174,7 @@ wal_replay_open(struct wal *wal, struct wal_replay_info *rinfo, struct wal_repla
 
     rep->r_wal = wal;
     rep->r_info = rinfo;
+    rep->r_pc = wal_replay_pc(wal);
     INIT_LIST_HEAD(&rep->r_head);
 
     rmlock_init(&rep->r_txm_lock);
@@ -363,6 +409,28 @@ wal_txcid_rb_insert(struct rb_root *root, struct wal_txmeta_rec *trec)
     return 0;
 }
 
+/* Keep a window of read-ahead in flight beyond the validator's current
+ * offset so that reading a wal file overlaps with validating it.
+ */
+static void
+wal_recs_readahead(const struct wal_replay_gen_info *rginfo, off_t curoff, off_t *raoff)
+{
+    uintptr_t addr;
+    size_t len, fsz;
+
+    fsz = rginfo->size - rginfo->soff;
+
+    if (*raoff >= fsz || curoff + WAL_REPLAY_RA_BYTES < *raoff)
+        return;
+
+    len = min_t(size_t, WAL_REPLAY_RA_BYTES, fsz - *raoff);
+    addr = (uintptr_t)(rginfo->buf + *raoff);
+
+    madvise((void *)(addr & PAGE_MASK), len + (addr & ~PAGE_MASK), MADV_WILLNEED);
+
+    *raoff += len;
+}
+
 static merr_t
 wal_recs_validate(struct wal_replay_work *rw)
 {
@@ -370,7 +438,7 @@ wal_recs_validate(struct wal_replay_work *rw)
     struct wal_minmax_info *info;
     struct wal_replay_gen_info *rginfo = rw->rw_rginfo;
     struct wal_rechdr hdr;
-    off_t curoff = 0, rgeoff = 0;
+    off_t curoff = 0, rgeoff = 0, raoff = 0;
     uint64_t gen = rginfo->gen, recoff = 0;
     const char *buf = rginfo->buf;
     bool valid;
@@ -380,6 +448,8 @@ wal_recs_validate(struct wal_replay_work *rw)
     info = rginfo->info_valid ? NULL : &rginfo->info;
     version = wal_version_get(rep->r_wal);
 
+    wal_recs_readahead(rginfo, curoff, &raoff);
+
     while ((valid = wal_rec_is_valid(buf, curoff + rginfo->soff, rginfo->size, &recoff,
                                      gen, version, &hdr, info))) {
         size_t len = wal_rechdr_len(version) + hdr.len;
@@ -424,8 +494,12 @@ wal_recs_validate(struct wal_replay_work *rw)
 
         buf += len;
         recoff += len;
+
+        wal_recs_readahead(rginfo, curoff, &raoff);
     }
 
+    perfc_add(rep->r_pc, PERFC_RA_WALREPLAY_RBYTES, curoff);
+
     if (rginfo->eoff && !valid) {
         assert(valid);
         log_crit("WAL replay: Corrupted record found in gen %lu file %d, "
@@ -515,26 +589,25 @@ wal_replay_gen_getbyseqno(struct wal_replay *rep, uint64_t seqno)
     return NULL;
 }
 
-merr_t
-wal_replay_gen_impl(struct wal_replay *rep, struct wal_replay_gen *rgen, bool flags)
+static void
+wal_replay_apply_worker(struct work_struct *work)
 {
-    struct rb_root *root = &rgen->rg_root;
-    struct rb_node *node;
+    struct wal_replay_apply *ra = container_of(work, struct wal_replay_apply, ra_work);
+    struct wal_replay *rep = ra->ra_rep;
     struct ikvdb *ikvdb = wal_ikvdb(rep->r_wal);
     struct ikvdb_kvs_hdl *ikvsh = rep->r_ikvsh;
-    merr_t err;
+    struct wal_rec *rec, *next;
+    merr_t err = 0;
 
-    node = rb_first(root);
-    while (node) {
-        struct wal_rec *rec = rb_entry(node, struct wal_rec, node);
+    for (rec = ra->ra_head; rec; rec = next) {
         struct kvs_ktuple *kt = &rec->kt;
         struct kvs_vtuple *vt = &rec->vt;
 
-        node = rb_next(node);
+        next = rec->apply_next;
 
         assert(rec->hdr.type == WAL_RT_NONTX || rec->hdr.type == WAL_RT_TX);
 
-        kt->kt_flags = flags;
+        kt->kt_flags = ra->ra_flags;
 
         switch (rec->op) {
           case WAL_OP_PUT:
@@ -549,33 +622,144 @@ wal_replay_gen_impl(struct wal_replay *rep, struct wal_replay_gen *rgen, bool fl
             err = ikvdb_wal_replay_prefix_del(ikvdb, ikvsh, rec->cnid, rec->seqno, kt);
             break;
 
+          case WAL_OP_RDEL:
+            err = ikvdb_wal_replay_range_del(ikvdb, ikvsh, rec->cnid, rec->seqno, kt, vt);
+            break;
+
           default:
             err = merr(EINVAL);
             break;
         }
 
         if (HSE_UNLIKELY(err)) {
-            struct wal_rec *cur, *next;
-
             log_crit("WAL replay: Unrecognized record op %d in gen %lu, failing replay",
-                     rec->op, rgen->rg_gen);
-
-            rbtree_postorder_for_each_entry_safe(cur, next, root, node)
-                kmem_cache_free(rep->r_cache, cur);
-
-            return err;
+                     rec->op, ra->ra_rgen->rg_gen);
+            break;
         }
 
-        rgen->rg_maxseqno = max_t(uint64_t, rgen->rg_maxseqno, rec->seqno);
+        ra->ra_maxseqno = max_t(uint64_t, ra->ra_maxseqno, rec->seqno);
+        ra->ra_krcnt++;
+
+        kmem_cache_free(rep->r_cache, rec);
+    }
 
-        rb_erase(&rec->node, root);
+    /* Free the records that were not applied due to an error */
+    for (; rec; rec = next) {
+        next = rec->apply_next;
         kmem_cache_free(rep->r_cache, rec);
-        rgen->rg_krcnt++;
+    }
+
+    perfc_add(rep->r_pc, PERFC_RA_WALREPLAY_RECS, ra->ra_krcnt);
+
+    ra->ra_err = err;
+}
+
+merr_t
+wal_replay_gen_impl(struct wal_replay *rep, struct wal_replay_gen *rgen, bool flags)
+{
+    struct rb_root *root = &rgen->rg_root;
+    struct rb_node *node;
+    merr_t err = 0;
+    uint32_t i;
+
+    for (i = 0; i < rep->r_acnt; i++) {
+        struct wal_replay_apply *ra = rep->r_apply + i;
+
+        INIT_WORK(&ra->ra_work, wal_replay_apply_worker);
+        ra->ra_rep = rep;
+        ra->ra_rgen = rgen;
+        ra->ra_head = NULL;
+        ra->ra_tailp = &ra->ra_head;
+        ra->ra_krcnt = 0;
+        ra->ra_maxseqno = 0;
+        ra->ra_flags = flags;
+        ra->ra_err = 0;
+    }
+
+    /* Partition the records by key hash, preserving record (rid) order
+     * within each partition.  Ownership of the records passes to the
+     * apply workers, hence the tree is reset.
+     */
+    for (node = rb_first(root); node; node = rb_next(node)) {
+        struct wal_rec *rec = rb_entry(node, struct wal_rec, node);
+        struct wal_replay_apply *ra;
+
+        i = key_hash64(rec->kt.kt_data, rec->kt.kt_len) % rep->r_acnt;
+        ra = rep->r_apply + i;
+
+        rec->apply_next = NULL;
+        *ra->ra_tailp = rec;
+        ra->ra_tailp = &rec->apply_next;
+    }
+
+    *root = RB_ROOT;
+
+    for (i = 1; i < rep->r_acnt; i++) {
+        struct wal_replay_apply *ra = rep->r_apply + i;
+
+        if (ra->ra_head)
+            queue_work(rep->r_awq, &ra->ra_work);
+    }
+
+    /* Apply the first partition in the calling thread */
+    wal_replay_apply_worker(&rep->r_apply[0].ra_work);
+
+    if (rep->r_awq)
+        flush_workqueue(rep->r_awq);
+
+    for (i = 0; i < rep->r_acnt; i++) {
+        struct wal_replay_apply *ra = rep->r_apply + i;
+
+        if (ra->ra_err && !err)
+            err = ra->ra_err;
+
+        rgen->rg_maxseqno = max_t(uint64_t, rgen->rg_maxseqno, ra->ra_maxseqno);
+        rgen->rg_krcnt += ra->ra_krcnt;
+    }
+
+    return err;
+}
+
+static merr_t
+wal_replay_apply_init(struct wal_replay *rep)
+{
+    uint32_t acnt;
+
+    acnt = clamp_t(uint32_t, rep->r_info->replay_threads,
+                   HSE_WAL_REPLAY_THREADS_MIN, HSE_WAL_REPLAY_THREADS_MAX);
+
+    rep->r_apply = aligned_alloc(__alignof__(*rep->r_apply), acnt * sizeof(*rep->r_apply));
+    if (!rep->r_apply)
+        return merr(ENOMEM);
+
+    memset(rep->r_apply, 0, acnt * sizeof(*rep->r_apply));
+    rep->r_acnt = acnt;
+
+    /* The calling thread applies one of the partitions itself */
+    if (acnt > 1) {
+        rep->r_awq = alloc_workqueue("hse_wal_apply", 0, acnt - 1, acnt - 1);
+        if (!rep->r_awq) {
+            free(rep->r_apply);
+            rep->r_apply = NULL;
+            rep->r_acnt = 0;
+            return merr(ENOMEM);
+        }
     }
 
     return 0;
 }
 
+static void
+wal_replay_apply_fini(struct wal_replay *rep)
+{
+    destroy_workqueue(rep->r_awq);
+    rep->r_awq = NULL;
+
+    free(rep->r_apply);
+    rep->r_apply = NULL;
+    rep->r_acnt = 0;
+}
+
 
 /*
  * General WAL replay interfaces
@@ -621,6 +805,10 @@ wal_replay_core(struct wal_replay *rep)
 
     flags = HSE_BTF_MANAGED; /* Replay with MANAGED flag to let c0 share the mmaped wal files */
 
+    err = wal_replay_apply_init(rep);
+    if (err)
+        return err;
+
     /* Set c0sk to wal replay mode. This disables the c0kvms_should ingest() check and
      * allow us to take control of the c0kvms boundaries. Also, the seqno bump for reserved
      * seqno and LC are also skipped.
@@ -641,6 +829,9 @@ wal_replay_core(struct wal_replay *rep)
         }
     }
 
+    list_for_each_entry(cur, &rep->r_head, rg_link)
+        perfc_inc(rep->r_pc, PERFC_BA_WALREPLAY_GENS);
+
     list_for_each_entry_safe(cur, next, &rep->r_head, rg_link) {
         bool flush = false, last_entry;
 
@@ -682,10 +873,14 @@ wal_replay_core(struct wal_replay *rep)
         log_info("WAL replay: Gen %lu, maxseqno %lu replayed %lu keys",
                  cur->rg_gen, maxseqno, cur->rg_krcnt);
 
+        perfc_dec(rep->r_pc, PERFC_BA_WALREPLAY_GENS);
+
         list_del_init(&cur->rg_link);
         free(cur);
     }
 
+    wal_replay_apply_fini(rep);
+
     /* This additional sync ensures that all replayed c0kvmses are ingested in the case of a
      * gen rollback or if the KVDB is opened in rdonly_replay mode.
      */
@@ -706,6 +901,7 @@ wal_replay_core(struct wal_replay *rep)
     return ikvdb_wal_replay_sync(ikvdb, 0);
 
 errout:
+    wal_replay_apply_fini(rep);
     ikvdb_wal_replay_disable(ikvdb);
 
     return err;
@@ -993,6 +1189,8 @@ wal_replay_worker(struct work_struct *work)
     log_info("WAL replay: Gen %lu fileid %d nrecs %lu ntxrecs %lu nskipped %lu",
              rginfo->gen, rginfo->fileid, nrecs, ntxrecs, nskipped);
 
+    perfc_dec(rep->r_pc, PERFC_BA_WALREPLAY_FILES);
+
 #ifndef NDEBUG
     assert(wal_rec_iter_eof(&iter));
 #endif
@@ -1042,10 +1240,17 @@ wal_replay_prepare(struct wal_replay *rep)
     return err;
 }
 
+void
+wal_replay_perfc_alloc(uint prio, const char *group, struct perfc_set *pcs)
+{
+    perfc_alloc(wal_replay_perfc, group, "set", prio, pcs);
+}
+
 merr_t
 wal_replay(struct wal *wal, struct wal_replay_info *rinfo)
 {
     struct wal_replay *rep = NULL;
+    uint64_t tstart;
     merr_t err = 0;
 
     if (wal_is_clean(wal))
@@ -1069,6 +1274,8 @@ wal_replay(struct wal *wal, struct wal_replay_info *rinfo)
     if (err)
         return err;
 
+    tstart = get_time_ns();
+
     err = wal_fileset_replay(wal_fset(wal), rinfo, &rep->r_cnt, &rep->r_ginfo);
     if (err)
         goto exit;
@@ -1076,6 +1283,8 @@ wal_replay(struct wal *wal, struct wal_replay_info *rinfo)
     if (rep->r_cnt == 0) /* Nothing to replay */
         goto exit;
 
+    perfc_set(rep->r_pc, PERFC_BA_WALREPLAY_FILES, rep->r_cnt);
+
 #ifndef NDEBUG
     log_info("WAL replay: Info: ");
     wal_replay_dump_info(rep);
@@ -1094,6 +1303,8 @@ wal_replay(struct wal *wal, struct wal_replay_info *rinfo)
     if (err)
         goto exit;
 
+    perfc_set(rep->r_pc, PERFC_BA_WALREPLAY_MSECS, (get_time_ns() - tstart) / 1000000);
+
 exit:
     wal_replay_close(rep, !!err);
 
@@ -11,6 +11,7 @@
 
 struct wal;
 struct wal_replay_info;
+struct perfc_set;
 
 struct wal_replay_gen_info {
     spinlock_t     txm_lock HSE_ACP_ALIGNED;
@@ -40,6 +41,7 @@ struct wal_rechdr {
 
 struct wal_rec {
     struct rb_node    node;
+    struct wal_rec   *apply_next;
     struct wal_rechdr hdr;
     uint64_t          cnid;
     uint64_t          txid;
@@ -60,6 +62,9 @@ struct wal_txmeta_rec {
     off_t          fileoff;
 };
 
+void
+wal_replay_perfc_alloc(uint prio, const char *group, struct perfc_set *pcs);
+
 merr_t
 wal_replay(struct wal *wal, struct wal_replay_info *rinfo);
 
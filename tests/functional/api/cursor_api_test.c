@@ -4,6 +4,7 @@
  */
 
 #include <hse/hse.h>
+#include <hse/experimental.h>
 
 #include <mtf/framework.h>
 #include <hse/test/fixtures/kvdb.h>
@@ -1199,6 +1200,73 @@ MTF_DEFINE_UTEST_PREPOST(
     ASSERT_EQ(0, hse_err_to_errno(err));
 }
 
+MTF_DEFINE_UTEST(cursor_api_test, create_split_null_kvs)
+{
+    hse_err_t              err;
+    struct hse_kvs_cursor *cursorv[4];
+    unsigned int           cursorc = NELEM(cursorv);
+
+    err = hse_kvs_cursor_create_split(NULL, 0, NULL, NULL, 0, NULL, 0, &cursorc, cursorv);
+    ASSERT_EQ(EINVAL, hse_err_to_errno(err));
+}
+
+MTF_DEFINE_UTEST_PREPOST(cursor_api_test, create_split_zero_cursorc, kvs_setup, kvs_teardown)
+{
+    hse_err_t              err;
+    struct hse_kvs_cursor *cursorv[4];
+    unsigned int           cursorc = 0;
+
+    err = hse_kvs_cursor_create_split(kvs_handle, 0, NULL, NULL, 0, NULL, 0, &cursorc, cursorv);
+    ASSERT_EQ(EINVAL, hse_err_to_errno(err));
+}
+
+MTF_DEFINE_UTEST_PREPOST(cursor_api_test, create_split_success, kvs_setup_with_data, kvs_teardown)
+{
+    hse_err_t              err;
+    struct hse_kvs_cursor *cursorv[4];
+    unsigned int           cursorc = NELEM(cursorv);
+    const void            *key, *val;
+    size_t                 key_len, val_len;
+    bool                   eof;
+    char                   key_buf[8], val_buf[8];
+    int                    i = 1;
+
+    err = hse_kvs_cursor_create_split(
+        kvs_handle, 0, NULL, "key1", sizeof("key1") - 1, "key3", sizeof("key3") - 1, &cursorc,
+        cursorv);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+    ASSERT_GE(cursorc, 1);
+    ASSERT_LE(cursorc, NELEM(cursorv));
+
+    /* Writes after the split are not visible to any of the cursors */
+    err = hse_kvs_put(
+        kvs_handle, 0, NULL, "key2a", sizeof("key2a") - 1, "value2a", sizeof("value2a") - 1);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    /* Together the cursors must yield each key in the range exactly once */
+    for (unsigned int c = 0; c < cursorc; c++) {
+        while (true) {
+            err = hse_kvs_cursor_read(cursorv[c], 0, &key, &key_len, &val, &val_len, &eof);
+            ASSERT_EQ(0, hse_err_to_errno(err));
+            if (eof)
+                break;
+
+            snprintf(key_buf, sizeof(key_buf), KEY_FMT, i);
+            snprintf(val_buf, sizeof(val_buf), VALUE_FMT, i);
+
+            ASSERT_EQ(strlen(key_buf), key_len);
+            ASSERT_EQ(0, memcmp(key, key_buf, key_len));
+            ASSERT_EQ(0, memcmp(val, val_buf, val_len));
+            i++;
+        }
+
+        err = hse_kvs_cursor_destroy(cursorv[c]);
+        ASSERT_EQ(0, hse_err_to_errno(err));
+    }
+
+    ASSERT_EQ(4, i);
+}
+
 MTF_DEFINE_UTEST_PREPOST(cursor_api_test, update_view_null_cursor, kvs_setup, kvs_teardown)
 {
     hse_err_t err;
@@ -532,6 +532,94 @@ MTF_DEFINE_UTEST_PREPOST(
     ASSERT_EQ(0, memcmp(valbuf, "value0", val_len));
 }
 
+MTF_DEFINE_UTEST(kvs_api_test, get_multi_null_kvs)
+{
+    hse_err_t    err;
+    const void  *keys[] = { "key0" };
+    const size_t key_lens[] = { 4 };
+    bool         found[1];
+    size_t       val_lens[1];
+
+    err = hse_kvs_get_multi(NULL, 0, NULL, 1, keys, key_lens, found, NULL, NULL, val_lens);
+    ASSERT_EQ(EINVAL, hse_err_to_errno(err));
+}
+
+MTF_DEFINE_UTEST(kvs_api_test, get_multi_invalid_count)
+{
+    hse_err_t    err;
+    const void  *keys[] = { "key0" };
+    const size_t key_lens[] = { 4 };
+    bool         found[1];
+    size_t       val_lens[1];
+
+    err = hse_kvs_get_multi(
+        (struct hse_kvs *)-1, 0, NULL, 0, keys, key_lens, found, NULL, NULL, val_lens);
+    ASSERT_EQ(EINVAL, hse_err_to_errno(err));
+
+    err = hse_kvs_get_multi(
+        (struct hse_kvs *)-1, 0, NULL, HSE_KVS_GET_MULTI_MAX + 1, keys, key_lens, found, NULL,
+        NULL, val_lens);
+    ASSERT_EQ(EINVAL, hse_err_to_errno(err));
+}
+
+MTF_DEFINE_UTEST(kvs_api_test, get_multi_key_len_is_0)
+{
+    hse_err_t    err;
+    const void  *keys[] = { "key0", "key1" };
+    const size_t key_lens[] = { 4, 0 };
+    bool         found[2];
+    size_t       val_lens[2];
+
+    err = hse_kvs_get_multi(
+        (struct hse_kvs *)-1, 0, NULL, 2, keys, key_lens, found, NULL, NULL, val_lens);
+    ASSERT_EQ(ENOENT, hse_err_to_errno(err));
+}
+
+MTF_DEFINE_UTEST_PREPOST(kvs_api_test, get_multi_success, kvs_setup_with_data, kvs_teardown)
+{
+    hse_err_t    err;
+    const void  *keys[] = { "key3", "nokey", "key0", "key4", "key3" };
+    const size_t key_lens[] = { 4, 5, 4, 4, 4 };
+    const char  *expected[] = { "value3", NULL, "value0", "value4", "value3" };
+    char         valbufv[NELEM(keys)][8];
+    void        *valbufs[NELEM(keys)];
+    size_t       valbuf_szs[NELEM(keys)];
+    bool         found[NELEM(keys)];
+    size_t       val_lens[NELEM(keys)];
+
+    for (size_t i = 0; i < NELEM(keys); i++) {
+        valbufs[i] = valbufv[i];
+        valbuf_szs[i] = sizeof(valbufv[i]);
+    }
+
+    err = hse_kvs_get_multi(
+        kvs_handle, 0, NULL, NELEM(keys), keys, key_lens, found, valbufs, valbuf_szs, val_lens);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    for (size_t i = 0; i < NELEM(keys); i++) {
+        if (!expected[i]) {
+            ASSERT_FALSE(found[i]);
+            continue;
+        }
+
+        ASSERT_TRUE(found[i]);
+        ASSERT_EQ(strlen(expected[i]), val_lens[i]);
+        ASSERT_EQ(0, memcmp(valbufv[i], expected[i], val_lens[i]));
+    }
+
+    /* Probe for value lengths only.
+     */
+    err = hse_kvs_get_multi(
+        kvs_handle, 0, NULL, NELEM(keys), keys, key_lens, found, NULL, NULL, val_lens);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    for (size_t i = 0; i < NELEM(keys); i++) {
+        ASSERT_EQ(!!expected[i], found[i]);
+        if (expected[i])
+            ASSERT_EQ(strlen(expected[i]), val_lens[i]);
+    }
+}
+
 MTF_DEFINE_UTEST(kvs_api_test, name_null_kvs)
 {
     const char *name;
@@ -0,0 +1,541 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <hse/hse.h>
+#include <hse/experimental.h>
+#include <hse/test/fixtures/kvdb.h>
+#include <hse/test/fixtures/kvs.h>
+
+#include <mtf/framework.h>
+
+#include <hse/util/base.h>
+
+/* With durability disabled hse_kvdb_sync() ingests c0 into cn, which lets
+ * the tests place both the keys and the range tombstones in either.
+ */
+const char *kvdb_rparamv[] = { "durability.enabled=false" };
+
+struct hse_kvdb *kvdb_handle;
+struct hse_kvs  *kvs_handle;
+const char      *kvs_name = "kvs";
+
+#define KEY_FMT     "key%03d"
+#define VALUE_FMT   "value%03d"
+#define NUM_ENTRIES 100
+#define RDEL_START  20
+#define RDEL_END    60
+
+/* Set (to the kvdb home) in the environment of the child process which
+ * range deletes and then exits without closing the kvdb.
+ */
+#define CRASH_ENV "RANGE_DELETE_API_TEST_CRASH_HOME"
+
+static int
+key_fmt(char *buf, size_t bufsz, int i)
+{
+    return snprintf(buf, bufsz, KEY_FMT, i);
+}
+
+static hse_err_t
+load(struct hse_kvs *kvs)
+{
+    char key[16], val[16];
+    hse_err_t err = 0;
+
+    for (int i = 0; i < NUM_ENTRIES && !err; i++) {
+        int klen, vlen;
+
+        klen = key_fmt(key, sizeof(key), i);
+        vlen = snprintf(val, sizeof(val), VALUE_FMT, i);
+
+        err = hse_kvs_put(kvs, 0, NULL, key, klen, val, vlen);
+    }
+
+    return err;
+}
+
+static hse_err_t
+range_delete(struct hse_kvs *kvs, int start, int end)
+{
+    char skey[16], ekey[16];
+    int slen, elen;
+
+    slen = key_fmt(skey, sizeof(skey), start);
+    elen = key_fmt(ekey, sizeof(ekey), end);
+
+    return hse_kvs_range_delete(kvs, 0, NULL, skey, slen, ekey, elen);
+}
+
+static bool
+deleted(int i)
+{
+    return i >= RDEL_START && i < RDEL_END;
+}
+
+static int
+verify_get(struct mtf_test_info *lcl_ti, struct hse_kvs *kvs)
+{
+    char key[16], val[16], buf[16];
+
+    for (int i = 0; i < NUM_ENTRIES; i++) {
+        hse_err_t err;
+        size_t vlen;
+        bool found;
+        int klen;
+
+        klen = key_fmt(key, sizeof(key), i);
+        snprintf(val, sizeof(val), VALUE_FMT, i);
+
+        err = hse_kvs_get(kvs, 0, NULL, key, klen, &found, buf, sizeof(buf), &vlen);
+        ASSERT_EQ_RET(0, hse_err_to_errno(err), -1);
+        ASSERT_EQ_RET(!deleted(i), found, -1);
+
+        if (found) {
+            ASSERT_EQ_RET(strlen(val), vlen, -1);
+            ASSERT_EQ_RET(0, memcmp(val, buf, vlen), -1);
+        }
+    }
+
+    return 0;
+}
+
+static int
+verify_cursor(struct mtf_test_info *lcl_ti, struct hse_kvs *kvs, unsigned int flags)
+{
+    struct hse_kvs_cursor *cursor;
+    bool reverse = flags & HSE_CURSOR_CREATE_REV;
+    int i = reverse ? NUM_ENTRIES - 1 : 0;
+    hse_err_t err;
+    bool eof;
+
+    err = hse_kvs_cursor_create(kvs, flags, NULL, NULL, 0, &cursor);
+    ASSERT_EQ_RET(0, hse_err_to_errno(err), -1);
+
+    while (1) {
+        const void *k, *v;
+        size_t klen, vlen;
+        char key[16];
+
+        err = hse_kvs_cursor_read(cursor, 0, &k, &klen, &v, &vlen, &eof);
+        ASSERT_EQ_RET(0, hse_err_to_errno(err), -1);
+        if (eof)
+            break;
+
+        while (deleted(i))
+            i += reverse ? -1 : 1;
+
+        ASSERT_EQ_RET(key_fmt(key, sizeof(key), i), klen, -1);
+        ASSERT_EQ_RET(0, memcmp(key, k, klen), -1);
+
+        i += reverse ? -1 : 1;
+    }
+
+    /* Skip past a trailing deleted range, if any.
+     */
+    while (i >= 0 && i < NUM_ENTRIES && deleted(i))
+        i += reverse ? -1 : 1;
+
+    ASSERT_EQ_RET(reverse ? -1 : NUM_ENTRIES, i, -1);
+
+    err = hse_kvs_cursor_destroy(cursor);
+    ASSERT_EQ_RET(0, hse_err_to_errno(err), -1);
+
+    return 0;
+}
+
+static int
+verify(struct mtf_test_info *lcl_ti, struct hse_kvs *kvs)
+{
+    ASSERT_EQ_RET(0, verify_get(lcl_ti, kvs), -1);
+    ASSERT_EQ_RET(0, verify_cursor(lcl_ti, kvs, 0), -1);
+    ASSERT_EQ_RET(0, verify_cursor(lcl_ti, kvs, HSE_CURSOR_CREATE_REV), -1);
+
+    return 0;
+}
+
+/* Runs in the child process forked by the wal_replay test: write the keys
+ * and the range tombstone to the WAL, then exit without closing the kvdb.
+ */
+static HSE_NORETURN void
+crash_writer(const char *home)
+{
+    struct hse_kvdb *kvdb;
+    struct hse_kvs *kvs;
+    hse_err_t err;
+
+    /* Not needed by the child, and _exit() skips its atexit() cleanup.
+     */
+    rmdir(mtf_kvdb_home);
+
+    err = hse_kvdb_open(home, 0, NULL, &kvdb);
+    if (err)
+        _exit(1);
+
+    err = hse_kvdb_kvs_open(kvdb, kvs_name, 0, NULL, &kvs);
+    if (!err)
+        err = load(kvs);
+    if (!err)
+        err = range_delete(kvs, RDEL_START, RDEL_END);
+    if (!err)
+        err = hse_kvdb_sync(kvdb, 0);
+
+    _exit(err ? 1 : 0);
+}
+
+int
+test_collection_setup(struct mtf_test_info *lcl_ti)
+{
+    const char *home;
+    hse_err_t err;
+
+    home = getenv(CRASH_ENV);
+    if (home)
+        crash_writer(home);
+
+    err = fxt_kvdb_setup(mtf_kvdb_home, NELEM(kvdb_rparamv), kvdb_rparamv, 0, NULL, &kvdb_handle);
+
+    return hse_err_to_errno(err);
+}
+
+int
+test_collection_teardown(struct mtf_test_info *lcl_ti)
+{
+    hse_err_t err;
+
+    err = fxt_kvdb_teardown(mtf_kvdb_home, kvdb_handle);
+
+    return hse_err_to_errno(err);
+}
+
+int
+kvs_setup(struct mtf_test_info *lcl_ti)
+{
+    hse_err_t err;
+
+    err = fxt_kvs_setup(kvdb_handle, kvs_name, 0, NULL, 0, NULL, &kvs_handle);
+
+    return hse_err_to_errno(err);
+}
+
+int
+kvs_teardown(struct mtf_test_info *lcl_ti)
+{
+    hse_err_t err;
+
+    err = fxt_kvs_teardown(kvdb_handle, kvs_name, kvs_handle);
+
+    return hse_err_to_errno(err);
+}
+
+MTF_BEGIN_UTEST_COLLECTION_PREPOST(range_delete_api_test, test_collection_setup, test_collection_teardown)
+
+MTF_DEFINE_UTEST(range_delete_api_test, null_kvs)
+{
+    hse_err_t err;
+
+    err = hse_kvs_range_delete(NULL, 0, NULL, "a", 1, "b", 1);
+    ASSERT_EQ(EINVAL, hse_err_to_errno(err));
+}
+
+MTF_DEFINE_UTEST_PREPOST(range_delete_api_test, invalid_args, kvs_setup, kvs_teardown)
+{
+    hse_err_t err;
+
+    err = hse_kvs_range_delete(kvs_handle, 1, NULL, "a", 1, "b", 1);
+    ASSERT_EQ(EINVAL, hse_err_to_errno(err));
+
+    err = hse_kvs_range_delete(kvs_handle, 0, NULL, NULL, 1, "b", 1);
+    ASSERT_EQ(EINVAL, hse_err_to_errno(err));
+
+    err = hse_kvs_range_delete(kvs_handle, 0, NULL, "a", 1, NULL, 1);
+    ASSERT_EQ(EINVAL, hse_err_to_errno(err));
+
+    err = hse_kvs_range_delete(kvs_handle, 0, NULL, "a", 0, "b", 1);
+    ASSERT_EQ(ENOENT, hse_err_to_errno(err));
+
+    err = hse_kvs_range_delete(kvs_handle, 0, NULL, "a", HSE_KVS_KEY_LEN_MAX + 1, "b", 1);
+    ASSERT_EQ(ENAMETOOLONG, hse_err_to_errno(err));
+
+    /* An empty range deletes nothing.
+     */
+    err = load(kvs_handle);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    err = range_delete(kvs_handle, RDEL_END, RDEL_START);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    err = range_delete(kvs_handle, RDEL_START, RDEL_START);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    for (int i = 0; i < NUM_ENTRIES; i++) {
+        char key[16];
+        size_t vlen;
+        bool found;
+        int klen;
+
+        klen = key_fmt(key, sizeof(key), i);
+        err = hse_kvs_get(kvs_handle, 0, NULL, key, klen, &found, NULL, 0, &vlen);
+        ASSERT_EQ(0, hse_err_to_errno(err));
+        ASSERT_TRUE(found);
+    }
+}
+
+MTF_DEFINE_UTEST(range_delete_api_test, txn_unsupported)
+{
+    const char *rparamv[] = { "transactions.enabled=true" };
+    struct hse_kvdb_txn *txn;
+    struct hse_kvs *kvs;
+    hse_err_t err;
+
+    err = fxt_kvs_setup(kvdb_handle, kvs_name, NELEM(rparamv), rparamv, 0, NULL, &kvs);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    txn = hse_kvdb_txn_alloc(kvdb_handle);
+    ASSERT_NE(NULL, txn);
+
+    err = hse_kvdb_txn_begin(kvdb_handle, txn);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    err = hse_kvs_range_delete(kvs, 0, txn, "a", 1, "b", 1);
+    ASSERT_EQ(ENOTSUP, hse_err_to_errno(err));
+
+    err = hse_kvdb_txn_abort(kvdb_handle, txn);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    hse_kvdb_txn_free(kvdb_handle, txn);
+
+    err = hse_kvs_range_delete(kvs, 0, NULL, "a", 1, "b", 1);
+    ASSERT_EQ(ENOTSUP, hse_err_to_errno(err));
+
+    err = fxt_kvs_teardown(kvdb_handle, kvs_name, kvs);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+}
+
+MTF_DEFINE_UTEST_PREPOST(range_delete_api_test, c0, kvs_setup, kvs_teardown)
+{
+    char key[16];
+    hse_err_t err;
+    size_t vlen;
+    bool found;
+    int klen;
+
+    err = load(kvs_handle);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    err = range_delete(kvs_handle, RDEL_START, RDEL_END);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    ASSERT_EQ(0, verify(lcl_ti, kvs_handle));
+
+    /* Keys put after the range delete are visible.
+     */
+    klen = key_fmt(key, sizeof(key), RDEL_START);
+    err = hse_kvs_put(kvs_handle, 0, NULL, key, klen, "new", 3);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    err = hse_kvs_get(kvs_handle, 0, NULL, key, klen, &found, NULL, 0, &vlen);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+    ASSERT_TRUE(found);
+    ASSERT_EQ(3, vlen);
+}
+
+MTF_DEFINE_UTEST_PREPOST(range_delete_api_test, cn, kvs_setup, kvs_teardown)
+{
+    hse_err_t err;
+
+    err = load(kvs_handle);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    err = hse_kvdb_sync(kvdb_handle, 0);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    /* Range tombstone in c0, keys in cn.
+     */
+    err = range_delete(kvs_handle, RDEL_START, RDEL_END);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    ASSERT_EQ(0, verify(lcl_ti, kvs_handle));
+
+    /* Both range tombstone and keys in cn.
+     */
+    err = hse_kvdb_sync(kvdb_handle, 0);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    ASSERT_EQ(0, verify(lcl_ti, kvs_handle));
+}
+
+MTF_DEFINE_UTEST_PREPOST(range_delete_api_test, compaction, kvs_setup, kvs_teardown)
+{
+    struct hse_kvdb_compact_status status;
+    hse_err_t err;
+
+    /* Spread the keys and the range tombstone over several kvsets.
+     */
+    for (int i = 0; i < 4; i++) {
+        err = load(kvs_handle);
+        ASSERT_EQ(0, hse_err_to_errno(err));
+
+        err = hse_kvdb_sync(kvdb_handle, 0);
+        ASSERT_EQ(0, hse_err_to_errno(err));
+    }
+
+    err = range_delete(kvs_handle, RDEL_START, RDEL_END);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    err = hse_kvdb_sync(kvdb_handle, 0);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    err = hse_kvdb_compact(kvdb_handle, HSE_KVDB_COMPACT_SAMP_LWM);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    do {
+        usleep(100 * 1000);
+
+        err = hse_kvdb_compact_status_get(kvdb_handle, &status);
+        ASSERT_EQ(0, hse_err_to_errno(err));
+    } while (status.kvcs_active);
+
+    ASSERT_EQ(0, verify(lcl_ti, kvs_handle));
+}
+
+static int
+probe(
+    struct mtf_test_info      *lcl_ti,
+    struct hse_kvs            *kvs,
+    const char                *pfx,
+    enum hse_kvs_pfx_probe_cnt expect,
+    int                        expect_key)
+{
+    char keybuf[HSE_KVS_KEY_LEN_MAX], valbuf[16], key[16], val[16];
+    enum hse_kvs_pfx_probe_cnt pc;
+    size_t klen, vlen;
+    hse_err_t err;
+    int len;
+
+    err = hse_kvs_prefix_probe(kvs, 0, NULL, pfx, strlen(pfx), &pc, keybuf, sizeof(keybuf),
+                               &klen, valbuf, sizeof(valbuf), &vlen);
+    ASSERT_EQ_RET(0, hse_err_to_errno(err), -1);
+    ASSERT_EQ_RET(expect, pc, -1);
+
+    if (pc == HSE_KVS_PFX_FOUND_ONE) {
+        len = key_fmt(key, sizeof(key), expect_key);
+        ASSERT_EQ_RET(len, klen, -1);
+        ASSERT_EQ_RET(0, memcmp(key, keybuf, klen), -1);
+
+        len = snprintf(val, sizeof(val), VALUE_FMT, expect_key);
+        ASSERT_EQ_RET(len, vlen, -1);
+        ASSERT_EQ_RET(0, memcmp(val, valbuf, vlen), -1);
+    }
+
+    return 0;
+}
+
+MTF_DEFINE_UTEST_PREPOST(range_delete_api_test, prefix_probe, kvs_setup, kvs_teardown)
+{
+    hse_err_t err;
+
+    err = load(kvs_handle);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    ASSERT_EQ(0, probe(lcl_ti, kvs_handle, "key02", HSE_KVS_PFX_FOUND_MUL, 0));
+
+    /* Range delete key020 through key028 leaving only key029 with prefix
+     * "key02", with the rtomb and the keys in c0.
+     */
+    err = range_delete(kvs_handle, 20, 29);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    ASSERT_EQ(0, probe(lcl_ti, kvs_handle, "key02", HSE_KVS_PFX_FOUND_ONE, 29));
+    ASSERT_EQ(0, probe(lcl_ti, kvs_handle, "key03", HSE_KVS_PFX_FOUND_MUL, 0));
+
+    /* And with the rtomb and the keys in cn.
+     */
+    err = hse_kvdb_sync(kvdb_handle, 0);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    ASSERT_EQ(0, probe(lcl_ti, kvs_handle, "key02", HSE_KVS_PFX_FOUND_ONE, 29));
+
+    /* A key put after the range delete is not hidden by it.
+     */
+    err = hse_kvs_put(kvs_handle, 0, NULL, "key025", 6, "value025", 8);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    ASSERT_EQ(0, probe(lcl_ti, kvs_handle, "key02", HSE_KVS_PFX_FOUND_MUL, 0));
+
+    err = range_delete(kvs_handle, 20, 30);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    ASSERT_EQ(0, probe(lcl_ti, kvs_handle, "key02", HSE_KVS_PFX_FOUND_ZERO, 0));
+}
+
+MTF_DEFINE_UTEST(range_delete_api_test, wal_replay)
+{
+    struct hse_kvs *kvs;
+    hse_err_t err;
+    pid_t pid;
+    int wstatus;
+
+    err = hse_kvdb_kvs_create(kvdb_handle, kvs_name, 0, NULL);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    err = hse_kvdb_close(kvdb_handle);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+    kvdb_handle = NULL;
+
+    /* The child re-executes this test with a fresh hse_init() (threads do
+     * not survive fork()), range deletes via the WAL, and exits without
+     * closing the kvdb.
+     */
+    pid = fork();
+    ASSERT_NE(-1, pid);
+
+    if (pid == 0) {
+        setenv(CRASH_ENV, mtf_kvdb_home, 1);
+        execl("/proc/self/exe", "range_delete_api_test", (char *)NULL);
+        _exit(127);
+    }
+
+    ASSERT_EQ(pid, waitpid(pid, &wstatus, 0));
+    ASSERT_TRUE(WIFEXITED(wstatus));
+    ASSERT_EQ(0, WEXITSTATUS(wstatus));
+
+    /* Reopen with durability enabled so that the WAL is replayed.
+     */
+    err = hse_kvdb_open(mtf_kvdb_home, 0, NULL, &kvdb_handle);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    err = hse_kvdb_kvs_open(kvdb_handle, kvs_name, 0, NULL, &kvs);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    ASSERT_EQ(0, verify(lcl_ti, kvs));
+
+    /* And again once the replayed range tombstone has been ingested.
+     */
+    err = hse_kvdb_kvs_close(kvs);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    err = hse_kvdb_close(kvdb_handle);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    err = hse_kvdb_open(mtf_kvdb_home, 0, NULL, &kvdb_handle);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    err = hse_kvdb_kvs_open(kvdb_handle, kvs_name, 0, NULL, &kvs);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    ASSERT_EQ(0, verify(lcl_ti, kvs));
+
+    err = fxt_kvs_teardown(kvdb_handle, kvs_name, kvs);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+}
+
+MTF_END_UTEST_COLLECTION(range_delete_api_test)
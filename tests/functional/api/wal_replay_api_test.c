@@ -0,0 +1,241 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <hse/hse.h>
+#include <hse/experimental.h>
+#include <hse/test/fixtures/kvdb.h>
+
+#include <mtf/framework.h>
+
+#include <hse/util/base.h>
+
+/* Replay with several apply threads, each of which is handed records
+ * of every kvs.
+ */
+const char *replay_rparamv[] = { "durability.replay.threads=4" };
+
+struct hse_kvdb *kvdb_handle;
+
+#define NUM_KVS     4
+#define NUM_ENTRIES 1000
+#define DEL_STRIDE  7
+#define RDEL_START  500
+#define RDEL_END    600
+
+#define KEY_FMT   "key%04d"
+#define VALUE_FMT "kvs%d-value%04d"
+
+/* Set (to the kvdb home) in the environment of the child process which
+ * writes to each kvs and then exits without closing the kvdb.
+ */
+#define CRASH_ENV "WAL_REPLAY_API_TEST_CRASH_HOME"
+
+static void
+kvs_name_fmt(char *buf, size_t bufsz, int kvs)
+{
+    snprintf(buf, bufsz, "kvs%d", kvs);
+}
+
+static int
+key_fmt(char *buf, size_t bufsz, int i)
+{
+    return snprintf(buf, bufsz, KEY_FMT, i);
+}
+
+/* Every kvs holds the same keys, but with values unique to the kvs, so a
+ * record applied to the wrong kvs is caught by verify().
+ */
+static hse_err_t
+load(struct hse_kvs *kvs, int idx)
+{
+    char key[16], val[32], ekey[16];
+    hse_err_t err = 0;
+    int klen, elen;
+
+    for (int i = 0; i < NUM_ENTRIES && !err; i++) {
+        int vlen;
+
+        klen = key_fmt(key, sizeof(key), i);
+        vlen = snprintf(val, sizeof(val), VALUE_FMT, idx, i);
+
+        err = hse_kvs_put(kvs, 0, NULL, key, klen, val, vlen);
+    }
+
+    for (int i = idx; i < NUM_ENTRIES && !err; i += DEL_STRIDE) {
+        klen = key_fmt(key, sizeof(key), i);
+
+        err = hse_kvs_delete(kvs, 0, NULL, key, klen);
+    }
+
+    if (!err) {
+        klen = key_fmt(key, sizeof(key), RDEL_START + idx);
+        elen = key_fmt(ekey, sizeof(ekey), RDEL_END + idx);
+
+        err = hse_kvs_range_delete(kvs, 0, NULL, key, klen, ekey, elen);
+    }
+
+    return err;
+}
+
+static bool
+deleted(int idx, int i)
+{
+    if (i >= RDEL_START + idx && i < RDEL_END + idx)
+        return true;
+
+    return i >= idx && (i - idx) % DEL_STRIDE == 0;
+}
+
+static int
+verify(struct mtf_test_info *lcl_ti, struct hse_kvs *kvs, int idx)
+{
+    char key[16], val[32], buf[32];
+    hse_err_t err;
+
+    for (int i = 0; i < NUM_ENTRIES; i++) {
+        size_t vlen;
+        bool found;
+        int klen, len;
+
+        klen = key_fmt(key, sizeof(key), i);
+        len = snprintf(val, sizeof(val), VALUE_FMT, idx, i);
+
+        err = hse_kvs_get(kvs, 0, NULL, key, klen, &found, buf, sizeof(buf), &vlen);
+        ASSERT_EQ_RET(0, hse_err_to_errno(err), -1);
+        ASSERT_EQ_RET(!deleted(idx, i), found, -1);
+
+        if (found) {
+            ASSERT_EQ_RET(len, vlen, -1);
+            ASSERT_EQ_RET(0, memcmp(val, buf, vlen), -1);
+        }
+    }
+
+    return 0;
+}
+
+/* Runs in the child process forked by the replay test: write to each kvs
+ * via the WAL, then exit without closing the kvdb.
+ */
+static HSE_NORETURN void
+crash_writer(const char *home)
+{
+    struct hse_kvdb *kvdb;
+    hse_err_t err;
+
+    /* Not needed by the child, and _exit() skips its atexit() cleanup.
+     */
+    rmdir(mtf_kvdb_home);
+
+    err = hse_kvdb_open(home, 0, NULL, &kvdb);
+    if (err)
+        _exit(1);
+
+    for (int i = 0; i < NUM_KVS && !err; i++) {
+        struct hse_kvs *kvs;
+        char name[16];
+
+        kvs_name_fmt(name, sizeof(name), i);
+
+        err = hse_kvdb_kvs_open(kvdb, name, 0, NULL, &kvs);
+        if (!err)
+            err = load(kvs, i);
+    }
+
+    if (!err)
+        err = hse_kvdb_sync(kvdb, 0);
+
+    _exit(err ? 1 : 0);
+}
+
+int
+test_collection_setup(struct mtf_test_info *lcl_ti)
+{
+    const char *home;
+    hse_err_t err;
+
+    home = getenv(CRASH_ENV);
+    if (home)
+        crash_writer(home);
+
+    err = fxt_kvdb_setup(mtf_kvdb_home, 0, NULL, 0, NULL, &kvdb_handle);
+
+    return hse_err_to_errno(err);
+}
+
+int
+test_collection_teardown(struct mtf_test_info *lcl_ti)
+{
+    hse_err_t err;
+
+    err = fxt_kvdb_teardown(mtf_kvdb_home, kvdb_handle);
+
+    return hse_err_to_errno(err);
+}
+
+MTF_BEGIN_UTEST_COLLECTION_PREPOST(wal_replay_api_test, test_collection_setup, test_collection_teardown)
+
+MTF_DEFINE_UTEST(wal_replay_api_test, parallel_apply)
+{
+    struct hse_kvs *kvsv[NUM_KVS];
+    char name[16];
+    hse_err_t err;
+    pid_t pid;
+    int wstatus;
+
+    for (int i = 0; i < NUM_KVS; i++) {
+        kvs_name_fmt(name, sizeof(name), i);
+
+        err = hse_kvdb_kvs_create(kvdb_handle, name, 0, NULL);
+        ASSERT_EQ(0, hse_err_to_errno(err));
+    }
+
+    err = hse_kvdb_close(kvdb_handle);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+    kvdb_handle = NULL;
+
+    /* The child re-executes this test with a fresh hse_init() (threads do
+     * not survive fork()), writes via the WAL, and exits without closing
+     * the kvdb.
+     */
+    pid = fork();
+    ASSERT_NE(-1, pid);
+
+    if (pid == 0) {
+        setenv(CRASH_ENV, mtf_kvdb_home, 1);
+        execl("/proc/self/exe", "wal_replay_api_test", (char *)NULL);
+        _exit(127);
+    }
+
+    ASSERT_EQ(pid, waitpid(pid, &wstatus, 0));
+    ASSERT_TRUE(WIFEXITED(wstatus));
+    ASSERT_EQ(0, WEXITSTATUS(wstatus));
+
+    err = hse_kvdb_open(mtf_kvdb_home, NELEM(replay_rparamv), replay_rparamv, &kvdb_handle);
+    ASSERT_EQ(0, hse_err_to_errno(err));
+
+    for (int i = 0; i < NUM_KVS; i++) {
+        kvs_name_fmt(name, sizeof(name), i);
+
+        err = hse_kvdb_kvs_open(kvdb_handle, name, 0, NULL, &kvsv[i]);
+        ASSERT_EQ(0, hse_err_to_errno(err));
+    }
+
+    for (int i = 0; i < NUM_KVS; i++)
+        ASSERT_EQ(0, verify(lcl_ti, kvsv[i], i));
+
+    for (int i = 0; i < NUM_KVS; i++) {
+        err = hse_kvdb_kvs_close(kvsv[i]);
+        ASSERT_EQ(0, hse_err_to_errno(err));
+    }
+}
+
+MTF_END_UTEST_COLLECTION(wal_replay_api_test)
@@ -655,12 +655,15 @@ static struct mapi_injection cn_inject_list[] = {
     { mapi_idx_cn_periodic,          MAPI_RC_SCALAR, 0 },
     { mapi_idx_cn_is_capped,         MAPI_RC_SCALAR, 0 },
     { mapi_idx_cn_disable_maint,     MAPI_RC_SCALAR, 0 },
+    { mapi_idx_cn_rcache_invalidate, MAPI_RC_SCALAR, 0 },
+    { mapi_idx_cn_set_vcomp,         MAPI_RC_SCALAR, 0 },
 
     { mapi_idx_cn_get_rp,            MAPI_RC_PTR, &mocked_kvs_rparams },
     { mapi_idx_cn_get_cparams,       MAPI_RC_PTR, &mocked_kvs_cparams },
     { mapi_idx_cn_get_mpool,         MAPI_RC_PTR, NULL },
     { mapi_idx_cn_get_mclass_policy, MAPI_RC_PTR, NULL },
     { mapi_idx_cn_get_ingest_perfc,  MAPI_RC_PTR, NULL },
+    { mapi_idx_cn_get_vcomp,         MAPI_RC_PTR, NULL },
 
     { -1 },
 };
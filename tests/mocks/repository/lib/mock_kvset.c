@@ -383,6 +383,12 @@ _kvset_get_nth_vblock_len(struct kvset *kvset, u32 index)
     return vcnt * sizeof(int);
 }
 
+static u64
+_kvset_get_nth_vblock_used(struct kvset *kvset, u32 index)
+{
+    return _kvset_get_nth_vblock_len(kvset, index);
+}
+
 static uint64_t
 _kvset_get_nodeid(const struct kvset *kvset)
 {
@@ -715,6 +721,10 @@ _kvset_iter_seek(struct kv_iterator *kvi, const void *key, int len, bool *eof)
 static struct mapi_injection inject_list[] = {
     { mapi_idx_kvset_kblk_start, MAPI_RC_SCALAR, 0},
     { mapi_idx_kvset_set_rule, MAPI_RC_SCALAR, 0},
+    { mapi_idx_kvset_vgc_bytes, MAPI_RC_SCALAR, 0},
+    { mapi_idx_kvset_hit, MAPI_RC_SCALAR, 0},
+    { mapi_idx_kvset_add_hits, MAPI_RC_SCALAR, 0},
+    { mapi_idx_kvset_reap_hits, MAPI_RC_SCALAR, 0},
     { -1 }
 };
 
@@ -729,6 +739,7 @@ mock_kvset_set(void)
     MOCK_SET(kvset, _kvset_set_work);
     MOCK_SET(kvset, _kvset_get_work);
     MOCK_SET(kvset, _kvset_get_nth_vblock_len);
+    MOCK_SET(kvset, _kvset_get_nth_vblock_used);
     MOCK_SET(kvset, _kvset_list_add);
     MOCK_SET(kvset, _kvset_list_add_tail);
     MOCK_SET(kvset, _kvset_get_ref);
@@ -763,6 +774,7 @@ mock_kvset_unset(void)
 
     MOCK_UNSET(kvset, _kvset_open);
     MOCK_UNSET(kvset, _kvset_get_nth_vblock_len);
+    MOCK_UNSET(kvset, _kvset_get_nth_vblock_used);
     MOCK_UNSET(kvset, _kvset_list_add);
     MOCK_UNSET(kvset, _kvset_list_add_tail);
     MOCK_UNSET(kvset, _kvset_get_ref);
@@ -51,6 +51,7 @@ static struct mapi_injection inject_list[] = {
     { mapi_idx_kvset_builder_add_vref, MAPI_RC_SCALAR, 0 },
     { mapi_idx_kvset_builder_get_mblocks, MAPI_RC_SCALAR, 0 },
     { mapi_idx_kvset_builder_set_agegroup, MAPI_RC_SCALAR, 0 },
+    { mapi_idx_kvset_builder_set_bloom_prob, MAPI_RC_SCALAR, 0 },
     { mapi_idx_kvset_builder_adopt_vblocks, MAPI_RC_SCALAR, 0},
     { -1},
 };
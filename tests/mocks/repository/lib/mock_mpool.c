@@ -152,6 +152,29 @@ _mpool_mblock_delete(struct mpool *mp, uint64_t id)
     return 0;
 }
 
+static merr_t
+_mpool_mblock_commitv(struct mpool *mp, uint64_t *idv, int idc)
+{
+    return 0;
+}
+
+static merr_t
+_mpool_mblock_deletev(struct mpool *mp, uint64_t *idv, int idc)
+{
+    for (int i = 0; i < idc; i++) {
+        merr_t err;
+
+        if (!idv[i])
+            continue;
+
+        err = _mpool_mblock_delete(mp, idv[i]);
+        if (err)
+            return err;
+    }
+
+    return 0;
+}
+
 merr_t
 _mpool_props_get(struct mpool *mp, struct mpool_props *props)
 {
@@ -685,6 +708,8 @@ mock_mpool_set(void)
     MOCK_SET(mpool, _mpool_mblock_alloc);
     MOCK_SET(mpool, _mpool_mblock_commit);
     MOCK_SET(mpool, _mpool_mblock_delete);
+    MOCK_SET(mpool, _mpool_mblock_commitv);
+    MOCK_SET(mpool, _mpool_mblock_deletev);
     MOCK_SET(mpool, _mpool_mblock_props_get);
     MOCK_SET(mpool, _mpool_mblock_read);
     MOCK_SET(mpool, _mpool_mblock_write);
@@ -711,6 +736,8 @@ mock_mpool_unset(void)
     MOCK_UNSET(mpool, _mpool_mblock_alloc);
     MOCK_UNSET(mpool, _mpool_mblock_commit);
     MOCK_UNSET(mpool, _mpool_mblock_delete);
+    MOCK_UNSET(mpool, _mpool_mblock_commitv);
+    MOCK_UNSET(mpool, _mpool_mblock_deletev);
     MOCK_UNSET(mpool, _mpool_mblock_props_get);
     MOCK_UNSET(mpool, _mpool_mblock_read);
     MOCK_UNSET(mpool, _mpool_mblock_write);
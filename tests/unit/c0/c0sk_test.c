@@ -20,6 +20,9 @@
 #include <hse/ikvdb/cursor.h>
 #include <hse/ikvdb/throttle.h>
 #include <hse/ikvdb/kvdb_rparams.h>
+#include <hse/ikvdb/kvs_rparams.h>
+#include <hse/ikvdb/kvs_vcomp.h>
+#include <hse/ikvdb/cn.h>
 #include <hse/ikvdb/cndb.h>
 
 #include "cn_mock.h"
@@ -447,6 +450,118 @@ MTF_DEFINE_UTEST_PREPOST(c0sk_test, t_sync, no_fail_pre, no_fail_post)
     destroy_mock_cn(mock_cn);
 }
 
+/* Compressed lengths of the values ingested by deferred_vcomp, by key.
+ */
+static struct {
+    uint valc;
+    uint clenv[2];
+} deferred;
+
+static merr_t
+_kvset_builder_add_val(
+    struct kvset_builder   *self,
+    const struct key_obj   *kobj,
+    const void             *vdata,
+    uint                    vlen,
+    u64                     seq,
+    uint                    complen)
+{
+    KOBJ2KEY(kobj);
+
+    if (c0sk_test_klen == 2 && c0sk_test_kdata[1] - '0' < NELEM(deferred.clenv)) {
+        deferred.clenv[c0sk_test_kdata[1] - '0'] = complen;
+        deferred.valc++;
+    }
+
+    return 0;
+}
+
+MTF_DEFINE_UTEST_PREPOST(c0sk_test, deferred_vcomp, no_fail_pre, no_fail_post)
+{
+    struct kvdb_rparams   kvdb_rp;
+    struct c0_kvmultiset *kvms;
+    struct kvs_ktuple     kt;
+    struct kvs_vtuple     vt;
+    struct kvs_rparams *  rp;
+    struct kvs_vcomp *    vc;
+    struct mock_kvdb      mkvdb;
+    struct cn *           mock_cn;
+    struct c0sk_impl *    self;
+    atomic_ulong          seqno;
+    char                  val[1024];
+    u16                   skidx = 0;
+    merr_t                err;
+
+    kvdb_rp = kvdb_rparams_defaults();
+
+    atomic_set(&seqno, 0);
+    err = c0sk_open(&kvdb_rp, 0, "mock_mp", &mock_health, &seqno, 0, &mkvdb.ikdb_c0sk);
+    ASSERT_EQ(0, err);
+
+    err = create_mock_cn(&mock_cn, false, false, 0);
+    ASSERT_EQ(0, err);
+
+    /* Values are compressed by default, by c0 ingest.
+     */
+    rp = cn_get_rp(mock_cn);
+    rp->value.compression.dflt = VCOMP_DEFAULT_ON;
+    rp->value.compression.deferred = true;
+
+    err = kvs_vcomp_open(NULL, 1, rp, NULL, &vc);
+    ASSERT_EQ(0, err);
+
+    mapi_inject_ptr(mapi_idx_cn_get_vcomp, vc);
+    mapi_inject_unset(mapi_idx_kvset_builder_add_val);
+    MOCK_SET(kvset_builder, _kvset_builder_add_val);
+
+    err = c0sk_c0_register(mkvdb.ikdb_c0sk, mock_cn, &skidx);
+    ASSERT_EQ(0, err);
+
+    self = c0sk_h2r(mkvdb.ikdb_c0sk);
+
+    err = c0kvms_create(1, &seqno, NULL, &kvms);
+    ASSERT_EQ(0, err);
+
+    err = c0sk_install_c0kvms(self, NULL, kvms);
+    ASSERT_EQ(0, err);
+
+    /* Key "k0" is put with compression disabled, "k1" by default.
+     */
+    memset(val, 'x', sizeof(val));
+    kvs_vtuple_init(&vt, val, sizeof(val));
+
+    kvs_ktuple_init(&kt, "k0", 2);
+    kt.kt_flags = HSE_BTF_VCOMP_OFF;
+    err = c0sk_put(mkvdb.ikdb_c0sk, skidx, &kt, &vt, HSE_SQNREF_SINGLE);
+    ASSERT_EQ(0, err);
+
+    kvs_ktuple_init(&kt, "k1", 2);
+    err = c0sk_put(mkvdb.ikdb_c0sk, skidx, &kt, &vt, HSE_SQNREF_SINGLE);
+    ASSERT_EQ(0, err);
+
+    memset(&deferred, 0, sizeof(deferred));
+
+    err = c0sk_sync(mkvdb.ikdb_c0sk, 0);
+    ASSERT_EQ(0, err);
+
+    ASSERT_EQ(2, deferred.valc);
+    ASSERT_EQ(0, deferred.clenv[0]);
+    ASSERT_GT(deferred.clenv[1], 0);
+    ASSERT_LT(deferred.clenv[1], sizeof(val));
+
+    c0kvms_putref(kvms);
+
+    err = c0sk_close(mkvdb.ikdb_c0sk);
+    ASSERT_EQ(0, err);
+
+    destroy_mock_cn(mock_cn);
+
+    MOCK_UNSET(kvset_builder, _kvset_builder_add_val);
+    mapi_inject(mapi_idx_kvset_builder_add_val, 0);
+    mapi_inject_unset(mapi_idx_cn_get_vcomp);
+    kvs_vcomp_close(vc);
+}
+
 MTF_DEFINE_UTEST_PREPOST(c0sk_test, various, no_fail_pre, no_fail_post)
 {
     struct kvdb_rparams kvdb_rp;
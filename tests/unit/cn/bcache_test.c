@@ -0,0 +1,177 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <mtf/framework.h>
+
+#include <hse/error/merr.h>
+#include <hse/util/page.h>
+#include <hse/util/perfc.h>
+
+#include <cn/bcache.h>
+
+#include <mocks/mock_mpool.h>
+
+#define MBLOCK_PAGES    (1024)
+
+static uint64_t mbid;
+
+int
+test_pre(struct mtf_test_info *lcl_ti)
+{
+    static char page[PAGE_SIZE];
+    merr_t err;
+
+    mock_mpool_set();
+
+    err = mpm_mblock_alloc(MBLOCK_PAGES * PAGE_SIZE, &mbid);
+    ASSERT_EQ_RET(0, err, -1);
+
+    for (uint i = 0; i < MBLOCK_PAGES; ++i) {
+        memset(page, i, sizeof(page));
+
+        err = mpm_mblock_write(mbid, page, (uint64_t)i * PAGE_SIZE, PAGE_SIZE);
+        ASSERT_EQ_RET(0, err, -1);
+    }
+
+    return 0;
+}
+
+MTF_BEGIN_UTEST_COLLECTION(bcache_test);
+
+MTF_DEFINE_UTEST_PRE(bcache_test, index_hit, test_pre)
+{
+    struct perfc_set pc = { 0 };
+    struct bcache_ref bcr = { 0 };
+    struct bcache_ent *ent;
+    const uint8_t *p1, *p2;
+    struct bcache *bc;
+    merr_t err;
+
+    err = bcache_create(0, &bc);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, bc);
+
+    bcr.br_bc = bc;
+    bcr.br_pc = &pc;
+    bcr.br_tag = 1;
+    bcr.br_mbid = mbid;
+
+    p1 = bcache_get(&bcr, 7, BCACHE_INDEX, &ent);
+    ASSERT_NE(NULL, p1);
+    ASSERT_EQ(7, p1[0]);
+    ASSERT_EQ(7, p1[PAGE_SIZE - 1]);
+    bcache_put(ent);
+
+    p2 = bcache_get(&bcr, 7, BCACHE_INDEX, &ent);
+    ASSERT_EQ(p1, p2);
+    bcache_put(ent);
+
+    /* A different tag must not find the page.
+     */
+    bcr.br_tag = 2;
+    p2 = bcache_get(&bcr, 7, BCACHE_INDEX, &ent);
+    ASSERT_NE(NULL, p2);
+    ASSERT_NE(p1, p2);
+    ASSERT_EQ(7, p2[0]);
+    bcache_put(ent);
+
+    bcache_purge(bc, &pc);
+    bcache_destroy(bc);
+}
+
+MTF_DEFINE_UTEST_PRE(bcache_test, value_admission, test_pre)
+{
+    struct perfc_set pc = { 0 };
+    struct bcache_ref bcr = { 0 };
+    struct bcache_ent *ent;
+    const uint8_t *p;
+    struct bcache *bc;
+    merr_t err;
+
+    err = bcache_create(0, &bc);
+    ASSERT_EQ(0, err);
+
+    bcr.br_bc = bc;
+    bcr.br_pc = &pc;
+    bcr.br_tag = 1;
+    bcr.br_mbid = mbid;
+
+    /* Value pages are admitted only on their second miss.
+     */
+    p = bcache_get(&bcr, 3, BCACHE_VALUE, &ent);
+    ASSERT_EQ(NULL, p);
+
+    p = bcache_get(&bcr, 3, BCACHE_VALUE, &ent);
+    ASSERT_NE(NULL, p);
+    ASSERT_EQ(3, p[0]);
+    bcache_put(ent);
+
+    p = bcache_get(&bcr, 3, BCACHE_VALUE, &ent);
+    ASSERT_NE(NULL, p);
+    bcache_put(ent);
+
+    /* Purging the owner's pages drops them from the cache.
+     */
+    bcache_purge(bc, &pc);
+
+    p = bcache_get(&bcr, 3, BCACHE_VALUE, &ent);
+    ASSERT_EQ(NULL, p);
+
+    bcache_destroy(bc);
+}
+
+MTF_DEFINE_UTEST_PRE(bcache_test, evict, test_pre)
+{
+    struct bcache_ent *entv[MBLOCK_PAGES];
+    struct perfc_set pc = { 0 };
+    struct bcache_ref bcr = { 0 };
+    struct bcache_ent *ent;
+    const uint8_t *p;
+    struct bcache *bc;
+    uint pinned;
+    merr_t err;
+
+    /* The smallest cache has a single shard of 256 pages.
+     */
+    err = bcache_create(PAGE_SIZE, &bc);
+    ASSERT_EQ(0, err);
+
+    bcr.br_bc = bc;
+    bcr.br_pc = &pc;
+    bcr.br_tag = 1;
+    bcr.br_mbid = mbid;
+
+    /* Unpinned pages are evicted to make room for new pages.
+     */
+    for (uint i = 0; i < MBLOCK_PAGES; ++i) {
+        p = bcache_get(&bcr, i, BCACHE_INDEX, &ent);
+        ASSERT_NE(NULL, p);
+        ASSERT_EQ((uint8_t)i, p[0]);
+        bcache_put(ent);
+    }
+
+    /* Pinned pages are never evicted.
+     */
+    for (pinned = 0; pinned < MBLOCK_PAGES; ++pinned) {
+        p = bcache_get(&bcr, pinned, BCACHE_INDEX, &entv[pinned]);
+        if (!p)
+            break;
+        ASSERT_EQ((uint8_t)pinned, p[0]);
+    }
+
+    ASSERT_EQ(256, pinned);
+
+    for (uint i = 0; i < pinned; ++i)
+        bcache_put(entv[i]);
+
+    p = bcache_get(&bcr, MBLOCK_PAGES - 1, BCACHE_INDEX, &ent);
+    ASSERT_NE(NULL, p);
+    bcache_put(ent);
+
+    bcache_purge(bc, &pc);
+    bcache_destroy(bc);
+}
+
+MTF_END_UTEST_COLLECTION(bcache_test);
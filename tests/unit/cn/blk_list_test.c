@@ -36,6 +36,8 @@ pre(struct mtf_test_info *info)
 {
     mapi_inject(mapi_idx_mpool_mblock_delete, 0);
     mapi_inject(mapi_idx_mpool_mblock_commit, 0);
+    mapi_inject(mapi_idx_mpool_mblock_deletev, 0);
+    mapi_inject(mapi_idx_mpool_mblock_commitv, 0);
     return 0;
 }
 
@@ -210,6 +212,60 @@ MTF_DEFINE_UTEST_PREPOST(blk_list_test, t_delete_mblocks, pre, post)
     delete_mblocks(ds, &b);
     blk_list_free(&b);
     mapi_inject(api, 0);
+
+    /* The list is deleted with a single vector delete, and one mblock
+     * at a time only if that fails.
+     */
+    blk_list_init(&b);
+    for (i = 0; i < N; i++) {
+        err = blk_list_append(&b, BLK_ID + i);
+        ASSERT_EQ(err, 0);
+    }
+    mapi_calls_clear(mapi_idx_mpool_mblock_delete);
+    mapi_calls_clear(mapi_idx_mpool_mblock_deletev);
+    delete_mblocks(ds, &b);
+    ASSERT_EQ(1, mapi_calls(mapi_idx_mpool_mblock_deletev));
+    ASSERT_EQ(0, mapi_calls(mapi_idx_mpool_mblock_delete));
+    for (i = 0; i < N; i++)
+        ASSERT_EQ(0, b.idv[i]);
+
+    for (i = 0; i < N; i++)
+        b.idv[i] = BLK_ID + i;
+    mapi_inject(mapi_idx_mpool_mblock_deletev, merr(EIO));
+    delete_mblocks(ds, &b);
+    ASSERT_EQ(N, mapi_calls(mapi_idx_mpool_mblock_delete));
+    mapi_inject(mapi_idx_mpool_mblock_deletev, 0);
+    blk_list_free(&b);
+}
+
+MTF_DEFINE_UTEST_PREPOST(blk_list_test, t_commit_mblocks, pre, post)
+{
+    int             i, N = 5;
+    merr_t          err;
+    struct blk_list b;
+
+    blk_list_init(&b);
+    err = commit_mblocks(ds, &b);
+    ASSERT_EQ(err, 0);
+
+    for (i = 0; i < N; i++) {
+        err = blk_list_append(&b, BLK_ID + i);
+        ASSERT_EQ(err, 0);
+    }
+
+    mapi_calls_clear(mapi_idx_mpool_mblock_commit);
+    mapi_calls_clear(mapi_idx_mpool_mblock_commitv);
+    err = commit_mblocks(ds, &b);
+    ASSERT_EQ(err, 0);
+    ASSERT_EQ(1, mapi_calls(mapi_idx_mpool_mblock_commitv));
+    ASSERT_EQ(0, mapi_calls(mapi_idx_mpool_mblock_commit));
+
+    mapi_inject(mapi_idx_mpool_mblock_commitv, merr(EIO));
+    err = commit_mblocks(ds, &b);
+    ASSERT_EQ(EIO, merr_errno(err));
+    mapi_inject(mapi_idx_mpool_mblock_commitv, 0);
+
+    blk_list_free(&b);
 }
 
 MTF_END_UTEST_COLLECTION(blk_list_test);
@@ -144,12 +144,12 @@ read_blooms(struct mtf_test_info *lcl_ti, char *kblock_file)
 
         kvs_ktuple_init(&ktuple, keybuf, len);
 
-        hit = bloom_reader_lookup(&rgndesc, ktuple.kt_hash);
+        hit = bloom_reader_lookup(&rgndesc, NULL, ktuple.kt_hash);
         ASSERT_TRUE(hit);
 
         /* Permute the hash to try and elicit a false positive.
          */
-        hit = bloom_reader_lookup(&rgndesc, ~(ktuple.kt_hash));
+        hit = bloom_reader_lookup(&rgndesc, NULL, ~(ktuple.kt_hash));
         if (hit)
             ++fpc;
     }
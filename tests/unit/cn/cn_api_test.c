@@ -67,7 +67,7 @@ MTF_DEFINE_UTEST_PRE(cn_api, basic, pre)
     mapi_inject(mapi_idx_mpool_props_get, 0);
     mapi_inject(mapi_idx_mpool_mclass_props_get, ENOENT);
 
-    err = cn_kvdb_create(4, 4, &cn_kvdb);
+    err = cn_kvdb_create(4, 4, 0, 0, &cn_kvdb);
     ASSERT_EQ(0, err);
 
     err = cn_open(cn_kvdb, ds, &kk, cndb, 0, &rp, "mp", "kvs", &mock_health, 0, &cn);
@@ -88,6 +88,7 @@ MTF_DEFINE_UTEST_PRE(cn_api, basic, pre)
 
     (void)cn_get_cancel(cn);
     (void)cn_get_io_wq(cn);
+    (void)cn_get_ra_wq(cn);
     (void)cn_get_sched(cn);
     (void)cn_get_cndb(cn);
     (void)cn_get_perfc(cn, CN_ACTION_COMPACT_K);
@@ -78,6 +78,8 @@ struct injections injections[] = {
     /* mblocks */
     { 0, mapi_idx_mpool_mblock_commit },
     { 0, mapi_idx_mpool_mblock_delete },
+    { 0, mapi_idx_mpool_mblock_commitv },
+    { 0, mapi_idx_mpool_mblock_deletev },
 };
 
 const struct kvset_stats fake_kvset_stats = {
@@ -191,38 +193,69 @@ MTF_DEFINE_UTEST_PRE(cn_ingest_test, commit_delete, test_pre)
     merr_t err;
 
     /*
-     * Test cn_mblocks_commit w/ cndb_txn_txc set to succeed
+     * Test cn_mblocks_commit w/ cndb_txn_txc set to succeed.  All mblocks
+     * of all kvsets are committed with a single vector commit.
      */
     init_mblks(m, n_kvsets, &k, &v);
     mapi_calls_clear(mapi_idx_mpool_mblock_commit);
+    mapi_calls_clear(mapi_idx_mpool_mblock_commitv);
     err = cn_mblocks_commit(mock_ds, n_kvsets, m, CN_MUT_OTHER);
     ASSERT_EQ(err, 0);
-    ASSERT_EQ(mapi_calls(mapi_idx_mpool_mblock_commit), n_kvsets * (1 + k + v)); /* 1 for hblock */
+    ASSERT_EQ(mapi_calls(mapi_idx_mpool_mblock_commit), 0);
+    ASSERT_EQ(mapi_calls(mapi_idx_mpool_mblock_commitv), 1);
     free_mblks(m, n_kvsets);
 
     init_mblks(m, n_kvsets, &k, &v);
-    mapi_calls_clear(mapi_idx_mpool_mblock_commit);
+    for (uint i = 0; i < n_kvsets; i++)
+        m[i].bl_vadopted = v;
+    mapi_calls_clear(mapi_idx_mpool_mblock_commitv);
     err = cn_mblocks_commit(mock_ds, n_kvsets, m, CN_MUT_KCOMPACT);
     ASSERT_EQ(err, 0);
-    ASSERT_EQ(mapi_calls(mapi_idx_mpool_mblock_commit), n_kvsets * (1 + k)); /* kcompact ==> does not commit vblks, 1 for hblock */
+    ASSERT_EQ(mapi_calls(mapi_idx_mpool_mblock_commitv), 1);
+    free_mblks(m, n_kvsets);
+
+    init_mblks(m, n_kvsets, &k, &v);
+    mapi_inject(mapi_idx_mpool_mblock_commitv, merr(EIO));
+    err = cn_mblocks_commit(mock_ds, n_kvsets, m, CN_MUT_OTHER);
+    ASSERT_EQ(merr_errno(err), EIO);
+    mapi_inject(mapi_idx_mpool_mblock_commitv, 0);
     free_mblks(m, n_kvsets);
 
     /* Test cn_mblocks_destroy with kcompact == false.
-     * Should delete kblocks and vblocks.
+     * Should delete kblocks and vblocks, one vector per list.
      */
     init_mblks(m, n_kvsets, &k, &v);
     mapi_calls_clear(mapi_idx_mpool_mblock_delete);
+    mapi_calls_clear(mapi_idx_mpool_mblock_deletev);
     cn_mblocks_destroy(mock_ds, n_kvsets, m, 0);
-    ASSERT_EQ(mapi_calls(mapi_idx_mpool_mblock_delete), n_kvsets * (1 + k + v)); /* 1 for hblock */
+    ASSERT_EQ(mapi_calls(mapi_idx_mpool_mblock_delete), n_kvsets); /* hblocks */
+    ASSERT_EQ(mapi_calls(mapi_idx_mpool_mblock_deletev), n_kvsets * 2);
     free_mblks(m, n_kvsets);
 
     /* Test cn_mblocks_destroy with kcompact == true.
-     * Should delete kblocks but not vblocks.
+     * Should delete kblocks but not the adopted vblocks.
+     */
+    init_mblks(m, n_kvsets, &k, &v);
+    for (uint i = 0; i < n_kvsets; i++)
+        m[i].bl_vadopted = v;
+    mapi_calls_clear(mapi_idx_mpool_mblock_delete);
+    mapi_calls_clear(mapi_idx_mpool_mblock_deletev);
+    cn_mblocks_destroy(mock_ds, n_kvsets, m, 1);
+    ASSERT_EQ(mapi_calls(mapi_idx_mpool_mblock_delete), n_kvsets); /* hblocks */
+    ASSERT_EQ(mapi_calls(mapi_idx_mpool_mblock_deletev), n_kvsets);
+    free_mblks(m, n_kvsets);
+
+    /* Vblocks written by a k-compaction to replace garbage laden
+     * vblocks are deleted along with the kblocks.
      */
     init_mblks(m, n_kvsets, &k, &v);
+    for (uint i = 0; i < n_kvsets; i++)
+        m[i].bl_vadopted = v - 2;
     mapi_calls_clear(mapi_idx_mpool_mblock_delete);
+    mapi_calls_clear(mapi_idx_mpool_mblock_deletev);
     cn_mblocks_destroy(mock_ds, n_kvsets, m, 1);
-    ASSERT_EQ(mapi_calls(mapi_idx_mpool_mblock_delete), n_kvsets * (1 + k)); /* 1 for hblock */
+    ASSERT_EQ(mapi_calls(mapi_idx_mpool_mblock_delete), n_kvsets); /* hblocks */
+    ASSERT_EQ(mapi_calls(mapi_idx_mpool_mblock_deletev), n_kvsets * 2);
     free_mblks(m, n_kvsets);
 }
 
@@ -7,6 +7,7 @@
 
 #include <hse/util/base.h>
 #include <hse/util/keycmp.h>
+#include <hse/util/workqueue.h>
 
 #include <hse/ikvdb/cn.h>
 #include <hse/ikvdb/omf_kmd.h>
@@ -31,6 +32,17 @@ _cn_get_tree(const struct cn *cn)
 merr_t
 cn_tree_kvset_refs(struct cn_tree_node *node, struct cn_level_cursor *lcur)
 {
+    struct kvref *k;
+
+    /* Every node has one (fake) kvset.
+     */
+    table_reset(lcur->cnlc_kvref_tab);
+
+    k = table_append(lcur->cnlc_kvref_tab);
+    if (!k)
+        return merr(ENOMEM);
+
+    k->kvset = NULL;
     return 0;
 }
 
@@ -216,6 +228,8 @@ pre_test(struct mtf_test_info *lcl_ti)
     mapi_inject(mapi_idx_kvset_get_dgen, 0);
 
     mapi_inject(mapi_idx_cn_get_maint_wq, 0);
+    mapi_inject(mapi_idx_cn_get_io_wq, 0);
+    mapi_inject(mapi_idx_cn_get_ra_wq, 0);
 
     MOCK_SET(cn, _cn_get_tree);
 
@@ -224,6 +238,7 @@ pre_test(struct mtf_test_info *lcl_ti)
     mapi_inject(mapi_idx_kvset_iter_seek, 0);
     mapi_inject(mapi_idx_kvset_iter_es_get, 0);
     mapi_inject(mapi_idx_kvset_iter_kvset_get, 0);
+    mapi_inject(mapi_idx_kvset_madvise_cursor, 0);
 
     MOCK_SET(kvset, _kvset_iter_next_vref);
     MOCK_SET(kvset, _kvset_iter_val_get);
@@ -499,4 +514,118 @@ MTF_DEFINE_UTEST_PREPOST(cn_tree_cursor_test, with_ptomb, pre_test, post_test)
     route_map_destroy(tree.ct_route_map);
 }
 
+/* Occupies the read-ahead workqueue's only thread until b_mutex is released.
+ */
+struct blocker {
+    struct work_struct b_work;
+    struct mutex       b_mutex;
+};
+
+static void
+blocker_worker(struct work_struct *work)
+{
+    struct blocker *b = container_of(work, struct blocker, b_work);
+
+    mutex_lock(&b->b_mutex);
+    mutex_unlock(&b->b_mutex);
+}
+
+MTF_DEFINE_UTEST_PREPOST(cn_tree_cursor_test, leaf_readahead, pre_test, post_test)
+{
+    struct blocker blocker;
+    merr_t err;
+    struct cn_cursor cur = {
+        .cncur_seqno = 10,
+    };
+    struct workqueue_struct *wq;
+    struct cn_tree_node tn[2];
+    struct route_node *rnode[2];
+    const char ekey[] = { 'm', 'z' };
+    const char *seek = "key";
+    int i;
+
+    wq = alloc_workqueue("cn_tree_cursor_test", 0, 1, 1);
+    ASSERT_NE(NULL, wq);
+
+    mapi_inject_ptr(mapi_idx_cn_get_ra_wq, wq);
+
+    tree.ct_route_map = route_map_create(CN_FANOUT_MAX);
+    ASSERT_NE(NULL, tree.ct_route_map);
+
+    for (i = 0; i < NELEM(rnode); i++) {
+        rnode[i] = route_map_insert(tree.ct_route_map, &tn[i], &ekey[i], sizeof(ekey[i]));
+        ASSERT_NE(NULL, rnode[i]);
+    }
+
+    kv_start();
+    kv_end();
+
+    err = cn_tree_cursor_create(&cur);
+    ASSERT_EQ(0, err);
+
+    /* Seeking into the first leaf starts read-ahead of the second leaf.
+     */
+    err = cn_tree_cursor_seek(&cur, seek, strlen(seek), NULL);
+    ASSERT_EQ(0, err);
+    ASSERT_FALSE(cur.cncur_lcur[1].cnlc_islast);
+    ASSERT_EQ(ekey[0], cur.cncur_lcur[1].cnlc_next_ekey[0]);
+    ASSERT_TRUE(cur.cncur_ra_queued);
+
+    flush_workqueue(wq);
+    ASSERT_FALSE(cur.cncur_ra_pending);
+    ASSERT_EQ(0, cur.cncur_ra_err);
+    ASSERT_TRUE(cur.cncur_ra_lcur.cnlc_islast);
+    ASSERT_EQ(1, table_len(cur.cncur_ra_lcur.cnlc_kvref_tab));
+
+    /* Seeking into the last leaf discards the read-ahead and starts none.
+     */
+    seek = "n";
+    err = cn_tree_cursor_seek(&cur, seek, strlen(seek), NULL);
+    ASSERT_EQ(0, err);
+    ASSERT_TRUE(cur.cncur_lcur[1].cnlc_islast);
+    ASSERT_FALSE(cur.cncur_ra_queued);
+    ASSERT_EQ(0, table_len(cur.cncur_ra_lcur.cnlc_kvref_tab));
+
+    /* A read-ahead that has yet to start is canceled rather than waited upon.
+     */
+    mutex_init(&blocker.b_mutex);
+    mutex_lock(&blocker.b_mutex);
+    INIT_WORK(&blocker.b_work, blocker_worker);
+    ASSERT_TRUE(queue_work(wq, &blocker.b_work));
+
+    seek = "key";
+    err = cn_tree_cursor_seek(&cur, seek, strlen(seek), NULL);
+    ASSERT_EQ(0, err);
+    ASSERT_TRUE(cur.cncur_ra_queued);
+
+    seek = "n";
+    err = cn_tree_cursor_seek(&cur, seek, strlen(seek), NULL);
+    ASSERT_EQ(0, err);
+    ASSERT_TRUE(cur.cncur_ra_cancel);
+    ASSERT_TRUE(cur.cncur_ra_pending);
+
+    mutex_unlock(&blocker.b_mutex);
+    flush_workqueue(wq);
+    mutex_destroy(&blocker.b_mutex);
+
+    ASSERT_FALSE(cur.cncur_ra_pending);
+    ASSERT_FALSE(cur.cncur_ra_started);
+    ASSERT_EQ(0, table_len(cur.cncur_ra_lcur.cnlc_kvref_tab));
+
+    /* Destroying a cursor waits for its read-ahead.
+     */
+    seek = "key";
+    err = cn_tree_cursor_seek(&cur, seek, strlen(seek), NULL);
+    ASSERT_EQ(0, err);
+    ASSERT_TRUE(cur.cncur_ra_queued);
+
+    cn_tree_cursor_destroy(&cur);
+
+    for (i = 0; i < NELEM(rnode); i++)
+        route_map_delete(tree.ct_route_map, rnode[i]);
+    route_map_destroy(tree.ct_route_map);
+
+    destroy_workqueue(wq);
+}
+
 MTF_END_UTEST_COLLECTION(cn_tree_cursor_test)
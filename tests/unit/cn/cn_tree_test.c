@@ -8,6 +8,7 @@
 #include <hse/error/merr.h>
 #include <hse/logging/logging.h>
 #include <hse/util/keycmp.h>
+#include <hse/util/workqueue.h>
 
 #include <hse/limits.h>
 
@@ -15,16 +16,19 @@
 #include <hse/ikvdb/limits.h>
 #include <hse/ikvdb/kvdb_health.h>
 #include <hse/ikvdb/cn.h>
+#include <hse/ikvdb/cn_kvdb.h>
 
 #include <cn/cn_tree.h>
 #include <cn/cn_tree_iter.h>
 #include <cn/cn_tree_internal.h>
 #include <cn/cn_tree_create.h>
+#include <cn/route.h>
 #include <cn/cn_tree_compact.h>
 
 #include <cn/cn_internal.h>
 #include <cn/kvset.h>
 #include <cn/kv_iterator.h>
+#include <cn/spill.h>
 
 struct mpool *     mock_ds = (void *)0x1234abcd;
 struct kvdb_health mock_health;
@@ -358,6 +362,7 @@ struct mapi_injection inject_list[] = {
     { mapi_idx_kvset_builder_create, MAPI_RC_SCALAR, 0 },
     { mapi_idx_kvset_builder_set_merge_stats, MAPI_RC_SCALAR, 0 },
     { mapi_idx_kvset_builder_set_agegroup, MAPI_RC_SCALAR, 0 },
+    { mapi_idx_kvset_builder_set_bloom_prob, MAPI_RC_SCALAR, 0 },
     { mapi_idx_kvset_builder_get_mblocks, MAPI_RC_SCALAR, 0 },
 
     { -1 },
@@ -877,4 +882,404 @@ MY_TEST2(test_tree, fanout_bits, 1, levels, 2, 1);
 MY_TEST2(test_tree, fanout_bits, 3, levels, 1, 0);
 MY_TEST2(test_tree, fanout_bits, 3, levels, 2, 1);
 
+MTF_DEFINE_UTEST_PRE(test, bloom_prob, test_setup)
+{
+    struct kvs_cparams cp = {};
+    struct cn_tree_node *tn;
+    struct cn_tree *tree;
+    merr_t err;
+
+    rp->cn_bloom_prob = 10000;
+    rp->cn_bloom_prob_root = 1000;
+
+    err = cn_tree_create(&tree, 0, &cp, &mock_health, rp);
+    ASSERT_EQ(0, err);
+
+    tn = cn_node_alloc(tree, 1);
+    ASSERT_NE(NULL, tn);
+
+    ASSERT_EQ(1000, cn_tree_node_bloom_prob(tree->ct_root));
+    ASSERT_EQ(10000, cn_tree_node_bloom_prob(tn));
+
+    rp->cn_bloom_prob_leaf = 20000;
+    ASSERT_EQ(20000, cn_tree_node_bloom_prob(tn));
+
+    /* Auto mode ignores the counters until enough lookups were sampled.
+     */
+    rp->cn_bloom_auto = true;
+    atomic_set(&tn->tn_bloom_probes, 100);
+    atomic_set(&tn->tn_bloom_negs, 10);
+    ASSERT_EQ(20000, cn_tree_node_bloom_prob(tn));
+
+    atomic_set(&tn->tn_bloom_probes, 4096);
+    atomic_set(&tn->tn_bloom_negs, 1024);
+    ASSERT_EQ(80000, cn_tree_node_bloom_prob(tn));
+
+    atomic_set(&tn->tn_bloom_negs, 4096);
+    ASSERT_EQ(20000, cn_tree_node_bloom_prob(tn));
+
+    atomic_set(&tn->tn_bloom_negs, 0);
+    ASSERT_EQ(200000, cn_tree_node_bloom_prob(tn));
+
+    cn_node_free(tn);
+    cn_tree_destroy(tree);
+}
+
+MTF_DEFINE_UTEST_PRE(test, range_split, test_setup)
+{
+    struct kvs_cparams cp = {};
+    struct route_node *rnodev[10];
+    char keybufv[9 * HSE_KVS_KEY_LEN_MAX];
+    uint keylenv[9], splitc;
+    struct cn_tree *tree;
+    char ekey[8];
+    merr_t err;
+    int i;
+
+    err = cn_tree_create(&tree, 0, &cp, &mock_health, rp);
+    ASSERT_EQ(0, err);
+
+    splitc = cn_tree_range_split(tree, NULL, 0, NULL, 0, 3, keybufv, keylenv);
+    ASSERT_EQ(0, splitc);
+
+    /* Leaf edge keys k010, k020, ..., k100.
+     */
+    for (i = 0; i < NELEM(rnodev); i++) {
+        snprintf(ekey, sizeof(ekey), "k%03d", (i + 1) * 10);
+        rnodev[i] = route_map_insert(tree->ct_route_map, tree->ct_root, ekey, strlen(ekey));
+        ASSERT_NE(NULL, rnodev[i]);
+    }
+
+    splitc = cn_tree_range_split(tree, NULL, 0, NULL, 0, 0, keybufv, keylenv);
+    ASSERT_EQ(0, splitc);
+
+    /* Nine candidate edges (the rightmost leaf is never split) in four groups.
+     */
+    splitc = cn_tree_range_split(tree, NULL, 0, NULL, 0, 3, keybufv, keylenv);
+    ASSERT_EQ(3, splitc);
+    ASSERT_EQ(0, keycmp(keybufv, keylenv[0], "k020", 4));
+    ASSERT_EQ(0, keycmp(keybufv + HSE_KVS_KEY_LEN_MAX, keylenv[1], "k050", 4));
+    ASSERT_EQ(0, keycmp(keybufv + 2 * HSE_KVS_KEY_LEN_MAX, keylenv[2], "k070", 4));
+
+    splitc = cn_tree_range_split(tree, NULL, 0, NULL, 0, 20, keybufv, keylenv);
+    ASSERT_EQ(9, splitc);
+    ASSERT_EQ(0, keycmp(keybufv, keylenv[0], "k010", 4));
+    ASSERT_EQ(0, keycmp(keybufv + 8 * HSE_KVS_KEY_LEN_MAX, keylenv[8], "k090", 4));
+
+    /* Only edges in [min, max) are candidates.
+     */
+    splitc = cn_tree_range_split(tree, "k025", 4, "k055", 4, 3, keybufv, keylenv);
+    ASSERT_EQ(3, splitc);
+    ASSERT_EQ(0, keycmp(keybufv, keylenv[0], "k030", 4));
+    ASSERT_EQ(0, keycmp(keybufv + 2 * HSE_KVS_KEY_LEN_MAX, keylenv[2], "k050", 4));
+
+    splitc = cn_tree_range_split(tree, "k025", 4, "k055", 4, 1, keybufv, keylenv);
+    ASSERT_EQ(1, splitc);
+    ASSERT_EQ(0, keycmp(keybufv, keylenv[0], "k040", 4));
+
+    splitc = cn_tree_range_split(tree, NULL, 0, "k030", 4, 9, keybufv, keylenv);
+    ASSERT_EQ(2, splitc);
+
+    splitc = cn_tree_range_split(tree, "k095", 4, NULL, 0, 9, keybufv, keylenv);
+    ASSERT_EQ(0, splitc);
+
+    for (i = 0; i < NELEM(rnodev); i++)
+        route_map_delete(tree->ct_route_map, rnodev[i]);
+
+    cn_tree_destroy(tree);
+}
+
+/*----------------------------------------------------------------
+ * Mocked spill, for root spills built in parallel ranges
+ */
+#define SPILL_LEAVES 8
+
+static struct cn_compaction_work *spill_work;
+static struct fake_kvset *        spill_kvsets;
+static uint64_t                   spill_fail_nodeid;
+static atomic_int                 spill_subspillc;
+static atomic_int                 spill_skipc;
+static atomic_int                 spill_rangec;
+static uint                       spill_rangelenv[SPILL_LEAVES];
+static char                       spill_rangev[SPILL_LEAVES][HSE_KVS_KEY_LEN_MAX];
+
+static merr_t
+_cn_subspill(
+    struct subspill     *ss,
+    struct spillctx     *sctx,
+    struct cn_tree_node *node,
+    uint64_t             node_dgen,
+    const void          *ekey,
+    uint                 eklen)
+{
+    if (node->tn_nodeid == spill_fail_nodeid)
+        return merr(EIO);
+
+    memset(ss, 0, sizeof(*ss));
+    ss->ss_work = spill_work;
+    ss->ss_sgen = spill_work->cw_sgen;
+    ss->ss_node = node;
+    ss->ss_kvsetid = node->tn_nodeid;
+    ss->ss_mblks.hblk_id = 0xabc000 + node->tn_nodeid;
+    ss->ss_added = true;
+
+    atomic_inc(&spill_subspillc);
+
+    return 0;
+}
+
+static merr_t
+_cn_spill_range_create(
+    struct cn_compaction_work *w,
+    struct workqueue_struct   *vra_wq,
+    const void                *key,
+    uint                       klen,
+    const void                *prev_ekey,
+    uint                       prev_eklen,
+    struct cn_merge_stats     *stats,
+    struct spillctx          **sctx_out)
+{
+    int n = atomic_inc_return(&spill_rangec) - 1;
+
+    if (n < SPILL_LEAVES) {
+        memcpy(spill_rangev[n], key, klen);
+        spill_rangelenv[n] = klen;
+    }
+
+    *sctx_out = (void *)w;
+
+    return 0;
+}
+
+static merr_t
+_cn_subspill_skip(
+    struct spillctx     *sctx,
+    struct cn_tree_node *node,
+    uint64_t             node_dgen,
+    const void          *ekey,
+    uint                 eklen)
+{
+    atomic_inc(&spill_skipc);
+
+    return 0;
+}
+
+static void
+_cn_subspill_get_kvset_meta(struct subspill *ss, struct kvset_meta *km)
+{
+    memset(km, 0, sizeof(*km));
+
+    km->km_dgen_hi = ss->ss_work->cw_dgen_hi;
+    km->km_dgen_lo = ss->ss_work->cw_dgen_hi_min;
+    km->km_nodeid = ss->ss_node->tn_nodeid;
+    km->km_hblk_id = ss->ss_mblks.hblk_id;
+}
+
+static merr_t
+_kvset_open(struct cn_tree *tree, u64 tag, struct kvset_meta *km, struct kvset **ks)
+{
+    struct fake_kvset *kvset;
+
+    kvset = fake_kvset_open(&spill_kvsets, km->km_dgen_hi);
+    if (!kvset)
+        return merr(ENOMEM);
+
+    kvset->dgen_lo = km->km_dgen_lo;
+    kvset->nodeid = km->km_nodeid;
+    *ks = (struct kvset *)kvset;
+
+    return 0;
+}
+
+static bool
+spill_range_started(const char *key)
+{
+    for (int i = 0; i < atomic_read(&spill_rangec) && i < SPILL_LEAVES; i++) {
+        if (!keycmp(spill_rangev[i], spill_rangelenv[i], key, strlen(key)))
+            return true;
+    }
+
+    return false;
+}
+
+/* Spill one root kvset into SPILL_LEAVES leaves with edge keys k010, k020,
+ * ..., k080 (each of which holds one older kvset), and verify the result.
+ */
+static int
+spill_plan_check(
+    struct mtf_test_info *lcl_ti,
+    struct cn_kvdb       *cn_kvdb,
+    int64_t               read_sz,
+    uint64_t              fail_nodeid,
+    int                   rangec)
+{
+    struct cn_tree_node *leafv[SPILL_LEAVES];
+    struct test_params tp = {};
+    struct cn_compaction_work w;
+    struct fake_kvset *kvset;
+    struct test t;
+    int built, i;
+    merr_t err;
+
+    test_init(&t, &tp, lcl_ti);
+
+    err = cn_tree_create(&t.tree, 0, &cp, &mock_health, rp);
+    ASSERT_EQ_RET(0, err, -1);
+
+    kvset = fake_kvset_open_add(&t.kvset_list, t.tree, 0, 100);
+    ASSERT_NE_RET(NULL, kvset, -1);
+
+    for (i = 0; i < SPILL_LEAVES; i++) {
+        char ekey[8];
+
+        leafv[i] = cn_node_alloc(t.tree, i + 1);
+        ASSERT_NE_RET(NULL, leafv[i], -1);
+
+        atomic_init(&leafv[i]->tn_sgen, g_node_sgen);
+        list_add_tail(&leafv[i]->tn_link, &t.tree->ct_nodes);
+
+        snprintf(ekey, sizeof(ekey), "k%03d", (i + 1) * 10);
+        leafv[i]->tn_route_node = route_map_insert(t.tree->ct_route_map, leafv[i], ekey,
+                                                   strlen(ekey));
+        ASSERT_NE_RET(NULL, leafv[i]->tn_route_node, -1);
+
+        kvset = fake_kvset_open_add(&t.kvset_list, t.tree, i + 1, 10 + i);
+        ASSERT_NE_RET(NULL, kvset, -1);
+    }
+
+    t.tree->cn_kvdb = cn_kvdb;
+
+    atomic_init(&t.tree->ct_root->tn_sgen, g_node_sgen);
+    cn_comp_work_init(&t, t.tree->ct_root, &w, CN_ACTION_SPILL, false);
+    w.cw_est.cwe_read_sz = read_sz;
+
+    spill_work = &w;
+    spill_fail_nodeid = fail_nodeid;
+    atomic_set(&spill_subspillc, 0);
+    atomic_set(&spill_skipc, 0);
+    atomic_set(&spill_rangec, 0);
+    mapi_calls_clear(mapi_idx_cn_mblocks_destroy);
+
+    cn_compact(&w);
+
+    /* Every range but the first has its own spill context, which replays
+     * just the leaf to the left of the range (no edge key is a prefix of
+     * another).
+     */
+    ASSERT_EQ_RET(rangec - 1, atomic_read(&spill_rangec), -1);
+    ASSERT_EQ_RET(rangec - 1, atomic_read(&spill_skipc), -1);
+    ASSERT_EQ_RET(0, t.tree->ct_rspill_pbuild, -1);
+
+    built = atomic_read(&spill_subspillc);
+
+    for (i = 0; i < SPILL_LEAVES; i++) {
+        struct cn_tree_node *tn = leafv[i];
+        struct kvset_list_entry *le;
+        struct fake_kvset *newest, *oldest;
+
+        ASSERT_EQ_RET(0, atomic_read(&tn->tn_ss_spilling), -1);
+
+        le = list_first_entry(&tn->tn_kvset_list, typeof(*le), le_link);
+        newest = (struct fake_kvset *)le->le_kvset;
+        le = list_last_entry(&tn->tn_kvset_list, typeof(*le), le_link);
+        oldest = (struct fake_kvset *)le->le_kvset;
+
+        ASSERT_EQ_RET(10 + i, oldest->dgen_hi, -1);
+
+        if (fail_nodeid) {
+            ASSERT_EQ_RET(oldest, newest, -1);
+            continue;
+        }
+
+        /* Each leaf received exactly one kvset, in front of its older kvset.
+         */
+        ASSERT_EQ_RET(&oldest->kle, list_next_entry(&newest->kle, le_link), -1);
+        ASSERT_EQ_RET(tn->tn_nodeid, newest->nodeid, -1);
+        ASSERT_EQ_RET(w.cw_dgen_hi, newest->dgen_hi, -1);
+        ASSERT_TRUE_RET(_kvset_younger((void *)newest, (void *)oldest), -1);
+        ASSERT_EQ_RET(g_node_sgen + 1, atomic_read(&tn->tn_sgen), -1);
+    }
+
+    if (fail_nodeid) {
+        /* The subspills built by the other ranges are discarded.
+         */
+        ASSERT_EQ_RET(EIO, merr_errno(w.cw_err), -1);
+        ASSERT_EQ_RET(built, mapi_calls(mapi_idx_cn_mblocks_destroy), -1);
+        ASSERT_TRUE_RET(t.tree->ct_rspills_wedged, -1);
+        ASSERT_FALSE_RET(list_empty(&t.tree->ct_root->tn_kvset_list), -1);
+    } else {
+        ASSERT_EQ_RET(0, w.cw_err, -1);
+        ASSERT_EQ_RET(SPILL_LEAVES, built, -1);
+        ASSERT_EQ_RET(0, mapi_calls(mapi_idx_cn_mblocks_destroy), -1);
+        ASSERT_TRUE_RET(list_empty(&t.tree->ct_root->tn_kvset_list), -1);
+    }
+
+    test_tree_destroy(&t);
+
+    while (spill_kvsets) {
+        kvset = spill_kvsets;
+        spill_kvsets = kvset->next;
+        fake_kvset_destroy(kvset);
+    }
+
+    return 0;
+}
+
+MTF_DEFINE_UTEST_PRE(test, spill_plan, test_setup)
+{
+    struct cn_kvdb cn_kvdb = {};
+    int rc;
+
+    cn_kvdb.cn_spill_threads = 3;
+    cn_kvdb.cn_spill_wq = alloc_workqueue("t_spill", 0, 1, cn_kvdb.cn_spill_threads);
+    ASSERT_NE(NULL, cn_kvdb.cn_spill_wq);
+
+    mapi_inject_unset(mapi_idx_cn_subspill);
+    mapi_inject_unset(mapi_idx_kvset_open);
+
+    MOCK_SET(spill, _cn_subspill);
+    MOCK_SET(spill, _cn_spill_range_create);
+    MOCK_SET(spill, _cn_subspill_skip);
+    MOCK_SET(spill, _cn_subspill_get_kvset_meta);
+    MOCK_SET(kvset, _kvset_open);
+
+    /* Spills that would read less than CN_SPILL_RANGE_MIN per range,
+     * and spills without a spill workqueue, are built serially.
+     */
+    rc = spill_plan_check(lcl_ti, &cn_kvdb, 2 * CN_SPILL_RANGE_MIN - 1, 0, 1);
+    ASSERT_EQ(0, rc);
+
+    rc = spill_plan_check(lcl_ti, NULL, 1ul << 40, 0, 1);
+    ASSERT_EQ(0, rc);
+
+    /* Two ranges of four (equally weighted) leaves.
+     */
+    rc = spill_plan_check(lcl_ti, &cn_kvdb, 2 * CN_SPILL_RANGE_MIN, 0, 2);
+    ASSERT_EQ(0, rc);
+    ASSERT_TRUE(spill_range_started("k040"));
+
+    /* The number of ranges is limited by the number of spill threads,
+     * and each range starts at the edge key of the previous range.
+     */
+    rc = spill_plan_check(lcl_ti, &cn_kvdb, 1ul << 40, 0, 4);
+    ASSERT_EQ(0, rc);
+    ASSERT_TRUE(spill_range_started("k020"));
+    ASSERT_TRUE(spill_range_started("k040"));
+    ASSERT_TRUE(spill_range_started("k060"));
+
+    /* A failure in one range (node 7 is the first leaf of the last range)
+     * fails the spill, commits nothing and releases all leaves.
+     */
+    rc = spill_plan_check(lcl_ti, &cn_kvdb, 1ul << 40, 7, 4);
+    ASSERT_EQ(0, rc);
+
+    MOCK_UNSET(spill, _cn_subspill);
+    MOCK_UNSET(spill, _cn_spill_range_create);
+    MOCK_UNSET(spill, _cn_subspill_skip);
+    MOCK_UNSET(spill, _cn_subspill_get_kvset_meta);
+    MOCK_UNSET(kvset, _kvset_open);
+
+    destroy_workqueue(cn_kvdb.cn_spill_wq);
+}
+
 MTF_END_UTEST_COLLECTION(test)
@@ -189,8 +189,11 @@ new_kvsets(struct test_tree *tt, int n_kvsets, int lvl, int off)
     for (off = start_off; off <= end_off; off++) {
 
         for (i = 0; i < n_kvsets; i++) {
+            struct kvset_meta *meta = init_kvset_meta(ttv->dgen--);
 
-            err = kvset_open(tt->tree, tt->tag, init_kvset_meta(ttv->dgen--), &kvset);
+            meta->km_nodeid = lvl + off;
+
+            err = kvset_open(tt->tree, tt->tag, meta, &kvset);
             if (err)
                 return err;
 
@@ -327,6 +330,16 @@ cn_node_stats_get_mock(const struct cn_tree_node *tn, struct cn_node_stats *s)
     s->ns_keys_uniq = 100 * 1000;
 }
 
+/* Hits reaped from each kvset over a heat period, indexed by nodeid.
+ */
+uint64_t heat_hitv[8];
+
+static uint64_t
+_kvset_reap_hits(struct kvset *ks)
+{
+    return heat_hitv[kvset_get_nodeid(ks)];
+}
+
 /* Prefer the mapi_inject_list method for mocking functions over the
  * MOCK_SET/MOCK_UNSET macros if the mock simply needs to return a
  * constant value.  The advantage of the mapi_inject_list approach is
@@ -643,4 +656,106 @@ MTF_DEFINE_UTEST_PRE(test, t_sp3_one_big_tree_with_work, pre_test)
     sp3_destroy(cs);
 }
 
+/* Run one heat period over the leaf nodes of %tree, where leaf node N is
+ * hit hitv[N - 1] times, and return the bytes of hot data it retains.
+ */
+static uint64_t
+heat_period(struct cn_tree *tree, uint64_t hot, uint64_t budget, const uint64_t *hitv)
+{
+    uint64_t used = 0;
+    void *lock;
+
+    memcpy(heat_hitv + 1, hitv, sizeof(*hitv) * 4);
+
+    rmlock_rlock(&tree->ct_lock, &lock);
+    sp3_heat_update(tree, hot, &used);
+    if (hot > 0)
+        sp3_heat_promote(tree, hot, budget, &used);
+    rmlock_runlock(lock);
+
+    return used;
+}
+
+MTF_DEFINE_UTEST_PRE(test, t_sp3_heat, pre_test)
+{
+    struct cn_tree_node *tn, *tnv[4];
+    struct test_tree *tt;
+    struct sp3_node *spnv[4];
+    uint64_t used;
+    merr_t err;
+    uint i = 0;
+
+    mapi_inject_unset(mapi_idx_kvset_reap_hits);
+    MOCK_SET(kvset, _kvset_reap_hits);
+
+    tt = new_tree(4);
+    ASSERT_NE(tt, NULL);
+
+    err = new_kvsets(tt, 1, 1, -1);
+    ASSERT_EQ(err, 0);
+
+    cn_tree_foreach_leaf(tn, tt->tree) {
+        ASSERT_LT(i, NELEM(tnv));
+        tn->tn_ns.ns_kst.kst_kalen = MiB(100);
+        spnv[i] = tn2spn(tn);
+        tnv[i++] = tn;
+    }
+    ASSERT_EQ(NELEM(tnv), i);
+
+    /* Nodes 1 and 2 are hot (heat 100 >= 50), but the budget only has
+     * room for one of them.  Node 3 is warm (heat 30).
+     */
+    used = heat_period(tt->tree, 50, MiB(150), (uint64_t[]){ 200, 200, 60, 0 });
+    ASSERT_EQ(MiB(100), used);
+    ASSERT_TRUE(tt->tree->ct_track_hits);
+    ASSERT_EQ(1, spnv[0]->spn_migrate);
+    ASSERT_EQ(0, spnv[1]->spn_migrate);
+    ASSERT_EQ(0, spnv[2]->spn_migrate);
+    ASSERT_EQ(0, spnv[3]->spn_migrate);
+    ASSERT_EQ(100, spnv[0]->spn_heat);
+    ASSERT_EQ(30, spnv[2]->spn_heat);
+
+    /* Complete the promotion of node 1 (see sp3_work_wtype_mclass).
+     */
+    tnv[0]->tn_hot = true;
+    spnv[0]->spn_migrate = 0;
+
+    /* Node 1 cools (heat 50) but remains hot, and is charged to the
+     * budget, so there is still no room for node 2 (heat 125).
+     */
+    used = heat_period(tt->tree, 50, MiB(150), (uint64_t[]){ 0, 150, 0, 0 });
+    ASSERT_EQ(MiB(100), used);
+    ASSERT_EQ(0, spnv[0]->spn_migrate);
+    ASSERT_EQ(0, spnv[1]->spn_migrate);
+
+    /* A larger budget admits node 2.
+     */
+    used = heat_period(tt->tree, 50, MiB(200), (uint64_t[]){ 0, 150, 0, 0 });
+    ASSERT_EQ(MiB(200), used);
+    ASSERT_EQ(25, spnv[0]->spn_heat);
+    ASSERT_EQ(0, spnv[0]->spn_migrate);
+    ASSERT_EQ(1, spnv[1]->spn_migrate);
+
+    /* Node 1 falls below half the hot rate (heat 12) and is demoted,
+     * while node 2 remains pending promotion (heat 68).
+     */
+    used = heat_period(tt->tree, 50, MiB(200), (uint64_t[]){ 0, 0, 0, 0 });
+    ASSERT_EQ(MiB(100), used);
+    ASSERT_EQ(-1, spnv[0]->spn_migrate);
+    ASSERT_EQ(1, spnv[1]->spn_migrate);
+    ASSERT_EQ(0, spnv[2]->spn_migrate);
+
+    /* Disabling the hot rate cancels pending promotions, demotes all
+     * hot nodes, and stops hit counting.
+     */
+    used = heat_period(tt->tree, 0, MiB(200), (uint64_t[]){ 0, 0, 0, 0 });
+    ASSERT_EQ(0, used);
+    ASSERT_FALSE(tt->tree->ct_track_hits);
+    ASSERT_EQ(-1, spnv[0]->spn_migrate);
+    ASSERT_EQ(0, spnv[1]->spn_migrate);
+
+    MOCK_UNSET(kvset, _kvset_reap_hits);
+    destroy_trees();
+}
+
 MTF_END_UTEST_COLLECTION(test);
@@ -221,6 +221,53 @@ MTF_DEFINE_UTEST_PREPOST(hblock_reader_test, t_hbr_read_vgroup_map, test_pre, te
     free(vgmap);
 }
 
+MTF_DEFINE_UTEST_PREPOST(hblock_reader_test, t_hbr_read_vblock_usage, test_pre, test_post)
+{
+    const uint32_t nvblks = hbh_ro.hbh_num_vblocks;
+    const uint32_t off_pg = FAKE_HBLOCK_SIZE / PAGE_SIZE - 1;
+    struct vbused_omf *omf = (void *)hblock + off_pg * PAGE_SIZE;
+    uint32_t vbusedv[4];
+    bool found;
+    merr_t err;
+
+    for (uint32_t i = 0; i < nvblks; i++)
+        omf_set_vbu_used(omf + i, (i + 1) * 1000);
+
+    /* No usage region.
+     */
+    err = hbr_read_vblock_usage(&mblk, nvblks, vbusedv, &found);
+    ASSERT_EQ(0, merr_errno(err));
+    ASSERT_FALSE(found);
+
+    omf_set_hbh_vbused_off_pg(mblk.map_base, off_pg);
+    omf_set_hbh_vbused_len_pg(mblk.map_base, 1);
+
+    err = hbr_read_vblock_usage(&mblk, nvblks, vbusedv, &found);
+    ASSERT_EQ(0, merr_errno(err));
+    ASSERT_TRUE(found);
+    for (uint32_t i = 0; i < nvblks; i++)
+        ASSERT_EQ((i + 1) * 1000, vbusedv[i]);
+
+    /* Mismatched vblock count.
+     */
+    err = hbr_read_vblock_usage(&mblk, nvblks - 1, vbusedv, &found);
+    ASSERT_EQ(EPROTO, merr_errno(err));
+
+    /* Region extends beyond the hblock.
+     */
+    omf_set_hbh_vbused_len_pg(mblk.map_base, 2);
+    err = hbr_read_vblock_usage(&mblk, nvblks, vbusedv, &found);
+    ASSERT_EQ(EPROTO, merr_errno(err));
+
+    /* Older hblocks have no usage region.
+     */
+    omf_set_hbh_vbused_len_pg(mblk.map_base, 1);
+    omf_set_hbh_version(mblk.map_base, HBLOCK_HDR_VERSION2);
+    err = hbr_read_vblock_usage(&mblk, nvblks, vbusedv, &found);
+    ASSERT_EQ(0, merr_errno(err));
+    ASSERT_FALSE(found);
+}
+
 MTF_DEFINE_UTEST_PREPOST(hblock_reader_test, t_hbr_read_ptree, test_pre, test_post)
 {
     merr_t err;
@@ -549,6 +549,38 @@ MTF_DEFINE_UTEST_PRE(test, t_kbb_fill, test_setup)
     }
 }
 
+MTF_DEFINE_UTEST_PRE(test, t_kbb_pfx_bloom, test_setup)
+{
+    struct kblock_builder *kbb = 0;
+    struct blk_list        blks;
+    merr_t                 err;
+
+    mocked_rp.cn_bloom_pfx = true;
+
+    /* Prefix length from the kvs prefix length, and from the rparam.
+     */
+    for (uint i = 0; i < 2; i++) {
+        mocked_cp.pfx_len = 8;
+        mocked_rp.cn_bloom_pfx_len = i ? 4 : 0;
+
+        err = kbb_create(KBB_CREATE_ARGS);
+        ASSERT_EQ(err, 0);
+
+        /* Keys shorter than the prefix are left out of the prefix filter. */
+        err = add_entries(lcl_ti, kbb, 100, 2, 0, 9, 0);
+        ASSERT_EQ(err, 0);
+
+        err = add_entries(lcl_ti, kbb, 10 * 1000, 16, 8, 9, 0);
+        ASSERT_EQ(err, 0);
+
+        err = kbb_finish(kbb, &blks);
+        ASSERT_EQ(err, 0);
+
+        blk_list_free(&blks);
+        kbb_destroy(kbb);
+    }
+}
+
 MTF_DEFINE_UTEST_PRE(test, t_hash_set, test_setup)
 {
     struct kblock_builder *kbb = 0;
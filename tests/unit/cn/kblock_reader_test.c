@@ -200,6 +200,55 @@ MTF_DEFINE_UTEST_PRE(kblock_reader, t_kbr_read_blm_region_desc, pre)
     ASSERT_EQ(blm.bd_bitmap, mblk.map_base + PAGE_SIZE * blm.bd_first_page);
 }
 
+MTF_DEFINE_UTEST_PRE(kblock_reader, t_kbr_read_pblm_region_desc, pre)
+{
+    merr_t err;
+    struct bloom_desc blm;
+    struct kblock_hdr_omf *kbh = mblk.map_base;
+    struct bloom_hdr_omf *pbh;
+    uint32_t hoff;
+
+    /* No prefix filter.
+     */
+    err = kbr_read_pblm_region_desc(&mblk, &blm);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(0, blm.bd_pfxlen);
+    ASSERT_EQ(0, blm.bd_n_pages);
+
+    /* Prefix filter on the last bloom page.
+     */
+    hoff = BLM_HOFF + ((sizeof(struct bloom_hdr_omf) + HOFF_ALIGN) & ~(HOFF_ALIGN - 1));
+    pbh = (void *)kbh + hoff;
+
+    omf_set_bh_magic(pbh, BLOOM_OMF_MAGIC);
+    omf_set_bh_version(pbh, BLOOM_OMF_VERSION);
+    omf_set_bh_type(pbh, BLOOM_OMF_BLOCKED);
+    omf_set_bh_bitmapsz(pbh, PAGE_SIZE);
+    omf_set_bh_bktshift(pbh, 9);
+    omf_set_bh_n_hashes(pbh, 7);
+
+    omf_set_kbh_pblm_hoff(kbh, hoff);
+    omf_set_kbh_pblm_hlen(kbh, sizeof(*pbh));
+    omf_set_kbh_pblm_doff_pg(kbh, FAKE_BLOOM_DOFF_PG + FAKE_BLOOM_DLEN_PG - 1);
+    omf_set_kbh_pblm_dlen_pg(kbh, 1);
+    omf_set_kbh_pblm_pfxlen(kbh, 4);
+
+    err = kbr_read_pblm_region_desc(&mblk, &blm);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(4, blm.bd_pfxlen);
+    ASSERT_EQ(1, blm.bd_n_pages);
+    ASSERT_EQ(7, blm.bd_n_hashes);
+    ASSERT_EQ(blm.bd_bitmap, mblk.map_base + PAGE_SIZE * blm.bd_first_page);
+
+    /* Version 6 kblocks have no prefix filter.
+     */
+    omf_set_kbh_version(kbh, KBLOCK_HDR_VERSION6);
+
+    err = kbr_read_pblm_region_desc(&mblk, &blm);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(0, blm.bd_pfxlen);
+}
+
 MTF_DEFINE_UTEST_PRE(kblock_reader, t_kbr_read_metrics, pre)
 {
     merr_t err;
@@ -233,7 +233,7 @@ MTF_DEFINE_UTEST_PRE(kcompact_test, keep, pre)
     for (i = 0; i < NITER; ++i)
         ASSERT_EQ(0, mock_make_vblocks(&itv[i], &rp, i));
 
-    err = kvset_keep_vblocks(&vbmap, &vgmap, itv, NITER);
+    err = kvset_keep_vblocks(&vbmap, &vgmap, itv, NITER, 0);
     ASSERT_EQ(err, 0);
 
     /* verify each map is cumulative of what came before */
@@ -253,6 +253,67 @@ MTF_DEFINE_UTEST_PRE(kcompact_test, keep, pre)
 #undef NITER
 }
 
+MTF_DEFINE_UTEST_PRE(kcompact_test, keep_vgc, pre)
+{
+#define NITER 8
+    struct kvs_rparams    rp = kvs_rparams_defaults();
+    struct kvset_vblk_map vbmap = { 0 };
+    struct vgmap *vgmap;
+    int                   i, j;
+    merr_t                err;
+
+    memset(itv, 0, sizeof(itv));
+
+    for (i = 0; i < NITER; ++i)
+        ASSERT_EQ(0, mock_make_vblocks(&itv[i], &rp, i));
+
+    /* Fully used vblocks are all kept.
+     */
+    err = kvset_keep_vblocks(&vbmap, &vgmap, itv, NITER, 50);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(0, vbmap.vbm_rewrc);
+    ASSERT_EQ(NITER * (NITER - 1) / 2, vbmap.vbm_blkc);
+    ASSERT_NE(NULL, vbmap.vbm_vbidx);
+
+    for (j = i = 0; i < NITER; ++i) {
+        ASSERT_EQ(vbmap.vbm_map[i], j);
+        j += i;
+    }
+
+    for (i = 0; i < j; ++i)
+        ASSERT_EQ(i, vbmap.vbm_vbidx[i]);
+
+    free(vbmap.vbm_vbidx);
+    free(vbmap.vbm_blkv);
+    vgmap_free(vgmap);
+
+    /* Vblocks with no live values are all rewritten.
+     */
+    mapi_inject(mapi_idx_kvset_get_nth_vblock_used, 0);
+
+    err = kvset_keep_vblocks(&vbmap, &vgmap, itv, NITER, 50);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(0, vbmap.vbm_blkc);
+    ASSERT_EQ(j, vbmap.vbm_rewrc);
+    ASSERT_EQ(0, vbmap.vbm_tot);
+    ASSERT_EQ(NULL, vgmap);
+
+    for (i = 0; i < j; ++i)
+        ASSERT_EQ(VBM_REWRITE, vbmap.vbm_vbidx[i]);
+
+    mapi_inject_unset(mapi_idx_kvset_get_nth_vblock_used);
+
+    free(vbmap.vbm_vbidx);
+    free(vbmap.vbm_blkv);
+    for (i = 0; i < NITER; ++i) {
+        struct mock_kv_iterator *iter = container_of(itv[i], typeof(*iter), kvi);
+
+        kvset_put_ref((struct kvset *)iter->kvset);
+        kvset_iter_release(itv[i]);
+    }
+#undef NITER
+}
+
 MTF_DEFINE_UTEST_PRE(kcompact_test, four_into_one, pre)
 {
 #define NITER 4
@@ -286,7 +347,7 @@ MTF_DEFINE_UTEST_PRE(kcompact_test, four_into_one, pre)
         ASSERT_EQ(0, mock_make_kvi(&itv[i], i, &rp, &nkv));
     }
 
-    err = kvset_keep_vblocks(&vbmap, &vgmap, itv, NITER);
+    err = kvset_keep_vblocks(&vbmap, &vgmap, itv, NITER, 0);
     ASSERT_EQ(0, err);
 
     st.kwant = 1;
@@ -357,7 +418,7 @@ MTF_DEFINE_UTEST_PRE(kcompact_test, all_gone, pre)
         ASSERT_EQ(0, mock_make_kvi(&itv[i], i, &rp, &nkv));
     }
 
-    err = kvset_keep_vblocks(&vbmap, &vgmap, itv, 5);
+    err = kvset_keep_vblocks(&vbmap, &vgmap, itv, 5, 0);
     ASSERT_EQ(0, err);
 
     /* HSE_REVISIT: is it possible to detect a memory overwrite here? */
@@ -429,7 +490,7 @@ MTF_DEFINE_UTEST_PREPOST(kcompact_test, all_gone_mixed, mixed_pre, mixed_post)
         ASSERT_EQ(0, mock_make_kvi(&itv[i], i, &rp, &nkv));
     }
 
-    err = kvset_keep_vblocks(&vbmap, &vgmap, itv, 5);
+    err = kvset_keep_vblocks(&vbmap, &vgmap, itv, 5, 0);
     ASSERT_EQ(0, err);
 
     /* HSE_REVISIT: is it possible to detect a memory overwrite here? */
@@ -498,7 +559,7 @@ MTF_DEFINE_UTEST_PREPOST(kcompact_test, four_into_one_mixed, mixed_pre, mixed_po
         ASSERT_EQ(0, mock_make_kvi(&itv[i], i, &rp, &nkv));
     }
 
-    err = kvset_keep_vblocks(&vbmap, &vgmap, itv, NITER);
+    err = kvset_keep_vblocks(&vbmap, &vgmap, itv, NITER, 0);
     ASSERT_EQ(0, err);
 
     st.kwant = 1;
@@ -566,7 +627,7 @@ run_kcompact(struct mtf_test_info *lcl_ti, int expect)
         ASSERT_EQ_RET(0, mock_make_kvi(&itv[i], i, &rp, &nkv), 1);
     }
 
-    err = kvset_keep_vblocks(&vbmap, &vgmap, itv, 5);
+    err = kvset_keep_vblocks(&vbmap, &vgmap, itv, 5, 0);
     ASSERT_EQ_RET(err, 0, 1);
 
     /* HSE_REVISIT: is it possible to detect a memory overwrite here? */
@@ -666,6 +727,8 @@ pre(struct mtf_test_info *info)
     mapi_inject(mapi_idx_cn_tree_get_cndb, 0);
     mapi_inject(mapi_idx_cndb_kvsetid_mint, 1);
     mapi_inject(mapi_idx_kvset_builder_set_agegroup, 0);
+    mapi_inject(mapi_idx_cn_tree_node_agegroup, HSE_MPOLICY_AGE_LEAF);
+    mapi_inject(mapi_idx_cn_tree_node_bloom_prob, 10000);
     mapi_inject(mapi_idx_kvset_builder_set_merge_stats, 0);
 
     return 0;
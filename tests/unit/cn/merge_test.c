@@ -11,6 +11,8 @@
 #include <mocks/mock_kvset_builder.h>
 
 #include <hse/logging/logging.h>
+#include <hse/util/compression_zstd.h>
+#include <hse/util/keycmp.h>
 #include <hse/util/parse_num.h>
 
 #include <hse/limits.h>
@@ -21,6 +23,9 @@
 #include <hse/ikvdb/limits.h>
 #include <hse/ikvdb/cn.h>
 #include <hse/ikvdb/cndb.h>
+#include <hse/ikvdb/kvs_vcomp.h>
+#include <hse/ikvdb/mclass_policy.h>
+#include <hse/ikvdb/vcomp_params.h>
 
 #include <cn/cn_tree.h>
 #include <cn/cn_tree_create.h>
@@ -28,6 +33,7 @@
 #include <cn/cn_tree_internal.h>
 #include <cn/spill.h>
 #include <cn/kcompact.h>
+#include <cn/kvcompact.h>
 #include <cn/cn_metrics.h>
 #include <cn/kvs_mblk_desc.h>
 #include <cn/kv_iterator.h>
@@ -55,6 +61,10 @@
 
 #define MAX_TEST_FILES 256
 
+#define RECOMP_KEYS  4
+#define RECOMP_VLEN  4000
+#define RECOMP_LEVEL 19
+
 static struct test_params {
     /* Intialized once at start of program */
     char *test_filev[MAX_TEST_FILES];
@@ -77,6 +87,8 @@ static struct test_params {
     int pfx_len;
     int next_output_key;
     int next_output_val;
+    FILE *record; /* log the output instead of verifying it (range spill) */
+    bool recomp;  /* save the values instead of verifying them (kvcompact) */
 
     /* Initialized when a new ptomb is encountered (spread mode only) */
     int  last_pt_key;
@@ -84,6 +96,15 @@ static struct test_params {
     int  pt_count;
 } tp;
 
+/* Values emitted by the recompression test.
+ */
+static struct {
+    uint valc;
+    uint vlenv[RECOMP_KEYS];
+    uint complenv[RECOMP_KEYS];
+    char vdatav[RECOMP_KEYS][RECOMP_VLEN];
+} recomp;
+
 static void
 search_dir(const char *path)
 {
@@ -399,6 +420,11 @@ _kvset_builder_add_key(struct kvset_builder *builder, const struct key_obj *kobj
 
     key_obj_copy(kdata, sizeof(kdata), &klen, kobj);
 
+    if (tp.record) {
+        fprintf(tp.record, "%.*s;", klen, (char *)kdata);
+        return 0;
+    }
+
     if (tp.verbose >= VERBOSE_PER_KEY1)
         printf("add_key, expect key#%u %.*s\n", tp.next_output_key, klen, (char *)kdata);
 
@@ -440,6 +466,14 @@ _kvset_builder_add_val_internal(
     const void *   ref_vdata = NULL;
     uint           ref_vlen = 0;
 
+    if (tp.record) {
+        bool data = (vtype == VTYPE_UCVAL || vtype == VTYPE_IVAL);
+
+        fprintf(tp.record, "%lu/%d/%.*s,", (ulong)seq, vtype,
+                data ? (int)vlen : 0, data ? (const char *)vdata : "");
+        return;
+    }
+
     ref_eof = kvset_get_nth_val(
         tp.out_kvset_node,
         tp.next_output_key,
@@ -548,6 +582,18 @@ _kvset_builder_add_val(
 {
     enum kmd_vtype vtype;
 
+    if (tp.recomp) {
+        uint i = recomp.valc++;
+
+        VERIFY_TRUE_RET(i < RECOMP_KEYS, __LINE__);
+        VERIFY_TRUE_RET((complen ?: vlen) <= RECOMP_VLEN, __LINE__);
+
+        recomp.vlenv[i] = vlen;
+        recomp.complenv[i] = complen;
+        memcpy(recomp.vdatav[i], vdata, complen ?: vlen);
+        return 0;
+    }
+
     if (vdata == HSE_CORE_TOMB_REG)
         vtype = VTYPE_TOMB;
     else if (vdata == HSE_CORE_TOMB_PFX)
@@ -832,6 +878,38 @@ kv_spill_test_kvi_create(
     return 0;
 }
 
+/* A range spill context creates its own iterators over the spill's
+ * input kvsets and seeks them to the start of its range.
+ */
+static merr_t
+_kvset_iter_create(
+    struct kvset *           kvset,
+    struct workqueue_struct *io_workq,
+    struct workqueue_struct *vra_wq,
+    struct perfc_set *       pc,
+    enum kvset_iter_flags    flags,
+    struct kv_iterator **    kvi_out)
+{
+    struct kv_spill_test_kvi *iter = (struct kv_spill_test_kvi *)kvset;
+
+    return kv_spill_test_kvi_create(kvi_out, iter->test, iter->src, NULL);
+}
+
+/* Seeks are kblock granular, rewind to the first key so that the range
+ * must discard all the keys that precede its start key.
+ */
+static merr_t
+_kvset_iter_seek(struct kv_iterator *kvi, const void *key, int len, bool *eof)
+{
+    struct kv_spill_test_kvi *iter = container_of(kvi, typeof(*iter), kvi);
+
+    iter->cursor = 0;
+    kvi->kvi_eof = false;
+    *eof = false;
+
+    return 0;
+}
+
 #define MODE_SPILL 0
 #define MODE_KCOMPACT 1
 
@@ -995,7 +1073,7 @@ run_testcase(struct mtf_test_info *lcl_ti, int mode, const char *info)
 
             route_node_keycpy(rtn, ekey, sizeof(ekey), &eklen);
 
-            err = cn_subspill(&subspill, sctx, 0, 0, ekey, eklen);
+            err = cn_subspill(&subspill, sctx, route_node_tnode(rtn), 0, ekey, eklen);
             ASSERT_EQ(0, err);
         }
 
@@ -1069,6 +1147,343 @@ run_testcase(struct mtf_test_info *lcl_ti, int mode, const char *info)
     free(iterv);
 }
 
+struct test_leaf {
+    struct cn_tree_node *tn;
+    uint                 eklen;
+    unsigned char        ekey[HSE_KVS_KEY_LEN_MAX];
+};
+
+static merr_t
+spill_leaves(struct spillctx *sctx, const struct test_leaf *leafv, uint first, uint last)
+{
+    for (uint i = first; i < last; i++) {
+        const struct test_leaf *leaf = leafv + i;
+        struct subspill ss;
+        merr_t err;
+
+        err = cn_subspill(&ss, sctx, leaf->tn, 0, leaf->ekey, leaf->eklen);
+        if (err)
+            return err;
+
+        fprintf(tp.record, "|%u:%d|", i, ss.ss_added);
+    }
+
+    return 0;
+}
+
+/* Spill the input kvsets into the leaves of the tree and log the output.
+ * If split is non-zero, the primary spill context builds only the leaves
+ * to the left of leaf split, and a range spill context (started the same
+ * way as cn_spill_range_cb() starts one) builds the remainder.
+ */
+static int
+range_spill(
+    struct mtf_test_info   *lcl_ti,
+    struct cn_tree         *tree,
+    struct kvs_rparams     *rp,
+    const struct test_leaf *leafv,
+    uint                    split,
+    char                  **log,
+    size_t                 *len)
+{
+    struct kv_iterator *iterv[tp.inp_kvset_nodec];
+    struct cn_tree_node *output_nodev[tp.fanout];
+    struct kvset_mblocks outputs[tp.fanout];
+    uint64_t kvsetidv[tp.fanout];
+    struct cn_compaction_work w;
+    struct cn_merge_stats stats;
+    struct spillctx *sctx;
+    atomic_int cancel;
+    merr_t err;
+    uint i;
+
+    atomic_set(&cancel, 0);
+
+    for (i = 0; i < tp.inp_kvset_nodec; i++) {
+        err = kv_spill_test_kvi_create(&iterv[i], &tp, i, lcl_ti);
+        ASSERT_EQ_RET(0, err, -1);
+    }
+
+    memset(outputs, 0, sizeof(outputs));
+    memset(output_nodev, 0, sizeof(output_nodev));
+
+    init_work(&w, (struct mpool *)lcl_ti, rp, tree, tp.horizon, tp.inp_kvset_nodec, iterv,
+              0, tp.pfx_len, 0, &cancel, tp.fanout, tp.drop_tombs, outputs, output_nodev,
+              kvsetidv, NULL, NULL);
+
+    w.cw_action = CN_ACTION_SPILL;
+
+    tp.record = open_memstream(log, len);
+    ASSERT_NE_RET(NULL, tp.record, -1);
+
+    err = cn_spill_create(&w, &sctx);
+    if (!err) {
+        err = spill_leaves(sctx, leafv, 0, split ? split : tp.fanout);
+        cn_spill_destroy(sctx);
+    }
+
+    if (!err && split > 0) {
+        const struct test_leaf *prev = leafv + split - 1;
+        const struct test_leaf *edge = NULL;
+        uint klen, skip;
+
+        /* Start at the prefix of the previous leaf's edge key and replay the
+         * leaves that may contain keys with that prefix.
+         */
+        klen = prev->eklen;
+        if (tp.pfx_len > 0 && klen > tp.pfx_len)
+            klen = tp.pfx_len;
+
+        for (skip = split - 1; skip > 0; --skip) {
+            edge = leafv + skip - 1;
+
+            if (keycmp(edge->ekey, edge->eklen, prev->ekey, klen) < 0)
+                break;
+
+            edge = NULL;
+        }
+
+        memset(&stats, 0, sizeof(stats));
+
+        err = cn_spill_range_create(&w, NULL, prev->ekey, klen, edge ? edge->ekey : NULL,
+                                    edge ? edge->eklen : 0, &stats, &sctx);
+        if (!err) {
+            for (i = skip; !err && i < split; i++)
+                err = cn_subspill_skip(sctx, leafv[i].tn, 0, leafv[i].ekey, leafv[i].eklen);
+
+            if (!err)
+                err = spill_leaves(sctx, leafv, split, tp.fanout);
+
+            cn_spill_destroy(sctx);
+        }
+    }
+
+    fclose(tp.record);
+    tp.record = NULL;
+
+    for (i = 0; i < tp.inp_kvset_nodec; i++)
+        kv_iterator_release(&iterv[i]);
+
+    ASSERT_EQ_RET(0, err, -1);
+
+    return 0;
+}
+
+static void
+run_range_testcase(struct mtf_test_info *lcl_ti, const char *info)
+{
+    struct kvs_cparams cp = { .pfx_len = tp.pfx_len };
+    struct kvs_rparams rp = kvs_rparams_defaults();
+    struct test_leaf leafv[tp.fanout];
+    struct kvdb_health health;
+    struct cn_tree *tree;
+    char *serial, *log;
+    size_t serial_len, len;
+    merr_t err;
+    int rc;
+
+    if (tp.inp_kvset_nodec == 0 || tp.out_kvset_nkeys < tp.fanout)
+        return;
+
+    if (tp.verbose >= VERBOSE_PER_FILE2)
+        printf("Mode: %s\n", info);
+
+    err = cn_tree_create(&tree, 0, &cp, &health, &rp);
+    ASSERT_EQ(0, err);
+
+    cn_tree_setup(tree, NULL, NULL, &rp, NULL, 1234, 0);
+
+    /* Place the leaf edges between the output keys, so that every leaf
+     * receives a share of the keys.
+     */
+    for (uint i = 0; i < tp.fanout; i++) {
+        struct test_leaf *leaf = leafv + i;
+
+        if (i < tp.fanout - 1) {
+            cJSON *key;
+            uint nvals;
+            bool eof;
+
+            eof = kvset_get_nth_key(tp.out_kvset_node,
+                                    (i + 1) * tp.out_kvset_nkeys / tp.fanout - 1, &key, &nvals);
+            ASSERT_FALSE(eof);
+
+            leaf->eklen = strlcpy((char *)leaf->ekey, cJSON_GetStringValue(key),
+                                  sizeof(leaf->ekey));
+        } else {
+            leaf->eklen = sizeof(leaf->ekey);
+            memset(leaf->ekey, 0xff, sizeof(leaf->ekey));
+        }
+
+        leaf->tn = cn_node_alloc(tree, i + 1);
+        ASSERT_NE(NULL, leaf->tn);
+
+        leaf->tn->tn_route_node = route_map_insert(tree->ct_route_map, leaf->tn, leaf->ekey,
+                                                   leaf->eklen);
+        ASSERT_NE(NULL, leaf->tn->tn_route_node);
+        list_add_tail(&leaf->tn->tn_link, &tree->ct_nodes);
+    }
+
+    rc = range_spill(lcl_ti, tree, &rp, leafv, 0, &serial, &serial_len);
+    ASSERT_EQ(0, rc);
+
+    /* Whichever leaf a range starts at, the subspills must be exactly
+     * those built by the serial spill.
+     */
+    for (uint split = 1; split < tp.fanout; split++) {
+        rc = range_spill(lcl_ti, tree, &rp, leafv, split, &log, &len);
+        ASSERT_EQ(0, rc);
+
+        ASSERT_EQ(serial_len, len);
+        ASSERT_EQ(0, memcmp(serial, log, len));
+        free(log);
+    }
+
+    free(serial);
+    cn_tree_destroy(tree);
+}
+
+static void
+recomp_val_make(char *buf, uint i)
+{
+    uint len = 0;
+
+    /* The last key's value is too small to be compressed.
+     */
+    if (i == RECOMP_KEYS - 1) {
+        strlcpy(buf, "small", RECOMP_VLEN + 1);
+        return;
+    }
+
+    while (len < RECOMP_VLEN)
+        len += snprintf(buf + len, RECOMP_VLEN + 1 - len, "value %u of key %u, ", len, i);
+}
+
+/* Run a kv-compaction of a single kvset whose values are stored uncompressed,
+ * and whose output lands in a leaf on the capacity media class iff %capacity.
+ */
+static void
+run_recomp_testcase(struct mtf_test_info *lcl_ti, bool capacity)
+{
+    struct kvs_rparams rp = kvs_rparams_defaults();
+    struct mclass_policy policy = { 0 };
+    struct cn_compaction_work w;
+    struct kvset_mblocks outputs[1];
+    struct cn_tree_node *output_nodev[1];
+    struct kv_iterator *iterv[1];
+    char val[RECOMP_VLEN + 1];
+    char buf[RECOMP_VLEN * 2];
+    uint64_t kvsetidv[1];
+    cJSON *kvsets, *kvset;
+    struct kvs_vcomp *vc;
+    atomic_int cancel;
+    merr_t err;
+    uint len;
+
+    rp.value.compression.compact = VCOMP_DEFAULT_ON;
+    rp.value.compression.compact_level = RECOMP_LEVEL;
+
+    err = kvs_vcomp_open(NULL, 1, &rp, NULL, &vc);
+    ASSERT_EQ(0, err);
+    ASSERT_TRUE(kvs_vcomp_recompress_enabled(vc));
+
+    policy.mc_table[HSE_MPOLICY_AGE_LEAF][HSE_MPOLICY_DTYPE_VALUE] =
+        capacity ? HSE_MCLASS_CAPACITY : HSE_MCLASS_STAGING;
+
+    mapi_inject_ptr(mapi_idx_cn_get_vcomp, vc);
+    mapi_inject_ptr(mapi_idx_cn_get_mclass_policy, &policy);
+
+    /*  kvsets = [ [ [ key, [ [ seq, "v", value ] ] ], ... ] ]
+     */
+    kvsets = cJSON_CreateArray();
+    kvset = cJSON_CreateArray();
+    ASSERT_TRUE(kvsets && kvset);
+    cJSON_AddItemToArray(kvsets, kvset);
+
+    for (uint i = 0; i < RECOMP_KEYS; i++) {
+        cJSON *entry, *vals, *v;
+        char key[32];
+
+        snprintf(key, sizeof(key), "key%03u", i);
+        recomp_val_make(val, i);
+
+        v = cJSON_CreateArray();
+        vals = cJSON_CreateArray();
+        entry = cJSON_CreateArray();
+        ASSERT_TRUE(v && vals && entry);
+
+        cJSON_AddItemToArray(v, cJSON_CreateNumber(RECOMP_KEYS - i));
+        cJSON_AddItemToArray(v, cJSON_CreateString("v"));
+        cJSON_AddItemToArray(v, cJSON_CreateString(val));
+        cJSON_AddItemToArray(vals, v);
+        cJSON_AddItemToArray(entry, cJSON_CreateString(key));
+        cJSON_AddItemToArray(entry, vals);
+        cJSON_AddItemToArray(kvset, entry);
+    }
+
+    tp.inp_kvset_nodev = kvsets;
+    tp.inp_kvset_nodec = 1;
+    tp.recomp = true;
+    recomp.valc = 0;
+
+    err = kv_spill_test_kvi_create(&iterv[0], &tp, 0, lcl_ti);
+    ASSERT_EQ(0, err);
+
+    atomic_set(&cancel, 0);
+    memset(outputs, 0, sizeof(outputs));
+    memset(output_nodev, 0, sizeof(output_nodev));
+
+    init_work(&w, (struct mpool *)lcl_ti, &rp, NULL, 0, 1, iterv, 0, 0, 0, &cancel, 1, false,
+              outputs, output_nodev, kvsetidv, NULL, NULL);
+    w.cw_action = CN_ACTION_COMPACT_KV;
+
+    err = cn_kvcompact(&w);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(RECOMP_KEYS, recomp.valc);
+
+    for (uint i = 0; i < RECOMP_KEYS; i++) {
+        const char *vdata = recomp.vdatav[i];
+
+        recomp_val_make(val, i);
+        ASSERT_EQ(strlen(val), recomp.vlenv[i]);
+
+        if (!capacity || i == RECOMP_KEYS - 1) {
+            ASSERT_EQ(0, recomp.complenv[i]);
+            ASSERT_EQ(0, memcmp(val, vdata, recomp.vlenv[i]));
+            continue;
+        }
+
+        /* The value must have been compressed with zstd at compact_level,
+         * and must read back intact.
+         */
+        ASSERT_GT(recomp.complenv[i], 0);
+        ASSERT_LT(recomp.complenv[i], recomp.vlenv[i]);
+        ASSERT_EQ(COMPRESS_ZSTD_TAG, (uint8_t)vdata[0]);
+
+        err = compress_zstd_compress(val, recomp.vlenv[i], buf, sizeof(buf), &len,
+                                     RECOMP_LEVEL, NULL);
+        ASSERT_EQ(0, err);
+        ASSERT_EQ(len, recomp.complenv[i]);
+        ASSERT_EQ(0, memcmp(buf, vdata, len));
+
+        err = vcomp_decompress(vdata, recomp.complenv[i], buf, sizeof(buf), &len);
+        ASSERT_EQ(0, err);
+        ASSERT_EQ(recomp.vlenv[i], len);
+        ASSERT_EQ(0, memcmp(val, buf, len));
+    }
+
+    kv_iterator_release(&iterv[0]);
+
+    tp.recomp = false;
+    tp.inp_kvset_nodev = NULL;
+    tp.inp_kvset_nodec = 0;
+    cJSON_Delete(kvsets);
+
+    mapi_inject_ptr(mapi_idx_cn_get_vcomp, NULL);
+    mapi_inject_unset(mapi_idx_cn_get_mclass_policy);
+    kvs_vcomp_close(vc);
+}
+
 static void
 setup_tcase(struct mtf_test_info *lcl_ti)
 {
@@ -1103,6 +1518,8 @@ run_all_tcases(struct mtf_test_info *lcl_ti)
         tp.pfx_len = tp.pfx_len >= 0 ? tp.pfx_len : 3;
         run_testcase(lcl_ti, MODE_SPILL, "spill with prefix");
 
+        run_range_testcase(lcl_ti, "range spill");
+
         teardown_tcase(lcl_ti);
     }
 }
@@ -1201,14 +1618,20 @@ test_prehook(struct mtf_test_info *info)
     MOCK_SET(kvset, _kvset_iter_val_get);
     MOCK_SET(kvset, _kvset_iter_next_vref);
     MOCK_SET(kvset, _kvset_iter_kvset_get);
+    MOCK_SET(kvset, _kvset_iter_create);
+    MOCK_SET(kvset, _kvset_iter_seek);
 
     /* Install kvset mocks */
     MOCK_SET(kvset_view, _kvset_get_dgen);
 
     /* Neuter the following APIs */
     mapi_inject_ptr(mapi_idx_cn_tree_get_cn, NULL);
+    mapi_inject_ptr(mapi_idx_cn_get_vcomp, NULL);
     mapi_inject(mapi_idx_kvset_builder_set_merge_stats, 0);
+    mapi_inject(mapi_idx_kvset_iter_set_stats, 0);
     mapi_inject(mapi_idx_cndb_kvsetid_mint, 1);
+    mapi_inject(mapi_idx_cn_tree_node_agegroup, HSE_MPOLICY_AGE_LEAF);
+    mapi_inject(mapi_idx_cn_tree_node_bloom_prob, 10000);
     mapi_inject(mapi_idx_cn_tree_get_cndb, 0);
 
     return 0;
@@ -1221,4 +1644,10 @@ MTF_DEFINE_UTEST_PRE(spill_test_col, spill_test, test_prehook)
     run_all_tcases(lcl_ti);
 }
 
+MTF_DEFINE_UTEST_PRE(spill_test_col, recompress, test_prehook)
+{
+    run_recomp_testcase(lcl_ti, true);
+    run_recomp_testcase(lcl_ti, false);
+}
+
 MTF_END_UTEST_COLLECTION(spill_test_col)
@@ -0,0 +1,202 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <mtf/framework.h>
+
+#include <hse/error/merr.h>
+#include <hse/ikvdb/tuple.h>
+
+#include <cn/rcache.h>
+
+static void
+fill(
+    struct rcache       *rc,
+    uint64_t             view,
+    const char          *key,
+    uint64_t             vseq,
+    enum key_lookup_res  res,
+    const char          *val)
+{
+    struct kvs_ktuple kt;
+    struct kvs_buf vbuf = { 0 };
+    uint64_t cookie;
+
+    kvs_ktuple_init(&kt, key, strlen(key));
+
+    if (val) {
+        vbuf.b_buf = (void *)val;
+        vbuf.b_buf_sz = vbuf.b_len = strlen(val);
+    }
+
+    cookie = rcache_fill_begin(rc, view);
+    rcache_fill(rc, cookie, &kt, vseq, res, &vbuf);
+}
+
+static bool
+lookup(struct rcache *rc, const char *key, uint64_t view, enum key_lookup_res *res, char *val)
+{
+    struct kvs_ktuple kt;
+    struct kvs_buf vbuf = { 0 };
+    bool hit;
+
+    kvs_ktuple_init(&kt, key, strlen(key));
+
+    vbuf.b_buf = val;
+    vbuf.b_buf_sz = 32;
+
+    hit = rcache_lookup(rc, &kt, view, res, &vbuf);
+    if (hit && *res == FOUND_VAL)
+        val[vbuf.b_len] = '\0';
+
+    return hit;
+}
+
+MTF_BEGIN_UTEST_COLLECTION(rcache_test);
+
+MTF_DEFINE_UTEST(rcache_test, basic)
+{
+    enum key_lookup_res res;
+    struct rcache *rc;
+    char val[33];
+    merr_t err;
+    bool hit;
+
+    err = rcache_create(0, 0, NULL, &rc);
+    ASSERT_NE(0, err);
+
+    err = rcache_create(1 << 20, 100, NULL, &rc);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, rc);
+
+    hit = lookup(rc, "key1", 200, &res, val);
+    ASSERT_FALSE(hit);
+
+    /* Results looked up at a view older than the newest data in cn
+     * are not admitted.
+     */
+    fill(rc, 99, "key1", 50, FOUND_VAL, "val1");
+    hit = lookup(rc, "key1", 200, &res, val);
+    ASSERT_FALSE(hit);
+
+    fill(rc, 150, "key1", 50, FOUND_VAL, "val1");
+    hit = lookup(rc, "key1", 200, &res, val);
+    ASSERT_TRUE(hit);
+    ASSERT_EQ(FOUND_VAL, res);
+    ASSERT_STREQ("val1", val);
+
+    /* A view that cannot see the cached value must miss.
+     */
+    hit = lookup(rc, "key1", 49, &res, val);
+    ASSERT_FALSE(hit);
+
+    fill(rc, 150, "key2", 60, FOUND_TMB, NULL);
+    hit = lookup(rc, "key2", 60, &res, val);
+    ASSERT_TRUE(hit);
+    ASSERT_EQ(FOUND_TMB, res);
+
+    fill(rc, 150, "key3", 0, NOT_FOUND, NULL);
+    hit = lookup(rc, "key3", 1, &res, val);
+    ASSERT_TRUE(hit);
+    ASSERT_EQ(NOT_FOUND, res);
+
+    rcache_invalidate(rc, &(struct kvs_ktuple){ 0 });
+    hit = lookup(rc, "key1", 200, &res, val);
+    ASSERT_TRUE(hit);
+
+    {
+        struct kvs_ktuple kt;
+
+        kvs_ktuple_init(&kt, "key1", 4);
+        rcache_invalidate(rc, &kt);
+    }
+
+    hit = lookup(rc, "key1", 200, &res, val);
+    ASSERT_FALSE(hit);
+    hit = lookup(rc, "key2", 200, &res, val);
+    ASSERT_TRUE(hit);
+
+    rcache_destroy(rc);
+}
+
+MTF_DEFINE_UTEST(rcache_test, flush)
+{
+    enum key_lookup_res res;
+    struct kvs_ktuple kt;
+    struct kvs_buf vbuf = { 0 };
+    struct rcache *rc;
+    uint64_t cookie;
+    char val[33];
+    merr_t err;
+    bool hit;
+
+    err = rcache_create(1 << 20, 100, NULL, &rc);
+    ASSERT_EQ(0, err);
+
+    fill(rc, 150, "key1", 50, FOUND_VAL, "val1");
+    hit = lookup(rc, "key1", 200, &res, val);
+    ASSERT_TRUE(hit);
+
+    /* An ingest invalidates all entries and raises the admission view.
+     */
+    rcache_flush(rc, 300);
+
+    hit = lookup(rc, "key1", 200, &res, val);
+    ASSERT_FALSE(hit);
+
+    fill(rc, 250, "key1", 280, FOUND_VAL, "val2");
+    hit = lookup(rc, "key1", 400, &res, val);
+    ASSERT_FALSE(hit);
+
+    fill(rc, 300, "key1", 280, FOUND_VAL, "val2");
+    hit = lookup(rc, "key1", 400, &res, val);
+    ASSERT_TRUE(hit);
+    ASSERT_STREQ("val2", val);
+
+    /* A fill that raced with an ingest is dropped.
+     */
+    kvs_ktuple_init(&kt, "key3", 4);
+    cookie = rcache_fill_begin(rc, 400);
+    ASSERT_NE(0, cookie);
+
+    rcache_flush(rc, 0);
+    rcache_fill(rc, cookie, &kt, 0, NOT_FOUND, &vbuf);
+
+    hit = lookup(rc, "key3", 400, &res, val);
+    ASSERT_FALSE(hit);
+
+    rcache_destroy(rc);
+}
+
+MTF_DEFINE_UTEST(rcache_test, budget)
+{
+    enum key_lookup_res res;
+    struct rcache *rc;
+    char key[32], val[33];
+    uint hits = 0;
+    merr_t err;
+
+    err = rcache_create(16 * 1024, 0, NULL, &rc);
+    ASSERT_EQ(0, err);
+
+    for (uint i = 0; i < 10000; ++i) {
+        snprintf(key, sizeof(key), "key%u", i);
+        fill(rc, 1, key, 1, FOUND_VAL, "0123456789abcdef0123456789abcdef");
+    }
+
+    for (uint i = 0; i < 10000; ++i) {
+        snprintf(key, sizeof(key), "key%u", i);
+        if (lookup(rc, key, 1, &res, val)) {
+            ASSERT_STREQ("0123456789abcdef0123456789abcdef", val);
+            hits++;
+        }
+    }
+
+    ASSERT_GT(hits, 0);
+    ASSERT_LT(hits, 16 * 1024 / 32);
+
+    rcache_destroy(rc);
+}
+
+MTF_END_UTEST_COLLECTION(rcache_test);
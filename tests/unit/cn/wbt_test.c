@@ -290,7 +290,7 @@ get_verify(struct mtf_test_info *lcl_ti, void *tree, struct wbt_hdr_omf *hdr, st
         key2kobj(&ko_ref, k->kdata, k->klen);
 
         lookup_res = NOT_FOUND;
-        err = wbtr_read_vref(kbd.map_base, &wbd, &kt, 1, &lookup_res, NULL, &vref);
+        err = wbtr_read_vref(kbd.map_base, NULL, &wbd, &kt, 1, &lookup_res, NULL, &vref);
         ASSERT_EQ_RET(0, err, 1);
 
         found = ref_tree_get(rtree, k->kdata, k->klen);
@@ -571,4 +571,36 @@ MTF_DEFINE_UTEST_PREPOST(wbt_test, skip_keys, pre_test, post_test)
     free(ql.buf);
 }
 
+MTF_DEFINE_UTEST(wbt_test, ine_fp_search)
+{
+    uint32_t fpv[64];
+    uint     i, n;
+
+    ASSERT_EQ(0x61000000, wbt_ine_fp("a", 1));
+    ASSERT_EQ(0x61626364, wbt_ine_fp("abcdefg", 7));
+    ASSERT_EQ(0, wbt_ine_fp("", 0));
+
+    /* Pairs of duplicate fingerprints: 0, 0, 2, 2, 4, 4, ... */
+    for (i = 0; i < NELEM(fpv); i++)
+        fpv[i] = cpu_to_be32(i & ~1u);
+
+    for (n = 0; n <= NELEM(fpv); n++) {
+        for (i = 0; i <= NELEM(fpv) + 1; i++) {
+            uint lo = 0, hi = 0;
+
+            while (lo < n && be32_to_cpu(fpv[lo]) < i)
+                lo++;
+            while (hi < n && be32_to_cpu(fpv[hi]) <= i)
+                hi++;
+
+            ASSERT_EQ(lo, wbt_ine_fp_search(fpv, n, i, false));
+            ASSERT_EQ(hi, wbt_ine_fp_search(fpv, n, i, true));
+        }
+    }
+
+    fpv[0] = cpu_to_be32(UINT32_MAX);
+    ASSERT_EQ(0, wbt_ine_fp_search(fpv, 1, UINT32_MAX, false));
+    ASSERT_EQ(1, wbt_ine_fp_search(fpv, 1, UINT32_MAX, true));
+}
+
 MTF_END_UTEST_COLLECTION(wbt_test)
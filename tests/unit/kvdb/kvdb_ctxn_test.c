@@ -1542,4 +1542,104 @@ MTF_DEFINE_UTEST_PREPOST(kvdb_ctxn_test, expired, mapi_pre, mapi_post)
     viewset_destroy(vs);
 }
 
+static void *
+group_commit_helper(void *arg)
+{
+    struct kvdb_ctxn *handle = arg;
+
+    return (void *)(uintptr_t)merr_errno(kvdb_ctxn_commit(handle));
+}
+
+/* Concurrent committers are committed in batches, each of which must mint
+ * a distinct commit seqno for every txn in the batch.
+ */
+MTF_DEFINE_UTEST_PREPOST(kvdb_ctxn_test, group_commit, mapi_pre, mapi_post)
+{
+    const int              num_txns = 64;
+    const u64              initial_seq = 117UL;
+    struct kvdb_ctxn      *handles[num_txns];
+    pthread_t              tidv[num_txns];
+    bool                   seen[2 * num_txns];
+    struct viewset        *vs;
+    struct c0snr_set      *css;
+    atomic_ulong           kvdb_seq, tseqno;
+    atomic_ulong          *headp;
+    merr_t                 err;
+    int                    i, rc;
+
+    atomic_set(&kvdb_seq, initial_seq);
+    atomic_set(&tseqno, 0);
+
+    err = viewset_create(&vs, &kvdb_seq, &tseqno);
+    ASSERT_EQ(0, err);
+
+    err = kvdb_ctxn_set_create(&kvdb_ctxn_set, tn_timeout, tn_delay);
+    ASSERT_EQ(0, err);
+
+    err = c0snr_set_create(&css);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; i < num_txns; i++) {
+        uintptr_t seqref;
+        int64_t cookie;
+        u64 view_seqno;
+
+        handles[i] = kvdb_ctxn_alloc(NULL, NULL, &kvdb_seq, kvdb_ctxn_set, vs, css, NULL, NULL);
+        ASSERT_NE(NULL, handles[i]);
+
+        err = kvdb_ctxn_begin(handles[i]);
+        ASSERT_EQ(0, err);
+
+        /* Make the txn a writer so that it must mint a commit seqno.
+         */
+        err = kvdb_ctxn_trylock_write(handles[i], &seqref, &view_seqno, &cookie, false, 0, i);
+        ASSERT_EQ(0, err);
+        ASSERT_EQ(initial_seq, view_seqno);
+
+        kvdb_ctxn_unlock(handles[i]);
+    }
+
+    for (i = 0; i < num_txns; i++) {
+        rc = pthread_create(tidv + i, 0, group_commit_helper, handles[i]);
+        ASSERT_EQ(0, rc);
+    }
+
+    for (i = 0; i < num_txns; i++) {
+        void *result;
+
+        rc = pthread_join(tidv[i], &result);
+        ASSERT_EQ(0, rc);
+        ASSERT_EQ(0, (uintptr_t)result);
+    }
+
+    /* Each commit consumes two seqnos and one commit ticket.
+     */
+    ASSERT_EQ(initial_seq + 2 * num_txns, atomic_read(&kvdb_seq));
+
+    headp = kvdb_ctxn_set_tseqnop_get(kvdb_ctxn_set);
+    ASSERT_EQ(num_txns, atomic_read(headp));
+    kvdb_ctxn_set_wait_commits(kvdb_ctxn_set, 0);
+
+    memset(seen, 0, sizeof(seen));
+
+    for (i = 0; i < num_txns; i++) {
+        uintptr_t seqref = kvdb_ctxn_get_seqnoref(handles[i]);
+        u64 commit_sn;
+
+        ASSERT_EQ(KVDB_CTXN_COMMITTED, kvdb_ctxn_get_state(handles[i]));
+
+        commit_sn = HSE_SQNREF_TO_ORDNL(seqref);
+        ASSERT_GT(commit_sn, initial_seq);
+        ASSERT_LT(commit_sn, initial_seq + 2 * num_txns);
+        ASSERT_FALSE(seen[commit_sn - initial_seq]);
+        seen[commit_sn - initial_seq] = true;
+
+        kvdb_ctxn_free(handles[i]);
+    }
+
+    kvdb_ctxn_set_destroy(kvdb_ctxn_set);
+    c0snr_set_destroy(css);
+    viewset_destroy(vs);
+}
+
 MTF_END_UTEST_COLLECTION(kvdb_ctxn_test);
@@ -822,4 +822,104 @@ MTF_DEFINE_UTEST(kvdb_rest_test, perfc)
     ASSERT_EQ(0, merr_errno(err));
 }
 
+static merr_t
+check_slowops_cb(
+    const long status,
+    const char *const headers,
+    const size_t headers_len,
+    const char *const output,
+    const size_t output_len,
+    void *const arg)
+{
+    merr_t err = 0;
+    cJSON *body, *rec;
+
+    if (status != REST_STATUS_OK)
+        return merr(EINVAL);
+
+    if (!strstr(headers, REST_MAKE_STATIC_HEADER(REST_HEADER_CONTENT_TYPE, REST_APPLICATION_JSON)))
+        return merr(EINVAL);
+
+    body = cJSON_ParseWithLength(output, output_len);
+    if (!body) {
+        if (cJSON_GetErrorPtr()) {
+            return merr(EPROTO);
+        } else {
+            return merr(ENOMEM);
+        }
+    }
+
+    if (!cJSON_IsArray(body)) {
+        err = merr(EINVAL);
+        goto out;
+    }
+
+    cJSON_ArrayForEach(rec, body) {
+        cJSON *op, *latency, *stages;
+
+        op = cJSON_GetObjectItemCaseSensitive(rec, "op");
+        latency = cJSON_GetObjectItemCaseSensitive(rec, "latency_ns");
+        stages = cJSON_GetObjectItemCaseSensitive(rec, "stages");
+
+        if (!cJSON_IsString(op) || !cJSON_IsNumber(latency) || !cJSON_IsObject(stages)) {
+            err = merr(EINVAL);
+            goto out;
+        }
+    }
+
+out:
+    cJSON_Delete(body);
+
+    return err;
+}
+
+MTF_DEFINE_UTEST(kvdb_rest_test, slowops)
+{
+    merr_t err;
+    struct curl_slist *headers = NULL;
+    long status = REST_STATUS_BAD_REQUEST;
+    const char *alias = ikvdb_alias((struct ikvdb *)kvdb);
+
+    headers = curl_slist_append(headers, REST_MAKE_STATIC_HEADER(REST_HEADER_CONTENT_TYPE,
+        REST_APPLICATION_JSON));
+    ASSERT_NE(NULL, headers);
+
+    err = rest_client_fetch("GET", NULL, NULL, 0, check_status_cb, &status,
+        "/kvdbs/%s/slowops?pretty=xyz", alias);
+    ASSERT_EQ(0, merr_errno(err));
+
+    err = rest_client_fetch("GET", NULL, NULL, 0, check_slowops_cb, NULL, "/kvdbs/%s/slowops",
+        alias);
+    ASSERT_EQ(0, merr_errno(err));
+
+    status = REST_STATUS_CREATED;
+    err = rest_client_fetch("PUT", headers, "1", 1, check_status_cb, &status,
+        "/kvdbs/%s/params/slowop_thresh_us", alias);
+    ASSERT_EQ(0, merr_errno(err));
+
+    for (int i = 0; i < 100; i++) {
+        char key[16];
+        bool found;
+        size_t vlen;
+
+        snprintf(key, sizeof(key), "slowop%d", i);
+
+        err = hse_kvs_put(kvs1, 0, NULL, key, strlen(key), key, strlen(key));
+        ASSERT_EQ(0, merr_errno(err));
+
+        err = hse_kvs_get(kvs1, 0, NULL, key, strlen(key), &found, NULL, 0, &vlen);
+        ASSERT_EQ(0, merr_errno(err));
+    }
+
+    err = rest_client_fetch("PUT", headers, "0", 1, check_status_cb, &status,
+        "/kvdbs/%s/params/slowop_thresh_us", alias);
+    ASSERT_EQ(0, merr_errno(err));
+
+    err = rest_client_fetch("GET", NULL, NULL, 0, check_slowops_cb, NULL,
+        "/kvdbs/%s/slowops?pretty=true", alias);
+    ASSERT_EQ(0, merr_errno(err));
+
+    curl_slist_free_all(headers);
+}
+
 MTF_END_UTEST_COLLECTION(kvdb_rest_test)
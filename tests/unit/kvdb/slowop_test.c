@@ -0,0 +1,186 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <unistd.h>
+
+#include <cjson/cJSON.h>
+
+#include <mtf/framework.h>
+
+#include <hse/ikvdb/slowop.h>
+
+MTF_BEGIN_UTEST_COLLECTION(slowop_test)
+
+static int
+slowop_count(struct mtf_test_info *lcl_ti, struct slowop_log *log)
+{
+    cJSON *root;
+    merr_t err;
+    int n;
+
+    err = slowop_log_emit(log, &root);
+    ASSERT_EQ_RET(0, err, -1);
+    ASSERT_TRUE_RET(cJSON_IsArray(root), -1);
+
+    n = cJSON_GetArraySize(root);
+    cJSON_Delete(root);
+
+    return n;
+}
+
+MTF_DEFINE_UTEST(slowop_test, threshold)
+{
+    struct slowop_log *log;
+    struct slowop so;
+    merr_t err;
+
+    err = slowop_log_create(&log);
+    ASSERT_EQ(0, err);
+
+    /* A zero threshold disables tracing.
+     */
+    slowop_start(&so, 0);
+    ASSERT_FALSE(slowop_tls.st_active);
+    usleep(2000);
+    slowop_finish(log, &so, SLOWOP_GET, "kvs1", "key", 3);
+    ASSERT_EQ(0, slowop_count(lcl_ti, log));
+
+    /* Operations faster than the threshold are not recorded.
+     */
+    slowop_start(&so, 10 * 1000 * 1000);
+    ASSERT_TRUE(slowop_tls.st_active);
+    slowop_finish(log, &so, SLOWOP_PUT, "kvs1", "key", 3);
+    ASSERT_FALSE(slowop_tls.st_active);
+    ASSERT_EQ(0, slowop_count(lcl_ti, log));
+
+    slowop_log_destroy(log);
+}
+
+MTF_DEFINE_UTEST(slowop_test, record)
+{
+    struct slowop_log *log;
+    struct slowop so, inner;
+    cJSON *root, *rec, *stages, *item;
+    uint64_t start;
+    merr_t err;
+
+    err = slowop_log_create(&log);
+    ASSERT_EQ(0, err);
+
+    slowop_start(&so, 1);
+    slowop_add(SLOWOP_KVSETS, 3);
+    slowop_add(SLOWOP_BLOOM_FP, 1);
+
+    start = slowop_stage_start();
+    ASSERT_NE(0, start);
+    usleep(1000);
+    slowop_stage_end(SLOWOP_CN_NS, start);
+
+    /* Nested operations are accounted to the outer operation.
+     */
+    slowop_start(&inner, 1);
+    ASSERT_EQ(0, inner.so_start);
+    slowop_add(SLOWOP_KVSETS, 1);
+    slowop_finish(log, &inner, SLOWOP_GET, "kvs1", "inner", 5);
+    ASSERT_TRUE(slowop_tls.st_active);
+
+    slowop_finish(log, &so, SLOWOP_GET, "kvs1", "key", 3);
+    ASSERT_FALSE(slowop_tls.st_active);
+
+    /* Stage statistics are not accumulated between operations.
+     */
+    slowop_add(SLOWOP_KVSETS, 100);
+    ASSERT_EQ(0, slowop_stage_start());
+
+    err = slowop_log_emit(log, &root);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(1, cJSON_GetArraySize(root));
+
+    rec = cJSON_GetArrayItem(root, 0);
+    ASSERT_NE(NULL, rec);
+
+    item = cJSON_GetObjectItemCaseSensitive(rec, "op");
+    ASSERT_STREQ("get", cJSON_GetStringValue(item));
+    item = cJSON_GetObjectItemCaseSensitive(rec, "kvs");
+    ASSERT_STREQ("kvs1", cJSON_GetStringValue(item));
+    item = cJSON_GetObjectItemCaseSensitive(rec, "key");
+    ASSERT_STREQ("key", cJSON_GetStringValue(item));
+    item = cJSON_GetObjectItemCaseSensitive(rec, "key_length");
+    ASSERT_EQ(3, cJSON_GetNumberValue(item));
+    item = cJSON_GetObjectItemCaseSensitive(rec, "latency_ns");
+    ASSERT_GE(cJSON_GetNumberValue(item), 1000 * 1000);
+
+    stages = cJSON_GetObjectItemCaseSensitive(rec, "stages");
+    ASSERT_TRUE(cJSON_IsObject(stages));
+    item = cJSON_GetObjectItemCaseSensitive(stages, "kvsets");
+    ASSERT_EQ(4, cJSON_GetNumberValue(item));
+    item = cJSON_GetObjectItemCaseSensitive(stages, "bloom_fp");
+    ASSERT_EQ(1, cJSON_GetNumberValue(item));
+    item = cJSON_GetObjectItemCaseSensitive(stages, "cn_ns");
+    ASSERT_GE(cJSON_GetNumberValue(item), 1000 * 1000);
+    item = cJSON_GetObjectItemCaseSensitive(stages, "c0_ns");
+    ASSERT_EQ(0, cJSON_GetNumberValue(item));
+
+    /* The calling thread's rusage deltas over the operation.
+     */
+    item = cJSON_GetObjectItemCaseSensitive(stages, "minflt");
+    ASSERT_TRUE(cJSON_IsNumber(item));
+    item = cJSON_GetObjectItemCaseSensitive(stages, "majflt");
+    ASSERT_TRUE(cJSON_IsNumber(item));
+    item = cJSON_GetObjectItemCaseSensitive(stages, "inblock");
+    ASSERT_TRUE(cJSON_IsNumber(item));
+
+    cJSON_Delete(root);
+    slowop_log_destroy(log);
+}
+
+MTF_DEFINE_UTEST(slowop_test, wrap)
+{
+    struct slowop_log *log;
+    double prev = 0;
+    cJSON *root;
+    merr_t err;
+    int n;
+
+    err = slowop_log_create(&log);
+    ASSERT_EQ(0, err);
+
+    for (uint i = 0; i < 1000; ++i) {
+        struct slowop so;
+
+        slowop_start(&so, 1);
+        usleep(2);
+        slowop_finish(log, &so, SLOWOP_TXN_COMMIT, NULL, NULL, 0);
+    }
+
+    /* Each ring retains only its most recent records, and records
+     * are emitted oldest first.
+     */
+    err = slowop_log_emit(log, &root);
+    ASSERT_EQ(0, err);
+
+    n = cJSON_GetArraySize(root);
+    ASSERT_GT(n, 0);
+    ASSERT_LT(n, 1000);
+
+    for (int i = 0; i < n; ++i) {
+        cJSON *rec = cJSON_GetArrayItem(root, i);
+        cJSON *item;
+
+        item = cJSON_GetObjectItemCaseSensitive(rec, "op");
+        ASSERT_STREQ("txn_commit", cJSON_GetStringValue(item));
+        item = cJSON_GetObjectItemCaseSensitive(rec, "key_length");
+        ASSERT_EQ(0, cJSON_GetNumberValue(item));
+
+        item = cJSON_GetObjectItemCaseSensitive(rec, "timestamp_us");
+        ASSERT_GE(cJSON_GetNumberValue(item), prev);
+        prev = cJSON_GetNumberValue(item);
+    }
+
+    cJSON_Delete(root);
+    slowop_log_destroy(log);
+}
+
+MTF_END_UTEST_COLLECTION(slowop_test)
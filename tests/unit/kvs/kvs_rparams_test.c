@@ -404,6 +404,44 @@ MTF_DEFINE_UTEST_PRE(kvs_rparams_test, cn_mcache_vmax, test_pre)
     ASSERT_EQ(UINT32_MAX, ps->ps_bounds.as_uscalar.ps_max);
 }
 
+MTF_DEFINE_UTEST_PRE(kvs_rparams_test, cn_get_aio_depth, test_pre)
+{
+    const struct param_spec *ps = ps_get("cn_get_aio_depth");
+
+    ASSERT_NE(NULL, ps);
+    ASSERT_NE(NULL, ps->ps_description);
+    ASSERT_EQ(PARAM_FLAG_EXPERIMENTAL | PARAM_FLAG_WRITABLE, ps->ps_flags);
+    ASSERT_EQ(PARAM_TYPE_U32, ps->ps_type);
+    ASSERT_EQ(offsetof(struct kvs_rparams, cn_get_aio_depth), ps->ps_offset);
+    ASSERT_EQ(sizeof(uint32_t), ps->ps_size);
+    ASSERT_EQ((uintptr_t)ps->ps_convert, (uintptr_t)param_default_converter);
+    ASSERT_EQ((uintptr_t)ps->ps_validate, (uintptr_t)param_default_validator);
+    ASSERT_EQ((uintptr_t)ps->ps_stringify, (uintptr_t)param_default_stringify);
+    ASSERT_EQ((uintptr_t)ps->ps_jsonify, (uintptr_t)param_default_jsonify);
+    ASSERT_EQ(32, params.cn_get_aio_depth);
+    ASSERT_EQ(0, ps->ps_bounds.as_uscalar.ps_min);
+    ASSERT_EQ(1024, ps->ps_bounds.as_uscalar.ps_max);
+}
+
+MTF_DEFINE_UTEST_PRE(kvs_rparams_test, cn_rcache_size_mb, test_pre)
+{
+    const struct param_spec *ps = ps_get("cn_rcache_size_mb");
+
+    ASSERT_NE(NULL, ps);
+    ASSERT_NE(NULL, ps->ps_description);
+    ASSERT_EQ(PARAM_FLAG_EXPERIMENTAL, ps->ps_flags);
+    ASSERT_EQ(PARAM_TYPE_U32, ps->ps_type);
+    ASSERT_EQ(offsetof(struct kvs_rparams, cn_rcache_size_mb), ps->ps_offset);
+    ASSERT_EQ(sizeof(uint32_t), ps->ps_size);
+    ASSERT_EQ((uintptr_t)ps->ps_convert, (uintptr_t)param_default_converter);
+    ASSERT_EQ((uintptr_t)ps->ps_validate, (uintptr_t)param_default_validator);
+    ASSERT_EQ((uintptr_t)ps->ps_stringify, (uintptr_t)param_default_stringify);
+    ASSERT_EQ((uintptr_t)ps->ps_jsonify, (uintptr_t)param_default_jsonify);
+    ASSERT_EQ(0, params.cn_rcache_size_mb);
+    ASSERT_EQ(0, ps->ps_bounds.as_uscalar.ps_min);
+    ASSERT_EQ(64 * 1024, ps->ps_bounds.as_uscalar.ps_max);
+}
+
 MTF_DEFINE_UTEST_PRE(kvs_rparams_test, cn_mcache_kra_params, test_pre)
 {
     const struct param_spec *ps = ps_get("cn_mcache_kra_params");
@@ -493,6 +531,23 @@ MTF_DEFINE_UTEST_PRE(kvs_rparams_test, cn_bloom_preload, test_pre)
     ASSERT_FALSE(params.cn_bloom_preload);
 }
 
+MTF_DEFINE_UTEST_PRE(kvs_rparams_test, cn_mcache_lazy, test_pre)
+{
+    const struct param_spec *ps = ps_get("cn_mcache_lazy");
+
+    ASSERT_NE(NULL, ps);
+    ASSERT_NE(NULL, ps->ps_description);
+    ASSERT_EQ(PARAM_FLAG_EXPERIMENTAL, ps->ps_flags);
+    ASSERT_EQ(PARAM_TYPE_BOOL, ps->ps_type);
+    ASSERT_EQ(offsetof(struct kvs_rparams, cn_mcache_lazy), ps->ps_offset);
+    ASSERT_EQ(sizeof(bool), ps->ps_size);
+    ASSERT_EQ((uintptr_t)ps->ps_convert, (uintptr_t)param_default_converter);
+    ASSERT_EQ((uintptr_t)ps->ps_validate, (uintptr_t)param_default_validator);
+    ASSERT_EQ((uintptr_t)ps->ps_stringify, (uintptr_t)param_default_stringify);
+    ASSERT_EQ((uintptr_t)ps->ps_jsonify, (uintptr_t)param_default_jsonify);
+    ASSERT_FALSE(params.cn_mcache_lazy);
+}
+
 MTF_DEFINE_UTEST_PRE(kvs_rparams_test, cn_bloom_prob, test_pre)
 {
     const struct param_spec *ps = ps_get("cn_bloom_prob");
@@ -531,6 +586,134 @@ MTF_DEFINE_UTEST_PRE(kvs_rparams_test, cn_bloom_capped, test_pre)
     ASSERT_EQ(UINT64_MAX, ps->ps_bounds.as_uscalar.ps_max);
 }
 
+MTF_DEFINE_UTEST_PRE(kvs_rparams_test, cn_bloom_prob_root, test_pre)
+{
+    const struct param_spec *ps = ps_get("cn_bloom_prob_root");
+
+    ASSERT_NE(NULL, ps);
+    ASSERT_NE(NULL, ps->ps_description);
+    ASSERT_EQ(PARAM_FLAG_EXPERIMENTAL, ps->ps_flags);
+    ASSERT_EQ(PARAM_TYPE_U64, ps->ps_type);
+    ASSERT_EQ(offsetof(struct kvs_rparams, cn_bloom_prob_root), ps->ps_offset);
+    ASSERT_EQ(sizeof(uint64_t), ps->ps_size);
+    ASSERT_EQ((uintptr_t)ps->ps_convert, (uintptr_t)param_default_converter);
+    ASSERT_EQ((uintptr_t)ps->ps_validate, (uintptr_t)param_default_validator);
+    ASSERT_EQ((uintptr_t)ps->ps_stringify, (uintptr_t)param_default_stringify);
+    ASSERT_EQ((uintptr_t)ps->ps_jsonify, (uintptr_t)param_default_jsonify);
+    ASSERT_EQ(0, params.cn_bloom_prob_root);
+    ASSERT_EQ(0, ps->ps_bounds.as_uscalar.ps_min);
+    ASSERT_EQ(UINT64_MAX, ps->ps_bounds.as_uscalar.ps_max);
+}
+
+MTF_DEFINE_UTEST_PRE(kvs_rparams_test, cn_bloom_prob_leaf, test_pre)
+{
+    const struct param_spec *ps = ps_get("cn_bloom_prob_leaf");
+
+    ASSERT_NE(NULL, ps);
+    ASSERT_NE(NULL, ps->ps_description);
+    ASSERT_EQ(PARAM_FLAG_EXPERIMENTAL, ps->ps_flags);
+    ASSERT_EQ(PARAM_TYPE_U64, ps->ps_type);
+    ASSERT_EQ(offsetof(struct kvs_rparams, cn_bloom_prob_leaf), ps->ps_offset);
+    ASSERT_EQ(sizeof(uint64_t), ps->ps_size);
+    ASSERT_EQ((uintptr_t)ps->ps_convert, (uintptr_t)param_default_converter);
+    ASSERT_EQ((uintptr_t)ps->ps_validate, (uintptr_t)param_default_validator);
+    ASSERT_EQ((uintptr_t)ps->ps_stringify, (uintptr_t)param_default_stringify);
+    ASSERT_EQ((uintptr_t)ps->ps_jsonify, (uintptr_t)param_default_jsonify);
+    ASSERT_EQ(0, params.cn_bloom_prob_leaf);
+    ASSERT_EQ(0, ps->ps_bounds.as_uscalar.ps_min);
+    ASSERT_EQ(UINT64_MAX, ps->ps_bounds.as_uscalar.ps_max);
+}
+
+MTF_DEFINE_UTEST_PRE(kvs_rparams_test, cn_bloom_auto, test_pre)
+{
+    const struct param_spec *ps = ps_get("cn_bloom_auto");
+
+    ASSERT_NE(NULL, ps);
+    ASSERT_NE(NULL, ps->ps_description);
+    ASSERT_EQ(PARAM_FLAG_EXPERIMENTAL, ps->ps_flags);
+    ASSERT_EQ(PARAM_TYPE_BOOL, ps->ps_type);
+    ASSERT_EQ(offsetof(struct kvs_rparams, cn_bloom_auto), ps->ps_offset);
+    ASSERT_EQ(sizeof(bool), ps->ps_size);
+    ASSERT_EQ((uintptr_t)ps->ps_convert, (uintptr_t)param_default_converter);
+    ASSERT_EQ((uintptr_t)ps->ps_validate, (uintptr_t)param_default_validator);
+    ASSERT_EQ((uintptr_t)ps->ps_stringify, (uintptr_t)param_default_stringify);
+    ASSERT_EQ((uintptr_t)ps->ps_jsonify, (uintptr_t)param_default_jsonify);
+    ASSERT_FALSE(params.cn_bloom_auto);
+}
+
+MTF_DEFINE_UTEST_PRE(kvs_rparams_test, cn_bloom_type, test_pre)
+{
+    merr_t                   err;
+    char                     buf[128];
+    size_t                   needed_sz;
+    const struct param_spec *ps = ps_get("cn_bloom_type");
+
+    ASSERT_NE(NULL, ps);
+    ASSERT_NE(NULL, ps->ps_description);
+    ASSERT_EQ(PARAM_FLAG_EXPERIMENTAL, ps->ps_flags);
+    ASSERT_EQ(PARAM_TYPE_ENUM, ps->ps_type);
+    ASSERT_EQ(offsetof(struct kvs_rparams, cn_bloom_type), ps->ps_offset);
+    ASSERT_EQ(sizeof(enum cn_bloom_type), ps->ps_size);
+    ASSERT_NE((uintptr_t)ps->ps_convert, (uintptr_t)param_default_converter);
+    ASSERT_EQ((uintptr_t)ps->ps_validate, (uintptr_t)param_default_validator);
+    ASSERT_NE((uintptr_t)ps->ps_stringify, (uintptr_t)param_default_stringify);
+    ASSERT_NE((uintptr_t)ps->ps_jsonify, (uintptr_t)param_default_jsonify);
+    ASSERT_EQ(CN_BLOOM_TYPE_BLOCKED, params.cn_bloom_type);
+    ASSERT_EQ(CN_BLOOM_TYPE_MIN, ps->ps_bounds.as_uscalar.ps_min);
+    ASSERT_EQ(CN_BLOOM_TYPE_MAX, ps->ps_bounds.as_uscalar.ps_max);
+
+    ps->ps_stringify(ps, &params.cn_bloom_type, buf, sizeof(buf), &needed_sz);
+    ASSERT_STREQ("\"blocked\"", buf);
+    ASSERT_EQ(9, needed_sz);
+
+    /* clang-format off */
+    err = check(
+        "cn_bloom_type=blocked", true,
+        "cn_bloom_type=fuse", true,
+        "cn_bloom_type=xor", false,
+        NULL
+    );
+    /* clang-format on */
+
+    ASSERT_EQ(0, merr_errno(err));
+}
+
+MTF_DEFINE_UTEST_PRE(kvs_rparams_test, cn_bloom_pfx, test_pre)
+{
+    const struct param_spec *ps = ps_get("cn_bloom_pfx");
+
+    ASSERT_NE(NULL, ps);
+    ASSERT_NE(NULL, ps->ps_description);
+    ASSERT_EQ(PARAM_FLAG_EXPERIMENTAL, ps->ps_flags);
+    ASSERT_EQ(PARAM_TYPE_BOOL, ps->ps_type);
+    ASSERT_EQ(offsetof(struct kvs_rparams, cn_bloom_pfx), ps->ps_offset);
+    ASSERT_EQ(sizeof(bool), ps->ps_size);
+    ASSERT_EQ((uintptr_t)ps->ps_convert, (uintptr_t)param_default_converter);
+    ASSERT_EQ((uintptr_t)ps->ps_validate, (uintptr_t)param_default_validator);
+    ASSERT_EQ((uintptr_t)ps->ps_stringify, (uintptr_t)param_default_stringify);
+    ASSERT_EQ((uintptr_t)ps->ps_jsonify, (uintptr_t)param_default_jsonify);
+    ASSERT_FALSE(params.cn_bloom_pfx);
+}
+
+MTF_DEFINE_UTEST_PRE(kvs_rparams_test, cn_bloom_pfx_len, test_pre)
+{
+    const struct param_spec *ps = ps_get("cn_bloom_pfx_len");
+
+    ASSERT_NE(NULL, ps);
+    ASSERT_NE(NULL, ps->ps_description);
+    ASSERT_EQ(PARAM_FLAG_EXPERIMENTAL, ps->ps_flags);
+    ASSERT_EQ(PARAM_TYPE_U32, ps->ps_type);
+    ASSERT_EQ(offsetof(struct kvs_rparams, cn_bloom_pfx_len), ps->ps_offset);
+    ASSERT_EQ(sizeof(uint32_t), ps->ps_size);
+    ASSERT_EQ((uintptr_t)ps->ps_convert, (uintptr_t)param_default_converter);
+    ASSERT_EQ((uintptr_t)ps->ps_validate, (uintptr_t)param_default_validator);
+    ASSERT_EQ((uintptr_t)ps->ps_stringify, (uintptr_t)param_default_stringify);
+    ASSERT_EQ((uintptr_t)ps->ps_jsonify, (uintptr_t)param_default_jsonify);
+    ASSERT_EQ(0, params.cn_bloom_pfx_len);
+    ASSERT_EQ(0, ps->ps_bounds.as_uscalar.ps_min);
+    ASSERT_EQ(HSE_KVS_PFX_LEN_MAX, ps->ps_bounds.as_uscalar.ps_max);
+}
+
 MTF_DEFINE_UTEST_PRE(kvs_rparams_test, cn_compaction_debug, test_pre)
 {
     const struct param_spec *ps = ps_get("cn_compaction_debug");
@@ -679,6 +862,154 @@ MTF_DEFINE_UTEST_PRE(kvs_rparams_test, value_compression_default, test_pre)
     ASSERT_EQ(0, merr_errno(err));
 }
 
+MTF_DEFINE_UTEST_PRE(kvs_rparams_test, value_compression_algorithm, test_pre)
+{
+    merr_t                   err;
+    char                     buf[128];
+    size_t                   needed_sz;
+    const struct param_spec *ps = ps_get("value.compression.algorithm");
+
+    ASSERT_NE(NULL, ps);
+    ASSERT_NE(NULL, ps->ps_description);
+    ASSERT_EQ(0, ps->ps_flags);
+    ASSERT_EQ(PARAM_TYPE_ENUM, ps->ps_type);
+    ASSERT_EQ(offsetof(struct kvs_rparams, value.compression.algo), ps->ps_offset);
+    ASSERT_EQ(sizeof(enum vcomp_algorithm), ps->ps_size);
+    ASSERT_NE((uintptr_t)ps->ps_convert, (uintptr_t)param_default_converter);
+    ASSERT_EQ((uintptr_t)ps->ps_validate, (uintptr_t)param_default_validator);
+    ASSERT_NE((uintptr_t)ps->ps_stringify, (uintptr_t)param_default_stringify);
+    ASSERT_NE((uintptr_t)ps->ps_jsonify, (uintptr_t)param_default_jsonify);
+    ASSERT_EQ(VCOMP_ALGO_LZ4, params.value.compression.algo);
+    ASSERT_EQ(VCOMP_ALGO_MIN, ps->ps_bounds.as_uscalar.ps_min);
+    ASSERT_EQ(VCOMP_ALGO_MAX, ps->ps_bounds.as_uscalar.ps_max);
+
+    ps->ps_stringify(ps, &params.value.compression.algo, buf, sizeof(buf), &needed_sz);
+    ASSERT_STREQ("\"lz4\"", buf);
+    ASSERT_EQ(5, needed_sz);
+
+    /* clang-format off */
+    err = check(
+        "value.compression.algorithm=lz4", true,
+        "value.compression.algorithm=zstd", true,
+        "value.compression.algorithm=does-not-exist", false,
+        NULL
+    );
+    /* clang-format on */
+
+    ASSERT_EQ(0, merr_errno(err));
+}
+
+MTF_DEFINE_UTEST_PRE(kvs_rparams_test, value_compression_level, test_pre)
+{
+    const struct param_spec *ps = ps_get("value.compression.level");
+
+    ASSERT_NE(NULL, ps);
+    ASSERT_NE(NULL, ps->ps_description);
+    ASSERT_EQ(0, ps->ps_flags);
+    ASSERT_EQ(PARAM_TYPE_I32, ps->ps_type);
+    ASSERT_EQ(offsetof(struct kvs_rparams, value.compression.level), ps->ps_offset);
+    ASSERT_EQ(sizeof(int32_t), ps->ps_size);
+    ASSERT_EQ((uintptr_t)ps->ps_convert, (uintptr_t)param_default_converter);
+    ASSERT_EQ((uintptr_t)ps->ps_validate, (uintptr_t)param_default_validator);
+    ASSERT_EQ((uintptr_t)ps->ps_stringify, (uintptr_t)param_default_stringify);
+    ASSERT_EQ((uintptr_t)ps->ps_jsonify, (uintptr_t)param_default_jsonify);
+    ASSERT_EQ(3, params.value.compression.level);
+    ASSERT_EQ(-7, ps->ps_bounds.as_scalar.ps_min);
+    ASSERT_EQ(19, ps->ps_bounds.as_scalar.ps_max);
+}
+
+MTF_DEFINE_UTEST_PRE(kvs_rparams_test, value_compression_dict_size, test_pre)
+{
+    const struct param_spec *ps = ps_get("value.compression.dict_size");
+
+    ASSERT_NE(NULL, ps);
+    ASSERT_NE(NULL, ps->ps_description);
+    ASSERT_EQ(PARAM_FLAG_EXPERIMENTAL, ps->ps_flags);
+    ASSERT_EQ(PARAM_TYPE_U32, ps->ps_type);
+    ASSERT_EQ(offsetof(struct kvs_rparams, value.compression.dict_size), ps->ps_offset);
+    ASSERT_EQ(sizeof(uint32_t), ps->ps_size);
+    ASSERT_EQ((uintptr_t)ps->ps_convert, (uintptr_t)param_default_converter);
+    ASSERT_EQ((uintptr_t)ps->ps_validate, (uintptr_t)param_default_validator);
+    ASSERT_EQ((uintptr_t)ps->ps_stringify, (uintptr_t)param_default_stringify);
+    ASSERT_EQ((uintptr_t)ps->ps_jsonify, (uintptr_t)param_default_jsonify);
+    ASSERT_EQ(0, params.value.compression.dict_size);
+    ASSERT_EQ(0, ps->ps_bounds.as_uscalar.ps_min);
+    ASSERT_EQ(1024 * 1024, ps->ps_bounds.as_uscalar.ps_max);
+}
+
+MTF_DEFINE_UTEST_PRE(kvs_rparams_test, value_compression_compact, test_pre)
+{
+    merr_t                   err;
+    char                     buf[128];
+    size_t                   needed_sz;
+    const struct param_spec *ps = ps_get("value.compression.compact");
+
+    ASSERT_NE(NULL, ps);
+    ASSERT_NE(NULL, ps->ps_description);
+    ASSERT_EQ(0, ps->ps_flags);
+    ASSERT_EQ(PARAM_TYPE_ENUM, ps->ps_type);
+    ASSERT_EQ(offsetof(struct kvs_rparams, value.compression.compact), ps->ps_offset);
+    ASSERT_EQ(sizeof(enum vcomp_default), ps->ps_size);
+    ASSERT_NE((uintptr_t)ps->ps_convert, (uintptr_t)param_default_converter);
+    ASSERT_EQ((uintptr_t)ps->ps_validate, (uintptr_t)param_default_validator);
+    ASSERT_NE((uintptr_t)ps->ps_stringify, (uintptr_t)param_default_stringify);
+    ASSERT_NE((uintptr_t)ps->ps_jsonify, (uintptr_t)param_default_jsonify);
+    ASSERT_EQ(VCOMP_DEFAULT_OFF, params.value.compression.compact);
+    ASSERT_EQ(VCOMP_DEFAULT_MIN, ps->ps_bounds.as_uscalar.ps_min);
+    ASSERT_EQ(VCOMP_DEFAULT_MAX, ps->ps_bounds.as_uscalar.ps_max);
+
+    ps->ps_stringify(ps, &params.value.compression.compact, buf, sizeof(buf), &needed_sz);
+    ASSERT_STREQ("\"off\"", buf);
+    ASSERT_EQ(5, needed_sz);
+
+    /* clang-format off */
+    err = check(
+        "value.compression.compact=off", true,
+        "value.compression.compact=on", true,
+        "value.compression.compact=zstd", false,
+        NULL
+    );
+    /* clang-format on */
+
+    ASSERT_EQ(0, merr_errno(err));
+}
+
+MTF_DEFINE_UTEST_PRE(kvs_rparams_test, value_compression_compact_level, test_pre)
+{
+    const struct param_spec *ps = ps_get("value.compression.compact_level");
+
+    ASSERT_NE(NULL, ps);
+    ASSERT_NE(NULL, ps->ps_description);
+    ASSERT_EQ(0, ps->ps_flags);
+    ASSERT_EQ(PARAM_TYPE_I32, ps->ps_type);
+    ASSERT_EQ(offsetof(struct kvs_rparams, value.compression.compact_level), ps->ps_offset);
+    ASSERT_EQ(sizeof(int32_t), ps->ps_size);
+    ASSERT_EQ((uintptr_t)ps->ps_convert, (uintptr_t)param_default_converter);
+    ASSERT_EQ((uintptr_t)ps->ps_validate, (uintptr_t)param_default_validator);
+    ASSERT_EQ((uintptr_t)ps->ps_stringify, (uintptr_t)param_default_stringify);
+    ASSERT_EQ((uintptr_t)ps->ps_jsonify, (uintptr_t)param_default_jsonify);
+    ASSERT_EQ(9, params.value.compression.compact_level);
+    ASSERT_EQ(-7, ps->ps_bounds.as_scalar.ps_min);
+    ASSERT_EQ(19, ps->ps_bounds.as_scalar.ps_max);
+}
+
+MTF_DEFINE_UTEST_PRE(kvs_rparams_test, value_compression_deferred, test_pre)
+{
+    const struct param_spec *ps = ps_get("value.compression.deferred");
+
+    ASSERT_NE(NULL, ps);
+    ASSERT_NE(NULL, ps->ps_description);
+    ASSERT_EQ(0, ps->ps_flags);
+    ASSERT_EQ(PARAM_TYPE_BOOL, ps->ps_type);
+    ASSERT_EQ(offsetof(struct kvs_rparams, value.compression.deferred), ps->ps_offset);
+    ASSERT_EQ(sizeof(bool), ps->ps_size);
+    ASSERT_EQ((uintptr_t)ps->ps_convert, (uintptr_t)param_default_converter);
+    ASSERT_EQ((uintptr_t)ps->ps_validate, (uintptr_t)param_default_validator);
+    ASSERT_EQ((uintptr_t)ps->ps_stringify, (uintptr_t)param_default_stringify);
+    ASSERT_EQ((uintptr_t)ps->ps_jsonify, (uintptr_t)param_default_jsonify);
+    ASSERT_EQ(false, params.value.compression.deferred);
+}
+
 MTF_DEFINE_UTEST(kvs_rparams_test, get)
 {
     merr_t err;
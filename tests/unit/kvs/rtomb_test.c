@@ -0,0 +1,102 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <mtf/framework.h>
+
+#include <hse/ikvdb/rtomb.h>
+
+MTF_BEGIN_UTEST_COLLECTION(rtomb_test)
+
+static struct rtomb *
+mk(const char *start, const char *end, uint64_t seqno)
+{
+    return rtomb_alloc(start, strlen(start), end, strlen(end), seqno);
+}
+
+MTF_DEFINE_UTEST(rtomb_test, covers)
+{
+    struct rtomb *rt = mk("b", "d", 10);
+
+    ASSERT_NE(NULL, rt);
+    ASSERT_EQ(10, rt->rt_seqno);
+    ASSERT_EQ(0, memcmp(rtomb_start(rt), "b", 1));
+    ASSERT_EQ(0, memcmp(rtomb_end(rt), "d", 1));
+
+    ASSERT_FALSE(rtomb_covers(rt, "a", 1));
+    ASSERT_TRUE(rtomb_covers(rt, "b", 1));
+    ASSERT_TRUE(rtomb_covers(rt, "bzzz", 4));
+    ASSERT_TRUE(rtomb_covers(rt, "c", 1));
+    ASSERT_FALSE(rtomb_covers(rt, "d", 1));
+    ASSERT_FALSE(rtomb_covers(rt, "da", 2));
+
+    free(rt);
+}
+
+MTF_DEFINE_UTEST(rtomb_test, overlaps)
+{
+    struct rtomb *rt = mk("c", "f", 10);
+
+    ASSERT_NE(NULL, rt);
+
+    ASSERT_TRUE(rtomb_overlaps(rt, NULL, 0, NULL, 0));
+    ASSERT_TRUE(rtomb_overlaps(rt, "a", 1, "c", 1));
+    ASSERT_TRUE(rtomb_overlaps(rt, "e", 1, "z", 1));
+    ASSERT_TRUE(rtomb_overlaps(rt, "d", 1, "e", 1));
+    ASSERT_FALSE(rtomb_overlaps(rt, "a", 1, "b", 1));
+    ASSERT_FALSE(rtomb_overlaps(rt, "f", 1, "z", 1));
+    ASSERT_FALSE(rtomb_overlaps(rt, NULL, 0, "bz", 2));
+    ASSERT_FALSE(rtomb_overlaps(rt, "f", 1, NULL, 0));
+
+    free(rt);
+}
+
+MTF_DEFINE_UTEST(rtomb_test, vec_lookup)
+{
+    struct rtomb_vec rv = { 0 };
+    merr_t err;
+    int i;
+
+    ASSERT_EQ(0, rtomb_vec_lookup(NULL, "a", 1, UINT64_MAX));
+    ASSERT_EQ(0, rtomb_vec_lookup(&rv, "a", 1, UINT64_MAX));
+
+    err = rtomb_vec_add(&rv, mk("a", "m", 10));
+    ASSERT_EQ(0, err);
+    err = rtomb_vec_add(&rv, mk("k", "z", 20));
+    ASSERT_EQ(0, err);
+
+    /* Grow the vector beyond its initial capacity. */
+    for (i = 0; i < 20; i++) {
+        err = rtomb_vec_add(&rv, mk("x", "y", 5));
+        ASSERT_EQ(0, err);
+    }
+
+    ASSERT_EQ(22, rv.rv_cnt);
+    ASSERT_GE(rv.rv_max, rv.rv_cnt);
+
+    ASSERT_EQ(10, rtomb_vec_lookup(&rv, "b", 1, UINT64_MAX));
+    ASSERT_EQ(20, rtomb_vec_lookup(&rv, "l", 1, UINT64_MAX));
+    ASSERT_EQ(20, rtomb_vec_lookup(&rv, "x", 1, UINT64_MAX));
+    ASSERT_EQ(0, rtomb_vec_lookup(&rv, "z", 1, UINT64_MAX));
+
+    /* Rtombs newer than the view are not visible. */
+    ASSERT_EQ(10, rtomb_vec_lookup(&rv, "l", 1, 15));
+    ASSERT_EQ(0, rtomb_vec_lookup(&rv, "n", 1, 15));
+    ASSERT_EQ(5, rtomb_vec_lookup(&rv, "x", 1, 9));
+    ASSERT_EQ(0, rtomb_vec_lookup(&rv, "b", 1, 9));
+
+    rtomb_vec_reset(&rv);
+    ASSERT_EQ(0, rv.rv_cnt);
+    ASSERT_EQ(0, rtomb_vec_lookup(&rv, "b", 1, UINT64_MAX));
+
+    rv.rv_cnt = 22;
+    rtomb_vec_fini(&rv, true);
+    ASSERT_EQ(0, rv.rv_cnt);
+    ASSERT_EQ(NULL, rv.rv_v);
+}
+
+MTF_END_UTEST_COLLECTION(rtomb_test)
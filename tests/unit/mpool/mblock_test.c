@@ -8,6 +8,7 @@
 #include <support/random_buffer.h>
 
 #include <hse/error/merr.h>
+#include <hse/util/base.h>
 #include <hse/util/minmax.h>
 #include <hse/util/page.h>
 
@@ -617,8 +618,8 @@ MTF_DEFINE_UTEST_PREPOST(mblock_test, mblock_invalid_args, mpool_test_pre, mpool
     err = mblock_fset_commit(mbfsp, &bad_mbid, 1);
     ASSERT_EQ(EINVAL, merr_errno(err));
 
-    err = mblock_fset_commit(mbfsp, &mbid, 2);
-    ASSERT_EQ(ENOTSUP, merr_errno(err));
+    err = mblock_fset_commit(mbfsp, &mbid, 0);
+    ASSERT_EQ(EINVAL, merr_errno(err));
 
     err = mblock_fset_delete(NULL, &mbid, 1);
     ASSERT_EQ(EINVAL, merr_errno(err));
@@ -629,8 +630,8 @@ MTF_DEFINE_UTEST_PREPOST(mblock_test, mblock_invalid_args, mpool_test_pre, mpool
     err = mblock_fset_delete(mbfsp, &bad_mbid, 1);
     ASSERT_EQ(EINVAL, merr_errno(err));
 
-    err = mblock_fset_delete(mbfsp, &mbid, 2);
-    ASSERT_EQ(ENOTSUP, merr_errno(err));
+    err = mblock_fset_delete(mbfsp, &mbid, 0);
+    ASSERT_EQ(EINVAL, merr_errno(err));
 
     err = mblock_fset_find(NULL, &mbid, 1, NULL);
     ASSERT_EQ(EINVAL, merr_errno(err));
@@ -695,8 +696,8 @@ MTF_DEFINE_UTEST_PREPOST(mblock_test, mblock_invalid_args, mpool_test_pre, mpool
     err = mblock_file_commit(mbfp, NULL, 1);
     ASSERT_EQ(EINVAL, merr_errno(err));
 
-    err = mblock_file_commit(mbfp, &mbid, 2);
-    ASSERT_EQ(ENOTSUP, merr_errno(err));
+    err = mblock_file_commit(mbfp, &mbid, 0);
+    ASSERT_EQ(EINVAL, merr_errno(err));
 
     err = mblock_file_delete(NULL, &mbid, 1);
     ASSERT_EQ(EINVAL, merr_errno(err));
@@ -704,8 +705,8 @@ MTF_DEFINE_UTEST_PREPOST(mblock_test, mblock_invalid_args, mpool_test_pre, mpool
     err = mblock_file_delete(mbfp, NULL, 1);
     ASSERT_EQ(EINVAL, merr_errno(err));
 
-    err = mblock_file_delete(mbfp, &mbid, 2);
-    ASSERT_EQ(ENOTSUP, merr_errno(err));
+    err = mblock_file_delete(mbfp, &mbid, 0);
+    ASSERT_EQ(EINVAL, merr_errno(err));
 
     err = mblock_read(NULL, mbid, iov, 1, 0);
     ASSERT_EQ(EINVAL, merr_errno(err));
@@ -728,6 +729,144 @@ MTF_DEFINE_UTEST_PREPOST(mblock_test, mblock_invalid_args, mpool_test_pre, mpool
     mpool_destroy(mtf_kvdb_home, &tdparams);
 }
 
+MTF_DEFINE_UTEST_PREPOST(mblock_test, mblock_vector, mpool_test_pre, mpool_test_post)
+{
+    struct mpool       *mp;
+    struct mblock_props props;
+    struct mpool_info   info = {};
+    uint64_t            mbidv[48], delv[48], bpalloc, apalloc;
+    merr_t              err;
+    int                 i, mbidc = NELEM(mbidv);
+
+    err = mpool_create(mtf_kvdb_home, &tcparams);
+    ASSERT_EQ(0, err);
+
+    err = mpool_open(mtf_kvdb_home, &trparams, O_RDWR, &mp);
+    ASSERT_EQ(0, err);
+
+    err = mpool_info_get(mp, &info);
+    ASSERT_EQ(0, err);
+    bpalloc = allocated_bytes_summation(&info);
+
+    /* Allocations are spread across the files in the file set, so the
+     * vector exercises the grouping of mblocks by file.
+     */
+    for (i = 0; i < mbidc; i++) {
+        err = mpool_mblock_alloc(mp, HSE_MCLASS_CAPACITY, MPOOL_MBLOCK_PREALLOC, &mbidv[i], NULL);
+        ASSERT_EQ(0, err);
+    }
+
+    err = mpool_mblock_commitv(NULL, mbidv, mbidc);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    err = mpool_mblock_commitv(mp, mbidv, 0);
+    ASSERT_EQ(0, err);
+
+    err = mpool_mblock_commitv(mp, mbidv, mbidc);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; i < mbidc; i++) {
+        err = mpool_mblock_props_get(mp, mbidv[i], &props);
+        ASSERT_EQ(0, err);
+        ASSERT_EQ(mbidv[i], props.mpr_objid);
+    }
+
+    /* Committing an already committed mblock fails.
+     */
+    err = mpool_mblock_commitv(mp, mbidv + 1, 1);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    /* Delete the even numbered mblocks, then the odd numbered ones in
+     * a vector with zeroed holes, which deletev ignores.
+     */
+    for (i = 0; i < mbidc; i++)
+        delv[i] = (i % 2) ? 0 : mbidv[i];
+
+    err = mpool_mblock_deletev(mp, delv, mbidc);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; i < mbidc; i++) {
+        err = mpool_mblock_props_get(mp, mbidv[i], &props);
+        ASSERT_EQ((i % 2) ? 0 : ENOENT, merr_errno(err));
+    }
+
+    for (i = 0; i < mbidc; i++)
+        delv[i] = (i % 2) ? mbidv[i] : 0;
+
+    err = mpool_mblock_deletev(mp, delv, mbidc);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; i < mbidc; i++) {
+        err = mpool_mblock_props_get(mp, mbidv[i], &props);
+        ASSERT_EQ(ENOENT, merr_errno(err));
+    }
+
+    err = mpool_info_get(mp, &info);
+    ASSERT_EQ(0, err);
+    apalloc = allocated_bytes_summation(&info);
+    ASSERT_EQ(bpalloc, apalloc);
+
+    err = mpool_mblock_deletev(mp, mbidv, 1);
+    ASSERT_EQ(ENOENT, merr_errno(err));
+
+    err = mpool_close(mp);
+    ASSERT_EQ(0, err);
+
+    mpool_destroy(mtf_kvdb_home, &tdparams);
+}
+
+MTF_DEFINE_UTEST_PREPOST(mblock_test, mblock_vector_mclass, mpool_test_pre, mpool_test_post)
+{
+    struct mpool       *mp;
+    struct mblock_props props;
+    uint64_t            mbidv[16];
+    merr_t              err;
+    int                 i, mbidc = NELEM(mbidv);
+
+    setup_mclass(HSE_MCLASS_STAGING);
+
+    err = mpool_create(mtf_kvdb_home, &tcparams);
+    ASSERT_EQ(0, err);
+
+    err = mpool_open(mtf_kvdb_home, &trparams, O_RDWR, &mp);
+    ASSERT_EQ(0, err);
+
+    /* Interleave the media classes so that the vector must be grouped by
+     * media class before it is handed to the file sets.
+     */
+    for (i = 0; i < mbidc; i++) {
+        enum hse_mclass mclass = (i % 2) ? HSE_MCLASS_STAGING : HSE_MCLASS_CAPACITY;
+
+        err = mpool_mblock_alloc(mp, mclass, 0, &mbidv[i], NULL);
+        ASSERT_EQ(0, err);
+    }
+
+    err = mpool_mblock_commitv(mp, mbidv, mbidc);
+    ASSERT_EQ(0, err);
+
+    /* All are committed, and the caller's vector is left in its order.
+     */
+    for (i = 0; i < mbidc; i++) {
+        err = mpool_mblock_props_get(mp, mbidv[i], &props);
+        ASSERT_EQ(0, err);
+        ASSERT_EQ(mbidv[i], props.mpr_objid);
+        ASSERT_EQ((i % 2) ? HSE_MCLASS_STAGING : HSE_MCLASS_CAPACITY, props.mpr_mclass);
+    }
+
+    err = mpool_mblock_deletev(mp, mbidv, mbidc);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; i < mbidc; i++) {
+        err = mpool_mblock_props_get(mp, mbidv[i], &props);
+        ASSERT_EQ(ENOENT, merr_errno(err));
+    }
+
+    err = mpool_close(mp);
+    ASSERT_EQ(0, err);
+
+    mpool_destroy(mtf_kvdb_home, &tdparams);
+}
+
 MTF_DEFINE_UTEST_PREPOST(mblock_test, mblock_clone, mpool_test_pre, mpool_test_post)
 {
     struct mpool *mp;
@@ -1474,6 +1474,159 @@ bonsai_update_test(enum bonsai_alloc_mode allocm, struct mtf_test_info *lcl_ti)
     cheap = NULL;
 }
 
+struct update_mt_args {
+    struct bonsai_root *tree;
+    pthread_mutex_t    *mtx;
+    int                 tid;
+    int                 nkeys;
+    int                 nops;
+};
+
+static void *
+bonsai_update_mt_worker(void *arg)
+{
+    struct update_mt_args *args = arg;
+    merr_t err = 0;
+
+    BONSAI_RCU_REGISTER();
+
+    for (int i = 0; i < args->nops && !err; ++i) {
+        struct bonsai_skey skey;
+        struct bonsai_sval sval;
+        u64 key, value, seqno;
+
+        key = i % args->nkeys;
+        seqno = (u64)args->tid * args->nops + i + 1;
+        value = seqno;
+
+        bn_skey_init(&key, sizeof(key), 0, 0, &skey);
+        bn_sval_init(&value, sizeof(value), HSE_ORDNL_TO_SQNREF(seqno), &sval);
+
+        /* Add values to existing keys without the tree mutex, just as c0 does.
+         */
+        rcu_read_lock();
+        err = bn_update(args->tree, &skey, &sval);
+        if (err && merr_errno(err) == ENOENT) {
+            pthread_mutex_lock(args->mtx);
+            err = bn_insert_or_replace(args->tree, &skey, &sval);
+            pthread_mutex_unlock(args->mtx);
+        }
+        rcu_read_unlock();
+    }
+
+    BONSAI_RCU_UNREGISTER();
+
+    return (void *)(long)merr_errno(err);
+}
+
+/* Concurrently add many values to a small set of keys, then verify that
+ * no value was lost and that each value list is correctly ordered.
+ */
+void
+bonsai_update_mt_test(enum bonsai_alloc_mode allocm, struct mtf_test_info *lcl_ti)
+{
+    const int              NTHREADS = 8, NKEYS = 61, NOPS = 4096;
+    struct update_mt_args  args[NTHREADS];
+    pthread_t              tids[NTHREADS];
+    struct bonsai_root    *tree;
+    pthread_mutex_t        tmtx;
+    int                    rc;
+
+    init_tree(&tree, allocm);
+    pthread_mutex_init(&tmtx, NULL);
+
+    for (int i = 0; i < NTHREADS; ++i) {
+        args[i].tree = tree;
+        args[i].mtx = &tmtx;
+        args[i].tid = i;
+        args[i].nkeys = NKEYS;
+        args[i].nops = NOPS;
+
+        rc = pthread_create(&tids[i], NULL, bonsai_update_mt_worker, &args[i]);
+        ASSERT_EQ(0, rc);
+    }
+
+    for (int i = 0; i < NTHREADS; ++i) {
+        void *ret;
+
+        rc = pthread_join(tids[i], &ret);
+        ASSERT_EQ(0, rc);
+        ASSERT_EQ(NULL, ret);
+    }
+
+    rcu_read_lock();
+    for (u64 key = 0; key < NKEYS; ++key) {
+        struct bonsai_skey skey;
+        struct bonsai_kv *kv;
+        struct bonsai_val *v;
+        u64 prev = U64_MAX;
+        uint n = 0;
+        bool found;
+
+        bn_skey_init(&key, sizeof(key), 0, 0, &skey);
+
+        found = bn_find(tree, &skey, &kv);
+        ASSERT_EQ(true, found);
+
+        for (v = rcu_dereference(kv->bkv_values); v; v = rcu_dereference(v->bv_next)) {
+            u64 seqno = HSE_SQNREF_TO_ORDNL(v->bv_seqnoref);
+
+            ASSERT_LT(seqno, prev);
+            ASSERT_EQ(0, memcmp(&seqno, v->bv_value, sizeof(seqno)));
+            prev = seqno;
+            ++n;
+        }
+
+        ASSERT_EQ(n, kv->bkv_valcnt);
+        ASSERT_EQ(NTHREADS * (NOPS / NKEYS + (key < NOPS % NKEYS)), n);
+    }
+    rcu_read_unlock();
+
+    pthread_mutex_destroy(&tmtx);
+    bn_destroy(tree);
+
+    cheap_destroy(cheap);
+    cheap = NULL;
+}
+
+#define CHEAP_ALLOC_MT_ALLOCS (8192)
+
+struct cheap_alloc_mt_args {
+    struct bonsai_root *tree;
+    int                 tid;
+    void               *memv[CHEAP_ALLOC_MT_ALLOCS];
+};
+
+static size_t
+cheap_alloc_mt_size(int i)
+{
+    /* Mostly small allocations, and now and then one too large to be
+     * carved from a chunk.
+     */
+    return (i % 257 == 0) ? HSE_BT_CHUNKSZ / 4 : 8 + (i * 13) % 512;
+}
+
+static void *
+bonsai_cheap_alloc_mt_worker(void *arg)
+{
+    struct cheap_alloc_mt_args *args = arg;
+
+    for (int i = 0; i < CHEAP_ALLOC_MT_ALLOCS; ++i) {
+        size_t align = 8u << (i % 4);
+        size_t sz = cheap_alloc_mt_size(i);
+        void *mem;
+
+        mem = bn_cheap_alloc(args->tree, align, sz);
+        if (!mem || ((uintptr_t)mem & (align - 1)))
+            return (void *)(long)EINVAL;
+
+        memset(mem, args->tid, sz);
+        args->memv[i] = mem;
+    }
+
+    return NULL;
+}
+
 void
 bonsai_original_test(enum bonsai_alloc_mode allocm, struct mtf_test_info *lcl_ti)
 {
@@ -1638,6 +1791,62 @@ MTF_DEFINE_UTEST_PREPOST(bonsai_tree_test, update, no_fail_pre, no_fail_post)
     bonsai_update_test(HSE_ALLOC_CURSOR, lcl_ti);
 }
 
+MTF_DEFINE_UTEST_PREPOST(bonsai_tree_test, update_mt, no_fail_pre, no_fail_post)
+{
+    bonsai_update_mt_test(HSE_ALLOC_MALLOC, lcl_ti);
+    bonsai_update_mt_test(HSE_ALLOC_CURSOR, lcl_ti);
+}
+
+/* Allocate concurrently from the tree's cheap, then verify that no two
+ * allocations overlap.
+ */
+MTF_DEFINE_UTEST_PREPOST(bonsai_tree_test, cheap_alloc_mt, no_fail_pre, no_fail_post)
+{
+    const int                   NTHREADS = 8;
+    struct cheap_alloc_mt_args *args;
+    pthread_t                   tids[NTHREADS];
+    struct bonsai_root         *tree;
+    int                         rc;
+
+    args = calloc(NTHREADS, sizeof(*args));
+    ASSERT_NE(NULL, args);
+
+    init_tree(&tree, HSE_ALLOC_CURSOR);
+
+    for (int i = 0; i < NTHREADS; ++i) {
+        args[i].tree = tree;
+        args[i].tid = i + 1;
+
+        rc = pthread_create(&tids[i], NULL, bonsai_cheap_alloc_mt_worker, &args[i]);
+        ASSERT_EQ(0, rc);
+    }
+
+    for (int i = 0; i < NTHREADS; ++i) {
+        void *ret;
+
+        rc = pthread_join(tids[i], &ret);
+        ASSERT_EQ(0, rc);
+        ASSERT_EQ(NULL, ret);
+    }
+
+    for (int i = 0; i < NTHREADS; ++i) {
+        for (int j = 0; j < CHEAP_ALLOC_MT_ALLOCS; ++j) {
+            const u8 *mem = args[i].memv[j];
+            size_t sz = cheap_alloc_mt_size(j);
+
+            for (size_t k = 0; k < sz; ++k)
+                ASSERT_EQ(args[i].tid, mem[k]);
+        }
+    }
+
+    bn_destroy(tree);
+
+    cheap_destroy(cheap);
+    cheap = NULL;
+
+    free(args);
+}
+
 MTF_DEFINE_UTEST_PREPOST(bonsai_tree_test, original, no_fail_pre, no_fail_post)
 {
     bonsai_original_test(HSE_ALLOC_MALLOC, lcl_ti);
@@ -5,6 +5,7 @@
 
 #include <hse/util/platform.h>
 #include <hse/util/compression_lz4.h>
+#include <hse/util/compression_zstd.h>
 #include <hse/logging/logging.h>
 
 #include <mtf/framework.h>
@@ -163,5 +164,161 @@ MTF_DEFINE_UTEST(compression_test, mongo)
     free(cbuf);
 }
 
+MTF_DEFINE_UTEST(compression_test, zstd)
+{
+    size_t srcsz, cbufsz;
+    char *src, *cbuf, *dbuf;
+    uint cbuflen, dbuflen;
+    merr_t err;
+    int i;
+
+    srcsz = 128 * 1024;
+    src = malloc(srcsz);
+    ASSERT_NE(NULL, src);
+
+    dbuf = malloc(srcsz);
+    ASSERT_NE(NULL, dbuf);
+
+    cbufsz = compress_zstd_ops.cop_estimate(NULL, srcsz);
+    ASSERT_GE(cbufsz, srcsz);
+
+    cbuf = malloc(cbufsz);
+    ASSERT_NE(NULL, cbuf);
+
+    for (i = 0; i < srcsz; ++i)
+        src[i] = i / 7;
+
+    err = compress_zstd_ops.cop_compress(src, srcsz, cbuf, cbufsz, &cbuflen);
+    ASSERT_EQ(0, err);
+    ASSERT_LT(cbuflen, srcsz);
+
+    /* The output must never be mistaken for an LZ4 block.
+     */
+    ASSERT_EQ(COMPRESS_ZSTD_TAG, (uint8_t)cbuf[0]);
+
+    err = compress_zstd_ops.cop_decompress(cbuf, cbuflen, dbuf, srcsz, &dbuflen);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(srcsz, dbuflen);
+    ASSERT_EQ(0, memcmp(src, dbuf, dbuflen));
+
+    /* Check that partial decompression yields a prefix of the source.
+     */
+    for (i = 1; i < srcsz + 1; i += 4093) {
+        memset(dbuf, 0xaa, srcsz);
+
+        err = compress_zstd_ops.cop_decompress(cbuf, cbuflen, dbuf, i, &dbuflen);
+        ASSERT_EQ(0, err);
+        ASSERT_EQ(i, dbuflen);
+        ASSERT_EQ(0, memcmp(src, dbuf, i));
+    }
+
+    /* Check a few levels, including a negative (fast) level.
+     */
+    for (i = -5; i < 20; i += 6) {
+        err = compress_zstd_compress(src, srcsz, cbuf, cbufsz, &cbuflen, i, NULL);
+        ASSERT_EQ(0, err);
+
+        err = compress_zstd_ops.cop_decompress(cbuf, cbuflen, dbuf, srcsz, &dbuflen);
+        ASSERT_EQ(0, err);
+        ASSERT_EQ(srcsz, dbuflen);
+        ASSERT_EQ(0, memcmp(src, dbuf, dbuflen));
+    }
+
+    /* Truncated input must not decompress.
+     */
+    err = compress_zstd_ops.cop_decompress(cbuf, 1, dbuf, srcsz, &dbuflen);
+    ASSERT_NE(0, err);
+
+    free(cbuf);
+    free(dbuf);
+    free(src);
+}
+
+MTF_DEFINE_UTEST(compression_test, zstd_dict)
+{
+    const uint nsamples = 2000;
+    size_t *sizev, dictlen, off;
+    char *samples, *dict, *dict2;
+    char val[256], cbuf[512], dbuf[256];
+    uint cbuflen, dbuflen, vlen;
+    uint32_t id, id2;
+    ZSTD_CDict *cdict;
+    merr_t err;
+    uint i;
+
+    samples = malloc(nsamples * sizeof(val));
+    sizev = malloc(nsamples * sizeof(*sizev));
+    dict = malloc(8192);
+    dict2 = malloc(8192);
+    ASSERT_NE(NULL, samples);
+    ASSERT_NE(NULL, sizev);
+    ASSERT_NE(NULL, dict);
+    ASSERT_NE(NULL, dict2);
+
+    /* Generate json-like values that share most of their structure.
+     */
+    for (i = 0, off = 0; i < nsamples; ++i) {
+        sizev[i] = snprintf(samples + off, sizeof(val),
+                            "{\"id\": %u, \"name\": \"user%u\", \"email\": \"user%u@example.com\", "
+                            "\"status\": \"%s\", \"score\": %u}",
+                            i, i * 7, i * 13, (i % 3) ? "active" : "inactive", i % 101);
+        off += sizev[i];
+    }
+
+    err = compress_zstd_train(samples, sizev, nsamples, dict, 8192, &dictlen);
+    ASSERT_EQ(0, err);
+    ASSERT_GT(dictlen, 0);
+
+    err = compress_zstd_dict_register(dict, dictlen, &id);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(0, id);
+
+    /* Registering the same dictionary again just takes a reference,
+     * while a different dictionary with the same ID is rejected.
+     */
+    err = compress_zstd_dict_register(dict, dictlen, &id2);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(id, id2);
+
+    memcpy(dict2, dict, dictlen);
+    dict2[dictlen - 1] ^= 0xff;
+    err = compress_zstd_dict_register(dict2, dictlen, &id2);
+    ASSERT_EQ(EEXIST, merr_errno(err));
+
+    cdict = ZSTD_createCDict(dict, dictlen, 3);
+    ASSERT_NE(NULL, cdict);
+
+    vlen = snprintf(val, sizeof(val),
+                    "{\"id\": %u, \"name\": \"user%u\", \"email\": \"user%u@example.com\", "
+                    "\"status\": \"%s\", \"score\": %u}",
+                    nsamples + 1, 17, 31, "active", 42);
+
+    err = compress_zstd_compress(val, vlen, cbuf, sizeof(cbuf), &cbuflen, 3, cdict);
+    ASSERT_EQ(0, err);
+    ASSERT_LT(cbuflen, vlen / 2);
+
+    err = compress_zstd_ops.cop_decompress(cbuf, cbuflen, dbuf, sizeof(dbuf), &dbuflen);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(vlen, dbuflen);
+    ASSERT_EQ(0, memcmp(val, dbuf, vlen));
+
+    /* The dictionary remains registered until its last reference is dropped.
+     */
+    compress_zstd_dict_unregister(id);
+
+    err = compress_zstd_ops.cop_decompress(cbuf, cbuflen, dbuf, sizeof(dbuf), &dbuflen);
+    ASSERT_EQ(0, err);
+
+    compress_zstd_dict_unregister(id);
+
+    err = compress_zstd_ops.cop_decompress(cbuf, cbuflen, dbuf, sizeof(dbuf), &dbuflen);
+    ASSERT_EQ(ENOENT, merr_errno(err));
+
+    ZSTD_freeCDict(cdict);
+    free(dict2);
+    free(dict);
+    free(sizev);
+    free(samples);
+}
 
 MTF_END_UTEST_COLLECTION(compression_test)
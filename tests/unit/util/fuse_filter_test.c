@@ -0,0 +1,102 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <mtf/framework.h>
+
+#include <hse/error/merr.h>
+#include <hse/util/inttypes.h>
+#include <hse/util/hash.h>
+#include <hse/util/fuse_filter.h>
+
+MTF_BEGIN_UTEST_COLLECTION(fuse_filter_test);
+
+MTF_DEFINE_UTEST(fuse_filter_test, parameters)
+{
+    size_t sz;
+
+    ASSERT_EQ(8, fuse_fpbits_est(10000));
+    ASSERT_EQ(8, fuse_fpbits_est(1000000 / 256));
+    ASSERT_EQ(16, fuse_fpbits_est(1000));
+
+    /* Large filters approach 1.125 fingerprints per key.
+     */
+    sz = fuse_size_estimate(8, 1000000);
+    ASSERT_LT(sz, 1000000 * 115 / 100);
+    ASSERT_EQ(2 * sz, fuse_size_estimate(16, 1000000));
+
+    for (uint n = 1; n < 1000000; n *= 7) {
+        uint cap;
+
+        sz = fuse_size_estimate(8, n);
+        cap = fuse_element_estimate(8, sz);
+        ASSERT_GE(cap, n);
+        ASSERT_LE(fuse_size_estimate(8, cap), sz);
+    }
+}
+
+static void
+fuse_check(struct mtf_test_info *lcl_ti, uint fpbits, uint nkeys)
+{
+    struct fuse_filter ff;
+    u64 *hashv, *keyv;
+    void *fpv;
+    uint fp = 0;
+    size_t sz;
+    merr_t err;
+
+    hashv = malloc(sizeof(*hashv) * nkeys);
+    keyv = malloc(sizeof(*keyv) * nkeys);
+    ASSERT_NE(NULL, hashv);
+    ASSERT_NE(NULL, keyv);
+
+    for (uint i = 0; i < nkeys; ++i) {
+        keyv[i] = hse_hash64(&i, sizeof(i));
+        hashv[i] = keyv[i];
+    }
+
+    /* Duplicate hashes must not prevent construction.
+     */
+    if (nkeys > 2)
+        hashv[1] = hashv[2];
+
+    sz = fuse_size_estimate(fpbits, nkeys);
+    fpv = malloc(sz);
+    ASSERT_NE(NULL, fpv);
+
+    fuse_filter_init(&ff, fpbits, nkeys, fpv, sz);
+
+    err = fuse_filter_populate(&ff, hashv, nkeys);
+    ASSERT_EQ(0, err);
+
+    for (uint i = 0; i < nkeys; ++i) {
+        if (nkeys > 2 && i == 1)
+            continue;
+        ASSERT_TRUE(fuse_lookup(&ff, keyv[i]));
+    }
+
+    for (uint i = nkeys; i < nkeys + 100000; ++i)
+        fp += fuse_lookup(&ff, hse_hash64(&i, sizeof(i)));
+
+    /* Expect about 390 false positives for 8-bit fingerprints,
+     * and about 2 for 16-bit fingerprints.
+     */
+    ASSERT_LT(fp, (fpbits == 8) ? 600 : 20);
+
+    free(fpv);
+    free(keyv);
+    free(hashv);
+}
+
+MTF_DEFINE_UTEST(fuse_filter_test, lookup)
+{
+    static const uint nkeysv[] = { 1, 2, 3, 100, 4096, 100000 };
+
+    for (uint i = 0; i < NELEM(nkeysv); ++i) {
+        fuse_check(lcl_ti, 8, nkeysv[i]);
+        fuse_check(lcl_ti, 16, nkeysv[i]);
+    }
+}
+
+MTF_END_UTEST_COLLECTION(fuse_filter_test)
@@ -67,4 +67,42 @@ MTF_DEFINE_UTEST(keycmp_test, prefix)
     ASSERT_TRUE(rc > 0);
 }
 
+MTF_DEFINE_UTEST(keycmp_test, lcp)
+{
+    unsigned char key1[256], key2[256];
+    int pass;
+
+    for (size_t i = 0; i < sizeof(key1); i++)
+        key1[i] = key2[i] = (i * 7) & 0x7f;
+
+    /* Exercise both the default and the cpu specific long key kernels.
+     */
+    for (pass = 0; pass < 2; pass++) {
+        if (pass > 0)
+            keycmp_init();
+
+        for (size_t len = 0; len <= sizeof(key1); len++) {
+            ASSERT_EQ(len, keycmp_lcp(key1, key2, len));
+            ASSERT_EQ(0, keycmp_mem(key1, key2, len));
+
+            for (size_t pos = 0; pos < len; pos++) {
+                int rc;
+
+                key2[pos] = key1[pos] + 1;
+
+                ASSERT_EQ(pos, keycmp_lcp(key1, key2, len));
+
+                rc = keycmp_mem(key1, key2, len);
+                ASSERT_TRUE(rc < 0);
+                ASSERT_TRUE(memcmp(key1, key2, len) < 0);
+
+                rc = keycmp(key2, len, key1, len);
+                ASSERT_TRUE(rc > 0);
+
+                key2[pos] = key1[pos];
+            }
+        }
+    }
+}
+
 MTF_END_UTEST_COLLECTION(keycmp_test)
@@ -433,7 +433,8 @@ wbt_dump(struct dump_mblock *mblk)
     const struct wbt_hdr_omf *wbt = mblk->data + omf_kbh_wbt_hoff(mblk->data);
 
     switch (omf_wbt_version(wbt)) {
-    case WBT_TREE_VERSION:
+    case WBT_TREE_VERSION6:
+    case WBT_TREE_VERSION7:
         wbt_dump_impl(mblk, wbt);
         break;
     default:
@@ -468,6 +469,53 @@ bloom_bkt_cmp(const void *lhs, const void *rhs)
     return 0;
 }
 
+static void
+fuse_dump(struct dump_mblock *mblk)
+{
+    const void *p = mblk->data;
+    const struct kblock_hdr_omf *kbh = p;
+    const struct bloom_hdr_omf  *bh = p + omf_kbh_blm_hoff(kbh);
+    size_t doff, dlen, fpbytes, fpcnt, zero;
+    uint entries;
+
+    fpbytes = omf_bh_fpbits(bh) / 8;
+    entries = omf_kbh_entries(kbh);
+
+    printf(
+        "  bloom hdr: magic 0x%08x  ver %u type fuse  fpbits %u  "
+        "seglen %u  segcntlen %u  seed 0x%08x  bitmapsz %u\n",
+        omf_bh_magic(bh),
+        omf_bh_version(bh),
+        omf_bh_fpbits(bh),
+        omf_bh_seglen(bh),
+        omf_bh_modulus(bh),
+        omf_bh_seed(bh),
+        omf_bh_bitmapsz(bh));
+
+    doff = omf_kbh_blm_doff_pg(kbh) * PAGE_SIZE;
+    dlen = omf_kbh_blm_dlen_pg(kbh) * PAGE_SIZE;
+
+    if (mblk->props.mpr_write_len < doff + dlen || !fpbytes || !entries)
+        return;
+
+    fpcnt = omf_bh_bitmapsz(bh) / fpbytes;
+    if (fpcnt * fpbytes > dlen)
+        return;
+
+    /* Slots left zero are those no key was peeled to.
+     */
+    zero = 0;
+    for (size_t i = 0; i < fpcnt; ++i) {
+        const uint8_t *fp = p + doff + i * fpbytes;
+
+        zero += (fpbytes == 1) ? (fp[0] == 0) : (fp[0] == 0 && fp[1] == 0);
+    }
+
+    printf("  fuse fingerprints:   %zu\n", fpcnt);
+    printf("  fuse zero slots:     %zu\n", zero);
+    printf("  fuse bits per key:   %.2lf\n", (double)omf_bh_bitmapsz(bh) * CHAR_BIT / entries);
+}
+
 static void
 bloom_dump(struct dump_mblock *mblk)
 {
@@ -483,6 +531,11 @@ bloom_dump(struct dump_mblock *mblk)
     uint bktmax;
     uint i, j;
 
+    if (omf_bh_version(bh) > BLOOM_OMF_VERSION5 && omf_bh_type(bh) == BLOOM_OMF_FUSE) {
+        fuse_dump(mblk);
+        return;
+    }
+
     bktsz = (1u << omf_bh_bktshift(bh)) / 8;
     bitsperbkt = bktsz * CHAR_BIT;
 
@@ -651,6 +704,19 @@ kblock_dump(struct dump_mblock *mblk)
         omf_kbh_blm_dlen_pg(kbh),
         omf_bh_version(bh));
 
+    if (omf_kbh_version(kbh) >= KBLOCK_HDR_VERSION7 && omf_kbh_pblm_pfxlen(kbh)) {
+        const struct bloom_hdr_omf *pbh = p + omf_kbh_pblm_hoff(kbh);
+
+        printf("  pfx bloom: hdr %d %d  data_pg %d %d  ver %u  type %u  pfxlen %u\n",
+            omf_kbh_pblm_hoff(kbh),
+            omf_kbh_pblm_hlen(kbh),
+            omf_kbh_pblm_doff_pg(kbh),
+            omf_kbh_pblm_dlen_pg(kbh),
+            omf_bh_version(pbh),
+            omf_bh_type(pbh),
+            omf_kbh_pblm_pfxlen(kbh));
+    }
+
     printf("  kmd: start_pg %u\n",
         omf_kbh_wbt_doff_pg(kbh) + omf_wbt_root(wbt) + 1);
 
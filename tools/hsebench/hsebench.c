@@ -0,0 +1,1265 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ *
+ * hsebench is a multi-threaded benchmark of the engine's primitives (put, get, cursor
+ * seek/read, txn commit and kvdb sync) driven by a script of workload phases.  Each phase is
+ * a weighted mix of operations over a key distribution, run for a fixed time or number of
+ * operations.  Presets match the core YCSB workloads A-F.  For each phase and operation,
+ * hsebench reports throughput and latency percentiles from HDR histograms, optionally as JSON
+ * for regression tracking.
+ *
+ * Keys are the big-endian record number, preceded by a fixed filler if the key length is
+ * larger than eight bytes, such that records sort in numerical order.
+ */
+
+#include <endian.h>
+#include <errno.h>
+#include <getopt.h>
+#include <libgen.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <cjson/cJSON.h>
+#include <hdr/hdr_histogram.h>
+
+#include <hse/hse.h>
+#include <hse/version.h>
+
+#include <hse/util/arch.h>
+#include <hse/util/atomic.h>
+#include <hse/util/base.h>
+#include <hse/util/compiler.h>
+#include <hse/util/hash.h>
+#include <hse/util/inttypes.h>
+#include <hse/util/xrand.h>
+
+#include <hse/cli/param.h>
+
+#include <tools/common.h>
+#include <tools/parm_groups.h>
+
+#define KLEN_MIN        (8)
+#define KLEN_MAX        (64)
+#define SCANLEN_MAX     (10000)
+#define TXNLEN_MAX      (64)
+#define ZIPF_THETA      (0.99)
+
+/* Latencies are recorded in nanoseconds, up to 100 seconds, with three significant figures.
+ */
+#define LAT_MIN         (1)
+#define LAT_MAX         (100UL * 1000 * 1000 * 1000)
+#define LAT_SIGFIGS     (3)
+
+enum op {
+    OP_READ,
+    OP_UPDATE,
+    OP_INSERT,
+    OP_SCAN,
+    OP_RMW,
+    OP_DELETE,
+    OP_TXN,
+    OP_SYNC,
+    OP_CNT
+};
+
+static const char *const op_names[] = {
+    [OP_READ] = "read",
+    [OP_UPDATE] = "update",
+    [OP_INSERT] = "insert",
+    [OP_SCAN] = "scan",
+    [OP_RMW] = "rmw",
+    [OP_DELETE] = "delete",
+    [OP_TXN] = "txn",
+    [OP_SYNC] = "sync",
+};
+
+enum dist {
+    DIST_UNIFORM,
+    DIST_ZIPFIAN,
+    DIST_LATEST,
+    DIST_SEQUENTIAL,
+};
+
+static const char *const dist_names[] = {
+    [DIST_UNIFORM] = "uniform",
+    [DIST_ZIPFIAN] = "zipfian",
+    [DIST_LATEST] = "latest",
+    [DIST_SEQUENTIAL] = "sequential",
+};
+
+struct preset {
+    const char *name;
+    const char *spec;
+    const char *desc;
+};
+
+static const struct preset presets[] = {
+    { "ycsb-a", "read=50,update=50,dist=zipfian", "update heavy (YCSB A)" },
+    { "ycsb-b", "read=95,update=5,dist=zipfian", "read mostly (YCSB B)" },
+    { "ycsb-c", "read=100,dist=zipfian", "read only (YCSB C)" },
+    { "ycsb-d", "read=95,insert=5,dist=latest", "read latest (YCSB D)" },
+    { "ycsb-e", "scan=95,insert=5,dist=zipfian,scanlen=100", "short ranges (YCSB E)" },
+    { "ycsb-f", "read=50,rmw=50,dist=zipfian", "read-modify-write (YCSB F)" },
+    { "put", "insert=100", "c0 put of new keys" },
+    { "get", "read=100,dist=uniform", "point get" },
+    { "scan", "scan=100,dist=uniform,scanlen=100", "cursor create, seek and read" },
+    { "txn", "txn=100,dist=uniform,txnlen=4", "transaction put and commit" },
+    { "sync", "update=99,sync=1,dist=uniform", "put with periodic kvdb sync" },
+};
+
+/**
+ * struct phase - a workload phase
+ * @name:    preset name or "custom"
+ * @spec:    phase specification as given on the command line
+ * @weight:  relative frequency of each operation
+ * @wsum:    sum of weights
+ * @dist:    key distribution
+ * @secs:    run time limit
+ * @ops:     operation count limit (zero for no limit)
+ * @scanlen: maximum number of keys read per scan (each scan reads a uniform [1, scanlen])
+ * @txnlen:  number of keys put per transaction
+ * @flush:   sync the kvdb before starting the phase, such that reads are served by cn
+ */
+struct phase {
+    char  *name;
+    char  *spec;
+    uint   weight[OP_CNT];
+    uint   wsum;
+    enum dist dist;
+    uint   secs;
+    ulong  ops;
+    uint   scanlen;
+    uint   txnlen;
+    bool   flush;
+};
+
+struct zipf {
+    u64    n;
+    double theta;
+    double alpha;
+    double zetan;
+    double eta;
+    double zeta2;
+};
+
+struct opstats {
+    struct hdr_histogram *hist;
+    ulong                 errors;
+    ulong                 misses;
+};
+
+struct worker {
+    pthread_t       tid;
+    uint            idx;
+    struct phase   *phase;
+    ulong           ops;
+    u64             seq;
+    struct opstats  stats[OP_CNT];
+    struct hdr_histogram *seek_hist;
+    void           *valbuf;
+    void           *rdbuf;
+} HSE_ACP_ALIGNED;
+
+struct opts {
+    const char *home;
+    const char *kvs;
+    const char *config;
+    const char *json;
+    ulong       records;
+    uint        threads;
+    uint        klen;
+    uint        vlen;
+    uint        secs;
+    ulong       ops;
+    bool        load;
+    bool        create;
+    bool        quiet;
+} opts = {
+    .kvs = "hsebench",
+    .records = 1000 * 1000,
+    .threads = 8,
+    .klen = 16,
+    .vlen = 1024,
+    .secs = 30,
+};
+
+const char *progname;
+
+static struct hse_kvdb *kvdb;
+static struct hse_kvs  *kvs;
+static struct zipf      zipf;
+static bool             kvdb_created;
+
+static volatile bool stopthreads HSE_ACP_ALIGNED;
+static atomic_ulong  n_ops HSE_ACP_ALIGNED;
+static atomic_ulong  n_records HSE_ACP_ALIGNED;
+static pthread_barrier_t start_barrier;
+
+void
+syntax(const char *fmt, ...)
+{
+    char    msg[256];
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(msg, sizeof(msg), fmt, ap);
+    va_end(ap);
+
+    fprintf(stderr, "%s: %s, use -h for help\n", progname, msg);
+}
+
+static void
+usage(void)
+{
+    printf(
+        "usage: %s [options] -C <kvdb_home> [phase ...] [param=value ...]\n"
+        "-C home   KVDB home directory\n"
+        "-c        create the KVDB if it does not exist (and drop it on exit)\n"
+        "-d secs   default run time of each phase (default: %u)\n"
+        "-h        print this help list\n"
+        "-J file   write results as JSON to file ('-' for stdout)\n"
+        "-j jobs   number of worker threads (default: %u)\n"
+        "-K klen   key length, %u to %u (default: %u)\n"
+        "-k kvs    KVS name (default: %s)\n"
+        "-l        load the records before running the phases\n"
+        "-n ops    default operation count limit of each phase\n"
+        "-q        do not print results to stdout\n"
+        "-r recs   number of records (default: %lu)\n"
+        "-v vlen   value length (default: %u)\n"
+        "-Z config path to global config file\n",
+        progname, opts.secs, opts.threads, KLEN_MIN, KLEN_MAX, opts.klen, opts.kvs, opts.records,
+        opts.vlen);
+
+    printf(
+        "\nA phase is a preset name or 'custom', optionally followed by a colon and a\n"
+        "comma separated list of key=value settings:\n"
+        "  <op>=weight  relative frequency of op, where op is one of:\n"
+        "               read update insert scan rmw delete txn sync\n"
+        "  dist=name    key distribution: uniform zipfian latest sequential\n"
+        "  secs=n       run time limit\n"
+        "  ops=n        operation count limit\n"
+        "  scanlen=n    maximum number of keys read by a scan\n"
+        "  txnlen=n     number of keys put per transaction\n"
+        "  flush=1      sync the kvdb before the phase, so that reads are served by cn\n"
+        "\nPresets:\n");
+
+    for (size_t i = 0; i < NELEM(presets); i++)
+        printf("  %-8s %-28s %s\n", presets[i].name, presets[i].desc, presets[i].spec);
+
+    printf(
+        "\nExamples:\n"
+        "  %s -C /mnt/kvdb -c -l -r 1000000 -j 16 ycsb-a ycsb-b ycsb-c -J results.json\n"
+        "  %s -C /mnt/kvdb get get:flush=1 custom:read=90,scan=10,dist=uniform,secs=10\n",
+        progname, progname);
+}
+
+/* The zipfian generator of Gray et al., "Quickly Generating Billion-Record Synthetic
+ * Databases", as used by YCSB.
+ */
+static double
+zeta(u64 n, double theta)
+{
+    double sum = 0;
+
+    for (u64 i = 1; i <= n; i++)
+        sum += 1.0 / pow(i, theta);
+
+    return sum;
+}
+
+static void
+zipf_init(struct zipf *z, u64 n, double theta)
+{
+    z->n = n;
+    z->theta = theta;
+    z->alpha = 1.0 / (1.0 - theta);
+    z->zetan = zeta(n, theta);
+    z->zeta2 = zeta(2, theta);
+    z->eta = (1.0 - pow(2.0 / n, 1.0 - theta)) / (1.0 - z->zeta2 / z->zetan);
+}
+
+static u64
+zipf_next(const struct zipf *z, double u)
+{
+    double uz = u * z->zetan;
+
+    if (uz < 1.0)
+        return 0;
+
+    if (uz < 1.0 + pow(0.5, z->theta))
+        return 1;
+
+    return (u64)(z->n * pow(z->eta * u - z->eta + 1.0, z->alpha));
+}
+
+static HSE_ALWAYS_INLINE double
+rand_unit(void)
+{
+    return (xrand64_tls() >> 11) * 0x1.0p-53;
+}
+
+static u64
+key_next(struct worker *w)
+{
+    u64 n = atomic_read(&n_records);
+    u64 k;
+
+    switch (w->phase->dist) {
+    case DIST_ZIPFIAN:
+        /* Scramble the popular records over the key space, as YCSB does.
+         */
+        k = zipf_next(&zipf, rand_unit());
+        k = hse_hash64(&k, sizeof(k)) % n;
+        break;
+
+    case DIST_LATEST:
+        /* The zipfian distribution is over the initial record count, but anchored at the
+         * most recently inserted record.
+         */
+        k = zipf_next(&zipf, rand_unit());
+        k = (k < n) ? n - 1 - k : 0;
+        break;
+
+    case DIST_SEQUENTIAL:
+        k = (w->seq++ * opts.threads + w->idx) % n;
+        break;
+
+    default:
+        k = xrand64_tls() % n;
+        break;
+    }
+
+    return k;
+}
+
+static void
+key_make(void *buf, u64 k)
+{
+    u64 be = htobe64(k);
+
+    memset(buf, 'k', opts.klen - sizeof(be));
+    memcpy((char *)buf + opts.klen - sizeof(be), &be, sizeof(be));
+}
+
+static enum op
+op_next(const struct phase *ph)
+{
+    uint r = xrand64_tls() % ph->wsum;
+    int  i;
+
+    for (i = 0; i < OP_CNT - 1; i++) {
+        if (r < ph->weight[i])
+            break;
+        r -= ph->weight[i];
+    }
+
+    return i;
+}
+
+static hse_err_t
+do_put(struct worker *w, struct hse_kvdb_txn *txn, u64 k)
+{
+    char key[KLEN_MAX];
+
+    key_make(key, k);
+
+    /* Vary the value so that repeated puts of a key aren't identical.
+     */
+    *(u64 *)w->valbuf = k ^ w->ops;
+
+    return hse_kvs_put(kvs, 0, txn, key, opts.klen, w->valbuf, opts.vlen);
+}
+
+static hse_err_t
+do_get(struct worker *w, u64 k, bool *found)
+{
+    char   key[KLEN_MAX];
+    size_t vlen;
+
+    key_make(key, k);
+
+    return hse_kvs_get(kvs, 0, NULL, key, opts.klen, found, w->rdbuf, opts.vlen, &vlen);
+}
+
+static hse_err_t
+do_scan(struct worker *w, u64 k)
+{
+    struct hse_kvs_cursor *cur;
+    const void *kdata, *vdata;
+    size_t klen, vlen;
+    char key[KLEN_MAX];
+    bool eof = false;
+    uint cnt;
+    u64 t;
+    hse_err_t err;
+
+    cnt = 1 + xrand64_tls() % w->phase->scanlen;
+    key_make(key, k);
+
+    err = hse_kvs_cursor_create(kvs, 0, NULL, NULL, 0, &cur);
+    if (err)
+        return err;
+
+    t = get_time_ns();
+    err = hse_kvs_cursor_seek(cur, 0, key, opts.klen, NULL, NULL);
+    hdr_record_value(w->seek_hist, get_time_ns() - t);
+
+    while (!err && !eof && cnt-- > 0)
+        err = hse_kvs_cursor_read(cur, 0, &kdata, &klen, &vdata, &vlen, &eof);
+
+    hse_kvs_cursor_destroy(cur);
+
+    return err;
+}
+
+static hse_err_t
+do_txn(struct worker *w)
+{
+    struct hse_kvdb_txn *txn;
+    hse_err_t err;
+
+    txn = hse_kvdb_txn_alloc(kvdb);
+    if (!txn)
+        return ENOMEM;
+
+    err = hse_kvdb_txn_begin(kvdb, txn);
+
+    for (uint i = 0; !err && i < w->phase->txnlen; i++)
+        err = do_put(w, txn, key_next(w));
+
+    if (!err)
+        err = hse_kvdb_txn_commit(kvdb, txn);
+    else
+        hse_kvdb_txn_abort(kvdb, txn);
+
+    hse_kvdb_txn_free(kvdb, txn);
+
+    return err;
+}
+
+static hse_err_t
+op_exec(struct worker *w, enum op op, bool *miss)
+{
+    char key[KLEN_MAX];
+    bool found = true;
+    hse_err_t err = 0;
+
+    switch (op) {
+    case OP_READ:
+        err = do_get(w, key_next(w), &found);
+        break;
+
+    case OP_UPDATE:
+        err = do_put(w, NULL, key_next(w));
+        break;
+
+    case OP_INSERT:
+        err = do_put(w, NULL, atomic_inc_return(&n_records) - 1);
+        break;
+
+    case OP_SCAN:
+        err = do_scan(w, key_next(w));
+        break;
+
+    case OP_RMW: {
+        u64 k = key_next(w);
+
+        err = do_get(w, k, &found);
+        if (!err)
+            err = do_put(w, NULL, k);
+        break;
+    }
+
+    case OP_DELETE:
+        key_make(key, key_next(w));
+        err = hse_kvs_delete(kvs, 0, NULL, key, opts.klen);
+        break;
+
+    case OP_TXN:
+        err = do_txn(w);
+        break;
+
+    case OP_SYNC:
+        err = hse_kvdb_sync(kvdb, 0);
+        break;
+
+    default:
+        break;
+    }
+
+    *miss = !found;
+
+    return err;
+}
+
+static void *
+worker_main(void *arg)
+{
+    struct worker *w = arg;
+    const struct phase *ph = w->phase;
+
+    pthread_barrier_wait(&start_barrier);
+
+    while (!stopthreads) {
+        enum op op = op_next(ph);
+        hse_err_t err;
+        bool miss;
+        u64 t;
+
+        if (ph->ops && atomic_inc_return(&n_ops) > ph->ops)
+            break;
+
+        t = get_time_ns();
+        err = op_exec(w, op, &miss);
+        t = get_time_ns() - t;
+
+        hdr_record_value(w->stats[op].hist, t);
+        w->stats[op].errors += !!err;
+        w->stats[op].misses += miss;
+        w->ops++;
+    }
+
+    return NULL;
+}
+
+/* The load phase inserts the records in parallel, each worker putting every
+ * opts.threads'th record.
+ */
+static void *
+loader_main(void *arg)
+{
+    struct worker *w = arg;
+
+    pthread_barrier_wait(&start_barrier);
+
+    for (u64 k = w->idx; k < opts.records && !stopthreads; k += opts.threads) {
+        hse_err_t err;
+        u64 t;
+
+        t = get_time_ns();
+        err = do_put(w, NULL, k);
+        t = get_time_ns() - t;
+
+        hdr_record_value(w->stats[OP_INSERT].hist, t);
+        w->stats[OP_INSERT].errors += !!err;
+        w->ops++;
+    }
+
+    return NULL;
+}
+
+static int
+phase_set(struct phase *ph, const char *key, const char *val)
+{
+    char *end = NULL;
+    ulong v;
+    int i;
+
+    if (!strcmp(key, "dist")) {
+        for (i = 0; i < NELEM(dist_names); i++) {
+            if (!strcmp(val, dist_names[i])) {
+                ph->dist = i;
+                return 0;
+            }
+        }
+
+        return EINVAL;
+    }
+
+    errno = 0;
+    v = strtoul(val, &end, 0);
+    if (errno || end == val || *end)
+        return EINVAL;
+
+    for (i = 0; i < OP_CNT; i++) {
+        if (!strcmp(key, op_names[i])) {
+            ph->weight[i] = v;
+            return 0;
+        }
+    }
+
+    if (!strcmp(key, "secs"))
+        ph->secs = v;
+    else if (!strcmp(key, "ops"))
+        ph->ops = v;
+    else if (!strcmp(key, "scanlen") && v > 0 && v <= SCANLEN_MAX)
+        ph->scanlen = v;
+    else if (!strcmp(key, "txnlen") && v > 0 && v <= TXNLEN_MAX)
+        ph->txnlen = v;
+    else if (!strcmp(key, "flush"))
+        ph->flush = !!v;
+    else
+        return EINVAL;
+
+    return 0;
+}
+
+static int
+phase_parse_settings(struct phase *ph, const char *settings)
+{
+    char *str, *tok, *next;
+    int rc = 0;
+
+    str = strdup(settings);
+    if (!str)
+        return ENOMEM;
+
+    next = str;
+
+    while (!rc && (tok = strsep(&next, ","))) {
+        char *val = strchr(tok, '=');
+
+        if (!*tok)
+            continue;
+
+        if (!val) {
+            rc = EINVAL;
+            break;
+        }
+
+        *val++ = '\0';
+        rc = phase_set(ph, tok, val);
+        if (rc)
+            syntax("invalid phase setting '%s=%s'", tok, val);
+    }
+
+    free(str);
+
+    return rc;
+}
+
+static int
+phase_parse(struct phase *ph, const char *arg)
+{
+    const char *colon;
+    size_t namelen;
+    int rc;
+
+    memset(ph, 0, sizeof(*ph));
+    ph->dist = DIST_UNIFORM;
+    ph->secs = opts.secs;
+    ph->ops = opts.ops;
+    ph->scanlen = 100;
+    ph->txnlen = 1;
+
+    colon = strchr(arg, ':');
+    namelen = colon ? colon - arg : strlen(arg);
+
+    ph->spec = strdup(arg);
+    ph->name = strndup(arg, namelen);
+    if (!ph->spec || !ph->name)
+        return ENOMEM;
+
+    if (strcmp(ph->name, "custom")) {
+        size_t i;
+
+        for (i = 0; i < NELEM(presets); i++) {
+            if (!strcmp(ph->name, presets[i].name))
+                break;
+        }
+
+        if (i == NELEM(presets)) {
+            syntax("unknown preset '%s'", ph->name);
+            return EINVAL;
+        }
+
+        rc = phase_parse_settings(ph, presets[i].spec);
+        if (rc)
+            return rc;
+    }
+
+    if (colon) {
+        rc = phase_parse_settings(ph, colon + 1);
+        if (rc)
+            return rc;
+    }
+
+    for (int i = 0; i < OP_CNT; i++)
+        ph->wsum += ph->weight[i];
+
+    if (!ph->wsum) {
+        syntax("phase '%s' has no operations", arg);
+        return EINVAL;
+    }
+
+    return 0;
+}
+
+static void
+phase_free(struct phase *ph)
+{
+    free(ph->name);
+    free(ph->spec);
+}
+
+static cJSON *
+hist_to_json(const struct hdr_histogram *hist)
+{
+    cJSON *lat;
+
+    lat = cJSON_CreateObject();
+    if (!lat)
+        return NULL;
+
+    cJSON_AddNumberToObject(lat, "min", hdr_min(hist));
+    cJSON_AddNumberToObject(lat, "mean", hdr_mean(hist));
+    cJSON_AddNumberToObject(lat, "stddev", hdr_stddev(hist));
+    cJSON_AddNumberToObject(lat, "p50", hdr_value_at_percentile(hist, 50.0));
+    cJSON_AddNumberToObject(lat, "p90", hdr_value_at_percentile(hist, 90.0));
+    cJSON_AddNumberToObject(lat, "p95", hdr_value_at_percentile(hist, 95.0));
+    cJSON_AddNumberToObject(lat, "p99", hdr_value_at_percentile(hist, 99.0));
+    cJSON_AddNumberToObject(lat, "p99.9", hdr_value_at_percentile(hist, 99.9));
+    cJSON_AddNumberToObject(lat, "p99.99", hdr_value_at_percentile(hist, 99.99));
+    cJSON_AddNumberToObject(lat, "max", hdr_max(hist));
+
+    return lat;
+}
+
+static void
+print_hist_one(const char *opname, ulong errors, double secs, const struct hdr_histogram *hist)
+{
+    const char *lat_fmt = "%10s %12ld %10.0f %8lu %9.0f %8ld %8ld %8ld %8ld %10ld %12ld\n";
+
+    printf(lat_fmt, opname, (long)hist->total_count, hist->total_count / secs, errors,
+           hdr_mean(hist), hdr_min(hist), hdr_value_at_percentile(hist, 50.0),
+           hdr_value_at_percentile(hist, 95.0), hdr_value_at_percentile(hist, 99.0),
+           hdr_value_at_percentile(hist, 99.9), hdr_max(hist));
+}
+
+/* Report a phase's results, which have been accumulated into the first worker.
+ */
+static void
+phase_report(const struct phase *ph, struct worker *w, ulong ops, double secs, cJSON *phases)
+{
+    const char *hdr_fmt = "%10s %12s %10s %8s %9s %8s %8s %8s %8s %10s %12s\n";
+    cJSON *jph = NULL, *jops = NULL;
+
+    if (!opts.quiet) {
+        printf("\nphase %s: %lu ops in %.2f secs, %.0f ops/sec, latency (ns):\n",
+               ph->spec, ops, secs, ops / secs);
+        printf(hdr_fmt, "operation", "count", "ops/sec", "errors", "mean", "min", "50.0",
+               "95.0", "99.0", "99.9", "max");
+    }
+
+    if (phases) {
+        jph = cJSON_CreateObject();
+        jops = cJSON_CreateObject();
+        if (!jph || !jops) {
+            cJSON_Delete(jph);
+            cJSON_Delete(jops);
+            jph = jops = NULL;
+        } else {
+            cJSON_AddStringToObject(jph, "name", ph->name);
+            cJSON_AddStringToObject(jph, "spec", ph->spec);
+            cJSON_AddStringToObject(jph, "dist", dist_names[ph->dist]);
+            cJSON_AddNumberToObject(jph, "threads", opts.threads);
+            cJSON_AddNumberToObject(jph, "secs", secs);
+            cJSON_AddNumberToObject(jph, "ops", ops);
+            cJSON_AddNumberToObject(jph, "ops_per_sec", ops / secs);
+            cJSON_AddItemToObject(jph, "operations", jops);
+            cJSON_AddItemToArray(phases, jph);
+        }
+    }
+
+    for (int i = 0; i < OP_CNT; i++) {
+        const struct opstats *st = &w->stats[i];
+        cJSON *jop;
+
+        if (!st->hist->total_count)
+            continue;
+
+        if (!opts.quiet)
+            print_hist_one(op_names[i], st->errors, secs, st->hist);
+
+        if (!jops)
+            continue;
+
+        jop = cJSON_CreateObject();
+        if (!jop)
+            continue;
+
+        cJSON_AddNumberToObject(jop, "count", st->hist->total_count);
+        cJSON_AddNumberToObject(jop, "ops_per_sec", st->hist->total_count / secs);
+        cJSON_AddNumberToObject(jop, "errors", st->errors);
+        cJSON_AddNumberToObject(jop, "misses", st->misses);
+        cJSON_AddItemToObject(jop, "latency_ns", hist_to_json(st->hist));
+
+        if (i == OP_SCAN)
+            cJSON_AddItemToObject(jop, "seek_latency_ns", hist_to_json(w->seek_hist));
+
+        cJSON_AddItemToObject(jops, op_names[i], jop);
+    }
+
+    if (!opts.quiet && w->seek_hist->total_count)
+        print_hist_one("seek", 0, secs, w->seek_hist);
+}
+
+static int
+phase_run(struct phase *ph, struct worker *workerv, void *(*func)(void *), cJSON *phases)
+{
+    ulong ops = 0;
+    double secs;
+    u64 tstart;
+    uint i;
+    int rc;
+
+    if (ph->flush) {
+        hse_err_t err = hse_kvdb_sync(kvdb, 0);
+
+        if (err) {
+            warn(err, "sync before phase %s failed", ph->spec);
+            return EIO;
+        }
+    }
+
+    for (i = 0; i < opts.threads; i++) {
+        struct worker *w = workerv + i;
+
+        w->phase = ph;
+        w->ops = 0;
+        w->seq = 0;
+
+        for (int j = 0; j < OP_CNT; j++) {
+            hdr_reset(w->stats[j].hist);
+            w->stats[j].errors = w->stats[j].misses = 0;
+        }
+
+        hdr_reset(w->seek_hist);
+    }
+
+    rc = pthread_barrier_init(&start_barrier, NULL, opts.threads + 1);
+    if (rc)
+        return rc;
+
+    stopthreads = false;
+    atomic_set(&n_ops, 0);
+
+    for (i = 0; i < opts.threads; i++) {
+        rc = pthread_create(&workerv[i].tid, NULL, func, workerv + i);
+        if (rc)
+            fatal(rc, "pthread_create");
+    }
+
+    pthread_barrier_wait(&start_barrier);
+    tstart = get_time_ns();
+
+    /* The load phase isn't limited by time.
+     */
+    if (func == worker_main) {
+        for (uint s = 0; s < ph->secs * 10 && !stopthreads; s++) {
+            if (ph->ops && atomic_read(&n_ops) >= ph->ops)
+                break;
+            usleep(100 * 1000);
+        }
+
+        stopthreads = true;
+    }
+
+    for (i = 0; i < opts.threads; i++)
+        pthread_join(workerv[i].tid, NULL);
+
+    secs = (get_time_ns() - tstart) / 1e9;
+
+    pthread_barrier_destroy(&start_barrier);
+
+    for (i = 0; i < opts.threads; i++) {
+        struct worker *w = workerv + i;
+
+        ops += w->ops;
+
+        if (i == 0)
+            continue;
+
+        for (int j = 0; j < OP_CNT; j++) {
+            hdr_add(workerv[0].stats[j].hist, w->stats[j].hist);
+            workerv[0].stats[j].errors += w->stats[j].errors;
+            workerv[0].stats[j].misses += w->stats[j].misses;
+        }
+
+        hdr_add(workerv[0].seek_hist, w->seek_hist);
+    }
+
+    phase_report(ph, workerv, ops, secs, phases);
+
+    return 0;
+}
+
+static struct worker *
+workers_create(void)
+{
+    struct worker *workerv;
+    size_t sz;
+
+    sz = sizeof(*workerv) * opts.threads;
+
+    workerv = aligned_alloc(HSE_ACP_LINESIZE, sz);
+    if (!workerv)
+        return NULL;
+
+    memset(workerv, 0, sz);
+
+    for (uint i = 0; i < opts.threads; i++) {
+        struct worker *w = workerv + i;
+        int rc;
+
+        w->idx = i;
+        w->valbuf = malloc(opts.vlen + sizeof(u64));
+        w->rdbuf = malloc(opts.vlen + sizeof(u64));
+        if (!w->valbuf || !w->rdbuf)
+            return NULL;
+
+        for (uint j = 0; j < opts.vlen + sizeof(u64); j++)
+            ((u8 *)w->valbuf)[j] = xrand64_tls();
+
+        for (int j = 0; j < OP_CNT; j++) {
+            rc = hdr_init(LAT_MIN, LAT_MAX, LAT_SIGFIGS, &w->stats[j].hist);
+            if (rc)
+                return NULL;
+        }
+
+        rc = hdr_init(LAT_MIN, LAT_MAX, LAT_SIGFIGS, &w->seek_hist);
+        if (rc)
+            return NULL;
+    }
+
+    return workerv;
+}
+
+static void
+workers_destroy(struct worker *workerv)
+{
+    if (!workerv)
+        return;
+
+    for (uint i = 0; i < opts.threads; i++) {
+        struct worker *w = workerv + i;
+
+        for (int j = 0; j < OP_CNT; j++)
+            hdr_close(w->stats[j].hist);
+
+        hdr_close(w->seek_hist);
+        free(w->valbuf);
+        free(w->rdbuf);
+    }
+
+    free(workerv);
+}
+
+static void
+kvdb_setup(struct svec *kvdb_cparms, struct svec *kvdb_oparms, struct svec *kvs_cparms,
+           struct svec *kvs_oparms)
+{
+    hse_err_t err;
+
+    if (opts.create && access(opts.home, F_OK)) {
+        if (mkdir(opts.home, 0750) && errno != EEXIST)
+            fatal(errno, "unable to create %s", opts.home);
+
+        err = hse_kvdb_create(opts.home, kvdb_cparms->strc, kvdb_cparms->strv);
+        if (err)
+            fatal(err, "hse_kvdb_create %s", opts.home);
+
+        kvdb_created = true;
+    }
+
+    err = hse_kvdb_open(opts.home, kvdb_oparms->strc, kvdb_oparms->strv, &kvdb);
+    if (err)
+        fatal(err, "hse_kvdb_open %s", opts.home);
+
+    err = hse_kvdb_kvs_open(kvdb, opts.kvs, kvs_oparms->strc, kvs_oparms->strv, &kvs);
+    if (hse_err_to_errno(err) == ENOENT) {
+        err = hse_kvdb_kvs_create(kvdb, opts.kvs, kvs_cparms->strc, kvs_cparms->strv);
+        if (err)
+            fatal(err, "hse_kvdb_kvs_create %s", opts.kvs);
+
+        err = hse_kvdb_kvs_open(kvdb, opts.kvs, kvs_oparms->strc, kvs_oparms->strv, &kvs);
+    }
+
+    if (err)
+        fatal(err, "hse_kvdb_kvs_open %s", opts.kvs);
+}
+
+static void
+kvdb_teardown(void)
+{
+    hse_err_t err;
+
+    hse_kvdb_kvs_close(kvs);
+    hse_kvdb_close(kvdb);
+
+    if (kvdb_created) {
+        err = hse_kvdb_drop(opts.home);
+        if (err)
+            warn(err, "hse_kvdb_drop %s", opts.home);
+
+        if (rmdir(opts.home))
+            warn(errno, "unable to remove %s", opts.home);
+    }
+}
+
+static void
+json_write(cJSON *root)
+{
+    FILE *fp = stdout;
+    char *str;
+
+    str = cJSON_Print(root);
+    if (!str) {
+        warn(ENOMEM, "unable to format JSON results");
+        return;
+    }
+
+    if (strcmp(opts.json, "-")) {
+        fp = fopen(opts.json, "w");
+        if (!fp) {
+            warn(errno, "unable to open %s", opts.json);
+            cJSON_free(str);
+            return;
+        }
+    }
+
+    fprintf(fp, "%s\n", str);
+
+    if (fp != stdout)
+        fclose(fp);
+
+    cJSON_free(str);
+}
+
+int
+main(int argc, char **argv)
+{
+    struct parm_groups *pg = NULL;
+    struct svec hse_gparms = { 0 };
+    struct svec kvdb_cparms = { 0 };
+    struct svec kvdb_oparms = { 0 };
+    struct svec kvs_cparms = { 0 };
+    struct svec kvs_oparms = { 0 };
+    struct phase *phasev = NULL;
+    struct worker *workerv;
+    cJSON *root = NULL, *jphases = NULL;
+    int phasec = 0;
+    hse_err_t err;
+    int rc, c;
+
+    progname = basename(argv[0]);
+
+    rc = pg_create(&pg, PG_HSE_GLOBAL, PG_KVDB_CREATE, PG_KVDB_OPEN, PG_KVS_CREATE, PG_KVS_OPEN,
+                   NULL);
+    if (rc)
+        fatal(rc, "pg_create");
+
+    while ((c = getopt(argc, argv, ":C:cd:hJ:j:K:k:ln:qr:v:Z:")) != -1) {
+        char *errmsg, *end;
+
+        errmsg = end = NULL;
+        errno = 0;
+
+        switch (c) {
+        case 'C':
+            opts.home = optarg;
+            break;
+        case 'c':
+            opts.create = true;
+            break;
+        case 'd':
+            opts.secs = strtoul(optarg, &end, 0);
+            errmsg = "invalid duration";
+            break;
+        case 'h':
+            usage();
+            exit(0);
+        case 'J':
+            opts.json = optarg;
+            break;
+        case 'j':
+            opts.threads = strtoul(optarg, &end, 0);
+            errmsg = "invalid thread count";
+            break;
+        case 'K':
+            opts.klen = strtoul(optarg, &end, 0);
+            errmsg = "invalid key length";
+            break;
+        case 'k':
+            opts.kvs = optarg;
+            break;
+        case 'l':
+            opts.load = true;
+            break;
+        case 'n':
+            opts.ops = strtoul(optarg, &end, 0);
+            errmsg = "invalid operation count";
+            break;
+        case 'q':
+            opts.quiet = true;
+            break;
+        case 'r':
+            opts.records = strtoul(optarg, &end, 0);
+            errmsg = "invalid record count";
+            break;
+        case 'v':
+            opts.vlen = strtoul(optarg, &end, 0);
+            errmsg = "invalid value length";
+            break;
+        case 'Z':
+            opts.config = optarg;
+            break;
+        case '?':
+            syntax("invalid option -%c", optopt);
+            exit(EX_USAGE);
+        case ':':
+            syntax("option -%c requires a parameter", optopt);
+            exit(EX_USAGE);
+        default:
+            fprintf(stderr, "option -%c ignored\n", c);
+            break;
+        }
+
+        if (errno && errmsg) {
+            syntax("%s", errmsg);
+            exit(EX_USAGE);
+        } else if (end && *end) {
+            syntax("%s '%s'", errmsg, optarg);
+            exit(EX_USAGE);
+        }
+    }
+
+    if (!opts.home) {
+        syntax("missing KVDB home (-C)");
+        exit(EX_USAGE);
+    }
+
+    if (opts.klen < KLEN_MIN || opts.klen > KLEN_MAX) {
+        syntax("key length must be between %u and %u", KLEN_MIN, KLEN_MAX);
+        exit(EX_USAGE);
+    }
+
+    if (!opts.threads || !opts.records) {
+        syntax("thread and record counts must be nonzero");
+        exit(EX_USAGE);
+    }
+
+    /* Phases precede the parameter groups.
+     */
+    phasev = calloc(argc, sizeof(*phasev));
+    if (!phasev)
+        fatal(ENOMEM, "unable to allocate phases");
+
+    while (optind < argc && !strchr(argv[optind], '=')) {
+        rc = phase_parse(&phasev[phasec++], argv[optind]);
+        if (rc)
+            exit(EX_USAGE);
+        optind++;
+    }
+
+    rc = pg_parse_argv(pg, argc, argv, &optind);
+    switch (rc) {
+    case 0:
+        if (optind < argc)
+            fatal(0, "unknown parameter: %s", argv[optind]);
+        break;
+    case EINVAL:
+        fatal(0, "missing group name (e.g. %s) before parameter %s\n", PG_KVDB_OPEN,
+              argv[optind]);
+        break;
+    default:
+        fatal(rc, "error processing parameter %s\n", argv[optind]);
+        break;
+    }
+
+    rc = rc ?: svec_append_pg(&hse_gparms, pg, PG_HSE_GLOBAL, NULL);
+    rc = rc ?: svec_append_pg(&kvdb_cparms, pg, PG_KVDB_CREATE, NULL);
+    rc = rc ?: svec_append_pg(&kvdb_oparms, pg, PG_KVDB_OPEN, NULL);
+    rc = rc ?: svec_append_pg(&kvs_cparms, pg, PG_KVS_CREATE, NULL);
+    rc = rc ?: svec_append_pg(&kvs_oparms, pg, PG_KVS_OPEN, NULL);
+    if (rc)
+        fatal(rc, "failed to parse params\n");
+
+    if (!phasec && !opts.load) {
+        syntax("nothing to do, specify -l and/or phases");
+        exit(EX_USAGE);
+    }
+
+    err = hse_init(opts.config, hse_gparms.strc, hse_gparms.strv);
+    if (err)
+        fatal(err, "failed to initialize kvdb");
+
+    kvdb_setup(&kvdb_cparms, &kvdb_oparms, &kvs_cparms, &kvs_oparms);
+
+    workerv = workers_create();
+    if (!workerv)
+        fatal(ENOMEM, "unable to allocate workers");
+
+    if (opts.json) {
+        cJSON *jcfg;
+
+        root = cJSON_CreateObject();
+        jcfg = cJSON_CreateObject();
+        jphases = cJSON_CreateArray();
+        if (!root || !jcfg || !jphases)
+            fatal(ENOMEM, "unable to allocate JSON results");
+
+        cJSON_AddStringToObject(root, "version", HSE_VERSION_STRING);
+        cJSON_AddNumberToObject(jcfg, "threads", opts.threads);
+        cJSON_AddNumberToObject(jcfg, "records", opts.records);
+        cJSON_AddNumberToObject(jcfg, "key_length", opts.klen);
+        cJSON_AddNumberToObject(jcfg, "value_length", opts.vlen);
+        cJSON_AddItemToObject(root, "config", jcfg);
+        cJSON_AddItemToObject(root, "phases", jphases);
+    }
+
+    /* Records are numbered [0, n_records), inserts append to them.
+     */
+    atomic_set(&n_records, opts.records);
+    zipf_init(&zipf, opts.records, ZIPF_THETA);
+
+    if (opts.load) {
+        struct phase load = {
+            .name = "load",
+            .spec = "load",
+            .weight[OP_INSERT] = 1,
+            .wsum = 1,
+            .dist = DIST_SEQUENTIAL,
+        };
+
+        rc = phase_run(&load, workerv, loader_main, jphases);
+        if (rc)
+            fatal(rc, "load failed");
+    }
+
+    for (int i = 0; i < phasec; i++) {
+        rc = phase_run(&phasev[i], workerv, worker_main, jphases);
+        if (rc)
+            break;
+    }
+
+    if (root) {
+        json_write(root);
+        cJSON_Delete(root);
+    }
+
+    for (int i = 0; i < phasec; i++)
+        phase_free(&phasev[i]);
+    free(phasev);
+
+    workers_destroy(workerv);
+    kvdb_teardown();
+    hse_fini();
+
+    pg_destroy(pg);
+    svec_reset(&hse_gparms);
+    svec_reset(&kvdb_cparms);
+    svec_reset(&kvdb_oparms);
+    svec_reset(&kvs_cparms);
+    svec_reset(&kvs_oparms);
+
+    return rc ? EX_SOFTWARE : 0;
+}